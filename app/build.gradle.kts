@@ -17,40 +17,48 @@ android {
 
         testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
         
-        // NDK configuration for native whisper.cpp
-        // Temporarily disabled - using Vosk for speech recognition
-        // ndk {
-        //     abiFilters += listOf("arm64-v8a", "armeabi-v7a")
-        // }
+        // Native library: wake word engine, plus whisper.cpp when it is checked out
+        ndk {
+            abiFilters += listOf("arm64-v8a", "armeabi-v7a")
+        }
         
-        // External native build
-        // externalNativeBuild {
-        //     cmake {
-        //         cppFlags += listOf("-std=c++17", "-O3")
-        //         arguments += listOf(
-        //             "-DANDROID_STL=c++_shared",
-        //             "-DANDROID_PLATFORM=android-26"
-        //         )
-        //     }
-        // }
+        externalNativeBuild {
+            cmake {
+                cppFlags += listOf("-std=c++17", "-O3")
+                arguments += listOf(
+                    "-DANDROID_STL=c++_shared",
+                    "-DANDROID_PLATFORM=android-26"
+                )
+            }
+        }
     }
     
-    // Native build configuration - temporarily disabled
-    // externalNativeBuild {
-    //     cmake {
-    //         path = file("src/main/cpp/CMakeLists.txt")
-    //         version = "3.22.1"
-    //     }
-    // }
+    externalNativeBuild {
+        cmake {
+            path = file("src/main/cpp/CMakeLists.txt")
+            version = "3.22.1"
+        }
+    }
 
     buildTypes {
         debug {
             isMinifyEnabled = false
             isDebuggable = true
+            // Point every API client at a stand-in server: -PapiBaseOverride=http://127.0.0.1:8080
+            val apiBaseOverride = (project.findProperty("apiBaseOverride") as String?).orEmpty()
+            buildConfigField("String", "API_BASE_OVERRIDE", "\"$apiBaseOverride\"")
+            // Native whisper engine: -PwhisperBackend=fake for the deterministic stand-in (see cpp/fake_whisper)
+            val whisperBackend = (project.findProperty("whisperBackend") as String?) ?: "auto"
+            externalNativeBuild {
+                cmake {
+                    arguments += "-DWHISPER_BACKEND=$whisperBackend"
+                }
+            }
         }
         release {
             isMinifyEnabled = true
             isShrinkResources = true
+            buildConfigField("String", "API_BASE_OVERRIDE", "\"\"")
             proguardFiles(
                 getDefaultProguardFile("proguard-android-optimize.txt"),
                 "proguard-rules.pro"
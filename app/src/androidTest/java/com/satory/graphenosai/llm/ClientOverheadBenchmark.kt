@@ -0,0 +1,141 @@
+package com.satory.graphenosai.llm
+
+import android.os.Bundle
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import com.satory.graphenosai.BuildConfig
+import com.satory.graphenosai.audio.WhisperTranscriber
+import com.satory.graphenosai.search.BraveSearchClient
+import com.satory.graphenosai.security.SecureKeyManager
+import com.satory.graphenosai.util.Endpoints
+import kotlinx.coroutines.runBlocking
+import org.junit.After
+import org.junit.Assert.*
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+/**
+ * Client overhead of the app's own network clients, per request and per
+ * chat token, against the stand-in server (app/src/test/cpp/standin_server)
+ * with all server-side waiting turned off:
+ *
+ *   standin_server --port 8080 --first-token-ms 0 --tokens-per-s 0 --tokens 200 \
+ *       --transcribe-ms 0 --search-ms 0
+ *   adb reverse tcp:8080 tcp:8080
+ *   ./gradlew connectedDebugAndroidTest \
+ *       -Pandroid.testInstrumentationRunnerArguments.standinUrl=http://127.0.0.1:8080 \
+ *       -Pandroid.testInstrumentationRunnerArguments.class=com.satory.graphenosai.llm.ClientOverheadBenchmark
+ *
+ * Skipped without the standinUrl argument. Results go to logcat (tag
+ * ClientOverhead) and the instrumentation status; standin_bench on the host
+ * gives the floor for the same server.
+ */
+@RunWith(AndroidJUnit4::class)
+class ClientOverheadBenchmark {
+
+    companion object {
+        private const val TAG = "ClientOverhead"
+        private const val WARMUP = 5
+        private const val PLACEHOLDER_KEY = "standin"
+    }
+
+    private val instrumentation = InstrumentationRegistry.getInstrumentation()
+    private val arguments = InstrumentationRegistry.getArguments()
+    private val requests = arguments.getString("requests")?.toIntOrNull() ?: 50
+    // Must match the server's --tokens
+    private val tokens = arguments.getString("tokens")?.toIntOrNull() ?: 200
+
+    private lateinit var keyManager: SecureKeyManager
+    private var placedOpenRouterKey = false
+    private var placedBraveKey = false
+
+    @Before
+    fun setUp() {
+        val standinUrl = arguments.getString("standinUrl")
+        assumeTrue("needs -e standinUrl <stand-in server>", !standinUrl.isNullOrBlank())
+        assumeTrue("the stand-in is only reachable from debug builds", BuildConfig.DEBUG)
+        Endpoints.overrideBase(standinUrl)
+        // Requests only reach the stand-in; a stored key is left alone
+        keyManager = SecureKeyManager(instrumentation.targetContext)
+        if (!keyManager.hasOpenRouterApiKey()) {
+            keyManager.setOpenRouterApiKey(PLACEHOLDER_KEY)
+            placedOpenRouterKey = true
+        }
+        if (!keyManager.hasBraveApiKey()) {
+            keyManager.setBraveApiKey(PLACEHOLDER_KEY)
+            placedBraveKey = true
+        }
+    }
+
+    @After
+    fun tearDown() {
+        if (BuildConfig.DEBUG) Endpoints.overrideBase(null)
+        if (placedOpenRouterKey) keyManager.clearOpenRouterApiKey()
+        if (placedBraveKey) keyManager.clearBraveApiKey()
+    }
+
+    @Test
+    fun chatStream() = runBlocking {
+        val client = OpenRouterClient(keyManager)
+        val times = measure {
+            var chunks = 0
+            client.streamCompletion("What's the weather like tomorrow?", context = null).collect { chunks++ }
+            assertEquals("chunks per answer (server --tokens)", tokens, chunks)
+        }
+        report("chat", times, tokens)
+    }
+
+    @Test
+    fun transcription() = runBlocking {
+        val transcriber = WhisperTranscriber { PLACEHOLDER_KEY }
+        // Three seconds of 16 kHz mono silence, about the size of a short command
+        val wav = File(instrumentation.targetContext.cacheDir, "standin.wav").apply {
+            writeBytes(ByteArray(44 + 3 * 16000 * 2))
+        }
+        try {
+            val times = measure {
+                assertTrue(transcriber.transcribe(wav, "en").isSuccess)
+            }
+            report("transcription", times, 0)
+        } finally {
+            wav.delete()
+        }
+    }
+
+    @Test
+    fun search() = runBlocking {
+        val client = BraveSearchClient(keyManager)
+        val times = measure {
+            assertEquals(5, client.search("weather tomorrow").size)
+        }
+        report("search", times, 0)
+    }
+
+    private suspend fun measure(request: suspend () -> Unit): LongArray {
+        repeat(WARMUP) { request() }
+        val times = LongArray(requests)
+        for (i in times.indices) {
+            val start = System.nanoTime()
+            request()
+            times[i] = System.nanoTime() - start
+        }
+        return times
+    }
+
+    private fun report(name: String, timesNs: LongArray, tokensPerRequest: Int) {
+        timesNs.sort()
+        val p50 = timesNs[timesNs.size / 2] / 1e6
+        val p90 = timesNs[(timesNs.size * 9 / 10).coerceAtMost(timesNs.size - 1)] / 1e6
+        val mean = timesNs.average() / 1e6
+        val perToken = if (tokensPerRequest > 0) mean * 1000 / tokensPerRequest else 0.0
+        val line = "%s: %d requests, p50 %.2f ms, p90 %.2f ms, mean %.2f ms%s".format(
+            name, timesNs.size, p50, p90, mean,
+            if (tokensPerRequest > 0) ", %.1f us/token".format(perToken) else "")
+        Log.i(TAG, line)
+        instrumentation.sendStatus(0, Bundle().apply { putString("stream", "$line\n") })
+    }
+}
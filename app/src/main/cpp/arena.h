@@ -0,0 +1,140 @@
+/**
+ * arena.h - Bump allocator for per-request native buffers
+ *
+ * A request (one transcription) takes its PCM, scratch and result buffers
+ * from an Arena and releases them all at once with reset(). When a
+ * request outgrows the current block a new one is added; the next reset()
+ * replaces the blocks with a single one sized to the high-water mark, so
+ * from the second request of a given size on, nothing touches the heap.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace assistant {
+
+class Arena {
+public:
+    explicit Arena(size_t initial_bytes = 64 * 1024) {
+        blocks_.reserve(kMaxBlocks);
+        if (initial_bytes > 0) add_block(initial_bytes);
+    }
+
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** Uninitialized memory for `bytes`, valid until reset(). */
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        // Block bases come from new[] and are max_align_t aligned, so aligning offsets suffices
+        size_t start = (offset_ + align - 1) & ~(align - 1);
+        if (blocks_.empty() || start + bytes > blocks_.back().size) {
+            add_block(bytes);
+            start = 0;
+        }
+        offset_ = start + bytes;
+        return blocks_.back().data.get() + start;
+    }
+
+    template <typename T>
+    T* alloc(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /** Copy of `n` chars plus a terminating NUL. */
+    char* copy(const char* text, size_t n) {
+        char* out = alloc<char>(n + 1);
+        memcpy(out, text, n);
+        out[n] = '\0';
+        return out;
+    }
+
+    /** Release everything; keeps (and if needed consolidates) the memory. */
+    void reset() {
+        const size_t high_water = in_use();
+        if (blocks_.size() > 1) {
+            blocks_.clear();
+            capacity_ = 0;
+            add_block(high_water);
+        }
+        offset_ = 0;
+    }
+
+    /** Bytes handed out since the last reset, including alignment and abandoned block tails. */
+    size_t in_use() const {
+        size_t total = offset_;
+        for (size_t i = 0; i + 1 < blocks_.size(); ++i) total += blocks_[i].size;
+        return total;
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t blocks() const { return blocks_.size(); }
+
+private:
+    static constexpr size_t kMaxBlocks = 16;
+
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+
+    void add_block(size_t bytes) {
+        // Double each time so a request needs few blocks before the next reset consolidates
+        bytes = std::max(std::max<size_t>(bytes, 1), capacity_);
+        Block block;
+        block.data.reset(new uint8_t[bytes]);
+        block.size = bytes;
+        blocks_.push_back(std::move(block));
+        capacity_ += bytes;
+        offset_ = 0;
+    }
+
+    std::vector<Block> blocks_;
+    size_t offset_ = 0;     // within blocks_.back()
+    size_t capacity_ = 0;
+};
+
+/** Append-only NUL-terminated text in an Arena; growth abandons the old copy until reset(). */
+class ArenaText {
+public:
+    explicit ArenaText(Arena& arena) : arena_(&arena) {}
+
+    void append(const char* text, size_t n) {
+        if (size_ + n + 1 > capacity_) {
+            const size_t capacity = std::max<size_t>(64, std::max(capacity_ * 2, size_ + n + 1));
+            char* grown = arena_->alloc<char>(capacity);
+            if (size_ > 0) memcpy(grown, data_, size_);
+            data_ = grown;
+            capacity_ = capacity;
+        }
+        memcpy(data_ + size_, text, n);
+        size_ += n;
+        data_[size_] = '\0';
+    }
+
+    void append(const char* text) { append(text, strlen(text)); }
+
+    void clear() {
+        size_ = 0;
+        if (data_ != nullptr) data_[0] = '\0';
+    }
+
+    const char* c_str() const { return data_ != nullptr ? data_ : ""; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    Arena* arena_;
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+} // namespace assistant
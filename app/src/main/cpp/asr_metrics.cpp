@@ -0,0 +1,187 @@
+/**
+ * asr_metrics.cpp - Transcript normalization and Levenshtein alignment
+ */
+
+#include "asr_metrics.h"
+
+#include <algorithm>
+#include <map>
+
+namespace assistant {
+
+std::vector<uint32_t> decode_utf8(const std::string& text) {
+    std::vector<uint32_t> out;
+    out.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size()) {
+        const auto c = static_cast<uint8_t>(text[i]);
+        uint32_t cp = c;
+        size_t extra = 0;
+        if (c >= 0xF0) { cp = c & 0x07; extra = 3; }
+        else if (c >= 0xE0) { cp = c & 0x0F; extra = 2; }
+        else if (c >= 0xC0) { cp = c & 0x1F; extra = 1; }
+        else if (c >= 0x80) { ++i; continue; }   // stray continuation byte
+        if (i + extra >= text.size() && extra > 0) break;   // truncated sequence
+        for (size_t k = 1; k <= extra; ++k) cp = (cp << 6) | (static_cast<uint8_t>(text[i + k]) & 0x3F);
+        out.push_back(cp);
+        i += extra + 1;
+    }
+    return out;
+}
+
+std::string encode_utf8(const std::vector<uint32_t>& code_points) {
+    std::string out;
+    for (uint32_t cp : code_points) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return out;
+}
+
+namespace {
+    uint32_t to_lower(uint32_t cp) {
+        if (cp >= 'A' && cp <= 'Z') return cp + 0x20;
+        if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;    // Latin-1
+        if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;                // Cyrillic А-Я
+        if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;                // Ѐ-Џ (Ё)
+        return cp;
+    }
+
+    bool is_space(uint32_t cp) {
+        return cp == ' ' || cp == '\t' || cp == '\n' || cp == '\r' || cp == 0xA0;
+    }
+
+    bool is_punctuation(uint32_t cp) {
+        if (cp == '\'') return false;
+        if (cp < 0x80) return (cp >= '!' && cp <= '/') || (cp >= ':' && cp <= '@') ||
+                              (cp >= '[' && cp <= '`') || (cp >= '{' && cp <= '~');
+        return cp == 0xA1 || cp == 0xAB || cp == 0xBB || cp == 0xBF ||
+               (cp >= 0x2010 && cp <= 0x2027);     // dashes, quotes, ellipsis
+    }
+
+    /** Levenshtein alignment with unit costs; counts each edit type. */
+    ErrorCounts align(const std::vector<uint32_t>& ref, const std::vector<uint32_t>& hyp) {
+        const size_t n = ref.size();
+        const size_t m = hyp.size();
+        std::vector<uint32_t> cost((n + 1) * (m + 1));
+        auto at = [m](size_t i, size_t j) { return i * (m + 1) + j; };
+        for (size_t i = 0; i <= n; ++i) cost[at(i, 0)] = static_cast<uint32_t>(i);
+        for (size_t j = 0; j <= m; ++j) cost[at(0, j)] = static_cast<uint32_t>(j);
+        for (size_t i = 1; i <= n; ++i) {
+            for (size_t j = 1; j <= m; ++j) {
+                const uint32_t sub = cost[at(i - 1, j - 1)] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+                cost[at(i, j)] = std::min({sub, cost[at(i - 1, j)] + 1, cost[at(i, j - 1)] + 1});
+            }
+        }
+
+        ErrorCounts counts;
+        counts.reference = n;
+        size_t i = n;
+        size_t j = m;
+        while (i > 0 || j > 0) {
+            if (i > 0 && j > 0 &&
+                cost[at(i, j)] == cost[at(i - 1, j - 1)] + (ref[i - 1] == hyp[j - 1] ? 0 : 1)) {
+                if (ref[i - 1] != hyp[j - 1]) ++counts.substitutions;
+                --i;
+                --j;
+            } else if (i > 0 && cost[at(i, j)] == cost[at(i - 1, j)] + 1) {
+                ++counts.deletions;
+                --i;
+            } else {
+                ++counts.insertions;
+                --j;
+            }
+        }
+        return counts;
+    }
+}
+
+std::vector<std::string> normalize_transcript(const std::string& text) {
+    std::vector<std::string> words;
+    std::vector<uint32_t> word;
+    for (uint32_t cp : decode_utf8(text)) {
+        if (is_space(cp) || is_punctuation(cp)) {
+            // Hyphenated and dotted tokens split, like the references are written
+            if (!word.empty()) words.push_back(encode_utf8(word));
+            word.clear();
+        } else {
+            word.push_back(to_lower(cp));
+        }
+    }
+    if (!word.empty()) words.push_back(encode_utf8(word));
+    return words;
+}
+
+double ErrorCounts::rate() const {
+    if (reference == 0) return errors() > 0 ? 1.0 : 0.0;
+    return static_cast<double>(errors()) / static_cast<double>(reference);
+}
+
+void ErrorCounts::add(const ErrorCounts& other) {
+    substitutions += other.substitutions;
+    deletions += other.deletions;
+    insertions += other.insertions;
+    reference += other.reference;
+}
+
+ErrorCounts word_errors(const std::string& reference, const std::string& hypothesis) {
+    // Map words to ids so the alignment works on integers
+    std::map<std::string, uint32_t> ids;
+    auto to_ids = [&ids](const std::vector<std::string>& words) {
+        std::vector<uint32_t> out;
+        out.reserve(words.size());
+        for (const std::string& w : words) {
+            out.push_back(ids.emplace(w, static_cast<uint32_t>(ids.size())).first->second);
+        }
+        return out;
+    };
+    const std::vector<uint32_t> ref = to_ids(normalize_transcript(reference));
+    const std::vector<uint32_t> hyp = to_ids(normalize_transcript(hypothesis));
+    return align(ref, hyp);
+}
+
+ErrorCounts char_errors(const std::string& reference, const std::string& hypothesis) {
+    auto chars = [](const std::string& text) {
+        std::vector<uint32_t> out;
+        for (const std::string& w : normalize_transcript(text)) {
+            const std::vector<uint32_t> cps = decode_utf8(w);
+            out.insert(out.end(), cps.begin(), cps.end());
+        }
+        return out;
+    };
+    return align(chars(reference), chars(hypothesis));
+}
+
+void AsrScore::add(const AsrScore& other) {
+    words.add(other.words);
+    chars.add(other.chars);
+    audio_seconds += other.audio_seconds;
+    compute_seconds += other.compute_seconds;
+    clips += other.clips;
+}
+
+AsrScore score_clip(const std::string& reference, const std::string& hypothesis,
+                    double audio_seconds, double compute_seconds) {
+    AsrScore score;
+    score.words = word_errors(reference, hypothesis);
+    score.chars = char_errors(reference, hypothesis);
+    score.audio_seconds = audio_seconds;
+    score.compute_seconds = compute_seconds;
+    score.clips = 1;
+    return score;
+}
+
+} // namespace assistant
@@ -0,0 +1,58 @@
+/**
+ * asr_metrics.h - Word/character error rate and real-time factor for ASR evaluation
+ *
+ * Transcripts are compared after normalization: lowercase (ASCII, Latin-1
+ * and Cyrillic), punctuation removed except apostrophes, whitespace
+ * collapsed. CER counts code points of the normalized words, without the
+ * spaces between them, so it is comparable across scripts.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace assistant {
+
+std::vector<uint32_t> decode_utf8(const std::string& text);
+std::string encode_utf8(const std::vector<uint32_t>& code_points);
+
+/** Normalized words of a transcript (see the file comment). */
+std::vector<std::string> normalize_transcript(const std::string& text);
+
+/** Alignment of a hypothesis against a reference. */
+struct ErrorCounts {
+    size_t substitutions = 0;
+    size_t deletions = 0;
+    size_t insertions = 0;
+    size_t reference = 0;       // reference length (words or characters)
+
+    size_t errors() const { return substitutions + deletions + insertions; }
+    /** errors / reference; 0 for an empty reference and hypothesis. */
+    double rate() const;
+    void add(const ErrorCounts& other);
+};
+
+ErrorCounts word_errors(const std::string& reference, const std::string& hypothesis);
+ErrorCounts char_errors(const std::string& reference, const std::string& hypothesis);
+
+/** Accumulated accuracy and speed over a set of clips. */
+struct AsrScore {
+    ErrorCounts words;
+    ErrorCounts chars;
+    double audio_seconds = 0.0;
+    double compute_seconds = 0.0;
+    size_t clips = 0;
+
+    /** Processing time per second of audio; < 1 is faster than real time. */
+    double rtf() const { return audio_seconds > 0.0 ? compute_seconds / audio_seconds : 0.0; }
+    void add(const AsrScore& other);
+};
+
+/** Score one clip. */
+AsrScore score_clip(const std::string& reference, const std::string& hypothesis,
+                    double audio_seconds, double compute_seconds);
+
+} // namespace assistant
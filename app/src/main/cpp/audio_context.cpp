@@ -0,0 +1,74 @@
+/**
+ * audio_context.cpp - Encoder context sizing and degenerate transcript check
+ */
+
+#include "audio_context.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include "lru_cache.h"
+
+namespace assistant {
+
+int32_t compute_audio_ctx(size_t n_samples, int32_t sample_rate, const AudioContextPolicy& policy) {
+    if (sample_rate <= 0 || n_samples == 0) return 0;
+    const double seconds = static_cast<double>(n_samples) / sample_rate;
+    if (seconds > policy.max_seconds) return 0;
+
+    const double covered = seconds * (1.0 + policy.margin_fraction) + policy.margin_seconds;
+    auto frames = static_cast<int32_t>(std::ceil(covered * policy.frames_per_second));
+    if (policy.granularity > 1) {
+        frames = (frames + policy.granularity - 1) / policy.granularity * policy.granularity;
+    }
+    frames = std::max(frames, policy.min_ctx);
+    return frames >= policy.full_ctx ? 0 : frames;
+}
+
+float audio_ctx_seconds(int32_t audio_ctx, const AudioContextPolicy& policy) {
+    const int32_t frames = audio_ctx > 0 ? std::min(audio_ctx, policy.full_ctx) : policy.full_ctx;
+    return static_cast<float>(frames) / policy.frames_per_second;
+}
+
+bool transcript_looks_degenerate(const char* text, double audio_seconds, double max_chars_per_second) {
+    if (static_cast<double>(strlen(text)) > max_chars_per_second * std::max(1.0, audio_seconds)) return true;
+
+    // Runs on every short-context transcription, so no heap: each trigram is a hash of its
+    // three word hashes, counted in a fixed open-addressed table. Text that passed the length
+    // check above has far fewer trigrams than the table takes.
+    constexpr size_t kMaxTrigrams = 512;
+    constexpr size_t kSlots = 2 * kMaxTrigrams;         // power of two
+    uint64_t slots[kSlots] = {};                        // 0: empty
+    uint64_t window[3] = {};
+    size_t words = 0;
+    size_t trigrams = 0;
+    size_t distinct = 0;
+    const char* p = text;
+    while (trigrams < kMaxTrigrams) {
+        while (*p != '\0' && isspace(static_cast<unsigned char>(*p))) ++p;
+        if (*p == '\0') break;
+        const char* word = p;
+        while (*p != '\0' && !isspace(static_cast<unsigned char>(*p))) ++p;
+        window[0] = window[1];
+        window[1] = window[2];
+        window[2] = fnv1a64(word, static_cast<size_t>(p - word));
+        if (++words < 3) continue;
+
+        const uint64_t hash = std::max<uint64_t>(1, fnv1a64(window, sizeof(window)));
+        ++trigrams;
+        for (size_t i = hash & (kSlots - 1);; i = (i + 1) & (kSlots - 1)) {
+            if (slots[i] == hash) break;
+            if (slots[i] == 0) {
+                slots[i] = hash;
+                ++distinct;
+                break;
+            }
+        }
+    }
+    if (words < 8) return false;
+    return distinct * 2 < trigrams;
+}
+
+} // namespace assistant
@@ -0,0 +1,53 @@
+/**
+ * audio_context.h - Encoder context sizing for short whisper utterances
+ *
+ * Whisper pads every clip to 30 s and encodes all 1500 frames (50 per
+ * second). A voice command of a few seconds only needs the frames that
+ * cover it, so `compute_audio_ctx` picks a smaller `audio_ctx` with a
+ * safety margin. Reduced contexts are known to make the decoder loop or
+ * hallucinate more often, so clips past `max_seconds` keep the full
+ * context and `transcript_looks_degenerate` flags results that should be
+ * decoded again with it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace assistant {
+
+struct AudioContextPolicy {
+    int32_t full_ctx = 1500;            // encoder frames for a 30 s window
+    int32_t frames_per_second = 50;
+    float margin_seconds = 1.0f;        // covered past the end of the clip
+    float margin_fraction = 0.1f;       // ... plus this share of its length
+    int32_t min_ctx = 256;              // ~5 s; smaller contexts lose accuracy
+    int32_t granularity = 64;           // round up so similar clips share a size
+    float max_seconds = 20.0f;          // longer clips use the full context
+};
+
+/**
+ * Encoder context for a clip of `n_samples` at `sample_rate`; 0 means the
+ * full context (whisper's default).
+ */
+int32_t compute_audio_ctx(size_t n_samples, int32_t sample_rate,
+                          const AudioContextPolicy& policy = AudioContextPolicy());
+
+/** Seconds of audio an encoder context of `audio_ctx` frames covers. */
+float audio_ctx_seconds(int32_t audio_ctx, const AudioContextPolicy& policy = AudioContextPolicy());
+
+/**
+ * Heuristic for a looping or hallucinated transcript: far more text than
+ * the audio could hold, or mostly repeated word trigrams (among the first
+ * 512). Does not allocate.
+ */
+bool transcript_looks_degenerate(const char* text, double audio_seconds, double max_chars_per_second = 25.0);
+
+inline bool transcript_looks_degenerate(const std::string& text, double audio_seconds,
+                                        double max_chars_per_second = 25.0) {
+    return transcript_looks_degenerate(text.c_str(), audio_seconds, max_chars_per_second);
+}
+
+} // namespace assistant
@@ -0,0 +1,1014 @@
+/**
+ * audio_decoder.cpp - WAV and FLAC decoders, MediaCodec on Android, resampling stream
+ */
+
+#define LOG_TAG "AudioDecoder"
+
+#include "audio_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __ANDROID__
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaExtractor.h>
+#include <media/NdkMediaFormat.h>
+#endif
+
+#include "native_log.h"
+#include "wav_io.h"
+
+namespace assistant {
+
+namespace {
+    constexpr size_t kChunkFrames = 4096;
+
+    void set_error(std::string* error, const std::string& message) {
+        if (error != nullptr) *error = message;
+    }
+
+    uint32_t read_u32_be(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+    /** Size of an ID3v2 tag starting at `head` (header, footer included); 0 if there is none. */
+    long id3_size(const uint8_t* head, size_t n) {
+        if (n < 10 || memcmp(head, "ID3", 3) != 0) return 0;
+        const long body = (static_cast<long>(head[6] & 0x7f) << 21) | (static_cast<long>(head[7] & 0x7f) << 14) |
+                          (static_cast<long>(head[8] & 0x7f) << 7) | static_cast<long>(head[9] & 0x7f);
+        return 10 + body + ((head[5] & 0x10) != 0 ? 10 : 0);
+    }
+
+    // ---- WAV ----
+
+    /** Any PCM or float WAV, read sequentially through stdio. */
+    class WavDecoder : public AudioDecoder {
+    public:
+        explicit WavDecoder(FILE* file) : file_(file) {}
+        ~WavDecoder() override { fclose(file_); }
+
+        bool open(std::string* error) {
+            WavInfo wav;
+            if (!read_wav_header(file_, wav) || wav.channels < 1 || wav.sample_rate <= 0) {
+                set_error(error, "malformed WAV header");
+                return false;
+            }
+            const int32_t bits = wav.bits_per_sample;
+            if (wav.format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) {
+                // Same expression as read_wav_mono_float for 16-bit, so both paths give identical samples
+                divisor_ = std::ldexp(1.0f, bits - 1) * static_cast<float>(wav.channels);
+            } else if (wav.format == 3 && (bits == 32 || bits == 64)) {
+                divisor_ = static_cast<float>(wav.channels);
+            } else {
+                set_error(error, "unsupported WAV encoding (format " + std::to_string(wav.format) + ", " +
+                                 std::to_string(bits) + " bits)");
+                return false;
+            }
+            float_ = wav.format == 3;
+            bytes_per_sample_ = static_cast<size_t>(bits / 8);
+            frame_bytes_ = bytes_per_sample_ * static_cast<size_t>(wav.channels);
+
+            // Recorders that were killed leave a zero or oversized data length; trust the file size instead
+            uint64_t data_bytes = wav.data_bytes;
+            struct stat st;
+            if (fstat(fileno(file_), &st) == 0 && st.st_size >= wav.data_offset) {
+                const auto available = static_cast<uint64_t>(st.st_size - wav.data_offset);
+                if (data_bytes == 0 || data_bytes > available) data_bytes = available;
+            }
+            remaining_ = data_bytes / frame_bytes_;
+
+            info_.format = AUDIO_WAV;
+            info_.sample_rate = wav.sample_rate;
+            info_.channels = wav.channels;
+            info_.bits_per_sample = bits;
+            info_.frames = static_cast<int64_t>(remaining_);
+            info_.exact = true;
+            return true;
+        }
+
+        size_t read(float* out, size_t n) override {
+            const size_t channels = static_cast<size_t>(info_.channels);
+            const size_t frames_per_read = std::max<size_t>(1, sizeof(buffer_) / frame_bytes_);
+            size_t done = 0;
+            while (done < n && remaining_ > 0) {
+                const size_t want = static_cast<size_t>(std::min<uint64_t>({n - done, frames_per_read, remaining_}));
+                const size_t got = fread(buffer_, frame_bytes_, want, file_);
+                for (size_t f = 0; f < got; ++f) {
+                    const uint8_t* frame = buffer_ + f * frame_bytes_;
+                    out[done + f] = float_ ? mix_float(frame, channels) : mix_int(frame, channels);
+                }
+                done += got;
+                remaining_ -= got;
+                if (got < want) {
+                    failed_ = ferror(file_) != 0;
+                    remaining_ = 0;
+                }
+            }
+            return done;
+        }
+
+    private:
+        float mix_int(const uint8_t* frame, size_t channels) const {
+            int64_t sum = 0;
+            for (size_t c = 0; c < channels; ++c) {
+                const uint8_t* p = frame + c * bytes_per_sample_;
+                switch (bytes_per_sample_) {
+                    case 1: sum += static_cast<int32_t>(p[0]) - 128; break;
+                    case 2: sum += static_cast<int16_t>(p[0] | (p[1] << 8)); break;
+                    case 3: sum += static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) |
+                                                        (static_cast<uint32_t>(p[1]) << 16) |
+                                                        (static_cast<uint32_t>(p[2]) << 24)) >> 8; break;
+                    default: {
+                        int32_t s;
+                        memcpy(&s, p, sizeof(s));
+                        sum += s;
+                    }
+                }
+            }
+            return static_cast<float>(sum) / divisor_;
+        }
+
+        float mix_float(const uint8_t* frame, size_t channels) const {
+            double sum = 0.0;
+            for (size_t c = 0; c < channels; ++c) {
+                const uint8_t* p = frame + c * bytes_per_sample_;
+                if (bytes_per_sample_ == 4) {
+                    float s;
+                    memcpy(&s, p, sizeof(s));
+                    sum += s;
+                } else {
+                    double s;
+                    memcpy(&s, p, sizeof(s));
+                    sum += s;
+                }
+            }
+            return std::max(-1.0f, std::min(1.0f, static_cast<float>(sum) / divisor_));
+        }
+
+        FILE* file_;
+        bool float_ = false;
+        size_t bytes_per_sample_ = 2;
+        size_t frame_bytes_ = 2;
+        float divisor_ = 1.0f;
+        uint64_t remaining_ = 0;
+        uint8_t buffer_[16384];
+    };
+
+    // ---- FLAC ----
+
+    struct CrcTables {
+        uint8_t crc8[256];
+        uint16_t crc16[256];
+
+        CrcTables() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c8 = i;
+                uint32_t c16 = i << 8;
+                for (int bit = 0; bit < 8; ++bit) {
+                    c8 = (c8 & 0x80) != 0 ? (c8 << 1) ^ 0x07 : c8 << 1;
+                    c16 = (c16 & 0x8000) != 0 ? (c16 << 1) ^ 0x8005 : c16 << 1;
+                }
+                crc8[i] = static_cast<uint8_t>(c8);
+                crc16[i] = static_cast<uint16_t>(c16);
+            }
+        }
+    };
+
+    const CrcTables& crc_tables() {
+        static const CrcTables tables;
+        return tables;
+    }
+
+    uint8_t crc8(const uint8_t* p, size_t n) {
+        const uint8_t* table = crc_tables().crc8;
+        uint8_t crc = 0;
+        for (size_t i = 0; i < n; ++i) crc = table[crc ^ p[i]];
+        return crc;
+    }
+
+    uint16_t crc16(const uint8_t* p, size_t n) {
+        const uint16_t* table = crc_tables().crc16;
+        uint16_t crc = 0;
+        for (size_t i = 0; i < n; ++i) crc = static_cast<uint16_t>((crc << 8) ^ table[(crc >> 8) ^ p[i]]);
+        return crc;
+    }
+
+    /** MSB-first bit reader over a byte range; reads past the end yield zeros and set overrun(). */
+    class BitReader {
+    public:
+        BitReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+        uint32_t read(int n) {
+            if (n == 0) return 0;
+            if (count_ < n) refill();
+            const auto v = static_cast<uint32_t>(cache_ >> (64 - n));
+            cache_ <<= n;
+            count_ -= n;
+            consumed_ += static_cast<uint64_t>(n);
+            return v;
+        }
+
+        int32_t read_signed(int n) {
+            if (n == 0) return 0;
+            const uint32_t v = read(n);
+            return static_cast<int32_t>(v << (32 - n)) >> (32 - n);
+        }
+
+        /** Zeros before the next one bit, which is consumed. */
+        uint32_t unary() {
+            uint32_t zeros = 0;
+            while (true) {
+                if (count_ == 0) refill();
+                if (cache_ == 0) {
+                    zeros += static_cast<uint32_t>(count_);
+                    consumed_ += static_cast<uint64_t>(count_);
+                    count_ = 0;
+                    if (overrun()) return 0;
+                    continue;
+                }
+                const int lead = __builtin_clzll(cache_);
+                cache_ = lead == 63 ? 0 : cache_ << (lead + 1);
+                count_ -= lead + 1;
+                consumed_ += static_cast<uint64_t>(lead + 1);
+                return zeros + static_cast<uint32_t>(lead);
+            }
+        }
+
+        void align() { read(static_cast<int>((8 - consumed_ % 8) % 8)); }
+
+        bool overrun() const { return consumed_ > static_cast<uint64_t>(size_) * 8; }
+        size_t bytes_consumed() const { return static_cast<size_t>(consumed_ / 8); }
+
+    private:
+        void refill() {
+            while (count_ <= 56) {
+                const uint8_t byte = pos_ < size_ ? data_[pos_] : 0;
+                ++pos_;
+                cache_ |= static_cast<uint64_t>(byte) << (56 - count_);
+                count_ += 8;
+            }
+        }
+
+        const uint8_t* data_;
+        size_t size_;
+        size_t pos_ = 0;
+        uint64_t cache_ = 0;
+        int count_ = 0;
+        uint64_t consumed_ = 0;
+    };
+
+    /**
+     * Native FLAC: all subframe types and stereo decorrelation modes, up to
+     * 24 bits and 8 channels. Frames are decoded one at a time from a buffer
+     * sized to the largest frame STREAMINFO allows; a frame with a bad CRC
+     * becomes silence and decoding resynchronizes on the next frame header.
+     */
+    class FlacDecoder : public AudioDecoder {
+    public:
+        explicit FlacDecoder(FILE* file) : file_(file) {}
+        ~FlacDecoder() override { fclose(file_); }
+
+        bool open(long offset, std::string* error) {
+            uint8_t marker[4];
+            if (fseek(file_, offset, SEEK_SET) != 0 || fread(marker, 1, 4, file_) != 4 || memcmp(marker, "fLaC", 4) != 0) {
+                set_error(error, "missing fLaC marker");
+                return false;
+            }
+            bool have_streaminfo = false;
+            bool last = false;
+            while (!last) {
+                uint8_t header[4];
+                if (fread(header, 1, 4, file_) != 4) {
+                    set_error(error, "truncated FLAC metadata");
+                    return false;
+                }
+                last = (header[0] & 0x80) != 0;
+                const uint32_t type = header[0] & 0x7f;
+                const uint32_t length = read_u32_be(header) & 0xffffff;
+                if (type == 0 && length >= 34) {
+                    uint8_t si[34];
+                    if (fread(si, 1, sizeof(si), file_) != sizeof(si) ||
+                        fseek(file_, static_cast<long>(length - sizeof(si)), SEEK_CUR) != 0) {
+                        set_error(error, "truncated STREAMINFO");
+                        return false;
+                    }
+                    max_block_ = (static_cast<uint32_t>(si[2]) << 8) | si[3];
+                    max_frame_bytes_ = (static_cast<uint32_t>(si[7]) << 16) | (static_cast<uint32_t>(si[8]) << 8) | si[9];
+                    info_.sample_rate = static_cast<int32_t>((static_cast<uint32_t>(si[10]) << 12) |
+                                                             (static_cast<uint32_t>(si[11]) << 4) | (si[12] >> 4));
+                    info_.channels = ((si[12] >> 1) & 0x07) + 1;
+                    info_.bits_per_sample = (((si[12] & 0x01) << 4) | (si[13] >> 4)) + 1;
+                    const int64_t total = (static_cast<int64_t>(si[13] & 0x0f) << 32) | read_u32_be(si + 14);
+                    info_.frames = total > 0 ? total : -1;
+                    info_.exact = total > 0;
+                    have_streaminfo = true;
+                } else if (fseek(file_, static_cast<long>(length), SEEK_CUR) != 0) {
+                    set_error(error, "truncated FLAC metadata");
+                    return false;
+                }
+            }
+            if (!have_streaminfo || info_.sample_rate <= 0) {
+                set_error(error, "FLAC without STREAMINFO");
+                return false;
+            }
+            if (info_.bits_per_sample < 4 || info_.bits_per_sample > 24) {
+                set_error(error, std::to_string(info_.bits_per_sample) + "-bit FLAC is not supported");
+                return false;
+            }
+            info_.format = AUDIO_FLAC;
+            if (max_block_ < 16) max_block_ = 65535;
+            divisor_ = std::ldexp(1.0f, info_.bits_per_sample - 1) * static_cast<float>(info_.channels);
+
+            // Worst case is a verbatim frame, side channel included; STREAMINFO usually knows better
+            const size_t verbatim = static_cast<size_t>(max_block_) * static_cast<size_t>(info_.channels) *
+                                    static_cast<size_t>(info_.bits_per_sample + 1) / 8 + 64;
+            frame_cap_ = max_frame_bytes_ > 0 ? std::min<size_t>(max_frame_bytes_ + 64, verbatim) : verbatim;
+            buffer_.resize(std::max<size_t>(2 * frame_cap_, 64 * 1024));
+            for (int c = 0; c < info_.channels; ++c) samples_[c].resize(max_block_);
+            mono_.resize(max_block_);
+            return true;
+        }
+
+        size_t read(float* out, size_t n) override {
+            size_t done = 0;
+            while (done < n) {
+                if (block_pos_ == block_size_ && !next_frame()) break;
+                const size_t take = std::min(n - done, block_size_ - block_pos_);
+                memcpy(out + done, mono_.data() + block_pos_, take * sizeof(float));
+                block_pos_ += take;
+                done += take;
+            }
+            return done;
+        }
+
+    private:
+        enum FrameResult { FRAME_OK, FRAME_SHORT, FRAME_BAD };
+
+        static constexpr size_t kMaxFrameBytes = 16u << 20;
+
+        /** Keep at least `want` bytes buffered unless the file ends first. */
+        void fill(size_t want) {
+            if (end_ - begin_ >= want || eof_) return;
+            if (begin_ > 0) {
+                memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+                end_ -= begin_;
+                begin_ = 0;
+            }
+            if (buffer_.size() < want) buffer_.resize(want);
+            while (end_ < buffer_.size() && !eof_) {
+                const size_t got = fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+                if (got == 0) eof_ = true;
+                end_ += got;
+            }
+        }
+
+        bool next_frame() {
+            while (true) {
+                if (info_.exact && decoded_ >= static_cast<uint64_t>(info_.frames)) return finished();
+                fill(frame_cap_);
+                const size_t available = end_ - begin_;
+                if (available == 0) return finished();
+
+                size_t consumed = 0;
+                uint32_t header_block = 0;
+                const FrameResult result = decode(buffer_.data() + begin_, available, &consumed, &header_block);
+                if (result == FRAME_OK) {
+                    begin_ += consumed;
+                    return true;
+                }
+                if (result == FRAME_SHORT && !eof_ && frame_cap_ < kMaxFrameBytes) {
+                    // A frame larger than STREAMINFO promised; make room and try again
+                    frame_cap_ = std::min(frame_cap_ * 2, kMaxFrameBytes);
+                    continue;
+                }
+                if (result == FRAME_SHORT && eof_) {
+                    begin_ = end_;
+                    return finished();
+                }
+
+                ++damaged_frames_;
+                resync();
+                if (header_block > 0 && header_block <= max_block_) {
+                    // Keep the timeline: the damaged frame plays as silence
+                    std::fill(mono_.begin(), mono_.begin() + header_block, 0.0f);
+                    block_size_ = header_block;
+                    block_pos_ = 0;
+                    decoded_ += header_block;
+                    return true;
+                }
+            }
+        }
+
+        bool finished() {
+            if (info_.exact && decoded_ < static_cast<uint64_t>(info_.frames)) {
+                LOGW("FLAC stream ends %llu frames early",
+                     static_cast<unsigned long long>(static_cast<uint64_t>(info_.frames) - decoded_));
+                failed_ = true;
+            }
+            if (damaged_frames_ > 0) LOGW("%u damaged FLAC frames replaced by silence", damaged_frames_);
+            return false;
+        }
+
+        /** Skip to the next frame sync code after the current position. */
+        void resync() {
+            begin_ = std::min(begin_ + 1, end_);
+            while (true) {
+                for (; begin_ + 1 < end_; ++begin_) {
+                    if (buffer_[begin_] == 0xff && (buffer_[begin_ + 1] & 0xfe) == 0xf8) return;
+                }
+                if (eof_) {
+                    begin_ = end_;
+                    return;
+                }
+                fill(end_ - begin_ + 64 * 1024);
+            }
+        }
+
+        FrameResult decode(const uint8_t* p, size_t available, size_t* consumed, uint32_t* header_block) {
+            if (available < 2) return FRAME_SHORT;
+            if (p[0] != 0xff || (p[1] & 0xfe) != 0xf8) return FRAME_BAD;
+
+            BitReader bits(p, available);
+            bits.read(16);
+            const uint32_t block_code = bits.read(4);
+            const uint32_t rate_code = bits.read(4);
+            const uint32_t assignment = bits.read(4);
+            const uint32_t size_code = bits.read(3);
+            bits.read(1);
+
+            // Frame or sample number, UTF-8 style; only its length matters here
+            const uint32_t lead = bits.read(8);
+            int extra = 0;
+            if (lead >= 0x80) {
+                if (lead < 0xc0 || lead == 0xff) return FRAME_BAD;
+                for (uint32_t mask = 0x40; (lead & mask) != 0; mask >>= 1) ++extra;
+            }
+            for (int i = 0; i < extra; ++i) {
+                if ((bits.read(8) & 0xc0) != 0x80) return FRAME_BAD;
+            }
+
+            uint32_t block;
+            if (block_code == 0) return FRAME_BAD;
+            else if (block_code == 1) block = 192;
+            else if (block_code <= 5) block = 576u << (block_code - 2);
+            else if (block_code == 6) block = bits.read(8) + 1;
+            else if (block_code == 7) block = bits.read(16) + 1;
+            else block = 256u << (block_code - 8);
+
+            if (rate_code == 12) bits.read(8);
+            else if (rate_code == 13 || rate_code == 14) bits.read(16);
+            else if (rate_code == 15) return FRAME_BAD;
+
+            static const int32_t kSampleSizes[8] = {0, 8, 12, -1, 16, 20, 24, -1};
+            const int32_t bps = size_code == 0 ? info_.bits_per_sample : kSampleSizes[size_code];
+            if (bps != info_.bits_per_sample) return FRAME_BAD;
+
+            const int32_t channels = assignment < 8 ? static_cast<int32_t>(assignment) + 1 : 2;
+            if (assignment > 10 || channels != info_.channels) return FRAME_BAD;
+
+            if (bits.overrun()) return FRAME_SHORT;
+            const size_t header_bytes = bits.bytes_consumed();
+            if (header_bytes >= available) return FRAME_SHORT;
+            if (crc8(p, header_bytes) != bits.read(8)) return FRAME_BAD;
+            *header_block = block;
+            if (block > max_block_) return FRAME_BAD;
+
+            for (int32_t c = 0; c < channels; ++c) {
+                const bool side = (assignment == 8 && c == 1) || (assignment == 9 && c == 0) || (assignment == 10 && c == 1);
+                if (!decode_subframe(bits, bps + (side ? 1 : 0), block, samples_[c].data())) {
+                    return bits.overrun() ? FRAME_SHORT : FRAME_BAD;
+                }
+            }
+            bits.align();
+            const size_t frame_bytes = bits.bytes_consumed();
+            if (bits.overrun() || frame_bytes + 2 > available) return FRAME_SHORT;
+            const uint16_t expected = static_cast<uint16_t>((p[frame_bytes] << 8) | p[frame_bytes + 1]);
+            if (crc16(p, frame_bytes) != expected) return FRAME_BAD;
+
+            decorrelate(assignment, block);
+            downmix(channels, block);
+            block_size_ = block;
+            block_pos_ = 0;
+            decoded_ += block;
+            *consumed = frame_bytes + 2;
+            return FRAME_OK;
+        }
+
+        bool decode_subframe(BitReader& bits, int32_t bps, uint32_t block, int32_t* out) {
+            if (bits.read(1) != 0) return false;
+            const uint32_t type = bits.read(6);
+            uint32_t wasted = 0;
+            if (bits.read(1) != 0) {
+                wasted = bits.unary() + 1;
+                if (static_cast<int32_t>(wasted) >= bps) return false;
+                bps -= static_cast<int32_t>(wasted);
+            }
+
+            if (type == 0) {
+                std::fill(out, out + block, bits.read_signed(bps));
+            } else if (type == 1) {
+                for (uint32_t i = 0; i < block; ++i) out[i] = bits.read_signed(bps);
+            } else if (type >= 8 && type <= 12) {
+                const uint32_t order = type - 8;
+                if (order > block) return false;
+                for (uint32_t i = 0; i < order; ++i) out[i] = bits.read_signed(bps);
+                if (!decode_residual(bits, block, order, out)) return false;
+                restore_fixed(order, block, out);
+            } else if (type >= 32) {
+                const uint32_t order = type - 31;
+                if (order > block) return false;
+                for (uint32_t i = 0; i < order; ++i) out[i] = bits.read_signed(bps);
+                const int precision = static_cast<int>(bits.read(4)) + 1;
+                if (precision == 16) return false;
+                const int32_t shift = bits.read_signed(5);
+                if (shift < 0) return false;
+                int32_t coefs[32];
+                for (uint32_t i = 0; i < order; ++i) coefs[i] = bits.read_signed(precision);
+                if (!decode_residual(bits, block, order, out)) return false;
+                restore_lpc(coefs, order, shift, block, out);
+            } else {
+                return false;
+            }
+
+            if (wasted > 0) {
+                for (uint32_t i = 0; i < block; ++i) out[i] = static_cast<int32_t>(static_cast<uint32_t>(out[i]) << wasted);
+            }
+            return !bits.overrun();
+        }
+
+        /** Rice-coded residual into out[order, block). */
+        static bool decode_residual(BitReader& bits, uint32_t block, uint32_t order, int32_t* out) {
+            const uint32_t method = bits.read(2);
+            if (method > 1) return false;
+            const int param_bits = method == 0 ? 4 : 5;
+            const uint32_t escape = method == 0 ? 15 : 31;
+            const uint32_t partition_order = bits.read(4);
+            const uint32_t partition = block >> partition_order;
+            if ((partition << partition_order) != block || partition < order) return false;
+
+            uint32_t i = order;
+            for (uint32_t p = 0; p < (1u << partition_order); ++p) {
+                const uint32_t k = bits.read(param_bits);
+                const uint32_t end = (p + 1) * partition;
+                if (k == escape) {
+                    const int raw = static_cast<int>(bits.read(5));
+                    for (; i < end; ++i) out[i] = bits.read_signed(raw);
+                } else {
+                    for (; i < end; ++i) {
+                        const uint32_t v = (bits.unary() << k) | bits.read(static_cast<int>(k));
+                        out[i] = static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+                    }
+                }
+                if (bits.overrun()) return false;
+            }
+            return true;
+        }
+
+        static void restore_fixed(uint32_t order, uint32_t block, int32_t* s) {
+            switch (order) {
+                case 1:
+                    for (uint32_t i = 1; i < block; ++i) s[i] += s[i - 1];
+                    break;
+                case 2:
+                    for (uint32_t i = 2; i < block; ++i) s[i] += 2 * s[i - 1] - s[i - 2];
+                    break;
+                case 3:
+                    for (uint32_t i = 3; i < block; ++i) s[i] += 3 * (s[i - 1] - s[i - 2]) + s[i - 3];
+                    break;
+                case 4:
+                    for (uint32_t i = 4; i < block; ++i) s[i] += 4 * (s[i - 1] + s[i - 3]) - 6 * s[i - 2] - s[i - 4];
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        static void restore_lpc(const int32_t* coefs, uint32_t order, int32_t shift, uint32_t block, int32_t* s) {
+            for (uint32_t i = order; i < block; ++i) {
+                int64_t sum = 0;
+                for (uint32_t j = 0; j < order; ++j) sum += static_cast<int64_t>(coefs[j]) * s[i - 1 - j];
+                s[i] += static_cast<int32_t>(sum >> shift);
+            }
+        }
+
+        void decorrelate(uint32_t assignment, uint32_t block) {
+            int32_t* a = samples_[0].data();
+            int32_t* b = samples_[1].data();
+            if (assignment == 8) {
+                for (uint32_t i = 0; i < block; ++i) b[i] = a[i] - b[i];
+            } else if (assignment == 9) {
+                for (uint32_t i = 0; i < block; ++i) a[i] += b[i];
+            } else if (assignment == 10) {
+                for (uint32_t i = 0; i < block; ++i) {
+                    const int32_t mid = static_cast<int32_t>(static_cast<uint32_t>(a[i]) << 1) | (b[i] & 1);
+                    a[i] = (mid + b[i]) >> 1;
+                    b[i] = (mid - b[i]) >> 1;
+                }
+            }
+        }
+
+        void downmix(int32_t channels, uint32_t block) {
+            if (channels == 1) {
+                const int32_t* s = samples_[0].data();
+                for (uint32_t i = 0; i < block; ++i) mono_[i] = static_cast<float>(s[i]) / divisor_;
+                return;
+            }
+            for (uint32_t i = 0; i < block; ++i) {
+                int32_t sum = 0;
+                for (int32_t c = 0; c < channels; ++c) sum += samples_[c][i];
+                mono_[i] = static_cast<float>(sum) / divisor_;
+            }
+        }
+
+        FILE* file_;
+        uint32_t max_block_ = 0;
+        uint32_t max_frame_bytes_ = 0;
+        float divisor_ = 1.0f;
+        size_t frame_cap_ = 0;
+        std::vector<uint8_t> buffer_;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+        bool eof_ = false;
+        std::vector<int32_t> samples_[8];
+        std::vector<float> mono_;
+        size_t block_size_ = 0;
+        size_t block_pos_ = 0;
+        uint64_t decoded_ = 0;
+        uint32_t damaged_frames_ = 0;
+    };
+
+#ifdef __ANDROID__
+    // ---- Platform codecs ----
+
+    constexpr int64_t kDequeueTimeoutUs = 10000;
+    constexpr int kMaxIdlePolls = 500;       // 5 s without output: the codec is stuck
+
+    /** AAC, Opus, Vorbis, MP3, AMR through NDK MediaExtractor + MediaCodec, in synchronous mode. */
+    class MediaCodecDecoder : public AudioDecoder {
+    public:
+        ~MediaCodecDecoder() override {
+            if (codec_ != nullptr) {
+                AMediaCodec_stop(codec_);
+                AMediaCodec_delete(codec_);
+            }
+            if (extractor_ != nullptr) AMediaExtractor_delete(extractor_);
+            if (fd_ >= 0) close(fd_);
+        }
+
+        bool open(const char* path, AudioFormat format, std::string* error) {
+            fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+            struct stat st;
+            if (fd_ < 0 || fstat(fd_, &st) != 0) {
+                set_error(error, "cannot open file");
+                return false;
+            }
+            extractor_ = AMediaExtractor_new();
+            if (AMediaExtractor_setDataSourceFd(extractor_, fd_, 0, st.st_size) != AMEDIA_OK) {
+                set_error(error, "platform extractor rejected the file");
+                return false;
+            }
+
+            const size_t tracks = AMediaExtractor_getTrackCount(extractor_);
+            for (size_t t = 0; t < tracks && codec_ == nullptr; ++t) {
+                AMediaFormat* track = AMediaExtractor_getTrackFormat(extractor_, t);
+                const char* mime = nullptr;
+                if (AMediaFormat_getString(track, AMEDIAFORMAT_KEY_MIME, &mime) && strncmp(mime, "audio/", 6) == 0) {
+                    codec_ = AMediaCodec_createDecoderByType(mime);
+                    if (codec_ != nullptr && AMediaCodec_configure(codec_, track, nullptr, nullptr, 0) == AMEDIA_OK &&
+                        AMediaCodec_start(codec_) == AMEDIA_OK) {
+                        AMediaExtractor_selectTrack(extractor_, t);
+                        AMediaFormat_getInt32(track, AMEDIAFORMAT_KEY_SAMPLE_RATE, &info_.sample_rate);
+                        AMediaFormat_getInt32(track, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &info_.channels);
+                        int64_t duration_us = 0;
+                        if (AMediaFormat_getInt64(track, AMEDIAFORMAT_KEY_DURATION, &duration_us) && duration_us > 0) {
+                            info_.frames = duration_us * info_.sample_rate / 1000000;
+                        }
+                        LOGD("Decoding %s track %zu: %d Hz, %d channels", mime, t, info_.sample_rate, info_.channels);
+                    } else if (codec_ != nullptr) {
+                        AMediaCodec_delete(codec_);
+                        codec_ = nullptr;
+                    }
+                }
+                AMediaFormat_delete(track);
+            }
+            if (codec_ == nullptr) {
+                set_error(error, "no decodable audio track");
+                return false;
+            }
+            info_.format = format;
+
+            // HE-AAC and friends report their real rate and layout only with the first output
+            if (!decode_more() && failed_) {
+                set_error(error, "platform decoder produced no audio");
+                return false;
+            }
+            return info_.sample_rate > 0 && info_.channels > 0;
+        }
+
+        size_t read(float* out, size_t n) override {
+            size_t done = 0;
+            while (done < n) {
+                if (pending_pos_ == pending_.size() && !decode_more()) break;
+                const size_t take = std::min(n - done, pending_.size() - pending_pos_);
+                memcpy(out + done, pending_.data() + pending_pos_, take * sizeof(float));
+                pending_pos_ += take;
+                done += take;
+            }
+            return done;
+        }
+
+    private:
+        /** Run the codec until it hands out PCM; false at the end of the stream. */
+        bool decode_more() {
+            pending_.clear();
+            pending_pos_ = 0;
+            int idle = 0;
+            while (pending_.empty() && !output_done_) {
+                if (!input_done_) feed_input();
+
+                AMediaCodecBufferInfo meta;
+                const ssize_t index = AMediaCodec_dequeueOutputBuffer(codec_, &meta, kDequeueTimeoutUs);
+                if (index >= 0) {
+                    size_t capacity = 0;
+                    const uint8_t* data = AMediaCodec_getOutputBuffer(codec_, static_cast<size_t>(index), &capacity);
+                    if (data != nullptr && meta.size > 0) append_pcm(data + meta.offset, static_cast<size_t>(meta.size));
+                    AMediaCodec_releaseOutputBuffer(codec_, static_cast<size_t>(index), false);
+                    if ((meta.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0) output_done_ = true;
+                    idle = 0;
+                } else if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+                    read_output_format();
+                } else if (index == AMEDIACODEC_INFO_TRY_AGAIN_LATER) {
+                    if (++idle > kMaxIdlePolls) {
+                        LOGE("Platform decoder stalled");
+                        failed_ = true;
+                        return false;
+                    }
+                } else if (index != AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+                    LOGE("Platform decoder error %zd", index);
+                    failed_ = true;
+                    return false;
+                }
+            }
+            return !pending_.empty();
+        }
+
+        void feed_input() {
+            const ssize_t index = AMediaCodec_dequeueInputBuffer(codec_, 0);
+            if (index < 0) return;
+            size_t capacity = 0;
+            uint8_t* buffer = AMediaCodec_getInputBuffer(codec_, static_cast<size_t>(index), &capacity);
+            const ssize_t size = buffer != nullptr ? AMediaExtractor_readSampleData(extractor_, buffer, capacity) : -1;
+            if (size < 0) {
+                AMediaCodec_queueInputBuffer(codec_, static_cast<size_t>(index), 0, 0, 0, AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+                input_done_ = true;
+                return;
+            }
+            const int64_t time_us = AMediaExtractor_getSampleTime(extractor_);
+            AMediaCodec_queueInputBuffer(codec_, static_cast<size_t>(index), 0, static_cast<size_t>(size),
+                                         static_cast<uint64_t>(std::max<int64_t>(0, time_us)), 0);
+            AMediaExtractor_advance(extractor_);
+        }
+
+        void read_output_format() {
+            AMediaFormat* format = AMediaCodec_getOutputFormat(codec_);
+            if (format == nullptr) return;
+            int32_t rate = 0;
+            int32_t channels = 0;
+            int32_t encoding = 2;
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &rate);
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &channels);
+            // AMEDIAFORMAT_KEY_PCM_ENCODING needs API 28; the key itself is older
+            AMediaFormat_getInt32(format, "pcm-encoding", &encoding);
+            AMediaFormat_delete(format);
+
+            if (rate > 0 && rate != info_.sample_rate) {
+                if (started_) LOGW("Output rate changed mid-stream: %d -> %d Hz", info_.sample_rate, rate);
+                if (info_.frames > 0 && info_.sample_rate > 0) info_.frames = info_.frames * rate / info_.sample_rate;
+                if (!started_) info_.sample_rate = rate;
+            }
+            if (channels > 0) info_.channels = channels;
+            float_pcm_ = encoding == 4;
+        }
+
+        void append_pcm(const uint8_t* data, size_t bytes) {
+            started_ = true;
+            const size_t channels = static_cast<size_t>(std::max(1, info_.channels));
+            const size_t sample_bytes = float_pcm_ ? sizeof(float) : sizeof(int16_t);
+            const size_t frames = bytes / (sample_bytes * channels);
+            const float divisor = (float_pcm_ ? 1.0f : 32768.0f) * static_cast<float>(channels);
+            const size_t base = pending_.size();
+            pending_.resize(base + frames);
+            for (size_t f = 0; f < frames; ++f) {
+                float sum = 0.0f;
+                for (size_t c = 0; c < channels; ++c) {
+                    const uint8_t* p = data + (f * channels + c) * sample_bytes;
+                    if (float_pcm_) {
+                        float s;
+                        memcpy(&s, p, sizeof(s));
+                        sum += s;
+                    } else {
+                        int16_t s;
+                        memcpy(&s, p, sizeof(s));
+                        sum += static_cast<float>(s);
+                    }
+                }
+                pending_[base + f] = sum / divisor;
+            }
+        }
+
+        int fd_ = -1;
+        AMediaExtractor* extractor_ = nullptr;
+        AMediaCodec* codec_ = nullptr;
+        bool input_done_ = false;
+        bool output_done_ = false;
+        bool started_ = false;
+        bool float_pcm_ = false;
+        std::vector<float> pending_;
+        size_t pending_pos_ = 0;
+    };
+#endif
+}
+
+const char* audio_format_name(AudioFormat format) {
+    switch (format) {
+        case AUDIO_WAV: return "wav";
+        case AUDIO_FLAC: return "flac";
+        case AUDIO_MP4: return "mp4";
+        case AUDIO_OGG: return "ogg";
+        case AUDIO_MP3: return "mp3";
+        case AUDIO_ADTS: return "aac";
+        case AUDIO_AMR: return "amr";
+        default: return "unknown";
+    }
+}
+
+AudioFormat sniff_audio_format(const uint8_t* head, size_t n) {
+    if (n >= 12 && memcmp(head, "RIFF", 4) == 0 && memcmp(head + 8, "WAVE", 4) == 0) return AUDIO_WAV;
+    if (n >= 4 && memcmp(head, "fLaC", 4) == 0) return AUDIO_FLAC;
+    if (n >= 4 && memcmp(head, "OggS", 4) == 0) return AUDIO_OGG;
+    if (n >= 8 && memcmp(head + 4, "ftyp", 4) == 0) return AUDIO_MP4;
+    if (n >= 6 && memcmp(head, "#!AMR", 5) == 0) return AUDIO_AMR;
+    if (n >= 10 && memcmp(head, "ID3", 3) == 0) return AUDIO_MP3;     // tag not skipped: assume MPEG audio
+    if (n >= 2 && head[0] == 0xff && (head[1] & 0xe0) == 0xe0) {
+        // Layer bits 00 mark an ADTS header; anything else is an MPEG audio frame
+        return (head[1] & 0x06) == 0 ? AUDIO_ADTS : AUDIO_MP3;
+    }
+    return AUDIO_UNKNOWN;
+}
+
+std::unique_ptr<AudioDecoder> open_audio_decoder(const char* path, std::string* error) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        set_error(error, "cannot open file");
+        return nullptr;
+    }
+    uint8_t head[16];
+    size_t n = fread(head, 1, sizeof(head), file);
+    const long offset = id3_size(head, n);
+    if (offset > 0) {
+        // FLAC and MP3 files from tag editors start with an ID3v2 tag
+        n = fseek(file, offset, SEEK_SET) == 0 ? fread(head, 1, sizeof(head), file) : 0;
+    }
+    const AudioFormat format = sniff_audio_format(head, n);
+
+    if (format == AUDIO_WAV && offset == 0) {
+        rewind(file);
+        auto decoder = std::make_unique<WavDecoder>(file);
+        if (!decoder->open(error)) return nullptr;
+        return decoder;
+    }
+    if (format == AUDIO_FLAC) {
+        auto decoder = std::make_unique<FlacDecoder>(file);
+        if (!decoder->open(offset, error)) return nullptr;
+        return decoder;
+    }
+    fclose(file);
+    if (format == AUDIO_UNKNOWN || format == AUDIO_WAV) {
+        set_error(error, "unrecognized audio format");
+        return nullptr;
+    }
+#ifdef __ANDROID__
+    auto decoder = std::make_unique<MediaCodecDecoder>();
+    if (!decoder->open(path, format, error)) return nullptr;
+    return decoder;
+#else
+    set_error(error, std::string(audio_format_name(format)) + " needs the platform decoder (Android only)");
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<AudioFileStream> AudioFileStream::open(const char* path, int32_t sample_rate, std::string* error) {
+    std::unique_ptr<AudioDecoder> decoder = open_audio_decoder(path, error);
+    if (!decoder) return nullptr;
+    return std::make_unique<AudioFileStream>(std::move(decoder), sample_rate);
+}
+
+AudioFileStream::AudioFileStream(std::unique_ptr<AudioDecoder> decoder, int32_t sample_rate)
+    : decoder_(std::move(decoder)), sample_rate_(std::max(1, sample_rate)) {
+    const AudioStreamInfo& info = decoder_->info();
+    if (info.sample_rate != sample_rate_) {
+        resampler_ = std::make_unique<Resampler>(info.sample_rate, sample_rate_);
+        decoded_.resize(kChunkFrames);
+    }
+    if (info.frames >= 0) frames_ = output_length(info.frames);
+}
+
+int64_t AudioFileStream::output_length(int64_t source_frames) const {
+    const int64_t in_rate = decoder_->info().sample_rate;
+    if (!resampler_ || in_rate <= 0) return source_frames;
+    return (source_frames * sample_rate_ + in_rate - 1) / in_rate;
+}
+
+size_t AudioFileStream::read(float* out, size_t n) {
+    size_t done = 0;
+    if (!resampler_) {
+        // Already at the output rate: decode straight into the caller's buffer
+        while (done < n) {
+            const size_t got = decoder_->read(out + done, n - done);
+            if (got == 0) break;
+            done += got;
+        }
+        if (done < n) frames_ = position_ + static_cast<int64_t>(done);
+    } else {
+        while (done < n) {
+            if (pending_pos_ == pending_.size() && !refill()) break;
+            const size_t take = std::min(n - done, pending_.size() - pending_pos_);
+            std::copy(pending_.begin() + static_cast<std::ptrdiff_t>(pending_pos_),
+                      pending_.begin() + static_cast<std::ptrdiff_t>(pending_pos_ + take), out + done);
+            pending_pos_ += take;
+            done += take;
+        }
+    }
+    position_ += static_cast<int64_t>(done);
+    return done;
+}
+
+size_t AudioFileStream::skip(size_t n) {
+    float scratch[4096];
+    size_t done = 0;
+    while (done < n) {
+        const size_t got = read(scratch, std::min(n - done, sizeof(scratch) / sizeof(scratch[0])));
+        if (got == 0) break;
+        done += got;
+    }
+    return done;
+}
+
+bool AudioFileStream::refill() {
+    pending_.clear();
+    pending_pos_ = 0;
+    while (pending_.empty() && !flushed_) {
+        size_t got = decoder_->read(decoded_.data(), decoded_.size());
+        source_read_ += static_cast<int64_t>(got);
+        if (got == 0) {
+            // Push zeros through the filter delay so the last input comes out, then cut at the true length
+            got = std::min(decoded_.size(), static_cast<size_t>(resampler_->half_taps()) + 1);
+            std::fill(decoded_.begin(), decoded_.begin() + static_cast<std::ptrdiff_t>(got), 0.0f);
+            flushed_ = true;
+            frames_ = output_length(source_read_);
+        }
+        pending_.resize(resampler_->max_output(got));
+        const size_t produced = resampler_->process(decoded_.data(), got, pending_.data(), pending_.size());
+        resampled_ += static_cast<int64_t>(produced);
+        size_t keep = produced;
+        if (flushed_) {
+            const int64_t excess = resampled_ - frames_;
+            if (excess > 0) keep -= std::min(produced, static_cast<size_t>(excess));
+        }
+        pending_.resize(keep);
+    }
+    return !pending_.empty();
+}
+
+bool read_audio_mono_float(const char* path, int32_t sample_rate, Arena& arena, float** out, size_t* n) {
+    std::unique_ptr<AudioFileStream> stream = AudioFileStream::open(path, sample_rate);
+    if (!stream) return false;
+
+    if (stream->source().exact && stream->frames() >= 0) {
+        const auto total = static_cast<size_t>(stream->frames());
+        float* samples = arena.alloc<float>(std::max<size_t>(total, 1));
+        *n = stream->read(samples, total);
+        *out = samples;
+        return !stream->failed();
+    }
+
+    // Length unknown or estimated: collect in chunks, then copy once
+    std::vector<float> all;
+    std::vector<float> chunk(kChunkFrames);
+    size_t got;
+    while ((got = stream->read(chunk.data(), chunk.size())) > 0) all.insert(all.end(), chunk.begin(), chunk.begin() + got);
+    float* samples = arena.alloc<float>(std::max<size_t>(all.size(), 1));
+    std::copy(all.begin(), all.end(), samples);
+    *out = samples;
+    *n = all.size();
+    return !stream->failed();
+}
+
+} // namespace assistant
@@ -0,0 +1,142 @@
+/**
+ * audio_decoder.h - Streaming decoders for imported audio files
+ *
+ * Shared voice notes arrive as m4a (AAC), Ogg/Opus, MP3, FLAC or WAV in
+ * any sample rate and channel layout. A decoder reads its file in small
+ * chunks and hands out mono float frames at the file's own rate; it holds
+ * one compressed frame and one decoded block at a time, so an hour-long
+ * file needs no more memory than a short one.
+ *
+ * WAV (8/16/24/32-bit PCM, 32/64-bit float) and FLAC are decoded here.
+ * AAC, Opus, Vorbis and MP3 go through the platform codecs (NDK
+ * MediaExtractor + MediaCodec) on Android and cannot be opened on host
+ * builds.
+ *
+ * AudioFileStream puts a Resampler behind the decoder and yields mono
+ * frames at the rate whisper runs at, in whatever chunk size the caller
+ * asks for.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "resampler.h"
+
+namespace assistant {
+
+enum AudioFormat : int32_t {
+    AUDIO_UNKNOWN = 0,
+    AUDIO_WAV,
+    AUDIO_FLAC,
+    AUDIO_MP4,      // m4a/mp4/3gp: AAC, sometimes ALAC or AMR
+    AUDIO_OGG,      // Opus, Vorbis or FLAC
+    AUDIO_MP3,
+    AUDIO_ADTS,     // raw AAC
+    AUDIO_AMR,
+};
+
+const char* audio_format_name(AudioFormat format);
+
+/** Container of a file from its first bytes (after any ID3v2 tag); AUDIO_UNKNOWN if none matches. */
+AudioFormat sniff_audio_format(const uint8_t* head, size_t n);
+
+struct AudioStreamInfo {
+    AudioFormat format = AUDIO_UNKNOWN;
+    int32_t sample_rate = 0;
+    int32_t channels = 0;
+    int32_t bits_per_sample = 0;    // 0 for lossy formats
+    int64_t frames = -1;            // total at sample_rate; -1 if unknown
+    bool exact = false;             // frames is a count, not an estimate from the duration
+};
+
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() = default;
+
+    const AudioStreamInfo& info() const { return info_; }
+
+    /**
+     * Decode up to `n` further frames, downmixed to mono floats in [-1, 1);
+     * returns the count, 0 at the end of the stream or on an error.
+     */
+    virtual size_t read(float* out, size_t n) = 0;
+
+    /** True once read() stopped because the file is damaged or unreadable rather than at its end. */
+    bool failed() const { return failed_; }
+
+protected:
+    AudioStreamInfo info_;
+    bool failed_ = false;
+};
+
+/**
+ * Open `path` with the decoder its first bytes call for. Returns nullptr,
+ * with the reason in `error`, for unreadable files and for formats this
+ * build cannot decode.
+ */
+std::unique_ptr<AudioDecoder> open_audio_decoder(const char* path, std::string* error = nullptr);
+
+/** Mono frames of any decodable file at a fixed rate, in chunks of the caller's choosing. */
+class AudioFileStream {
+public:
+    static std::unique_ptr<AudioFileStream> open(const char* path, int32_t sample_rate,
+                                                 std::string* error = nullptr);
+
+    explicit AudioFileStream(std::unique_ptr<AudioDecoder> decoder, int32_t sample_rate);
+
+    const AudioStreamInfo& source() const { return decoder_->info(); }
+    int32_t sample_rate() const { return sample_rate_; }
+
+    /** Frames the whole file yields at sample_rate(); -1 if the decoder cannot tell. */
+    int64_t frames() const { return frames_; }
+
+    /** Frames handed out so far. */
+    int64_t position() const { return position_; }
+
+    /** Fill `out` with the next `n` frames; fewer only at the end of the stream. */
+    size_t read(float* out, size_t n);
+
+    /**
+     * Step over the next `n` frames, e.g. to resume partway through a
+     * file; returns the count. They are decoded and dropped, so what
+     * follows is exactly what read() would have returned after them.
+     */
+    size_t skip(size_t n);
+
+    bool failed() const { return decoder_->failed(); }
+
+private:
+    /** Decode and resample the next chunk into pending_; false once nothing is left. */
+    bool refill();
+
+    /** Output frames for `source_frames` input frames. */
+    int64_t output_length(int64_t source_frames) const;
+
+    std::unique_ptr<AudioDecoder> decoder_;
+    int32_t sample_rate_;
+    std::unique_ptr<Resampler> resampler_;  // null when the file is already at sample_rate_
+    std::vector<float> decoded_;
+    std::vector<float> pending_;
+    size_t pending_pos_ = 0;
+    int64_t frames_ = -1;
+    int64_t position_ = 0;
+    int64_t source_read_ = 0;               // source frames decoded so far
+    int64_t resampled_ = 0;                 // frames out of the resampler, before trimming its tail
+    bool flushed_ = false;
+};
+
+/**
+ * Decode a whole file to mono floats at `sample_rate`, allocated from
+ * `arena` (e.g. a short clip for a voice query). The decoder's own
+ * buffers come from the heap; 16 kHz WAV on a hot path should keep using
+ * read_wav_mono_float.
+ */
+bool read_audio_mono_float(const char* path, int32_t sample_rate, Arena& arena, float** out, size_t* n);
+
+} // namespace assistant
@@ -0,0 +1,132 @@
+/**
+ * audio_features.cpp - Streaming log-mel / MFCC front-end
+ */
+
+#include "audio_features.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace assistant {
+
+namespace {
+    float hz_to_mel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+    float mel_to_hz(float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+    size_t next_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+FeatureFrontend::FeatureFrontend(const FeatureConfig& config)
+    : config_(config),
+      frame_len_(config.sample_rate * config.frame_ms / 1000),
+      hop_len_(config.sample_rate * config.hop_ms / 1000),
+      fft_len_(next_pow2(static_cast<size_t>(frame_len_))),
+      fft_(fft_len_),
+      ring_(frame_len_, 0.0f),
+      window_(frame_len_),
+      frame_(fft_len_, 0.0f),
+      spectrum_(fft_len_ / 2 + 1),
+      scratch_(fft_len_),
+      power_(fft_len_ / 2 + 1),
+      log_mel_(config.n_mels),
+      features_(config.n_mfcc > 0 ? config.n_mfcc : config.n_mels) {
+
+    for (int32_t i = 0; i < frame_len_; ++i) {
+        window_[i] = 0.5f - 0.5f * std::cos(2.0f * static_cast<float>(M_PI) * i / (frame_len_ - 1));
+    }
+
+    // Triangular filters equally spaced on the mel scale
+    const float fmax = std::min(config.fmax, config.sample_rate / 2.0f);
+    const float mel_lo = hz_to_mel(config.fmin);
+    const float mel_hi = hz_to_mel(fmax);
+    const int32_t n_bins = static_cast<int32_t>(fft_len_ / 2 + 1);
+    const float bin_hz = static_cast<float>(config.sample_rate) / static_cast<float>(fft_len_);
+
+    mel_start_.resize(config.n_mels);
+    mel_weights_.resize(config.n_mels);
+    for (int32_t m = 0; m < config.n_mels; ++m) {
+        const float left = mel_to_hz(mel_lo + (mel_hi - mel_lo) * m / (config.n_mels + 1));
+        const float center = mel_to_hz(mel_lo + (mel_hi - mel_lo) * (m + 1) / (config.n_mels + 1));
+        const float right = mel_to_hz(mel_lo + (mel_hi - mel_lo) * (m + 2) / (config.n_mels + 1));
+
+        int32_t first = -1;
+        std::vector<float>& weights = mel_weights_[m];
+        for (int32_t b = 0; b < n_bins; ++b) {
+            const float hz = b * bin_hz;
+            float w = 0.0f;
+            if (hz > left && hz <= center) w = (hz - left) / (center - left);
+            else if (hz > center && hz < right) w = (right - hz) / (right - center);
+            if (w <= 0.0f) {
+                if (first >= 0) break;
+                continue;
+            }
+            if (first < 0) first = b;
+            weights.push_back(w);
+        }
+        // Narrow low-frequency filters can fall between bins; use the nearest one
+        if (first < 0) {
+            first = std::min(n_bins - 1, static_cast<int32_t>(std::lround(center / bin_hz)));
+            weights.push_back(1.0f);
+        }
+        mel_start_[m] = first;
+    }
+
+    if (config.n_mfcc > 0) {
+        dct_.resize(static_cast<size_t>(config.n_mfcc) * config.n_mels);
+        const float norm0 = std::sqrt(1.0f / config.n_mels);
+        const float norm = std::sqrt(2.0f / config.n_mels);
+        for (int32_t k = 0; k < config.n_mfcc; ++k) {
+            for (int32_t m = 0; m < config.n_mels; ++m) {
+                dct_[k * config.n_mels + m] = (k == 0 ? norm0 : norm) *
+                    std::cos(static_cast<float>(M_PI) * k * (m + 0.5f) / config.n_mels);
+            }
+        }
+    }
+}
+
+void FeatureFrontend::reset() {
+    std::fill(ring_.begin(), ring_.end(), 0.0f);
+    ring_pos_ = 0;
+    filled_ = 0;
+    since_hop_ = 0;
+}
+
+float FeatureFrontend::compute_frame() {
+    // Linearize the ring (oldest sample first) and apply the window
+    float energy = 0.0f;
+    for (int32_t i = 0; i < frame_len_; ++i) {
+        const float s = ring_[(ring_pos_ + i) % frame_len_];
+        energy += s * s;
+        frame_[i] = s * window_[i];
+    }
+
+    fft_.forward_real(frame_.data(), spectrum_.data(), scratch_.data());
+    for (size_t b = 0; b < power_.size(); ++b) power_[b] = std::norm(spectrum_[b]);
+
+    for (int32_t m = 0; m < config_.n_mels; ++m) {
+        const std::vector<float>& weights = mel_weights_[m];
+        const float* p = power_.data() + mel_start_[m];
+        float sum = 0.0f;
+        for (size_t w = 0; w < weights.size(); ++w) sum += weights[w] * p[w];
+        log_mel_[m] = std::log(sum + 1e-6f);
+    }
+
+    if (config_.n_mfcc > 0) {
+        for (int32_t k = 0; k < config_.n_mfcc; ++k) {
+            const float* row = dct_.data() + static_cast<size_t>(k) * config_.n_mels;
+            float acc = 0.0f;
+            for (int32_t m = 0; m < config_.n_mels; ++m) acc += row[m] * log_mel_[m];
+            features_[k] = acc;
+        }
+    } else {
+        std::copy(log_mel_.begin(), log_mel_.end(), features_.begin());
+    }
+
+    return 10.0f * std::log10(energy / frame_len_ + 1e-10f);
+}
+
+} // namespace assistant
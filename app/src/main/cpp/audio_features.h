@@ -0,0 +1,88 @@
+/**
+ * audio_features.h - Streaming log-mel / MFCC front-end
+ *
+ * Consumes 16-bit PCM in arbitrary chunk sizes and emits one feature
+ * vector per hop. All buffers are sized in the constructor so push() is
+ * allocation-free, which matters for the always-on wake word path.
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace assistant {
+
+struct FeatureConfig {
+    int32_t sample_rate = 16000;
+    int32_t frame_ms = 30;
+    int32_t hop_ms = 20;
+    int32_t n_mels = 40;
+    int32_t n_mfcc = 10;      // 0 = emit log-mel energies instead of MFCCs
+    float fmin = 20.0f;
+    float fmax = 4000.0f;
+};
+
+class FeatureFrontend {
+public:
+    explicit FeatureFrontend(const FeatureConfig& config);
+
+    const FeatureConfig& config() const { return config_; }
+    int32_t feature_dim() const { return config_.n_mfcc > 0 ? config_.n_mfcc : config_.n_mels; }
+    int32_t hop_samples() const { return hop_len_; }
+    int32_t frame_samples() const { return frame_len_; }
+
+    /**
+     * Feed PCM samples. `on_frame(const float* features, float energy_db)`
+     * is called for every completed hop; energy_db is the frame energy in
+     * dBFS and lets callers gate expensive work on silence.
+     */
+    template <typename OnFrame>
+    void push(const int16_t* pcm, size_t n, OnFrame&& on_frame) {
+        for (size_t i = 0; i < n; ++i) {
+            ring_[ring_pos_] = static_cast<float>(pcm[i]) * (1.0f / 32768.0f);
+            ring_pos_ = (ring_pos_ + 1) % frame_len_;
+            if (filled_ < frame_len_) ++filled_;
+            if (++since_hop_ >= hop_len_ && filled_ == frame_len_) {
+                since_hop_ = 0;
+                const float energy_db = compute_frame();
+                on_frame(features_.data(), energy_db);
+            }
+        }
+    }
+
+    void reset();
+
+private:
+    float compute_frame();
+
+    FeatureConfig config_;
+    int32_t frame_len_;
+    int32_t hop_len_;
+    size_t fft_len_;
+    Fft fft_;
+
+    std::vector<float> ring_;
+    int32_t ring_pos_ = 0;
+    int32_t filled_ = 0;
+    int32_t since_hop_ = 0;
+
+    std::vector<float> window_;
+    std::vector<float> frame_;
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<std::complex<float>> scratch_;
+    std::vector<float> power_;
+
+    // Sparse triangular mel filters: first FFT bin + weights per filter
+    std::vector<int32_t> mel_start_;
+    std::vector<std::vector<float>> mel_weights_;
+    std::vector<float> log_mel_;
+    std::vector<float> dct_;       // n_mfcc x n_mels, row-major
+    std::vector<float> features_;
+};
+
+} // namespace assistant
@@ -0,0 +1,186 @@
+/**
+ * barge_in.cpp - Detect the user talking over TTS playback
+ */
+
+#include "barge_in.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace assistant {
+
+namespace {
+    constexpr float kActiveReferencePower = 1e-6f;  // -60 dBFS
+    constexpr float kReferenceDecay = 0.76f;        // envelope: ~30 dB per 200 ms at 8 ms blocks
+    constexpr float kFloorAttack = 0.2f;
+    constexpr float kFloorRelease = 0.002f;
+    constexpr float kResidualWarmup = 0.5f;
+    constexpr float kPowerSmoothing = 0.3f;
+    constexpr float kResidualRise = 0.1f;
+    constexpr float kResidualFall = 0.005f;
+    constexpr float kInitialResidualDb = 0.0f;
+    constexpr float kSpeechLeak = 0.25f;            // score lost per non-speech block
+
+    float to_db(float power) { return 10.0f * std::log10(power + 1e-10f); }
+}
+
+BargeInDetector::BargeInDetector(const BargeInConfig& config)
+    : config_(config),
+      aec_(config.aec),
+      resampler_(config.reference_rate, config.sample_rate),
+      block_(static_cast<size_t>(aec_.block_size())),
+      mic_block_(block_),
+      ref_block_(block_),
+      out_block_(block_),
+      out_pcm_(block_) {
+    preroll_.reset(static_cast<size_t>(config_.sample_rate) * std::max(0, config_.preroll_ms) / 1000);
+    reset();
+}
+
+void BargeInDetector::reset() {
+    aec_.reset();
+    resampler_.reset();
+    reference_.clear();
+    reference_read_ = 0;
+    mic_fill_ = 0;
+    preroll_.clear();
+    noise_floor_db_ = 0.0f;
+    floor_initialized_ = false;
+    reference_env_ = 0.0f;
+    out_smooth_ = 0.0f;
+    mic_smooth_ = 0.0f;
+    residual_db_ = kInitialResidualDb;
+    playback_samples_ = 0;
+    speech_score_ = 0.0f;
+    aec_resets_seen_ = 0;
+    triggered_ = false;
+    samples_ = 0;
+    trigger_sample_ = -1;
+}
+
+void BargeInDetector::set_reference_rate(int32_t rate) {
+    if (rate == resampler_.in_rate()) return;
+    config_.reference_rate = rate;
+    resampler_ = Resampler(rate, config_.sample_rate);
+    reference_.clear();
+    reference_read_ = 0;
+}
+
+void BargeInDetector::push_reference(const int16_t* pcm, size_t n) {
+    resample_in_.resize(n);
+    for (size_t i = 0; i < n; ++i) resample_in_[i] = static_cast<float>(pcm[i]) * (1.0f / 32768.0f);
+    resample_out_.resize(resampler_.max_output(n));
+    const size_t produced = resampler_.process(resample_in_.data(), n, resample_out_.data(), resample_out_.size());
+
+    // Compact before growing so the queue's storage stays bounded
+    if (reference_read_ > 0) {
+        reference_.erase(reference_.begin(), reference_.begin() + static_cast<std::ptrdiff_t>(reference_read_));
+        reference_read_ = 0;
+    }
+    reference_.insert(reference_.end(), resample_out_.begin(),
+                      resample_out_.begin() + static_cast<std::ptrdiff_t>(produced));
+
+    const size_t max_lead = static_cast<size_t>(config_.sample_rate) * config_.max_reference_lead_ms / 1000;
+    if (reference_.size() > max_lead) reference_read_ = reference_.size() - max_lead;
+}
+
+void BargeInDetector::push_silence(size_t n) {
+    if (reference_read_ > 0) {
+        reference_.erase(reference_.begin(), reference_.begin() + static_cast<std::ptrdiff_t>(reference_read_));
+        reference_read_ = 0;
+    }
+    reference_.insert(reference_.end(), n, 0.0f);
+    const size_t max_lead = static_cast<size_t>(config_.sample_rate) * config_.max_reference_lead_ms / 1000;
+    if (reference_.size() > max_lead) reference_read_ = reference_.size() - max_lead;
+}
+
+bool BargeInDetector::process_capture(const int16_t* pcm, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        mic_block_[mic_fill_++] = static_cast<float>(pcm[i]) * (1.0f / 32768.0f);
+        if (mic_fill_ == block_) {
+            process_block();
+            mic_fill_ = 0;
+        }
+    }
+    return triggered_;
+}
+
+void BargeInDetector::process_block() {
+    // Reference for this block; an underrun (playback reported late) is treated as silence
+    const size_t available = std::min(block_, reference_.size() - reference_read_);
+    std::copy(reference_.begin() + static_cast<std::ptrdiff_t>(reference_read_),
+              reference_.begin() + static_cast<std::ptrdiff_t>(reference_read_ + available),
+              ref_block_.begin());
+    std::fill(ref_block_.begin() + static_cast<std::ptrdiff_t>(available), ref_block_.end(), 0.0f);
+    reference_read_ += available;
+
+    // The canceller keeps adapting through double talk: the user's voice is
+    // uncorrelated with the reference, so it only adds misadjustment, while
+    // freezing on a false alarm would leave an unconverged filter stuck.
+    aec_.process(mic_block_.data(), ref_block_.data(), out_block_.data());
+    if (aec_.divergence_resets() != aec_resets_seen_) {
+        // The canceller starts from scratch: learn the residual again before trusting it
+        aec_resets_seen_ = aec_.divergence_resets();
+        playback_samples_ = 0;
+        residual_db_ = kInitialResidualDb;
+    }
+
+    for (size_t i = 0; i < block_; ++i) {
+        const float s = std::max(-1.0f, std::min(1.0f, out_block_[i]));
+        out_pcm_[i] = static_cast<int16_t>(s * 32767.0f);
+    }
+    preroll_.write(out_pcm_.data(), block_);
+    samples_ += static_cast<int64_t>(block_);
+
+    double ref_acc = 0.0;
+    for (float r : ref_block_) ref_acc += static_cast<double>(r) * r;
+    const auto ref_power = static_cast<float>(ref_acc / static_cast<double>(block_));
+    reference_env_ = std::max(ref_power, reference_env_ * kReferenceDecay);
+    const bool playing = reference_env_ > kActiveReferencePower;
+    if (playing) playback_samples_ += static_cast<int64_t>(block_);
+    const bool warming_up = playing &&
+        playback_samples_ * 1000 < static_cast<int64_t>(config_.warmup_ms) * config_.sample_rate;
+
+    // Short smoothing evens out syllable-rate fluctuations in both powers
+    out_smooth_ += kPowerSmoothing * (aec_.out_power() - out_smooth_);
+    mic_smooth_ += kPowerSmoothing * (aec_.mic_power() - mic_smooth_);
+    const float out_db = to_db(out_smooth_);
+    if (!floor_initialized_) {
+        noise_floor_db_ = out_db;
+        floor_initialized_ = true;
+    }
+
+    // Expected residual: the microphone level minus what the canceller usually removes.
+    // Near-end speech is not cancelled, so it raises the output relative to the input.
+    const float mic_db = to_db(mic_smooth_);
+    float threshold = std::max(noise_floor_db_ + config_.snr_db, config_.min_speech_db);
+    if (playing) threshold = std::max(threshold, mic_db + residual_db_ + config_.residual_margin_db);
+    const bool speech = !warming_up && out_db > threshold;
+
+    if (speech) {
+        noise_floor_db_ += kFloorRelease * 0.25f * (out_db - noise_floor_db_);
+        speech_score_ += 1.0f;
+    } else {
+        const float rate = out_db < noise_floor_db_ ? kFloorAttack : kFloorRelease;
+        noise_floor_db_ += rate * (out_db - noise_floor_db_);
+        if (playing) {
+            const float target = out_db - mic_db;
+            const float rate_residual = warming_up ? kResidualWarmup
+                : (target > residual_db_ ? kResidualRise : kResidualFall);
+            residual_db_ += rate_residual * (target - residual_db_);
+        }
+        speech_score_ = std::max(0.0f, speech_score_ - kSpeechLeak);
+    }
+
+    const int64_t onset_samples = static_cast<int64_t>(config_.sample_rate) * config_.onset_ms / 1000;
+    if (!triggered_ && speech_score_ * static_cast<float>(block_) >= static_cast<float>(onset_samples)) {
+        triggered_ = true;
+        trigger_sample_ = samples_;
+    }
+}
+
+size_t BargeInDetector::copy_preroll(int16_t* out, size_t max_samples) const {
+    return preroll_.copy_latest(out, max_samples);
+}
+
+} // namespace assistant
@@ -0,0 +1,123 @@
+/**
+ * barge_in.h - Detect the user talking over TTS playback
+ *
+ * The microphone keeps running while the assistant speaks. Each capture
+ * block is passed through the echo canceller against the playback
+ * reference (resampled from the TTS rate to the capture rate), and a VAD
+ * on the echo-cancelled signal decides whether the user started talking.
+ *
+ * The VAD threshold is the larger of the adaptive noise floor and the
+ * expected residual echo: the microphone level times a learned residual
+ * ratio (what the canceller usually leaves of the echo). The ratio is
+ * learned during the first `warmup_ms` of playback (no triggering while
+ * the canceller converges) and then tracks the residual on blocks that are
+ * not speech, rising quickly and falling slowly so short cancellation
+ * dips do not make it over-sensitive. Near-end speech is not cancelled,
+ * so it lifts the output above that expectation.
+ *
+ * Detection uses a leaky count of speech blocks rather than a strict run,
+ * so the short gaps between syllables do not restart the onset timer.
+ *
+ * Echo-cancelled capture is kept in a ring buffer so the next recognition
+ * turn can start with the words spoken before detection.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "echo_canceller.h"
+#include "resampler.h"
+#include "ring_buffer.h"
+
+namespace assistant {
+
+struct BargeInConfig {
+    int32_t sample_rate = 16000;        // capture rate
+    int32_t reference_rate = 16000;     // playback (TTS) rate
+    int32_t onset_ms = 150;             // speech needed to trigger
+    int32_t warmup_ms = 300;            // playback time before triggering is allowed
+    int32_t preroll_ms = 1500;
+    int32_t max_reference_lead_ms = 500;
+    float snr_db = 9.0f;                // above the noise floor
+    float residual_margin_db = 4.5f;    // above the expected residual echo
+    float min_speech_db = -45.0f;       // absolute threshold (dBFS)
+    EchoCancellerConfig aec;
+};
+
+class BargeInDetector {
+public:
+    explicit BargeInDetector(const BargeInConfig& config = BargeInConfig());
+
+    BargeInDetector(const BargeInDetector&) = delete;
+    BargeInDetector& operator=(const BargeInDetector&) = delete;
+
+    /** Change the playback rate (e.g. a different TTS voice); clears queued reference. */
+    void set_reference_rate(int32_t rate);
+
+    /**
+     * Queue reference audio as it reaches the speaker. Capture consumes it
+     * one sample per captured sample; anything queued more than
+     * max_reference_lead_ms ahead of the capture is dropped.
+     */
+    void push_reference(const int16_t* pcm, size_t n);
+
+    /** Queue `n` capture-rate samples of silence (nothing playing during that time). */
+    void push_silence(size_t n);
+
+    /** Feed capture PCM; returns true once user speech has been detected. */
+    bool process_capture(const int16_t* pcm, size_t n);
+
+    bool triggered() const { return triggered_; }
+
+    /** Copy the newest echo-cancelled capture, oldest first; returns the count. */
+    size_t copy_preroll(int16_t* out, size_t max_samples) const;
+    size_t preroll_capacity() const { return preroll_.capacity(); }
+
+    void reset();
+
+    float erle_db() const { return aec_.erle_db(); }
+    float noise_floor_db() const { return noise_floor_db_; }
+    float residual_ratio_db() const { return residual_db_; }
+    /** Capture samples processed so far / at the trigger (-1 before). */
+    int64_t samples() const { return samples_; }
+    int64_t trigger_sample() const { return trigger_sample_; }
+
+private:
+    void process_block();
+
+    BargeInConfig config_;
+    EchoCanceller aec_;
+    Resampler resampler_;
+    size_t block_;
+
+    std::vector<float> reference_;       // queued reference at the capture rate
+    size_t reference_read_ = 0;
+    std::vector<float> resample_in_;
+    std::vector<float> resample_out_;
+
+    std::vector<float> mic_block_;
+    std::vector<float> ref_block_;
+    std::vector<float> out_block_;
+    std::vector<int16_t> out_pcm_;
+    size_t mic_fill_ = 0;
+
+    RingBuffer<int16_t> preroll_;
+
+    float noise_floor_db_ = 0.0f;
+    bool floor_initialized_ = false;
+    float reference_env_ = 0.0f;
+    float out_smooth_ = 0.0f;
+    float mic_smooth_ = 0.0f;
+    float residual_db_ = 0.0f;
+    int64_t playback_samples_ = 0;
+    float speech_score_ = 0.0f;         // leaky count of speech blocks
+    int32_t aec_resets_seen_ = 0;
+    bool triggered_ = false;
+    int64_t samples_ = 0;
+    int64_t trigger_sample_ = -1;
+};
+
+} // namespace assistant
@@ -0,0 +1,152 @@
+/**
+ * barge_in_jni.cpp - JNI bridge for the full-duplex barge-in detector
+ *
+ * Each handle owns one BargeInDetector. Reference and capture calls for a
+ * handle must come from a single thread (the monitor loop in
+ * BargeInMonitor), which keeps the two streams in step.
+ */
+
+#define LOG_TAG "BargeInJNI"
+
+#include <jni.h>
+
+#include <vector>
+
+#include "barge_in.h"
+#include "native_log.h"
+
+using assistant::BargeInConfig;
+using assistant::BargeInDetector;
+
+namespace {
+    BargeInDetector* from_handle(jlong handle) {
+        return reinterpret_cast<BargeInDetector*>(handle);
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeCreate(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jint sampleRate,
+        jint referenceRate,
+        jint onsetMs,
+        jint prerollMs) {
+    if (sampleRate <= 0 || referenceRate <= 0) return 0;
+
+    BargeInConfig config;
+    config.sample_rate = sampleRate;
+    config.reference_rate = referenceRate;
+    config.onset_ms = onsetMs;
+    config.preroll_ms = prerollMs;
+    return reinterpret_cast<jlong>(new BargeInDetector(config));
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeSetReferenceRate(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jint rate) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector != nullptr && rate > 0) detector->set_reference_rate(rate);
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativePushReference(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jshortArray pcm,
+        jint offset,
+        jint length) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector == nullptr || length <= 0 || offset < 0) return;
+    if (offset + length > env->GetArrayLength(pcm)) return;
+
+    auto* samples = static_cast<int16_t*>(env->GetPrimitiveArrayCritical(pcm, nullptr));
+    if (samples == nullptr) return;
+    detector->push_reference(samples + offset, static_cast<size_t>(length));
+    env->ReleasePrimitiveArrayCritical(pcm, samples, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativePushSilence(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jint length) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector != nullptr && length > 0) detector->push_silence(static_cast<size_t>(length));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeProcess(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jshortArray pcm,
+        jint length) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector == nullptr || length <= 0) return JNI_FALSE;
+
+    // Critical access avoids a copy per capture read; process_capture() never calls back into Java
+    auto* samples = static_cast<int16_t*>(env->GetPrimitiveArrayCritical(pcm, nullptr));
+    if (samples == nullptr) return JNI_FALSE;
+    const bool triggered = detector->process_capture(samples, static_cast<size_t>(length));
+    env->ReleasePrimitiveArrayCritical(pcm, samples, JNI_ABORT);
+    return triggered ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jshortArray JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeGetPreroll(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector == nullptr) return env->NewShortArray(0);
+
+    std::vector<int16_t> preroll(detector->preroll_capacity());
+    const size_t n = detector->copy_preroll(preroll.data(), preroll.size());
+    jshortArray result = env->NewShortArray(static_cast<jsize>(n));
+    if (result != nullptr && n > 0) {
+        env->SetShortArrayRegion(result, 0, static_cast<jsize>(n), preroll.data());
+    }
+    return result;
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeGetErleDb(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    BargeInDetector* detector = from_handle(handle);
+    return detector != nullptr ? detector->erle_db() : 0.0f;
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeReset(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector != nullptr) detector->reset();
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_BargeInDetector_nativeDestroy(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    BargeInDetector* detector = from_handle(handle);
+    if (detector != nullptr) {
+        LOGI("Barge-in stats: ERLE %.1f dB, residual %.1f dB, %s",
+             detector->erle_db(), detector->residual_ratio_db(),
+             detector->triggered() ? "triggered" : "not triggered");
+    }
+    delete detector;
+}
+
+} // extern "C"
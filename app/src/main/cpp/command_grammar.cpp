@@ -0,0 +1,166 @@
+/**
+ * command_grammar.cpp - Phrase trie and constrained greedy decoding step
+ */
+
+#include "command_grammar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace assistant {
+
+bool parse_command_spec(const std::string& spec, std::vector<CommandPhrase>& out, std::string* error) {
+    out.clear();
+    size_t line_no = 0;
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = spec.find('\n', pos);
+        if (end == std::string::npos) end = spec.size();
+        std::string line = spec.substr(pos, end - pos);
+        pos = end + 1;
+        ++line_no;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        const size_t tab = line.find('\t');
+        if (tab == 0 || tab == std::string::npos || tab + 1 >= line.size()) {
+            if (error != nullptr) *error = "line " + std::to_string(line_no) + ": expected intent<TAB>phrase";
+            return false;
+        }
+        out.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+    if (out.empty() && error != nullptr) *error = "no phrases";
+    return !out.empty();
+}
+
+void PhraseTrie::clear() {
+    nodes_.assign(1, Node());
+    max_depth_ = 0;
+}
+
+int32_t PhraseTrie::child(int32_t node, int32_t token) const {
+    const auto& children = nodes_[node].children;
+    const auto it = std::lower_bound(children.begin(), children.end(), std::make_pair(token, INT32_MIN));
+    return it != children.end() && it->first == token ? it->second : -1;
+}
+
+void PhraseTrie::add(const int32_t* tokens, size_t n, int32_t phrase) {
+    auto mark = [&](int32_t node) {
+        int32_t& only = nodes_[node].only;
+        if (only == -1) only = phrase;
+        else if (only != phrase) only = kMany;
+    };
+
+    int32_t node = kRoot;
+    mark(node);
+    for (size_t i = 0; i < n; ++i) {
+        int32_t next = child(node, tokens[i]);
+        if (next < 0) {
+            next = static_cast<int32_t>(nodes_.size());
+            nodes_.emplace_back();
+            auto& children = nodes_[node].children;
+            children.insert(std::lower_bound(children.begin(), children.end(), std::make_pair(tokens[i], INT32_MIN)),
+                            std::make_pair(tokens[i], next));
+        }
+        node = next;
+        mark(node);
+    }
+    nodes_[node].terminal = phrase;
+    max_depth_ = std::max(max_depth_, n);
+}
+
+int32_t PhraseTrie::walk(const int32_t* tokens, size_t n) const {
+    int32_t node = kRoot;
+    for (size_t i = 0; i < n && node >= 0; ++i) node = child(node, tokens[i]);
+    return node;
+}
+
+CommandDecoder::CommandDecoder(const PhraseTrie& trie, int32_t eot_token) : trie_(trie), eot_(eot_token) {}
+
+void CommandDecoder::reset() {
+    decided_ = -1;
+    last_node_ = -1;
+    eot_chosen_ = false;
+    early_ = false;
+    logprob_sum_ = 0.0;
+    steps_ = 0;
+}
+
+void CommandDecoder::constrain(const int32_t* history, size_t n, float* logits, size_t n_vocab) {
+    constexpr float kMasked = -std::numeric_limits<float>::infinity();
+    auto force_eot = [&] {
+        std::fill(logits, logits + n_vocab, kMasked);
+        if (eot_ >= 0 && static_cast<size_t>(eot_) < n_vocab) logits[eot_] = 0.0f;
+        eot_chosen_ = true;
+    };
+
+    if (decided_ >= 0) {
+        force_eot();
+        return;
+    }
+    const int32_t node = trie_.walk(history, n);
+    last_node_ = node;
+    if (node < 0) {
+        force_eot();
+        return;
+    }
+    // One phrase left in this subtree: it is the answer, stop decoding now
+    if (n > 0 && trie_.only_phrase(node) >= 0) {
+        decided_ = trie_.only_phrase(node);
+        early_ = trie_.terminal(node) != decided_;
+        force_eot();
+        return;
+    }
+
+    // Log-softmax normalizer over the unconstrained distribution
+    const float max_logit = *std::max_element(logits, logits + n_vocab);
+    double sum = 0.0;
+    for (size_t i = 0; i < n_vocab; ++i) sum += std::exp(static_cast<double>(logits[i] - max_logit));
+    const double log_norm = max_logit + std::log(sum);
+
+    const bool eot_allowed = trie_.terminal(node) >= 0 && eot_ >= 0 && static_cast<size_t>(eot_) < n_vocab;
+    float best = kMasked;
+    int32_t best_token = -1;
+    if (eot_allowed) {
+        best = logits[eot_];
+        best_token = eot_;
+    }
+    for (const auto& entry : trie_.children(node)) {
+        if (entry.first >= 0 && static_cast<size_t>(entry.first) < n_vocab && logits[entry.first] > best) {
+            best = logits[entry.first];
+            best_token = entry.first;
+        }
+    }
+
+    // Mask in one pass over the vocabulary, keeping the sorted children and eot
+    const auto& children = trie_.children(node);
+    size_t c = 0;
+    for (size_t i = 0; i < n_vocab; ++i) {
+        while (c < children.size() && static_cast<size_t>(children[c].first) < i) ++c;
+        const bool allowed = (c < children.size() && static_cast<size_t>(children[c].first) == i) ||
+                             (eot_allowed && static_cast<int32_t>(i) == eot_);
+        if (!allowed) logits[i] = kMasked;
+    }
+
+    if (best_token >= 0) {
+        logprob_sum_ += best - log_norm;
+        ++steps_;
+    }
+    eot_chosen_ = best_token == eot_;
+}
+
+CommandMatch CommandDecoder::result() const {
+    CommandMatch match;
+    if (decided_ >= 0) {
+        match.phrase = decided_;
+        match.early = early_;
+    } else if (eot_chosen_ && last_node_ >= 0) {
+        match.phrase = trie_.terminal(last_node_);
+    }
+    match.steps = steps_;
+    match.score = steps_ > 0 && match.phrase >= 0 ? static_cast<float>(std::exp(logprob_sum_ / steps_)) : 0.0f;
+    return match;
+}
+
+} // namespace assistant
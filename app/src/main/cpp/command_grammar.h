@@ -0,0 +1,113 @@
+/**
+ * command_grammar.h - Phrase-list constrained decoding for voice commands
+ *
+ * Short commands ("open camera", "set a timer for 5 minutes") come from a
+ * closed list, so the recognizer only has to pick among them. The phrases
+ * are tokenized with the recognizer's own tokenizer and stored in a trie;
+ * at every decoding step CommandDecoder masks the logits to tokens that
+ * continue some phrase (plus end-of-text where a phrase is complete).
+ * As soon as the decoded prefix leaves a single phrase in its subtree the
+ * decoder forces end-of-text, so a match usually costs a handful of
+ * decoder steps. The score is the geometric mean probability of the
+ * chosen tokens under the unconstrained distribution, so out-of-grammar
+ * speech scores low even though some phrase is always matched.
+ *
+ * The spec is one "intent<TAB>phrase" per line ('#' comments); pattern
+ * expansion happens on the Kotlin side (CommandGrammar.kt).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace assistant {
+
+struct CommandPhrase {
+    std::string intent;
+    std::string text;
+};
+
+/** Parse "intent<TAB>phrase" lines; false (with `error`) on a malformed line. */
+bool parse_command_spec(const std::string& spec, std::vector<CommandPhrase>& out, std::string* error = nullptr);
+
+class PhraseTrie {
+public:
+    static constexpr int32_t kRoot = 0;
+
+    PhraseTrie() { clear(); }
+
+    void clear();
+
+    /** Add a token sequence ending in `phrase`; several sequences may share a phrase. */
+    void add(const int32_t* tokens, size_t n, int32_t phrase);
+
+    /** Node reached from the root by `tokens`, or -1 if they leave the trie. */
+    int32_t walk(const int32_t* tokens, size_t n) const;
+
+    int32_t child(int32_t node, int32_t token) const;
+
+    /** (token, child) pairs, sorted by token. */
+    const std::vector<std::pair<int32_t, int32_t>>& children(int32_t node) const { return nodes_[node].children; }
+
+    /** Phrase completed at `node`, or -1. */
+    int32_t terminal(int32_t node) const { return nodes_[node].terminal; }
+
+    /** The only phrase reachable from `node`, or -1 if there are several. */
+    int32_t only_phrase(int32_t node) const { return nodes_[node].only >= 0 ? nodes_[node].only : -1; }
+
+    size_t size() const { return nodes_.size(); }
+    size_t max_depth() const { return max_depth_; }
+
+private:
+    static constexpr int32_t kMany = -2;
+
+    struct Node {
+        std::vector<std::pair<int32_t, int32_t>> children;
+        int32_t terminal = -1;
+        int32_t only = -1;      // -1: none yet, kMany: several
+    };
+
+    std::vector<Node> nodes_;
+    size_t max_depth_ = 0;
+};
+
+struct CommandMatch {
+    int32_t phrase = -1;
+    float score = 0.0f;     // geometric mean token probability, 0..1
+    int32_t steps = 0;      // constrained decoder steps taken
+    bool early = false;     // decided before the phrase was fully decoded
+};
+
+/** Per-utterance state for constraining one greedy decode with a PhraseTrie. */
+class CommandDecoder {
+public:
+    CommandDecoder(const PhraseTrie& trie, int32_t eot_token);
+
+    void reset();
+
+    /**
+     * Mask `logits` (n_vocab entries) given the tokens decoded so far, and
+     * score the greedy choice it leaves. Once the phrase is decided (or the
+     * history left the trie) only end-of-text stays allowed.
+     */
+    void constrain(const int32_t* history, size_t n, float* logits, size_t n_vocab);
+
+    /** Outcome after the decoder emitted end-of-text (or stopped). */
+    CommandMatch result() const;
+
+private:
+    const PhraseTrie& trie_;
+    int32_t eot_;
+    int32_t decided_ = -1;
+    int32_t last_node_ = -1;
+    bool eot_chosen_ = false;
+    bool early_ = false;
+    double logprob_sum_ = 0.0;
+    int32_t steps_ = 0;
+};
+
+} // namespace assistant
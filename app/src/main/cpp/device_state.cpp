@@ -0,0 +1,140 @@
+/**
+ * device_state.cpp - sysfs thermal and power_supply readers
+ */
+
+#include "device_state.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace assistant {
+
+namespace {
+    // Phones list 50-100 zones; stop at the first gap past this many
+    constexpr int kMaxThermalZones = 128;
+
+    // Sensors that are absent report -273 C or thousands of degrees
+    bool plausible_celsius(float celsius) {
+        return celsius > -40.0f && celsius < 150.0f;
+    }
+
+    // PMIC "zones" that report battery current/voltage or throttle levels, not temperatures
+    bool temperature_zone(const std::string& type) {
+        for (const char* skip : { "ibat", "vbat", "bcl", "lvl", "soc_limit" }) {
+            if (type.find(skip) != std::string::npos) return false;
+        }
+        return true;
+    }
+
+    // Zones report millidegrees, a few drivers plain degrees
+    float zone_celsius(long long raw) {
+        return std::llabs(raw) >= 1000 ? static_cast<float>(raw) / 1000.0f : static_cast<float>(raw);
+    }
+
+    std::vector<std::string> list_dir(const std::string& path) {
+        std::vector<std::string> names;
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) return names;
+        while (const dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') names.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    // "battery" on most devices; otherwise the first supply whose type says so
+    std::string find_battery(const std::string& supplies) {
+        std::string found;
+        for (const std::string& name : list_dir(supplies)) {
+            if (name == "battery") return supplies + "/" + name;
+            if (found.empty() && read_sysfs_line(supplies + "/" + name + "/type") == "Battery") {
+                found = supplies + "/" + name;
+            }
+        }
+        return found;
+    }
+}
+
+bool read_sysfs_long(const std::string& path, long long& value) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) return false;
+    const bool ok = fscanf(file, "%lld", &value) == 1;
+    fclose(file);
+    return ok;
+}
+
+std::string read_sysfs_line(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) return std::string();
+    char line[128];
+    const bool ok = fgets(line, sizeof(line), file) != nullptr;
+    fclose(file);
+    if (!ok) return std::string();
+    line[strcspn(line, "\r\n")] = '\0';
+    return line;
+}
+
+DeviceSensors::DeviceSensors(std::string root) : root_(std::move(root)) {}
+
+std::vector<ThermalZone> DeviceSensors::read_thermal() const {
+    std::vector<ThermalZone> zones;
+    char name[48];
+    for (int i = 0; i < kMaxThermalZones; ++i) {
+        snprintf(name, sizeof(name), "/thermal/thermal_zone%d", i);
+        const std::string zone = root_ + name;
+        long long raw = 0;
+        if (!read_sysfs_long(zone + "/temp", raw)) {
+            // Numbering can skip a zone whose driver failed to probe
+            if (read_sysfs_line(zone + "/type").empty()) break;
+            continue;
+        }
+        const float celsius = zone_celsius(raw);
+        std::string type = read_sysfs_line(zone + "/type");
+        if (!plausible_celsius(celsius) || !temperature_zone(type)) continue;
+        ThermalZone entry;
+        entry.type = std::move(type);
+        entry.celsius = celsius;
+        zones.push_back(std::move(entry));
+    }
+    return zones;
+}
+
+BatteryState DeviceSensors::read_battery() const {
+    BatteryState battery;
+    const std::string dir = find_battery(root_ + "/power_supply");
+    if (dir.empty()) return battery;
+    battery.present = true;
+
+    long long value = 0;
+    if (read_sysfs_long(dir + "/capacity", value)) battery.capacity_pct = static_cast<int32_t>(value);
+    const std::string status = read_sysfs_line(dir + "/status");
+    battery.charging = status == "Charging" || status == "Full";
+    if (read_sysfs_long(dir + "/temp", value)) battery.celsius = static_cast<float>(value) / 10.0f;
+
+    // current_now is in uA but its sign differs between vendors; status says which way it flows
+    long long current = 0;
+    long long voltage = 0;
+    if (read_sysfs_long(dir + "/current_now", current) && read_sysfs_long(dir + "/voltage_now", voltage)) {
+        battery.has_power = true;
+        const float amps = static_cast<float>(std::llabs(current)) / 1e6f;
+        battery.current_a = battery.charging ? -amps : amps;
+        // A few drivers report millivolts
+        battery.voltage_v = voltage < 100000 ? static_cast<float>(voltage) / 1e3f : static_cast<float>(voltage) / 1e6f;
+    }
+    return battery;
+}
+
+DeviceState DeviceSensors::read() const {
+    DeviceState state;
+    state.zones = read_thermal();
+    for (const ThermalZone& zone : state.zones) state.max_celsius = std::max(state.max_celsius, zone.celsius);
+    state.battery = read_battery();
+    return state;
+}
+
+} // namespace assistant
@@ -0,0 +1,62 @@
+/**
+ * device_state.h - Thermal zone and battery readings from sysfs
+ *
+ * Reads `<root>/thermal/thermal_zone<N>` and `<root>/power_supply/<name>`
+ * (root is /sys/class on a device). Tests and Linux hosts point the root at a
+ * directory of stand-in files with the same layout. Values the kernel or
+ * SELinux does not expose stay at their "unknown" defaults, and callers
+ * are expected to treat them as such rather than as zero.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace assistant {
+
+struct ThermalZone {
+    std::string type;               // e.g. "cpu-1-0-usr", "skin-therm", "battery"
+    float celsius = 0.0f;
+};
+
+struct BatteryState {
+    bool present = false;           // false: no battery supply found
+    int32_t capacity_pct = -1;      // -1: unknown
+    bool charging = false;          // charging or full on external power
+    bool has_power = false;         // current and voltage both readable
+    float current_a = 0.0f;         // drawn from the battery (> 0 while discharging)
+    float voltage_v = 0.0f;
+    float celsius = 0.0f;           // battery temperature, 0 if unknown
+
+    float power_w() const { return current_a * voltage_v; }
+};
+
+struct DeviceState {
+    std::vector<ThermalZone> zones;
+    float max_celsius = 0.0f;       // hottest plausible zone, 0 if none readable
+    BatteryState battery;
+};
+
+class DeviceSensors {
+public:
+    explicit DeviceSensors(std::string root = "/sys/class");
+
+    std::vector<ThermalZone> read_thermal() const;
+    BatteryState read_battery() const;
+    DeviceState read() const;
+
+    const std::string& root() const { return root_; }
+
+private:
+    std::string root_;
+};
+
+/** Whole-file integer, as sysfs writes them; false if missing or unparsable. */
+bool read_sysfs_long(const std::string& path, long long& value);
+
+/** First line of a file without the newline; empty if missing. */
+std::string read_sysfs_line(const std::string& path);
+
+} // namespace assistant
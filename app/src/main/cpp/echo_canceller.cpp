@@ -0,0 +1,134 @@
+/**
+ * echo_canceller.cpp - Partitioned-block frequency-domain echo canceller
+ */
+
+#include "echo_canceller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace assistant {
+
+namespace {
+    constexpr float kActiveReferencePower = 1e-6f;   // -60 dBFS; below this there is nothing to learn
+    constexpr float kErleSmoothing = 0.05f;
+    constexpr float kDivergenceSmoothing = 0.05f;    // ~160 ms at 8 ms blocks
+    constexpr float kRelativeRegularization = 0.3f;
+
+    float mean_square(const float* x, size_t n) {
+        double acc = 0.0;
+        for (size_t i = 0; i < n; ++i) acc += static_cast<double>(x[i]) * x[i];
+        return static_cast<float>(acc / static_cast<double>(n));
+    }
+}
+
+EchoCanceller::EchoCanceller(const EchoCancellerConfig& config)
+    : config_(config),
+      block_(static_cast<size_t>(std::max(16, config.block_size))),
+      fft_size_(2 * block_),
+      bins_(block_ + 1),
+      fft_(fft_size_) {
+    config_.filter_blocks = std::max(1, config_.filter_blocks);
+    config_.step = std::min(1.0f, std::max(0.01f, config_.step));
+    const size_t partitions = static_cast<size_t>(config_.filter_blocks);
+    ref_frame_.assign(fft_size_, 0.0f);
+    ref_spectra_.assign(partitions * bins_, Complex());
+    weights_.assign(partitions * bins_, Complex());
+    ref_power_.assign(bins_, 0.0f);
+    spectrum_.assign(bins_, Complex());
+    scratch_.assign(fft_size_, Complex());
+    time_.assign(fft_size_, 0.0f);
+}
+
+void EchoCanceller::reset() {
+    std::fill(ref_frame_.begin(), ref_frame_.end(), 0.0f);
+    std::fill(ref_spectra_.begin(), ref_spectra_.end(), Complex());
+    std::fill(weights_.begin(), weights_.end(), Complex());
+    ref_head_ = 0;
+    constrain_next_ = 0;
+    adapt_ = true;
+    mic_power_ = echo_power_ = out_power_ = 0.0f;
+    erle_db_ = 0.0f;
+    mic_avg_ = out_avg_ = 0.0f;
+    divergence_resets_ = 0;
+}
+
+void EchoCanceller::process(const float* mic, const float* ref, float* out) {
+    const size_t partitions = static_cast<size_t>(config_.filter_blocks);
+
+    // Newest reference spectrum over [previous block | current block]
+    std::copy(ref_frame_.begin() + block_, ref_frame_.end(), ref_frame_.begin());
+    std::copy(ref, ref + block_, ref_frame_.begin() + block_);
+    ref_head_ = (ref_head_ + partitions - 1) % partitions;
+    fft_.forward_real(ref_frame_.data(), &ref_spectra_[ref_head_ * bins_], scratch_.data());
+    const float ref_power = mean_square(ref, block_);
+
+    // Echo estimate: sum of partition products, last half of the inverse (overlap-save)
+    std::fill(spectrum_.begin(), spectrum_.end(), Complex());
+    for (size_t p = 0; p < partitions; ++p) {
+        const Complex* x = &ref_spectra_[((ref_head_ + p) % partitions) * bins_];
+        const Complex* w = &weights_[p * bins_];
+        for (size_t k = 0; k < bins_; ++k) spectrum_[k] += w[k] * x[k];
+    }
+    fft_.inverse_real(spectrum_.data(), time_.data(), scratch_.data());
+    const float* echo = time_.data() + block_;
+
+    mic_power_ = mean_square(mic, block_);
+    echo_power_ = mean_square(echo, block_);
+    for (size_t i = 0; i < block_; ++i) out[i] = mic[i] - echo[i];
+    out_power_ = mean_square(out, block_);
+
+    // A diverged filter adds echo instead of removing it; start over
+    mic_avg_ += kDivergenceSmoothing * (mic_power_ - mic_avg_);
+    out_avg_ += kDivergenceSmoothing * (out_power_ - out_avg_);
+    if (out_avg_ > 4.0f * mic_avg_ && mic_avg_ > kActiveReferencePower) {
+        out_avg_ = mic_avg_;
+        ++divergence_resets_;
+        std::fill(weights_.begin(), weights_.end(), Complex());
+        std::copy(mic, mic + block_, out);
+        out_power_ = mic_power_;
+        return;
+    }
+
+    if (ref_power < kActiveReferencePower) return;
+    const float erle = 10.0f * std::log10((mic_power_ + 1e-10f) / (out_power_ + 1e-10f));
+    if (!adapt_) return;
+    erle_db_ += kErleSmoothing * (erle - erle_db_);
+
+    // Error spectrum of [zeros | e]
+    std::fill(time_.begin(), time_.begin() + static_cast<std::ptrdiff_t>(block_), 0.0f);
+    std::copy(out, out + block_, time_.begin() + static_cast<std::ptrdiff_t>(block_));
+    fft_.forward_real(time_.data(), spectrum_.data(), scratch_.data());
+
+    // Per-bin reference power over the whole filter span. Bins between the
+    // harmonics of voiced speech carry almost no reference energy; the
+    // relative term keeps their step from blowing up on leakage.
+    std::fill(ref_power_.begin(), ref_power_.end(), 0.0f);
+    for (size_t p = 0; p < partitions; ++p) {
+        const Complex* x = &ref_spectra_[p * bins_];
+        for (size_t k = 0; k < bins_; ++k) ref_power_[k] += std::norm(x[k]);
+    }
+    float mean_power = 0.0f;
+    for (float power : ref_power_) mean_power += power;
+    mean_power /= static_cast<float>(bins_);
+    const float regularization = kRelativeRegularization * mean_power +
+        static_cast<float>(fft_size_ * partitions) * kActiveReferencePower;
+    for (size_t k = 0; k < bins_; ++k) {
+        spectrum_[k] *= config_.step / (ref_power_[k] + regularization);
+    }
+
+    for (size_t p = 0; p < partitions; ++p) {
+        const Complex* x = &ref_spectra_[((ref_head_ + p) % partitions) * bins_];
+        Complex* w = &weights_[p * bins_];
+        for (size_t k = 0; k < bins_; ++k) w[k] += std::conj(x[k]) * spectrum_[k];
+    }
+
+    // Keep one partition a linear (not circular) convolution: zero its impulse response tail
+    Complex* w = &weights_[constrain_next_ * bins_];
+    fft_.inverse_real(w, time_.data(), scratch_.data());
+    std::fill(time_.begin() + static_cast<std::ptrdiff_t>(block_), time_.end(), 0.0f);
+    fft_.forward_real(time_.data(), w, scratch_.data());
+    constrain_next_ = (constrain_next_ + 1) % partitions;
+}
+
+} // namespace assistant
@@ -0,0 +1,97 @@
+/**
+ * echo_canceller.h - Acoustic echo canceller for full-duplex barge-in
+ *
+ * Partitioned-block frequency-domain adaptive filter (overlap-save). The
+ * playback reference is split into `filter_blocks` partitions of
+ * `block_size` samples, so the filter models block_size * filter_blocks
+ * samples of echo path (128 ms with the defaults at 16 kHz) for the cost
+ * of a few FFTs per block. Each bin's step is normalized by the reference
+ * power in that bin; the gradient constraint is applied to one partition
+ * per block in rotation, which converges nearly as fast as constraining
+ * all of them at a fraction of the FFTs.
+ *
+ * Adaptation can be frozen (see set_adaptation), e.g. to hold a converged
+ * path while probing the canceller; near-end speech is uncorrelated with
+ * the reference, so adapting through double talk only adds misadjustment.
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace assistant {
+
+struct EchoCancellerConfig {
+    int32_t block_size = 128;       // samples per process() call, power of two
+    int32_t filter_blocks = 16;     // echo tail = block_size * filter_blocks
+    float step = 1.0f;              // normalized step size (0, 1]
+};
+
+class EchoCanceller {
+public:
+    explicit EchoCanceller(const EchoCancellerConfig& config = EchoCancellerConfig());
+
+    EchoCanceller(const EchoCanceller&) = delete;
+    EchoCanceller& operator=(const EchoCanceller&) = delete;
+
+    /**
+     * Cancel one block: `mic` and `ref` hold block_size samples in [-1, 1]
+     * with `ref` time-aligned to what the speaker was playing; writes the
+     * echo-free signal to `out` (may alias `mic`).
+     */
+    void process(const float* mic, const float* ref, float* out);
+
+    /** Enable or freeze filter adaptation. */
+    void set_adaptation(bool enabled) { adapt_ = enabled; }
+
+    void reset();
+
+    int32_t block_size() const { return config_.block_size; }
+
+    /** Mean-square powers of the last block. */
+    float mic_power() const { return mic_power_; }
+    float echo_power() const { return echo_power_; }
+    float out_power() const { return out_power_; }
+
+    /** Smoothed echo return loss enhancement (mic / residual) while the reference is active. */
+    float erle_db() const { return erle_db_; }
+
+    /** Times the filter diverged and was cleared; it has to converge again after each. */
+    int32_t divergence_resets() const { return divergence_resets_; }
+
+private:
+    using Complex = std::complex<float>;
+
+    EchoCancellerConfig config_;
+    size_t block_;
+    size_t fft_size_;
+    size_t bins_;
+    Fft fft_;
+
+    std::vector<float> ref_frame_;          // previous + current reference block
+    std::vector<Complex> ref_spectra_;      // filter_blocks x bins, newest at ref_head_
+    size_t ref_head_ = 0;
+    std::vector<Complex> weights_;          // filter_blocks x bins
+    std::vector<float> ref_power_;          // per-bin sum over partitions
+    size_t constrain_next_ = 0;
+
+    std::vector<Complex> spectrum_;
+    std::vector<Complex> scratch_;
+    std::vector<float> time_;
+
+    bool adapt_ = true;
+    float mic_power_ = 0.0f;
+    float echo_power_ = 0.0f;
+    float out_power_ = 0.0f;
+    float erle_db_ = 0.0f;
+    float mic_avg_ = 0.0f;          // smoothed powers for divergence detection
+    float out_avg_ = 0.0f;
+    int32_t divergence_resets_ = 0;
+};
+
+} // namespace assistant
@@ -0,0 +1,127 @@
+/**
+ * endpointer.cpp - End-of-utterance detection for voice capture
+ */
+
+#include "endpointer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace assistant {
+
+namespace {
+    constexpr float kHighPassPole = 0.97f;      // ~80 Hz at 16 kHz
+    constexpr float kFloorAttack = 0.2f;        // follow quieter frames quickly
+    constexpr float kFloorRelease = 0.002f;     // drift up slowly (~5 s at 10 ms frames)
+}
+
+Endpointer::Endpointer(const EndpointerConfig& config)
+    : config_(config),
+      frame_len_(std::max(1, config.sample_rate * config.frame_ms / 1000)) {
+}
+
+void Endpointer::reset() {
+    hp_prev_in_ = 0.0f;
+    hp_prev_out_ = 0.0f;
+    frame_energy_ = 0.0;
+    frame_pos_ = 0;
+    state_ = ENDPOINT_WAITING;
+    reason_ = ENDPOINT_REASON_NONE;
+    noise_floor_db_ = 0.0f;
+    floor_initialized_ = false;
+    last_speech_ = false;
+    decoder_endpoint_ = false;
+    speech_run_ = 0;
+    silence_run_ = 0;
+    samples_ = 0;
+    speech_start_ = -1;
+    speech_end_ = -1;
+    end_ = -1;
+}
+
+EndpointState Endpointer::process(const int16_t* pcm, size_t n) {
+    for (size_t i = 0; i < n && state_ != ENDPOINT_ENDED; ++i) {
+        const float x = static_cast<float>(pcm[i]) * (1.0f / 32768.0f);
+        const float y = x - hp_prev_in_ + kHighPassPole * hp_prev_out_;
+        hp_prev_in_ = x;
+        hp_prev_out_ = y;
+        frame_energy_ += static_cast<double>(y) * y;
+        ++samples_;
+
+        if (++frame_pos_ == frame_len_) {
+            const float energy_db = 10.0f * std::log10(static_cast<float>(frame_energy_ / frame_len_) + 1e-10f);
+            frame_pos_ = 0;
+            frame_energy_ = 0.0;
+            on_frame(energy_db);
+        }
+    }
+    return state_;
+}
+
+void Endpointer::notify_decoder_endpoint() {
+    if (state_ == ENDPOINT_SPEECH) decoder_endpoint_ = true;
+}
+
+void Endpointer::on_frame(float energy_db) {
+    if (!floor_initialized_) {
+        noise_floor_db_ = energy_db;
+        floor_initialized_ = true;
+    }
+
+    const bool speech = energy_db > std::max(noise_floor_db_ + config_.snr_db, config_.min_speech_db);
+    if (!speech) {
+        const float rate = energy_db < noise_floor_db_ ? kFloorAttack : kFloorRelease;
+        noise_floor_db_ += rate * (energy_db - noise_floor_db_);
+    } else {
+        // Let a stationary noise that appears mid-capture eventually become the floor
+        noise_floor_db_ += kFloorRelease * 0.25f * (energy_db - noise_floor_db_);
+    }
+    last_speech_ = speech;
+
+    const int32_t onset_frames = std::max(1, config_.onset_ms / config_.frame_ms);
+    const int64_t ms = samples_ * 1000 / config_.sample_rate;
+
+    if (state_ == ENDPOINT_WAITING) {
+        speech_run_ = speech ? speech_run_ + 1 : 0;
+        if (speech_run_ >= onset_frames) {
+            state_ = ENDPOINT_SPEECH;
+            speech_start_ = samples_ - static_cast<int64_t>(speech_run_) * frame_len_;
+            speech_end_ = samples_;
+            silence_run_ = 0;
+        } else if (ms >= config_.leading_timeout_ms) {
+            state_ = ENDPOINT_ENDED;
+            reason_ = ENDPOINT_REASON_NO_SPEECH;
+            end_ = samples_;
+        }
+        return;
+    }
+
+    if (speech) {
+        silence_run_ = 0;
+        speech_end_ = samples_;
+        // Speech after the decoder's boundary starts a new phrase
+        decoder_endpoint_ = false;
+    } else {
+        ++silence_run_;
+    }
+
+    const int32_t silence_ms = silence_run_ * config_.frame_ms;
+    if (silence_ms >= config_.hangover_ms) {
+        reason_ = ENDPOINT_REASON_SILENCE;
+    } else if (decoder_endpoint_ && silence_ms >= config_.decoder_hangover_ms) {
+        reason_ = ENDPOINT_REASON_DECODER;
+    } else if ((samples_ - speech_start_) * 1000 / config_.sample_rate >= config_.max_utterance_ms) {
+        reason_ = ENDPOINT_REASON_MAX_LENGTH;
+    } else {
+        return;
+    }
+    state_ = ENDPOINT_ENDED;
+    end_ = samples_;
+}
+
+int32_t Endpointer::detection_delay_ms() const {
+    if (end_ < 0 || speech_end_ < 0) return -1;
+    return static_cast<int32_t>((end_ - speech_end_) * 1000 / config_.sample_rate);
+}
+
+} // namespace assistant
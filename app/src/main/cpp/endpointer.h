@@ -0,0 +1,98 @@
+/**
+ * endpointer.h - End-of-utterance detection for voice capture
+ *
+ * An energy VAD with an adaptive noise floor classifies short frames as
+ * speech or not. Capture is declared finished once speech has started and
+ * is followed by `hangover_ms` of non-speech, or a shorter
+ * `decoder_hangover_ms` when the recognizer has reported an utterance
+ * boundary of its own (e.g. Vosk's acceptWaveForm returning true).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace assistant {
+
+struct EndpointerConfig {
+    int32_t sample_rate = 16000;
+    int32_t frame_ms = 10;
+    int32_t onset_ms = 80;              // continuous speech needed to start an utterance
+    int32_t hangover_ms = 800;          // trailing non-speech that ends it
+    int32_t decoder_hangover_ms = 250;  // ... once the decoder has signalled an endpoint
+    int32_t leading_timeout_ms = 6000;  // give up if nobody starts speaking
+    int32_t max_utterance_ms = 30000;
+    float snr_db = 9.0f;                // speech threshold above the noise floor
+    float min_speech_db = -50.0f;       // absolute threshold (dBFS)
+};
+
+enum EndpointState : int32_t {
+    ENDPOINT_WAITING = 0,   // no speech yet
+    ENDPOINT_SPEECH = 1,    // utterance in progress
+    ENDPOINT_ENDED = 2,
+};
+
+enum EndpointReason : int32_t {
+    ENDPOINT_REASON_NONE = 0,
+    ENDPOINT_REASON_SILENCE = 1,
+    ENDPOINT_REASON_DECODER = 2,
+    ENDPOINT_REASON_NO_SPEECH = 3,
+    ENDPOINT_REASON_MAX_LENGTH = 4,
+};
+
+class Endpointer {
+public:
+    explicit Endpointer(const EndpointerConfig& config = EndpointerConfig());
+
+    /** Feed 16-bit mono PCM; returns the state after the last complete frame. */
+    EndpointState process(const int16_t* pcm, size_t n);
+
+    /** The decoder finalized an utterance; ends capture after a short hangover. */
+    void notify_decoder_endpoint();
+
+    void reset();
+
+    EndpointState state() const { return state_; }
+    EndpointReason reason() const { return reason_; }
+    const EndpointerConfig& config() const { return config_; }
+
+    /** Stream positions in samples; -1 until known. */
+    int64_t speech_start_sample() const { return speech_start_; }
+    int64_t speech_end_sample() const { return speech_end_; }
+    int64_t end_sample() const { return end_; }
+    int64_t samples() const { return samples_; }
+
+    /** Time from the end of the last speech frame to the endpoint decision. */
+    int32_t detection_delay_ms() const;
+
+    float noise_floor_db() const { return noise_floor_db_; }
+    bool last_frame_speech() const { return last_speech_; }
+
+private:
+    void on_frame(float energy_db);
+
+    EndpointerConfig config_;
+    int32_t frame_len_;
+
+    // First-order high-pass state (removes DC and rumble before the energy)
+    float hp_prev_in_ = 0.0f;
+    float hp_prev_out_ = 0.0f;
+    double frame_energy_ = 0.0;
+    int32_t frame_pos_ = 0;
+
+    EndpointState state_ = ENDPOINT_WAITING;
+    EndpointReason reason_ = ENDPOINT_REASON_NONE;
+    float noise_floor_db_ = 0.0f;
+    bool floor_initialized_ = false;
+    bool last_speech_ = false;
+    bool decoder_endpoint_ = false;
+    int32_t speech_run_ = 0;
+    int32_t silence_run_ = 0;
+    int64_t samples_ = 0;
+    int64_t speech_start_ = -1;
+    int64_t speech_end_ = -1;
+    int64_t end_ = -1;
+};
+
+} // namespace assistant
@@ -0,0 +1,201 @@
+/**
+ * energy_meter.cpp - Battery power integration and per-thread CPU accounting
+ */
+
+#define LOG_TAG "EnergyMeter"
+
+#include "energy_meter.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "native_log.h"
+
+namespace assistant {
+
+namespace {
+    void read_power(const DeviceSensors& sensors, double& power_w, bool& known) {
+        const BatteryState battery = sensors.read_battery();
+        // Power drawn from the battery only; while charging it says nothing about our cost
+        known = battery.has_power && !battery.charging;
+        power_w = known ? static_cast<double>(battery.power_w()) : 0.0;
+    }
+}
+
+double thread_cpu_seconds() {
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return -1.0;
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+EnergyMeter::EnergyMeter(DeviceSensors sensors, int32_t sample_interval_ms)
+    : sensors_(std::move(sensors)),
+      interval_(std::max(1, sample_interval_ms)) {
+    // Seed the held reading so the first request has one before the sampler's
+    read_power(sensors_, power_w_, power_known_);
+    thread_ = std::thread([this] { run(); });
+}
+
+EnergyMeter::~EnergyMeter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+EnergyMeter& EnergyMeter::shared() {
+    static EnergyMeter meter;
+    return meter;
+}
+
+void EnergyMeter::advance_locked(Clock::time_point now, double power_w, bool power_known) {
+    if (have_sample_ && open_count_ > 0) {
+        const double dt = std::chrono::duration<double>(now - sampled_at_).count();
+        if (dt > 0.0) {
+            const bool known = power_known_ && power_known;
+            // Requests open together share the draw rather than each being charged all of it
+            const double share = known ? 0.5 * (power_w_ + power_w) * dt / static_cast<double>(open_count_) : 0.0;
+            for (Open& open : open_) {
+                if (open.token == 0) continue;
+                if (known) {
+                    open.joules += share;
+                } else {
+                    open.power_unknown = true;
+                }
+            }
+        }
+    }
+    have_sample_ = true;
+    sampled_at_ = now;
+    power_w_ = power_w;
+    power_known_ = power_known;
+}
+
+uint64_t EnergyMeter::begin(const char* engine) {
+    const double cpu = thread_cpu_seconds();
+    uint64_t token;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_count_ == open_.size()) {
+            LOGW("%zu measurements already open, not measuring %s", open_.size(), engine);
+            return 0;
+        }
+        // The integral restarts with the first open measurement; until the sampler
+        // wakes, the interval runs on the last reading
+        if (open_count_ == 0) have_sample_ = false;
+        const Clock::time_point now = Clock::now();
+        advance_locked(now, power_w_, power_known_);
+
+        Open* slot = std::find_if(open_.begin(), open_.end(), [](const Open& open) { return open.token == 0; });
+        token = next_token_++;
+        slot->token = token;
+        strncpy(slot->engine, engine, kMaxEngineName);
+        slot->engine[kMaxEngineName] = '\0';
+        slot->started = now;
+        slot->thread = std::this_thread::get_id();
+        slot->cpu_started = cpu;
+        slot->joules = 0.0;
+        slot->power_unknown = false;
+        ++open_count_;
+        // Registered here, once per engine, so end() allocates nothing
+        if (engines_.find(slot->engine) == engines_.end()) engines_[slot->engine].engine = slot->engine;
+    }
+    cv_.notify_all();
+    return token;
+}
+
+bool EnergyMeter::end(uint64_t token, double audio_seconds, EnergySample* out) {
+    if (token == 0) return false;
+    const double cpu = thread_cpu_seconds();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(open_.begin(), open_.end(), [token](const Open& open) { return open.token == token; });
+    if (it == open_.end()) return false;
+    Open& open = *it;
+    const Clock::time_point now = Clock::now();
+    advance_locked(now, power_w_, power_known_);
+
+    EnergySample sample;
+    sample.wall_seconds = std::chrono::duration<double>(now - open.started).count();
+    sample.audio_seconds = std::max(0.0, audio_seconds);
+    sample.power_known = !open.power_unknown && power_known_;
+    sample.joules = sample.power_known ? open.joules : 0.0;
+    sample.cpu_known = open.thread == std::this_thread::get_id() && open.cpu_started >= 0.0 && cpu >= 0.0;
+    sample.cpu_seconds = sample.cpu_known ? std::max(0.0, cpu - open.cpu_started) : 0.0;
+
+    EngineEnergy& engine = engines_.find(open.engine)->second;
+    ++engine.requests;
+    engine.wall_seconds += sample.wall_seconds;
+    engine.audio_seconds += sample.audio_seconds;
+    if (sample.cpu_known) {
+        engine.cpu_seconds += sample.cpu_seconds;
+        engine.cpu_audio_seconds += sample.audio_seconds;
+    }
+    if (sample.power_known) {
+        ++engine.measured;
+        engine.joules += sample.joules;
+        engine.measured_audio_seconds += sample.audio_seconds;
+    }
+    LOGD("%s: %.2f J%s, %.3f CPU s%s, %.2f s wall, %.2f s audio", open.engine, sample.joules,
+         sample.power_known ? "" : " (unknown)", sample.cpu_seconds, sample.cpu_known ? "" : " (other thread)",
+         sample.wall_seconds, sample.audio_seconds);
+
+    open.token = 0;
+    --open_count_;
+    if (open_count_ == 0) have_sample_ = false;
+    if (out != nullptr) *out = sample;
+    return true;
+}
+
+std::vector<EngineEnergy> EnergyMeter::engines() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EngineEnergy> out;
+    out.reserve(engines_.size());
+    for (const auto& entry : engines_) {
+        // begin() registers an engine before its first request ends
+        if (entry.second.requests > 0) out.push_back(entry.second);
+    }
+    return out;
+}
+
+std::string EnergyMeter::format_report() const {
+    std::string text;
+    char line[200];
+    for (const EngineEnergy& engine : engines()) {
+        snprintf(line, sizeof(line),
+                 "%-12s %5llu req  %7.2f J/req  %6.2f J/audio s  %6.3f CPU s/audio s  %7.1f CPU s  (%llu with power)\n",
+                 engine.engine.c_str(), static_cast<unsigned long long>(engine.requests),
+                 engine.joules_per_request(), engine.joules_per_audio_second(), engine.cpu_per_audio_second(),
+                 engine.cpu_seconds, static_cast<unsigned long long>(engine.measured));
+        text += line;
+    }
+    return text;
+}
+
+void EnergyMeter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || open_count_ > 0; });
+        if (stop_) break;
+        // sysfs reads can block for a few ms; never with the lock held
+        lock.unlock();
+        double power_w = 0.0;
+        bool known = false;
+        read_power(sensors_, power_w, known);
+        lock.lock();
+        if (open_count_ > 0) {
+            advance_locked(Clock::now(), power_w, known);
+        } else {
+            power_w_ = power_w;
+            power_known_ = known;
+        }
+        cv_.wait_for(lock, interval_, [this] { return stop_; });
+    }
+}
+
+} // namespace assistant
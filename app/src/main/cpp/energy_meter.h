@@ -0,0 +1,137 @@
+/**
+ * energy_meter.h - Energy and CPU time per request, per engine
+ *
+ * Brackets a request (a transcription, a chat turn) with begin()/end().
+ * While any request is open, a sampler thread reads battery current and
+ * voltage every `sample_interval_ms` and integrates power into joules;
+ * each interval's energy is split evenly between the requests open during
+ * it. begin() and end() never touch sysfs: they close the running
+ * interval with the sampler's latest reading, and the sampler is woken
+ * to take a fresh one when a measurement opens. CPU time is that of the
+ * calling thread (CLOCK_THREAD_CPUTIME_ID), so worker threads a request
+ * starts (whisper.cpp's graph threads) are not counted, and a request
+ * that ends on another thread than it began on (a suspended chat turn)
+ * reports none.
+ *
+ * Battery figures are whole-device: they include the screen, radios and
+ * the idle floor. They are meant for comparing engines and settings under
+ * the same conditions, not as an absolute cost. While charging, or where
+ * the power_supply files are unreadable, a request's joules are reported
+ * as unknown. The sysfs root comes with the DeviceSensors argument so
+ * tests run against stand-in files.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "device_state.h"
+
+namespace assistant {
+
+struct EnergySample {
+    double joules = 0.0;            // this request's share; 0 unless power_known
+    bool power_known = false;
+    double cpu_seconds = 0.0;       // calling thread; 0 unless cpu_known
+    bool cpu_known = false;         // false when end() ran on another thread than begin()
+    double wall_seconds = 0.0;
+    double audio_seconds = 0.0;
+};
+
+struct EngineEnergy {
+    std::string engine;
+    uint64_t requests = 0;
+    uint64_t measured = 0;          // requests with known joules
+    double joules = 0.0;            // over measured requests
+    double measured_audio_seconds = 0.0;
+    double cpu_seconds = 0.0;       // over requests with known CPU time
+    double cpu_audio_seconds = 0.0;
+    double wall_seconds = 0.0;
+    double audio_seconds = 0.0;
+
+    double joules_per_request() const { return measured > 0 ? joules / static_cast<double>(measured) : 0.0; }
+    double joules_per_audio_second() const {
+        return measured_audio_seconds > 0.0 ? joules / measured_audio_seconds : 0.0;
+    }
+    double cpu_per_audio_second() const { return cpu_audio_seconds > 0.0 ? cpu_seconds / cpu_audio_seconds : 0.0; }
+};
+
+/** CPU seconds used by the calling thread so far; -1 if the clock is unavailable. */
+double thread_cpu_seconds();
+
+class EnergyMeter {
+public:
+    /** Measurements open at once; begin() past this returns 0. */
+    static constexpr size_t kMaxOpen = 8;
+    /** Engine names are kept up to this many characters. */
+    static constexpr size_t kMaxEngineName = 31;
+
+    explicit EnergyMeter(DeviceSensors sensors = DeviceSensors(), int32_t sample_interval_ms = 100);
+    ~EnergyMeter();
+
+    EnergyMeter(const EnergyMeter&) = delete;
+    EnergyMeter& operator=(const EnergyMeter&) = delete;
+
+    /**
+     * Open a measurement for `engine` on the calling thread; returns its
+     * token, or 0 when kMaxOpen measurements are already open. Allocates
+     * nothing once `engine` has been seen.
+     */
+    uint64_t begin(const char* engine);
+    uint64_t begin(const std::string& engine) { return begin(engine.c_str()); }
+
+    /** Close measurement `token`, covering `audio_seconds` of audio (0 for a chat turn). */
+    bool end(uint64_t token, double audio_seconds, EnergySample* out = nullptr);
+
+    std::vector<EngineEnergy> engines() const;
+    std::string format_report() const;
+
+    /** The meter shared by the library's engines and the app. */
+    static EnergyMeter& shared();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Open {
+        uint64_t token = 0;             // 0: slot free
+        char engine[kMaxEngineName + 1] = {};
+        Clock::time_point started;
+        std::thread::id thread;
+        double cpu_started = -1.0;
+        double joules = 0.0;            // share of the integral so far
+        bool power_unknown = false;     // an interval without a usable reading
+    };
+
+    void advance_locked(Clock::time_point now, double power_w, bool power_known);
+    void run();
+
+    DeviceSensors sensors_;
+    std::chrono::milliseconds interval_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    uint64_t next_token_ = 1;
+    std::array<Open, kMaxOpen> open_;
+    size_t open_count_ = 0;
+    std::map<std::string, EngineEnergy, std::less<>> engines_;
+
+    // Running integral of battery power while any measurement is open
+    bool have_sample_ = false;
+    Clock::time_point sampled_at_;
+    double power_w_ = 0.0;              // latest reading, held until the next
+    bool power_known_ = false;
+
+    std::thread thread_;
+};
+
+} // namespace assistant
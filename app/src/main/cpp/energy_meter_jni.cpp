@@ -0,0 +1,63 @@
+/**
+ * energy_meter_jni.cpp - JNI bridge for the shared energy meter
+ *
+ * Lets the Kotlin engines (Vosk, cloud ASR, chat turns) report into the
+ * same per-engine table as the native ones. nativeEnd writes
+ * [joules, power known (0/1), CPU seconds, CPU known (0/1), wall seconds]
+ * into a caller-owned FloatArray.
+ */
+
+#define LOG_TAG "EnergyMeterJNI"
+
+#include <jni.h>
+
+#include "energy_meter.h"
+#include "native_log.h"
+
+using assistant::EnergyMeter;
+using assistant::EnergySample;
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_satory_graphenosai_diagnostics_EnergyMeter_nativeBegin(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jstring engine) {
+    const char* chars = env->GetStringUTFChars(engine, nullptr);
+    if (chars == nullptr) return 0;
+    const uint64_t token = EnergyMeter::shared().begin(chars);
+    env->ReleaseStringUTFChars(engine, chars);
+    return static_cast<jlong>(token);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_satory_graphenosai_diagnostics_EnergyMeter_nativeEnd(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong token,
+        jfloat audioSeconds,
+        jfloatArray out) {
+    EnergySample sample;
+    if (!EnergyMeter::shared().end(static_cast<uint64_t>(token), audioSeconds, &sample)) return JNI_FALSE;
+    if (out != nullptr && env->GetArrayLength(out) >= 5) {
+        const jfloat values[5] = {
+            static_cast<jfloat>(sample.joules),
+            sample.power_known ? 1.0f : 0.0f,
+            static_cast<jfloat>(sample.cpu_seconds),
+            sample.cpu_known ? 1.0f : 0.0f,
+            static_cast<jfloat>(sample.wall_seconds),
+        };
+        env->SetFloatArrayRegion(out, 0, 5, values);
+    }
+    return JNI_TRUE;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_satory_graphenosai_diagnostics_EnergyMeter_nativeReport(
+        JNIEnv* env,
+        jclass /* clazz */) {
+    return env->NewStringUTF(EnergyMeter::shared().format_report().c_str());
+}
+
+} // extern "C"
@@ -0,0 +1,652 @@
+/**
+ * fake_whisper.cpp - Deterministic fake whisper engine for tests and benchmarks
+ */
+
+#define LOG_TAG "FakeWhisper"
+
+#include "fake_whisper.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lru_cache.h"
+#include "native_log.h"
+
+namespace {
+    const char* kWords[] = {
+        " the", " weather", " tomorrow", " will", " be", " sunny", " and", " warm", " in", " Berlin",
+        " please", " call", " my", " mother", " at", " six", " set", " a", " timer", " for",
+        " ten", " minutes", " what", " is", " time", " it", " open", " camera", " send", " message",
+        " to", " Anna", " turn", " on", " off", " lights", " how", " far", " station", " play",
+        " music", " next", " song", " remind", " me", " buy", " milk", " today", " heute", " morgen",
+        " bitte", " Wetter", " hola", " gracias", " mañana", " привет", " спасибо", " завтра", " bonjour", " merci",
+        " demain", " yes", " no", " okay",
+    };
+    constexpr int32_t kWordCount = static_cast<int32_t>(sizeof(kWords) / sizeof(kWords[0]));
+
+    const char* kLanguages[] = { "en", "de", "es", "ru", "fr", "ja", "zh", "it", "pt", "ar" };
+    constexpr int32_t kLanguageCount = static_cast<int32_t>(sizeof(kLanguages) / sizeof(kLanguages[0]));
+
+    // Vocabulary: words, then one token per byte (for text tokenize() does not know), then specials
+    constexpr whisper_token kByteBase = kWordCount;
+    constexpr whisper_token kEot = kByteBase + 256;
+    constexpr whisper_token kSot = kEot + 1;
+    constexpr whisper_token kTranslate = kEot + 2;
+    constexpr whisper_token kTranscribe = kEot + 3;
+    constexpr whisper_token kNoTimestamps = kEot + 4;
+    constexpr whisper_token kLangBase = kEot + 5;
+    constexpr int32_t kVocab = kLangBase + kLanguageCount;
+
+    constexpr int32_t kAudioCtx = 1500;
+    constexpr int32_t kTextCtx = 448;
+    // whisper conditions each window on at most this many tokens of the text before it
+    constexpr size_t kMaxPromptTokens = kTextCtx / 2;
+    constexpr size_t kWindowSamples = WHISPER_SAMPLE_RATE * 30;
+    constexpr size_t kWordsPerSegment = 12;
+    // Well under the bridge's decoder budget of n_text_ctx / 2 tokens
+    constexpr size_t kMaxWordsPerWindow = kTextCtx / 2 - 8;
+
+    constexpr uint32_t kLiveContext = 0x46435458;
+    constexpr uint32_t kLiveState = 0x46535441;
+    constexpr uint32_t kFreed = 0xdeadbeef;
+    // Freed objects are kept (marked) this long so late use is caught, not undefined
+    constexpr size_t kQuarantine = 4096;
+
+    std::atomic<uint64_t> g_violations{0};
+    std::mutex g_violation_mutex;
+    std::string g_first_violation;
+
+    void violation(const char* fmt, ...) {
+        char message[256];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(message, sizeof(message), fmt, args);
+        va_end(args);
+        LOGE("%s", message);
+        if (g_violations++ == 0) {
+            std::lock_guard<std::mutex> lock(g_violation_mutex);
+            g_first_violation = message;
+        }
+    }
+
+    int32_t language_index(const char* language) {
+        if (language == nullptr) return -1;
+        for (int32_t i = 0; i < kLanguageCount; ++i) {
+            if (strcmp(language, kLanguages[i]) == 0) return i;
+        }
+        return -1;
+    }
+
+    struct Segment {
+        std::string text;
+        std::vector<whisper_token> tokens;
+        int64_t t0 = 0;     // centiseconds, like whisper
+        int64_t t1 = 0;
+    };
+
+    uint64_t window_hash(const float* pcm, size_t n) {
+        return assistant::fnv1a64(pcm, n * sizeof(float));
+    }
+
+    /** Words for one window of `n` samples; none for silence. */
+    size_t window_words(const assistant::FakeWhisperConfig& config, const float* pcm, size_t n) {
+        double energy = 0.0;
+        for (size_t i = 0; i < n; ++i) energy += static_cast<double>(pcm[i]) * pcm[i];
+        if (n == 0 || energy / static_cast<double>(n) < 1e-6) return 0;
+        const double words = static_cast<double>(n) / WHISPER_SAMPLE_RATE * config.words_per_second;
+        return std::min(kMaxWordsPerWindow, std::max<size_t>(1, static_cast<size_t>(std::lround(words))));
+    }
+
+    /** What a window is conditioned on: the last tokens of `past` whisper would use as its prompt; 0 for none. */
+    uint64_t prompt_hash(const std::vector<whisper_token>& past, size_t limit) {
+        const size_t n = std::min(limit, past.size());
+        return n > 0 ? assistant::fnv1a64(past.data() + past.size() - n, n * sizeof(whisper_token)) : 0;
+    }
+
+    std::vector<whisper_token> window_tokens(const assistant::FakeWhisperConfig& config, uint64_t hash,
+                                             size_t words, int32_t language, bool translate, uint64_t prompt) {
+        std::mt19937_64 rng(hash ^ (static_cast<uint64_t>(language + 1) * 0x9e3779b97f4a7c15ull) ^
+                            (translate ? 0x5bd1e9955bd1e995ull : 0) ^ config.seed ^ (prompt * 0xc2b2ae3d27d4eb4full));
+        std::vector<whisper_token> tokens(words);
+        for (whisper_token& token : tokens) token = static_cast<whisper_token>(rng() % kWordCount);
+        return tokens;
+    }
+
+    const char* token_text(whisper_token token) {
+        static const auto bytes = [] {
+            std::vector<std::array<char, 2>> table(256);
+            for (int i = 0; i < 256; ++i) table[i] = { static_cast<char>(i), '\0' };
+            return table;
+        }();
+        if (token >= 0 && token < kWordCount) return kWords[token];
+        if (token >= kByteBase && token < kEot) return bytes[token - kByteBase].data();
+        if (token == kEot) return "[_EOT_]";
+        if (token == kSot) return "[_SOT_]";
+        if (token == kTranslate) return "[_TRANSLATE_]";
+        if (token == kTranscribe) return "[_TRANSCRIBE_]";
+        if (token == kNoTimestamps) return "[_NOT_]";
+        if (token >= kLangBase && token < kVocab) return kLanguages[token - kLangBase];
+        return nullptr;
+    }
+
+    /** Sleep `ms`, polling the abort callback; false if it asked to stop. */
+    bool simulate(double ms, const whisper_full_params& params) {
+        const auto aborted = [&params] {
+            return params.abort_callback != nullptr && params.abort_callback(params.abort_callback_user_data);
+        };
+        if (ms <= 0.0) return !aborted();
+        const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+        while (true) {
+            if (aborted()) return false;
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return true;
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                deadline - now, std::chrono::milliseconds(1)));
+        }
+    }
+}
+
+struct whisper_state {
+    uint32_t magic = kLiveState;
+    whisper_context* ctx = nullptr;
+    std::atomic<int32_t> busy{0};
+    std::vector<Segment> segments;
+
+    // Encoder output of the last single-window clip, for the decoder API
+    bool encoded = false;
+    uint64_t hash = 0;
+    size_t words = 0;
+    uint64_t prompt = 0;
+
+    // Decoder position since n_past == 0
+    int32_t language = 0;
+    bool translate = false;
+    size_t text_tokens = 0;
+    std::vector<float> logits;
+};
+
+struct whisper_context {
+    uint32_t magic = kLiveContext;
+    assistant::FakeWhisperConfig config;
+    std::unique_ptr<whisper_state> own;         // used by whisper_full; null when loaded without a state
+    std::atomic<int32_t> states{0};             // alive from whisper_init_state
+};
+
+namespace {
+    std::mutex g_quarantine_mutex;
+    std::deque<std::unique_ptr<whisper_state>> g_freed_states;
+    std::deque<std::unique_ptr<whisper_context>> g_freed_contexts;
+    std::atomic<int32_t> g_peak_states{0};
+
+    void note_states(const whisper_context* ctx, int32_t alive) {
+        const int32_t total = alive + (ctx->own ? 1 : 0);
+        int32_t peak = g_peak_states.load();
+        while (total > peak && !g_peak_states.compare_exchange_weak(peak, total)) {
+        }
+    }
+
+    template <typename T>
+    void quarantine(std::deque<std::unique_ptr<T>>& freed, T* object) {
+        std::lock_guard<std::mutex> lock(g_quarantine_mutex);
+        freed.emplace_back(object);
+        if (freed.size() > kQuarantine) freed.pop_front();
+    }
+
+    bool live_context(const whisper_context* ctx, const char* call) {
+        if (ctx == nullptr || ctx->magic != kLiveContext) {
+            violation("%s on a %s context", call, ctx == nullptr ? "null" : "freed");
+            return false;
+        }
+        return true;
+    }
+
+    /** Exclusive use of a state for one call; flags overlapping or cross-context use. */
+    thread_local int32_t t_engine_depth = 0;
+
+    /** Marks the calling thread as inside the engine; see fake_whisper_in_engine(). */
+    class EngineCall {
+    public:
+        EngineCall() { ++t_engine_depth; }
+        ~EngineCall() { --t_engine_depth; }
+
+        EngineCall(const EngineCall&) = delete;
+        EngineCall& operator=(const EngineCall&) = delete;
+    };
+
+    class StateUse {
+    public:
+        StateUse(whisper_context* ctx, whisper_state* state, const char* call) {
+            if (state == nullptr || state->magic != kLiveState) {
+                violation("%s on a %s state", call, state == nullptr ? "null" : "freed");
+                return;
+            }
+            if (!live_context(state->ctx, call)) return;
+            if (ctx != nullptr && ctx != state->ctx) {
+                violation("%s with a state of another context", call);
+                return;
+            }
+            if (state->busy.fetch_add(1) != 0) {
+                state->busy.fetch_sub(1);
+                violation("%s on a state another call is using", call);
+                return;
+            }
+            state_ = state;
+        }
+
+        ~StateUse() {
+            if (state_ != nullptr) state_->busy.fetch_sub(1);
+        }
+
+        StateUse(const StateUse&) = delete;
+        StateUse& operator=(const StateUse&) = delete;
+
+        bool ok() const { return state_ != nullptr; }
+
+    private:
+        EngineCall call_;
+        whisper_state* state_ = nullptr;
+    };
+
+    void append_segments(whisper_state* state, const std::vector<whisper_token>& tokens, size_t first_sample,
+                         size_t n_samples, bool single_segment) {
+        const size_t per_segment = single_segment ? std::max<size_t>(1, tokens.size()) : kWordsPerSegment;
+        const int64_t start_cs = static_cast<int64_t>(first_sample * 100 / WHISPER_SAMPLE_RATE);
+        const int64_t length_cs = static_cast<int64_t>(n_samples * 100 / WHISPER_SAMPLE_RATE);
+        for (size_t begin = 0; begin < tokens.size(); begin += per_segment) {
+            const size_t end = std::min(tokens.size(), begin + per_segment);
+            Segment segment;
+            for (size_t i = begin; i < end; ++i) segment.text += token_text(tokens[i]);
+            segment.tokens.assign(tokens.begin() + static_cast<std::ptrdiff_t>(begin),
+                                  tokens.begin() + static_cast<std::ptrdiff_t>(end));
+            segment.t0 = start_cs + length_cs * static_cast<int64_t>(begin) / static_cast<int64_t>(tokens.size());
+            segment.t1 = start_cs + length_cs * static_cast<int64_t>(end) / static_cast<int64_t>(tokens.size());
+            state->segments.push_back(std::move(segment));
+        }
+    }
+
+    /** Greedy decode of one window through the logits filter, as whisper_full does with one installed. */
+    std::vector<whisper_token> filtered_decode(whisper_context* ctx, whisper_state* state,
+                                               const whisper_full_params& params,
+                                               const std::vector<whisper_token>& target) {
+        std::vector<whisper_token> out;
+        std::vector<whisper_token_data> history;
+        std::vector<float>& logits = state->logits;
+        logits.resize(kVocab);
+        const size_t limit = params.max_tokens > 0 ? static_cast<size_t>(params.max_tokens) : target.size() + 1;
+        while (out.size() < limit) {
+            std::fill(logits.begin(), logits.end(), 0.0f);
+            logits[out.size() < target.size() ? target[out.size()] : kEot] = 10.0f;
+            params.logits_filter_callback(ctx, state, history.data(), static_cast<int>(history.size()),
+                                          logits.data(), params.logits_filter_callback_user_data);
+            const auto best = static_cast<whisper_token>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+            if (best == kEot) break;
+            whisper_token_data data = {};
+            data.id = best;
+            history.push_back(data);
+            out.push_back(best);
+        }
+        return out;
+    }
+}
+
+namespace assistant {
+
+void parse_fake_whisper_config(const std::string& text, FakeWhisperConfig& config) {
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+        const char* value = line.c_str() + eq + 1;
+        if (key == "load_ms") config.load_ms = static_cast<int32_t>(atoi(value));
+        else if (key == "encode_ms") config.encode_ms = static_cast<int32_t>(atoi(value));
+        else if (key == "decode_ms_per_token") config.decode_ms_per_token = atof(value);
+        else if (key == "words_per_second") config.words_per_second = atof(value);
+        else if (key == "seed") config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+    }
+}
+
+std::string fake_whisper_transcript(const FakeWhisperConfig& config, const float* pcm, size_t n_samples,
+                                    const char* language, bool translate) {
+    const int32_t lang = std::max(0, language_index(language));
+    std::string text;
+    std::vector<whisper_token> past;
+    for (size_t offset = 0; offset < n_samples; offset += kWindowSamples) {
+        const size_t n = std::min(kWindowSamples, n_samples - offset);
+        const size_t words = window_words(config, pcm + offset, n);
+        const std::vector<whisper_token> tokens =
+            window_tokens(config, window_hash(pcm + offset, n), words, lang, translate, prompt_hash(past, kMaxPromptTokens));
+        for (whisper_token token : tokens) text += token_text(token);
+        past.insert(past.end(), tokens.begin(), tokens.end());
+    }
+    return text;
+}
+
+uint64_t fake_whisper_violations() {
+    return g_violations.load();
+}
+
+bool fake_whisper_in_engine() {
+    return t_engine_depth > 0;
+}
+
+int32_t fake_whisper_peak_states() {
+    return g_peak_states.load();
+}
+
+std::string fake_whisper_first_violation() {
+    std::lock_guard<std::mutex> lock(g_violation_mutex);
+    return g_first_violation;
+}
+
+} // namespace assistant
+
+namespace {
+    whisper_context* load_context(const char* path_model, bool with_state) {
+        std::ifstream file(path_model != nullptr ? path_model : "", std::ios::binary);
+        if (!file) {
+            LOGE("Cannot open model %s", path_model != nullptr ? path_model : "(null)");
+            return nullptr;
+        }
+        // Real model files are binary; only a leading text header can hold settings
+        std::string header(64 * 1024, '\0');
+        file.read(&header[0], static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(file.gcount()));
+
+        auto* ctx = new whisper_context();
+        assistant::parse_fake_whisper_config(header, ctx->config);
+        if (with_state) {
+            ctx->own.reset(new whisper_state());
+            ctx->own->ctx = ctx;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(ctx->config.load_ms));
+        return ctx;
+    }
+}
+
+extern "C" {
+
+struct whisper_context_params whisper_context_default_params(void) {
+    whisper_context_params params = {};
+    params.use_gpu = false;
+    return params;
+}
+
+struct whisper_context* whisper_init_from_file_with_params(const char* path_model,
+                                                           struct whisper_context_params /* params */) {
+    EngineCall call;
+    return load_context(path_model, true);
+}
+
+struct whisper_context* whisper_init_from_file_with_params_no_state(const char* path_model,
+                                                                    struct whisper_context_params /* params */) {
+    EngineCall call;
+    return load_context(path_model, false);
+}
+
+struct whisper_state* whisper_init_state(struct whisper_context* ctx) {
+    EngineCall call;
+    if (!live_context(ctx, "whisper_init_state")) return nullptr;
+    auto* state = new whisper_state();
+    state->ctx = ctx;
+    note_states(ctx, ctx->states.fetch_add(1) + 1);
+    return state;
+}
+
+void whisper_free(struct whisper_context* ctx) {
+    EngineCall call;
+    if (ctx == nullptr) return;
+    if (!live_context(ctx, "whisper_free")) return;
+    const int32_t alive = ctx->states.load();
+    if (alive != 0) {
+        violation("whisper_free with %d states of the context still alive", alive);
+    }
+    if (ctx->own) {
+        if (ctx->own->busy.load() != 0) {
+            violation("whisper_free while whisper_full is running on the context");
+        }
+        ctx->own->magic = kFreed;
+        quarantine(g_freed_states, ctx->own.release());
+    }
+    ctx->magic = kFreed;
+    quarantine(g_freed_contexts, ctx);
+}
+
+void whisper_free_state(struct whisper_state* state) {
+    EngineCall call;
+    if (state == nullptr) return;
+    if (state->magic != kLiveState) {
+        violation("whisper_free_state on a freed state");
+        return;
+    }
+    if (state->ctx->magic != kLiveContext) {
+        violation("whisper_free_state after its context was freed");
+    } else {
+        state->ctx->states.fetch_sub(1);
+    }
+    if (state->busy.load() != 0) {
+        violation("whisper_free_state while another call is using the state");
+    }
+    state->magic = kFreed;
+    state->segments.clear();
+    state->segments.shrink_to_fit();
+    state->logits.clear();
+    state->logits.shrink_to_fit();
+    quarantine(g_freed_states, state);
+}
+
+struct whisper_full_params whisper_full_default_params(enum whisper_sampling_strategy strategy) {
+    whisper_full_params params = {};
+    params.strategy = strategy;
+    params.n_threads = 4;
+    params.n_max_text_ctx = 16384;
+    params.no_timestamps = false;
+    params.print_progress = true;
+    params.print_timestamps = true;
+    params.language = "en";
+    params.temperature = 0.0f;
+    params.temperature_inc = 0.2f;
+    params.greedy.best_of = 5;
+    params.beam_search.beam_size = 5;
+    params.beam_search.patience = -1.0f;
+    return params;
+}
+
+int whisper_full_with_state(struct whisper_context* ctx, struct whisper_state* state,
+                            struct whisper_full_params params, const float* samples, int n_samples) {
+    StateUse use(ctx, state, "whisper_full_with_state");
+    if (!use.ok()) return -1;
+    const assistant::FakeWhisperConfig& config = ctx->config;
+    const int32_t language = std::max(0, language_index(params.language));
+    const int32_t audio_ctx = params.audio_ctx > 0 ? std::min(params.audio_ctx, kAudioCtx) : kAudioCtx;
+    const size_t total = n_samples > 0 ? static_cast<size_t>(n_samples) : 0;
+    const size_t prompt_limit = std::min(kMaxPromptTokens, static_cast<size_t>(std::max(0, params.n_max_text_ctx)));
+    std::vector<whisper_token> past;
+    if (params.prompt_tokens != nullptr && params.prompt_n_tokens > 0) {
+        past.assign(params.prompt_tokens, params.prompt_tokens + params.prompt_n_tokens);
+    }
+
+    state->segments.clear();
+    state->encoded = false;
+    for (size_t offset = 0; offset < total; offset += kWindowSamples) {
+        const size_t n = std::min(kWindowSamples, total - offset);
+        if (params.encoder_begin_callback != nullptr &&
+            !params.encoder_begin_callback(ctx, state, params.encoder_begin_callback_user_data)) {
+            return -6;
+        }
+        if (!simulate(static_cast<double>(config.encode_ms) * audio_ctx / kAudioCtx, params)) return -6;
+
+        // A reduced context only encodes the start of the window; the decoder never hears the rest
+        const size_t seen = std::min(n, kWindowSamples * static_cast<size_t>(audio_ctx) / kAudioCtx);
+        const uint64_t hash = window_hash(samples + offset, seen);
+        const size_t words = window_words(config, samples + offset, seen);
+        const uint64_t prompt = prompt_hash(past, prompt_limit);
+        std::vector<whisper_token> tokens = window_tokens(config, hash, words, language, params.translate, prompt);
+        if (params.logits_filter_callback != nullptr) {
+            tokens = filtered_decode(ctx, state, params, tokens);
+        } else if (params.max_tokens > 0 && tokens.size() > static_cast<size_t>(params.max_tokens)) {
+            tokens.resize(static_cast<size_t>(params.max_tokens));
+        }
+        if (!simulate(config.decode_ms_per_token * static_cast<double>(tokens.size() + 1), params)) return -6;
+        append_segments(state, tokens, offset, n, params.single_segment);
+        past.insert(past.end(), tokens.begin(), tokens.end());
+
+        state->hash = hash;
+        state->words = words;
+        state->prompt = prompt;
+    }
+    // Only a single-window encoding can be decoded again
+    state->encoded = total > 0 && total <= kWindowSamples;
+    return 0;
+}
+
+int whisper_full(struct whisper_context* ctx, struct whisper_full_params params,
+                 const float* samples, int n_samples) {
+    if (!live_context(ctx, "whisper_full")) return -1;
+    return whisper_full_with_state(ctx, ctx->own.get(), params, samples, n_samples);
+}
+
+int whisper_full_n_segments_from_state(struct whisper_state* state) {
+    StateUse use(nullptr, state, "whisper_full_n_segments");
+    return use.ok() ? static_cast<int>(state->segments.size()) : 0;
+}
+
+int whisper_full_n_segments(struct whisper_context* ctx) {
+    if (!live_context(ctx, "whisper_full_n_segments")) return 0;
+    return whisper_full_n_segments_from_state(ctx->own.get());
+}
+
+const char* whisper_full_get_segment_text_from_state(struct whisper_state* state, int i_segment) {
+    StateUse use(nullptr, state, "whisper_full_get_segment_text");
+    if (!use.ok() || i_segment < 0 || static_cast<size_t>(i_segment) >= state->segments.size()) return nullptr;
+    return state->segments[static_cast<size_t>(i_segment)].text.c_str();
+}
+
+const char* whisper_full_get_segment_text(struct whisper_context* ctx, int i_segment) {
+    if (!live_context(ctx, "whisper_full_get_segment_text")) return nullptr;
+    return whisper_full_get_segment_text_from_state(ctx->own.get(), i_segment);
+}
+
+int64_t whisper_full_get_segment_t0_from_state(struct whisper_state* state, int i_segment) {
+    StateUse use(nullptr, state, "whisper_full_get_segment_t0");
+    if (!use.ok() || i_segment < 0 || static_cast<size_t>(i_segment) >= state->segments.size()) return 0;
+    return state->segments[static_cast<size_t>(i_segment)].t0;
+}
+
+int64_t whisper_full_get_segment_t1_from_state(struct whisper_state* state, int i_segment) {
+    StateUse use(nullptr, state, "whisper_full_get_segment_t1");
+    if (!use.ok() || i_segment < 0 || static_cast<size_t>(i_segment) >= state->segments.size()) return 0;
+    return state->segments[static_cast<size_t>(i_segment)].t1;
+}
+
+int whisper_full_n_tokens_from_state(struct whisper_state* state, int i_segment) {
+    StateUse use(nullptr, state, "whisper_full_n_tokens");
+    if (!use.ok() || i_segment < 0 || static_cast<size_t>(i_segment) >= state->segments.size()) return 0;
+    return static_cast<int>(state->segments[static_cast<size_t>(i_segment)].tokens.size());
+}
+
+whisper_token whisper_full_get_token_id_from_state(struct whisper_state* state, int i_segment, int i_token) {
+    StateUse use(nullptr, state, "whisper_full_get_token_id");
+    if (!use.ok() || i_segment < 0 || static_cast<size_t>(i_segment) >= state->segments.size()) return kEot;
+    const std::vector<whisper_token>& tokens = state->segments[static_cast<size_t>(i_segment)].tokens;
+    return i_token >= 0 && static_cast<size_t>(i_token) < tokens.size() ? tokens[static_cast<size_t>(i_token)] : kEot;
+}
+
+int whisper_decode_with_state(struct whisper_context* ctx, struct whisper_state* state,
+                              const whisper_token* tokens, int n_tokens, int n_past, int /* n_threads */) {
+    StateUse use(ctx, state, "whisper_decode_with_state");
+    if (!use.ok() || !state->encoded) return -1;
+    if (n_past == 0) {
+        state->language = 0;
+        state->translate = false;
+        state->text_tokens = 0;
+    }
+    for (int i = 0; i < n_tokens; ++i) {
+        const whisper_token token = tokens[i];
+        if (token >= kLangBase && token < kVocab) state->language = token - kLangBase;
+        else if (token == kTranslate) state->translate = true;
+        else if (token == kTranscribe) state->translate = false;
+        else if (token >= 0 && token < kEot) ++state->text_tokens;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ctx->config.decode_ms_per_token * n_tokens));
+
+    const std::vector<whisper_token> expected =
+        window_tokens(ctx->config, state->hash, state->words, state->language, state->translate, state->prompt);
+    state->logits.assign(kVocab, 0.0f);
+    state->logits[state->text_tokens < expected.size() ? expected[state->text_tokens] : kEot] = 10.0f;
+    return 0;
+}
+
+float* whisper_get_logits_from_state(struct whisper_state* state) {
+    StateUse use(nullptr, state, "whisper_get_logits");
+    return use.ok() && !state->logits.empty() ? state->logits.data() : nullptr;
+}
+
+int whisper_tokenize(struct whisper_context* ctx, const char* text, whisper_token* tokens, int n_max_tokens) {
+    EngineCall call;
+    if (!live_context(ctx, "whisper_tokenize") || text == nullptr) return -1;
+    std::vector<whisper_token> out;
+    const std::string input(text);
+    size_t start = 0;
+    while (start < input.size()) {
+        // Pieces run from one space to the next, like the words of the vocabulary
+        size_t end = input.find(' ', start + 1);
+        if (end == std::string::npos) end = input.size();
+        const std::string piece = input.substr(start, end - start);
+        const auto word = std::find_if(kWords, kWords + kWordCount, [&piece](const char* w) { return piece == w; });
+        if (word != kWords + kWordCount) {
+            out.push_back(static_cast<whisper_token>(word - kWords));
+        } else {
+            for (unsigned char c : piece) out.push_back(kByteBase + c);
+        }
+        start = end;
+    }
+    if (out.size() > static_cast<size_t>(std::max(0, n_max_tokens))) return -static_cast<int>(out.size());
+    std::copy(out.begin(), out.end(), tokens);
+    return static_cast<int>(out.size());
+}
+
+const char* whisper_token_to_str(struct whisper_context* ctx, whisper_token token) {
+    if (!live_context(ctx, "whisper_token_to_str")) return nullptr;
+    return token_text(token);
+}
+
+int whisper_n_vocab(struct whisper_context* ctx) { return live_context(ctx, "whisper_n_vocab") ? kVocab : 0; }
+int whisper_n_text_ctx(struct whisper_context* ctx) { return live_context(ctx, "whisper_n_text_ctx") ? kTextCtx : 0; }
+int whisper_n_audio_ctx(struct whisper_context* ctx) { return live_context(ctx, "whisper_n_audio_ctx") ? kAudioCtx : 0; }
+int whisper_is_multilingual(struct whisper_context* ctx) { return live_context(ctx, "whisper_is_multilingual") ? 1 : 0; }
+int whisper_lang_id(const char* lang) { return language_index(lang); }
+
+whisper_token whisper_token_eot(struct whisper_context* /* ctx */) { return kEot; }
+whisper_token whisper_token_sot(struct whisper_context* /* ctx */) { return kSot; }
+whisper_token whisper_token_not(struct whisper_context* /* ctx */) { return kNoTimestamps; }
+whisper_token whisper_token_translate(struct whisper_context* /* ctx */) { return kTranslate; }
+whisper_token whisper_token_transcribe(struct whisper_context* /* ctx */) { return kTranscribe; }
+whisper_token whisper_token_lang(struct whisper_context* /* ctx */, int lang_id) { return kLangBase + lang_id; }
+
+const char* whisper_print_system_info(void) {
+    return "fake-whisper (deterministic test engine)";
+}
+
+} // extern "C"
@@ -0,0 +1,84 @@
+/**
+ * fake_whisper.h - Deterministic fake whisper engine for tests and benchmarks
+ *
+ * fake_whisper.cpp implements whisper.h without a model, so the JNI bridge
+ * and everything above it can run on a Linux host, or in a debug build
+ * made with WHISPER_BACKEND=fake. The transcript is a
+ * function of the audio, language, task and prompt: words are drawn from a
+ * small vocabulary with a generator seeded by a hash of the PCM, at about
+ * words_per_second of audio (silence gives no words). Clips longer than
+ * 30 s are handled window by window, like whisper_full, and each window
+ * after the first also depends on the text before it (the last
+ * n_text_ctx / 2 tokens, the prompt whisper keeps); prompt_tokens stand in
+ * for that text at the start of a call. A caller that splits a recording
+ * into separate calls gets the same transcript only if it passes that
+ * context on. The decoder API
+ * (whisper_decode_with_state + logits) continues the same transcript, so
+ * re-decoding an encoded state matches a fresh whisper_full.
+ *
+ * A reduced audio_ctx covers only the start of each window, as in the
+ * real encoder: audio past it does not reach the transcript, so a context
+ * sized too small for the clip changes the text.
+ *
+ * Latency is simulated by sleeping: encode_ms per 30 s window (scaled by
+ * the requested audio_ctx) and decode_ms_per_token. Both sleeps poll the
+ * abort callback every millisecond, so preemption behaves like the real
+ * engine.
+ *
+ * The "model file" is any readable file; lines of the form key=value set
+ * the FakeWhisperConfig fields below, everything else is ignored.
+ *
+ * The fake also checks how it is used and counts violations: a state used
+ * by two calls at once, a state used with a context other than its own, a
+ * context freed while states created from it are alive, and calls on a
+ * freed context. These are the mistakes that corrupt memory in the real
+ * engine, where they are much harder to see.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace assistant {
+
+struct FakeWhisperConfig {
+    int32_t load_ms = 0;                // model load
+    int32_t encode_ms = 0;              // one full 30 s window
+    double decode_ms_per_token = 0.0;
+    double words_per_second = 2.5;
+    uint32_t seed = 0;                  // varies the transcript, e.g. per model tier
+};
+
+/** Apply the key=value lines of `text` to `config`; unknown keys are ignored. */
+void parse_fake_whisper_config(const std::string& text, FakeWhisperConfig& config);
+
+/**
+ * The transcript whisper_full produces for `pcm` with `config`, for
+ * `language` (unknown or "auto": English) and task. Tests use it to
+ * check what came back through the bridge.
+ */
+std::string fake_whisper_transcript(const FakeWhisperConfig& config, const float* pcm, size_t n_samples,
+                                    const char* language, bool translate);
+
+/** Misuse detected since the process started; see the file comment. */
+uint64_t fake_whisper_violations();
+
+/**
+ * True while the calling thread is inside a fake engine call that may use
+ * the heap, so host tests can count the bridge's allocations apart from
+ * the engine's own.
+ */
+bool fake_whisper_in_engine();
+
+/**
+ * The most states one context has had alive at once since the process
+ * started, its own (see whisper_init_from_file_with_params) included.
+ */
+int32_t fake_whisper_peak_states();
+
+/** Description of the first violation, or empty. */
+std::string fake_whisper_first_violation();
+
+} // namespace assistant
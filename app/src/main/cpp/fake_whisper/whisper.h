@@ -0,0 +1,153 @@
+/**
+ * whisper.h - Deterministic stand-in for the whisper.cpp API
+ *
+ * Declares the subset of whisper.cpp's public API that whisper_jni.cpp
+ * uses, with the same names and signatures, so the bridge builds against
+ * fake_whisper.cpp instead of the real engine. See fake_whisper.h for what
+ * the fake does and the checks it makes.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WHISPER_SAMPLE_RATE 16000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct whisper_context;
+struct whisper_state;
+
+typedef int32_t whisper_token;
+
+typedef struct whisper_token_data {
+    whisper_token id;
+    whisper_token tid;
+    float p;
+    float plog;
+    float pt;
+    float ptsum;
+    int64_t t0;
+    int64_t t1;
+    int64_t t_dtw;
+    float vlen;
+} whisper_token_data;
+
+struct whisper_context_params {
+    bool use_gpu;
+    bool flash_attn;
+    int gpu_device;
+};
+
+enum whisper_sampling_strategy {
+    WHISPER_SAMPLING_GREEDY,
+    WHISPER_SAMPLING_BEAM_SEARCH,
+};
+
+typedef bool (*ggml_abort_callback)(void* data);
+typedef bool (*whisper_encoder_begin_callback)(struct whisper_context* ctx, struct whisper_state* state,
+                                               void* user_data);
+typedef void (*whisper_logits_filter_callback)(struct whisper_context* ctx, struct whisper_state* state,
+                                               const whisper_token_data* tokens, int n_tokens, float* logits,
+                                               void* user_data);
+
+struct whisper_full_params {
+    enum whisper_sampling_strategy strategy;
+
+    int n_threads;
+    int n_max_text_ctx;
+    int offset_ms;
+    int duration_ms;
+
+    bool translate;
+    bool no_context;
+    bool no_timestamps;
+    bool single_segment;
+    bool print_special;
+    bool print_progress;
+    bool print_realtime;
+    bool print_timestamps;
+
+    int max_tokens;
+    int audio_ctx;
+
+    const whisper_token* prompt_tokens;
+    int prompt_n_tokens;
+
+    const char* language;
+    bool detect_language;
+
+    float temperature;
+    float temperature_inc;
+
+    struct {
+        int best_of;
+    } greedy;
+
+    struct {
+        int beam_size;
+        float patience;
+    } beam_search;
+
+    whisper_encoder_begin_callback encoder_begin_callback;
+    void* encoder_begin_callback_user_data;
+
+    ggml_abort_callback abort_callback;
+    void* abort_callback_user_data;
+
+    whisper_logits_filter_callback logits_filter_callback;
+    void* logits_filter_callback_user_data;
+};
+
+struct whisper_context_params whisper_context_default_params(void);
+struct whisper_context* whisper_init_from_file_with_params(const char* path_model,
+                                                           struct whisper_context_params params);
+struct whisper_context* whisper_init_from_file_with_params_no_state(const char* path_model,
+                                                                    struct whisper_context_params params);
+struct whisper_state* whisper_init_state(struct whisper_context* ctx);
+void whisper_free(struct whisper_context* ctx);
+void whisper_free_state(struct whisper_state* state);
+
+struct whisper_full_params whisper_full_default_params(enum whisper_sampling_strategy strategy);
+int whisper_full(struct whisper_context* ctx, struct whisper_full_params params,
+                 const float* samples, int n_samples);
+int whisper_full_with_state(struct whisper_context* ctx, struct whisper_state* state,
+                            struct whisper_full_params params, const float* samples, int n_samples);
+
+int whisper_full_n_segments(struct whisper_context* ctx);
+int whisper_full_n_segments_from_state(struct whisper_state* state);
+const char* whisper_full_get_segment_text(struct whisper_context* ctx, int i_segment);
+const char* whisper_full_get_segment_text_from_state(struct whisper_state* state, int i_segment);
+int64_t whisper_full_get_segment_t0_from_state(struct whisper_state* state, int i_segment);
+int64_t whisper_full_get_segment_t1_from_state(struct whisper_state* state, int i_segment);
+int whisper_full_n_tokens_from_state(struct whisper_state* state, int i_segment);
+whisper_token whisper_full_get_token_id_from_state(struct whisper_state* state, int i_segment, int i_token);
+
+int whisper_decode_with_state(struct whisper_context* ctx, struct whisper_state* state,
+                              const whisper_token* tokens, int n_tokens, int n_past, int n_threads);
+float* whisper_get_logits_from_state(struct whisper_state* state);
+int whisper_tokenize(struct whisper_context* ctx, const char* text, whisper_token* tokens, int n_max_tokens);
+const char* whisper_token_to_str(struct whisper_context* ctx, whisper_token token);
+
+int whisper_n_vocab(struct whisper_context* ctx);
+int whisper_n_text_ctx(struct whisper_context* ctx);
+int whisper_n_audio_ctx(struct whisper_context* ctx);
+int whisper_is_multilingual(struct whisper_context* ctx);
+int whisper_lang_id(const char* lang);
+
+whisper_token whisper_token_eot(struct whisper_context* ctx);
+whisper_token whisper_token_sot(struct whisper_context* ctx);
+whisper_token whisper_token_not(struct whisper_context* ctx);
+whisper_token whisper_token_translate(struct whisper_context* ctx);
+whisper_token whisper_token_transcribe(struct whisper_context* ctx);
+whisper_token whisper_token_lang(struct whisper_context* ctx, int lang_id);
+
+const char* whisper_print_system_info(void);
+
+#ifdef __cplusplus
+}
+#endif
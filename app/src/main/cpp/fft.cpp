@@ -0,0 +1,81 @@
+/**
+ * fft.cpp - Iterative radix-2 FFT
+ */
+
+#include "fft.h"
+
+#include <cmath>
+#include <utility>
+
+namespace assistant {
+
+Fft::Fft(size_t n) : n_(n), bitrev_(n), twiddles_(n / 2) {
+    size_t bits = 0;
+    while ((size_t{1} << bits) < n) ++bits;
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & (size_t{1} << b)) r |= size_t{1} << (bits - 1 - b);
+        }
+        bitrev_[i] = r;
+    }
+
+    for (size_t k = 0; k < n / 2; ++k) {
+        const double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+        twiddles_[k] = std::complex<float>(static_cast<float>(std::cos(angle)),
+                                           static_cast<float>(std::sin(angle)));
+    }
+}
+
+void Fft::transform(std::complex<float>* data, bool inverse) const {
+    for (size_t i = 0; i < n_; ++i) {
+        const size_t j = bitrev_[i];
+        if (j > i) std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= n_; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = n_ / len;
+        for (size_t start = 0; start < n_; start += len) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<float> w = twiddles_[k * step];
+                if (inverse) w = std::conj(w);
+                const std::complex<float> t = w * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
+
+void Fft::forward(std::complex<float>* data) const {
+    transform(data, false);
+}
+
+void Fft::inverse(std::complex<float>* data) const {
+    transform(data, true);
+    const float scale = 1.0f / static_cast<float>(n_);
+    for (size_t i = 0; i < n_; ++i) data[i] *= scale;
+}
+
+void Fft::forward_real(const float* in, std::complex<float>* out,
+                       std::complex<float>* scratch) const {
+    for (size_t i = 0; i < n_; ++i) scratch[i] = std::complex<float>(in[i], 0.0f);
+    transform(scratch, false);
+    for (size_t i = 0; i <= n_ / 2; ++i) out[i] = scratch[i];
+}
+
+void Fft::inverse_real(const std::complex<float>* in, float* out,
+                       std::complex<float>* scratch) const {
+    scratch[0] = in[0];
+    for (size_t i = 1; i < n_ / 2; ++i) {
+        scratch[i] = in[i];
+        scratch[n_ - i] = std::conj(in[i]);
+    }
+    scratch[n_ / 2] = in[n_ / 2];
+    inverse(scratch);
+    for (size_t i = 0; i < n_; ++i) out[i] = scratch[i].real();
+}
+
+} // namespace assistant
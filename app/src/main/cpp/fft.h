@@ -0,0 +1,50 @@
+/**
+ * fft.h - Small radix-2 FFT for the audio front-ends
+ *
+ * Twiddles and the bit-reversal table are computed once per size, so the
+ * transform itself never allocates. Sizes must be powers of two.
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace assistant {
+
+class Fft {
+public:
+    explicit Fft(size_t n);
+
+    size_t size() const { return n_; }
+
+    /** In-place complex forward transform of size(). */
+    void forward(std::complex<float>* data) const;
+
+    /** In-place complex inverse transform of size(), scaled by 1/size(). */
+    void inverse(std::complex<float>* data) const;
+
+    /**
+     * Real forward transform: `in` has size() samples, `out` receives the
+     * size()/2 + 1 non-redundant bins. `scratch` must hold size() values.
+     */
+    void forward_real(const float* in, std::complex<float>* out,
+                      std::complex<float>* scratch) const;
+
+    /**
+     * Inverse of forward_real: `in` has size()/2 + 1 bins, `out` receives
+     * size() real samples. `scratch` must hold size() values.
+     */
+    void inverse_real(const std::complex<float>* in, float* out,
+                      std::complex<float>* scratch) const;
+
+private:
+    void transform(std::complex<float>* data, bool inverse) const;
+
+    size_t n_;
+    std::vector<size_t> bitrev_;
+    std::vector<std::complex<float>> twiddles_;
+};
+
+} // namespace assistant
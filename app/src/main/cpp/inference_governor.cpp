@@ -0,0 +1,171 @@
+/**
+ * inference_governor.cpp - Level selection, settings per level and RTF bookkeeping
+ */
+
+#define LOG_TAG "InferenceGovernor"
+
+#include "inference_governor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "native_log.h"
+
+namespace assistant {
+
+const char* thermal_level_name(ThermalLevel level) {
+    switch (level) {
+        case THERMAL_NOMINAL: return "nominal";
+        case THERMAL_WARM: return "warm";
+        case THERMAL_HOT: return "hot";
+        case THERMAL_CRITICAL: return "critical";
+    }
+    return "unknown";
+}
+
+bool GovernorDecision::same_settings(const GovernorDecision& other) const {
+    return n_threads == other.n_threads && short_utterance == other.short_utterance &&
+           audio_ctx.margin_seconds == other.audio_ctx.margin_seconds &&
+           audio_ctx.min_ctx == other.audio_ctx.min_ctx && model_tier == other.model_tier;
+}
+
+InferenceGovernor::InferenceGovernor(DeviceSensors sensors, GovernorPolicy policy)
+    : sensors_(std::move(sensors)), policy_(policy), thread_([this] { run(); }) {}
+
+InferenceGovernor::~InferenceGovernor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void InferenceGovernor::set_max_threads(int32_t threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy_.max_threads = std::max(1, threads);
+    have_last_ = false;
+}
+
+ThermalLevel InferenceGovernor::next_level(float celsius) const {
+    const float thresholds[] = { policy_.warm_celsius, policy_.hot_celsius, policy_.critical_celsius };
+    int32_t level = level_;
+    // Up as soon as a threshold is crossed, down only once clear of it by the hysteresis
+    while (level < THERMAL_CRITICAL && celsius >= thresholds[level]) ++level;
+    while (level > THERMAL_NOMINAL && celsius < thresholds[level - 1] - policy_.hysteresis_celsius) --level;
+    return static_cast<ThermalLevel>(level);
+}
+
+GovernorDecision InferenceGovernor::decide_locked(const DeviceState& state) {
+    // No readable zone: nothing to go on, stay nominal rather than guess
+    level_ = state.max_celsius > 0.0f ? next_level(state.max_celsius) : THERMAL_NOMINAL;
+
+    GovernorDecision decision;
+    decision.level = level_;
+    decision.celsius = state.max_celsius;
+    decision.battery_pct = state.battery.capacity_pct;
+    decision.battery_saver = state.battery.present && !state.battery.charging &&
+        state.battery.capacity_pct >= 0 && state.battery.capacity_pct < policy_.low_battery_pct;
+
+    const int32_t max_threads = std::max(1, policy_.max_threads);
+    switch (level_) {
+        case THERMAL_NOMINAL: decision.n_threads = max_threads; break;
+        case THERMAL_WARM: decision.n_threads = std::max(1, max_threads - 1); break;
+        case THERMAL_HOT: decision.n_threads = std::max(1, max_threads / 2); break;
+        case THERMAL_CRITICAL: decision.n_threads = 1; break;
+    }
+    if (decision.battery_saver) decision.n_threads = std::max(1, std::min(decision.n_threads, max_threads / 2));
+
+    // Encoder work scales with the context; trim the safety margin before touching the model
+    if (level_ >= THERMAL_HOT || decision.battery_saver) {
+        decision.short_utterance = true;
+        decision.audio_ctx.margin_seconds = 0.5f;
+        decision.audio_ctx.margin_fraction = 0.05f;
+    }
+    if (level_ == THERMAL_CRITICAL) decision.audio_ctx.min_ctx = 192;
+    decision.model_tier = level_ == THERMAL_CRITICAL || (level_ == THERMAL_HOT && decision.battery_saver) ? 1 : 0;
+
+    if (!have_last_ || !decision.same_settings(last_) || decision.level != last_.level) {
+        const LevelStats& before = stats_[have_last_ ? last_.level : THERMAL_NOMINAL];
+        LOGI("Governor: %s (%.1f C, battery %d%%%s) -> %d threads, %s ctx margin %.1f s, model tier %d "
+             "(mean RTF so far at %s: %.2f)",
+             thermal_level_name(decision.level), decision.celsius, decision.battery_pct,
+             decision.battery_saver ? ", saver" : "", decision.n_threads,
+             decision.short_utterance ? "short" : "default", decision.audio_ctx.margin_seconds,
+             decision.model_tier, thermal_level_name(have_last_ ? last_.level : THERMAL_NOMINAL), before.mean_rtf());
+    }
+    last_ = decision;
+    have_last_ = true;
+    return decision;
+}
+
+GovernorDecision InferenceGovernor::update(const DeviceState& state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampled_at_ = Clock::now();
+    return decide_locked(state);
+}
+
+GovernorDecision InferenceGovernor::decide() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (have_last_) {
+            const auto age = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - sampled_at_);
+            if (age.count() >= policy_.sample_interval_ms && !refresh_) {
+                refresh_ = true;
+                cv_.notify_all();
+            }
+            return last_;
+        }
+    }
+    // Read sysfs outside the lock; a few dozen small files
+    const DeviceState state = sensors_.read();
+    return update(state);
+}
+
+void InferenceGovernor::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || refresh_; });
+        if (stop_) break;
+        lock.unlock();
+        const DeviceState state = sensors_.read();
+        lock.lock();
+        sampled_at_ = Clock::now();
+        decide_locked(state);
+        refresh_ = false;
+    }
+}
+
+void InferenceGovernor::record(const GovernorDecision& decision, double audio_seconds, double wall_seconds) {
+    if (audio_seconds <= 0.0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    LevelStats& stats = stats_[decision.level];
+    ++stats.requests;
+    stats.audio_seconds += audio_seconds;
+    stats.wall_seconds += wall_seconds;
+    const double rtf = wall_seconds / audio_seconds;
+    stats.max_rtf = std::max(stats.max_rtf, rtf);
+    LOGD("RTF %.2f at %s with %d threads (%.1f C)", rtf, thermal_level_name(decision.level),
+         decision.n_threads, decision.celsius);
+}
+
+LevelStats InferenceGovernor::level_stats(ThermalLevel level) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_[level];
+}
+
+std::string InferenceGovernor::format_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string text;
+    char line[160];
+    for (int32_t level = THERMAL_NOMINAL; level <= THERMAL_CRITICAL; ++level) {
+        const LevelStats& stats = stats_[level];
+        snprintf(line, sizeof(line), "%-8s %6llu requests %8.1f s audio  RTF mean %.2f max %.2f\n",
+                 thermal_level_name(static_cast<ThermalLevel>(level)),
+                 static_cast<unsigned long long>(stats.requests), stats.audio_seconds, stats.mean_rtf(), stats.max_rtf);
+        text += line;
+    }
+    return text;
+}
+
+} // namespace assistant
@@ -0,0 +1,121 @@
+/**
+ * inference_governor.h - Thermal- and battery-aware inference settings
+ *
+ * Sustained transcription heats the SoC until the kernel caps the CPU
+ * clocks, and latency then collapses mid-session. The governor tracks the
+ * device state and steps the engine down before that happens: fewer
+ * threads as the device warms, a tighter encoder context when hot, and a
+ * smaller model when critical or when hot on a low battery. Only the first
+ * decision reads sysfs on the caller's thread; after that a stale reading
+ * is refreshed by the governor's own thread while requests keep the last
+ * settings, so a request never waits on (or allocates for) the sensors. Levels only drop back after the temperature has fallen by a
+ * hysteresis margin, so settings do not flap around a threshold.
+ *
+ * Each request's real-time factor is recorded against the level it ran
+ * at, which shows whether stepping down actually kept latency in check.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "audio_context.h"
+#include "device_state.h"
+
+namespace assistant {
+
+enum ThermalLevel : int32_t {
+    THERMAL_NOMINAL = 0,
+    THERMAL_WARM = 1,
+    THERMAL_HOT = 2,
+    THERMAL_CRITICAL = 3,
+};
+
+const char* thermal_level_name(ThermalLevel level);
+
+struct GovernorPolicy {
+    float warm_celsius = 42.0f;
+    float hot_celsius = 50.0f;
+    float critical_celsius = 60.0f;
+    float hysteresis_celsius = 3.0f;    // cool this far below a threshold to step back up
+    int32_t low_battery_pct = 20;       // battery saver below this while discharging
+    int32_t max_threads = 4;
+    int32_t sample_interval_ms = 2000;  // sysfs is re-read at most this often
+};
+
+struct GovernorDecision {
+    ThermalLevel level = THERMAL_NOMINAL;
+    bool battery_saver = false;
+    int32_t n_threads = 4;
+    bool short_utterance = false;       // force a reduced encoder context for short clips
+    AudioContextPolicy audio_ctx;
+    int32_t model_tier = 0;             // 0: configured model, 1: the smaller fallback
+    float celsius = 0.0f;
+    int32_t battery_pct = -1;
+
+    bool same_settings(const GovernorDecision& other) const;
+};
+
+struct LevelStats {
+    uint64_t requests = 0;
+    double audio_seconds = 0.0;
+    double wall_seconds = 0.0;
+    double max_rtf = 0.0;
+
+    double mean_rtf() const { return audio_seconds > 0.0 ? wall_seconds / audio_seconds : 0.0; }
+};
+
+class InferenceGovernor {
+public:
+    explicit InferenceGovernor(DeviceSensors sensors = DeviceSensors(), GovernorPolicy policy = GovernorPolicy());
+    ~InferenceGovernor();
+
+    InferenceGovernor(const InferenceGovernor&) = delete;
+    InferenceGovernor& operator=(const InferenceGovernor&) = delete;
+
+    /**
+     * Settings for the next request. Reads the sensors only when there is
+     * no decision yet; a stale one is returned while the refresh runs in
+     * the background.
+     */
+    GovernorDecision decide();
+
+    /** Settings for `state`, updating the level with hysteresis. */
+    GovernorDecision update(const DeviceState& state);
+
+    /** Record a finished request run with `decision`. */
+    void record(const GovernorDecision& decision, double audio_seconds, double wall_seconds);
+
+    LevelStats level_stats(ThermalLevel level) const;
+    std::string format_stats() const;
+
+    void set_max_threads(int32_t threads);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ThermalLevel next_level(float celsius) const;
+    GovernorDecision decide_locked(const DeviceState& state);
+    void run();
+
+    DeviceSensors sensors_;
+    GovernorPolicy policy_;
+    mutable std::mutex mutex_;
+    ThermalLevel level_ = THERMAL_NOMINAL;
+    GovernorDecision last_;
+    bool have_last_ = false;
+    Clock::time_point sampled_at_;
+    LevelStats stats_[4];
+
+    std::condition_variable cv_;
+    bool refresh_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace assistant
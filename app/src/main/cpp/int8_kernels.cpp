@@ -0,0 +1,207 @@
+/**
+ * int8_kernels.cpp - Quantized int8 kernels
+ */
+
+#include "int8_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace assistant {
+namespace int8 {
+
+const char* kernel_name() {
+#if defined(__ARM_NEON) && defined(__ARM_FEATURE_DOTPROD)
+    return "neon-dotprod";
+#elif defined(__ARM_NEON)
+    return "neon";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE4_1__)
+    return "sse4.1";
+#else
+    return "scalar";
+#endif
+}
+
+int32_t dot_ref(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t acc = 0;
+    for (size_t i = 0; i < n; ++i) acc += static_cast<int32_t>(a[i]) * b[i];
+    return acc;
+}
+
+int32_t dot(const int8_t* a, const int8_t* b, size_t n) {
+    size_t i = 0;
+    int32_t acc = 0;
+
+#if defined(__ARM_NEON)
+    int32x4_t vacc = vdupq_n_s32(0);
+    for (; i + 16 <= n; i += 16) {
+        const int8x16_t va = vld1q_s8(a + i);
+        const int8x16_t vb = vld1q_s8(b + i);
+#if defined(__ARM_FEATURE_DOTPROD)
+        vacc = vdotq_s32(vacc, va, vb);
+#else
+        // Two products per int16 lane: safe for symmetric [-127, 127] inputs
+        int16x8_t prod = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+        prod = vmlal_s8(prod, vget_high_s8(va), vget_high_s8(vb));
+        vacc = vpadalq_s16(vacc, prod);
+#endif
+    }
+#if defined(__aarch64__)
+    acc = vaddvq_s32(vacc);
+#else
+    acc = vgetq_lane_s32(vacc, 0) + vgetq_lane_s32(vacc, 1) +
+          vgetq_lane_s32(vacc, 2) + vgetq_lane_s32(vacc, 3);
+#endif
+
+#elif defined(__AVX2__)
+    __m256i vacc = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i a_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        const __m256i a_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+        const __m256i b_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+        const __m256i b_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+        vacc = _mm256_add_epi32(vacc, _mm256_madd_epi16(a_lo, b_lo));
+        vacc = _mm256_add_epi32(vacc, _mm256_madd_epi16(a_hi, b_hi));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(vacc), _mm256_extracti128_si256(vacc, 1));
+    sum = _mm_hadd_epi32(sum, sum);
+    sum = _mm_hadd_epi32(sum, sum);
+    acc = _mm_cvtsi128_si32(sum);
+
+#elif defined(__SSE4_1__)
+    __m128i vacc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i a_lo = _mm_cvtepi8_epi16(va);
+        const __m128i a_hi = _mm_cvtepi8_epi16(_mm_srli_si128(va, 8));
+        const __m128i b_lo = _mm_cvtepi8_epi16(vb);
+        const __m128i b_hi = _mm_cvtepi8_epi16(_mm_srli_si128(vb, 8));
+        vacc = _mm_add_epi32(vacc, _mm_madd_epi16(a_lo, b_lo));
+        vacc = _mm_add_epi32(vacc, _mm_madd_epi16(a_hi, b_hi));
+    }
+    vacc = _mm_hadd_epi32(vacc, vacc);
+    vacc = _mm_hadd_epi32(vacc, vacc);
+    acc = _mm_cvtsi128_si32(vacc);
+#endif
+
+    for (; i < n; ++i) acc += static_cast<int32_t>(a[i]) * b[i];
+    return acc;
+}
+
+void requantize(const int32_t* acc, const int32_t* bias, size_t n,
+                float scale, bool relu, int8_t* out) {
+    const int32_t lo = relu ? 0 : -127;
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t v = acc[i] + (bias != nullptr ? bias[i] : 0);
+        const int32_t q = static_cast<int32_t>(std::lrintf(static_cast<float>(v) * scale));
+        out[i] = static_cast<int8_t>(std::min(127, std::max(lo, q)));
+    }
+}
+
+void conv2d(const int8_t* in, const ConvShape& s, const int8_t* weights,
+            const int32_t* bias, float scale, bool relu, int8_t* out,
+            int8_t* patch) {
+    const int32_t k = s.kernel_h * s.kernel_w * s.in_c;
+    int32_t acc_buf[256];
+
+    for (int32_t oy = 0; oy < s.out_h; ++oy) {
+        for (int32_t ox = 0; ox < s.out_w; ++ox) {
+            // im2col for one output pixel
+            int8_t* p = patch;
+            for (int32_t ky = 0; ky < s.kernel_h; ++ky) {
+                const int32_t iy = oy * s.stride_h + ky - s.pad_h;
+                for (int32_t kx = 0; kx < s.kernel_w; ++kx) {
+                    const int32_t ix = ox * s.stride_w + kx - s.pad_w;
+                    if (iy < 0 || iy >= s.in_h || ix < 0 || ix >= s.in_w) {
+                        std::memset(p, 0, s.in_c);
+                    } else {
+                        std::memcpy(p, in + (static_cast<size_t>(iy) * s.in_w + ix) * s.in_c, s.in_c);
+                    }
+                    p += s.in_c;
+                }
+            }
+
+            int8_t* o = out + (static_cast<size_t>(oy) * s.out_w + ox) * s.out_c;
+            for (int32_t c0 = 0; c0 < s.out_c; c0 += 256) {
+                const int32_t cn = std::min<int32_t>(256, s.out_c - c0);
+                for (int32_t c = 0; c < cn; ++c) {
+                    acc_buf[c] = dot(patch, weights + static_cast<size_t>(c0 + c) * k, k);
+                }
+                requantize(acc_buf, bias != nullptr ? bias + c0 : nullptr, cn, scale, relu, o + c0);
+            }
+        }
+    }
+}
+
+void depthwise_conv2d(const int8_t* in, const ConvShape& s, const int8_t* weights,
+                      const int32_t* bias, float scale, bool relu, int8_t* out,
+                      int32_t* acc) {
+    const int32_t c = s.in_c;
+    for (int32_t oy = 0; oy < s.out_h; ++oy) {
+        for (int32_t ox = 0; ox < s.out_w; ++ox) {
+            std::fill(acc, acc + c, 0);
+            for (int32_t ky = 0; ky < s.kernel_h; ++ky) {
+                const int32_t iy = oy * s.stride_h + ky - s.pad_h;
+                if (iy < 0 || iy >= s.in_h) continue;
+                for (int32_t kx = 0; kx < s.kernel_w; ++kx) {
+                    const int32_t ix = ox * s.stride_w + kx - s.pad_w;
+                    if (ix < 0 || ix >= s.in_w) continue;
+                    const int8_t* x = in + (static_cast<size_t>(iy) * s.in_w + ix) * c;
+                    const int8_t* w = weights + (static_cast<size_t>(ky) * s.kernel_w + kx) * c;
+                    // Channel-contiguous multiply-accumulate; vectorized by the compiler
+                    for (int32_t ch = 0; ch < c; ++ch) {
+                        acc[ch] += static_cast<int32_t>(x[ch]) * w[ch];
+                    }
+                }
+            }
+            requantize(acc, bias, c, scale, relu,
+                       out + (static_cast<size_t>(oy) * s.out_w + ox) * c);
+        }
+    }
+}
+
+void fully_connected_acc(const int8_t* in, int32_t k, const int8_t* weights,
+                         const int32_t* bias, int32_t n, int32_t* out) {
+    for (int32_t i = 0; i < n; ++i) {
+        out[i] = dot(in, weights + static_cast<size_t>(i) * k, k) +
+                 (bias != nullptr ? bias[i] : 0);
+    }
+}
+
+void fully_connected(const int8_t* in, int32_t k, const int8_t* weights,
+                     const int32_t* bias, int32_t n, float scale, bool relu,
+                     int8_t* out) {
+    int32_t acc_buf[256];
+    for (int32_t n0 = 0; n0 < n; n0 += 256) {
+        const int32_t nn = std::min<int32_t>(256, n - n0);
+        fully_connected_acc(in, k, weights + static_cast<size_t>(n0) * k,
+                            bias != nullptr ? bias + n0 : nullptr, nn, acc_buf);
+        requantize(acc_buf, nullptr, nn, scale, relu, out + n0);
+    }
+}
+
+void global_average_pool(const int8_t* in, int32_t h, int32_t w, int32_t c,
+                         int8_t* out, int32_t* acc) {
+    std::fill(acc, acc + c, 0);
+    const int32_t count = h * w;
+    for (int32_t i = 0; i < count; ++i) {
+        const int8_t* x = in + static_cast<size_t>(i) * c;
+        for (int32_t ch = 0; ch < c; ++ch) acc[ch] += x[ch];
+    }
+    requantize(acc, nullptr, c, 1.0f / static_cast<float>(count), false, out);
+}
+
+} // namespace int8
+} // namespace assistant
@@ -0,0 +1,69 @@
+/**
+ * int8_kernels.h - Quantized int8 kernels for small on-device networks
+ *
+ * Symmetric per-tensor quantization (zero point 0, values in [-127, 127]).
+ * The dot product has NEON (with and without dotprod), AVX2 and SSE4.1
+ * paths chosen at compile time; *_ref variants are the scalar reference
+ * used by tests. Tensors are laid out HWC (channels innermost).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace assistant {
+namespace int8 {
+
+/** Name of the dot-product path compiled into this build. */
+const char* kernel_name();
+
+int32_t dot(const int8_t* a, const int8_t* b, size_t n);
+int32_t dot_ref(const int8_t* a, const int8_t* b, size_t n);
+
+/**
+ * out[i] = clamp(round((acc[i] + bias[i]) * scale)), optional ReLU.
+ * `bias` may be null.
+ */
+void requantize(const int32_t* acc, const int32_t* bias, size_t n,
+                float scale, bool relu, int8_t* out);
+
+struct ConvShape {
+    int32_t in_h, in_w, in_c;
+    int32_t out_h, out_w, out_c;
+    int32_t kernel_h, kernel_w;
+    int32_t stride_h, stride_w;
+    int32_t pad_h, pad_w;   // top/left padding; zero-filled
+};
+
+/**
+ * Standard convolution. weights: [out_c][kernel_h][kernel_w][in_c].
+ * `patch` is scratch of kernel_h * kernel_w * in_c bytes.
+ */
+void conv2d(const int8_t* in, const ConvShape& s, const int8_t* weights,
+            const int32_t* bias, float scale, bool relu, int8_t* out,
+            int8_t* patch);
+
+/**
+ * Depthwise convolution (out_c == in_c). weights: [kernel_h][kernel_w][in_c].
+ * `acc` is scratch of in_c int32 values.
+ */
+void depthwise_conv2d(const int8_t* in, const ConvShape& s, const int8_t* weights,
+                      const int32_t* bias, float scale, bool relu, int8_t* out,
+                      int32_t* acc);
+
+/** Fully connected: out[n] from in[k] with weights [n][k]. */
+void fully_connected(const int8_t* in, int32_t k, const int8_t* weights,
+                     const int32_t* bias, int32_t n, float scale, bool relu,
+                     int8_t* out);
+
+/** Fully connected without requantization (raw int32 accumulators, bias added). */
+void fully_connected_acc(const int8_t* in, int32_t k, const int8_t* weights,
+                         const int32_t* bias, int32_t n, int32_t* out);
+
+/** Global average pool over H x W, keeping the input scale. */
+void global_average_pool(const int8_t* in, int32_t h, int32_t w, int32_t c,
+                         int8_t* out, int32_t* acc);
+
+} // namespace int8
+} // namespace assistant
@@ -0,0 +1,135 @@
+/**
+ * intent_classifier.cpp - Hashed n-gram naive Bayes intent classifier
+ */
+
+#include "intent_classifier.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lru_cache.h"
+
+namespace assistant {
+
+namespace {
+    constexpr size_t kMaxFeatures = 256;
+
+    bool is_word_byte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '\'' || c >= 0x80;
+    }
+}
+
+size_t intent_features(const char* text, uint32_t* out, size_t max) {
+    constexpr uint32_t kMask = IntentClassifier::kFeatures - 1;
+    constexpr uint64_t kBigramSeed = 0x9e3779b97f4a7c15ull;
+    size_t n = 0;
+    uint64_t prev = 0;
+    bool have_prev = false;
+    const auto* p = reinterpret_cast<const unsigned char*>(text);
+    while (*p != '\0' && n < max) {
+        if (!is_word_byte(*p)) {
+            ++p;
+            continue;
+        }
+        uint64_t word = 14695981039346656037ull;
+        for (; *p != '\0' && is_word_byte(*p); ++p) {
+            const unsigned char c = (*p >= 'A' && *p <= 'Z') ? static_cast<unsigned char>(*p - 'A' + 'a') : *p;
+            word = (word ^ c) * 1099511628211ull;
+        }
+        out[n++] = static_cast<uint32_t>(word) & kMask;
+        if (have_prev && n < max) {
+            out[n++] = static_cast<uint32_t>(fnv1a64(&word, sizeof(word), prev ^ kBigramSeed)) & kMask;
+        }
+        prev = word;
+        have_prev = true;
+    }
+    return n;
+}
+
+bool IntentClassifier::train(const std::vector<CommandPhrase>& examples, float alpha) {
+    names_.clear();
+    std::vector<int32_t> labels;
+    labels.reserve(examples.size());
+    for (const auto& example : examples) {
+        auto it = std::find(names_.begin(), names_.end(), example.intent);
+        if (it == names_.end()) it = names_.insert(names_.end(), example.intent);
+        labels.push_back(static_cast<int32_t>(it - names_.begin()));
+    }
+    if (names_.size() < 2) {
+        names_.clear();
+        return false;
+    }
+
+    const size_t n_intents = names_.size();
+    std::vector<float> counts(n_intents * kFeatures, 0.0f);
+    std::vector<double> totals(n_intents, 0.0);
+    std::vector<double> docs(n_intents, 0.0);
+    known_.assign(kFeatures, 0);
+
+    uint32_t features[kMaxFeatures];
+    for (size_t i = 0; i < examples.size(); ++i) {
+        const size_t n = intent_features(examples[i].text.c_str(), features, kMaxFeatures);
+        float* row = &counts[labels[i] * kFeatures];
+        for (size_t f = 0; f < n; ++f) {
+            row[features[f]] += 1.0f;
+            known_[features[f]] = 1;
+        }
+        totals[labels[i]] += static_cast<double>(n);
+        docs[labels[i]] += 1.0;
+    }
+
+    log_prior_.resize(n_intents);
+    log_likelihood_.resize(n_intents * kFeatures);
+    for (size_t c = 0; c < n_intents; ++c) {
+        log_prior_[c] = static_cast<float>(std::log(docs[c] / static_cast<double>(examples.size())));
+        const double norm = std::log(totals[c] + alpha * kFeatures);
+        for (uint32_t f = 0; f < kFeatures; ++f) {
+            log_likelihood_[c * kFeatures + f] =
+                static_cast<float>(std::log(counts[c * kFeatures + f] + alpha) - norm);
+        }
+    }
+    return true;
+}
+
+IntentScore IntentClassifier::classify(const char* text) const {
+    IntentScore score;
+    if (names_.empty() || text == nullptr) return score;
+
+    uint32_t features[kMaxFeatures];
+    const size_t n = intent_features(text, features, kMaxFeatures);
+
+    // Intents are few (tens); keep the posteriors on the stack
+    constexpr size_t kMaxIntents = 64;
+    float posterior[kMaxIntents];
+    const size_t n_intents = std::min(names_.size(), kMaxIntents);
+    for (size_t c = 0; c < n_intents; ++c) posterior[c] = log_prior_[c];
+    for (size_t f = 0; f < n; ++f) {
+        if (!known_[features[f]]) continue;
+        ++score.features;
+        for (size_t c = 0; c < n_intents; ++c) posterior[c] += log_likelihood_[c * kFeatures + features[f]];
+    }
+    if (score.features == 0) return score;
+
+    size_t best = 0;
+    for (size_t c = 1; c < n_intents; ++c) {
+        if (posterior[c] > posterior[best]) best = c;
+    }
+    float runner_up = -INFINITY;
+    double sum = 0.0;
+    for (size_t c = 0; c < n_intents; ++c) {
+        sum += std::exp(static_cast<double>(posterior[c] - posterior[best]));
+        if (c != best) runner_up = std::max(runner_up, posterior[c]);
+    }
+    score.intent = static_cast<int32_t>(best);
+    score.probability = static_cast<float>(1.0 / sum);
+    score.margin = posterior[best] - runner_up;
+    return score;
+}
+
+int32_t IntentClassifier::intent_id(const std::string& name) const {
+    const auto it = std::find(names_.begin(), names_.end(), name);
+    return it != names_.end() ? static_cast<int32_t>(it - names_.begin()) : -1;
+}
+
+} // namespace assistant
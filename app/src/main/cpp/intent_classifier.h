@@ -0,0 +1,65 @@
+/**
+ * intent_classifier.h - Small on-device intent classifier for transcripts
+ *
+ * Multinomial naive Bayes over hashed word unigrams and bigrams, trained at
+ * load time from a few example utterances per intent, in the same
+ * "intent<TAB>text" spec as command_grammar.h. Intent ids follow the order
+ * of first appearance in the spec. One intent should be a catch-all trained
+ * on ordinary questions, so that text which is not a device action has a
+ * class to land in; callers then only act on confident, non-catch-all
+ * results. Features never seen in training are ignored rather than
+ * smoothed, so unknown words do not tilt the decision towards small classes.
+ *
+ * Classifying a transcript is a few hash lookups per word and allocates
+ * nothing, so it runs on every query ahead of the network request.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "command_grammar.h"
+
+namespace assistant {
+
+struct IntentScore {
+    int32_t intent = -1;        // -1: no known word in the text
+    float probability = 0.0f;   // posterior of `intent`
+    float margin = 0.0f;        // log-posterior gap to the runner-up
+    int32_t features = 0;       // known features that took part
+};
+
+class IntentClassifier {
+public:
+    static constexpr uint32_t kFeatureBits = 13;
+    static constexpr uint32_t kFeatures = 1u << kFeatureBits;
+
+    /** Train from labelled examples; false if there are fewer than two intents. */
+    bool train(const std::vector<CommandPhrase>& examples, float alpha = 0.5f);
+
+    IntentScore classify(const char* text) const;
+
+    size_t intents() const { return names_.size(); }
+    const std::string& intent_name(int32_t id) const { return names_[id]; }
+
+    /** Id of `name`, or -1. */
+    int32_t intent_id(const std::string& name) const;
+
+private:
+    std::vector<std::string> names_;
+    std::vector<float> log_prior_;          // per intent
+    std::vector<float> log_likelihood_;     // intents x kFeatures
+    std::vector<uint8_t> known_;            // feature seen in training
+};
+
+/**
+ * Feature ids of the unigrams and bigrams of `text`, up to `max`; returns
+ * the count. Words are runs of ASCII letters/digits/apostrophes or UTF-8
+ * bytes, and ASCII is lowercased.
+ */
+size_t intent_features(const char* text, uint32_t* out, size_t max);
+
+} // namespace assistant
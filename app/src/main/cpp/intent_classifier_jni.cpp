@@ -0,0 +1,86 @@
+/**
+ * intent_classifier_jni.cpp - JNI bridge for the on-device intent classifier
+ *
+ * The classifier is trained from the spec passed to nativeCreate. Results
+ * come back as the intent id (spec order, -1 for none) with probability and
+ * margin written into a caller-owned FloatArray, so a query allocates
+ * nothing beyond the UTF-8 copy of its text.
+ */
+
+#define LOG_TAG "IntentClassifierJNI"
+
+#include <jni.h>
+
+#include <string>
+#include <vector>
+
+#include "intent_classifier.h"
+#include "native_log.h"
+
+using assistant::CommandPhrase;
+using assistant::IntentClassifier;
+using assistant::IntentScore;
+
+namespace {
+    IntentClassifier* from_handle(jlong handle) {
+        return reinterpret_cast<IntentClassifier*>(handle);
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_satory_graphenosai_intent_IntentClassifier_nativeCreate(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jstring spec) {
+    const char* chars = env->GetStringUTFChars(spec, nullptr);
+    if (chars == nullptr) return 0;
+    const std::string text(chars);
+    env->ReleaseStringUTFChars(spec, chars);
+
+    std::vector<CommandPhrase> examples;
+    std::string error;
+    if (!assistant::parse_command_spec(text, examples, &error)) {
+        LOGE("Invalid intent examples: %s", error.c_str());
+        return 0;
+    }
+    auto* classifier = new IntentClassifier();
+    if (!classifier->train(examples)) {
+        LOGE("Intent examples need at least two intents");
+        delete classifier;
+        return 0;
+    }
+    LOGI("Intent classifier: %zu intents from %zu examples", classifier->intents(), examples.size());
+    return reinterpret_cast<jlong>(classifier);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_satory_graphenosai_intent_IntentClassifier_nativeClassify(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jstring text,
+        jfloatArray out) {
+    IntentClassifier* classifier = from_handle(handle);
+    if (classifier == nullptr) return -1;
+
+    const char* chars = env->GetStringUTFChars(text, nullptr);
+    if (chars == nullptr) return -1;
+    const IntentScore score = classifier->classify(chars);
+    env->ReleaseStringUTFChars(text, chars);
+
+    const jfloat values[2] = { score.probability, score.margin };
+    env->SetFloatArrayRegion(out, 0, 2, values);
+    return score.intent;
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_intent_IntentClassifier_nativeDestroy(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    delete from_handle(handle);
+}
+
+} // extern "C"
@@ -0,0 +1,235 @@
+/**
+ * job_scheduler.cpp - Engine thread, priority queues and preemption
+ */
+
+#define LOG_TAG "JobScheduler"
+
+#include "job_scheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "native_log.h"
+
+namespace assistant {
+
+namespace {
+    uint64_t elapsed_us(std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - since).count());
+    }
+}
+
+JobScheduler::JobScheduler() : thread_([this] { run(); }) {}
+
+JobScheduler::~JobScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    thread_.join();
+    for (auto& queue : queues_) {
+        for (auto& entry : queue) entry->job->cancelled();
+        queue.clear();
+    }
+}
+
+JobScheduler& JobScheduler::shared() {
+    static JobScheduler scheduler;
+    return scheduler;
+}
+
+JobClassStats& JobScheduler::class_stats(JobPriority priority) {
+    return priority == JOB_INTERACTIVE ? stats_.interactive : stats_.background;
+}
+
+void JobScheduler::record_start(JobClassStats& stats, Clock::time_point since) {
+    const uint64_t wait = elapsed_us(since, Clock::now());
+    ++stats.started;
+    stats.wait_us_total += wait;
+    stats.wait_us_max = std::max(stats.wait_us_max, wait);
+}
+
+uint64_t JobScheduler::submit(JobPriority priority, std::unique_ptr<StepJob> job) {
+    auto entry = std::make_unique<Entry>();
+    entry->priority = priority;
+    entry->job = std::move(job);
+    entry->queued_at = Clock::now();
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = entry->id = next_id_++;
+        auto& queue = queues_[priority];
+        queue.push_back(std::move(entry));
+        JobClassStats& stats = class_stats(priority);
+        ++stats.submitted;
+        const uint32_t depth = static_cast<uint32_t>(queue.size()) + (priority == JOB_INTERACTIVE ? turn_waiters_ : 0);
+        stats.max_queue_depth = std::max(stats.max_queue_depth, depth);
+        if (priority == JOB_INTERACTIVE) interactive_pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    work_cv_.notify_one();
+    return id;
+}
+
+bool JobScheduler::cancel(uint64_t id) {
+    std::unique_ptr<Entry> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ != nullptr && running_->id == id) {
+            running_->cancel = true;
+            return true;
+        }
+        for (auto& queue : queues_) {
+            auto it = std::find_if(queue.begin(), queue.end(), [id](const auto& entry) { return entry->id == id; });
+            if (it != queue.end()) {
+                removed = std::move(*it);
+                queue.erase(it);
+                break;
+            }
+        }
+        if (!removed) return false;
+        ++finishing_;
+        if (removed->priority == JOB_INTERACTIVE) interactive_pending_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    finish(std::move(removed), true);
+    return true;
+}
+
+void JobScheduler::cancel_all() {
+    std::vector<std::unique_ptr<Entry>> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ != nullptr) running_->cancel = true;
+        for (auto& queue : queues_) {
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (it->get() == running_) {
+                    ++it;
+                    continue;
+                }
+                if ((*it)->priority == JOB_INTERACTIVE) interactive_pending_.fetch_sub(1, std::memory_order_relaxed);
+                ++finishing_;
+                removed.push_back(std::move(*it));
+                it = queue.erase(it);
+            }
+        }
+    }
+    for (auto& entry : removed) finish(std::move(entry), true);
+
+    // Callbacks may still run on other threads (cancel(), or the engine thread after a cancelled step)
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return finishing_ == 0; });
+}
+
+void JobScheduler::finish(std::unique_ptr<Entry> entry, bool cancelled) {
+    // Job callbacks run without the lock; they may take engine locks of their own
+    if (cancelled) entry->job->cancelled();
+    const JobPriority priority = entry->priority;
+    entry.reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        JobClassStats& stats = class_stats(priority);
+        ++(cancelled ? stats.cancelled : stats.completed);
+        --finishing_;
+    }
+    idle_cv_.notify_all();
+}
+
+void JobScheduler::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] {
+        return running_ == nullptr && finishing_ == 0 && queues_[0].empty() && queues_[1].empty();
+    });
+}
+
+SchedulerStats JobScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SchedulerStats stats = stats_;
+    stats.interactive.queue_depth = static_cast<uint32_t>(queues_[JOB_INTERACTIVE].size()) + turn_waiters_;
+    stats.background.queue_depth = static_cast<uint32_t>(queues_[JOB_BACKGROUND].size());
+    return stats;
+}
+
+void JobScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] {
+            return stop_ || (!turn_held_ && turn_waiters_ == 0 &&
+                             (!queues_[JOB_INTERACTIVE].empty() || !queues_[JOB_BACKGROUND].empty()));
+        });
+        if (stop_) break;
+
+        auto& queue = !queues_[JOB_INTERACTIVE].empty() ? queues_[JOB_INTERACTIVE] : queues_[JOB_BACKGROUND];
+        Entry* entry = queue.front().get();
+        JobClassStats& stats = class_stats(entry->priority);
+
+        bool done = entry->cancel;
+        if (!done) {
+            const Clock::time_point now = Clock::now();
+            if (!entry->started) {
+                entry->started = true;
+                record_start(stats, entry->queued_at);
+            }
+            if (entry->paused) {
+                entry->paused = false;
+                stats_.paused_us_total += elapsed_us(entry->paused_at, now);
+            }
+            running_ = entry;
+            lock.unlock();
+            done = entry->job->step();
+            lock.lock();
+            running_ = nullptr;
+            ++stats.steps;
+        }
+
+        // Only the engine thread pops queue fronts, so `entry` is still at the front
+        if (done || entry->cancel) {
+            const bool cancelled = entry->cancel && !done;
+            std::unique_ptr<Entry> owned = std::move(queue.front());
+            queue.pop_front();
+            ++finishing_;
+            if (owned->priority == JOB_INTERACTIVE) interactive_pending_.fetch_sub(1, std::memory_order_relaxed);
+            lock.unlock();
+            finish(std::move(owned), cancelled);
+            lock.lock();
+        } else if (entry->priority == JOB_BACKGROUND &&
+                   (turn_waiters_ > 0 || !queues_[JOB_INTERACTIVE].empty())) {
+            entry->paused = true;
+            entry->paused_at = Clock::now();
+            ++stats_.preemptions;
+            LOGD("Background job %llu paused for interactive work", static_cast<unsigned long long>(entry->id));
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+JobScheduler::InteractiveTurn::InteractiveTurn(JobScheduler& scheduler) : scheduler_(scheduler) {
+    std::unique_lock<std::mutex> lock(scheduler_.mutex_);
+    const Clock::time_point requested = Clock::now();
+    JobClassStats& stats = scheduler_.stats_.interactive;
+    ++stats.submitted;
+    ++scheduler_.turn_waiters_;
+    scheduler_.interactive_pending_.fetch_add(1, std::memory_order_relaxed);
+    stats.max_queue_depth = std::max(stats.max_queue_depth,
+        static_cast<uint32_t>(scheduler_.queues_[JOB_INTERACTIVE].size()) + scheduler_.turn_waiters_);
+
+    // The step in flight finishes first; nothing new starts while we wait
+    scheduler_.idle_cv_.wait(lock, [this] { return scheduler_.running_ == nullptr && !scheduler_.turn_held_; });
+    --scheduler_.turn_waiters_;
+    scheduler_.interactive_pending_.fetch_sub(1, std::memory_order_relaxed);
+    scheduler_.turn_held_ = true;
+    scheduler_.record_start(stats, requested);
+}
+
+JobScheduler::InteractiveTurn::~InteractiveTurn() {
+    {
+        std::lock_guard<std::mutex> lock(scheduler_.mutex_);
+        scheduler_.turn_held_ = false;
+        ++scheduler_.stats_.interactive.steps;
+        ++scheduler_.stats_.interactive.completed;
+    }
+    scheduler_.idle_cv_.notify_all();
+    scheduler_.work_cv_.notify_one();
+}
+
+} // namespace assistant
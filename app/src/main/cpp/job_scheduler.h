@@ -0,0 +1,156 @@
+/**
+ * job_scheduler.h - Priority scheduler for jobs that share one inference engine
+ *
+ * A whisper context runs one request at a time, so a long file
+ * transcription and a voice query cannot simply run side by side. Jobs
+ * are split into steps (one audio window, one decoder pass) and run one
+ * step at a time on a dedicated engine thread: interactive jobs first,
+ * then the oldest background job. After every step of a background job
+ * the scheduler checks for interactive work, so a voice query waits at
+ * most for the step in flight; the background job keeps its place and
+ * resumes once interactive work is done.
+ *
+ * Interactive work that must run on the calling thread (a JNI call that
+ * owns its JNIEnv) takes an InteractiveTurn instead of submitting a job:
+ * it waits for the current step to finish, holds the engine, and releases
+ * it on destruction. Long steps can poll preempt_requested() to give up
+ * early (e.g. through whisper's abort callback) and redo the step later.
+ *
+ * The engine thread runs at normal priority; voice requests raise theirs
+ * with an InteractiveScope (thread_priority.h), so a step still finishing
+ * when a turn starts competes for the CPU from behind.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace assistant {
+
+enum JobPriority : int32_t {
+    JOB_INTERACTIVE = 0,
+    JOB_BACKGROUND = 1,
+};
+
+class StepJob {
+public:
+    virtual ~StepJob() = default;
+
+    /** Run one bounded unit of work; true once the job is finished. */
+    virtual bool step() = 0;
+
+    /** Called instead of further steps once cancelled, with no scheduler lock held. */
+    virtual void cancelled() {}
+};
+
+struct JobClassStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+    uint64_t steps = 0;
+    uint32_t queue_depth = 0;       // waiting or paused right now
+    uint32_t max_queue_depth = 0;
+    uint64_t started = 0;           // jobs or turns that got the engine
+    uint64_t wait_us_total = 0;     // submit (or turn request) -> first step
+    uint64_t wait_us_max = 0;
+
+    uint64_t mean_wait_us() const { return started > 0 ? wait_us_total / started : 0; }
+};
+
+struct SchedulerStats {
+    JobClassStats interactive;      // queued jobs and InteractiveTurns
+    JobClassStats background;
+    uint64_t preemptions = 0;       // background jobs paused for interactive work
+    uint64_t paused_us_total = 0;   // time background jobs spent paused
+};
+
+class JobScheduler {
+public:
+    JobScheduler();
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    /** Queue `job`; returns its id (never 0). */
+    uint64_t submit(JobPriority priority, std::unique_ptr<StepJob> job);
+
+    /**
+     * Cancel a queued or running job; a running one stops after its current
+     * step. False if the id is unknown or already finished.
+     */
+    bool cancel(uint64_t id);
+
+    /**
+     * Cancel everything queued (e.g. before the model is released). Returns
+     * once no cancellation callback is running anywhere, so whatever they
+     * release is released; callbacks must not call back into cancel_all.
+     */
+    void cancel_all();
+
+    /** True while interactive work waits for the engine. */
+    bool preempt_requested() const { return interactive_pending_.load(std::memory_order_relaxed) > 0; }
+
+    /** Block until no job is queued or running. */
+    void wait_idle();
+
+    SchedulerStats stats() const;
+
+    /** Holds the engine for the calling thread; see the file comment. */
+    class InteractiveTurn {
+    public:
+        explicit InteractiveTurn(JobScheduler& scheduler);
+        ~InteractiveTurn();
+
+        InteractiveTurn(const InteractiveTurn&) = delete;
+        InteractiveTurn& operator=(const InteractiveTurn&) = delete;
+
+    private:
+        JobScheduler& scheduler_;
+    };
+
+    /** The scheduler shared by the library's engines. */
+    static JobScheduler& shared();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        uint64_t id = 0;
+        JobPriority priority = JOB_BACKGROUND;
+        std::unique_ptr<StepJob> job;
+        Clock::time_point queued_at;
+        Clock::time_point paused_at;
+        bool started = false;
+        bool paused = false;
+        bool cancel = false;
+    };
+
+    void run();
+    JobClassStats& class_stats(JobPriority priority);
+    void record_start(JobClassStats& stats, Clock::time_point since);
+    void finish(std::unique_ptr<Entry> entry, bool cancelled);
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::unique_ptr<Entry>> queues_[2];
+    Entry* running_ = nullptr;
+    uint32_t finishing_ = 0;        // removed, callbacks not yet run
+    bool turn_held_ = false;
+    uint32_t turn_waiters_ = 0;
+    bool stop_ = false;
+    uint64_t next_id_ = 1;
+    SchedulerStats stats_;
+    std::atomic<uint32_t> interactive_pending_{0};
+    std::thread thread_;
+};
+
+} // namespace assistant
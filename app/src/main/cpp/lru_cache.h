@@ -0,0 +1,106 @@
+/**
+ * lru_cache.h - Small least-recently-used cache with move-only values
+ *
+ * Sized for a handful of heavy entries (whisper encoder states), so lookup
+ * is a linear scan over a list ordered from most to least recently used.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace assistant {
+
+template <typename Key, typename Value>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity = 1) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    /** The entry for `key`, now most recently used; nullptr if absent. */
+    Value* find(const Key& key) {
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->first == key) {
+                entries_.splice(entries_.begin(), entries_, it);
+                return &entries_.front().second;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Most recently used entry, or nullptr. */
+    Value* front() { return entries_.empty() ? nullptr : &entries_.front().second; }
+    const Key* front_key() const { return entries_.empty() ? nullptr : &entries_.front().first; }
+
+    /**
+     * Insert or replace `key` as the most recently used entry. Entries
+     * pushed out by the capacity are destroyed here, after the new one is
+     * in place.
+     */
+    Value& insert(const Key& key, Value value) {
+        if (Value* existing = find(key)) {
+            *existing = std::move(value);
+            return *existing;
+        }
+        entries_.emplace_front(key, std::move(value));
+        while (entries_.size() > capacity_) entries_.pop_back();
+        return entries_.front().second;
+    }
+
+    /**
+     * When full, re-key the least recently used entry as `key`, make it the
+     * most recent and return it for the caller to overwrite in place
+     * (no node allocation); nullptr while there is still room.
+     */
+    Value* recycle_oldest(const Key& key) {
+        if (entries_.size() < capacity_) return nullptr;
+        entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+        entries_.front().first = key;
+        return &entries_.front().second;
+    }
+
+    bool erase(const Key& key) {
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->first == key) {
+                entries_.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void clear() { entries_.clear(); }
+
+    /** Shrinking evicts the least recently used entries. */
+    void set_capacity(size_t capacity) {
+        capacity_ = capacity == 0 ? 1 : capacity;
+        while (entries_.size() > capacity_) entries_.pop_back();
+    }
+
+private:
+    size_t capacity_;
+    std::list<std::pair<Key, Value>> entries_;
+};
+
+/** FNV-1a over raw bytes; identifies a clip for cache lookups. */
+inline uint64_t fnv1a64(const void* data, size_t bytes, uint64_t seed = 14695981039346656037ull) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace assistant
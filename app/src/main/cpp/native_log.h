@@ -0,0 +1,56 @@
+/**
+ * native_log.h - Logging macros shared by the native sources
+ *
+ * Maps LOGI/LOGW/LOGE/LOGD to logcat on Android and to stderr on host
+ * builds, so the same sources compile for the device and for Linux tests.
+ * Each translation unit defines LOG_TAG before including this header.
+ */
+
+#pragma once
+
+#ifndef LOG_TAG
+#define LOG_TAG "AssistantNative"
+#endif
+
+#ifdef __ANDROID__
+
+#include <android/log.h>
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+#else
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace native_log {
+    // Host logging is quiet by default; set ASSISTANT_NATIVE_LOG=1 to enable
+    inline bool enabled() {
+        static const bool on = [] {
+            const char* env = std::getenv("ASSISTANT_NATIVE_LOG");
+            return env != nullptr && env[0] == '1';
+        }();
+        return on;
+    }
+
+    inline void print(char level, const char* tag, const char* fmt, ...) {
+        if (level != 'E' && !enabled()) return;
+        std::fprintf(stderr, "%c/%s: ", level, tag);
+        va_list args;
+        va_start(args, fmt);
+        std::vfprintf(stderr, fmt, args);
+        va_end(args);
+        std::fputc('\n', stderr);
+    }
+}
+
+#define LOGI(...) native_log::print('I', LOG_TAG, __VA_ARGS__)
+#define LOGW(...) native_log::print('W', LOG_TAG, __VA_ARGS__)
+#define LOGE(...) native_log::print('E', LOG_TAG, __VA_ARGS__)
+#define LOGD(...) native_log::print('D', LOG_TAG, __VA_ARGS__)
+
+#endif
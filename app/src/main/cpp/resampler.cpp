@@ -0,0 +1,93 @@
+/**
+ * resampler.cpp - Streaming windowed-sinc sample rate converter
+ */
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace assistant {
+
+namespace {
+    constexpr double kPi = 3.14159265358979323846;
+
+    double sinc(double x) {
+        return std::fabs(x) < 1e-9 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+    }
+}
+
+Resampler::Resampler(int32_t in_rate, int32_t out_rate, int32_t half_taps)
+    : in_rate_(std::max(1, in_rate)),
+      out_rate_(std::max(1, out_rate)),
+      half_taps_(std::max(1, half_taps)),
+      step_(static_cast<double>(in_rate_) / out_rate_) {
+    // Slightly below the lower Nyquist so the transition band stays out of the passband edge
+    const double cutoff = 0.95 * std::min(1.0, static_cast<double>(out_rate_) / in_rate_);
+    const int32_t taps = 2 * half_taps_;
+    table_.resize(static_cast<size_t>(kPhases + 1) * taps);
+    for (int32_t p = 0; p <= kPhases; ++p) {
+        const double frac = static_cast<double>(p) / kPhases;
+        for (int32_t m = 0; m < taps; ++m) {
+            // Distance from the output position to input sample floor(t) - half_taps + 1 + m
+            const double d = frac + (half_taps_ - 1 - m);
+            const double w = std::fabs(d) >= half_taps_ ? 0.0
+                : 0.42 + 0.5 * std::cos(kPi * d / half_taps_) + 0.08 * std::cos(2.0 * kPi * d / half_taps_);
+            table_[static_cast<size_t>(p) * taps + m] = static_cast<float>(cutoff * sinc(cutoff * d) * w);
+        }
+    }
+    reset();
+}
+
+void Resampler::reset() {
+    // Zero history so the first output is centred on the first input sample
+    history_.assign(static_cast<size_t>(half_taps_), 0.0f);
+    pos_ = static_cast<double>(half_taps_);
+}
+
+size_t Resampler::max_output(size_t n) const {
+    return static_cast<size_t>(std::ceil((history_.size() + n) / step_)) + 2;
+}
+
+size_t Resampler::process(const float* in, size_t n, float* out, size_t capacity) {
+    if (in_rate_ == out_rate_) {
+        n = std::min(n, capacity);
+        std::copy(in, in + n, out);
+        return n;
+    }
+
+    history_.insert(history_.end(), in, in + n);
+    const int32_t taps = 2 * half_taps_;
+    size_t produced = 0;
+    while (produced < capacity) {
+        const auto base = static_cast<int64_t>(pos_);
+        if (base + half_taps_ >= static_cast<int64_t>(history_.size())) break;
+
+        const double phase = (pos_ - static_cast<double>(base)) * kPhases;
+        const auto p = static_cast<int32_t>(phase);
+        const auto blend = static_cast<float>(phase - p);
+        const float* h0 = &table_[static_cast<size_t>(p) * taps];
+        const float* h1 = h0 + taps;
+        const float* x = &history_[static_cast<size_t>(base - half_taps_ + 1)];
+
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+        for (int32_t m = 0; m < taps; ++m) {
+            acc0 += h0[m] * x[m];
+            acc1 += h1[m] * x[m];
+        }
+        out[produced++] = acc0 + blend * (acc1 - acc0);
+        pos_ += step_;
+    }
+
+    // Drop input that no future output can reach
+    const auto keep_from = static_cast<int64_t>(pos_) - half_taps_ + 1;
+    if (keep_from > 0) {
+        const auto drop = std::min(static_cast<size_t>(keep_from), history_.size());
+        history_.erase(history_.begin(), history_.begin() + static_cast<std::ptrdiff_t>(drop));
+        pos_ -= static_cast<double>(drop);
+    }
+    return produced;
+}
+
+} // namespace assistant
@@ -0,0 +1,51 @@
+/**
+ * resampler.h - Streaming windowed-sinc sample rate converter
+ *
+ * Converts the TTS engine's output rate (typically 22050 or 24000 Hz) to
+ * the 16 kHz capture rate so playback can serve as the echo reference.
+ * A polyphase table with linear interpolation between phases keeps the
+ * per-sample cost to one short dot product; the cutoff follows the lower
+ * of the two rates so downsampling does not alias.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace assistant {
+
+class Resampler {
+public:
+    /** `half_taps` input samples are used on each side of an output sample. */
+    Resampler(int32_t in_rate, int32_t out_rate, int32_t half_taps = 16);
+
+    int32_t in_rate() const { return in_rate_; }
+    int32_t out_rate() const { return out_rate_; }
+    int32_t half_taps() const { return half_taps_; }
+
+    /** Upper bound on the samples produced by process() for `n` inputs. */
+    size_t max_output(size_t n) const;
+
+    /**
+     * Convert `n` input samples; writes at most `capacity` samples to `out`
+     * and returns the count. Output lags the input by `half_taps` samples.
+     */
+    size_t process(const float* in, size_t n, float* out, size_t capacity);
+
+    void reset();
+
+private:
+    static constexpr int32_t kPhases = 128;
+
+    int32_t in_rate_;
+    int32_t out_rate_;
+    int32_t half_taps_;
+    double step_;                 // input samples per output sample
+    std::vector<float> table_;    // (kPhases + 1) x (2 * half_taps)
+    std::vector<float> history_;  // unconsumed input, starting at index 0
+    double pos_ = 0.0;            // next output position within history_
+};
+
+} // namespace assistant
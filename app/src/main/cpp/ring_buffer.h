@@ -0,0 +1,64 @@
+/**
+ * ring_buffer.h - Fixed-capacity overwrite-oldest ring buffer
+ *
+ * Used to keep the most recent audio (wake word pre-roll, barge-in
+ * capture) without allocating on the audio thread.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace assistant {
+
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 0) : data_(capacity) {}
+
+    void reset(size_t capacity) {
+        data_.assign(capacity, T{});
+        head_ = 0;
+        size_ = 0;
+    }
+
+    size_t capacity() const { return data_.size(); }
+    size_t size() const { return size_; }
+    void clear() { head_ = 0; size_ = 0; }
+
+    /** Append samples, overwriting the oldest ones when full. */
+    void write(const T* src, size_t n) {
+        const size_t cap = data_.size();
+        if (cap == 0) return;
+        if (n >= cap) {
+            src += n - cap;
+            n = cap;
+        }
+        const size_t first = std::min(n, cap - head_);
+        std::copy(src, src + first, data_.begin() + head_);
+        std::copy(src + first, src + n, data_.begin());
+        head_ = (head_ + n) % cap;
+        size_ = std::min(cap, size_ + n);
+    }
+
+    /** Copy the newest min(n, size()) items in chronological order; returns the count. */
+    size_t copy_latest(T* dst, size_t n) const {
+        const size_t cap = data_.size();
+        n = std::min(n, size_);
+        if (n == 0) return 0;
+        const size_t start = (head_ + cap - n) % cap;
+        const size_t first = std::min(n, cap - start);
+        std::copy(data_.begin() + start, data_.begin() + start + first, dst);
+        std::copy(data_.begin(), data_.begin() + (n - first), dst + first);
+        return n;
+    }
+
+private:
+    std::vector<T> data_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+} // namespace assistant
@@ -0,0 +1,98 @@
+/**
+ * thread_priority.cpp - CPU topology and the interactive priority scope
+ */
+
+#include "thread_priority.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <thread>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+namespace assistant {
+
+namespace {
+    int64_t read_max_freq_khz(int32_t cpu) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+        FILE* file = fopen(path, "r");
+        if (file == nullptr) return 0;
+        long long khz = 0;
+        if (fscanf(file, "%lld", &khz) != 1) khz = 0;
+        fclose(file);
+        return khz;
+    }
+}
+
+std::vector<int32_t> select_fast_cpus(const std::vector<int64_t>& max_freq_khz) {
+    const int64_t fastest = max_freq_khz.empty() ? 0 : *std::max_element(max_freq_khz.begin(), max_freq_khz.end());
+    std::vector<int32_t> cpus;
+    for (size_t i = 0; i < max_freq_khz.size(); ++i) {
+        // Unknown frequencies anywhere: treat every core alike
+        if (fastest <= 0 || max_freq_khz[i] * 5 >= fastest * 4) cpus.push_back(static_cast<int32_t>(i));
+    }
+    return cpus;
+}
+
+std::vector<int32_t> fast_cpus() {
+    const int32_t n = static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int64_t> freqs(n);
+    bool all_known = true;
+    for (int32_t cpu = 0; cpu < n; ++cpu) {
+        freqs[cpu] = read_max_freq_khz(cpu);
+        all_known = all_known && freqs[cpu] > 0;
+    }
+    if (!all_known) std::fill(freqs.begin(), freqs.end(), 0);
+    return select_fast_cpus(freqs);
+}
+
+bool pin_current_thread(const std::vector<int32_t>& cpus) {
+#if defined(__linux__)
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int32_t cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+InteractiveScope::InteractiveScope(int32_t nice) {
+#if defined(__linux__)
+    // Read once: the topology does not change, and a request should not touch sysfs
+    static const std::vector<int32_t> fast = fast_cpus();
+    static const bool has_slow_cores =
+        fast.size() < static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // On Linux the nice value is per thread, and PRIO_PROCESS with 0 means the calling one
+    errno = 0;
+    const int current = getpriority(PRIO_PROCESS, 0);
+    if (errno == 0) {
+        previous_nice_ = current;
+        raised_ = current > nice && setpriority(PRIO_PROCESS, 0, nice) == 0;
+    }
+
+    if (has_slow_cores && sched_getaffinity(0, sizeof(previous_cpus_), &previous_cpus_) == 0) {
+        pinned_ = pin_current_thread(fast);
+    }
+#else
+    (void)nice;
+#endif
+}
+
+InteractiveScope::~InteractiveScope() {
+#if defined(__linux__)
+    if (pinned_) sched_setaffinity(0, sizeof(previous_cpus_), &previous_cpus_);
+    if (raised_) setpriority(PRIO_PROCESS, 0, previous_nice_);
+#endif
+}
+
+} // namespace assistant
@@ -0,0 +1,62 @@
+/**
+ * thread_priority.h - Fast-core placement and priority for voice requests
+ *
+ * whisper.cpp starts its graph threads from the thread that calls it, and
+ * a new thread inherits the nice value and CPU affinity of the thread that
+ * created it. An InteractiveScope raises the calling thread's priority and
+ * restricts it to the fast cores for the length of a voice request, so the
+ * graph threads of that request run there too, ahead of a file job on the
+ * scheduler's engine thread and of whatever else the app does in the
+ * background. Both are restored when the scope ends. Where the kernel
+ * refuses either change, the scope leaves that setting alone.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace assistant {
+
+/** Nice value of a voice request; Android's THREAD_PRIORITY_DISPLAY. */
+constexpr int32_t kInteractiveNice = -4;
+
+class InteractiveScope {
+public:
+    explicit InteractiveScope(int32_t nice = kInteractiveNice);
+    ~InteractiveScope();
+
+    InteractiveScope(const InteractiveScope&) = delete;
+    InteractiveScope& operator=(const InteractiveScope&) = delete;
+
+    /** Whether the priority was raised; false if it already was as high, or not permitted. */
+    bool raised() const { return raised_; }
+    /** Whether the thread was moved to the fast cores; false without slow cores to avoid. */
+    bool pinned() const { return pinned_; }
+
+private:
+    int32_t previous_nice_ = 0;
+    bool raised_ = false;
+    bool pinned_ = false;
+#if defined(__linux__)
+    cpu_set_t previous_cpus_;
+#endif
+};
+
+/**
+ * CPUs in the fastest clusters: those whose maximum frequency is within
+ * 80% of the fastest core's. All CPUs when frequencies are unknown.
+ */
+std::vector<int32_t> fast_cpus();
+
+/** Selection rule behind fast_cpus(); `max_freq_khz[i]` <= 0 means unknown. */
+std::vector<int32_t> select_fast_cpus(const std::vector<int64_t>& max_freq_khz);
+
+/** Restrict the calling thread to `cpus`; false where unsupported. */
+bool pin_current_thread(const std::vector<int32_t>& cpus);
+
+} // namespace assistant
@@ -0,0 +1,196 @@
+/**
+ * trace.cpp - ATrace on Android, an in-memory Chrome trace recorder on host
+ */
+
+#define LOG_TAG "Trace"
+
+#include "trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __ANDROID__
+#include <android/trace.h>
+#else
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#endif
+
+#include "native_log.h"
+
+namespace assistant {
+
+#ifdef __ANDROID__
+
+bool trace_enabled() {
+    return ATrace_isEnabled();
+}
+
+void trace_begin(const char* name) {
+    ATrace_beginSection(name);
+}
+
+void trace_end() {
+    ATrace_endSection();
+}
+
+void trace_counter(const char* /* name */, int64_t /* value */) {
+    // ATrace_setCounter needs API 29 and the app supports 26; counters stay host-only
+}
+
+bool trace_start(const char* /* path */) {
+    return false;
+}
+
+size_t trace_stop() {
+    return 0;
+}
+
+bool trace_start_from_env() {
+    return false;
+}
+
+#else
+
+namespace {
+    struct TraceEvent {
+        char phase;                 // 'B', 'E' or 'C'
+        std::string name;
+        int64_t ts_us;
+        int32_t tid;
+        int64_t value;
+    };
+
+    struct HostTrace {
+        std::mutex mutex;
+        std::string path;
+        std::vector<TraceEvent> events;
+        std::chrono::steady_clock::time_point origin;
+    };
+
+    std::atomic<bool> g_recording{false};
+
+    HostTrace& host_trace() {
+        static HostTrace trace;
+        return trace;
+    }
+
+    int32_t current_tid() {
+#ifdef SYS_gettid
+        return static_cast<int32_t>(syscall(SYS_gettid));
+#else
+        return 0;
+#endif
+    }
+
+    void record(char phase, const char* name, int64_t value) {
+        HostTrace& trace = host_trace();
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        if (!g_recording.load(std::memory_order_relaxed)) return;
+        TraceEvent event;
+        event.phase = phase;
+        if (name != nullptr) event.name = name;
+        event.ts_us = std::chrono::duration_cast<std::chrono::microseconds>(now - trace.origin).count();
+        event.tid = current_tid();
+        event.value = value;
+        trace.events.push_back(std::move(event));
+    }
+
+    void write_json_string(FILE* file, const std::string& text) {
+        fputc('"', file);
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                fputc('\\', file);
+                fputc(c, file);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                fprintf(file, "\\u%04x", static_cast<unsigned>(c));
+            } else {
+                fputc(c, file);
+            }
+        }
+        fputc('"', file);
+    }
+}
+
+bool trace_enabled() {
+    return g_recording.load(std::memory_order_relaxed);
+}
+
+void trace_begin(const char* name) {
+    record('B', name, 0);
+}
+
+void trace_end() {
+    record('E', nullptr, 0);
+}
+
+void trace_counter(const char* name, int64_t value) {
+    record('C', name, value);
+}
+
+bool trace_start(const char* path) {
+    if (path == nullptr || path[0] == '\0') return false;
+    HostTrace& trace = host_trace();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.path = path;
+    trace.events.clear();
+    trace.origin = std::chrono::steady_clock::now();
+    g_recording.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+size_t trace_stop() {
+    HostTrace& trace = host_trace();
+    std::vector<TraceEvent> events;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        if (!g_recording.load(std::memory_order_relaxed)) return 0;
+        g_recording.store(false, std::memory_order_relaxed);
+        events.swap(trace.events);
+        path.swap(trace.path);
+    }
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LOGE("Cannot write trace to %s", path.c_str());
+        return 0;
+    }
+    const int pid = static_cast<int>(getpid());
+    fputs("{\"traceEvents\":[\n", file);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        fprintf(file, "{\"ph\":\"%c\",\"ts\":%lld,\"pid\":%d,\"tid\":%d", event.phase,
+                static_cast<long long>(event.ts_us), pid, event.tid);
+        if (event.phase != 'E') {
+            fputs(",\"name\":", file);
+            write_json_string(file, event.name);
+        }
+        if (event.phase == 'C') {
+            fputs(",\"args\":{", file);
+            write_json_string(file, event.name);
+            fprintf(file, ":%lld}", static_cast<long long>(event.value));
+        }
+        fputs(i + 1 < events.size() ? "},\n" : "}\n", file);
+    }
+    fputs("],\"displayTimeUnit\":\"ms\"}\n", file);
+    fclose(file);
+    LOGI("Wrote %zu trace events to %s", events.size(), path.c_str());
+    return events.size();
+}
+
+bool trace_start_from_env() {
+    const char* path = std::getenv("ASSISTANT_TRACE");
+    return path != nullptr && trace_start(path);
+}
+
+#endif
+
+} // namespace assistant
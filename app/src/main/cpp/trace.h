@@ -0,0 +1,70 @@
+/**
+ * trace.h - Trace sections for Perfetto/systrace and host Chrome traces
+ *
+ * On Android, sections go to ATrace, so they show up in a Perfetto or
+ * systrace capture of the app (category "app") next to the Kotlin
+ * android.os.Trace sections, the binder calls and the scheduler: one
+ * capture shows the whole trigger -> answer timeline. ATrace itself
+ * checks whether tracing is on, so a section costs a few ns when idle.
+ *
+ * On host builds there is no ATrace; trace_start(path) instead records
+ * sections in memory and trace_stop() writes them as Chrome trace JSON,
+ * which Perfetto UI and chrome://tracing open. Tools also honour the
+ * ASSISTANT_TRACE environment variable (see trace_start_from_env).
+ *
+ * Sections are strictly nested per thread: end the innermost one first.
+ * Use TRACE_SCOPE for a section that ends with the enclosing block.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace assistant {
+
+/** True while sections are being recorded (ATrace enabled, or a host trace open). */
+bool trace_enabled();
+
+/** Open a section named `name` on the calling thread. */
+void trace_begin(const char* name);
+
+/** Close the calling thread's innermost section. */
+void trace_end();
+
+/** Value of a counter track, e.g. a queue depth. */
+void trace_counter(const char* name, int64_t value);
+
+/**
+ * Host builds: record sections until trace_stop(), which writes them to
+ * `path` as Chrome trace JSON. Always false on Android.
+ */
+bool trace_start(const char* path);
+
+/** Write and close the host trace; returns the number of events written. */
+size_t trace_stop();
+
+/** trace_start($ASSISTANT_TRACE) when the variable is set; for host tools. */
+bool trace_start_from_env();
+
+class TraceSection {
+public:
+    explicit TraceSection(const char* name) : active_(trace_enabled()) {
+        if (active_) trace_begin(name);
+    }
+    ~TraceSection() {
+        if (active_) trace_end();
+    }
+
+    TraceSection(const TraceSection&) = delete;
+    TraceSection& operator=(const TraceSection&) = delete;
+
+private:
+    bool active_;
+};
+
+} // namespace assistant
+
+#define ASSISTANT_TRACE_CONCAT_(a, b) a##b
+#define ASSISTANT_TRACE_CONCAT(a, b) ASSISTANT_TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) assistant::TraceSection ASSISTANT_TRACE_CONCAT(trace_section_, __LINE__)(name)
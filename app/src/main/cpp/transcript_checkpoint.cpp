@@ -0,0 +1,288 @@
+/**
+ * transcript_checkpoint.cpp - On-disk progress of a long transcription
+ *
+ * Record: u32 payload length, u32 CRC-32 of the payload, payload; all
+ * little-endian. The first payload byte is the record type:
+ *
+ *   'H'  "TCKP", u32 version, key bytes (the rest of the payload)
+ *   'W'  i64 position, u32 n, n x i32 prompt tokens,
+ *        u32 m, m x (i64 t0_ms, i64 t1_ms, u32 length, text bytes)
+ *   'C'  (empty)
+ */
+
+#define LOG_TAG "TranscriptCheckpoint"
+
+#include "transcript_checkpoint.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "native_log.h"
+
+namespace assistant {
+
+namespace {
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kRecordHeader = 8;
+    // Far above any real window; a larger length is damage, not data
+    constexpr uint32_t kMaxPayload = 16u << 20;
+
+    const uint32_t* crc32_table() {
+        static const auto table = [] {
+            static uint32_t t[256];
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t crc32(const uint8_t* p, size_t n) {
+        const uint32_t* table = crc32_table();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void put_i64(std::vector<uint8_t>& out, int64_t v) {
+        const auto u = static_cast<uint64_t>(v);
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(u >> (8 * i)));
+    }
+
+    uint32_t read_u32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    /** Bounds-checked reads from one payload; ok() turns false on the first overrun. */
+    class PayloadReader {
+    public:
+        PayloadReader(const uint8_t* p, size_t n) : p_(p), end_(p + n) {}
+
+        bool ok() const { return ok_; }
+        bool done() const { return p_ == end_; }
+
+        uint32_t u32() {
+            if (!take(4)) return 0;
+            return read_u32(p_ - 4);
+        }
+
+        int64_t i64() {
+            if (!take(8)) return 0;
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) v = (v << 8) | p_[i - 8];
+            return static_cast<int64_t>(v);
+        }
+
+        const uint8_t* bytes(size_t n) {
+            return take(n) ? p_ - n : nullptr;
+        }
+
+    private:
+        bool take(size_t n) {
+            if (!ok_ || static_cast<size_t>(end_ - p_) < n) {
+                ok_ = false;
+                return false;
+            }
+            p_ += n;
+            return true;
+        }
+
+        const uint8_t* p_;
+        const uint8_t* end_;
+        bool ok_ = true;
+    };
+
+    bool parse_window(const uint8_t* p, size_t n, TranscriptProgress& progress) {
+        PayloadReader in(p, n);
+        const int64_t position = in.i64();
+        const uint32_t n_prompt = in.u32();
+        if (!in.ok() || n_prompt > n / 4) return false;
+        std::vector<int32_t> prompt(n_prompt);
+        for (int32_t& token : prompt) token = static_cast<int32_t>(in.u32());
+        const uint32_t n_segments = in.u32();
+        if (!in.ok() || n_segments > n / 20) return false;
+        std::vector<TranscriptSegment> segments(n_segments);
+        for (TranscriptSegment& segment : segments) {
+            segment.t0_ms = in.i64();
+            segment.t1_ms = in.i64();
+            const uint32_t length = in.u32();
+            const uint8_t* text = in.bytes(length);
+            if (text == nullptr) return false;
+            segment.text.assign(reinterpret_cast<const char*>(text), length);
+        }
+        if (!in.ok() || !in.done() || position < progress.position) return false;
+
+        progress.position = position;
+        progress.prompt = std::move(prompt);
+        for (TranscriptSegment& segment : segments) progress.segments.push_back(std::move(segment));
+        ++progress.windows;
+        return true;
+    }
+
+    bool read_all(int fd, std::vector<uint8_t>& out) {
+        uint8_t buffer[16384];
+        while (true) {
+            const ssize_t got = read(fd, buffer, sizeof(buffer));
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) return false;
+            if (got == 0) return true;
+            out.insert(out.end(), buffer, buffer + got);
+        }
+    }
+
+    bool write_all(int fd, const uint8_t* p, size_t n) {
+        while (n > 0) {
+            const ssize_t wrote = write(fd, p, n);
+            if (wrote < 0 && errno == EINTR) continue;
+            if (wrote <= 0) return false;
+            p += wrote;
+            n -= static_cast<size_t>(wrote);
+        }
+        return true;
+    }
+
+    /**
+     * Replay the records of `data` for `key` into `progress`; returns the
+     * end of the last intact record, or -1 if the journal is not usable
+     * for `key` at all.
+     */
+    long replay(const std::vector<uint8_t>& data, const std::string& key, TranscriptProgress& progress) {
+        size_t offset = 0;
+        bool have_header = false;
+        while (data.size() - offset >= kRecordHeader) {
+            const uint32_t length = read_u32(data.data() + offset);
+            const uint32_t crc = read_u32(data.data() + offset + 4);
+            if (length == 0 || length > kMaxPayload || data.size() - offset - kRecordHeader < length) break;
+            const uint8_t* payload = data.data() + offset + kRecordHeader;
+            if (crc32(payload, length) != crc) break;
+
+            bool ok;
+            if (!have_header) {
+                PayloadReader in(payload + 1, length - 1);
+                const uint8_t* magic = in.bytes(4);
+                const uint32_t version = in.u32();
+                ok = payload[0] == 'H' && length >= 9 && magic != nullptr && memcmp(magic, "TCKP", 4) == 0 &&
+                     version == kVersion && key.size() == length - 9 &&
+                     memcmp(payload + 9, key.data(), key.size()) == 0;
+                if (!ok) return -1;
+                have_header = true;
+            } else if (payload[0] == 'W' && !progress.complete) {
+                ok = parse_window(payload + 1, length - 1, progress);
+            } else if (payload[0] == 'C' && length == 1) {
+                progress.complete = true;
+                ok = true;
+            } else {
+                ok = false;
+            }
+            if (!ok) break;
+            offset += kRecordHeader + length;
+        }
+        return have_header ? static_cast<long>(offset) : -1;
+    }
+
+    void set_error(std::string* error, const std::string& message) {
+        if (error != nullptr) *error = message;
+    }
+}
+
+std::unique_ptr<TranscriptCheckpoint> TranscriptCheckpoint::open(const char* path, const std::string& key,
+                                                                 TranscriptProgress* restored, std::string* error) {
+    TranscriptProgress progress;
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        set_error(error, std::string("cannot open checkpoint: ") + strerror(errno));
+        return nullptr;
+    }
+
+    std::vector<uint8_t> data;
+    long end = read_all(fd, data) ? replay(data, key, progress) : -1;
+    std::unique_ptr<TranscriptCheckpoint> checkpoint(new TranscriptCheckpoint(path, fd, 0));
+    if (end < 0) {
+        // Missing, foreign or damaged before the first window: start over
+        progress = TranscriptProgress();
+        if (!data.empty()) {
+            LOGW("Checkpoint %s is for another job or unreadable; starting over", path);
+        }
+        std::vector<uint8_t> header = {'H', 'T', 'C', 'K', 'P'};
+        put_u32(header, kVersion);
+        header.insert(header.end(), key.begin(), key.end());
+        if (ftruncate(fd, 0) != 0 || !checkpoint->write_record(header)) {
+            set_error(error, std::string("cannot write checkpoint: ") + strerror(errno));
+            return nullptr;
+        }
+    } else {
+        if (static_cast<size_t>(end) < data.size()) {
+            // A torn write from the process dying mid-record; drop it so appends follow the last good one
+            LOGW("Checkpoint %s: dropping %zu bytes after the last intact record", path,
+                 data.size() - static_cast<size_t>(end));
+            if (ftruncate(fd, end) != 0 || fsync(fd) != 0) {
+                set_error(error, std::string("cannot repair checkpoint: ") + strerror(errno));
+                return nullptr;
+            }
+        }
+        checkpoint->size_ = end;
+    }
+
+    if (restored != nullptr) *restored = std::move(progress);
+    return checkpoint;
+}
+
+TranscriptCheckpoint::~TranscriptCheckpoint() {
+    close(fd_);
+}
+
+bool TranscriptCheckpoint::append(int64_t position, const std::vector<int32_t>& prompt,
+                                  const TranscriptSegment* segments, size_t n_segments) {
+    std::vector<uint8_t> payload = {'W'};
+    put_i64(payload, position);
+    put_u32(payload, static_cast<uint32_t>(prompt.size()));
+    for (int32_t token : prompt) put_u32(payload, static_cast<uint32_t>(token));
+    put_u32(payload, static_cast<uint32_t>(n_segments));
+    for (size_t i = 0; i < n_segments; ++i) {
+        put_i64(payload, segments[i].t0_ms);
+        put_i64(payload, segments[i].t1_ms);
+        put_u32(payload, static_cast<uint32_t>(segments[i].text.size()));
+        payload.insert(payload.end(), segments[i].text.begin(), segments[i].text.end());
+    }
+    return write_record(payload);
+}
+
+bool TranscriptCheckpoint::finish() {
+    return write_record({'C'});
+}
+
+bool TranscriptCheckpoint::write_record(const std::vector<uint8_t>& payload) {
+    if (payload.size() > kMaxPayload) {
+        LOGE("Checkpoint record of %zu bytes is too large", payload.size());
+        return false;
+    }
+    std::vector<uint8_t> record;
+    record.reserve(kRecordHeader + payload.size());
+    put_u32(record, static_cast<uint32_t>(payload.size()));
+    put_u32(record, crc32(payload.data(), payload.size()));
+    record.insert(record.end(), payload.begin(), payload.end());
+
+    if (lseek(fd_, size_, SEEK_SET) != size_ || !write_all(fd_, record.data(), record.size()) || fsync(fd_) != 0) {
+        LOGE("Checkpoint %s: write failed: %s", path_.c_str(), strerror(errno));
+        // Whatever part of the record landed is cut off again, so the journal stays readable
+        if (ftruncate(fd_, size_) != 0) {
+            LOGE("Checkpoint %s: cannot drop the partial record", path_.c_str());
+        }
+        return false;
+    }
+    size_ += static_cast<long>(record.size());
+    return true;
+}
+
+} // namespace assistant
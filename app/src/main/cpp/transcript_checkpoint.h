@@ -0,0 +1,83 @@
+/**
+ * transcript_checkpoint.h - On-disk progress of a long transcription
+ *
+ * An hour-long recording takes many minutes to transcribe, and Android
+ * may kill the process at any point of it. The checkpoint is an
+ * append-only journal next to the work: a header naming the job (`key`:
+ * the source file and decoding options, as the caller spells them), then
+ * one record per finished window with its segments, the position the
+ * next window starts at and the decoder context (the prompt tokens) it
+ * needs, and finally a record marking the transcript complete.
+ *
+ * Each record carries its length and a CRC-32 and is synced before
+ * append() returns, so a crash mid-write loses at most the window in
+ * flight: open() keeps every intact record, cuts off a torn tail and
+ * appends after it. A journal for another key (the recording changed, or
+ * another language was asked for) is started over.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace assistant {
+
+struct TranscriptSegment {
+    int64_t t0_ms = 0;          // from the start of the recording
+    int64_t t1_ms = 0;
+    std::string text;
+};
+
+/** What a checkpoint held when it was opened. */
+struct TranscriptProgress {
+    int64_t position = 0;               // frames covered by the saved windows
+    std::vector<int32_t> prompt;        // decoder context for the window at `position`
+    std::vector<TranscriptSegment> segments;
+    size_t windows = 0;
+    bool complete = false;
+};
+
+class TranscriptCheckpoint {
+public:
+    /**
+     * Open the journal at `path` for `key`, creating it if it is missing,
+     * unreadable or for another key; what it already holds goes to
+     * `restored`. Returns nullptr, with the reason in `error`, if the file
+     * cannot be written.
+     */
+    static std::unique_ptr<TranscriptCheckpoint> open(const char* path, const std::string& key,
+                                                      TranscriptProgress* restored, std::string* error = nullptr);
+
+    ~TranscriptCheckpoint();
+
+    TranscriptCheckpoint(const TranscriptCheckpoint&) = delete;
+    TranscriptCheckpoint& operator=(const TranscriptCheckpoint&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    /**
+     * Record a finished window: its segments, the frame the next window
+     * starts at and the context to decode it with. False if the write or
+     * sync failed; the journal then ends at the previous window.
+     */
+    bool append(int64_t position, const std::vector<int32_t>& prompt, const TranscriptSegment* segments,
+                size_t n_segments);
+
+    /** Mark the transcript complete; reopening then restores it without further windows. */
+    bool finish();
+
+private:
+    TranscriptCheckpoint(std::string path, int fd, long size) : path_(std::move(path)), fd_(fd), size_(size) {}
+
+    bool write_record(const std::vector<uint8_t>& payload);
+
+    std::string path_;
+    int fd_;
+    long size_;             // end of the last intact record
+};
+
+} // namespace assistant
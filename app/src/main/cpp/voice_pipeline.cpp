@@ -0,0 +1,617 @@
+/**
+ * voice_pipeline.cpp - Stage chain, frame pool and built-in stages
+ */
+
+#include "voice_pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "endpointer.h"
+#include "resampler.h"
+#include "trace.h"
+#include "wav_io.h"
+
+namespace assistant {
+
+// ---------------------------------------------------------------------------
+// FramePool
+
+FramePool::FramePool(size_t frames, size_t capacity)
+    : capacity_(capacity), storage_(frames * capacity), frames_(frames) {
+    free_.reserve(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        frames_[i].pcm = storage_.data() + i * capacity;
+        frames_[i].capacity = capacity;
+        free_.push_back(&frames_[i]);
+    }
+}
+
+AudioFrame* FramePool::acquire() {
+    if (free_.empty()) return nullptr;
+    AudioFrame* frame = free_.back();
+    free_.pop_back();
+    frame->size = 0;
+    frame->speech = false;
+    return frame;
+}
+
+void FramePool::release(AudioFrame* frame) {
+    if (frame != nullptr) free_.push_back(frame);
+}
+
+// ---------------------------------------------------------------------------
+// Spec parsing
+
+std::string StageParams::get(const std::string& key, const std::string& fallback) const {
+    const auto it = values_.find(key);
+    return it != values_.end() ? it->second : fallback;
+}
+
+int32_t StageParams::get_int(const std::string& key, int32_t fallback) const {
+    const auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    char* end = nullptr;
+    const long value = strtol(it->second.c_str(), &end, 10);
+    return end != it->second.c_str() && *end == '\0' ? static_cast<int32_t>(value) : fallback;
+}
+
+float StageParams::get_float(const std::string& key, float fallback) const {
+    const auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    char* end = nullptr;
+    const float value = strtof(it->second.c_str(), &end);
+    return end != it->second.c_str() && *end == '\0' ? value : fallback;
+}
+
+namespace {
+    void set_error(std::string* error, const std::string& message) {
+        if (error != nullptr) *error = message;
+    }
+
+    std::vector<std::string> split_words(const std::string& text) {
+        std::vector<std::string> words;
+        std::string word;
+        for (char c : text) {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                if (!word.empty()) words.push_back(word);
+                word.clear();
+            } else {
+                word += c;
+            }
+        }
+        if (!word.empty()) words.push_back(word);
+        return words;
+    }
+}
+
+bool parse_pipeline_spec(const std::string& text, std::vector<StageSpec>& out, std::string* error) {
+    out.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t bar = text.find('|', start);
+        if (bar == std::string::npos) bar = text.size();
+        const std::vector<std::string> words = split_words(text.substr(start, bar - start));
+        if (words.empty()) {
+            set_error(error, "empty stage at offset " + std::to_string(start));
+            return false;
+        }
+
+        StageSpec spec;
+        spec.name = words[0];
+        for (size_t i = 1; i < words.size(); ++i) {
+            const size_t eq = words[i].find('=');
+            if (eq == std::string::npos || eq == 0) {
+                set_error(error, "stage '" + spec.name + "': expected key=value, got '" + words[i] + "'");
+                return false;
+            }
+            spec.params.set(words[i].substr(0, eq), words[i].substr(eq + 1));
+        }
+        out.push_back(std::move(spec));
+        start = bar + 1;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in stages
+
+namespace {
+    int16_t saturate(float x) {
+        return static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, x)));
+    }
+
+    /** First-order high-pass: y[n] = a * (y[n-1] + x[n] - x[n-1]). */
+    class HighPassStage : public Stage {
+    public:
+        explicit HighPassStage(float cutoff_hz) : cutoff_hz_(cutoff_hz) {}
+
+        int32_t configure(int32_t sample_rate, size_t) override {
+            const float rc = 1.0f / (2.0f * static_cast<float>(M_PI) * cutoff_hz_);
+            const float dt = 1.0f / static_cast<float>(sample_rate);
+            alpha_ = rc / (rc + dt);
+            return sample_rate;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            for (size_t i = 0; i < frame.size; ++i) {
+                const float x = frame.pcm[i];
+                prev_out_ = alpha_ * (prev_out_ + x - prev_in_);
+                prev_in_ = x;
+                frame.pcm[i] = saturate(prev_out_);
+            }
+            return true;
+        }
+
+        void reset() override { prev_in_ = prev_out_ = 0.0f; }
+
+    private:
+        float cutoff_hz_;
+        float alpha_ = 1.0f;
+        float prev_in_ = 0.0f;
+        float prev_out_ = 0.0f;
+    };
+
+    class GainStage : public Stage {
+    public:
+        explicit GainStage(float db) : gain_(std::pow(10.0f, db / 20.0f)) {}
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            for (size_t i = 0; i < frame.size; ++i) frame.pcm[i] = saturate(frame.pcm[i] * gain_);
+            return true;
+        }
+
+    private:
+        float gain_;
+    };
+
+    class ResampleStage : public Stage {
+    public:
+        explicit ResampleStage(int32_t rate) : out_rate_(rate) {}
+
+        int32_t configure(int32_t sample_rate, size_t frame_capacity) override {
+            resampler_.reset(new Resampler(sample_rate, out_rate_));
+            capacity_ = frame_capacity;
+            in_.resize(frame_capacity);
+            out_.resize(resampler_->max_output(frame_capacity));
+            return out_rate_;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            for (size_t i = 0; i < frame.size; ++i) in_[i] = frame.pcm[i];
+            const size_t produced = resampler_->process(in_.data(), frame.size, out_.data(), out_.size());
+            // Upsampling past the frame's headroom would need a second frame; drop the excess
+            frame.size = std::min(produced, capacity_);
+            for (size_t i = 0; i < frame.size; ++i) frame.pcm[i] = saturate(out_[i]);
+            frame.sample_rate = out_rate_;
+            return frame.size > 0;
+        }
+
+        void reset() override {
+            if (resampler_) resampler_->reset();
+        }
+
+    private:
+        int32_t out_rate_;
+        std::unique_ptr<Resampler> resampler_;
+        size_t capacity_ = 0;
+        std::vector<float> in_;
+        std::vector<float> out_;
+    };
+
+    class VadStage : public Stage {
+    public:
+        VadStage(const EndpointerConfig& config, bool stop_on_end)
+            : config_(config), stop_on_end_(stop_on_end) {}
+
+        int32_t configure(int32_t sample_rate, size_t) override {
+            config_.sample_rate = sample_rate;
+            endpointer_.reset(new Endpointer(config_));
+            return sample_rate;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext& context) override {
+            const EndpointState before = endpointer_->state();
+            const EndpointState state = endpointer_->process(frame.pcm, frame.size);
+            frame.speech = endpointer_->last_frame_speech();
+            if (state == before) return true;
+
+            PipelineEvent event;
+            if (state == ENDPOINT_SPEECH) {
+                event.type = PIPELINE_SPEECH_START;
+                event.position = frame.position;
+            } else if (state == ENDPOINT_ENDED) {
+                event.reason = endpointer_->reason();
+                event.type = event.reason == ENDPOINT_REASON_NO_SPEECH ? PIPELINE_NO_SPEECH : PIPELINE_SPEECH_END;
+                event.position = frame.position;
+                event.delay_ms = endpointer_->detection_delay_ms();
+                if (before == ENDPOINT_WAITING && event.type == PIPELINE_SPEECH_END) {
+                    // Speech started and ended within one frame
+                    PipelineEvent start;
+                    start.type = PIPELINE_SPEECH_START;
+                    start.position = frame.position;
+                    context.emit(start);
+                }
+                if (stop_on_end_) context.request_stop();
+            }
+            context.emit(event);
+            return true;
+        }
+
+        void reset() override {
+            if (endpointer_) endpointer_->reset();
+        }
+
+        void on_decoder_endpoint() override {
+            if (endpointer_) endpointer_->notify_decoder_endpoint();
+        }
+
+    private:
+        EndpointerConfig config_;
+        bool stop_on_end_;
+        std::unique_ptr<Endpointer> endpointer_;
+    };
+
+    /** FIFO of processed audio for the platform; the oldest audio is dropped when full. */
+    class TapStage : public Stage {
+    public:
+        explicit TapStage(float seconds) : seconds_(seconds) {}
+
+        int32_t configure(int32_t sample_rate, size_t) override {
+            limit_ = static_cast<size_t>(std::max(0.1f, seconds_) * static_cast<float>(sample_rate));
+            buffer_.reserve(limit_);
+            return sample_rate;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            compact();
+            buffer_.insert(buffer_.end(), frame.pcm, frame.pcm + frame.size);
+            if (buffer_.size() > limit_) read_ = buffer_.size() - limit_;
+            return true;
+        }
+
+        size_t read_output(int16_t* out, size_t max_samples) override {
+            const size_t n = std::min(max_samples, buffer_.size() - read_);
+            std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(read_),
+                      buffer_.begin() + static_cast<std::ptrdiff_t>(read_ + n), out);
+            read_ += n;
+            return n;
+        }
+
+        void reset() override {
+            buffer_.clear();
+            read_ = 0;
+        }
+
+    private:
+        void compact() {
+            if (read_ == 0) return;
+            buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(read_));
+            read_ = 0;
+        }
+
+        float seconds_;
+        size_t limit_ = 0;
+        std::vector<int16_t> buffer_;
+        size_t read_ = 0;
+    };
+
+    class WavSinkStage : public Stage {
+    public:
+        explicit WavSinkStage(std::string path) : path_(std::move(path)) {}
+
+        int32_t configure(int32_t sample_rate, size_t) override {
+            sample_rate_ = sample_rate;
+            return sample_rate;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            pcm_.insert(pcm_.end(), frame.pcm, frame.pcm + frame.size);
+            return true;
+        }
+
+        void finish(PipelineContext&) override {
+            write_wav_mono16(path_, pcm_.data(), pcm_.size(), sample_rate_);
+        }
+
+        void reset() override { pcm_.clear(); }
+
+    private:
+        std::string path_;
+        int32_t sample_rate_ = 0;
+        std::vector<int16_t> pcm_;
+    };
+
+    class EngineStage : public Stage {
+    public:
+        explicit EngineStage(std::unique_ptr<AsrEngine> engine) : engine_(std::move(engine)) {}
+
+        int32_t configure(int32_t sample_rate, size_t) override {
+            // Engines take their own rate; put a resample stage in front otherwise
+            return sample_rate == engine_->sample_rate() ? sample_rate : -1;
+        }
+
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            engine_->accept(frame.pcm, frame.size);
+            return true;
+        }
+
+        void finish(PipelineContext& context) override {
+            PipelineEvent event;
+            event.type = PIPELINE_RESULT;
+            event.text = engine_->finish();
+            context.emit(event);
+        }
+
+        void reset() override { engine_->reset(); }
+
+    private:
+        std::unique_ptr<AsrEngine> engine_;
+    };
+}
+
+std::unique_ptr<Stage> make_engine_stage(std::unique_ptr<AsrEngine> engine) {
+    if (!engine) return nullptr;
+    return std::unique_ptr<Stage>(new EngineStage(std::move(engine)));
+}
+
+StageRegistry StageRegistry::with_builtins() {
+    StageRegistry registry;
+    registry.add("highpass", [](const StageParams& params, std::string* error) -> std::unique_ptr<Stage> {
+        const float cutoff = params.get_float("cutoff_hz", 80.0f);
+        if (cutoff <= 0.0f) {
+            set_error(error, "highpass: cutoff_hz must be positive");
+            return nullptr;
+        }
+        return std::unique_ptr<Stage>(new HighPassStage(cutoff));
+    });
+    registry.add("gain", [](const StageParams& params, std::string*) -> std::unique_ptr<Stage> {
+        return std::unique_ptr<Stage>(new GainStage(params.get_float("db", 0.0f)));
+    });
+    registry.add("resample", [](const StageParams& params, std::string* error) -> std::unique_ptr<Stage> {
+        const int32_t rate = params.get_int("rate", 16000);
+        if (rate < 8000 || rate > 48000) {
+            set_error(error, "resample: rate must be 8000..48000");
+            return nullptr;
+        }
+        return std::unique_ptr<Stage>(new ResampleStage(rate));
+    });
+    registry.add("vad", [](const StageParams& params, std::string*) -> std::unique_ptr<Stage> {
+        EndpointerConfig config;
+        config.onset_ms = params.get_int("onset_ms", config.onset_ms);
+        config.hangover_ms = params.get_int("hangover_ms", config.hangover_ms);
+        config.decoder_hangover_ms = params.get_int("decoder_hangover_ms", config.decoder_hangover_ms);
+        config.leading_timeout_ms = params.get_int("leading_timeout_ms", config.leading_timeout_ms);
+        config.max_utterance_ms = params.get_int("max_utterance_ms", config.max_utterance_ms);
+        config.snr_db = params.get_float("snr_db", config.snr_db);
+        return std::unique_ptr<Stage>(new VadStage(config, params.get_int("stop", 1) != 0));
+    });
+    registry.add("tap", [](const StageParams& params, std::string*) -> std::unique_ptr<Stage> {
+        return std::unique_ptr<Stage>(new TapStage(params.get_float("seconds", 30.0f)));
+    });
+    registry.add("wav", [](const StageParams& params, std::string* error) -> std::unique_ptr<Stage> {
+        if (!params.has("path")) {
+            set_error(error, "wav: path is required");
+            return nullptr;
+        }
+        return std::unique_ptr<Stage>(new WavSinkStage(params.get("path")));
+    });
+    return registry;
+}
+
+void StageRegistry::add(const std::string& name, StageFactory factory) {
+    factories_[name] = std::move(factory);
+}
+
+std::unique_ptr<Stage> StageRegistry::create(const StageSpec& spec, std::string* error) const {
+    const auto it = factories_.find(spec.name);
+    if (it == factories_.end()) {
+        set_error(error, "unknown stage '" + spec.name + "'");
+        return nullptr;
+    }
+    return it->second(spec.params, error);
+}
+
+// ---------------------------------------------------------------------------
+// Sources
+
+size_t BufferSource::read(int16_t* out, size_t max_samples) {
+    const size_t n = std::min(max_samples, pcm_.size() - pos_);
+    std::copy(pcm_.begin() + static_cast<std::ptrdiff_t>(pos_),
+              pcm_.begin() + static_cast<std::ptrdiff_t>(pos_ + n), out);
+    pos_ += n;
+    return n;
+}
+
+bool WavFileSource::open(const std::string& path) {
+    pos_ = 0;
+    return read_wav_mono16(path, pcm_, &sample_rate_);
+}
+
+size_t WavFileSource::read(int16_t* out, size_t max_samples) {
+    const size_t n = std::min(max_samples, pcm_.size() - pos_);
+    std::copy(pcm_.begin() + static_cast<std::ptrdiff_t>(pos_),
+              pcm_.begin() + static_cast<std::ptrdiff_t>(pos_ + n), out);
+    pos_ += n;
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// VoicePipeline
+
+bool VoicePipeline::build(const std::string& spec, const StageRegistry& registry,
+                          const PipelineOptions& options, std::string* error) {
+    options_ = options;
+    stages_.clear();
+    stats_.clear();
+    if (options_.sample_rate <= 0 || options_.frame_ms <= 0) {
+        set_error(error, "invalid sample rate or frame size");
+        return false;
+    }
+    frame_samples_ = static_cast<size_t>(options_.sample_rate) * options_.frame_ms / 1000;
+    pool_.reset(new FramePool(std::max<size_t>(1, options_.pool_frames),
+                              frame_samples_ * std::max<size_t>(1, options_.frame_headroom)));
+    output_rate_ = options_.sample_rate;
+    reset();
+
+    std::vector<StageSpec> specs;
+    if (!parse_pipeline_spec(spec, specs, error)) return false;
+    for (const StageSpec& stage_spec : specs) {
+        std::unique_ptr<Stage> stage = registry.create(stage_spec, error);
+        if (!stage) {
+            if (error != nullptr && error->empty()) *error = "stage '" + stage_spec.name + "' failed to build";
+            return false;
+        }
+        if (!append(stage_spec.name, std::move(stage), error)) return false;
+    }
+    return true;
+}
+
+bool VoicePipeline::append(const std::string& name, std::unique_ptr<Stage> stage, std::string* error) {
+    if (!pool_ || !stage) {
+        set_error(error, "pipeline not built");
+        return false;
+    }
+    const int32_t rate = stage->configure(output_rate_, pool_->frame_capacity());
+    if (rate <= 0) {
+        set_error(error, "stage '" + name + "' cannot take " + std::to_string(output_rate_) + " Hz input");
+        return false;
+    }
+    output_rate_ = rate;
+    stages_.push_back(std::move(stage));
+    StageStats stats;
+    stats.name = name;
+    stats_.push_back(stats);
+    return true;
+}
+
+bool VoicePipeline::push(const int16_t* pcm, size_t n) {
+    if (!pool_ || stopped_ || finished_) return false;
+    while (n > 0) {
+        if (pending_ == nullptr) {
+            pending_ = pool_->acquire();
+            if (pending_ == nullptr) {
+                // Only happens if a stage kept a frame; drop input rather than allocate
+                ++pool_misses_;
+                position_ += static_cast<int64_t>(n);
+                return true;
+            }
+            pending_->sample_rate = options_.sample_rate;
+            pending_->position = position_;
+        }
+        const size_t take = std::min(n, frame_samples_ - pending_->size);
+        std::copy(pcm, pcm + take, pending_->pcm + pending_->size);
+        pending_->size += take;
+        position_ += static_cast<int64_t>(take);
+        pcm += take;
+        n -= take;
+
+        if (pending_->size == frame_samples_) {
+            AudioFrame* frame = pending_;
+            pending_ = nullptr;
+            run_frame(frame);
+            if (stopped_) return false;
+        }
+    }
+    return true;
+}
+
+void VoicePipeline::run_frame(AudioFrame* frame) {
+    using Clock = std::chrono::steady_clock;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        StageStats& stats = stats_[i];
+        ++stats.frames;
+        stats.samples += frame->size;
+        const auto start = Clock::now();
+        bool keep;
+        {
+            TraceSection section(stats.name.c_str());
+            keep = stages_[i]->process(*frame, *this);
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        stats.total_us += us;
+        stats.max_us = std::max(stats.max_us, us);
+        if (!keep) {
+            ++stats.dropped;
+            break;
+        }
+    }
+    pool_->release(frame);
+    if (stop_requested_) stopped_ = true;
+}
+
+void VoicePipeline::run(Source& source) {
+    std::vector<int16_t> buffer(frame_samples_ > 0 ? frame_samples_ : 320);
+    while (!stopped_) {
+        const size_t n = source.read(buffer.data(), buffer.size());
+        if (n == 0) break;
+        push(buffer.data(), n);
+    }
+    finish();
+}
+
+void VoicePipeline::finish() {
+    if (!pool_ || finished_) return;
+    if (pending_ != nullptr) {
+        AudioFrame* frame = pending_;
+        pending_ = nullptr;
+        if (frame->size > 0 && !stopped_) {
+            run_frame(frame);
+        } else {
+            pool_->release(frame);
+        }
+    }
+    for (auto& stage : stages_) stage->finish(*this);
+    finished_ = true;
+}
+
+void VoicePipeline::reset() {
+    if (pending_ != nullptr && pool_) pool_->release(pending_);
+    pending_ = nullptr;
+    for (auto& stage : stages_) stage->reset();
+    for (StageStats& stats : stats_) {
+        const std::string name = stats.name;
+        stats = StageStats();
+        stats.name = name;
+    }
+    events_.clear();
+    position_ = 0;
+    pool_misses_ = 0;
+    stop_requested_ = false;
+    stopped_ = false;
+    finished_ = false;
+}
+
+void VoicePipeline::notify_decoder_endpoint() {
+    for (auto& stage : stages_) stage->on_decoder_endpoint();
+}
+
+size_t VoicePipeline::poll_events(std::vector<PipelineEvent>& out) {
+    const size_t n = events_.size();
+    for (PipelineEvent& event : events_) out.push_back(std::move(event));
+    events_.clear();
+    return n;
+}
+
+size_t VoicePipeline::read_output(int16_t* out, size_t max_samples) {
+    if (stages_.empty()) return 0;
+    return stages_.back()->read_output(out, max_samples);
+}
+
+std::string VoicePipeline::format_stats() const {
+    std::string text;
+    char line[160];
+    for (const StageStats& stats : stats_) {
+        const double mean = stats.frames > 0 ? stats.total_us / static_cast<double>(stats.frames) : 0.0;
+        snprintf(line, sizeof(line), "%-10s %8llu frames %8.1f us/frame (max %.1f)%s\n",
+                 stats.name.c_str(), static_cast<unsigned long long>(stats.frames), mean, stats.max_us,
+                 stats.dropped > 0 ? " [drops]" : "");
+        text += line;
+    }
+    return text;
+}
+
+} // namespace assistant
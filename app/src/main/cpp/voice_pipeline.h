@@ -0,0 +1,302 @@
+/**
+ * voice_pipeline.h - Composable capture pipeline: source -> preprocess -> VAD -> engine -> sink
+ *
+ * A pipeline is a chain of stages built from a declarative spec, e.g.
+ *
+ *     highpass cutoff_hz=100 | gain db=6 | vad hangover_ms=700 | tap seconds=30
+ *
+ * Stages are looked up by name in a StageRegistry, so engines and platform
+ * sinks register their own factories next to the built-ins (see
+ * StageRegistry::with_builtins for the list and their parameters).
+ *
+ * Audio moves through the chain in pooled AudioFrames. The only copy is
+ * the one into a frame at the input; every stage works on the frame in
+ * place and the pipeline hands the same frame to the next stage. Each
+ * stage is timed per frame, so DSP, VAD and engine cost appear in one
+ * PipelineStats table whichever engine is in use.
+ *
+ * Input is either pushed (the platform capture loop) or pulled from a
+ * Source (WAV files and buffers on the host, which is how the tests run).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace assistant {
+
+/** One block of 16-bit mono PCM; storage belongs to a FramePool. */
+struct AudioFrame {
+    int16_t* pcm = nullptr;
+    size_t capacity = 0;        // samples available in `pcm`
+    size_t size = 0;            // samples in use
+    int32_t sample_rate = 0;    // changes if a stage resamples
+    int64_t position = 0;       // input sample index of the first sample
+    bool speech = false;        // set by a VAD stage
+};
+
+/** Fixed set of frames with one contiguous allocation; acquire/release never allocate. */
+class FramePool {
+public:
+    FramePool(size_t frames, size_t capacity);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /** nullptr when every frame is in use. */
+    AudioFrame* acquire();
+    void release(AudioFrame* frame);
+
+    size_t available() const { return free_.size(); }
+    size_t frame_capacity() const { return capacity_; }
+
+private:
+    size_t capacity_;
+    std::vector<int16_t> storage_;
+    std::vector<AudioFrame> frames_;
+    std::vector<AudioFrame*> free_;
+};
+
+enum PipelineEventType : int32_t {
+    PIPELINE_SPEECH_START = 1,
+    PIPELINE_SPEECH_END = 2,    // utterance ended (reason: EndpointReason)
+    PIPELINE_NO_SPEECH = 3,     // gave up waiting for speech
+    PIPELINE_RESULT = 4,        // an engine produced text
+};
+
+struct PipelineEvent {
+    PipelineEventType type = PIPELINE_SPEECH_START;
+    int64_t position = 0;       // input sample index
+    int32_t reason = 0;
+    int32_t delay_ms = 0;       // detection delay for end-of-speech events
+    std::string text;
+};
+
+/** What a stage may do besides transforming audio. */
+class PipelineContext {
+public:
+    virtual ~PipelineContext() = default;
+    virtual void emit(const PipelineEvent& event) = 0;
+    /** Finish the current frame, then accept no more input. */
+    virtual void request_stop() = 0;
+};
+
+class Stage {
+public:
+    virtual ~Stage() = default;
+
+    /**
+     * Called once before any audio with the rate of the frames this stage
+     * will see and the frame capacity; returns the rate it emits, or <= 0
+     * if it cannot work with that input.
+     */
+    virtual int32_t configure(int32_t sample_rate, size_t frame_capacity) {
+        (void)frame_capacity;
+        return sample_rate;
+    }
+
+    /** Process in place; return false to end the frame's trip here (e.g. a gate). */
+    virtual bool process(AudioFrame& frame, PipelineContext& context) = 0;
+
+    /** End of input: flush anything buffered. */
+    virtual void finish(PipelineContext& context) { (void)context; }
+
+    virtual void reset() {}
+
+    /** The recognizer downstream reported an utterance boundary of its own. */
+    virtual void on_decoder_endpoint() {}
+
+    /** Sinks that buffer audio for the platform hand it out here; returns the count. */
+    virtual size_t read_output(int16_t* out, size_t max_samples) {
+        (void)out;
+        (void)max_samples;
+        return 0;
+    }
+};
+
+/** "key=value" parameters of one stage in a spec. */
+class StageParams {
+public:
+    void set(const std::string& key, const std::string& value) { values_[key] = value; }
+    bool has(const std::string& key) const { return values_.count(key) != 0; }
+    std::string get(const std::string& key, const std::string& fallback = "") const;
+    int32_t get_int(const std::string& key, int32_t fallback) const;
+    float get_float(const std::string& key, float fallback) const;
+    const std::map<std::string, std::string>& values() const { return values_; }
+
+private:
+    std::map<std::string, std::string> values_;
+};
+
+struct StageSpec {
+    std::string name;
+    StageParams params;
+};
+
+/** Parse "name key=value ... | name ..."; false with a message on malformed input. */
+bool parse_pipeline_spec(const std::string& text, std::vector<StageSpec>& out, std::string* error);
+
+using StageFactory = std::function<std::unique_ptr<Stage>(const StageParams&, std::string* error)>;
+
+class StageRegistry {
+public:
+    /**
+     * Registry with the built-in stages:
+     *   highpass cutoff_hz=80        first-order high-pass (DC and rumble)
+     *   gain db=0                    fixed gain with saturation
+     *   resample rate=16000          change the frame rate (windowed sinc)
+     *   vad hangover_ms=800 ...      endpointer; marks frames, emits events, stops on end
+     *                                (onset_ms, decoder_hangover_ms, leading_timeout_ms,
+     *                                 max_utterance_ms, snr_db, stop=1)
+     *   tap seconds=30               buffers output for read_output()
+     *   wav path=out.wav             writes the output to a WAV file on finish
+     */
+    static StageRegistry with_builtins();
+
+    void add(const std::string& name, StageFactory factory);
+    bool contains(const std::string& name) const { return factories_.count(name) != 0; }
+    std::unique_ptr<Stage> create(const StageSpec& spec, std::string* error) const;
+
+private:
+    std::map<std::string, StageFactory> factories_;
+};
+
+/** A recognizer driven by the pipeline; the "engine" end of the chain. */
+class AsrEngine {
+public:
+    virtual ~AsrEngine() = default;
+    virtual int32_t sample_rate() const { return 16000; }
+    virtual void accept(const int16_t* pcm, size_t n) = 0;
+    /** End of input; returns the transcript. */
+    virtual std::string finish() = 0;
+    virtual void reset() {}
+};
+
+/** Stage adapter for an engine: feeds it every frame, emits PIPELINE_RESULT on finish. */
+std::unique_ptr<Stage> make_engine_stage(std::unique_ptr<AsrEngine> engine);
+
+class Source {
+public:
+    virtual ~Source() = default;
+    virtual int32_t sample_rate() const = 0;
+    /** Up to `max_samples` samples; 0 at the end. */
+    virtual size_t read(int16_t* out, size_t max_samples) = 0;
+};
+
+class BufferSource : public Source {
+public:
+    BufferSource(std::vector<int16_t> pcm, int32_t sample_rate)
+        : pcm_(std::move(pcm)), sample_rate_(sample_rate) {}
+    int32_t sample_rate() const override { return sample_rate_; }
+    size_t read(int16_t* out, size_t max_samples) override;
+
+private:
+    std::vector<int16_t> pcm_;
+    int32_t sample_rate_;
+    size_t pos_ = 0;
+};
+
+/** A 16-bit WAV file (downmixed to mono), read up front. */
+class WavFileSource : public Source {
+public:
+    bool open(const std::string& path);
+    int32_t sample_rate() const override { return sample_rate_; }
+    size_t read(int16_t* out, size_t max_samples) override;
+
+private:
+    std::vector<int16_t> pcm_;
+    int32_t sample_rate_ = 0;
+    size_t pos_ = 0;
+};
+
+struct StageStats {
+    std::string name;
+    uint64_t frames = 0;        // frames that reached this stage
+    uint64_t samples = 0;
+    uint64_t dropped = 0;       // frames this stage ended early
+    double total_us = 0.0;
+    double max_us = 0.0;
+};
+
+struct PipelineOptions {
+    int32_t sample_rate = 16000;    // input rate
+    int32_t frame_ms = 20;
+    size_t pool_frames = 2;
+    size_t frame_headroom = 4;      // frame capacity as a multiple of the input frame (upsampling)
+};
+
+class VoicePipeline : private PipelineContext {
+public:
+    VoicePipeline() = default;
+
+    VoicePipeline(const VoicePipeline&) = delete;
+    VoicePipeline& operator=(const VoicePipeline&) = delete;
+
+    /** Create and configure the stages in `spec`; false with a message on any error. */
+    bool build(const std::string& spec, const StageRegistry& registry,
+               const PipelineOptions& options, std::string* error);
+
+    /** Add an already-constructed stage at the end (engines built by the caller). */
+    bool append(const std::string& name, std::unique_ptr<Stage> stage, std::string* error);
+
+    /** Feed input PCM of any length; returns false once the pipeline has stopped. */
+    bool push(const int16_t* pcm, size_t n);
+
+    /** Drain a source through the pipeline until it ends or a stage stops it; then finish(). */
+    void run(Source& source);
+
+    /** Process the partial frame and let every stage flush (engines report results). */
+    void finish();
+
+    void reset();
+
+    /** Forwarded to every stage (see Stage::on_decoder_endpoint). */
+    void notify_decoder_endpoint();
+
+    bool stopped() const { return stopped_; }
+    bool finished() const { return finished_; }
+
+    /** Move queued events into `out`; returns how many. */
+    size_t poll_events(std::vector<PipelineEvent>& out);
+
+    /** Output buffered by the last stage (see Stage::read_output). */
+    size_t read_output(int16_t* out, size_t max_samples);
+
+    const std::vector<StageStats>& stats() const { return stats_; }
+    /** Frames that could not be taken from the pool (input was dropped). */
+    uint64_t pool_misses() const { return pool_misses_; }
+    int32_t input_rate() const { return options_.sample_rate; }
+    int32_t output_rate() const { return output_rate_; }
+    size_t frame_samples() const { return frame_samples_; }
+    size_t stage_count() const { return stages_.size(); }
+
+    /** One line per stage: frames, mean and max time per frame. */
+    std::string format_stats() const;
+
+private:
+    void emit(const PipelineEvent& event) override { events_.push_back(event); }
+    void request_stop() override { stop_requested_ = true; }
+    void run_frame(AudioFrame* frame);
+
+    PipelineOptions options_;
+    std::unique_ptr<FramePool> pool_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::vector<StageStats> stats_;
+    std::vector<PipelineEvent> events_;
+    AudioFrame* pending_ = nullptr;     // partially filled input frame
+    size_t frame_samples_ = 0;
+    int32_t output_rate_ = 0;
+    int64_t position_ = 0;
+    uint64_t pool_misses_ = 0;
+    bool stop_requested_ = false;
+    bool stopped_ = false;
+    bool finished_ = false;
+};
+
+} // namespace assistant
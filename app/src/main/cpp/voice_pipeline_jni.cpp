@@ -0,0 +1,155 @@
+/**
+ * voice_pipeline_jni.cpp - JNI bridge for the declarative capture pipeline
+ *
+ * Capture chunks arrive as little-endian 16-bit PCM byte arrays. Events are
+ * returned flattened into an IntArray, four ints per event:
+ * type, reason, detection delay (ms), input position (ms).
+ */
+
+#define LOG_TAG "VoicePipelineJNI"
+
+#include <jni.h>
+
+#include <string>
+#include <vector>
+
+#include "native_log.h"
+#include "voice_pipeline.h"
+
+using assistant::PipelineEvent;
+using assistant::PipelineOptions;
+using assistant::StageRegistry;
+using assistant::VoicePipeline;
+
+namespace {
+    constexpr int kEventInts = 4;
+
+    VoicePipeline* from_handle(jlong handle) {
+        return reinterpret_cast<VoicePipeline*>(handle);
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeCreate(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jstring spec,
+        jint sampleRate,
+        jint frameMs) {
+    const char* chars = env->GetStringUTFChars(spec, nullptr);
+    if (chars == nullptr) return 0;
+    const std::string text(chars);
+    env->ReleaseStringUTFChars(spec, chars);
+
+    PipelineOptions options;
+    options.sample_rate = sampleRate;
+    options.frame_ms = frameMs;
+    auto* pipeline = new VoicePipeline();
+    std::string error;
+    if (!pipeline->build(text, StageRegistry::with_builtins(), options, &error)) {
+        LOGE("Invalid pipeline \"%s\": %s", text.c_str(), error.c_str());
+        delete pipeline;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(pipeline);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativePush(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jbyteArray pcm,
+        jint length) {
+    VoicePipeline* pipeline = from_handle(handle);
+    if (pipeline == nullptr) return JNI_FALSE;
+    if (length < 2) return pipeline->stopped() ? JNI_FALSE : JNI_TRUE;
+
+    auto* bytes = static_cast<jbyte*>(env->GetPrimitiveArrayCritical(pcm, nullptr));
+    if (bytes == nullptr) return JNI_FALSE;
+    const bool running = pipeline->push(reinterpret_cast<const int16_t*>(bytes),
+                                        static_cast<size_t>(length) / 2);
+    env->ReleasePrimitiveArrayCritical(pcm, bytes, JNI_ABORT);
+    return running ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeRead(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jbyteArray out) {
+    VoicePipeline* pipeline = from_handle(handle);
+    if (pipeline == nullptr) return 0;
+
+    const jsize capacity = env->GetArrayLength(out) / 2;
+    auto* bytes = static_cast<jbyte*>(env->GetPrimitiveArrayCritical(out, nullptr));
+    if (bytes == nullptr) return 0;
+    const size_t n = pipeline->read_output(reinterpret_cast<int16_t*>(bytes), static_cast<size_t>(capacity));
+    env->ReleasePrimitiveArrayCritical(out, bytes, 0);
+    return static_cast<jint>(n * 2);
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativePollEvents(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    VoicePipeline* pipeline = from_handle(handle);
+    std::vector<PipelineEvent> events;
+    if (pipeline != nullptr) pipeline->poll_events(events);
+
+    std::vector<jint> flat;
+    flat.reserve(events.size() * kEventInts);
+    const int64_t rate = pipeline != nullptr ? pipeline->input_rate() : 1;
+    for (const PipelineEvent& event : events) {
+        flat.push_back(event.type);
+        flat.push_back(event.reason);
+        flat.push_back(event.delay_ms);
+        flat.push_back(static_cast<jint>(event.position * 1000 / rate));
+    }
+    jintArray result = env->NewIntArray(static_cast<jsize>(flat.size()));
+    if (result != nullptr && !flat.empty()) {
+        env->SetIntArrayRegion(result, 0, static_cast<jsize>(flat.size()), flat.data());
+    }
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeNotifyDecoderEndpoint(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    VoicePipeline* pipeline = from_handle(handle);
+    if (pipeline != nullptr) pipeline->notify_decoder_endpoint();
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeFinish(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    VoicePipeline* pipeline = from_handle(handle);
+    if (pipeline != nullptr) pipeline->finish();
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeGetStats(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    VoicePipeline* pipeline = from_handle(handle);
+    return env->NewStringUTF(pipeline != nullptr ? pipeline->format_stats().c_str() : "");
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_VoicePipeline_nativeDestroy(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    delete from_handle(handle);
+}
+
+} // extern "C"
@@ -0,0 +1,438 @@
+/**
+ * wake_word.cpp - Always-on keyword spotting
+ */
+
+#define LOG_TAG "WakeWord"
+
+#include "wake_word.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "int8_kernels.h"
+#include "native_log.h"
+
+namespace assistant {
+
+namespace {
+    constexpr uint32_t kVersion = 1;
+
+    struct Reader {
+        const uint8_t* p;
+        size_t left;
+        bool ok = true;
+
+        bool take(void* dst, size_t n) {
+            if (!ok || left < n) { ok = false; return false; }
+            memcpy(dst, p, n);
+            p += n;
+            left -= n;
+            return true;
+        }
+        uint32_t u32() { uint32_t v = 0; take(&v, 4); return v; }
+        int32_t i32() { return static_cast<int32_t>(u32()); }
+        float f32() { float v = 0; take(&v, 4); return v; }
+    };
+
+    struct Writer {
+        std::vector<uint8_t>& out;
+        void put(const void* src, size_t n) {
+            const uint8_t* b = static_cast<const uint8_t*>(src);
+            out.insert(out.end(), b, b + n);
+        }
+        void u32(uint32_t v) { put(&v, 4); }
+        void f32(float v) { put(&v, 4); }
+    };
+
+    constexpr uint32_t kMaxElements = 1u << 24;
+
+    /** Scales divide and multiply every activation; zero, negative or NaN ones poison the network. */
+    bool valid_scale(float scale) { return std::isfinite(scale) && scale > 0.0f; }
+}
+
+bool KwsModel::parse(const uint8_t* data, size_t size) {
+    Reader r{data, size};
+    char magic[4];
+    if (!r.take(magic, 4) || memcmp(magic, "KWS1", 4) != 0) {
+        LOGE("Not a KWS1 model");
+        return false;
+    }
+    if (r.u32() != kVersion) {
+        LOGE("Unsupported KWS model version");
+        return false;
+    }
+
+    input_frames = r.i32();
+    input_dim = r.i32();
+    n_classes = r.i32();
+    keyword_class = r.i32();
+    input_scale = r.f32();
+    features.sample_rate = r.i32();
+    features.frame_ms = r.i32();
+    features.hop_ms = r.i32();
+    features.n_mels = r.i32();
+    features.n_mfcc = r.i32();
+    features.fmin = r.f32();
+    features.fmax = r.f32();
+
+    const uint32_t n_layers = r.u32();
+    if (!r.ok || n_layers == 0 || n_layers > 64) return false;
+
+    layers.assign(n_layers, KwsLayer{});
+    for (KwsLayer& layer : layers) {
+        layer.type = r.u32();
+        layer.out_c = r.i32();
+        layer.kernel_h = r.i32();
+        layer.kernel_w = r.i32();
+        layer.stride_h = r.i32();
+        layer.stride_w = r.i32();
+        layer.pad_h = r.i32();
+        layer.pad_w = r.i32();
+        layer.relu = r.u32() != 0;
+        layer.weight_scale = r.f32();
+        layer.out_scale = r.f32();
+
+        const uint32_t n_weights = r.u32();
+        if (!r.ok || n_weights > kMaxElements) return false;
+        layer.weights.resize(n_weights);
+        r.take(layer.weights.data(), n_weights);
+        uint8_t pad[4];
+        r.take(pad, (4 - n_weights % 4) % 4);
+
+        const uint32_t n_bias = r.u32();
+        if (!r.ok || n_bias > kMaxElements) return false;
+        layer.bias.resize(n_bias);
+        r.take(layer.bias.data(), n_bias * sizeof(int32_t));
+    }
+
+    if (!r.ok) {
+        LOGE("Truncated KWS model");
+        return false;
+    }
+    bool scales_ok = valid_scale(input_scale);
+    for (const KwsLayer& layer : layers) {
+        scales_ok = scales_ok && valid_scale(layer.weight_scale) && valid_scale(layer.out_scale);
+    }
+    if (!scales_ok) {
+        LOGE("KWS model has an invalid quantization scale");
+        return false;
+    }
+    return true;
+}
+
+bool KwsModel::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LOGE("Failed to open KWS model: %s", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buf[8192];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    fclose(file);
+    return parse(bytes.data(), bytes.size());
+}
+
+std::vector<uint8_t> KwsModel::serialize() const {
+    std::vector<uint8_t> out;
+    Writer w{out};
+    w.put("KWS1", 4);
+    w.u32(kVersion);
+    w.u32(input_frames);
+    w.u32(input_dim);
+    w.u32(n_classes);
+    w.u32(keyword_class);
+    w.f32(input_scale);
+    w.u32(features.sample_rate);
+    w.u32(features.frame_ms);
+    w.u32(features.hop_ms);
+    w.u32(features.n_mels);
+    w.u32(features.n_mfcc);
+    w.f32(features.fmin);
+    w.f32(features.fmax);
+    w.u32(static_cast<uint32_t>(layers.size()));
+    for (const KwsLayer& layer : layers) {
+        w.u32(layer.type);
+        w.u32(layer.out_c);
+        w.u32(layer.kernel_h);
+        w.u32(layer.kernel_w);
+        w.u32(layer.stride_h);
+        w.u32(layer.stride_w);
+        w.u32(layer.pad_h);
+        w.u32(layer.pad_w);
+        w.u32(layer.relu ? 1 : 0);
+        w.f32(layer.weight_scale);
+        w.f32(layer.out_scale);
+        w.u32(static_cast<uint32_t>(layer.weights.size()));
+        w.put(layer.weights.data(), layer.weights.size());
+        const uint8_t zeros[4] = {0, 0, 0, 0};
+        w.put(zeros, (4 - layer.weights.size() % 4) % 4);
+        w.u32(static_cast<uint32_t>(layer.bias.size()));
+        w.put(layer.bias.data(), layer.bias.size() * sizeof(int32_t));
+    }
+    return out;
+}
+
+bool KwsNetwork::init(const KwsModel& model) {
+    model_ = nullptr;
+    shapes_.clear();
+    in_scales_.clear();
+    macs_ = 0;
+
+    if (model.layers.empty() || model.layers.back().type != KWS_LAYER_FC ||
+        model.layers.back().out_c != model.n_classes || model.n_classes < 2 ||
+        model.keyword_class < 0 || model.keyword_class >= model.n_classes) {
+        LOGE("KWS model must end in a fully connected layer with n_classes outputs");
+        return false;
+    }
+
+    Shape shape{model.input_frames, model.input_dim, 1};
+    float scale = model.input_scale;
+    size_t max_activation = static_cast<size_t>(shape.h) * shape.w * shape.c;
+    size_t max_patch = 0;
+    size_t max_acc = static_cast<size_t>(model.n_classes);
+
+    for (size_t i = 0; i < model.layers.size(); ++i) {
+        const KwsLayer& l = model.layers[i];
+        shapes_.push_back(shape);
+        in_scales_.push_back(scale);
+
+        Shape out = shape;
+        size_t expected_weights = 0;
+        switch (l.type) {
+            case KWS_LAYER_CONV:
+            case KWS_LAYER_DEPTHWISE: {
+                if (l.kernel_h < 1 || l.kernel_w < 1 || l.stride_h < 1 || l.stride_w < 1) return false;
+                out.h = (shape.h + 2 * l.pad_h - l.kernel_h) / l.stride_h + 1;
+                out.w = (shape.w + 2 * l.pad_w - l.kernel_w) / l.stride_w + 1;
+                if (l.type == KWS_LAYER_CONV) {
+                    out.c = l.out_c;
+                    expected_weights = static_cast<size_t>(l.out_c) * l.kernel_h * l.kernel_w * shape.c;
+                    max_patch = std::max(max_patch, static_cast<size_t>(l.kernel_h) * l.kernel_w * shape.c);
+                    macs_ += static_cast<uint64_t>(out.h) * out.w * expected_weights;
+                } else {
+                    if (l.out_c != shape.c) return false;
+                    expected_weights = static_cast<size_t>(l.kernel_h) * l.kernel_w * shape.c;
+                    macs_ += static_cast<uint64_t>(out.h) * out.w * expected_weights;
+                }
+                break;
+            }
+            case KWS_LAYER_POINTWISE:
+                out.c = l.out_c;
+                expected_weights = static_cast<size_t>(l.out_c) * shape.c;
+                macs_ += static_cast<uint64_t>(shape.h) * shape.w * expected_weights;
+                break;
+            case KWS_LAYER_AVGPOOL:
+                out = Shape{1, 1, shape.c};
+                break;
+            case KWS_LAYER_FC:
+                out = Shape{1, 1, l.out_c};
+                expected_weights = static_cast<size_t>(l.out_c) * shape.h * shape.w * shape.c;
+                macs_ += expected_weights;
+                break;
+            default:
+                LOGE("Unknown KWS layer type %u", l.type);
+                return false;
+        }
+
+        if (out.h < 1 || out.w < 1 || out.c < 1 || l.weights.size() != expected_weights ||
+            (!l.bias.empty() && l.bias.size() != static_cast<size_t>(out.c))) {
+            LOGE("KWS layer %zu has inconsistent shape or weights", i);
+            return false;
+        }
+
+        if (l.type != KWS_LAYER_AVGPOOL) scale = l.out_scale;
+        max_activation = std::max(max_activation, static_cast<size_t>(out.h) * out.w * out.c);
+        max_acc = std::max(max_acc, static_cast<size_t>(shape.c));
+        shape = out;
+    }
+    shapes_.push_back(shape);
+
+    ping_.assign(max_activation, 0);
+    pong_.assign(max_activation, 0);
+    patch_.assign(std::max<size_t>(max_patch, 1), 0);
+    acc_.assign(max_acc, 0);
+    probs_.assign(model.n_classes, 0.0f);
+    model_ = &model;
+    return true;
+}
+
+const float* KwsNetwork::infer(const int8_t* input) {
+    const int8_t* cur = input;
+    int8_t* bufs[2] = {ping_.data(), pong_.data()};
+    int which = 0;
+
+    for (size_t i = 0; i < model_->layers.size(); ++i) {
+        const KwsLayer& l = model_->layers[i];
+        const Shape& in = shapes_[i];
+        const Shape& out = shapes_[i + 1];
+        const float in_scale = in_scales_[i];
+        const float rq = in_scale * l.weight_scale / l.out_scale;
+        const int32_t* bias = l.bias.empty() ? nullptr : l.bias.data();
+        int8_t* dst = bufs[which];
+
+        int8::ConvShape cs{in.h, in.w, in.c, out.h, out.w, out.c,
+                           l.kernel_h, l.kernel_w, l.stride_h, l.stride_w, l.pad_h, l.pad_w};
+
+        switch (l.type) {
+            case KWS_LAYER_CONV:
+                int8::conv2d(cur, cs, l.weights.data(), bias, rq, l.relu, dst, patch_.data());
+                break;
+            case KWS_LAYER_DEPTHWISE:
+                int8::depthwise_conv2d(cur, cs, l.weights.data(), bias, rq, l.relu, dst, acc_.data());
+                break;
+            case KWS_LAYER_POINTWISE:
+                for (int32_t p = 0; p < in.h * in.w; ++p) {
+                    int8::fully_connected(cur + static_cast<size_t>(p) * in.c, in.c, l.weights.data(),
+                                          bias, out.c, rq, l.relu, dst + static_cast<size_t>(p) * out.c);
+                }
+                break;
+            case KWS_LAYER_AVGPOOL:
+                int8::global_average_pool(cur, in.h, in.w, in.c, dst, acc_.data());
+                break;
+            case KWS_LAYER_FC: {
+                const int32_t k = in.h * in.w * in.c;
+                if (i + 1 == model_->layers.size()) {
+                    int8::fully_connected_acc(cur, k, l.weights.data(), bias, out.c, acc_.data());
+                    const float deq = in_scale * l.weight_scale;
+                    float max_logit = -1e30f;
+                    for (int32_t c = 0; c < out.c; ++c) {
+                        probs_[c] = static_cast<float>(acc_[c]) * deq;
+                        max_logit = std::max(max_logit, probs_[c]);
+                    }
+                    float sum = 0.0f;
+                    for (int32_t c = 0; c < out.c; ++c) {
+                        probs_[c] = std::exp(probs_[c] - max_logit);
+                        sum += probs_[c];
+                    }
+                    for (int32_t c = 0; c < out.c; ++c) probs_[c] /= sum;
+                    return probs_.data();
+                }
+                int8::fully_connected(cur, k, l.weights.data(), bias, out.c, rq, l.relu, dst);
+                break;
+            }
+        }
+
+        cur = dst;
+        which ^= 1;
+    }
+    return probs_.data();
+}
+
+bool WakeWordDetector::init(KwsModel model, const WakeWordConfig& config) {
+    model_ = std::move(model);
+    config_ = config;
+
+    FeatureFrontend probe(model_.features);
+    if (model_.input_dim != probe.feature_dim() || model_.input_frames < 1 ||
+        model_.features.sample_rate <= 0) {
+        LOGE("KWS model input (%d x %d) does not match its feature config",
+             model_.input_frames, model_.input_dim);
+        return false;
+    }
+    if (!network_.init(model_)) return false;
+
+    frontend_.reset(new FeatureFrontend(model_.features));
+    window_.assign(static_cast<size_t>(model_.input_frames) * model_.input_dim, 0);
+    input_.assign(window_.size(), 0);
+    energy_.assign(model_.input_frames, -100.0f);
+    posteriors_.assign(std::max(1, config_.smoothing), 0.0f);
+    preroll_.reset(static_cast<size_t>(model_.features.sample_rate) * config_.preroll_ms / 1000);
+    reset();
+
+    LOGI("Wake word ready: %d x %d input, %llu MACs/inference, kernels=%s",
+         model_.input_frames, model_.input_dim,
+         static_cast<unsigned long long>(network_.macs_per_inference()), int8::kernel_name());
+    return true;
+}
+
+void WakeWordDetector::reset() {
+    if (frontend_) frontend_->reset();
+    std::fill(window_.begin(), window_.end(), 0);
+    std::fill(energy_.begin(), energy_.end(), -100.0f);
+    std::fill(posteriors_.begin(), posteriors_.end(), 0.0f);
+    window_pos_ = 0;
+    window_filled_ = 0;
+    hops_since_inference_ = 0;
+    posterior_pos_ = 0;
+    smoothed_ = 0.0f;
+    refractory_until_ = 0;
+    pending_detections_ = 0;
+    preroll_.clear();
+    last_ = WakeWordDetection{};
+    stats_ = WakeWordStats{};
+}
+
+int32_t WakeWordDetector::process(const int16_t* pcm, size_t n) {
+    pending_detections_ = 0;
+    preroll_.write(pcm, n);
+    frontend_->push(pcm, n, [this](const float* features, float energy_db) {
+        on_frame(features, energy_db);
+    });
+    stats_.samples += n;
+    return pending_detections_;
+}
+
+void WakeWordDetector::on_frame(const float* features, float energy_db) {
+    const int32_t dim = model_.input_dim;
+    const float inv_scale = 1.0f / model_.input_scale;
+    int8_t* slot = window_.data() + static_cast<size_t>(window_pos_) * dim;
+    for (int32_t i = 0; i < dim; ++i) {
+        const long q = std::lrintf(features[i] * inv_scale);
+        slot[i] = static_cast<int8_t>(std::min(127L, std::max(-127L, q)));
+    }
+    energy_[window_pos_] = energy_db;
+    window_pos_ = (window_pos_ + 1) % model_.input_frames;
+    window_filled_ = std::min(model_.input_frames, window_filled_ + 1);
+    stats_.frames++;
+
+    if (window_filled_ < model_.input_frames) return;
+    if (++hops_since_inference_ < std::max(1, config_.inference_stride)) return;
+    hops_since_inference_ = 0;
+
+    float posterior = 0.0f;
+    const float loudest = *std::max_element(energy_.begin(), energy_.end());
+    if (loudest < config_.gate_db) {
+        stats_.gated++;
+    } else {
+        // Oldest frame first
+        const size_t head = static_cast<size_t>(window_pos_) * dim;
+        std::copy(window_.begin() + head, window_.end(), input_.begin());
+        std::copy(window_.begin(), window_.begin() + head, input_.begin() + (window_.size() - head));
+
+        const auto start = std::chrono::steady_clock::now();
+        const float* probs = network_.infer(input_.data());
+        stats_.inference_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        stats_.inferences++;
+        posterior = probs[model_.keyword_class];
+    }
+
+    posteriors_[posterior_pos_] = posterior;
+    posterior_pos_ = (posterior_pos_ + 1) % static_cast<int32_t>(posteriors_.size());
+    float sum = 0.0f;
+    for (float p : posteriors_) sum += p;
+    smoothed_ = sum / static_cast<float>(posteriors_.size());
+
+    const int64_t position = static_cast<int64_t>(stats_.frames) * frontend_->hop_samples() +
+                             (frontend_->frame_samples() - frontend_->hop_samples());
+    if (smoothed_ >= config_.threshold && position >= refractory_until_) {
+        last_.sample_index = position;
+        last_.score = smoothed_;
+        refractory_until_ = position +
+            static_cast<int64_t>(model_.features.sample_rate) * config_.refractory_ms / 1000;
+        pending_detections_++;
+        stats_.detections++;
+        LOGI("Wake word detected at %lld (score %.2f)", static_cast<long long>(position), smoothed_);
+    }
+}
+
+size_t WakeWordDetector::copy_preroll(int16_t* out, size_t max_samples) const {
+    return preroll_.copy_latest(out, max_samples);
+}
+
+} // namespace assistant
@@ -0,0 +1,169 @@
+/**
+ * wake_word.h - Always-on keyword spotting
+ *
+ * A small int8 DS-CNN style network (conv, depthwise, pointwise, global
+ * average pool, fully connected) runs over a sliding window of MFCC or
+ * log-mel frames. The detector smooths the keyword posterior, applies a
+ * refractory period and keeps a pre-roll ring of raw PCM so the assistant
+ * can start recognition from audio captured before the trigger fired.
+ *
+ * Model file format ("KWS1", little endian):
+ *   magic[4] "KWS1", u32 version (1)
+ *   u32 input_frames, u32 input_dim, u32 n_classes, u32 keyword_class
+ *   f32 input_scale
+ *   u32 sample_rate, u32 frame_ms, u32 hop_ms, u32 n_mels, u32 n_mfcc
+ *   f32 fmin, f32 fmax
+ *   u32 n_layers, then per layer:
+ *     u32 type, out_c, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w, relu
+ *     f32 weight_scale, f32 out_scale
+ *     u32 n_weights, i8 weights[n_weights] (zero-padded to 4 bytes)
+ *     u32 n_bias, i32 bias[n_bias]
+ * The last layer must be KWS_LAYER_FC; its outputs are float logits.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio_features.h"
+#include "ring_buffer.h"
+
+namespace assistant {
+
+enum KwsLayerType : uint32_t {
+    KWS_LAYER_CONV = 1,
+    KWS_LAYER_DEPTHWISE = 2,
+    KWS_LAYER_POINTWISE = 3,
+    KWS_LAYER_AVGPOOL = 4,
+    KWS_LAYER_FC = 5,
+};
+
+struct KwsLayer {
+    uint32_t type = KWS_LAYER_CONV;
+    int32_t out_c = 0;
+    int32_t kernel_h = 1, kernel_w = 1;
+    int32_t stride_h = 1, stride_w = 1;
+    int32_t pad_h = 0, pad_w = 0;
+    bool relu = true;
+    float weight_scale = 1.0f;
+    float out_scale = 1.0f;
+    std::vector<int8_t> weights;
+    std::vector<int32_t> bias;
+};
+
+struct KwsModel {
+    int32_t input_frames = 0;
+    int32_t input_dim = 0;
+    int32_t n_classes = 0;
+    int32_t keyword_class = 1;
+    float input_scale = 1.0f;
+    FeatureConfig features;
+    std::vector<KwsLayer> layers;
+
+    bool parse(const uint8_t* data, size_t size);
+    bool load(const std::string& path);
+    std::vector<uint8_t> serialize() const;
+};
+
+/** Executes a KwsModel with preallocated activation buffers. */
+class KwsNetwork {
+public:
+    bool init(const KwsModel& model);
+
+    /** Run one window (input_frames x input_dim int8); returns class probabilities. */
+    const float* infer(const int8_t* input);
+
+    int32_t n_classes() const { return model_ != nullptr ? model_->n_classes : 0; }
+    uint64_t macs_per_inference() const { return macs_; }
+
+private:
+    struct Shape { int32_t h, w, c; };
+
+    const KwsModel* model_ = nullptr;
+    std::vector<Shape> shapes_;       // input shape of each layer, plus the output
+    std::vector<float> in_scales_;
+    std::vector<int8_t> ping_, pong_;
+    std::vector<int8_t> patch_;
+    std::vector<int32_t> acc_;
+    std::vector<float> probs_;
+    uint64_t macs_ = 0;
+};
+
+struct WakeWordConfig {
+    float threshold = 0.85f;
+    int32_t smoothing = 3;          // moving average over this many inferences
+    int32_t inference_stride = 2;   // run the network every N feature hops
+    int32_t refractory_ms = 1500;
+    int32_t preroll_ms = 1500;
+    float gate_db = -65.0f;         // skip inference while the whole window is quieter
+};
+
+struct WakeWordDetection {
+    int64_t sample_index = 0;       // stream position where the trigger fired
+    float score = 0.0f;
+};
+
+struct WakeWordStats {
+    uint64_t samples = 0;
+    uint64_t frames = 0;
+    uint64_t inferences = 0;
+    uint64_t gated = 0;
+    uint64_t detections = 0;
+    uint64_t inference_ns = 0;
+};
+
+class WakeWordDetector {
+public:
+    WakeWordDetector() = default;
+    WakeWordDetector(const WakeWordDetector&) = delete;
+    WakeWordDetector& operator=(const WakeWordDetector&) = delete;
+
+    /** Takes ownership of the model; returns false if it is malformed. */
+    bool init(KwsModel model, const WakeWordConfig& config);
+
+    /** Feed 16-bit PCM at the model's sample rate; returns detections in this chunk. */
+    int32_t process(const int16_t* pcm, size_t n);
+
+    const WakeWordDetection& last_detection() const { return last_; }
+    float last_score() const { return smoothed_; }
+    const WakeWordStats& stats() const { return stats_; }
+    int32_t sample_rate() const { return model_.features.sample_rate; }
+    uint64_t macs_per_inference() const { return network_.macs_per_inference(); }
+
+    /** Copy the most recent pre-roll audio (oldest first); returns the sample count. */
+    size_t copy_preroll(int16_t* out, size_t max_samples) const;
+    size_t preroll_capacity() const { return preroll_.capacity(); }
+
+    void reset();
+
+private:
+    void on_frame(const float* features, float energy_db);
+
+    KwsModel model_;
+    WakeWordConfig config_;
+    KwsNetwork network_;
+    std::unique_ptr<FeatureFrontend> frontend_;
+
+    std::vector<int8_t> window_;      // input_frames x input_dim, ring by frame
+    std::vector<float> energy_;       // per-frame energy ring
+    std::vector<int8_t> input_;       // linearized window
+    int32_t window_pos_ = 0;
+    int32_t window_filled_ = 0;
+    int32_t hops_since_inference_ = 0;
+
+    std::vector<float> posteriors_;
+    int32_t posterior_pos_ = 0;
+    float smoothed_ = 0.0f;
+    int64_t refractory_until_ = 0;
+    int32_t pending_detections_ = 0;
+
+    RingBuffer<int16_t> preroll_;
+    WakeWordDetection last_;
+    WakeWordStats stats_;
+};
+
+} // namespace assistant
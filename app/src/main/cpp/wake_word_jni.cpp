@@ -0,0 +1,129 @@
+/**
+ * wake_word_jni.cpp - JNI bridge for the always-on wake word detector
+ *
+ * Each handle owns one WakeWordDetector. Calls for a handle must come from
+ * a single thread (the capture loop in WakeWordService).
+ */
+
+#define LOG_TAG "WakeWordJNI"
+
+#include <jni.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "native_log.h"
+#include "wake_word.h"
+
+using assistant::KwsModel;
+using assistant::WakeWordConfig;
+using assistant::WakeWordDetector;
+
+namespace {
+    WakeWordDetector* from_handle(jlong handle) {
+        return reinterpret_cast<WakeWordDetector*>(handle);
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeCreate(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jstring modelPath,
+        jfloat threshold,
+        jint prerollMs) {
+    const char* path = env->GetStringUTFChars(modelPath, nullptr);
+    KwsModel model;
+    const bool loaded = model.load(path);
+    env->ReleaseStringUTFChars(modelPath, path);
+    if (!loaded) return 0;
+
+    WakeWordConfig config;
+    config.threshold = threshold;
+    config.preroll_ms = prerollMs;
+
+    auto* detector = new WakeWordDetector();
+    if (!detector->init(std::move(model), config)) {
+        delete detector;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(detector);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeProcess(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle,
+        jshortArray pcm,
+        jint length) {
+    WakeWordDetector* detector = from_handle(handle);
+    if (detector == nullptr || pcm == nullptr) return JNI_FALSE;
+    // A length past the array would read beyond the pinned samples
+    length = std::min(length, env->GetArrayLength(pcm));
+    if (length <= 0) return JNI_FALSE;
+
+    // Critical access avoids a copy per 20 ms chunk; process() never calls back into Java
+    auto* samples = static_cast<int16_t*>(env->GetPrimitiveArrayCritical(pcm, nullptr));
+    if (samples == nullptr) return JNI_FALSE;
+    const int32_t detections = detector->process(samples, static_cast<size_t>(length));
+    env->ReleasePrimitiveArrayCritical(pcm, samples, JNI_ABORT);
+    return detections > 0 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jshortArray JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeGetPreroll(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    WakeWordDetector* detector = from_handle(handle);
+    if (detector == nullptr) return env->NewShortArray(0);
+
+    std::vector<int16_t> preroll(detector->preroll_capacity());
+    const size_t n = detector->copy_preroll(preroll.data(), preroll.size());
+    jshortArray result = env->NewShortArray(static_cast<jsize>(n));
+    if (result != nullptr && n > 0) {
+        env->SetShortArrayRegion(result, 0, static_cast<jsize>(n), preroll.data());
+    }
+    return result;
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeGetLastScore(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    WakeWordDetector* detector = from_handle(handle);
+    return detector != nullptr ? detector->last_score() : 0.0f;
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeReset(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    WakeWordDetector* detector = from_handle(handle);
+    if (detector != nullptr) detector->reset();
+}
+
+JNIEXPORT void JNICALL
+Java_com_satory_graphenosai_audio_WakeWordEngine_nativeDestroy(
+        JNIEnv* env,
+        jclass /* clazz */,
+        jlong handle) {
+    WakeWordDetector* detector = from_handle(handle);
+    if (detector != nullptr) {
+        const auto& stats = detector->stats();
+        LOGI("Wake word stats: %llu inferences, %llu gated, %llu detections",
+             static_cast<unsigned long long>(stats.inferences),
+             static_cast<unsigned long long>(stats.gated),
+             static_cast<unsigned long long>(stats.detections));
+    }
+    delete detector;
+}
+
+} // extern "C"
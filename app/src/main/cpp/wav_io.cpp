@@ -0,0 +1,234 @@
+/**
+ * wav_io.cpp - Minimal RIFF/WAVE reader and writer
+ */
+
+#include "wav_io.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace assistant {
+
+namespace {
+    uint32_t read_u32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint16_t read_u16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    void put_u32(uint8_t* p, uint32_t v) {
+        p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+    }
+
+    void put_u16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+    }
+}
+
+bool read_wav_header(FILE* file, WavInfo& info) {
+    uint8_t riff[12];
+    if (fread(riff, 1, sizeof(riff), file) != sizeof(riff)) return false;
+    if (memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) return false;
+
+    bool have_fmt = false;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk)) {
+        const uint32_t size = read_u32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), file) != sizeof(fmt)) return false;
+            info.format = read_u16(fmt);
+            info.channels = read_u16(fmt + 2);
+            info.sample_rate = static_cast<int32_t>(read_u32(fmt + 4));
+            info.bits_per_sample = read_u16(fmt + 14);
+            // WAVE_FORMAT_EXTENSIBLE carries the real format in the sub-format GUID
+            if (info.format == 0xFFFE && size >= 26) {
+                uint8_t ext[10];
+                if (fread(ext, 1, sizeof(ext), file) != sizeof(ext)) return false;
+                info.format = read_u16(ext + 8);
+                if (fseek(file, static_cast<long>(size - 26 + (size & 1)), SEEK_CUR) != 0) return false;
+            } else if (fseek(file, static_cast<long>(size - 16 + (size & 1)), SEEK_CUR) != 0) {
+                return false;
+            }
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) return false;
+            info.data_offset = ftell(file);
+            info.data_bytes = size;
+            return true;
+        } else if (fseek(file, static_cast<long>(size + (size & 1)), SEEK_CUR) != 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool read_wav_mono16(const std::string& path, std::vector<int16_t>& out,
+                     int32_t* sample_rate) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+
+    WavInfo info;
+    if (!read_wav_header(file, info) || info.format != 1 || info.bits_per_sample != 16 ||
+        info.channels < 1) {
+        fclose(file);
+        return false;
+    }
+
+    const size_t frames = info.data_bytes / (2u * static_cast<uint32_t>(info.channels));
+    out.resize(frames);
+    if (info.channels == 1) {
+        out.resize(fread(out.data(), sizeof(int16_t), frames, file));
+    } else {
+        std::vector<int16_t> frame(info.channels);
+        size_t n = 0;
+        for (; n < frames; ++n) {
+            if (fread(frame.data(), sizeof(int16_t), frame.size(), file) != frame.size()) break;
+            int32_t sum = 0;
+            for (int16_t s : frame) sum += s;
+            out[n] = static_cast<int16_t>(sum / info.channels);
+        }
+        out.resize(n);
+    }
+
+    fclose(file);
+    if (sample_rate != nullptr) *sample_rate = info.sample_rate;
+    return true;
+}
+
+namespace {
+    /** Same chunk walk as read_wav_header, over a descriptor; accepts 16-bit PCM only. */
+    bool read_pcm16_header(int fd, WavInfo& info) {
+        bool have_fmt = false;
+        bool have_data = false;
+        uint8_t riff[12];
+        off_t pos = 12;
+        if (pread(fd, riff, sizeof(riff), 0) == static_cast<ssize_t>(sizeof(riff)) &&
+            memcmp(riff, "RIFF", 4) == 0 && memcmp(riff + 8, "WAVE", 4) == 0) {
+            uint8_t chunk[8];
+            while (!have_data && pread(fd, chunk, sizeof(chunk), pos) == static_cast<ssize_t>(sizeof(chunk))) {
+                const uint32_t size = read_u32(chunk + 4);
+                pos += sizeof(chunk);
+                if (memcmp(chunk, "fmt ", 4) == 0) {
+                    uint8_t fmt[26] = {};
+                    const size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+                    if (size < 16 || pread(fd, fmt, want, pos) != static_cast<ssize_t>(want)) break;
+                    info.format = read_u16(fmt);
+                    info.channels = read_u16(fmt + 2);
+                    info.sample_rate = static_cast<int32_t>(read_u32(fmt + 4));
+                    info.bits_per_sample = read_u16(fmt + 14);
+                    if (info.format == 0xFFFE && size >= 26) info.format = read_u16(fmt + 24);
+                    have_fmt = true;
+                } else if (memcmp(chunk, "data", 4) == 0) {
+                    info.data_offset = static_cast<long>(pos);
+                    info.data_bytes = size;
+                    have_data = have_fmt;
+                    if (!have_fmt) break;
+                    continue;
+                }
+                pos += size + (size & 1);
+            }
+        }
+        return have_data && info.format == 1 && info.bits_per_sample == 16 && info.channels >= 1;
+    }
+
+    /** Frames [first, first + n) downmixed to mono floats; returns the count read. */
+    size_t read_pcm16_frames(int fd, const WavInfo& info, size_t first, size_t n, float* out) {
+        const size_t channels = static_cast<size_t>(info.channels);
+        const size_t total = info.data_bytes / (2u * channels);
+        if (first >= total) return 0;
+        n = std::min(n, total - first);
+
+        int16_t buffer[4096];
+        const size_t frames_per_read = sizeof(buffer) / sizeof(buffer[0]) / channels;
+        size_t done = 0;
+        off_t pos = static_cast<off_t>(info.data_offset) + static_cast<off_t>(first * channels * sizeof(int16_t));
+        while (done < n) {
+            const size_t want = std::min(frames_per_read, n - done);
+            const ssize_t got = pread(fd, buffer, want * channels * sizeof(int16_t), pos);
+            if (got <= 0) break;
+            const size_t got_frames = static_cast<size_t>(got) / (channels * sizeof(int16_t));
+            if (got_frames == 0) break;
+            for (size_t f = 0; f < got_frames; ++f) {
+                int32_t sum = 0;
+                for (size_t c = 0; c < channels; ++c) sum += buffer[f * channels + c];
+                out[done + f] = static_cast<float>(sum) / (32768.0f * static_cast<float>(channels));
+            }
+            done += got_frames;
+            pos += static_cast<off_t>(got_frames * channels * sizeof(int16_t));
+        }
+        return done;
+    }
+}
+
+bool read_wav_mono_float(const char* path, Arena& arena, float** out, size_t* n,
+                         int32_t* sample_rate) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    WavInfo info;
+    if (!read_pcm16_header(fd, info)) {
+        close(fd);
+        return false;
+    }
+    const size_t frames = info.data_bytes / (2u * static_cast<size_t>(info.channels));
+    float* samples = arena.alloc<float>(frames);
+    const size_t done = read_pcm16_frames(fd, info, 0, frames, samples);
+    close(fd);
+
+    *out = samples;
+    *n = done;
+    if (sample_rate != nullptr) *sample_rate = info.sample_rate;
+    return true;
+}
+
+bool read_wav_info(const char* path, WavInfo& info) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = read_pcm16_header(fd, info);
+    close(fd);
+    return ok;
+}
+
+size_t read_wav_frames_float(const char* path, const WavInfo& info, size_t first, size_t n, float* out) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    const size_t done = read_pcm16_frames(fd, info, first, n, out);
+    close(fd);
+    return done;
+}
+
+bool write_wav_mono16(const std::string& path, const int16_t* pcm, size_t n,
+                      int32_t sample_rate) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    const uint32_t data_bytes = static_cast<uint32_t>(n * sizeof(int16_t));
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + data_bytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, 1);
+    put_u16(header + 22, 1);
+    put_u32(header + 24, static_cast<uint32_t>(sample_rate));
+    put_u32(header + 28, static_cast<uint32_t>(sample_rate) * 2);
+    put_u16(header + 32, 2);
+    put_u16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_bytes);
+
+    const bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+                    fwrite(pcm, sizeof(int16_t), n, file) == n;
+    fclose(file);
+    return ok;
+}
+
+} // namespace assistant
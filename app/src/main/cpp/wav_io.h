@@ -0,0 +1,57 @@
+/**
+ * wav_io.h - Minimal RIFF/WAVE reader and writer
+ *
+ * Walks the chunk list instead of assuming a 44-byte header, so files
+ * with LIST/fact chunks (common from other recorders) load correctly.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+
+namespace assistant {
+
+struct WavInfo {
+    int32_t sample_rate = 0;
+    int32_t channels = 0;
+    int32_t bits_per_sample = 0;
+    int32_t format = 0;         // 1 = PCM, 3 = IEEE float
+    long data_offset = 0;       // byte offset of the first sample
+    uint32_t data_bytes = 0;
+};
+
+/** Parse the header of an open file; leaves the file positioned at the data. */
+bool read_wav_header(FILE* file, WavInfo& info);
+
+/** Load a 16-bit PCM WAV, downmixing to mono. */
+bool read_wav_mono16(const std::string& path, std::vector<int16_t>& out,
+                     int32_t* sample_rate = nullptr);
+
+/**
+ * Load a 16-bit PCM WAV as mono floats in [-1, 1) allocated from `arena`.
+ * Uses plain file descriptors and stack buffers, so a warm arena means no
+ * heap allocation at all.
+ */
+bool read_wav_mono_float(const char* path, Arena& arena, float** out, size_t* n,
+                         int32_t* sample_rate = nullptr);
+
+/** Header of a 16-bit PCM WAV; false for other formats. */
+bool read_wav_info(const char* path, WavInfo& info);
+
+/**
+ * Read up to `n` frames starting at frame `first` of the 16-bit PCM WAV
+ * described by `info`, as mono floats; returns the number read. Lets long
+ * recordings be processed window by window in bounded memory.
+ */
+size_t read_wav_frames_float(const char* path, const WavInfo& info, size_t first, size_t n, float* out);
+
+bool write_wav_mono16(const std::string& path, const int16_t* pcm, size_t n,
+                      int32_t sample_rate);
+
+} // namespace assistant
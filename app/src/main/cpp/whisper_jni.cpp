@@ -5,19 +5,38 @@
  * Runs inference on a background native thread to avoid blocking UI.
  */
 
+#define LOG_TAG "WhisperJNI"
+
 #include <jni.h>
-#include <android/log.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
 #include <string>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <unordered_map>
 
-#include "whisper.h"
+#include <sys/stat.h>
 
-#define LOG_TAG "WhisperJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#include "whisper.h"
+#include "arena.h"
+#include "audio_decoder.h"
+#include "audio_context.h"
+#include "command_grammar.h"
+#include "energy_meter.h"
+#include "inference_governor.h"
+#include "job_scheduler.h"
+#include "lru_cache.h"
+#include "thread_priority.h"
+#include "trace.h"
+#include "transcript_checkpoint.h"
+#include "wav_io.h"
+#include "native_log.h"
 
 namespace {
     // Global model context (loaded once)
@@ -33,10 +52,907 @@ namespace {
         bool print_special = false;
         bool print_progress = false;
         bool no_timestamps = true;
+        bool short_utterance = true;    // size the encoder context to the clip
         std::string language = "en";
     };
     
     whisper_params g_params;
+
+    // Steps threads, encoder context and model down as the device heats up or the battery runs low
+    assistant::InferenceGovernor g_governor;
+    assistant::GovernorDecision g_governed;     // settings of the request in flight
+    std::string g_model_path;
+    std::string g_fallback_model_path;          // smaller model for the governor's tier 1
+    int32_t g_model_tier = 0;
+
+    // Options that only affect decoding; the encoder output is independent of them
+    struct decode_options {
+        std::string language;           // short codes stay in the small-string buffer
+        bool translate = false;
+        float temperature = 0.0f;
+
+        bool same_task(const decode_options& other) const {
+            return language == other.language && translate == other.translate;
+        }
+    };
+
+    struct state_deleter {
+        void operator()(whisper_state* state) const { whisper_free_state(state); }
+    };
+
+    /**
+     * A clip whose encoder output (cross-attention KV) is still held by
+     * `state`, along with the last transcript decoded from it. The text
+     * lives in the clip's own arena, which is reset before each decode.
+     */
+    struct encoded_clip {
+        std::unique_ptr<whisper_state, state_deleter> state;
+        decode_options options;
+        assistant::Arena arena{4096};
+        const char* text = "";
+    };
+
+    // Each state holds its own KV caches and compute buffers (hundreds of MB with the larger
+    // models). The context is loaded without one, and interactive requests, which run one at a
+    // time, share a single state: the cached clip's, or the spare while no clip is cached. With
+    // a file job's, at most two states are ever live.
+    constexpr size_t kEncodedClipCapacity = 1;
+    // whisper_full re-encodes per 30 s window; only single-window clips keep a reusable encoding
+    constexpr size_t kMaxCachedSamples = WHISPER_SAMPLE_RATE * 30;
+
+    assistant::LruCache<uint64_t, encoded_clip> g_encoded(kEncodedClipCapacity);
+    std::unique_ptr<whisper_state, state_deleter> g_spare_state;
+
+    /**
+     * The interactive state for a request that does not keep its encoding
+     * (a multi-window clip, command mode). Drops the cached clip, whose
+     * encoding the state will no longer hold; null if no state can be made.
+     * Hand it back through g_spare_state.
+     */
+    std::unique_ptr<whisper_state, state_deleter> take_interactive_state() {
+        std::unique_ptr<whisper_state, state_deleter> state = std::move(g_spare_state);
+        if (encoded_clip* clip = g_encoded.front()) {
+            if (!state) {
+                state = std::move(clip->state);
+            }
+            g_encoded.clear();
+        }
+        if (!state) {
+            state.reset(whisper_init_state(g_ctx));
+        }
+        return state;
+    }
+
+    // PCM, path and decoder scratch for the request in flight; reset at the start of each
+    assistant::Arena g_request(1 << 20);
+
+    decode_options current_options() {
+        decode_options options;
+        options.language = g_params.language;
+        options.translate = g_params.translate;
+        return options;
+    }
+
+    // The encoder output depends on the context size as well as the audio
+    uint64_t clip_key(const float* pcm, size_t n_samples, int32_t audio_ctx) {
+        const uint64_t hash = assistant::fnv1a64(pcm, n_samples * sizeof(float));
+        return assistant::fnv1a64(&audio_ctx, sizeof(audio_ctx), hash);
+    }
+
+    // 0: full context
+    int32_t request_audio_ctx(size_t n_samples) {
+        return g_params.short_utterance || g_governed.short_utterance
+            ? assistant::compute_audio_ctx(n_samples, WHISPER_SAMPLE_RATE, g_governed.audio_ctx) : 0;
+    }
+
+    /** Modified-UTF-8 copy of `str` in the request arena, without the VM's own copy. */
+    const char* copy_jstring(JNIEnv* env, jstring str) {
+        if (str == nullptr) {
+            return nullptr;
+        }
+        const jsize bytes = env->GetStringUTFLength(str);
+        char* out = g_request.alloc<char>(static_cast<size_t>(bytes) + 1);
+        env->GetStringUTFRegion(str, 0, env->GetStringLength(str), out);
+        out[bytes] = '\0';
+        return out;
+    }
+
+    whisper_full_params full_params(const decode_options& options, int32_t audio_ctx = 0) {
+        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+
+        wparams.print_realtime   = false;
+        wparams.print_progress   = g_params.print_progress;
+        wparams.print_timestamps = !g_params.no_timestamps;
+        wparams.print_special    = g_params.print_special;
+        wparams.translate        = options.translate;
+        wparams.language         = options.language.c_str();
+        wparams.n_threads        = g_governed.n_threads;
+        wparams.offset_ms        = g_params.offset_ms;
+        wparams.duration_ms      = g_params.duration_ms;
+        wparams.audio_ctx        = audio_ctx;
+
+        // Single segment mode for faster processing; without timestamp tokens,
+        // so a first pass and decode_encoded() feed the decoder the same prompt
+        wparams.single_segment   = true;
+        wparams.no_timestamps    = true;
+        return wparams;
+    }
+
+    void collect_text(whisper_state* state, assistant::ArenaText& out) {
+        const int n_segments = whisper_full_n_segments_from_state(state);
+        for (int i = 0; i < n_segments; ++i) {
+            const char* text = whisper_full_get_segment_text_from_state(state, i);
+            if (text != nullptr) {
+                out.append(text);
+            }
+        }
+    }
+
+    /** Argmax, or a softmax draw at `temperature`; overwrites `logits` when sampling. */
+    whisper_token sample_token(float* logits, int n_candidates, float temperature, std::mt19937& rng) {
+        if (temperature <= 0.0f) {
+            return static_cast<whisper_token>(std::max_element(logits, logits + n_candidates) - logits);
+        }
+        const float max_logit = *std::max_element(logits, logits + n_candidates);
+        double total = 0.0;
+        for (int i = 0; i < n_candidates; ++i) {
+            logits[i] = std::exp((logits[i] - max_logit) / temperature);
+            total += logits[i];
+        }
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        for (int i = 0; i < n_candidates; ++i) {
+            target -= logits[i];
+            if (target <= 0.0) {
+                return static_cast<whisper_token>(i);
+            }
+        }
+        return static_cast<whisper_token>(n_candidates - 1);
+    }
+
+    /**
+     * Decode text from an already encoded clip. Only the decoder runs: the
+     * prompt (sot, language, task, no-timestamps) is fed one token at a time
+     * and the continuation is sampled until end-of-text. Timestamp and other
+     * special tokens are excluded from sampling, matching single_segment mode.
+     * Returns false if the decoder fails.
+     */
+    bool decode_encoded(whisper_state* state, const decode_options& options, assistant::ArenaText& text) {
+        whisper_token prompt[4];
+        int n_prompt = 0;
+        prompt[n_prompt++] = whisper_token_sot(g_ctx);
+        if (whisper_is_multilingual(g_ctx)) {
+            const int lang_id = whisper_lang_id(options.language.c_str());
+            if (lang_id >= 0) {
+                prompt[n_prompt++] = whisper_token_lang(g_ctx, lang_id);
+            }
+            prompt[n_prompt++] = options.translate ? whisper_token_translate(g_ctx) : whisper_token_transcribe(g_ctx);
+        }
+        prompt[n_prompt++] = whisper_token_not(g_ctx);
+
+        const whisper_token eot = whisper_token_eot(g_ctx);
+        const int n_vocab = whisper_n_vocab(g_ctx);
+        const int max_tokens = whisper_n_text_ctx(g_ctx) / 2;
+        std::mt19937 rng(static_cast<uint32_t>(options.temperature * 1000.0f) + 1);
+
+        // Text tokens all precede eot; copy them plus eot as the candidate set
+        const int n_candidates = std::min<int>(n_vocab, eot + 1);
+        float* candidates = g_request.alloc<float>(static_cast<size_t>(n_candidates));
+        int n_past = 0;
+        whisper_token next = prompt[0];
+
+        for (int step = 0; step < n_prompt + max_tokens; ++step) {
+            // n_past == 0 drops whatever the previous decode left in the self-attention cache
+            if (whisper_decode_with_state(g_ctx, state, &next, 1, n_past, g_governed.n_threads) != 0) {
+                LOGE("Whisper decode failed at step %d", step);
+                return false;
+            }
+            ++n_past;
+            if (step + 1 < n_prompt) {
+                next = prompt[step + 1];
+                continue;
+            }
+
+            const float* logits = whisper_get_logits_from_state(state);
+            std::copy(logits, logits + n_candidates, candidates);
+            next = sample_token(candidates, n_candidates, options.temperature, rng);
+            if (next == eot) {
+                break;
+            }
+            const char* piece = whisper_token_to_str(g_ctx, next);
+            if (piece != nullptr) {
+                text.append(piece);
+            }
+        }
+        return true;
+    }
+
+    // Command mode: phrase trie over whisper tokens, rebuilt only when the grammar changes
+    struct command_grammar {
+        uint64_t spec_hash = 0;
+        std::vector<assistant::CommandPhrase> phrases;
+        assistant::PhraseTrie trie;
+    };
+
+    command_grammar g_command;
+
+    bool load_command_grammar(const char* spec) {
+        const uint64_t hash = assistant::fnv1a64(spec, strlen(spec));
+        if (hash == g_command.spec_hash && !g_command.phrases.empty()) {
+            return true;
+        }
+        std::string error;
+        std::vector<assistant::CommandPhrase> phrases;
+        if (!assistant::parse_command_spec(spec, phrases, &error)) {
+            LOGE("Bad command grammar: %s", error.c_str());
+            return false;
+        }
+
+        // Whisper writes " Open camera." as readily as " open camera"; accept either spelling
+        g_command.trie.clear();
+        whisper_token tokens[64];
+        for (size_t i = 0; i < phrases.size(); ++i) {
+            std::string lower = " " + phrases[i].text;
+            std::string upper = lower;
+            if (upper.size() > 1 && upper[1] >= 'a' && upper[1] <= 'z') {
+                upper[1] = static_cast<char>(upper[1] - 'a' + 'A');
+            }
+            for (const std::string& variant : { lower, upper, lower + ".", upper + "." }) {
+                const int n = whisper_tokenize(g_ctx, variant.c_str(), tokens, 64);
+                if (n > 0) {
+                    g_command.trie.add(tokens, static_cast<size_t>(n), static_cast<int32_t>(i));
+                }
+            }
+        }
+        g_command.phrases = std::move(phrases);
+        g_command.spec_hash = hash;
+        LOGI("Command grammar: %zu phrases, %zu trie nodes", g_command.phrases.size(), g_command.trie.size());
+        return true;
+    }
+
+    struct command_filter_data {
+        assistant::CommandDecoder* decoder;
+        int n_vocab;
+    };
+
+    void command_logits_filter(whisper_context* /* ctx */, whisper_state* /* state */,
+                               const whisper_token_data* tokens, int n_tokens, float* logits, void* user_data) {
+        auto* data = static_cast<command_filter_data*>(user_data);
+        whisper_token history[64];
+        const int n = std::min(n_tokens, 64);
+        for (int i = 0; i < n; ++i) {
+            history[i] = tokens[i].id;
+        }
+        data->decoder->constrain(history, static_cast<size_t>(n), logits, static_cast<size_t>(data->n_vocab));
+    }
+
+    /** Decode `clip` again with `options` into a fresh copy of its text. */
+    bool redecode_clip(encoded_clip& clip, const decode_options& options) {
+        clip.arena.reset();
+        assistant::ArenaText text(clip.arena);
+        if (!decode_encoded(clip.state.get(), options, text)) {
+            clip.text = "";
+            return false;
+        }
+        clip.text = text.c_str();
+        clip.options = options;
+        return true;
+    }
+
+    // States of cancelled file jobs. Cancellation runs on whichever thread cancelled (or on the
+    // engine thread, without g_mutex), so the state is parked here and freed under g_mutex
+    std::mutex g_retired_mutex;
+    std::vector<std::unique_ptr<whisper_state, state_deleter>> g_retired;
+
+    void retire_state(std::unique_ptr<whisper_state, state_deleter> state) {
+        if (!state) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_retired_mutex);
+        g_retired.push_back(std::move(state));
+    }
+
+    /** Free parked states; caller holds g_mutex. */
+    void free_retired_states() {
+        std::vector<std::unique_ptr<whisper_state, state_deleter>> retired;
+        {
+            std::lock_guard<std::mutex> lock(g_retired_mutex);
+            retired.swap(g_retired);
+        }
+    }
+
+    /** Cancel file jobs and drop every state tied to the current context; caller holds the engine. */
+    void release_states() {
+        assistant::JobScheduler::shared().cancel_all();
+        free_retired_states();
+        g_encoded.clear();
+        g_spare_state.reset();
+        g_command = command_grammar();
+    }
+
+    /** Replace the model with the one at `path`; caller holds the engine and g_mutex. */
+    bool load_model(const char* path) {
+        // Cached states and file jobs belong to the old context
+        release_states();
+        if (g_ctx != nullptr) {
+            whisper_free(g_ctx);
+            g_ctx = nullptr;
+        }
+        
+        LOGI("Loading whisper model from: %s", path);
+        
+        // Initialize model with default parameters
+        struct whisper_context_params cparams = whisper_context_default_params();
+        cparams.use_gpu = false; // GPU support requires additional setup
+        
+        TRACE_SCOPE("whisper.load_model");
+        // Without the context's own state: every request runs on one of ours
+        g_ctx = whisper_init_from_file_with_params_no_state(path, cparams);
+        return g_ctx != nullptr;
+    }
+
+    /**
+     * Take the governor's settings for the next request. The model is only
+     * swapped for an interactive request with no file job pending, since a
+     * swap drops every state of the old context.
+     */
+    void govern(bool allow_model_switch) {
+        free_retired_states();
+        g_governed = g_governor.decide();
+        g_governed.n_threads = std::min(g_governed.n_threads, g_params.n_threads);
+        
+        const int32_t tier = g_fallback_model_path.empty() ? 0 : g_governed.model_tier;
+        if (!allow_model_switch || g_ctx == nullptr || tier == g_model_tier) {
+            return;
+        }
+        if (assistant::JobScheduler::shared().stats().background.queue_depth > 0) {
+            LOGD("Model tier %d deferred: file jobs pending", tier);
+            return;
+        }
+        const std::string& path = tier == 0 ? g_model_path : g_fallback_model_path;
+        LOGI("Governor: switching to model tier %d", tier);
+        if (load_model(path.c_str())) {
+            g_model_tier = tier;
+            return;
+        }
+        // Fall back to whatever loads; never leave the engine without a model
+        LOGE("Failed to load model tier %d, reloading %s", tier, g_model_path.c_str());
+        g_model_tier = 0;
+        load_model(g_model_path.c_str());
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Energy and CPU time of one request, closed on every return path
+    struct energy_scope {
+        explicit energy_scope(const char* engine) : token(assistant::EnergyMeter::shared().begin(engine)) {}
+        ~energy_scope() { assistant::EnergyMeter::shared().end(token, audio_seconds); }
+
+        energy_scope(const energy_scope&) = delete;
+        energy_scope& operator=(const energy_scope&) = delete;
+
+        uint64_t token;
+        double audio_seconds = 0.0;
+    };
+
+    /**
+     * Splits one whisper_full call into "whisper.encode" and "whisper.decode"
+     * trace sections: the encoder callback opens the first and the window's
+     * first logits callback switches to the second. Callbacks are only
+     * installed while tracing, and only sections of the calling thread are
+     * touched, since ATrace sections must end where they began.
+     */
+    class stage_trace {
+    public:
+        explicit stage_trace(whisper_full_params& wparams) : thread_(std::this_thread::get_id()) {
+            if (!assistant::trace_enabled()) return;
+            wparams.encoder_begin_callback = on_encoder_begin;
+            wparams.encoder_begin_callback_user_data = this;
+            wparams.logits_filter_callback = on_logits;
+            wparams.logits_filter_callback_user_data = this;
+        }
+        ~stage_trace() { close(); }
+
+        stage_trace(const stage_trace&) = delete;
+        stage_trace& operator=(const stage_trace&) = delete;
+
+    private:
+        enum stage { NONE, ENCODE, DECODE };
+
+        static bool on_encoder_begin(whisper_context* /* ctx */, whisper_state* /* state */, void* user_data) {
+            static_cast<stage_trace*>(user_data)->open("whisper.encode", ENCODE);
+            return true;
+        }
+
+        static void on_logits(whisper_context* /* ctx */, whisper_state* /* state */,
+                              const whisper_token_data* /* tokens */, int /* n_tokens */, float* /* logits */,
+                              void* user_data) {
+            auto* self = static_cast<stage_trace*>(user_data);
+            if (self->stage_ == ENCODE) self->open("whisper.decode", DECODE);
+        }
+
+        void open(const char* name, stage next) {
+            if (std::this_thread::get_id() != thread_) return;
+            close();
+            assistant::trace_begin(name);
+            stage_ = next;
+        }
+
+        void close() {
+            if (stage_ != NONE) assistant::trace_end();
+            stage_ = NONE;
+        }
+
+        std::thread::id thread_;
+        stage stage_ = NONE;
+    };
+
+    // File transcription as a background job: one 30 s window per scheduler step
+    struct file_job_result {
+        std::mutex mutex;
+        std::string text;
+        std::vector<assistant::TranscriptSegment> segments;
+        float progress = 0.0f;
+        bool done = false;
+        bool failed = false;
+    };
+
+    std::mutex g_jobs_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<file_job_result>> g_jobs;
+
+    bool abort_for_interactive(void* /* user_data */) {
+        return assistant::JobScheduler::shared().preempt_requested();
+    }
+
+    // Resuming steps over this much already-transcribed audio per step, so voice queries still get in
+    constexpr int64_t kResumeSkipFrames = WHISPER_SAMPLE_RATE * 600;
+
+    /**
+     * Decodes the file window by window from a streaming decoder (any
+     * format audio_decoder.h opens, resampled to 16 kHz), so memory stays
+     * bounded for hour-long recordings. A window aborted because a voice
+     * query is waiting is not lost: it stays in the buffer, the step
+     * reports "not done" and the window is transcribed again when the job
+     * resumes.
+     *
+     * Each window is decoded with the text tokens of the ones before it as
+     * its prompt, passed explicitly rather than left in the state, so with
+     * a checkpoint every finished window (segments, position, prompt) is
+     * saved and a job restarted from it produces the same transcript as
+     * one that never stopped.
+     */
+    class file_transcription_job : public assistant::StepJob {
+    public:
+        file_transcription_job(std::unique_ptr<assistant::AudioFileStream> audio, decode_options options,
+                               std::shared_ptr<file_job_result> result,
+                               std::unique_ptr<assistant::TranscriptCheckpoint> checkpoint = nullptr,
+                               const assistant::TranscriptProgress* restored = nullptr)
+            : audio_(std::move(audio)), options_(std::move(options)), result_(std::move(result)),
+              checkpoint_(std::move(checkpoint)), window_(kMaxCachedSamples) {
+            if (restored != nullptr) {
+                next_frame_ = static_cast<size_t>(restored->position);
+                skip_ = restored->position;
+                prompt_ = restored->prompt;
+                complete_ = restored->complete;
+            }
+        }
+
+        bool step() override {
+            if (complete_) {
+                return finish();
+            }
+            if (skip_ > 0) {
+                // The engine is not needed to step over audio, so no lock; the window after it is decoded as before
+                TRACE_SCOPE("whisper.file_resume");
+                const auto chunk = static_cast<size_t>(std::min(skip_, kResumeSkipFrames));
+                if (audio_->skip(chunk) < chunk) {
+                    return fail(audio_->failed() ? "Audio decoding failed" : "Audio ends before its checkpoint");
+                }
+                skip_ -= static_cast<int64_t>(chunk);
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (g_ctx == nullptr) {
+                return fail("Model released");
+            }
+            if (!state_) {
+                state_.reset(whisper_init_state(g_ctx));
+                if (!state_) {
+                    return fail("Failed to allocate whisper state");
+                }
+            }
+
+            govern(false);
+            energy_scope energy("whisper-file");
+            TRACE_SCOPE("whisper.file_window");
+            const auto started = std::chrono::steady_clock::now();
+            if (window_frames_ == 0) {
+                TRACE_SCOPE("whisper.file_decode");
+                window_frames_ = audio_->read(window_.data(), window_.size());
+                if (audio_->failed()) {
+                    return fail("Audio decoding failed");
+                }
+                if (window_frames_ == 0) {
+                    return finish();
+                }
+            }
+            const size_t n = window_frames_;
+
+            whisper_full_params wparams = full_params(options_);
+            wparams.single_segment = false;
+            wparams.no_timestamps = false;      // segment times are part of the result; never re-decoded
+            wparams.no_context = true;
+            wparams.prompt_tokens = prompt_.empty() ? nullptr : prompt_.data();
+            wparams.prompt_n_tokens = static_cast<int>(prompt_.size());
+            wparams.abort_callback = abort_for_interactive;
+            wparams.abort_callback_user_data = nullptr;
+            stage_trace stages(wparams);
+            if (whisper_full_with_state(g_ctx, state_.get(), wparams, window_.data(), static_cast<int>(n)) != 0) {
+                if (assistant::JobScheduler::shared().preempt_requested()) {
+                    LOGD("File window at %zu aborted for interactive work", next_frame_);
+                    return false;
+                }
+                return fail("Whisper inference failed");
+            }
+
+            g_governor.record(g_governed, static_cast<double>(n) / WHISPER_SAMPLE_RATE, seconds_since(started));
+            energy.audio_seconds = static_cast<double>(n) / WHISPER_SAMPLE_RATE;
+            std::vector<assistant::TranscriptSegment> segments = collect_segments();
+            next_frame_ += n;
+            window_frames_ = 0;
+            // Saved before the UI sees it, so nothing shown is lost with the process
+            if (checkpoint_ && !checkpoint_->append(static_cast<int64_t>(next_frame_), prompt_, segments.data(),
+                                                    segments.size())) {
+                LOGW("Checkpoint write failed; continuing without one");
+                checkpoint_.reset();
+            }
+            // A short window is the last one; a length from the container's duration is only an estimate
+            const bool last = n < window_.size() ||
+                (audio_->source().exact && static_cast<int64_t>(next_frame_) >= audio_->frames());
+            {
+                std::lock_guard<std::mutex> result_lock(result_->mutex);
+                for (assistant::TranscriptSegment& segment : segments) {
+                    result_->text.append(segment.text);
+                    result_->segments.push_back(std::move(segment));
+                }
+                const int64_t total = audio_->frames();
+                result_->progress = total > 0
+                    ? std::min(0.99f, static_cast<float>(next_frame_) / static_cast<float>(total)) : 0.0f;
+            }
+            return last ? finish() : false;
+        }
+
+        void cancelled() override {
+            // Possibly a step of another job, or a model swap, is running on the context right now
+            retire_state(std::move(state_));
+            std::lock_guard<std::mutex> lock(result_->mutex);
+            result_->done = true;
+            result_->failed = true;
+        }
+
+    private:
+        /** Segments of the window just transcribed, on the recording's clock; extends the prompt with their text. */
+        std::vector<assistant::TranscriptSegment> collect_segments() {
+            const int64_t window_ms = static_cast<int64_t>(next_frame_) * 1000 / WHISPER_SAMPLE_RATE;
+            const whisper_token eot = whisper_token_eot(g_ctx);
+            const int n_segments = whisper_full_n_segments_from_state(state_.get());
+            std::vector<assistant::TranscriptSegment> segments;
+            segments.reserve(static_cast<size_t>(std::max(0, n_segments)));
+            for (int i = 0; i < n_segments; ++i) {
+                const char* text = whisper_full_get_segment_text_from_state(state_.get(), i);
+                if (text == nullptr) {
+                    continue;
+                }
+                assistant::TranscriptSegment segment;
+                // whisper's timestamps are centiseconds from the start of the window
+                segment.t0_ms = window_ms + whisper_full_get_segment_t0_from_state(state_.get(), i) * 10;
+                segment.t1_ms = window_ms + whisper_full_get_segment_t1_from_state(state_.get(), i) * 10;
+                segment.text = text;
+                segments.push_back(std::move(segment));
+                // Text tokens only, as whisper keeps its own prompt
+                const int n_tokens = whisper_full_n_tokens_from_state(state_.get(), i);
+                for (int t = 0; t < n_tokens; ++t) {
+                    const whisper_token token = whisper_full_get_token_id_from_state(state_.get(), i, t);
+                    if (token < eot) {
+                        prompt_.push_back(token);
+                    }
+                }
+            }
+            // whisper conditions on at most half its text context
+            const auto max_prompt = static_cast<size_t>(std::max(0, whisper_n_text_ctx(g_ctx) / 2));
+            if (prompt_.size() > max_prompt) {
+                prompt_.erase(prompt_.begin(), prompt_.end() - static_cast<std::ptrdiff_t>(max_prompt));
+            }
+            return segments;
+        }
+
+        bool finish() {
+            state_.reset();
+            if (checkpoint_ && !complete_ && !checkpoint_->finish()) {
+                LOGW("Could not mark checkpoint %s complete", checkpoint_->path().c_str());
+            }
+            std::lock_guard<std::mutex> lock(result_->mutex);
+            result_->progress = 1.0f;
+            result_->done = true;
+            LOGI("File transcription complete: %zu chars", result_->text.size());
+            return true;
+        }
+
+        bool fail(const char* reason) {
+            LOGE("File transcription failed: %s", reason);
+            state_.reset();
+            std::lock_guard<std::mutex> lock(result_->mutex);
+            result_->done = true;
+            result_->failed = true;
+            return true;
+        }
+
+        std::unique_ptr<assistant::AudioFileStream> audio_;
+        decode_options options_;
+        std::shared_ptr<file_job_result> result_;
+        std::unique_ptr<assistant::TranscriptCheckpoint> checkpoint_;
+        size_t next_frame_ = 0;
+        int64_t skip_ = 0;              // frames the checkpoint covers that the stream has yet to pass
+        bool complete_ = false;         // restored from a finished checkpoint
+        std::vector<whisper_token> prompt_;
+        std::vector<float> window_;
+        size_t window_frames_ = 0;      // decoded, not yet transcribed
+        std::unique_ptr<whisper_state, state_deleter> state_;
+    };
+
+    /**
+     * A clip as 16 kHz mono floats from g_request. 16 kHz 16-bit WAV, what
+     * the app records, takes the allocation-free path; other rates and
+     * formats (a shared voice note) go through the decoder and resampler.
+     */
+    bool read_clip(const char* path, float** pcm, size_t* n) {
+        int32_t rate = 0;
+        if (assistant::read_wav_mono_float(path, g_request, pcm, n, &rate) && rate == WHISPER_SAMPLE_RATE) {
+            return true;
+        }
+        return assistant::read_audio_mono_float(path, WHISPER_SAMPLE_RATE, g_request, pcm, n);
+    }
+
+    std::string jstring_to_string(JNIEnv* env, jstring str) {
+        const char* chars = str != nullptr ? env->GetStringUTFChars(str, nullptr) : nullptr;
+        if (chars == nullptr) {
+            return std::string();
+        }
+        std::string out(chars);
+        env->ReleaseStringUTFChars(str, chars);
+        return out;
+    }
+
+    /**
+     * What a checkpoint is valid for: this version of the recording, read the
+     * same way. False if the file cannot be stat'ed; a key without its size
+     * and mtime could match the journal of another recording.
+     */
+    bool checkpoint_key(const std::string& file, const decode_options& options, std::string& out) {
+        struct stat st = {};
+        if (stat(file.c_str(), &st) != 0) {
+            LOGE("Cannot stat %s: %s", file.c_str(), strerror(errno));
+            return false;
+        }
+        char key[512];
+        snprintf(key, sizeof(key), "audio=%s\nsize=%lld\nmtime=%lld\nlanguage=%s\ntranslate=%d\nrate=%d\nwindow=%zu",
+                 file.c_str(), static_cast<long long>(st.st_size), static_cast<long long>(st.st_mtime),
+                 options.language.c_str(), options.translate ? 1 : 0, WHISPER_SAMPLE_RATE, kMaxCachedSamples);
+        out = key;
+        return true;
+    }
+
+    /** Queue a file job; with a checkpoint path, resume from what it holds. */
+    jlong submit_file_job(JNIEnv* env, jstring audioPath, jstring checkpointPath) {
+        const std::string file = jstring_to_string(env, audioPath);
+        if (file.empty()) {
+            return 0;
+        }
+
+        std::string error;
+        std::unique_ptr<assistant::AudioFileStream> audio =
+            assistant::AudioFileStream::open(file.c_str(), WHISPER_SAMPLE_RATE, &error);
+        if (!audio) {
+            LOGE("Cannot decode %s: %s", file.c_str(), error.c_str());
+            return 0;
+        }
+        const assistant::AudioStreamInfo& source = audio->source();
+        LOGD("File job source: %s, %d Hz, %d channels", assistant::audio_format_name(source.format),
+             source.sample_rate, source.channels);
+
+        decode_options options;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (g_ctx == nullptr) {
+                LOGE("Model not initialized");
+                return 0;
+            }
+            options = current_options();
+        }
+
+        auto result = std::make_shared<file_job_result>();
+        std::unique_ptr<assistant::TranscriptCheckpoint> checkpoint;
+        assistant::TranscriptProgress restored;
+        if (checkpointPath != nullptr) {
+            const std::string checkpoint_path = jstring_to_string(env, checkpointPath);
+            std::string key;
+            if (!checkpoint_key(file, options, key)) {
+                return 0;
+            }
+            checkpoint = assistant::TranscriptCheckpoint::open(checkpoint_path.c_str(), key, &restored, &error);
+            if (!checkpoint) {
+                LOGE("Checkpoint %s: %s", checkpoint_path.c_str(), error.c_str());
+                return 0;
+            }
+            // What was saved is the UI's right away; the job picks up after it
+            for (const assistant::TranscriptSegment& segment : restored.segments) {
+                result->text.append(segment.text);
+            }
+            result->segments = std::move(restored.segments);
+            const int64_t total = audio->frames();
+            result->progress = total > 0
+                ? std::min(0.99f, static_cast<float>(restored.position) / static_cast<float>(total)) : 0.0f;
+            if (restored.windows > 0) {
+                LOGI("Resuming file transcription at %.1f s from %zu saved windows",
+                     static_cast<double>(restored.position) / WHISPER_SAMPLE_RATE, restored.windows);
+            }
+        }
+
+        std::lock_guard<std::mutex> jobs_lock(g_jobs_mutex);
+        const uint64_t id = assistant::JobScheduler::shared().submit(assistant::JOB_BACKGROUND,
+            std::make_unique<file_transcription_job>(std::move(audio), std::move(options), result,
+                                                     std::move(checkpoint), &restored));
+        g_jobs.emplace(id, std::move(result));
+        LOGI("Queued file transcription %llu", static_cast<unsigned long long>(id));
+        return static_cast<jlong>(id);
+    }
+
+    /** transcribe() for a caller that holds the engine and g_mutex. */
+    jstring transcribe_locked(JNIEnv* env, jstring audioPath) {
+        if (g_ctx == nullptr) {
+            LOGE("Model not initialized");
+            return env->NewStringUTF("");
+        }
+
+        // Everything below draws from the request arena, so a warm transcription does not touch the heap
+        g_request.reset();
+        const char* path = copy_jstring(env, audioPath);
+        if (path == nullptr) {
+            LOGE("Failed to get audio path string");
+            return env->NewStringUTF("");
+        }
+
+        LOGI("Transcribing audio: %s", path);
+
+        govern(true);
+        if (g_ctx == nullptr) {
+            return env->NewStringUTF("");
+        }
+
+        // The graph threads whisper.cpp starts from here inherit the raised priority and fast cores
+        assistant::InteractiveScope interactive;
+        energy_scope energy("whisper");
+        TRACE_SCOPE("whisper.transcribe");
+
+        // Read the clip as 16 kHz mono (WAV as recorded, or any decodable file)
+        float* pcm_data = nullptr;
+        size_t n_samples = 0;
+        bool read;
+        {
+            TRACE_SCOPE("whisper.read_wav");
+            read = read_clip(path, &pcm_data, &n_samples);
+        }
+        if (!read) {
+            LOGE("Failed to read audio file: %s", path);
+            return env->NewStringUTF("");
+        }
+        if (n_samples == 0) {
+            LOGE("No audio data read");
+            return env->NewStringUTF("");
+        }
+
+        LOGD("Audio samples: %zu", n_samples);
+        energy.audio_seconds = static_cast<double>(n_samples) / WHISPER_SAMPLE_RATE;
+
+        const decode_options options = current_options();
+        const char* result = "";
+        const auto started = std::chrono::steady_clock::now();
+        bool cache_hit = false;
+
+        if (n_samples > kMaxCachedSamples) {
+            // Multi-window clip: nothing reusable survives, so it runs on the interactive state uncached
+            std::unique_ptr<whisper_state, state_deleter> state = take_interactive_state();
+            if (!state) {
+                LOGE("Failed to allocate whisper state");
+                return env->NewStringUTF("");
+            }
+            whisper_full_params wparams = full_params(options);
+            stage_trace stages(wparams);
+            const bool ok = whisper_full_with_state(g_ctx, state.get(), wparams, pcm_data, static_cast<int>(n_samples)) == 0;
+            assistant::ArenaText text(g_request);
+            if (ok) {
+                collect_text(state.get(), text);
+            }
+            g_spare_state = std::move(state);
+            if (!ok) {
+                LOGE("Whisper inference failed");
+                return env->NewStringUTF("");
+            }
+            result = text.c_str();
+        } else {
+            // Short utterances only encode the frames that cover them (0: full 30 s context)
+            const int32_t audio_ctx = request_audio_ctx(n_samples);
+            const uint64_t key = clip_key(pcm_data, n_samples, audio_ctx);
+
+            if (encoded_clip* cached = g_encoded.find(key)) {
+                // Same audio again (task switch, language retry): skip mel + encoder
+                if (!cached->options.same_task(options) || cached->options.temperature != 0.0f) {
+                    if (!redecode_clip(*cached, options)) {
+                        return env->NewStringUTF("");
+                    }
+                }
+                LOGD("Reused cached encoder output");
+                cache_hit = true;
+                result = cached->text;
+            } else {
+                // Once the cache is full, the oldest clip's state and arena are reused in place
+                encoded_clip* clip = g_encoded.recycle_oldest(key);
+                if (clip == nullptr) {
+                    encoded_clip fresh;
+                    fresh.state = std::move(g_spare_state);
+                    if (!fresh.state) {
+                        fresh.state.reset(whisper_init_state(g_ctx));
+                    }
+                    if (!fresh.state) {
+                        LOGE("Failed to allocate whisper state");
+                        return env->NewStringUTF("");
+                    }
+                    clip = &g_encoded.insert(key, std::move(fresh));
+                }
+                clip->options = options;
+                clip->text = "";
+
+                whisper_full_params wparams = full_params(clip->options, audio_ctx);
+                stage_trace stages(wparams);
+                if (whisper_full_with_state(g_ctx, clip->state.get(), wparams, pcm_data, static_cast<int>(n_samples)) != 0) {
+                    LOGE("Whisper inference failed");
+                    g_encoded.erase(key);
+                    return env->NewStringUTF("");
+                }
+                clip->arena.reset();
+                assistant::ArenaText text(clip->arena);
+                collect_text(clip->state.get(), text);
+
+                // Reduced contexts occasionally loop or hallucinate; redo those with the full context
+                const double seconds = static_cast<double>(n_samples) / WHISPER_SAMPLE_RATE;
+                if (audio_ctx > 0 && assistant::transcript_looks_degenerate(text.c_str(), seconds)) {
+                    LOGI("Short-context transcript looks degenerate, re-encoding with full context");
+                    wparams.audio_ctx = 0;
+                    if (whisper_full_with_state(g_ctx, clip->state.get(), wparams, pcm_data, static_cast<int>(n_samples)) != 0) {
+                        LOGE("Whisper inference failed");
+                        g_encoded.erase(key);
+                        return env->NewStringUTF("");
+                    }
+                    clip->arena.reset();
+                    text = assistant::ArenaText(clip->arena);
+                    collect_text(clip->state.get(), text);
+                }
+                LOGD("Encoder context: %d of %d frames", audio_ctx > 0 ? audio_ctx : whisper_n_audio_ctx(g_ctx),
+                     whisper_n_audio_ctx(g_ctx));
+                clip->text = text.c_str();
+                result = clip->text;
+            }
+        }
+
+        if (!cache_hit) {
+            g_governor.record(g_governed, static_cast<double>(n_samples) / WHISPER_SAMPLE_RATE, seconds_since(started));
+        }
+        LOGI("Transcription complete: %zu chars", strlen(result));
+
+        return env->NewStringUTF(result);
+    }
 }
 
 extern "C" {
@@ -52,38 +968,27 @@ Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_initModel(
         jobject /* this */,
         jstring modelPath) {
     
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
     std::lock_guard<std::mutex> lock(g_mutex);
     
-    // Release existing model if any
-    if (g_ctx != nullptr) {
-        whisper_free(g_ctx);
-        g_ctx = nullptr;
-    }
-    
     const char* path = env->GetStringUTFChars(modelPath, nullptr);
     if (path == nullptr) {
         LOGE("Failed to get model path string");
         return -1;
     }
-    
-    LOGI("Loading whisper model from: %s", path);
-    
-    // Initialize model with default parameters
-    struct whisper_context_params cparams = whisper_context_default_params();
-    cparams.use_gpu = false; // GPU support requires additional setup
-    
-    g_ctx = whisper_init_from_file_with_params(path, cparams);
-    
+    g_model_path = path;
     env->ReleaseStringUTFChars(modelPath, path);
+    g_model_tier = 0;
     
-    if (g_ctx == nullptr) {
+    if (!load_model(g_model_path.c_str())) {
         LOGE("Failed to initialize whisper model");
         return -2;
     }
     
-    // Set optimal thread count based on available cores
-    int n_cores = std::thread::hardware_concurrency();
-    g_params.n_threads = std::min(n_cores, 4);
+    // One thread per fast core: little cores only slow the slowest graph node down
+    const int n_fast = static_cast<int>(assistant::fast_cpus().size());
+    g_params.n_threads = std::max(1, std::min(n_fast, 4));
+    g_governor.set_max_threads(g_params.n_threads);
     
     LOGI("Whisper model initialized successfully (threads: %d)", g_params.n_threads);
     return 0;
@@ -91,7 +996,7 @@ Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_initModel(
 
 /**
  * Transcribe audio file to text.
- * @param audioPath Path to WAV file (16kHz, 16-bit, mono)
+ * @param audioPath Path to the clip: 16 kHz 16-bit WAV as recorded, or any file submitFileTranscription accepts
  * @return Transcribed text
  */
 JNIEXPORT jstring JNICALL
@@ -100,121 +1005,399 @@ Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_transcribe(
         jobject /* this */,
         jstring audioPath) {
     
+    // A file job running in the background yields at its next window (or mid-window via the abort callback)
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
     std::lock_guard<std::mutex> lock(g_mutex);
     
-    if (g_ctx == nullptr) {
-        LOGE("Model not initialized");
-        return env->NewStringUTF("");
+    return transcribe_locked(env, audioPath);
+}
+
+/**
+ * Transcribe with custom parameters.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_transcribeWithParams(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath,
+        jstring language,
+        jboolean translate,
+        jint threads) {
+    
+    // Same turn for the update and the transcription, so a concurrent call cannot swap the parameters between them
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
+    std::lock_guard<std::mutex> lock(g_mutex);
+    
+    const char* lang = env->GetStringUTFChars(language, nullptr);
+    if (lang != nullptr) {
+        g_params.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
     }
     
-    const char* path = env->GetStringUTFChars(audioPath, nullptr);
-    if (path == nullptr) {
-        LOGE("Failed to get audio path string");
+    g_params.translate = translate;
+    if (threads > 0) {
+        g_params.n_threads = threads;
+    }
+    
+    return transcribe_locked(env, audioPath);
+}
+
+/**
+ * Decode the most recently transcribed clip again with different options,
+ * reusing its encoder output instead of recomputing mel + encoder. A
+ * temperature above zero samples instead of taking the argmax, for fallback
+ * retries.
+ * @return Transcribed text, or empty if no encoded clip is cached
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_redecode(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring language,
+        jboolean translate,
+        jfloat temperature) {
+    
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
+    std::lock_guard<std::mutex> lock(g_mutex);
+    
+    encoded_clip* clip = g_encoded.front();
+    if (g_ctx == nullptr || clip == nullptr) {
+        LOGE("No encoded clip to re-decode");
         return env->NewStringUTF("");
     }
     
-    LOGI("Transcribing audio: %s", path);
+    g_request.reset();
+    decode_options options;
+    options.language = clip->options.language;
+    if (const char* lang = copy_jstring(env, language)) {
+        options.language = lang;
+    }
+    options.translate = translate;
+    options.temperature = std::max(0.0f, static_cast<float>(temperature));
     
-    // Read WAV file
-    std::vector<float> pcm_data;
+    if (options.same_task(clip->options) && options.temperature == 0.0f && clip->options.temperature == 0.0f) {
+        return env->NewStringUTF(clip->text);
+    }
+    assistant::InteractiveScope interactive;
+    // A model switch would drop the clip being re-decoded
+    govern(false);
     {
-        // Simple WAV reader (16-bit PCM mono)
-        FILE* file = fopen(path, "rb");
-        if (!file) {
-            LOGE("Failed to open audio file: %s", path);
-            env->ReleaseStringUTFChars(audioPath, path);
+        TRACE_SCOPE("whisper.redecode");
+        if (!redecode_clip(*clip, options)) {
             return env->NewStringUTF("");
         }
-        
-        // Skip WAV header (44 bytes for standard PCM)
-        fseek(file, 44, SEEK_SET);
-        
-        // Read 16-bit samples and convert to float
-        int16_t sample;
-        while (fread(&sample, sizeof(int16_t), 1, file) == 1) {
-            pcm_data.push_back(static_cast<float>(sample) / 32768.0f);
-        }
-        
-        fclose(file);
     }
     
-    env->ReleaseStringUTFChars(audioPath, path);
+    LOGI("Re-decode complete: %zu chars", strlen(clip->text));
+    return env->NewStringUTF(clip->text);
+}
+
+/**
+ * Recognize a short command constrained to a phrase list. Decoding is
+ * masked to the grammar's tokens and stops as soon as one phrase is left.
+ * @param grammar One "intent<TAB>phrase" per line
+ * @return "intent<TAB>phrase<TAB>score" (score 0..1), or empty on failure
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_recognizeCommand(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath,
+        jstring grammar) {
+    
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
+    std::lock_guard<std::mutex> lock(g_mutex);
     
-    if (pcm_data.empty()) {
-        LOGE("No audio data read");
+    govern(true);
+    if (g_ctx == nullptr) {
+        LOGE("Model not initialized");
+        return env->NewStringUTF("");
+    }
+    
+    g_request.reset();
+    const char* path = copy_jstring(env, audioPath);
+    const char* spec = copy_jstring(env, grammar);
+    if (path == nullptr || spec == nullptr || !load_command_grammar(spec)) {
         return env->NewStringUTF("");
     }
     
-    LOGD("Audio samples: %zu", pcm_data.size());
+    assistant::InteractiveScope interactive;
+    energy_scope energy("whisper-command");
+    TRACE_SCOPE("whisper.command");
     
-    // Run inference
-    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    float* pcm_data = nullptr;
+    size_t n_samples = 0;
+    if (!read_clip(path, &pcm_data, &n_samples) || n_samples == 0) {
+        LOGE("Failed to read audio file: %s", path);
+        return env->NewStringUTF("");
+    }
+    energy.audio_seconds = static_cast<double>(n_samples) / WHISPER_SAMPLE_RATE;
+    
+    // Shares the interactive state; the next transcription re-encodes, which a command capture needs anyway
+    std::unique_ptr<whisper_state, state_deleter> state = take_interactive_state();
+    if (!state) {
+        LOGE("Failed to allocate whisper state");
+        return env->NewStringUTF("");
+    }
     
-    wparams.print_realtime   = false;
-    wparams.print_progress   = g_params.print_progress;
-    wparams.print_timestamps = !g_params.no_timestamps;
-    wparams.print_special    = g_params.print_special;
-    wparams.translate        = g_params.translate;
-    wparams.language         = g_params.language.c_str();
-    wparams.n_threads        = g_params.n_threads;
-    wparams.offset_ms        = g_params.offset_ms;
-    wparams.duration_ms      = g_params.duration_ms;
+    assistant::CommandDecoder decoder(g_command.trie, whisper_token_eot(g_ctx));
+    command_filter_data filter = { &decoder, whisper_n_vocab(g_ctx) };
     
-    // Single segment mode for faster processing
-    wparams.single_segment   = true;
+    decode_options options = current_options();
+    options.translate = false;
+    whisper_full_params wparams = full_params(options, request_audio_ctx(n_samples));
+    wparams.no_context = true;
+    wparams.no_timestamps = true;       // the trie holds text tokens only
+    wparams.greedy.best_of = 1;
+    wparams.temperature_inc = 0.0f;     // a constrained decode has nothing to fall back to
+    wparams.max_tokens = static_cast<int>(g_command.trie.max_depth()) + 1;
+    wparams.logits_filter_callback = command_logits_filter;
+    wparams.logits_filter_callback_user_data = &filter;
     
-    if (whisper_full(g_ctx, wparams, pcm_data.data(), pcm_data.size()) != 0) {
+    const bool ok = whisper_full_with_state(g_ctx, state.get(), wparams, pcm_data, static_cast<int>(n_samples)) == 0;
+    g_spare_state = std::move(state);
+    if (!ok) {
         LOGE("Whisper inference failed");
         return env->NewStringUTF("");
     }
     
-    // Collect transcription
-    std::string result;
-    const int n_segments = whisper_full_n_segments(g_ctx);
+    const assistant::CommandMatch match = decoder.result();
+    if (match.phrase < 0) {
+        LOGI("No command matched");
+        return env->NewStringUTF("");
+    }
+    const assistant::CommandPhrase& phrase = g_command.phrases[match.phrase];
+    LOGI("Command: %s (%.2f, %d steps%s)", phrase.intent.c_str(), match.score, match.steps,
+         match.early ? ", early" : "");
     
-    for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text(g_ctx, i);
-        if (text != nullptr) {
-            result += text;
-        }
+    assistant::ArenaText out(g_request);
+    char score[16];
+    snprintf(score, sizeof(score), "%.3f", match.score);
+    out.append(phrase.intent.c_str());
+    out.append("\t");
+    out.append(phrase.text.c_str());
+    out.append("\t");
+    out.append(score);
+    return env->NewStringUTF(out.c_str());
+}
+
+/**
+ * Queue a long recording for background transcription. It runs one 30 s
+ * window at a time and yields to transcribe/redecode/recognizeCommand,
+ * resuming where it stopped.
+ * @param audioPath WAV or FLAC at any rate; on Android also m4a/AAC, Ogg/Opus, MP3
+ * @return Job id, or 0 if the file cannot be transcribed
+ */
+JNIEXPORT jlong JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_submitFileTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath) {
+    
+    return submit_file_job(env, audioPath, nullptr);
+}
+
+/**
+ * submitFileTranscription with a checkpoint file, for recordings long
+ * enough that the process may be killed before they are done. Every
+ * finished window is saved there with the decoder context the next one
+ * needs; after a restart the same call (same recording, same language
+ * and task) resumes after the last saved window, and the segments saved
+ * so far can be polled right away. The checkpoint outlives the job, even
+ * a completed one, so a transcript is not lost before the app has stored
+ * it; delete the file to start over.
+ * @param checkpointPath File in the app's storage, created if missing
+ * @return Job id, or 0 if the file cannot be transcribed or the checkpoint cannot be written
+ */
+JNIEXPORT jlong JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_submitCheckpointedTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath,
+        jstring checkpointPath) {
+    
+    if (checkpointPath == nullptr) {
+        return 0;
     }
+    return submit_file_job(env, audioPath, checkpointPath);
+}
+
+/**
+ * Fraction of a file job transcribed so far.
+ * @return 0..1, or -1 if the job is unknown, failed or was cancelled
+ */
+JNIEXPORT jfloat JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getJobProgress(
+        JNIEnv* /* env */,
+        jobject /* this */,
+        jlong jobId) {
     
-    LOGI("Transcription complete: %zu chars", result.size());
+    std::lock_guard<std::mutex> jobs_lock(g_jobs_mutex);
+    auto it = g_jobs.find(static_cast<uint64_t>(jobId));
+    if (it == g_jobs.end()) {
+        return -1.0f;
+    }
+    std::lock_guard<std::mutex> lock(it->second->mutex);
+    return it->second->failed ? -1.0f : it->second->progress;
+}
+
+/**
+ * Text of a file job so far. Once the job has finished, this returns the
+ * final text and forgets the job.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_pollFileTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong jobId) {
     
-    return env->NewStringUTF(result.c_str());
+    std::string text;
+    {
+        std::lock_guard<std::mutex> jobs_lock(g_jobs_mutex);
+        auto it = g_jobs.find(static_cast<uint64_t>(jobId));
+        if (it == g_jobs.end()) {
+            return env->NewStringUTF("");
+        }
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(it->second->mutex);
+            text = it->second->text;
+            done = it->second->done;
+        }
+        if (done) {
+            g_jobs.erase(it);
+        }
+    }
+    return env->NewStringUTF(text.c_str());
 }
 
 /**
- * Transcribe with custom parameters.
+ * Segments of a file job from index `first` on, one per line as
+ * "t0_ms\tt1_ms\ttext", times from the start of the recording. Pass the
+ * number of segments seen so far to get only the new ones. Once the job
+ * has finished, this returns the rest followed by a last line "done" (or
+ * "failed") and forgets the job, so this one call is all a UI needs to
+ * follow it. A cancelled or unknown job reads as "failed".
  */
 JNIEXPORT jstring JNICALL
-Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_transcribeWithParams(
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_pollTranscriptSegments(
         JNIEnv* env,
         jobject /* this */,
-        jstring audioPath,
-        jstring language,
-        jboolean translate,
-        jint threads) {
+        jlong jobId,
+        jint first) {
     
-    // Update parameters
+    std::string out;
     {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        
-        const char* lang = env->GetStringUTFChars(language, nullptr);
-        if (lang != nullptr) {
-            g_params.language = lang;
-            env->ReleaseStringUTFChars(language, lang);
+        std::lock_guard<std::mutex> jobs_lock(g_jobs_mutex);
+        auto it = g_jobs.find(static_cast<uint64_t>(jobId));
+        if (it == g_jobs.end()) {
+            return env->NewStringUTF("failed\n");
         }
-        
-        g_params.translate = translate;
-        if (threads > 0) {
-            g_params.n_threads = threads;
+        bool forget;
+        {
+            std::lock_guard<std::mutex> lock(it->second->mutex);
+            const std::vector<assistant::TranscriptSegment>& segments = it->second->segments;
+            char times[48];
+            for (size_t i = static_cast<size_t>(std::max(0, first)); i < segments.size(); ++i) {
+                snprintf(times, sizeof(times), "%lld\t%lld\t", static_cast<long long>(segments[i].t0_ms),
+                         static_cast<long long>(segments[i].t1_ms));
+                out.append(times);
+                // Tabs and line breaks would split the record
+                for (char c : segments[i].text) {
+                    out.push_back(c == '\t' || c == '\n' || c == '\r' ? ' ' : c);
+                }
+                out.push_back('\n');
+            }
+            forget = it->second->done;
+            if (forget) {
+                out.append(it->second->failed ? "failed\n" : "done\n");
+            }
+        }
+        if (forget) {
+            g_jobs.erase(it);
         }
     }
+    return env->NewStringUTF(out.c_str());
+}
+
+/**
+ * Cancel a file job; a window in flight finishes first.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_cancelJob(
+        JNIEnv* /* env */,
+        jobject /* this */,
+        jlong jobId) {
+    
+    const bool cancelled = assistant::JobScheduler::shared().cancel(static_cast<uint64_t>(jobId));
+    std::lock_guard<std::mutex> jobs_lock(g_jobs_mutex);
+    g_jobs.erase(static_cast<uint64_t>(jobId));
+    return cancelled ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Scheduler metrics: queue depth, waits and preemptions per class.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getSchedulerStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    
+    const assistant::SchedulerStats stats = assistant::JobScheduler::shared().stats();
+    char out[512];
+    snprintf(out, sizeof(out),
+             "interactive: %llu done, depth %u (max %u), wait mean %.1f ms max %.1f ms\n"
+             "background: %llu done, %llu cancelled, depth %u (max %u), wait mean %.1f ms max %.1f ms\n"
+             "preemptions: %llu, paused %.1f s",
+             static_cast<unsigned long long>(stats.interactive.completed), stats.interactive.queue_depth,
+             stats.interactive.max_queue_depth, stats.interactive.mean_wait_us() / 1000.0,
+             stats.interactive.wait_us_max / 1000.0,
+             static_cast<unsigned long long>(stats.background.completed),
+             static_cast<unsigned long long>(stats.background.cancelled), stats.background.queue_depth,
+             stats.background.max_queue_depth, stats.background.mean_wait_us() / 1000.0,
+             stats.background.wait_us_max / 1000.0,
+             static_cast<unsigned long long>(stats.preemptions), stats.paused_us_total / 1e6);
+    return env->NewStringUTF(out);
+}
+
+/**
+ * Smaller model the governor switches to when the device is critically
+ * hot, or hot on a low battery. Empty to disable switching.
+ */
+JNIEXPORT void JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_setFallbackModel(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring modelPath) {
+    
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
+    std::lock_guard<std::mutex> lock(g_mutex);
+    
+    const char* path = modelPath != nullptr ? env->GetStringUTFChars(modelPath, nullptr) : nullptr;
+    g_fallback_model_path = path != nullptr ? path : "";
+    if (path != nullptr) {
+        env->ReleaseStringUTFChars(modelPath, path);
+    }
+    // Back to the configured model right away if the fallback was in use
+    if (g_fallback_model_path.empty() && g_model_tier != 0 && !g_model_path.empty()) {
+        g_model_tier = load_model(g_model_path.c_str()) ? 0 : g_model_tier;
+    }
+}
+
+/**
+ * Governor state and real-time factor per thermal level.
+ */
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getGovernorStats(
+        JNIEnv* env,
+        jobject /* this */) {
     
-    // Call main transcribe function
-    return Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_transcribe(
-            env, nullptr, audioPath);
+    const assistant::GovernorDecision decision = g_governor.decide();
+    char head[160];
+    snprintf(head, sizeof(head), "%s (%.1f C, battery %d%%%s): %d threads, model tier %d\n",
+             assistant::thermal_level_name(decision.level), decision.celsius, decision.battery_pct,
+             decision.battery_saver ? ", saver" : "", decision.n_threads, decision.model_tier);
+    return env->NewStringUTF((head + g_governor.format_stats()).c_str());
 }
 
 /**
@@ -225,8 +1408,10 @@ Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_releaseModel(
         JNIEnv* /* env */,
         jobject /* this */) {
     
+    assistant::JobScheduler::InteractiveTurn turn(assistant::JobScheduler::shared());
     std::lock_guard<std::mutex> lock(g_mutex);
     
+    release_states();
     if (g_ctx != nullptr) {
         whisper_free(g_ctx);
         g_ctx = nullptr;
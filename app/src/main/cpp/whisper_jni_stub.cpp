@@ -44,6 +44,100 @@ Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_transcribeWithPa
     return env->NewStringUTF("");
 }
 
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_redecode(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring language,
+        jboolean translate,
+        jfloat temperature) {
+    LOGW("Whisper stub: redecode called - native library not available");
+    return env->NewStringUTF("");
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_recognizeCommand(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath,
+        jstring grammar) {
+    LOGW("Whisper stub: recognizeCommand called - native library not available");
+    return env->NewStringUTF("");
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_submitFileTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath) {
+    LOGW("Whisper stub: submitFileTranscription called - native library not available");
+    return 0;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_submitCheckpointedTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring audioPath,
+        jstring checkpointPath) {
+    LOGW("Whisper stub: submitCheckpointedTranscription called - native library not available");
+    return 0;
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getJobProgress(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong jobId) {
+    return -1.0f;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_pollFileTranscription(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong jobId) {
+    return env->NewStringUTF("");
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_pollTranscriptSegments(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong jobId,
+        jint first) {
+    return env->NewStringUTF("");
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_cancelJob(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong jobId) {
+    return JNI_FALSE;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getSchedulerStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    return env->NewStringUTF("");
+}
+
+JNIEXPORT void JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_setFallbackModel(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring modelPath) {
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_getGovernorStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    return env->NewStringUTF("");
+}
+
 JNIEXPORT void JNICALL
 Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_releaseModel(
         JNIEnv* /* env */,
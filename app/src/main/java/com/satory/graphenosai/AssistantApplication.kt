@@ -5,6 +5,8 @@ import android.app.NotificationChannel
 import android.app.NotificationManager
 import android.content.Context
 import android.os.Build
+import android.util.Log
+import com.satory.graphenosai.diagnostics.LatencyMetrics
 import com.satory.graphenosai.security.SecureKeyManager
 
 /**
@@ -28,6 +30,9 @@ class AssistantApplication : Application() {
         
         // Load native libraries
         loadNativeLibraries()
+        
+        // Latency history for the diagnostics screen (a few hundred KB at most)
+        LatencyMetrics.open(filesDir)
     }
 
     private fun createNotificationChannels() {
@@ -61,8 +66,14 @@ class AssistantApplication : Application() {
     }
 
     private fun loadNativeLibraries() {
-        // Using Vosk for on-device speech recognition
-        nativeLibsLoaded = false
+        // Vosk handles speech recognition; the native library adds the wake word engine
+        nativeLibsLoaded = try {
+            System.loadLibrary("whisper_jni")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w("AssistantApplication", "Native library not available", e)
+            false
+        }
     }
 
     companion object {
@@ -32,11 +32,16 @@ import androidx.navigation.compose.composable
 import androidx.navigation.compose.rememberNavController
 import com.satory.graphenosai.service.AssistantAccessibilityService
 import com.satory.graphenosai.service.AssistantService
+import com.satory.graphenosai.service.WakeWordService
+import com.satory.graphenosai.service.TranscriptionService
 import com.satory.graphenosai.ui.SettingsManager
+import com.satory.graphenosai.ui.DiagnosticsScreen
 import com.satory.graphenosai.ui.SettingsScreen
+import com.satory.graphenosai.ui.TranscriptionScreen
 import com.satory.graphenosai.ui.VoskLanguageManagerScreen
 import com.satory.graphenosai.ui.theme.AiintegratedintoandroidTheme
 import com.satory.graphenosai.audio.VoskTranscriber
+import com.satory.graphenosai.audio.WakeWordEngine
 import kotlinx.coroutines.launch
 
 /**
@@ -64,8 +69,10 @@ class MainActivity : ComponentActivity() {
         ActivityResultContracts.RequestMultiplePermissions()
     ) { permissions ->
         val audioGranted = permissions[Manifest.permission.RECORD_AUDIO] ?: false
-        if (audioGranted) {
-            // Permission granted, UI will update
+        // Restart the wake word listener if it was enabled before the app was killed; its
+        // microphone foreground service cannot start before the permission is granted
+        if (audioGranted && SettingsManager(this).wakeWordEnabled && WakeWordEngine.isModelInstalled(this)) {
+            WakeWordService.start(this)
         }
     }
     
@@ -89,6 +96,9 @@ class MainActivity : ComponentActivity() {
         super.onCreate(savedInstanceState)
         enableEdgeToEdge()
 
+        // A long transcription the system killed continues from its checkpoint
+        TranscriptionService.resumePending(this)
+
         // Request permissions on launch
         permissionLauncher.launch(
             arrayOf(
@@ -116,9 +126,17 @@ class MainActivity : ComponentActivity() {
                         SettingsScreen(
                             onNavigateBack = { navController.popBackStack() },
                             assistantService = if (bound) assistantService else null,
-                            onNavigateToLanguages = { navController.navigate("voice_languages") }
+                            onNavigateToLanguages = { navController.navigate("voice_languages") },
+                            onNavigateToDiagnostics = { navController.navigate("diagnostics") },
+                            onNavigateToTranscription = { navController.navigate("transcription") }
                         )
                     }
+                    composable("diagnostics") {
+                        DiagnosticsScreen(onNavigateBack = { navController.popBackStack() })
+                    }
+                    composable("transcription") {
+                        TranscriptionScreen(onNavigateBack = { navController.popBackStack() })
+                    }
                     composable("voice_languages") {
                         VoskLanguageManagerScreen(
                             onNavigateBack = { navController.popBackStack() },
@@ -9,6 +9,7 @@ import android.media.MediaRecorder
 import android.util.Log
 import androidx.core.content.ContextCompat
 import androidx.annotation.RequiresPermission
+import com.satory.graphenosai.diagnostics.Tracing
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.channels.awaitClose
 import kotlinx.coroutines.flow.Flow
@@ -40,6 +41,8 @@ class AudioCaptureManager(private val context: Context) {
     private var outputFile: File? = null
     private var pcmOutputStream: FileOutputStream? = null
     private val pcmBuffer = mutableListOf<ByteArray>()
+    // Cookie of the "audio.capture" trace span; 0 while not capturing
+    private var captureTrace = 0
 
     private val bufferSize: Int by lazy {
         val minBufferSize = AudioRecord.getMinBufferSize(SAMPLE_RATE, CHANNEL_CONFIG, AUDIO_FORMAT)
@@ -49,9 +52,11 @@ class AudioCaptureManager(private val context: Context) {
     /**
      * Start capturing audio and emit PCM chunks as a Flow.
      * Audio is also saved to a temporary file for batch processing.
+     * [preRoll] (16-bit PCM captured before this call, e.g. by the wake word
+     * detector) is written and emitted ahead of the live audio.
      */
     @RequiresPermission(Manifest.permission.RECORD_AUDIO)
-    fun startCapture(): Flow<ByteArray> = callbackFlow {
+    fun startCapture(preRoll: ByteArray? = null): Flow<ByteArray> = callbackFlow {
         if (!hasRecordPermission()) {
             close(SecurityException("RECORD_AUDIO permission not granted"))
             return@callbackFlow
@@ -81,9 +86,16 @@ class AudioCaptureManager(private val context: Context) {
                 return@callbackFlow
             }
 
+            if (preRoll != null && preRoll.isNotEmpty()) {
+                pcmBuffer.add(preRoll)
+                pcmOutputStream?.write(preRoll)
+                trySend(preRoll)
+            }
+
             audioRecord?.startRecording()
+            captureTrace = Tracing.beginAsync("audio.capture")
             isRecording = true
-            Log.i(TAG, "Audio capture started")
+            Log.i(TAG, "Audio capture started (pre-roll ${preRoll?.size ?: 0} bytes)")
 
             val buffer = ByteArray(bufferSize)
 
@@ -123,7 +135,7 @@ class AudioCaptureManager(private val context: Context) {
         val wavFile = File(context.cacheDir, "audio_${System.currentTimeMillis()}.wav")
         
         // Convert PCM to WAV
-        convertPcmToWav(pcmFile, wavFile)
+        Tracing.section("audio.pcmToWav") { convertPcmToWav(pcmFile, wavFile) }
         
         // Clean up PCM file
         pcmFile.delete()
@@ -162,6 +174,10 @@ class AudioCaptureManager(private val context: Context) {
         }
         
         pcmOutputStream = null
+        if (captureTrace != 0) {
+            Tracing.endAsync("audio.capture", captureTrace)
+            captureTrace = 0
+        }
         Log.i(TAG, "Audio capture stopped")
     }
 
@@ -176,8 +192,10 @@ class AudioCaptureManager(private val context: Context) {
      * Convert raw PCM data to WAV format.
      * Vosk expects 16-bit PCM WAV at 16kHz mono.
      */
-    private fun convertPcmToWav(pcmFile: File, wavFile: File) {
-        val pcmData = pcmFile.readBytes()
+    private fun convertPcmToWav(pcmFile: File, wavFile: File) = writeWav(pcmFile.readBytes(), wavFile)
+
+    /** Write 16 kHz mono 16-bit PCM bytes to [wavFile] with a WAV header. */
+    fun writeWav(pcmData: ByteArray, wavFile: File) {
         val totalAudioLen = pcmData.size.toLong()
         val totalDataLen = totalAudioLen + 36
         val channels = 1
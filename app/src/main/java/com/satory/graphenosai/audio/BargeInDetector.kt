@@ -0,0 +1,86 @@
+package com.satory.graphenosai.audio
+
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+
+/**
+ * Kotlin handle for the native barge-in detector (barge_in.cpp). Push what
+ * the speaker played (or silence) and the matching microphone capture from
+ * a single thread; the native side cancels the echo and reports when the
+ * user starts talking over the assistant.
+ */
+class BargeInDetector private constructor(private var handle: Long) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "BargeInDetector"
+        const val SAMPLE_RATE = 16000
+        const val DEFAULT_ONSET_MS = 150
+        const val DEFAULT_PREROLL_MS = 1500
+
+        /** Returns null if the native library is unavailable. */
+        fun create(
+            referenceRate: Int,
+            onsetMs: Int = DEFAULT_ONSET_MS,
+            prerollMs: Int = DEFAULT_PREROLL_MS
+        ): BargeInDetector? {
+            if (!AssistantApplication.nativeLibsLoaded) {
+                Log.w(TAG, "Native library not loaded, barge-in disabled")
+                return null
+            }
+            val handle = nativeCreate(SAMPLE_RATE, referenceRate, onsetMs, prerollMs)
+            if (handle == 0L) {
+                Log.e(TAG, "Failed to create barge-in detector")
+                return null
+            }
+            return BargeInDetector(handle)
+        }
+
+        @JvmStatic private external fun nativeCreate(sampleRate: Int, referenceRate: Int, onsetMs: Int, prerollMs: Int): Long
+        @JvmStatic private external fun nativeSetReferenceRate(handle: Long, rate: Int)
+        @JvmStatic private external fun nativePushReference(handle: Long, pcm: ShortArray, offset: Int, length: Int)
+        @JvmStatic private external fun nativePushSilence(handle: Long, length: Int)
+        @JvmStatic private external fun nativeProcess(handle: Long, pcm: ShortArray, length: Int): Boolean
+        @JvmStatic private external fun nativeGetPreroll(handle: Long): ShortArray
+        @JvmStatic private external fun nativeGetErleDb(handle: Long): Float
+        @JvmStatic private external fun nativeReset(handle: Long)
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+    }
+
+    /** Playback sample rate of the reference; changing it drops queued reference audio. */
+    fun setReferenceRate(rate: Int) {
+        if (handle != 0L) nativeSetReferenceRate(handle, rate)
+    }
+
+    /** Audio the speaker just played, at the reference rate. */
+    fun pushReference(pcm: ShortArray, offset: Int = 0, length: Int = pcm.size - offset) {
+        if (handle != 0L && length > 0) nativePushReference(handle, pcm, offset, length)
+    }
+
+    /** Nothing was played for [samples] capture-rate samples. */
+    fun pushSilence(samples: Int) {
+        if (handle != 0L && samples > 0) nativePushSilence(handle, samples)
+    }
+
+    /** Returns true once user speech has been detected. */
+    fun process(pcm: ShortArray, length: Int = pcm.size): Boolean {
+        if (handle == 0L) return false
+        return nativeProcess(handle, pcm, length)
+    }
+
+    /** Echo-cancelled capture leading up to now, oldest sample first. */
+    fun getPreroll(): ShortArray = if (handle != 0L) nativeGetPreroll(handle) else ShortArray(0)
+
+    val erleDb: Float
+        get() = if (handle != 0L) nativeGetErleDb(handle) else 0f
+
+    fun reset() {
+        if (handle != 0L) nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+}
@@ -0,0 +1,119 @@
+package com.satory.graphenosai.audio
+
+import android.Manifest
+import android.content.Context
+import android.content.pm.PackageManager
+import android.media.AudioFormat
+import android.media.AudioRecord
+import android.media.MediaRecorder
+import android.util.Log
+import androidx.core.content.ContextCompat
+import com.satory.graphenosai.tts.TTSManager
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
+
+/**
+ * Listens while the assistant speaks and reports when the user talks over
+ * it. Each microphone read is paired with the PCM the TTS player handed to
+ * the speaker over the same interval (or silence between clips), so the
+ * native echo canceller can remove the assistant's voice before the VAD
+ * looks for the user's.
+ */
+class BargeInMonitor(private val context: Context, private val ttsManager: TTSManager) {
+
+    companion object {
+        private const val TAG = "BargeInMonitor"
+        private const val CHUNK_SAMPLES = 320 // 20 ms at 16 kHz
+    }
+
+    private var job: Job? = null
+
+    /**
+     * Start listening on [scope]. [onBargeIn] runs on the main thread with
+     * the echo-cancelled audio leading up to the detection (16 kHz PCM).
+     * Returns false if the microphone or the native detector is unavailable.
+     */
+    fun start(scope: CoroutineScope, onBargeIn: (ShortArray) -> Unit): Boolean {
+        if (job?.isActive == true) return true
+        if (ContextCompat.checkSelfPermission(context, Manifest.permission.RECORD_AUDIO)
+            != PackageManager.PERMISSION_GRANTED) {
+            Log.w(TAG, "RECORD_AUDIO permission not granted, barge-in disabled")
+            return false
+        }
+        val detector = BargeInDetector.create(referenceRate = BargeInDetector.SAMPLE_RATE) ?: return false
+
+        job = scope.launch(Dispatchers.IO) {
+            val minBuffer = AudioRecord.getMinBufferSize(
+                BargeInDetector.SAMPLE_RATE, AudioFormat.CHANNEL_IN_MONO, AudioFormat.ENCODING_PCM_16BIT
+            )
+            // The canceller needs a linear echo path: the CDD has AGC and noise suppression off for
+            // VOICE_RECOGNITION, which unlike UNPROCESSED every device supports
+            val record = try {
+                AudioRecord(
+                    MediaRecorder.AudioSource.VOICE_RECOGNITION,
+                    BargeInDetector.SAMPLE_RATE,
+                    AudioFormat.CHANNEL_IN_MONO,
+                    AudioFormat.ENCODING_PCM_16BIT,
+                    maxOf(minBuffer, CHUNK_SAMPLES * 2 * 4)
+                )
+            } catch (e: SecurityException) {
+                Log.e(TAG, "Microphone access denied", e)
+                detector.close()
+                return@launch
+            }
+            if (record.state != AudioRecord.STATE_INITIALIZED) {
+                Log.e(TAG, "AudioRecord failed to initialize")
+                record.release()
+                detector.close()
+                return@launch
+            }
+
+            val chunk = ShortArray(CHUNK_SAMPLES)
+            var referenceRate = BargeInDetector.SAMPLE_RATE
+            var preroll: ShortArray? = null
+            record.startRecording()
+            try {
+                while (isActive) {
+                    val read = record.read(chunk, 0, chunk.size)
+                    if (read < 0) {
+                        Log.e(TAG, "AudioRecord read error $read")
+                        break
+                    }
+                    if (read == 0) continue
+
+                    val playing = ttsManager.drainPlayed { pcm, offset, length, sampleRate ->
+                        if (sampleRate != referenceRate) {
+                            detector.setReferenceRate(sampleRate)
+                            referenceRate = sampleRate
+                        }
+                        detector.pushReference(pcm, offset, length)
+                    }
+                    if (!playing) detector.pushSilence(read)
+
+                    if (detector.process(chunk, read)) {
+                        Log.i(TAG, "User speech over playback (ERLE ${detector.erleDb} dB)")
+                        preroll = detector.getPreroll()
+                        break
+                    }
+                }
+            } finally {
+                record.stop()
+                record.release()
+                detector.close()
+            }
+
+            // The microphone is released before the next capture opens its own
+            preroll?.let { withContext(Dispatchers.Main) { onBargeIn(it) } }
+        }
+        return true
+    }
+
+    fun stop() {
+        job?.cancel()
+        job = null
+    }
+}
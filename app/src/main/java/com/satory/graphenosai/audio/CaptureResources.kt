@@ -0,0 +1,38 @@
+package com.satory.graphenosai.audio
+
+/**
+ * The native pipeline and the recognizer stream of the capture in
+ * progress. [open] releases the previous capture's pair before it opens
+ * the new one, so the stream it hands out stays open until [takeStream],
+ * [release] or the next [open].
+ */
+class CaptureResources<P : AutoCloseable, S : AutoCloseable> {
+
+    private var pipeline: P? = null
+    private var stream: S? = null
+
+    /** Release the last capture, then open the pipeline and after it the stream. */
+    @Synchronized
+    fun open(openPipeline: () -> P?, openStream: () -> S?): Pair<P?, S?> {
+        release()
+        val newPipeline = openPipeline()
+        pipeline = newPipeline
+        val newStream = openStream()
+        stream = newStream
+        return newPipeline to newStream
+    }
+
+    /** Hand the pipeline over to the caller, which closes it. */
+    @Synchronized
+    fun takePipeline(): P? = pipeline.also { pipeline = null }
+
+    /** Hand the stream over to the caller, e.g. to finish decoding after capture. */
+    @Synchronized
+    fun takeStream(): S? = stream.also { stream = null }
+
+    @Synchronized
+    fun release() {
+        takePipeline()?.close()
+        takeStream()?.close()
+    }
+}
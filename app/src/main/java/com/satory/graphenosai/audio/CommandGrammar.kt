@@ -0,0 +1,142 @@
+package com.satory.graphenosai.audio
+
+/**
+ * Closed list of voice commands for constrained recognition.
+ *
+ * Rules are written as patterns - "(open|launch) [the] camera" - and expanded
+ * into plain phrases. The same list feeds both recognizers: Vosk gets it as
+ * a grammar JSON array, the native whisper command mode (whisper_jni.cpp)
+ * as "intent<TAB>phrase" lines that it compiles into a token trie.
+ */
+class CommandGrammar(rules: List<Rule>) {
+
+    data class Rule(val intent: String, val pattern: String)
+
+    data class Phrase(val intent: String, val text: String)
+
+    /**
+     * A recognized command. [score] is 0..1; [early] means the recognizer
+     * stopped as soon as the words so far left only this phrase.
+     */
+    data class Match(val intent: String, val phrase: String, val score: Float, val early: Boolean = false)
+
+    companion object {
+        /** Below this a match is more likely out-of-grammar speech than a command. */
+        const val MIN_SCORE = 0.5f
+
+        val DEFAULT = CommandGrammar(listOf(
+            Rule("open_camera", "(open|launch|start) [the] camera"),
+            Rule("take_photo", "take a (photo|picture)"),
+            Rule("flashlight_on", "turn on [the] (flashlight|torch)"),
+            Rule("flashlight_off", "turn off [the] (flashlight|torch)"),
+            Rule("volume_up", "(volume up|louder)"),
+            Rule("volume_down", "(volume down|quieter)"),
+            Rule("stop", "(stop|cancel|never mind)"),
+            Rule("repeat", "(repeat|say that again)")
+        ))
+
+        /** Expand "(a|b)" alternatives and "[x]" optional parts; groups may nest. */
+        fun expand(pattern: String): List<String> =
+            expandRaw(pattern).map(::normalize).filter { it.isNotEmpty() }.distinct()
+
+        /** [expand] without normalization, for patterns that carry their own markup. */
+        fun expandRaw(pattern: String): List<String> =
+            Expander(pattern).parseSequence()
+                .map { it.split(' ').filter(String::isNotEmpty).joinToString(" ") }
+                .filter { it.isNotEmpty() }
+                .distinct()
+
+        /** Lowercase, drop punctuation and collapse whitespace, as recognizers print text. */
+        fun normalize(text: String): String =
+            text.lowercase()
+                .map { if (it.isLetterOrDigit() || it == '\'') it else ' ' }
+                .joinToString("")
+                .split(' ')
+                .filter { it.isNotEmpty() }
+                .joinToString(" ")
+
+        /** Parse the native "intent<TAB>phrase<TAB>score" result; null when nothing matched. */
+        fun parseNativeResult(result: String): Match? {
+            val parts = result.split('\t')
+            if (parts.size != 3 || parts[0].isEmpty()) return null
+            val score = parts[2].toFloatOrNull() ?: return null
+            return Match(parts[0], parts[1], score)
+        }
+    }
+
+    val phrases: List<Phrase> = rules.flatMap { rule ->
+        expand(rule.pattern).map { Phrase(rule.intent, it) }
+    }.distinctBy { it.text }
+
+    private val byText = phrases.associateBy { it.text }
+
+    /**
+     * Grammar for Vosk's Recognizer; "[unk]" absorbs out-of-grammar speech.
+     * Phrases are normalized, so they never need JSON escaping.
+     */
+    fun voskGrammarJson(): String =
+        (phrases.map { it.text } + "[unk]").joinToString(",", "[", "]") { "\"$it\"" }
+
+    /** Spec for the native command mode: one "intent<TAB>phrase" per line. */
+    fun nativeSpec(): String = phrases.joinToString("\n") { "${it.intent}\t${it.text}" }
+
+    /** Exact phrase for recognized [text], or null. */
+    fun match(text: String): Phrase? = byText[normalize(text)]
+
+    /**
+     * The only phrase that starts with the words of [partial], or null while
+     * several remain. Lets a streaming recognizer stop after a few words.
+     */
+    fun resolvePrefix(partial: String): Phrase? {
+        val prefix = normalize(partial)
+        if (prefix.isEmpty()) return null
+        var found: Phrase? = null
+        for (phrase in phrases) {
+            if (phrase.text == prefix || phrase.text.startsWith("$prefix ")) {
+                if (found != null && found.intent != phrase.intent) return null
+                // Several spellings of one intent: keep the shortest, it is what was said so far
+                if (found == null || phrase.text.length < found.text.length) found = phrase
+            }
+        }
+        return found
+    }
+
+    /** Recursive-descent expander over the pattern syntax. */
+    private class Expander(private val pattern: String) {
+        private var pos = 0
+
+        /** Sequence of words and groups up to ')', ']', '|' or the end. */
+        fun parseSequence(): List<String> {
+            var results = listOf("")
+            while (pos < pattern.length) {
+                val options = when (pattern[pos]) {
+                    ')', ']', '|' -> return results
+                    '(' -> group(')', optional = false)
+                    '[' -> group(']', optional = true)
+                    else -> listOf(word())
+                }
+                results = results.flatMap { head -> options.map { "$head $it" } }
+            }
+            return results
+        }
+
+        private fun group(close: Char, optional: Boolean): List<String> {
+            pos++
+            val options = mutableListOf<String>()
+            while (true) {
+                options += parseSequence()
+                if (pos >= pattern.length) throw IllegalArgumentException("Unclosed group in \"$pattern\"")
+                val c = pattern[pos++]
+                if (c == close) break
+                if (c != '|') throw IllegalArgumentException("Unexpected '$c' in \"$pattern\"")
+            }
+            return if (optional) options + "" else options
+        }
+
+        private fun word(): String {
+            val start = pos
+            while (pos < pattern.length && pattern[pos] !in "()[]|") pos++
+            return pattern.substring(start, pos)
+        }
+    }
+}
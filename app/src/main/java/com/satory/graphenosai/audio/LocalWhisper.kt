@@ -0,0 +1,76 @@
+package com.satory.graphenosai.audio
+
+import android.content.Context
+import android.net.Uri
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+import com.vincent.ai_integrated_into_android.audio.WhisperJNI
+import java.io.File
+
+/**
+ * The on-device whisper model: where it lives in app storage, how it gets
+ * there, and loading it into the native bridge once per process.
+ */
+object LocalWhisper {
+    private const val TAG = "LocalWhisper"
+    const val MODEL_DIR = "whisper"
+    const val MODEL_FILE = "ggml-model.bin"
+
+    private var loadedPath: String? = null
+
+    fun modelFile(context: Context): File = File(File(context.filesDir, MODEL_DIR), MODEL_FILE)
+
+    fun isModelInstalled(context: Context): Boolean = modelFile(context).isFile
+
+    /**
+     * Copy a GGML model picked in Settings from [uri] to [modelFile],
+     * replacing any installed one; it is loaded on next use. Blocking I/O:
+     * call off the main thread.
+     */
+    fun installModel(context: Context, uri: Uri): Boolean {
+        val target = modelFile(context)
+        val staging = File(target.parentFile, "$MODEL_FILE.tmp")
+        try {
+            target.parentFile?.mkdirs()
+            val input = context.contentResolver.openInputStream(uri) ?: return false
+            input.use { source -> staging.outputStream().use { source.copyTo(it) } }
+            if (staging.length() == 0L || !staging.renameTo(target)) {
+                Log.e(TAG, "Cannot install whisper model at ${target.absolutePath}")
+                return false
+            }
+            synchronized(this) { loadedPath = null }
+            Log.i(TAG, "Installed whisper model (${target.length()} bytes)")
+            return true
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to import whisper model", e)
+            return false
+        } finally {
+            staging.delete()
+        }
+    }
+
+    /**
+     * Make sure the installed model is the one the bridge has loaded.
+     * Returns false if the native library or the model is unavailable.
+     */
+    @Synchronized
+    fun ensureLoaded(context: Context): Boolean {
+        if (!AssistantApplication.nativeLibsLoaded) {
+            Log.w(TAG, "Native library not loaded, local whisper disabled")
+            return false
+        }
+        val model = modelFile(context)
+        if (!model.isFile) {
+            Log.w(TAG, "No whisper model at ${model.absolutePath}")
+            return false
+        }
+        if (loadedPath == model.absolutePath) return true
+        val status = WhisperJNI.initModel(model.absolutePath)
+        if (status != 0) {
+            Log.e(TAG, "Failed to load whisper model ($status)")
+            return false
+        }
+        loadedPath = model.absolutePath
+        return true
+    }
+}
@@ -0,0 +1,140 @@
+package com.satory.graphenosai.audio
+
+import java.io.File
+import java.io.OutputStream
+
+/** One timed piece of a long transcription, times from the start of the recording. */
+data class TranscriptSegment(val startMs: Long, val endMs: Long, val text: String) {
+
+    /** The line format shared by the native bridge and [TranscriptJobStore]. */
+    fun toLine(): String = "$startMs\t$endMs\t${text.replace('\t', ' ').replace('\n', ' ')}"
+
+    /** What one `WhisperJNI.pollTranscriptSegments` call returned. */
+    data class Poll(val segments: List<TranscriptSegment>, val done: Boolean, val failed: Boolean)
+
+    companion object {
+        fun parseLine(line: String): TranscriptSegment? {
+            val parts = line.split('\t', limit = 3)
+            if (parts.size != 3) return null
+            val start = parts[0].toLongOrNull() ?: return null
+            val end = parts[1].toLongOrNull() ?: return null
+            return TranscriptSegment(start, end, parts[2])
+        }
+
+        /** Segment lines, then possibly a last `done` or `failed` line. */
+        fun parsePoll(text: String): Poll {
+            val segments = mutableListOf<TranscriptSegment>()
+            var done = false
+            var failed = false
+            for (line in text.lineSequence()) {
+                when (line) {
+                    "" -> Unit
+                    "done" -> done = true
+                    "failed" -> failed = true
+                    else -> parseLine(line)?.let { segments.add(it) }
+                }
+            }
+            return Poll(segments, done, failed)
+        }
+    }
+}
+
+/**
+ * Long recordings queued for on-device transcription, kept in app storage
+ * so a job outlives the process that started it. Per job `<id>`:
+ *
+ *   <id>.name    display name of the recording
+ *   <id>.audio   copy of the recording (the native decoder reads paths, not URIs)
+ *   <id>.ckpt    the native checkpoint journal
+ *   <id>.txt     the finished transcript, one segment line each
+ *   <id>.failed  why it could not be transcribed
+ *
+ * A job is pending while its audio is there. The transcript is written
+ * before the audio and checkpoint are deleted, so a crash in between only
+ * leaves files to clean up, never a lost transcript.
+ */
+class TranscriptJobStore(private val root: File) {
+
+    data class Job(val id: String, val name: String, val audio: File, val checkpoint: File)
+
+    data class Finished(val id: String, val name: String, val segments: List<TranscriptSegment>, val error: String?)
+
+    /** Queue a recording; [write] copies its bytes. Returns null if it could not be stored. */
+    fun add(name: String, write: (OutputStream) -> Unit): Job? {
+        root.mkdirs()
+        var id = System.currentTimeMillis()
+        while (file("$id", NAME).exists()) id++
+        val job = job("$id", name)
+        val staging = file(job.id, "$AUDIO.tmp")
+        return try {
+            file(job.id, NAME).writeText(name)
+            staging.outputStream().use(write)
+            // Pending only once the copy is whole
+            if (!staging.renameTo(job.audio)) throw IllegalStateException("cannot rename ${staging.name}")
+            job
+        } catch (e: Exception) {
+            remove(job.id)
+            null
+        } finally {
+            staging.delete()
+        }
+    }
+
+    /** Jobs still to transcribe, oldest first. */
+    fun pending(): List<Job> = ids()
+        .filter { file(it, AUDIO).isFile && !file(it, TRANSCRIPT).exists() && !file(it, FAILED).exists() }
+        .map { job(it, file(it, NAME).readTextOrNull() ?: it) }
+
+    /** Finished and failed jobs, newest first. */
+    fun finished(): List<Finished> = ids().reversed().mapNotNull { id ->
+        val name = file(id, NAME).readTextOrNull() ?: id
+        val transcript = file(id, TRANSCRIPT)
+        val failed = file(id, FAILED)
+        when {
+            transcript.isFile -> Finished(
+                id, name, transcript.readLines().mapNotNull { TranscriptSegment.parseLine(it) }, null
+            )
+            failed.isFile -> Finished(id, name, emptyList(), failed.readTextOrNull() ?: "Failed")
+            else -> null
+        }
+    }
+
+    fun complete(job: Job, segments: List<TranscriptSegment>) {
+        val staging = file(job.id, "$TRANSCRIPT.tmp")
+        staging.writeText(segments.joinToString("") { it.toLine() + "\n" })
+        if (staging.renameTo(file(job.id, TRANSCRIPT))) {
+            job.audio.delete()
+            job.checkpoint.delete()
+        }
+    }
+
+    fun fail(job: Job, reason: String) {
+        file(job.id, FAILED).writeText(reason)
+        job.audio.delete()
+        job.checkpoint.delete()
+    }
+
+    fun remove(id: String) {
+        for (suffix in listOf(NAME, AUDIO, CHECKPOINT, TRANSCRIPT, FAILED)) file(id, suffix).delete()
+    }
+
+    private fun ids(): List<String> = (root.list() ?: emptyArray())
+        .filter { it.endsWith(".$NAME") }
+        .map { it.removeSuffix(".$NAME") }
+        .sortedBy { it.toLongOrNull() ?: Long.MAX_VALUE }
+
+    private fun job(id: String, name: String) = Job(id, name, file(id, AUDIO), file(id, CHECKPOINT))
+
+    private fun file(id: String, suffix: String) = File(root, "$id.$suffix")
+
+    private fun File.readTextOrNull(): String? = try { readText() } catch (e: Exception) { null }
+
+    companion object {
+        const val DIR = "transcriptions"
+        private const val NAME = "name"
+        private const val AUDIO = "audio"
+        private const val CHECKPOINT = "ckpt"
+        private const val TRANSCRIPT = "txt"
+        private const val FAILED = "failed"
+    }
+}
@@ -0,0 +1,133 @@
+package com.satory.graphenosai.audio
+
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+
+/**
+ * Native capture pipeline (voice_pipeline.cpp) built from a spec such as
+ * `"highpass cutoff_hz=80 | vad hangover_ms=800 | tap"`. Push each capture
+ * chunk, then [read] the processed audio for the recognizer and
+ * [pollEvents] for speech start/end. The same preprocessing, endpointing
+ * and per-stage timing apply whichever engine consumes the output.
+ */
+class VoicePipeline private constructor(private var handle: Long) : AutoCloseable {
+
+    enum class EventType { NONE, SPEECH_START, SPEECH_END, NO_SPEECH, RESULT }
+
+    /** Why the vad stage ended an utterance, in endpointer.h's order. */
+    enum class Reason { NONE, SILENCE, DECODER, NO_SPEECH, MAX_LENGTH }
+
+    data class Event(
+        val type: EventType,
+        val reason: Reason,
+        val delayMs: Int,
+        val positionMs: Int
+    )
+
+    companion object {
+        private const val TAG = "VoicePipeline"
+        const val SAMPLE_RATE = 16000
+        const val DEFAULT_FRAME_MS = 20
+        private const val EVENT_INTS = 4
+
+        /**
+         * Spec for the assistant's capture: DC/rumble removal, an endpointer
+         * when [hangoverMs] is set, and a tap the recognizer reads from.
+         */
+        fun captureSpec(hangoverMs: Int?): String = buildString {
+            append("highpass cutoff_hz=80")
+            if (hangoverMs != null) append(" | vad hangover_ms=$hangoverMs")
+            append(" | tap seconds=5")
+        }
+
+        /** Returns null if the native library is unavailable or the spec is invalid. */
+        fun create(spec: String, frameMs: Int = DEFAULT_FRAME_MS): VoicePipeline? {
+            if (!AssistantApplication.nativeLibsLoaded) {
+                Log.w(TAG, "Native library not loaded, using raw capture")
+                return null
+            }
+            val handle = nativeCreate(spec, SAMPLE_RATE, frameMs)
+            if (handle == 0L) {
+                Log.e(TAG, "Failed to build pipeline \"$spec\"")
+                return null
+            }
+            return VoicePipeline(handle)
+        }
+
+        @JvmStatic private external fun nativeCreate(spec: String, sampleRate: Int, frameMs: Int): Long
+        @JvmStatic private external fun nativePush(handle: Long, pcm: ByteArray, length: Int): Boolean
+        @JvmStatic private external fun nativeRead(handle: Long, out: ByteArray): Int
+        @JvmStatic private external fun nativePollEvents(handle: Long): IntArray
+        @JvmStatic private external fun nativeNotifyDecoderEndpoint(handle: Long)
+        @JvmStatic private external fun nativeFinish(handle: Long)
+        @JvmStatic private external fun nativeGetStats(handle: Long): String
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+    }
+
+    private var output = ByteArray(0)
+
+    /** Feed 16-bit little-endian PCM bytes; false once a stage has stopped the pipeline. */
+    @Synchronized
+    fun push(pcm: ByteArray, length: Int = pcm.size): Boolean {
+        if (handle == 0L) return false
+        return nativePush(handle, pcm, length)
+    }
+
+    /** Processed audio produced since the last call (16-bit PCM bytes), or null if none. */
+    @Synchronized
+    fun read(): ByteArray? {
+        if (handle == 0L) return null
+        if (output.isEmpty()) output = ByteArray(SAMPLE_RATE / 5 * 2)
+        val chunks = mutableListOf<ByteArray>()
+        while (true) {
+            val n = nativeRead(handle, output)
+            if (n <= 0) break
+            chunks.add(output.copyOf(n))
+            if (n < output.size) break
+        }
+        return when (chunks.size) {
+            0 -> null
+            1 -> chunks[0]
+            else -> chunks.reduce { acc, bytes -> acc + bytes }
+        }
+    }
+
+    @Synchronized
+    fun pollEvents(): List<Event> {
+        if (handle == 0L) return emptyList()
+        val flat = nativePollEvents(handle)
+        return (0 until flat.size / EVENT_INTS).map { i ->
+            val base = i * EVENT_INTS
+            Event(
+                type = EventType.entries.getOrElse(flat[base]) { EventType.NONE },
+                reason = Reason.entries.getOrElse(flat[base + 1]) { Reason.NONE },
+                delayMs = flat[base + 2],
+                positionMs = flat[base + 3]
+            )
+        }
+    }
+
+    /** The recognizer finalized an utterance; shortens the VAD stage's hangover. */
+    @Synchronized
+    fun notifyDecoderEndpoint() {
+        if (handle != 0L) nativeNotifyDecoderEndpoint(handle)
+    }
+
+    /** End of input: flush partial frames through every stage. */
+    @Synchronized
+    fun finish() {
+        if (handle != 0L) nativeFinish(handle)
+    }
+
+    /** Per-stage frame counts and processing time. */
+    val stats: String
+        @Synchronized get() = if (handle != 0L) nativeGetStats(handle) else ""
+
+    @Synchronized
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+}
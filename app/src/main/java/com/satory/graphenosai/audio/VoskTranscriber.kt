@@ -2,6 +2,7 @@ package com.satory.graphenosai.audio
 
 import android.content.Context
 import android.util.Log
+import com.satory.graphenosai.diagnostics.Tracing
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.channels.awaitClose
 import kotlinx.coroutines.flow.Flow
@@ -245,7 +246,7 @@ class VoskTranscriber(private val context: Context) {
             // Load model with low priority to reduce UI impact
             android.os.Process.setThreadPriority(android.os.Process.THREAD_PRIORITY_BACKGROUND)
             
-            model = Model(modelDir.absolutePath)
+            model = Tracing.section("vosk.loadModel") { Model(modelDir.absolutePath) }
             isModelLoaded = true
             currentLanguage = languageCode
             
@@ -316,7 +317,7 @@ class VoskTranscriber(private val context: Context) {
                 android.os.Process.setThreadPriority(android.os.Process.THREAD_PRIORITY_BACKGROUND)
                 
                 secondaryModel?.close()
-                secondaryModel = Model(secondaryModelDir.absolutePath)
+                secondaryModel = Tracing.section("vosk.loadModel") { Model(secondaryModelDir.absolutePath) }
                 secondaryLanguage = secondaryLanguageCode
                 isMultilingualEnabled = true
                 
@@ -462,14 +463,18 @@ class VoskTranscriber(private val context: Context) {
                 if (isMultilingualEnabled && secondaryModel != null) " + $secondaryLanguage (multilingual)" else "" +
                 ", file: ${audioFile.name}")
             
-            val audioBytes = readWavFile(audioFile)
+            val audioBytes = Tracing.section("vosk.readWav") { readWavFile(audioFile) }
             
             // Primary recognition
-            val primaryResult = recognizeWithModel(currentModel, audioBytes, "primary")
+            val primaryResult = Tracing.section("vosk.recognize") {
+                recognizeWithModel(currentModel, audioBytes, "primary")
+            }
             
             // If multilingual mode is enabled and primary result is poor, try secondary
             if (isMultilingualEnabled && secondaryModel != null) {
-                val secondaryResult = recognizeWithModel(secondaryModel!!, audioBytes, "secondary")
+                val secondaryResult = Tracing.section("vosk.recognize.secondary") {
+                    recognizeWithModel(secondaryModel!!, audioBytes, "secondary")
+                }
                 
                 // Combine results - use the one with more confidence/words
                 // or merge if both have content
@@ -493,6 +498,123 @@ class VoskTranscriber(private val context: Context) {
         }
     }
     
+    /**
+     * Recognize a short command restricted to [grammar]. Vosk only searches
+     * the grammar's phrases, and decoding stops as soon as the partial result
+     * leaves a single intent. Returns null when nothing in the grammar was said.
+     */
+    suspend fun recognizeCommand(audioFile: File, grammar: CommandGrammar): CommandGrammar.Match? =
+        withContext(Dispatchers.IO) {
+            val currentModel = model?.takeIf { isModelLoaded } ?: return@withContext null
+            try {
+                val audioBytes = readWavFile(audioFile)
+                val recognizer = Recognizer(currentModel, SAMPLE_RATE, grammar.voskGrammarJson())
+                recognizer.setWords(true)
+                try {
+                    // Small chunks so an early decision skips most of the clip
+                    val chunkSize = 3200
+                    var offset = 0
+                    var early: CommandGrammar.Phrase? = null
+                    while (offset < audioBytes.size && early == null) {
+                        val end = minOf(offset + chunkSize, audioBytes.size)
+                        Tracing.section("vosk.command.chunk") {
+                            recognizer.acceptWaveForm(audioBytes.copyOfRange(offset, end), end - offset)
+                        }
+                        offset = end
+                        early = grammar.resolvePrefix(
+                            JSONObject(recognizer.partialResult).optString("partial", ""))
+                    }
+                    commandMatch(grammar, JSONObject(recognizer.finalResult), early, offset < audioBytes.size)
+                } finally {
+                    recognizer.close()
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "Command recognition failed", e)
+                null
+            }
+        }
+
+    private fun commandMatch(
+        grammar: CommandGrammar,
+        result: JSONObject,
+        early: CommandGrammar.Phrase?,
+        stoppedEarly: Boolean
+    ): CommandGrammar.Match? {
+        val text = result.optString("text", "")
+        if (text.contains("[unk]")) return null
+        val phrase = grammar.match(text) ?: grammar.resolvePrefix(text) ?: early ?: return null
+
+        // Mean word confidence; out-of-grammar audio forced onto a phrase scores low
+        val words = result.optJSONArray("result")
+        var conf = 0.0
+        val n = words?.length() ?: 0
+        for (i in 0 until n) conf += words!!.getJSONObject(i).optDouble("conf", 0.0)
+        val score = if (n > 0) (conf / n).toFloat() else 0f
+
+        Log.i(TAG, "Command: ${phrase.intent} (\"$text\", $score${if (stoppedEarly) ", early" else ""})")
+        return CommandGrammar.Match(phrase.intent, phrase.text, score, stoppedEarly)
+    }
+
+    /**
+     * Start decoding live audio as it is captured, so the result is ready as
+     * soon as capture stops. Returns null when not ready or in multilingual
+     * mode (which compares two models over the whole recording).
+     */
+    fun startStream(): Stream? {
+        if (isMultilingualEnabled && secondaryModel != null) return null
+        val currentModel = model?.takeIf { isModelLoaded } ?: return null
+        return try {
+            Stream(Recognizer(currentModel, SAMPLE_RATE).apply {
+                setMaxAlternatives(0)
+                setWords(true)
+            })
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to start streaming recognizer", e)
+            null
+        }
+    }
+
+    /** Streaming recognizer over capture chunks; thread-safe. */
+    inner class Stream internal constructor(private val recognizer: Recognizer) : AutoCloseable {
+        private val segments = StringBuilder()
+        private var closed = false
+
+        /** Returns true when Vosk finalized an utterance (a decoder endpoint). */
+        @Synchronized
+        fun accept(chunk: ByteArray, length: Int = chunk.size): Boolean {
+            if (closed) return false
+            if (!recognizer.acceptWaveForm(chunk, length)) return false
+            appendSegment(recognizer.result)
+            return true
+        }
+
+        /** Flush the decoder and return the transcript in [transcribe]'s format. */
+        @Synchronized
+        fun finish(): String {
+            if (closed) return "[Transcription error: stream already finished]"
+            Tracing.section("vosk.finish") { appendSegment(recognizer.finalResult) }
+            close()
+            val text = segments.toString().trim()
+            Log.i(TAG, "Streaming transcription ($currentLanguage): $text")
+            return text.ifBlank { "[Could not transcribe audio - speak louder or closer to mic]" }
+        }
+
+        @Synchronized
+        override fun close() {
+            if (closed) return
+            closed = true
+            recognizer.close()
+        }
+
+        private fun appendSegment(resultJson: String) {
+            val text = JSONObject(resultJson).optString("text", "")
+            if (text.isNotBlank()) {
+                if (segments.isNotEmpty()) segments.append(' ')
+                segments.append(text.trim())
+            }
+        }
+    }
+    
     private fun recognizeWithModel(model: Model, audioBytes: ByteArray, label: String): String {
         val recognizer = Recognizer(model, SAMPLE_RATE)
         recognizer.setMaxAlternatives(0)
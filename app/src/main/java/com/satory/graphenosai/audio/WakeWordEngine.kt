@@ -0,0 +1,121 @@
+package com.satory.graphenosai.audio
+
+import android.content.Context
+import android.net.Uri
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+import java.io.File
+
+/**
+ * Kotlin handle for the native always-on keyword spotter (wake_word.cpp).
+ * Feed 16 kHz mono PCM from a single thread; the native side keeps a
+ * pre-roll ring so recognition can start with audio from before the trigger.
+ */
+class WakeWordEngine private constructor(private var handle: Long) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "WakeWordEngine"
+        const val SAMPLE_RATE = 16000
+        const val MODEL_DIR = "wakeword"
+        const val MODEL_FILE = "keyword.kws"
+        const val DEFAULT_PREROLL_MS = 1500
+
+        fun modelFile(context: Context): File = File(File(context.filesDir, MODEL_DIR), MODEL_FILE)
+
+        fun isModelInstalled(context: Context): Boolean = modelFile(context).isFile
+
+        /**
+         * Copy a keyword model ("KWS1", format in wake_word.h) picked in
+         * Settings from [uri] to [modelFile], replacing any installed one.
+         * The file must load; a rejected one leaves the old model in place.
+         * Blocking I/O: call off the main thread.
+         */
+        fun installModel(context: Context, uri: Uri): Boolean {
+            val target = modelFile(context)
+            val staging = File(target.parentFile, "$MODEL_FILE.tmp")
+            try {
+                target.parentFile?.mkdirs()
+                val input = context.contentResolver.openInputStream(uri) ?: return false
+                input.use { source -> staging.outputStream().use { source.copyTo(it) } }
+
+                val magic = ByteArray(4)
+                val read = staging.inputStream().use { it.read(magic) }
+                if (read != 4 || String(magic, Charsets.US_ASCII) != "KWS1") {
+                    Log.w(TAG, "Not a keyword model: $uri")
+                    return false
+                }
+                if (AssistantApplication.nativeLibsLoaded) {
+                    val handle = nativeCreate(staging.absolutePath, 0.5f, DEFAULT_PREROLL_MS)
+                    if (handle == 0L) {
+                        Log.w(TAG, "Keyword model failed to load: $uri")
+                        return false
+                    }
+                    nativeDestroy(handle)
+                }
+                if (!staging.renameTo(target)) {
+                    Log.e(TAG, "Cannot install wake word model at ${target.absolutePath}")
+                    return false
+                }
+                Log.i(TAG, "Installed wake word model (${target.length()} bytes)")
+                return true
+            } catch (e: Exception) {
+                Log.e(TAG, "Failed to import wake word model", e)
+                return false
+            } finally {
+                staging.delete()
+            }
+        }
+
+        /**
+         * Load the model from app storage. Returns null if the native library
+         * or the model is unavailable.
+         */
+        fun create(context: Context, threshold: Float, prerollMs: Int = DEFAULT_PREROLL_MS): WakeWordEngine? {
+            if (!AssistantApplication.nativeLibsLoaded) {
+                Log.w(TAG, "Native library not loaded, wake word disabled")
+                return null
+            }
+            val model = modelFile(context)
+            if (!model.isFile) {
+                Log.w(TAG, "No wake word model at ${model.absolutePath}")
+                return null
+            }
+            val handle = nativeCreate(model.absolutePath, threshold, prerollMs)
+            if (handle == 0L) {
+                Log.e(TAG, "Failed to load wake word model")
+                return null
+            }
+            return WakeWordEngine(handle)
+        }
+
+        @JvmStatic private external fun nativeCreate(modelPath: String, threshold: Float, prerollMs: Int): Long
+        @JvmStatic private external fun nativeProcess(handle: Long, pcm: ShortArray, length: Int): Boolean
+        @JvmStatic private external fun nativeGetPreroll(handle: Long): ShortArray
+        @JvmStatic private external fun nativeGetLastScore(handle: Long): Float
+        @JvmStatic private external fun nativeReset(handle: Long)
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+    }
+
+    /** Returns true if the keyword fired within this chunk. */
+    fun process(pcm: ShortArray, length: Int = pcm.size): Boolean {
+        if (handle == 0L) return false
+        return nativeProcess(handle, pcm, length)
+    }
+
+    /** Most recent pre-roll audio, oldest sample first. */
+    fun getPreroll(): ShortArray = if (handle != 0L) nativeGetPreroll(handle) else ShortArray(0)
+
+    val lastScore: Float
+        get() = if (handle != 0L) nativeGetLastScore(handle) else 0f
+
+    fun reset() {
+        if (handle != 0L) nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+}
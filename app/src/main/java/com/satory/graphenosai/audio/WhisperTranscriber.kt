@@ -1,12 +1,13 @@
 package com.satory.graphenosai.audio
 
 import android.util.Log
+import com.satory.graphenosai.util.Endpoints
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import org.json.JSONObject
 import java.io.File
+import java.net.HttpURLConnection
 import java.net.URL
-import javax.net.ssl.HttpsURLConnection
 
 /**
  * OpenAI Whisper API client for high-quality cloud speech-to-text.
@@ -43,11 +44,11 @@ class WhisperTranscriber(
         
         try {
             val url = when (provider) {
-                Provider.OPENAI -> URL(WHISPER_URL)
-                Provider.GROQ -> URL(GROQ_WHISPER_URL)
+                Provider.OPENAI -> URL(Endpoints.resolve(WHISPER_URL))
+                Provider.GROQ -> URL(Endpoints.resolve(GROQ_WHISPER_URL))
             }
             
-            val connection = url.openConnection() as HttpsURLConnection
+            val connection = url.openConnection() as HttpURLConnection
             val boundary = "----WebKitFormBoundary${System.currentTimeMillis()}"
             
             connection.apply {
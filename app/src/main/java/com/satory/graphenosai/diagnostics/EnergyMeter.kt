@@ -0,0 +1,63 @@
+package com.satory.graphenosai.diagnostics
+
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+import java.io.File
+
+/**
+ * Energy and CPU time per request, per engine (energy_meter.cpp). Joules
+ * come from integrating battery current x voltage over the request, split
+ * between requests that overlap, so they are whole-device figures for
+ * comparing engines and settings, and are unknown while charging. CPU time
+ * is the calling thread's and unknown when [end] runs on another thread
+ * than [begin]. The native whisper engine measures itself; this wraps the
+ * engines that run in Kotlin (Vosk, cloud ASR, chat turns).
+ */
+object EnergyMeter {
+
+    private const val TAG = "EnergyMeter"
+
+    data class Sample(
+        val joules: Float?,
+        val cpuSeconds: Float?,
+        val wallSeconds: Float,
+        val audioSeconds: Float
+    ) {
+        val cpuPerAudioSecond: Float? get() = cpuSeconds?.let { if (audioSeconds > 0f) it / audioSeconds else 0f }
+    }
+
+    /** Run [block] as one request of [engine]; [audioSeconds] is read after it returns (0 for a chat turn). */
+    inline fun <T> measure(engine: String, audioSeconds: () -> Float = { 0f }, block: () -> T): T {
+        val token = begin(engine)
+        try {
+            return block()
+        } finally {
+            end(token, audioSeconds())
+        }
+    }
+
+    /** Returns 0 when the native library is not loaded; [end] ignores that token. */
+    fun begin(engine: String): Long =
+        if (AssistantApplication.nativeLibsLoaded) nativeBegin(engine) else 0L
+
+    fun end(token: Long, audioSeconds: Float): Sample? {
+        if (token == 0L) return null
+        val out = FloatArray(5)
+        if (!nativeEnd(token, audioSeconds, out)) return null
+        return Sample(if (out[1] > 0f) out[0] else null, if (out[3] > 0f) out[2] else null, out[4], audioSeconds).also {
+            Log.d(TAG, "Request: ${it.joules?.let { j -> "%.2f J".format(j) } ?: "energy unknown"}, " +
+                "${it.cpuSeconds?.let { c -> "%.3f CPU s".format(c) } ?: "CPU unknown"}, %.2f s".format(it.wallSeconds))
+        }
+    }
+
+    /** One line per engine: J/request, J and CPU seconds per audio second. */
+    fun report(): String = if (AssistantApplication.nativeLibsLoaded) nativeReport() else ""
+
+    /** Length of a 16-bit PCM WAV as written by the capture path (44-byte header). */
+    fun wavSeconds(file: File, sampleRate: Int = 16000, channels: Int = 1): Float =
+        ((file.length() - 44).coerceAtLeast(0L) / (2f * channels * sampleRate))
+
+    @JvmStatic private external fun nativeBegin(engine: String): Long
+    @JvmStatic private external fun nativeEnd(token: Long, audioSeconds: Float, out: FloatArray): Boolean
+    @JvmStatic private external fun nativeReport(): String
+}
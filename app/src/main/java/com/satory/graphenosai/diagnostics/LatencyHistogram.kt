@@ -0,0 +1,95 @@
+package com.satory.graphenosai.diagnostics
+
+/**
+ * Latency histogram in the style of HdrHistogram: exact below 128 ms, then
+ * 64 linear buckets per power of two, so any recorded value is reported
+ * within 1.6% up to [MAX_VALUE_MS]. Memory is fixed (about 9 KB) however
+ * many values are recorded. Not thread-safe; [LatencyMetrics] guards it.
+ */
+class LatencyHistogram {
+
+    companion object {
+        private const val SUB_BUCKET_BITS = 7
+        private const val SUB_BUCKETS = 1 shl SUB_BUCKET_BITS
+        private const val HALF_BUCKETS = SUB_BUCKETS / 2
+
+        /** Larger values are recorded as this (one hour). */
+        const val MAX_VALUE_MS = 3_600_000L
+
+        private val BUCKET_COUNT = indexOf(MAX_VALUE_MS) + 1
+
+        private fun indexOf(value: Long): Int {
+            if (value < SUB_BUCKETS) return value.toInt()
+            val shift = (63 - java.lang.Long.numberOfLeadingZeros(value)) - (SUB_BUCKET_BITS - 1)
+            val sub = (value ushr shift).toInt()
+            return SUB_BUCKETS + (shift - 1) * HALF_BUCKETS + (sub - HALF_BUCKETS)
+        }
+
+        /** Smallest and largest value that land in bucket [index]. */
+        private fun rangeOf(index: Int): LongRange {
+            if (index < SUB_BUCKETS) return index.toLong()..index.toLong()
+            val shift = (index - SUB_BUCKETS) / HALF_BUCKETS + 1
+            val sub = (index - SUB_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS
+            val low = sub.toLong() shl shift
+            return low until low + (1L shl shift)
+        }
+    }
+
+    private val counts = LongArray(BUCKET_COUNT)
+
+    var count = 0L
+        private set
+    var min = 0L
+        private set
+    var max = 0L
+        private set
+    private var sum = 0L
+
+    val mean: Double get() = if (count > 0) sum.toDouble() / count else 0.0
+
+    fun record(valueMs: Long) {
+        val value = valueMs.coerceIn(0L, MAX_VALUE_MS)
+        counts[indexOf(value)]++
+        if (count == 0L || value < min) min = value
+        if (value > max) max = value
+        sum += value
+        count++
+    }
+
+    fun add(other: LatencyHistogram) {
+        if (other.count == 0L) return
+        for (i in counts.indices) counts[i] += other.counts[i]
+        if (count == 0L || other.min < min) min = other.min
+        if (other.max > max) max = other.max
+        sum += other.sum
+        count += other.count
+    }
+
+    fun clear() {
+        counts.fill(0L)
+        count = 0L
+        min = 0L
+        max = 0L
+        sum = 0L
+    }
+
+    /**
+     * Value at [percentile] (0..100): the midpoint of the bucket holding that
+     * rank, clamped to the recorded min and max (the max itself for the
+     * top bucket). 0 when empty.
+     */
+    fun percentile(percentile: Double): Long {
+        if (count == 0L) return 0L
+        val rank = Math.ceil(percentile.coerceIn(0.0, 100.0) / 100.0 * count).toLong().coerceAtLeast(1L)
+        var seen = 0L
+        for (i in counts.indices) {
+            seen += counts[i]
+            if (seen >= rank) {
+                if (seen == count) return max
+                val range = rangeOf(i)
+                return ((range.first + range.last) / 2).coerceIn(min, max)
+            }
+        }
+        return max
+    }
+}
@@ -0,0 +1,135 @@
+package com.satory.graphenosai.diagnostics
+
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Fixed-size ring of latency samples on disk, so percentiles survive
+ * restarts and cover days of use. Once [capacity] samples are stored the
+ * oldest are overwritten; at 16 bytes per sample the default ring is
+ * 256 KB and holds a few weeks of typical use.
+ *
+ * Layout (little-endian): a 24-byte header
+ *   magic "LATR", version u16, record size u16, capacity u32,
+ *   reserved u32, total records written u64
+ * then [capacity] records of
+ *   wall-clock time ms i64, latency ms i32, stage u16, reserved u16.
+ * A file with another magic, version or capacity is started afresh.
+ */
+class LatencyLog(private val file: File, val capacity: Int = DEFAULT_CAPACITY) {
+
+    companion object {
+        const val DEFAULT_CAPACITY = 16384
+
+        private const val MAGIC = 0x5254414C // "LATR"
+        private const val VERSION = 1
+        private const val HEADER_SIZE = 24
+        private const val RECORD_SIZE = 16
+        private const val WRITTEN_OFFSET = 16L
+    }
+
+    data class Record(val timeMs: Long, val latencyMs: Int, val stage: Int)
+
+    private var raf: RandomAccessFile? = null
+    private var written = 0L
+    private val record = ByteBuffer.allocate(RECORD_SIZE).order(ByteOrder.LITTLE_ENDIAN)
+    private val counter = ByteBuffer.allocate(8).order(ByteOrder.LITTLE_ENDIAN)
+
+    /** Total samples ever appended, including the overwritten ones. */
+    val totalWritten: Long
+        @Synchronized get() {
+            open()
+            return written
+        }
+
+    /** Samples currently held. */
+    val size: Int
+        @Synchronized get() = minOf(totalWritten, capacity.toLong()).toInt()
+
+    @Synchronized
+    fun append(timeMs: Long, latencyMs: Int, stage: Int) {
+        val out = open()
+        record.clear()
+        record.putLong(timeMs).putInt(latencyMs).putShort(stage.toShort()).putShort(0)
+        out.seek(HEADER_SIZE + (written % capacity) * RECORD_SIZE)
+        out.write(record.array())
+        written++
+        counter.clear()
+        counter.putLong(written)
+        out.seek(WRITTEN_OFFSET)
+        out.write(counter.array())
+    }
+
+    /** Held samples, oldest first. */
+    @Synchronized
+    fun read(): List<Record> {
+        val input = open()
+        val n = size
+        if (n == 0) return emptyList()
+        // One read of the whole ring, then walk it from the oldest slot
+        val bytes = ByteArray(n * RECORD_SIZE)
+        input.seek(HEADER_SIZE.toLong())
+        input.readFully(bytes)
+        val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+        val first = if (written > capacity) (written % capacity).toInt() else 0
+        return List(n) { i ->
+            val at = ((first + i) % n) * RECORD_SIZE
+            Record(buffer.getLong(at), buffer.getInt(at + 8), buffer.getShort(at + 12).toInt())
+        }
+    }
+
+    @Synchronized
+    fun clear() {
+        close()
+        file.delete()
+    }
+
+    @Synchronized
+    fun close() {
+        try {
+            raf?.close()
+        } catch (e: IOException) {
+            // Nothing buffered; every append is already written through
+        }
+        raf = null
+        written = 0L
+    }
+
+    private fun open(): RandomAccessFile {
+        raf?.let { return it }
+        file.parentFile?.mkdirs()
+        val out = RandomAccessFile(file, "rw")
+        written = readHeader(out) ?: run {
+            out.setLength(0L)
+            writeHeader(out)
+            0L
+        }
+        raf = out
+        return out
+    }
+
+    private fun readHeader(input: RandomAccessFile): Long? {
+        if (input.length() < HEADER_SIZE) return null
+        val header = ByteArray(HEADER_SIZE)
+        input.seek(0L)
+        input.readFully(header)
+        val buffer = ByteBuffer.wrap(header).order(ByteOrder.LITTLE_ENDIAN)
+        if (buffer.getInt(0) != MAGIC || buffer.getShort(4).toInt() != VERSION ||
+            buffer.getShort(6).toInt() != RECORD_SIZE || buffer.getInt(8) != capacity) return null
+        val count = buffer.getLong(16)
+        // A torn write can leave the counter ahead of the records
+        val held = (input.length() - HEADER_SIZE) / RECORD_SIZE
+        return if (count < 0 || minOf(count, capacity.toLong()) > held) null else count
+    }
+
+    private fun writeHeader(out: RandomAccessFile) {
+        val header = ByteBuffer.allocate(HEADER_SIZE).order(ByteOrder.LITTLE_ENDIAN)
+        header.putInt(MAGIC).putShort(VERSION.toShort()).putShort(RECORD_SIZE.toShort())
+            .putInt(capacity).putInt(0).putLong(0L)
+        out.seek(0L)
+        out.write(header.array())
+    }
+}
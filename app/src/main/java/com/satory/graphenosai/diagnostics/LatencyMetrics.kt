@@ -0,0 +1,115 @@
+package com.satory.graphenosai.diagnostics
+
+import android.util.Log
+import java.io.File
+import java.io.IOException
+
+/**
+ * Voice-to-answer latency per stage of a turn, kept across restarts in a
+ * [LatencyLog] ring file and summarized as [LatencyHistogram]s for the
+ * diagnostics screen. [record] is cheap enough for the hot path: one
+ * histogram update and a 16-byte write.
+ */
+object LatencyMetrics {
+
+    private const val TAG = "LatencyMetrics"
+    private const val FILE_NAME = "latency.ring"
+
+    /** Stages of one turn; [id] is stored in the ring file, so never renumber. */
+    enum class Stage(val id: Int, val label: String) {
+        TRIGGER_TO_LISTENING(0, "Trigger → listening"),
+        SPEECH_END_TO_TRANSCRIPT(1, "End of speech → transcript"),
+        TRANSCRIPT_TO_FIRST_TOKEN(2, "Transcript → first token"),
+        FIRST_TO_LAST_TOKEN(3, "First → last token"),
+        FIRST_TOKEN_TO_FIRST_AUDIO(4, "First token → first audio");
+
+        companion object {
+            fun fromId(id: Int): Stage? = values().firstOrNull { it.id == id }
+        }
+    }
+
+    data class Summary(
+        val stage: Stage,
+        val count: Long,
+        val p50: Long,
+        val p90: Long,
+        val p99: Long,
+        val max: Long,
+        val mean: Double
+    )
+
+    private var log: LatencyLog? = null
+    // What the ring held when opened plus everything recorded since
+    private val histograms = Stage.values().associateWith { LatencyHistogram() }
+
+    /** Open (or create) the ring in [dir]; until then samples are only kept in memory. */
+    @Synchronized
+    fun open(dir: File, capacity: Int = LatencyLog.DEFAULT_CAPACITY) {
+        log?.close()
+        histograms.values.forEach { it.clear() }
+        val ring = LatencyLog(File(dir, FILE_NAME), capacity)
+        try {
+            for (record in ring.read()) {
+                Stage.fromId(record.stage)?.let { histograms.getValue(it).record(record.latencyMs.toLong()) }
+            }
+        } catch (e: IOException) {
+            Log.w(TAG, "Latency log unreadable, starting afresh", e)
+            ring.clear()
+        }
+        log = ring
+    }
+
+    @Synchronized
+    fun record(stage: Stage, latencyMs: Long, nowMs: Long = System.currentTimeMillis()) {
+        if (latencyMs < 0) return
+        histograms.getValue(stage).record(latencyMs)
+        try {
+            log?.append(nowMs, latencyMs.coerceAtMost(Int.MAX_VALUE.toLong()).toInt(), stage.id)
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot append to latency log", e)
+        }
+    }
+
+    /**
+     * Percentiles per stage over samples recorded since [sinceMs] (wall-clock;
+     * 0 for everything still in the ring).
+     */
+    @Synchronized
+    fun summaries(sinceMs: Long = 0L): List<Summary> {
+        val source = if (sinceMs <= 0L) histograms else windowed(sinceMs)
+        return Stage.values().map { stage ->
+            val histogram = source.getValue(stage)
+            Summary(stage, histogram.count, histogram.percentile(50.0), histogram.percentile(90.0),
+                histogram.percentile(99.0), histogram.max, histogram.mean)
+        }
+    }
+
+    /** Samples held in the ring file (0 before [open]). */
+    @Synchronized
+    fun storedSamples(): Int = try {
+        log?.size ?: 0
+    } catch (e: IOException) {
+        0
+    }
+
+    @Synchronized
+    fun clear() {
+        log?.clear()
+        histograms.values.forEach { it.clear() }
+    }
+
+    private fun windowed(sinceMs: Long): Map<Stage, LatencyHistogram> {
+        val window = Stage.values().associateWith { LatencyHistogram() }
+        val records = try {
+            log?.read().orEmpty()
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot read latency log", e)
+            emptyList()
+        }
+        for (record in records) {
+            if (record.timeMs < sinceMs) continue
+            Stage.fromId(record.stage)?.let { window.getValue(it).record(record.latencyMs.toLong()) }
+        }
+        return window
+    }
+}
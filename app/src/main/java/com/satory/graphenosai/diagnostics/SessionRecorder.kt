@@ -0,0 +1,182 @@
+package com.satory.graphenosai.diagnostics
+
+import android.os.SystemClock
+import android.util.Log
+import java.io.File
+import java.io.FileOutputStream
+import java.io.IOException
+import java.io.Writer
+import java.text.SimpleDateFormat
+import java.util.Date
+import java.util.Locale
+
+/**
+ * Records voice turns for offline replay (app/src/test/cpp/session_replay):
+ * the captured audio, what was recognized and asked, and the chat API's raw
+ * SSE stream with the time each line arrived. One directory per turn:
+ *
+ *   session.tsv        t_ms <TAB> event <TAB> detail, t_ms since the trigger
+ *   audio.wav          the capture as handed to the recognizer
+ *   llm_request.json   the chat request body
+ *   llm_response.sse   the response body, one SSE line per "\n"
+ *   llm_response.tsv   t_ms <TAB> end offset in llm_response.sse, per line,
+ *                      t_ms since the request was sent
+ *
+ * Details escape tab, newline and backslash as \t, \n and \\. A session
+ * stays open after [COMPLETE] so late events (TTS starting) still land in
+ * it; the next [begin], [close] or turning [enabled] off ends it. Off unless enabled in settings:
+ * sessions hold the user's voice and conversation.
+ */
+object SessionRecorder {
+
+    private const val TAG = "SessionRecorder"
+    private const val FORMAT_HEADER = "# assistant session v1"
+    private const val MAX_SESSIONS = 50
+
+    /** Events written to session.tsv; session_replay reads these names. */
+    const val TRIGGER = "trigger"
+    const val PIPELINE = "pipeline"
+    const val LISTENING = "listening"
+    const val SPEECH_END = "speech_end"
+    const val CAPTURE_STOP = "capture_stop"
+    const val TRANSCRIPT = "transcript"
+    const val QUERY = "query"
+    const val REQUEST = "request"
+    const val FIRST_TOKEN = "first_token"
+    const val LAST_TOKEN = "last_token"
+    const val FIRST_AUDIO = "first_audio"
+    const val COMPLETE = "complete"
+    const val ERROR = "error"
+
+    /** Turning recording off ends the open session at once instead of at the next [begin]. */
+    @Volatile var enabled = false
+        set(value) {
+            field = value
+            if (!value) finish()
+        }
+
+    @Volatile private var dir: File? = null
+    private var events: Writer? = null
+    private var sse: FileOutputStream? = null
+    private var sseTiming: Writer? = null
+    private var startedAtMs = 0L
+    private var requestAtMs = 0L
+    private var sseBytes = 0L
+    private var completed = false
+
+    /** Start a session under [root] (closing any open one), timed from now. */
+    @Synchronized
+    fun begin(root: File) {
+        if (!enabled) return
+        closeLocked()
+        val name = SimpleDateFormat("yyyyMMdd-HHmmss-SSS", Locale.US).format(Date())
+        val session = File(root, name)
+        try {
+            if (!session.mkdirs()) throw IOException("cannot create $session")
+            prune(root)
+            events = File(session, "session.tsv").bufferedWriter().also { it.write("$FORMAT_HEADER\n") }
+            dir = session
+            startedAtMs = SystemClock.elapsedRealtime()
+            completed = false
+            eventLocked(TRIGGER, "")
+            Log.i(TAG, "Recording session to $session")
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot start session recording", e)
+            closeLocked()
+        }
+    }
+
+    @Synchronized
+    fun event(name: String, detail: String = "") {
+        if (dir != null) eventLocked(name, detail)
+    }
+
+    /** Copy the capture the recognizer is about to read. */
+    @Synchronized
+    fun audio(wav: File) {
+        val session = dir ?: return
+        try {
+            wav.copyTo(File(session, "audio.wav"), overwrite = true)
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot copy session audio", e)
+        }
+    }
+
+    /** The chat request is about to be sent; SSE line times are relative to this. */
+    @Synchronized
+    fun request(body: String) {
+        val session = dir ?: return
+        try {
+            File(session, "llm_request.json").writeText(body)
+            sse?.close()
+            sseTiming?.close()
+            sse = FileOutputStream(File(session, "llm_response.sse"))
+            sseTiming = File(session, "llm_response.tsv").bufferedWriter()
+            sseBytes = 0L
+            requestAtMs = SystemClock.elapsedRealtime()
+            eventLocked(REQUEST, "")
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot record request", e)
+        }
+    }
+
+    /** One line of the response body as read (without its line terminator). */
+    @Synchronized
+    fun sseLine(line: String) {
+        val out = sse ?: return
+        try {
+            val bytes = (line + "\n").toByteArray(Charsets.UTF_8)
+            out.write(bytes)
+            sseBytes += bytes.size
+            sseTiming?.write("${SystemClock.elapsedRealtime() - requestAtMs}\t$sseBytes\n")
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot record SSE line", e)
+            sse = null
+        }
+    }
+
+    @Synchronized
+    fun close() = closeLocked()
+
+    /** Close an open session, marking it cut short unless the turn had already completed. */
+    @Synchronized
+    private fun finish() {
+        if (dir == null) return
+        if (!completed) eventLocked(ERROR, "recording turned off")
+        closeLocked()
+    }
+
+    private fun eventLocked(name: String, detail: String) {
+        if (name == COMPLETE || name == ERROR) completed = true
+        try {
+            events?.write("${SystemClock.elapsedRealtime() - startedAtMs}\t$name\t${escape(detail)}\n")
+            events?.flush()
+            sseTiming?.flush()
+        } catch (e: IOException) {
+            Log.w(TAG, "Cannot record event $name", e)
+        }
+    }
+
+    private fun closeLocked() {
+        for (closeable in listOf(events, sse, sseTiming)) {
+            try {
+                closeable?.close()
+            } catch (e: IOException) {
+                Log.w(TAG, "Cannot close session file", e)
+            }
+        }
+        events = null
+        sse = null
+        sseTiming = null
+        dir = null
+    }
+
+    /** Keep the newest [MAX_SESSIONS] sessions; names sort by time. */
+    private fun prune(root: File) {
+        val sessions = root.listFiles { file -> file.isDirectory }?.sortedBy { it.name } ?: return
+        sessions.dropLast(MAX_SESSIONS).forEach { it.deleteRecursively() }
+    }
+
+    private fun escape(text: String): String =
+        text.replace("\\", "\\\\").replace("\t", "\\t").replace("\n", "\\n")
+}
@@ -0,0 +1,51 @@
+package com.satory.graphenosai.diagnostics
+
+import android.os.Build
+import android.os.Trace
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Trace sections for Perfetto/systrace, next to the native ATrace sections
+ * (trace.h): a capture with the "app" category shows capture, WAV
+ * conversion, recognition, network and TTS on one timeline.
+ *
+ * [section] is for code that stays on one thread. Work that suspends or
+ * hops threads uses [async] (or [beginAsync]/[endAsync]), which needs API
+ * 29 and is skipped on older releases.
+ */
+object Tracing {
+
+    private val cookies = AtomicInteger()
+
+    // ATrace truncates longer names
+    const val MAX_NAME = 127
+
+    inline fun <T> section(name: String, block: () -> T): T {
+        Trace.beginSection(name.take(MAX_NAME))
+        try {
+            return block()
+        } finally {
+            Trace.endSection()
+        }
+    }
+
+    /** Start a span that may end on another thread; pass the cookie to [endAsync]. */
+    fun beginAsync(name: String): Int {
+        val cookie = cookies.incrementAndGet()
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) Trace.beginAsyncSection(name.take(MAX_NAME), cookie)
+        return cookie
+    }
+
+    fun endAsync(name: String, cookie: Int) {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) Trace.endAsyncSection(name.take(MAX_NAME), cookie)
+    }
+
+    inline fun <T> async(name: String, block: () -> T): T {
+        val cookie = beginAsync(name)
+        try {
+            return block()
+        } finally {
+            endAsync(name, cookie)
+        }
+    }
+}
@@ -0,0 +1,62 @@
+package com.satory.graphenosai.intent
+
+import android.util.Log
+import com.satory.graphenosai.AssistantApplication
+
+/**
+ * Native n-gram intent classifier (intent_classifier.cpp), trained at
+ * creation from "intent<TAB>example" lines.
+ */
+class IntentClassifier private constructor(
+    private var handle: Long,
+    private val intents: List<String>
+) : AutoCloseable {
+
+    /** Best intent for a text; [margin] is the log-posterior gap to the runner-up. */
+    data class Result(val intent: String, val probability: Float, val margin: Float)
+
+    companion object {
+        private const val TAG = "IntentClassifier"
+
+        /** Returns null if the native library is not available or the spec is invalid. */
+        fun create(spec: String): IntentClassifier? {
+            if (!AssistantApplication.nativeLibsLoaded) {
+                Log.w(TAG, "Native library not loaded, intent classifier disabled")
+                return null
+            }
+            val handle = nativeCreate(spec)
+            return if (handle != 0L) IntentClassifier(handle, intentNames(spec)) else null
+        }
+
+        /** Intent names in native id order: first appearance in the spec. */
+        internal fun intentNames(spec: String): List<String> =
+            spec.lineSequence()
+                .filter { it.isNotBlank() && !it.startsWith("#") }
+                .map { it.substringBefore('\t') }
+                .distinct()
+                .toList()
+
+        @JvmStatic private external fun nativeCreate(spec: String): Long
+        @JvmStatic private external fun nativeClassify(handle: Long, text: String, out: FloatArray): Int
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+    }
+
+    private val scores = FloatArray(2)
+
+    /** Null when no word of [text] was seen in training. */
+    @Synchronized
+    fun classify(text: String): Result? {
+        if (handle == 0L) return null
+        val id = nativeClassify(handle, text, scores)
+        if (id < 0 || id >= intents.size) return null
+        return Result(intents[id], scores[0], scores[1])
+    }
+
+    @Synchronized
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+}
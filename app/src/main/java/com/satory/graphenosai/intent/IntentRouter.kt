@@ -0,0 +1,255 @@
+package com.satory.graphenosai.intent
+
+import com.satory.graphenosai.audio.CommandGrammar
+
+/**
+ * On-device fast path for simple device actions, checked on the transcript
+ * before any network request.
+ *
+ * Two stages: a word trie built from command patterns
+ * ("(open|launch) [the] {site}") that matches exactly and extracts slots,
+ * then the native [IntentClassifier] for paraphrases of actions that need
+ * no argument ("could you switch the torch on"). Naive Bayes ignores words
+ * it never saw, so "turn on wifi" scores like "turn on"; a classifier hit
+ * therefore also needs one of the action's [KEYWORDS] and must not be a
+ * question. Anything that is not a confident match returns null and goes
+ * to the LLM as before.
+ *
+ * [apps] maps a spoken app name to something launchable (a package name),
+ * or null if no such app is installed, so "open the pod bay doors" is not
+ * mistaken for an app launch.
+ */
+class IntentRouter(
+    private val classifier: Classifier? = null,
+    private val apps: (String) -> String? = { it },
+    private val minProbability: Float = DEFAULT_MIN_PROBABILITY,
+    private val minMargin: Float = DEFAULT_MIN_MARGIN
+) {
+
+    enum class Action(val needsArgument: Boolean) {
+        OPEN_SITE(true),
+        OPEN_APP(true),
+        FLASHLIGHT_ON(false),
+        FLASHLIGHT_OFF(false)
+    }
+
+    enum class Source { RULE, CLASSIFIER }
+
+    /** A resolved action; [argument] is the site URL or what [apps] returned for the app name. */
+    data class Resolved(val action: Action, val argument: String?, val source: Source, val confidence: Float)
+
+    fun interface Classifier {
+        fun classify(text: String): IntentClassifier.Result?
+    }
+
+    data class Stats(
+        val queries: Long,
+        val ruleHits: Long,
+        val classifierHits: Long,
+        val totalLatencyNs: Long,
+        val maxLatencyNs: Long
+    ) {
+        val hits: Long get() = ruleHits + classifierHits
+        val hitRate: Float get() = if (queries > 0) hits.toFloat() / queries else 0f
+        val meanLatencyUs: Long get() = if (queries > 0) totalLatencyNs / queries / 1000 else 0
+    }
+
+    companion object {
+        const val DEFAULT_MIN_PROBABILITY = 0.9f
+        const val DEFAULT_MIN_MARGIN = 2.0f
+        const val NO_INTENT = "none"
+
+        /** Spoken site name -> URL for OPEN_SITE. */
+        val SITES = mapOf(
+            "youtube" to "https://www.youtube.com",
+            "ютуб" to "https://www.youtube.com",
+            "wikipedia" to "https://www.wikipedia.org",
+            "википедия" to "https://www.wikipedia.org",
+            "википедию" to "https://www.wikipedia.org",
+            "github" to "https://github.com",
+            "reddit" to "https://www.reddit.com",
+            "google maps" to "https://www.google.com/maps",
+            "openstreetmap" to "https://www.openstreetmap.org",
+            "duckduckgo" to "https://duckduckgo.com"
+        )
+
+        val RULES = listOf(
+            Action.OPEN_SITE to "[please] (open|launch|go to|show me) [the] {site} [website|site] [please]",
+            Action.OPEN_SITE to "(открой|запусти) {site}",
+            Action.OPEN_APP to "[please] (open|launch|start) [the] {app} [app] [please]",
+            Action.OPEN_APP to "(открой|запусти) [приложение] {app}",
+            Action.FLASHLIGHT_ON to "[please] turn (on [the] (flashlight|torch)|[the] (flashlight|torch) on) [please]",
+            Action.FLASHLIGHT_ON to "(flashlight|torch) on",
+            Action.FLASHLIGHT_ON to "включи фонарик",
+            Action.FLASHLIGHT_OFF to "[please] turn (off [the] (flashlight|torch)|[the] (flashlight|torch) off) [please]",
+            Action.FLASHLIGHT_OFF to "(flashlight|torch) off",
+            Action.FLASHLIGHT_OFF to "выключи фонарик"
+        )
+
+        private val FLASHLIGHT_WORDS = setOf("flashlight", "torch", "фонарик", "фонарь")
+
+        /** A classifier hit must contain one of these words; actions without an entry never come from it. */
+        val KEYWORDS = mapOf(
+            Action.FLASHLIGHT_ON to FLASHLIGHT_WORDS,
+            Action.FLASHLIGHT_OFF to FLASHLIGHT_WORDS
+        )
+
+        /** First words of a question about an action rather than a request for it. */
+        val QUESTION_WORDS = setOf(
+            "how", "what", "why", "when", "where", "which", "who", "does", "is",
+            "как", "что", "почему", "зачем", "где", "когда"
+        )
+
+        /**
+         * Training examples for the native classifier: paraphrases of the
+         * argument-free actions, plus ordinary questions and requests for
+         * other switches as the [NO_INTENT] catch-all, including some that
+         * share their words.
+         */
+        val CLASSIFIER_EXAMPLES = listOf(
+            "FLASHLIGHT_ON" to "turn on the flashlight",
+            "FLASHLIGHT_ON" to "switch the torch on",
+            "FLASHLIGHT_ON" to "can you turn on my flashlight",
+            "FLASHLIGHT_ON" to "i need the flashlight",
+            "FLASHLIGHT_ON" to "enable the flashlight",
+            "FLASHLIGHT_ON" to "torch on please",
+            "FLASHLIGHT_ON" to "включи фонарик",
+            "FLASHLIGHT_ON" to "включи фонарик на телефоне",
+            "FLASHLIGHT_OFF" to "turn off the flashlight",
+            "FLASHLIGHT_OFF" to "switch the torch off",
+            "FLASHLIGHT_OFF" to "can you turn my flashlight off",
+            "FLASHLIGHT_OFF" to "disable the flashlight",
+            "FLASHLIGHT_OFF" to "torch off please",
+            "FLASHLIGHT_OFF" to "выключи фонарик",
+            "FLASHLIGHT_OFF" to "выключи фонарик на телефоне",
+            NO_INTENT to "turn on bluetooth",
+            NO_INTENT to "turn off the wifi",
+            NO_INTENT to "turn on the lights in the kitchen",
+            NO_INTENT to "switch off the alarm",
+            NO_INTENT to "enable dark mode",
+            NO_INTENT to "turn on captions",
+            NO_INTENT to "how do i turn on the torch",
+            NO_INTENT to "some light music please",
+            NO_INTENT to "включи свет в спальне",
+            NO_INTENT to "выключи будильник",
+            NO_INTENT to "what is the capital of france",
+            NO_INTENT to "how do i cook rice",
+            NO_INTENT to "why is the sky blue",
+            NO_INTENT to "how does a flashlight work",
+            NO_INTENT to "what is the best flashlight to buy",
+            NO_INTENT to "write a poem about the sea",
+            NO_INTENT to "what is the weather tomorrow",
+            NO_INTENT to "explain how light travels",
+            NO_INTENT to "tell me a joke",
+            NO_INTENT to "who wrote war and peace",
+            NO_INTENT to "translate this to german",
+            NO_INTENT to "summarize this article",
+            NO_INTENT to "что такое фонарик",
+            NO_INTENT to "как приготовить борщ",
+            NO_INTENT to "расскажи анекдот"
+        )
+
+        /** [CLASSIFIER_EXAMPLES] in the native "intent<TAB>text" format. */
+        fun classifierSpec(): String = CLASSIFIER_EXAMPLES.joinToString("\n") { "${it.first}\t${it.second}" }
+    }
+
+    private class Node {
+        val children = HashMap<String, Node>()
+        val slots = mutableListOf<Pair<String, Node>>()
+        var action: Action? = null
+    }
+
+    private val root = Node()
+
+    private var queries = 0L
+    private var ruleHits = 0L
+    private var classifierHits = 0L
+    private var totalLatencyNs = 0L
+    private var maxLatencyNs = 0L
+
+    init {
+        for ((action, pattern) in RULES) {
+            for (expansion in CommandGrammar.expandRaw(pattern)) add(action, expansion.split(' '))
+        }
+    }
+
+    private fun add(action: Action, words: List<String>) {
+        var node = root
+        for (word in words) {
+            node = if (word.startsWith("{") && word.endsWith("}")) {
+                val name = word.substring(1, word.length - 1)
+                node.slots.firstOrNull { it.first == name }?.second
+                    ?: Node().also { node.slots += name to it }
+            } else {
+                node.children.getOrPut(CommandGrammar.normalize(word)) { Node() }
+            }
+        }
+        if (node.action == null) node.action = action
+    }
+
+    /** Resolve [text] to a local action, or null to fall through to the LLM. */
+    fun route(text: String): Resolved? {
+        val start = System.nanoTime()
+        val resolved = matchRules(text) ?: classify(text)
+        record(resolved, System.nanoTime() - start)
+        return resolved
+    }
+
+    @Synchronized
+    fun stats(): Stats = Stats(queries, ruleHits, classifierHits, totalLatencyNs, maxLatencyNs)
+
+    private fun matchRules(text: String): Resolved? {
+        val words = CommandGrammar.normalize(text).split(' ').filter { it.isNotEmpty() }
+        if (words.isEmpty()) return null
+        return match(root, words, 0, null)
+    }
+
+    /** Depth-first over literal words first, then slots of growing length. */
+    private fun match(node: Node, words: List<String>, i: Int, argument: String?): Resolved? {
+        if (i == words.size) {
+            return node.action?.let { Resolved(it, argument, Source.RULE, 1f) }
+        }
+        node.children[words[i]]?.let { child ->
+            match(child, words, i + 1, argument)?.let { return it }
+        }
+        for ((name, child) in node.slots) {
+            for (end in i + 1..words.size) {
+                val value = slotValue(name, words.subList(i, end).joinToString(" ")) ?: continue
+                match(child, words, end, value)?.let { return it }
+            }
+        }
+        return null
+    }
+
+    /** The argument a slot captures, or null if [value] is not valid for it. */
+    private fun slotValue(name: String, value: String): String? = when (name) {
+        "site" -> SITES[value]
+        "app" -> apps(value)
+        else -> value
+    }
+
+    private fun classify(text: String): Resolved? {
+        val words = CommandGrammar.normalize(text).split(' ')
+        if (words.first() in QUESTION_WORDS) return null
+        val result = classifier?.classify(text) ?: return null
+        if (result.intent == NO_INTENT || result.probability < minProbability || result.margin < minMargin) return null
+        val action = Action.entries.firstOrNull { it.name == result.intent } ?: return null
+        // Arguments need the exact rule match; the classifier only decides argument-free actions
+        if (action.needsArgument) return null
+        val keywords = KEYWORDS[action] ?: return null
+        if (words.none { it in keywords }) return null
+        return Resolved(action, null, Source.CLASSIFIER, result.probability)
+    }
+
+    @Synchronized
+    private fun record(resolved: Resolved?, latencyNs: Long) {
+        queries++
+        when (resolved?.source) {
+            Source.RULE -> ruleHits++
+            Source.CLASSIFIER -> classifierHits++
+            null -> {}
+        }
+        totalLatencyNs += latencyNs
+        if (latencyNs > maxLatencyNs) maxLatencyNs = latencyNs
+    }
+}
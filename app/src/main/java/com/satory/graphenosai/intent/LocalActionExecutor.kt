@@ -0,0 +1,123 @@
+package com.satory.graphenosai.intent
+
+import android.content.BroadcastReceiver
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.hardware.camera2.CameraCharacteristics
+import android.hardware.camera2.CameraManager
+import android.media.AudioManager
+import android.net.Uri
+import android.provider.MediaStore
+import android.util.Log
+import androidx.core.content.ContextCompat
+import com.satory.graphenosai.audio.CommandGrammar
+
+/**
+ * Carries out [IntentRouter] actions with plain intents and system services;
+ * none of them needs an extra permission. Listens for package changes until
+ * [close] so the launchable app list follows installs and removals.
+ */
+class LocalActionExecutor(private val context: Context) : AutoCloseable {
+
+    companion object {
+        private const val TAG = "LocalActionExecutor"
+    }
+
+    // Normalized launcher label -> package, loaded on first use
+    @Volatile private var launchable: Map<String, String>? = null
+
+    private val packageReceiver = object : BroadcastReceiver() {
+        override fun onReceive(context: Context, intent: Intent) = refreshApps()
+    }
+
+    init {
+        val filter = IntentFilter().apply {
+            addAction(Intent.ACTION_PACKAGE_ADDED)
+            addAction(Intent.ACTION_PACKAGE_REMOVED)
+            addAction(Intent.ACTION_PACKAGE_CHANGED)
+            addDataScheme("package")
+        }
+        // System broadcasts still reach a receiver that is not exported
+        ContextCompat.registerReceiver(context, packageReceiver, filter, ContextCompat.RECEIVER_NOT_EXPORTED)
+    }
+
+    /** Package of the installed app called [name] (normalized), or null. */
+    fun findApp(name: String): String? {
+        val apps = launchable ?: loadLaunchable().also { launchable = it }
+        return apps[name]
+    }
+
+    /** Forget the app list, e.g. after a package was installed or removed. */
+    fun refreshApps() {
+        launchable = null
+    }
+
+    override fun close() {
+        context.unregisterReceiver(packageReceiver)
+    }
+
+    /** Perform [resolved]; returns the text to show and speak, or null if it could not be done. */
+    fun execute(resolved: IntentRouter.Resolved): String? = try {
+        when (resolved.action) {
+            IntentRouter.Action.OPEN_SITE -> resolved.argument?.let { openSite(it) }
+            IntentRouter.Action.OPEN_APP -> resolved.argument?.let { openApp(it) }
+            IntentRouter.Action.FLASHLIGHT_ON -> setTorch(true)
+            IntentRouter.Action.FLASHLIGHT_OFF -> setTorch(false)
+        }
+    } catch (e: Exception) {
+        Log.e(TAG, "Local action ${resolved.action} failed", e)
+        null
+    }
+
+    /** Open the camera app ready for a photo; the spoken "open camera" / "take a photo" commands. */
+    fun openCamera(): String? = try {
+        context.startActivity(
+            Intent(MediaStore.INTENT_ACTION_STILL_IMAGE_CAMERA).addFlags(Intent.FLAG_ACTIVITY_NEW_TASK)
+        )
+        "Opening the camera"
+    } catch (e: Exception) {
+        Log.e(TAG, "Cannot open the camera", e)
+        null
+    }
+
+    /** One media volume step up or down, showing the system volume panel. */
+    fun adjustVolume(raise: Boolean): String? {
+        val audio = context.getSystemService(AudioManager::class.java) ?: return null
+        val direction = if (raise) AudioManager.ADJUST_RAISE else AudioManager.ADJUST_LOWER
+        audio.adjustStreamVolume(AudioManager.STREAM_MUSIC, direction, AudioManager.FLAG_SHOW_UI)
+        return if (raise) "Volume up" else "Volume down"
+    }
+
+    private fun openSite(url: String): String {
+        context.startActivity(Intent(Intent.ACTION_VIEW, Uri.parse(url)).addFlags(Intent.FLAG_ACTIVITY_NEW_TASK))
+        return "Opening ${Uri.parse(url).host?.removePrefix("www.") ?: url}"
+    }
+
+    private fun openApp(packageName: String): String? {
+        val pm = context.packageManager
+        val intent = pm.getLaunchIntentForPackage(packageName) ?: return null
+        context.startActivity(intent.addFlags(Intent.FLAG_ACTIVITY_NEW_TASK))
+        val label = pm.getApplicationInfo(packageName, 0).loadLabel(pm)
+        return "Opening $label"
+    }
+
+    private fun setTorch(on: Boolean): String? {
+        val cameras = context.getSystemService(CameraManager::class.java) ?: return null
+        val id = cameras.cameraIdList.firstOrNull { id ->
+            val characteristics = cameras.getCameraCharacteristics(id)
+            characteristics.get(CameraCharacteristics.FLASH_INFO_AVAILABLE) == true &&
+                characteristics.get(CameraCharacteristics.LENS_FACING) == CameraCharacteristics.LENS_FACING_BACK
+        } ?: return null
+        cameras.setTorchMode(id, on)
+        return if (on) "Flashlight on" else "Flashlight off"
+    }
+
+    private fun loadLaunchable(): Map<String, String> {
+        val pm = context.packageManager
+        val launcher = Intent(Intent.ACTION_MAIN).addCategory(Intent.CATEGORY_LAUNCHER)
+        return pm.queryIntentActivities(launcher, 0)
+            .associate { CommandGrammar.normalize(it.loadLabel(pm).toString()) to it.activityInfo.packageName }
+            .also { Log.d(TAG, "Loaded ${it.size} launchable apps") }
+    }
+}
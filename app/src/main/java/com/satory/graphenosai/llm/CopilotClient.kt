@@ -1,7 +1,9 @@
 package com.satory.graphenosai.llm
 
 import android.util.Log
+import com.satory.graphenosai.diagnostics.SessionRecorder
 import com.satory.graphenosai.security.SecureKeyManager
+import com.satory.graphenosai.util.Endpoints
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import kotlinx.coroutines.flow.Flow
@@ -11,8 +13,8 @@ import org.json.JSONArray
 import org.json.JSONObject
 import java.io.BufferedReader
 import java.io.InputStreamReader
+import java.net.HttpURLConnection
 import java.net.URL
-import javax.net.ssl.HttpsURLConnection
 
 /**
  * GitHub Copilot API client with streaming support.
@@ -111,7 +113,7 @@ For any questions about current events, facts, prices, news, weather - search th
             }
 
             val responseCode = connection.responseCode
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = connection.errorStream?.bufferedReader()?.readText()
                 Log.e(TAG, "Completion error $responseCode: $errorBody")
                 return@withContext ""
@@ -157,13 +159,14 @@ For any questions about current events, facts, prices, news, weather - search th
         val responseBuilder = StringBuilder()
         
         try {
+            SessionRecorder.request(requestBody)
             connection.outputStream.use { os ->
                 os.write(requestBody.toByteArray(Charsets.UTF_8))
             }
 
             val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -182,29 +185,11 @@ For any questions about current events, facts, prices, news, weather - search th
             BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
                 var line: String?
                 while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                if (delta != null) {
-                                    val content: String? = delta.optString("content", null)
-                                    if (content != null && content.isNotEmpty() && content != "null") {
-                                        responseBuilder.append(content)
-                                        emit(content)
-                                    }
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
-                    }
+                    SessionRecorder.sseLine(line!!)
+                    if (SseParser.isDone(line!!)) break
+                    val content = SseParser.deltaContent(line!!) ?: continue
+                    responseBuilder.append(content)
+                    emit(content)
                 }
             }
             
@@ -270,13 +255,14 @@ For any questions about current events, facts, prices, news, weather - search th
         val responseBuilder = StringBuilder()
         
         try {
+            SessionRecorder.request(requestBody)
             connection.outputStream.use { os ->
                 os.write(requestBody.toByteArray(Charsets.UTF_8))
             }
 
             val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -288,27 +274,11 @@ For any questions about current events, facts, prices, news, weather - search th
             BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
                 var line: String?
                 while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content: String? = delta?.optString("content", null)
-                                if (content != null && content.isNotEmpty() && content != "null") {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
-                    }
+                    SessionRecorder.sseLine(line!!)
+                    if (SseParser.isDone(line!!)) break
+                    val content = SseParser.deltaContent(line!!) ?: continue
+                    responseBuilder.append(content)
+                    emit(content)
                 }
             }
             
@@ -369,13 +339,14 @@ For any questions about current events, facts, prices, news, weather - search th
         val responseBuilder = StringBuilder()
         
         try {
+            SessionRecorder.request(requestBody)
             connection.outputStream.use { os ->
                 os.write(requestBody.toByteArray(Charsets.UTF_8))
             }
 
             val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -387,27 +358,11 @@ For any questions about current events, facts, prices, news, weather - search th
             BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
                 var line: String?
                 while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content: String? = delta?.optString("content", null)
-                                if (content != null && content.isNotEmpty() && content != "null") {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
-                    }
+                    SessionRecorder.sseLine(line!!)
+                    if (SseParser.isDone(line!!)) break
+                    val content = SseParser.deltaContent(line!!) ?: continue
+                    responseBuilder.append(content)
+                    emit(content)
                 }
             }
             
@@ -450,13 +405,14 @@ For any questions about current events, facts, prices, news, weather - search th
         val responseBuilder = StringBuilder()
         
         try {
+            SessionRecorder.request(requestBody)
             connection.outputStream.use { os ->
                 os.write(requestBody.toByteArray(Charsets.UTF_8))
             }
 
             val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -476,29 +432,11 @@ For any questions about current events, facts, prices, news, weather - search th
             BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
                 var line: String?
                 while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                if (delta != null) {
-                                    val content: String? = delta.optString("content", null)
-                                    if (content != null && content.isNotEmpty() && content != "null") {
-                                        responseBuilder.append(content)
-                                        emit(content)
-                                    }
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
-                    }
+                    SessionRecorder.sseLine(line!!)
+                    if (SseParser.isDone(line!!)) break
+                    val content = SseParser.deltaContent(line!!) ?: continue
+                    responseBuilder.append(content)
+                    emit(content)
                 }
             }
             
@@ -519,9 +457,9 @@ For any questions about current events, facts, prices, news, weather - search th
         }
     }.flowOn(Dispatchers.IO)
 
-    private fun createConnection(token: String, isVisionRequest: Boolean = false): HttpsURLConnection {
-        val url = URL(BASE_URL)
-        return (url.openConnection() as HttpsURLConnection).apply {
+    private fun createConnection(token: String, isVisionRequest: Boolean = false): HttpURLConnection {
+        val url = URL(Endpoints.resolve(BASE_URL))
+        return (url.openConnection() as HttpURLConnection).apply {
             requestMethod = "POST"
             connectTimeout = TIMEOUT_MS
             readTimeout = TIMEOUT_MS * 2
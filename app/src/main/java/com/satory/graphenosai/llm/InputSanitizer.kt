@@ -0,0 +1,27 @@
+package com.satory.graphenosai.llm
+
+/**
+ * Masks identifiers, phone numbers, e-mail addresses and card numbers in a
+ * user query before it is sent, and caps its length.
+ */
+object InputSanitizer {
+
+    private const val MAX_LENGTH = 4000
+
+    fun sanitize(input: String): String {
+        var sanitized = input
+        sanitized = sanitized.replace(Regex("[a-f0-9]{16}"), "[ID]")
+        sanitized = sanitized.replace(Regex("\\+?\\d{10,15}"), "[PHONE]")
+        sanitized = sanitized.replace(
+            Regex("[a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\\.[a-zA-Z]{2,}"),
+            "[EMAIL]"
+        )
+        sanitized = sanitized.replace(Regex("\\d{4}[\\s-]?\\d{4}[\\s-]?\\d{4}[\\s-]?\\d{4}"), "[CARD]")
+
+        if (sanitized.length > MAX_LENGTH) {
+            sanitized = sanitized.take(MAX_LENGTH) + "..."
+        }
+
+        return sanitized.trim()
+    }
+}
@@ -1,7 +1,10 @@
 package com.satory.graphenosai.llm
 
 import android.util.Log
+import com.satory.graphenosai.diagnostics.SessionRecorder
+import com.satory.graphenosai.diagnostics.Tracing
 import com.satory.graphenosai.security.SecureKeyManager
+import com.satory.graphenosai.util.Endpoints
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.flow
@@ -11,8 +14,8 @@ import org.json.JSONArray
 import org.json.JSONObject
 import java.io.BufferedReader
 import java.io.InputStreamReader
+import java.net.HttpURLConnection
 import java.net.URL
-import javax.net.ssl.HttpsURLConnection
 
 /**
  * OpenRouter API client with streaming support, chat sessions, and vision capability.
@@ -103,13 +106,16 @@ Respond in the same language as the user."""
         val responseBuilder = StringBuilder()
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                SessionRecorder.request(requestBody)
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -118,29 +124,15 @@ Respond in the same language as the user."""
                 return@flow
             }
 
-            BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
-                var line: String?
-                while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content = delta?.optString("content", "") ?: ""
-                                if (content.isNotEmpty()) {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
+            Tracing.async("llm.stream") {
+                BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
+                    var line: String?
+                    while (reader.readLine().also { line = it } != null) {
+                        SessionRecorder.sseLine(line!!)
+                        if (SseParser.isDone(line!!)) break
+                        val content = SseParser.deltaContent(line!!) ?: continue
+                        responseBuilder.append(content)
+                        emit(content)
                     }
                 }
             }
@@ -203,13 +195,16 @@ Respond in the same language as the user."""
         val responseBuilder = StringBuilder()
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                SessionRecorder.request(requestBody)
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -218,29 +213,15 @@ Respond in the same language as the user."""
                 return@flow
             }
 
-            BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
-                var line: String?
-                while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content = delta?.optString("content", "") ?: ""
-                                if (content.isNotEmpty()) {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
+            Tracing.async("llm.stream") {
+                BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
+                    var line: String?
+                    while (reader.readLine().also { line = it } != null) {
+                        SessionRecorder.sseLine(line!!)
+                        if (SseParser.isDone(line!!)) break
+                        val content = SseParser.deltaContent(line!!) ?: continue
+                        responseBuilder.append(content)
+                        emit(content)
                     }
                 }
             }
@@ -302,13 +283,16 @@ Respond in the same language as the user."""
         val responseBuilder = StringBuilder()
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                SessionRecorder.request(requestBody)
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -317,29 +301,15 @@ Respond in the same language as the user."""
                 return@flow
             }
 
-            BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
-                var line: String?
-                while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content = delta?.optString("content", "") ?: ""
-                                if (content.isNotEmpty()) {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
+            Tracing.async("llm.stream") {
+                BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
+                    var line: String?
+                    while (reader.readLine().also { line = it } != null) {
+                        SessionRecorder.sseLine(line!!)
+                        if (SseParser.isDone(line!!)) break
+                        val content = SseParser.deltaContent(line!!) ?: continue
+                        responseBuilder.append(content)
+                        emit(content)
                     }
                 }
             }
@@ -383,13 +353,16 @@ Respond in the same language as the user."""
         val responseBuilder = StringBuilder()
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                SessionRecorder.request(requestBody)
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "Unknown error"
                 } catch (e: Exception) { "Error: ${e.message}" }
@@ -398,29 +371,15 @@ Respond in the same language as the user."""
                 return@flow
             }
 
-            BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
-                var line: String?
-                while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content = delta?.optString("content", "") ?: ""
-                                if (content.isNotEmpty()) {
-                                    responseBuilder.append(content)
-                                    emit(content)
-                                }
-                            }
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Parse error: $data")
-                        }
+            Tracing.async("llm.stream") {
+                BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
+                    var line: String?
+                    while (reader.readLine().also { line = it } != null) {
+                        SessionRecorder.sseLine(line!!)
+                        if (SseParser.isDone(line!!)) break
+                        val content = SseParser.deltaContent(line!!) ?: continue
+                        responseBuilder.append(content)
+                        emit(content)
                     }
                 }
             }
@@ -463,13 +422,16 @@ Respond in the same language as the user."""
         val connection = createConnection(apiKey)
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                SessionRecorder.request(requestBody)
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
             
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = try {
                     connection.errorStream?.bufferedReader()?.readText() ?: "No error body"
                 } catch (e: Exception) { "Could not read error" }
@@ -477,24 +439,13 @@ Respond in the same language as the user."""
                 return@flow
             }
 
-            BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
-                var line: String?
-                while (reader.readLine().also { line = it } != null) {
-                    if (line!!.startsWith("data: ")) {
-                        val data = line!!.removePrefix("data: ").trim()
-                        
-                        if (data == "[DONE]") break
-                        if (data.isEmpty()) continue
-                        
-                        try {
-                            val json = JSONObject(data)
-                            val choices = json.optJSONArray("choices")
-                            if (choices != null && choices.length() > 0) {
-                                val delta = choices.getJSONObject(0).optJSONObject("delta")
-                                val content = delta?.optString("content", "") ?: ""
-                                if (content.isNotEmpty()) emit(content)
-                            }
-                        } catch (e: Exception) { }
+            Tracing.async("llm.stream") {
+                BufferedReader(InputStreamReader(connection.inputStream)).use { reader ->
+                    var line: String?
+                    while (reader.readLine().also { line = it } != null) {
+                        SessionRecorder.sseLine(line!!)
+                        if (SseParser.isDone(line!!)) break
+                        SseParser.deltaContent(line!!)?.let { emit(it) }
                     }
                 }
             }
@@ -525,12 +476,14 @@ Respond in the same language as the user."""
         val connection = createConnection(apiKey)
         
         try {
-            connection.outputStream.use { os ->
-                os.write(requestBody.toByteArray(Charsets.UTF_8))
+            // Upload, server queueing and time to response headers
+            val responseCode = Tracing.async("llm.request") {
+                connection.outputStream.use { os ->
+                    os.write(requestBody.toByteArray(Charsets.UTF_8))
+                }
+                connection.responseCode
             }
-
-            val responseCode = connection.responseCode
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 val errorBody = connection.errorStream?.bufferedReader()?.readText()
                 throw OpenRouterException(responseCode, errorBody ?: "Unknown error")
             }
@@ -542,9 +495,9 @@ Respond in the same language as the user."""
         }
     }
 
-    private fun createConnection(apiKey: String): HttpsURLConnection {
-        val url = URL(BASE_URL)
-        return (url.openConnection() as HttpsURLConnection).apply {
+    private fun createConnection(apiKey: String): HttpURLConnection {
+        val url = URL(Endpoints.resolve(BASE_URL))
+        return (url.openConnection() as HttpURLConnection).apply {
             requestMethod = "POST"
             connectTimeout = TIMEOUT_MS
             readTimeout = TIMEOUT_MS * 2
@@ -579,7 +532,7 @@ Respond in the same language as the user."""
         
         messages.put(JSONObject().apply {
             put("role", "user")
-            put("content", sanitizeUserInput(userQuery))
+            put("content", InputSanitizer.sanitize(userQuery))
         })
         
         return messages
@@ -611,23 +564,6 @@ Respond in the same language as the user."""
         return message.getString("content")
     }
 
-    private fun sanitizeUserInput(input: String): String {
-        var sanitized = input
-        sanitized = sanitized.replace(Regex("[a-f0-9]{16}"), "[ID]")
-        sanitized = sanitized.replace(Regex("\\+?\\d{10,15}"), "[PHONE]")
-        sanitized = sanitized.replace(
-            Regex("[a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\\.[a-zA-Z]{2,}"),
-            "[EMAIL]"
-        )
-        sanitized = sanitized.replace(Regex("\\d{4}[\\s-]?\\d{4}[\\s-]?\\d{4}[\\s-]?\\d{4}"), "[CARD]")
-        
-        if (sanitized.length > 4000) {
-            sanitized = sanitized.take(4000) + "..."
-        }
-        
-        return sanitized.trim()
-    }
-
     fun rotateFallbackModel() {
         val currentIndex = FALLBACK_MODELS.indexOf(currentModel)
         currentModel = if (currentIndex < 0 || currentIndex >= FALLBACK_MODELS.size - 1) {
@@ -0,0 +1,184 @@
+package com.satory.graphenosai.llm
+
+/**
+ * Append-only text buffer for streamed LLM answers.
+ *
+ * Each [append] stores the chunk by reference and returns an immutable
+ * [Snapshot] (chunk list prefix + length), so publishing a new token costs
+ * O(1) instead of copying the whole answer into a fresh String. Consumers
+ * that need the full text call [Snapshot.text] (cached per snapshot);
+ * incremental consumers read only the chunks added since the snapshot they
+ * last saw via [Snapshot.chunksSince].
+ *
+ * Written from one coroutine; snapshots may be read from any thread once
+ * published (e.g. through a StateFlow).
+ */
+class ResponseBuffer {
+
+    /**
+     * A stable view of the first [chunkCount] chunks. Chunks are never
+     * rewritten, so the view stays valid while the buffer keeps growing.
+     */
+    class Snapshot internal constructor(
+        /** Bumped by [ResponseBuffer.clear]; snapshots of different generations share nothing. */
+        val generation: Int,
+        private val chunks: Array<String?>,
+        val chunkCount: Int,
+        val length: Int
+    ) {
+        @Volatile private var cached: String? = null
+
+        /** Monotonic within a generation: the number of chunks appended so far. */
+        val version: Int get() = chunkCount
+
+        fun isEmpty(): Boolean = length == 0
+
+        fun chunk(index: Int): String {
+            if (index !in 0 until chunkCount) throw IndexOutOfBoundsException("chunk $index of $chunkCount")
+            return chunks[index]!!
+        }
+
+        /**
+         * Chunks appended after [previous], or every chunk if [previous] is
+         * null or from another generation.
+         */
+        fun chunksSince(previous: Snapshot?): List<String> {
+            val from = if (previous != null && previous.generation == generation) previous.chunkCount else 0
+            return (from until chunkCount).map { chunks[it]!! }
+        }
+
+        /** The full text, built once per snapshot. */
+        fun text(): String {
+            cached?.let { return it }
+            val builder = StringBuilder(length)
+            for (i in 0 until chunkCount) builder.append(chunks[i])
+            return builder.toString().also { cached = it }
+        }
+
+        override fun toString(): String = text()
+
+        companion object {
+            val EMPTY = Snapshot(0, arrayOfNulls(0), 0, 0)
+        }
+    }
+
+    /**
+     * A streamed answer split at blank lines outside code fences, the
+     * places where markdown can be rendered piecewise: [settled] blocks no
+     * longer change, [tail] is the block still being written.
+     */
+    class Blocks(val settled: List<String>, val tail: String) {
+        fun isEmpty(): Boolean = settled.isEmpty() && tail.isEmpty()
+
+        /** The whole answer; builds a new String, so not for per-token use. */
+        fun text(): String = (settled + tail).filter { it.isNotEmpty() }.joinToString("\n\n")
+
+        companion object {
+            val EMPTY = Blocks(emptyList(), "")
+
+            fun of(text: String) = Blocks(emptyList(), text)
+        }
+    }
+
+    /**
+     * One consumer's view of the streamed text. [read] appends only the
+     * chunks a snapshot adds to the last one it saw and scans only the lines
+     * they complete; a block is copied out once, when it settles, so each
+     * read copies just the unsettled tail. An answer with no blank line
+     * outside a fence stays one tail and is copied whole on every read.
+     */
+    class Reader {
+        private val text = StringBuilder()
+        private var last: Snapshot? = null
+        private var settled: List<String> = emptyList()
+        private var settledEnd = 0
+        private var lineStart = 0
+        private var inFence = false
+
+        /** Catch up with [snapshot] and return the blocks it holds. */
+        fun read(snapshot: Snapshot): Blocks {
+            val previous = last
+            if (previous != null && (previous.generation != snapshot.generation || previous.chunkCount > snapshot.chunkCount)) {
+                // A new answer, or an older snapshot than the last one: start from its first chunk
+                reset()
+            }
+            for (chunk in snapshot.chunksSince(last)) text.append(chunk)
+            last = snapshot
+            scan()
+            return Blocks(settled, text.substring(settledEnd))
+        }
+
+        private fun reset() {
+            text.setLength(0)
+            last = null
+            settled = emptyList()
+            settledEnd = 0
+            lineStart = 0
+            inFence = false
+        }
+
+        /** Settle the blocks that lines completed since the last scan end. */
+        private fun scan() {
+            while (true) {
+                val end = text.indexOf("\n", lineStart)
+                if (end < 0) return
+                val first = firstNonBlank(lineStart, end)
+                if (first == end) {
+                    if (!inFence) {
+                        if (firstNonBlank(settledEnd, lineStart) < lineStart) {
+                            // A new list, so Blocks handed out earlier keep theirs
+                            settled = settled + text.substring(settledEnd, lineStart - 1)
+                        }
+                        settledEnd = end + 1
+                    }
+                } else if (text.startsWith("```", first)) {
+                    inFence = !inFence
+                }
+                lineStart = end + 1
+            }
+        }
+
+        private fun firstNonBlank(from: Int, to: Int): Int {
+            var i = from
+            while (i < to && text[i].isWhitespace()) i++
+            return i
+        }
+    }
+
+    private var generation = 0
+    private var chunks: Array<String?> = arrayOfNulls(INITIAL_CAPACITY)
+    private var count = 0
+    private var length = 0
+    private var current = Snapshot.EMPTY
+
+    val size: Int get() = length
+
+    /** Append [chunk] and return the snapshot that includes it. */
+    fun append(chunk: String): Snapshot {
+        if (chunk.isEmpty()) return current
+        if (count == chunks.size) {
+            // Only references are copied; older snapshots keep the previous array
+            chunks = chunks.copyOf(chunks.size * 2)
+        }
+        chunks[count++] = chunk
+        length += chunk.length
+        current = Snapshot(generation, chunks, count, length)
+        return current
+    }
+
+    fun snapshot(): Snapshot = current
+
+    /** Start a new answer; snapshots handed out earlier are unaffected. */
+    fun clear(): Snapshot {
+        generation++
+        chunks = arrayOfNulls(INITIAL_CAPACITY)
+        count = 0
+        length = 0
+        current = Snapshot(generation, chunks, 0, 0)
+        return current
+    }
+
+    private companion object {
+        const val INITIAL_CAPACITY = 64
+    }
+}
@@ -0,0 +1,41 @@
+package com.satory.graphenosai.llm
+
+import android.util.Log
+import org.json.JSONObject
+
+/**
+ * Reads the server-sent event lines of an OpenAI-style streaming chat
+ * completion (OpenRouter, Copilot), one line at a time as the clients read
+ * them. Called once per token, so it is benchmarked with the other per-token
+ * paths (see the benchmark module).
+ */
+object SseParser {
+
+    private const val TAG = "SseParser"
+    private const val DATA_PREFIX = "data: "
+
+    /** True for the `data: [DONE]` line that ends the stream. */
+    fun isDone(line: String): Boolean =
+        line.startsWith(DATA_PREFIX) && line.substring(DATA_PREFIX.length).trim() == "[DONE]"
+
+    /**
+     * Text delta carried by [line], or null when it carries none: comments,
+     * keep-alives, role-only and finish chunks, `[DONE]` and malformed data.
+     */
+    fun deltaContent(line: String): String? {
+        if (!line.startsWith(DATA_PREFIX)) return null
+        val data = line.substring(DATA_PREFIX.length).trim()
+        if (data.isEmpty() || data == "[DONE]") return null
+        return try {
+            val choices = JSONObject(data).optJSONArray("choices")
+            if (choices == null || choices.length() == 0) return null
+            val delta = choices.getJSONObject(0).optJSONObject("delta")
+            // JSON null comes back from optString as the text "null"
+            if (delta == null || delta.isNull("content")) return null
+            delta.optString("content").ifEmpty { null }
+        } catch (e: Exception) {
+            Log.w(TAG, "Parse error: $data")
+            null
+        }
+    }
+}
@@ -2,12 +2,13 @@ package com.satory.graphenosai.search
 
 import android.util.Log
 import com.satory.graphenosai.security.SecureKeyManager
+import com.satory.graphenosai.util.Endpoints
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import org.json.JSONObject
+import java.net.HttpURLConnection
 import java.net.URL
 import java.net.URLEncoder
-import javax.net.ssl.HttpsURLConnection
 
 /**
  * Search result data class.
@@ -57,9 +58,9 @@ class BraveSearchClient(private val keyManager: SecureKeyManager) {
 
     private fun searchBrave(query: String, apiKey: String, maxResults: Int): List<SearchResult> {
         val encodedQuery = URLEncoder.encode(query, "UTF-8")
-        val url = URL("$BRAVE_API_URL?q=$encodedQuery&count=$maxResults&safesearch=moderate")
+        val url = URL("${Endpoints.resolve(BRAVE_API_URL)}?q=$encodedQuery&count=$maxResults&safesearch=moderate")
         
-        val connection = url.openConnection() as HttpsURLConnection
+        val connection = url.openConnection() as HttpURLConnection
         connection.apply {
             requestMethod = "GET"
             connectTimeout = TIMEOUT_MS
@@ -70,7 +71,7 @@ class BraveSearchClient(private val keyManager: SecureKeyManager) {
         
         try {
             val responseCode = connection.responseCode
-            if (responseCode != HttpsURLConnection.HTTP_OK) {
+            if (responseCode != HttpURLConnection.HTTP_OK) {
                 Log.e(TAG, "Brave API error: $responseCode")
                 return emptyList()
             }
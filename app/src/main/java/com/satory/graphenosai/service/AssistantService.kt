@@ -7,24 +7,44 @@ import android.content.Intent
 import android.net.Uri
 import android.os.Binder
 import android.os.IBinder
+import android.os.SystemClock
 import android.util.Log
 import androidx.core.app.NotificationCompat
 import com.satory.graphenosai.AssistantApplication
 import com.satory.graphenosai.MainActivity
 import com.satory.graphenosai.R
 import com.satory.graphenosai.audio.AudioCaptureManager
+import com.satory.graphenosai.audio.BargeInMonitor
+import com.satory.graphenosai.audio.CaptureResources
+import com.satory.graphenosai.audio.CommandGrammar
+import com.satory.graphenosai.audio.LocalWhisper
 import com.satory.graphenosai.audio.SpeechRecognizerManager
+import com.satory.graphenosai.audio.VoicePipeline
 import com.satory.graphenosai.audio.VoskTranscriber
 import com.satory.graphenosai.audio.WhisperTranscriber
+import com.satory.graphenosai.diagnostics.EnergyMeter
+import com.satory.graphenosai.diagnostics.LatencyMetrics
+import com.satory.graphenosai.diagnostics.SessionRecorder
+import com.satory.graphenosai.diagnostics.Tracing
+import com.satory.graphenosai.intent.IntentClassifier
+import com.satory.graphenosai.intent.IntentRouter
+import com.satory.graphenosai.intent.LocalActionExecutor
 import com.satory.graphenosai.llm.ChatSession
 import com.satory.graphenosai.llm.CopilotClient
 import com.satory.graphenosai.llm.OpenRouterClient
+import com.satory.graphenosai.llm.ResponseBuffer
 import com.satory.graphenosai.search.BraveSearchClient
 import com.satory.graphenosai.storage.ChatHistoryManager
 import com.satory.graphenosai.tts.TTSManager
 import com.satory.graphenosai.ui.SettingsManager
+import com.vincent.ai_integrated_into_android.audio.WhisperJNI
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.*
+import java.io.ByteArrayOutputStream
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.atomic.AtomicBoolean
 
 /**
  * Foreground service managing the AI assistant lifecycle.
@@ -43,10 +63,36 @@ class AssistantService : Service() {
     private lateinit var copilotClient: CopilotClient
     private lateinit var braveSearchClient: BraveSearchClient
     private lateinit var ttsManager: TTSManager
+    private lateinit var bargeInMonitor: BargeInMonitor
+    private lateinit var localActions: LocalActionExecutor
+    private var intentClassifier: IntentClassifier? = null
+    lateinit var intentRouter: IntentRouter
     lateinit var settingsManager: SettingsManager
     lateinit var chatHistoryManager: ChatHistoryManager
     
     private var speechRecognitionJob: Job? = null
+    
+    // Preprocessing and automatic endpointing for Vosk/Whisper capture
+    private val capture = CaptureResources<VoicePipeline, VoskTranscriber.Stream>()
+    // Pipeline output of a Whisper capture, which is what gets uploaded
+    private val processedAudio = ByteArrayOutputStream()
+    @Volatile private var speechEndedAtMs = 0L
+    // Wake word captures are tried against CommandGrammar before transcription
+    @Volatile private var wakeWordTurn = false
+    
+    // Turn timeline for LatencyMetrics (elapsedRealtime, 0 once recorded or not reached)
+    @Volatile private var triggeredAtMs = 0L
+    @Volatile private var captureStoppedAtMs = 0L
+    @Volatile private var queryStartedAtMs = 0L
+    @Volatile private var firstTokenAtMs = 0L
+    
+    // On-screen text captured at activation, attached to the next query
+    @Volatile private var pendingScreenContext: String? = null
+    private var screenContextAtMs = 0L
+    
+    // End of speech -> transcription result, for the last endpointed capture
+    private val _lastEndpointLatencyMs = MutableStateFlow<Long?>(null)
+    val lastEndpointLatencyMs: StateFlow<Long?> = _lastEndpointLatencyMs.asStateFlow()
 
     // State flow for UI binding
     private val _assistantState = MutableStateFlow<AssistantState>(AssistantState.Idle)
@@ -58,6 +104,12 @@ class AssistantService : Service() {
     private val _response = MutableStateFlow("")
     val response: StateFlow<String> = _response.asStateFlow()
     
+    // Answer being streamed: append-only snapshots instead of a new String per token.
+    // `response` gets the final text once streaming is done.
+    private val responseBuffer = ResponseBuffer()
+    private val _streamingResponse = MutableStateFlow(ResponseBuffer.Snapshot.EMPTY)
+    val streamingResponse: StateFlow<ResponseBuffer.Snapshot> = _streamingResponse.asStateFlow()
+    
     // Chat session messages for UI
     private val _chatMessages = MutableStateFlow<List<ChatSession.Message>>(emptyList())
     val chatMessages: StateFlow<List<ChatSession.Message>> = _chatMessages.asStateFlow()
@@ -138,6 +190,12 @@ class AssistantService : Service() {
         
         const val EXTRA_TRIGGER = "trigger"
         const val EXTRA_QUERY = "query"
+        const val EXTRA_PREROLL_PATH = "preroll_path"
+        const val EXTRA_SCREEN_CONTEXT = "screen_context"
+        // Screen text goes stale once the user moves on
+        private const val SCREEN_CONTEXT_TTL_MS = 120_000L
+        // Longer wake word captures are questions, not commands
+        private const val COMMAND_MAX_SECONDS = 3f
     }
 
     inner class AssistantBinder : Binder() {
@@ -154,7 +212,7 @@ class AssistantService : Service() {
         voskTranscriber = VoskTranscriber(this)
         speechRecognizerManager = SpeechRecognizerManager(this)
         settingsManager = SettingsManager(this)
-        chatHistoryManager = ChatHistoryManager(this)
+        chatHistoryManager = ChatHistoryManager(filesDir)
         
         // Initialize Whisper with API key provider
         whisperTranscriber = WhisperTranscriber {
@@ -185,6 +243,33 @@ class AssistantService : Service() {
         
         braveSearchClient = BraveSearchClient(app.secureKeyManager)
         ttsManager = TTSManager(this)
+        ttsManager.onAudioStart = ::onFirstAudio
+        bargeInMonitor = BargeInMonitor(this, ttsManager)
+        
+        // Simple device actions are handled on-device before any network call
+        localActions = LocalActionExecutor(this)
+        intentClassifier = IntentClassifier.create(IntentRouter.classifierSpec())
+        intentRouter = IntentRouter(
+            classifier = intentClassifier?.let { classifier -> IntentRouter.Classifier { classifier.classify(it) } },
+            apps = localActions::findApp
+        )
+        
+        SessionRecorder.enabled = settingsManager.recordSessions
+        
+        // Hand the microphone back to the wake word listener once capture ends
+        serviceScope.launch {
+            var wasListening = false
+            assistantState.collect { state ->
+                val listening = state == AssistantState.Listening
+                if (wasListening && !listening) WakeWordService.resume(this@AssistantService)
+                wasListening = listening
+                when (state) {
+                    is AssistantState.Complete -> SessionRecorder.event(SessionRecorder.COMPLETE)
+                    is AssistantState.Error -> SessionRecorder.event(SessionRecorder.ERROR, state.message)
+                    else -> Unit
+                }
+            }
+        }
         
         // Initialize Vosk with selected language (and secondary for multilingual)
         serviceScope.launch(Dispatchers.IO) {
@@ -218,7 +303,10 @@ class AssistantService : Service() {
                 startForeground(NOTIFICATION_ID, createNotification("Assistant ready"))
                 // Clear session on each activation for fresh start
                 clearSession()
+                setScreenContext(intent.getStringExtra(EXTRA_SCREEN_CONTEXT))
                 launchOverlay()
+                // Wake word activations start listening immediately, seeded with the pre-roll
+                intent.getStringExtra(EXTRA_PREROLL_PATH)?.let { startVoiceCapture(it) }
             }
             ACTION_START_VOICE -> startVoiceCapture()
             ACTION_STOP_VOICE -> stopVoiceCapture()
@@ -237,8 +325,13 @@ class AssistantService : Service() {
         super.onDestroy()
         serviceScope.cancel()
         audioCaptureManager.release()
+        WakeWordService.resume(this)
         speechRecognizerManager.destroy()
+        bargeInMonitor.stop()
         ttsManager.shutdown()
+        intentClassifier?.close()
+        localActions.close()
+        SessionRecorder.close()
         Log.i(TAG, "AssistantService destroyed")
     }
 
@@ -268,8 +361,11 @@ class AssistantService : Service() {
 
     /**
      * Start voice capture using Vosk, System speech, or Whisper cloud transcription.
+     * [prerollPath] is raw 16 kHz PCM recorded by the wake word listener and
+     * [prerollPcm] the same format captured during barge-in; either is
+     * prepended for Vosk and Whisper (the system recognizer opens its own stream).
      */
-    fun startVoiceCapture() {
+    fun startVoiceCapture(prerollPath: String? = null, prerollPcm: ByteArray? = null) {
         // Reset any stuck listening state - check if recognizer is actually listening
         if (_assistantState.value == AssistantState.Listening) {
             if (!speechRecognizerManager.isCurrentlyListening() && !audioCaptureManager.isCapturing()) {
@@ -282,8 +378,14 @@ class AssistantService : Service() {
             }
         }
         
+        triggeredAtMs = SystemClock.elapsedRealtime()
+        captureStoppedAtMs = 0L
+        wakeWordTurn = prerollPath != null
+        SessionRecorder.begin(sessionsDir())
+        WakeWordService.pause(this)
         _assistantState.value = AssistantState.Listening
         _transcription.value = ""
+        val preRoll = prerollPcm ?: prerollPath?.let { readPreroll(it) }
         
         val voiceMethod = settingsManager.voiceInputMethod
         val preferVosk = voiceMethod == SettingsManager.VOICE_INPUT_VOSK
@@ -302,12 +404,12 @@ class AssistantService : Service() {
             // Whisper cloud transcription preferred
             preferWhisper -> {
                 Log.i(TAG, "Using Whisper cloud transcription")
-                startWhisperCapture()
+                startWhisperCapture(preRoll)
             }
             // Vosk preferred and ready
             preferVosk && voskReady -> {
                 Log.i(TAG, "Using Vosk transcription (preferred)")
-                startVoskCapture()
+                startVoskCapture(preRoll)
             }
             // System preferred and available
             !preferVosk && !preferWhisper && systemAvailable -> {
@@ -322,7 +424,7 @@ class AssistantService : Service() {
             // System preferred but unavailable, try Vosk as fallback
             !preferVosk && !systemAvailable && voskReady -> {
                 Log.i(TAG, "Using Vosk transcription (system unavailable, fallback)")
-                startVoskCapture()
+                startVoskCapture(preRoll)
             }
             // Nothing available
             else -> {
@@ -351,6 +453,7 @@ class AssistantService : Service() {
                         when (result) {
                             is SpeechRecognizerManager.RecognitionResult.ReadyForSpeech -> {
                                 Log.d(TAG, "Ready for speech")
+                                markListening()
                             }
                             is SpeechRecognizerManager.RecognitionResult.Partial -> {
                                 Log.d(TAG, "Partial: ${result.text}")
@@ -419,23 +522,38 @@ class AssistantService : Service() {
         }
     }
     
-    private fun startVoskCapture() {
+    private fun readPreroll(path: String): ByteArray? {
+        val file = File(path)
+        return try {
+            file.readBytes()
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to read wake word pre-roll", e)
+            null
+        } finally {
+            file.delete()
+        }
+    }
+    
+    private fun startVoskCapture(preRoll: ByteArray? = null) {
         Log.i(TAG, "Starting Vosk voice capture")
         
-        serviceScope.launch(Dispatchers.IO) {
-            try {
-                audioCaptureManager.startCapture()
-                    .collect { audioChunk ->
-                        // Buffer audio for batch processing
-                    }
-            } catch (e: Exception) {
-                Log.e(TAG, "Audio capture error", e)
-                _assistantState.value = AssistantState.Error(e.message ?: "Audio capture failed")
+        val method = SettingsManager.VOICE_INPUT_VOSK
+        val endpointing = settingsManager.isEndpointingEnabled(method)
+        releaseEndpointing()
+        // The last capture is released first; this stream stays open until capture stops
+        val (pipeline, stream) = capture.open(
+            { createPipeline(method) },
+            { if (endpointing) voskTranscriber.startStream() else null }
+        )
+        startPipelineCapture(method, pipeline, preRoll) { active, processed ->
+            // Decode as we go so the result is ready when capture stops
+            if (stream?.accept(processed) == true) {
+                active?.notifyDecoderEndpoint()
             }
         }
     }
     
-    private fun startWhisperCapture() {
+    private fun startWhisperCapture(preRoll: ByteArray? = null) {
         Log.i(TAG, "Starting Whisper cloud capture")
         
         // Configure Whisper provider from settings
@@ -444,19 +562,149 @@ class AssistantService : Service() {
             else -> WhisperTranscriber.Provider.GROQ
         }
         
+        val method = SettingsManager.VOICE_INPUT_WHISPER
+        releaseEndpointing()
+        processedAudio.reset()
+        val (pipeline, _) = capture.open({ createPipeline(method) }, { null })
+        startPipelineCapture(method, pipeline, preRoll) { _, processed -> processedAudio.write(processed) }
+    }
+
+    /**
+     * Shared capture for the Vosk and Whisper paths: every chunk runs through
+     * the native voice pipeline (preprocessing, endpointing when enabled) and
+     * [onAudio] receives the processed audio. Falls back to the raw chunks
+     * if [pipeline] could not be built.
+     */
+    private fun startPipelineCapture(
+        voiceMethod: String,
+        pipeline: VoicePipeline?,
+        preRoll: ByteArray?,
+        onAudio: (VoicePipeline?, ByteArray) -> Unit
+    ) {
         serviceScope.launch(Dispatchers.IO) {
             try {
-                audioCaptureManager.startCapture()
+                audioCaptureManager.startCapture(preRoll)
                     .collect { audioChunk ->
-                        // Buffer audio for batch processing
+                        markListening()
+                        if (pipeline == null) {
+                            onAudio(null, audioChunk)
+                            return@collect
+                        }
+                        pipeline.push(audioChunk)
+                        pipeline.read()?.let { onAudio(pipeline, it) }
+                        onPipelineEvents(pipeline)
                     }
             } catch (e: Exception) {
-                Log.e(TAG, "Audio capture error (Whisper)", e)
+                Log.e(TAG, "Audio capture error ($voiceMethod)", e)
                 _assistantState.value = AssistantState.Error(e.message ?: "Audio capture failed")
             }
         }
     }
 
+    private fun createPipeline(voiceMethod: String): VoicePipeline? {
+        speechEndedAtMs = 0L
+        val hangoverMs = if (settingsManager.isEndpointingEnabled(voiceMethod)) {
+            settingsManager.getEndpointHangoverMs(voiceMethod)
+        } else null
+        val spec = VoicePipeline.captureSpec(hangoverMs)
+        SessionRecorder.event(SessionRecorder.PIPELINE, spec)
+        return VoicePipeline.create(spec)
+    }
+    
+    /** Runs on the capture thread; stops capture once the utterance has ended. */
+    private fun onPipelineEvents(pipeline: VoicePipeline) {
+        for (event in pipeline.pollEvents()) {
+            if (speechEndedAtMs != 0L) return
+            if (event.type != VoicePipeline.EventType.SPEECH_END &&
+                event.type != VoicePipeline.EventType.NO_SPEECH) continue
+            
+            val now = SystemClock.elapsedRealtime()
+            speechEndedAtMs = now - event.delayMs.coerceAtLeast(0)
+            Log.i(TAG, "Endpoint detected (${event.reason}, ${event.delayMs} ms after speech)")
+            SessionRecorder.event(SessionRecorder.SPEECH_END, "${event.delayMs} ${event.reason}")
+            
+            serviceScope.launch {
+                if (event.type == VoicePipeline.EventType.NO_SPEECH) {
+                    // Nobody spoke; don't send silence to the recognizer
+                    cancelVoiceCapture()
+                } else {
+                    stopVoiceCapture()
+                }
+            }
+        }
+    }
+    
+    private fun reportEndpointLatency() {
+        val now = SystemClock.elapsedRealtime()
+        // Without an endpoint, speech ended when the user stopped the capture
+        val stopped = captureStoppedAtMs
+        captureStoppedAtMs = 0L
+        val speechEnd = speechEndedAtMs
+        if (speechEnd == 0L) {
+            if (stopped != 0L) LatencyMetrics.record(LatencyMetrics.Stage.SPEECH_END_TO_TRANSCRIPT, now - stopped)
+            return
+        }
+        val latency = now - speechEnd
+        LatencyMetrics.record(LatencyMetrics.Stage.SPEECH_END_TO_TRANSCRIPT, latency)
+        _lastEndpointLatencyMs.value = latency
+        Log.i(TAG, "End of speech to transcription: $latency ms")
+    }
+    
+    /** First audio reached the recognizer: ends the trigger -> listening stage. */
+    private fun markListening() {
+        val triggered = triggeredAtMs
+        if (triggered == 0L) return
+        triggeredAtMs = 0L
+        SessionRecorder.event(SessionRecorder.LISTENING)
+        LatencyMetrics.record(LatencyMetrics.Stage.TRIGGER_TO_LISTENING, SystemClock.elapsedRealtime() - triggered)
+    }
+    
+    /** TTS started playing; called from the TTS engine's thread. */
+    private fun onFirstAudio() {
+        val firstToken = firstTokenAtMs
+        if (firstToken == 0L) return
+        firstTokenAtMs = 0L
+        SessionRecorder.event(SessionRecorder.FIRST_AUDIO)
+        LatencyMetrics.record(LatencyMetrics.Stage.FIRST_TOKEN_TO_FIRST_AUDIO, SystemClock.elapsedRealtime() - firstToken)
+    }
+    
+    /** Sessions go where `adb pull` can reach them without root. */
+    private fun sessionsDir(): File = File(getExternalFilesDir(null) ?: filesDir, "sessions")
+    
+    /**
+     * The pipeline output of the capture that just stopped, as a WAV beside
+     * [raw]; [raw] itself when nothing came through.
+     */
+    private fun takeProcessedAudio(raw: File): File {
+        val pcm = synchronized(processedAudio) {
+            processedAudio.toByteArray().also { processedAudio.reset() }
+        }
+        if (pcm.isEmpty()) return raw
+        val wav = File(raw.parentFile, "${raw.nameWithoutExtension}_processed.wav")
+        audioCaptureManager.writeWav(pcm, wav)
+        return wav
+    }
+    
+    private fun closePipeline() {
+        capture.takePipeline()?.let {
+            Log.i(TAG, "Voice pipeline stats:\n${it.stats}")
+            it.close()
+        }
+    }
+    
+    private fun releaseEndpointing() {
+        closePipeline()
+        capture.takeStream()?.close()
+    }
+    
+    private fun cancelVoiceCapture() {
+        if (_assistantState.value != AssistantState.Listening) return
+        audioCaptureManager.cancelCapture()
+        releaseEndpointing()
+        _transcription.value = ""
+        _assistantState.value = AssistantState.Idle
+    }
+
     /**
      * Stop voice capture and process transcription.
      */
@@ -486,19 +734,37 @@ class AssistantService : Service() {
         }
         
         // Whisper or Vosk processing
+        captureStoppedAtMs = SystemClock.elapsedRealtime()
+        SessionRecorder.event(SessionRecorder.CAPTURE_STOP)
         _assistantState.value = AssistantState.Processing
+        val stream = capture.takeStream()
+        closePipeline()
         
         serviceScope.launch(Dispatchers.IO) {
+            // End of speech to answer spoken, around the per-stage spans
+            val turnTrace = Tracing.beginAsync("voice.turn")
             try {
                 val audioFile = audioCaptureManager.stopCapture()
+                SessionRecorder.audio(audioFile)
+                
+                if (wakeWordTurn && runVoiceCommand(audioFile, useWhisper)) {
+                    stream?.close()
+                    return@launch
+                }
                 
                 if (useWhisper) {
                     // Use Whisper cloud transcription
                     Log.i(TAG, "Transcribing with Whisper (${whisperTranscriber.provider})")
                     val language = settingsManager.voiceLanguage.split("-").firstOrNull()
+                    val upload = takeProcessedAudio(audioFile)
                     
-                    whisperTranscriber.transcribe(audioFile, language).fold(
+                    EnergyMeter.measure("whisper-cloud", { EnergyMeter.wavSeconds(upload) }) {
+                        Tracing.async("asr.whisperCloud") { whisperTranscriber.transcribe(upload, language) }
+                    }.also {
+                        if (upload != audioFile) upload.delete()
+                    }.fold(
                         onSuccess = { text ->
+                            reportEndpointLatency()
                             _transcription.value = text
                             processVoiceQuery(text)
                         },
@@ -514,14 +780,19 @@ class AssistantService : Service() {
                 
                 // Check if Vosk is ready
                 if (!voskTranscriber.isReady()) {
+                    stream?.close()
                     _transcription.value = ""
                     _response.value = "Voice recognition unavailable. Please download Vosk model in Settings."
                     _assistantState.value = AssistantState.Complete
                     return@launch
                 }
                 
-                // Transcribe using Vosk
-                val transcribedText = voskTranscriber.transcribe(audioFile)
+                // Transcribe using Vosk (the streaming recognizer has already seen the audio)
+                val transcribedText = stream?.finish()
+                    ?: EnergyMeter.measure("vosk", { EnergyMeter.wavSeconds(audioFile) }) {
+                        Tracing.async("asr.vosk") { voskTranscriber.transcribe(audioFile) }
+                    }
+                reportEndpointLatency()
                 
                 // Don't send error messages to LLM
                 if (transcribedText.startsWith("[") && transcribedText.endsWith("]")) {
@@ -539,6 +810,8 @@ class AssistantService : Service() {
                 Log.e(TAG, "Transcription error", e)
                 _response.value = "Voice input error: ${e.message}"
                 _assistantState.value = AssistantState.Error(e.message ?: "Transcription failed")
+            } finally {
+                Tracing.endAsync("voice.turn", turnTrace)
             }
         }
     }
@@ -555,6 +828,8 @@ class AssistantService : Service() {
         
         _transcription.value = effectiveQuery
         _assistantState.value = AssistantState.Processing
+        // Typed queries have no capture; the session starts at the query
+        SessionRecorder.begin(sessionsDir())
         
         Log.i(TAG, "Processing query: '$effectiveQuery', hasImage=${imageBase64 != null}, imageLength=${imageBase64?.length}")
         
@@ -587,6 +862,7 @@ class AssistantService : Service() {
      * Called from voice capture paths.
      */
     private suspend fun processVoiceQuery(query: String) {
+        SessionRecorder.event(SessionRecorder.TRANSCRIPT, query)
         // Add user message to chat (on main thread for UI update)
         withContext(Dispatchers.Main) {
             addUserMessageToChat(query, null)
@@ -602,9 +878,14 @@ class AssistantService : Service() {
      * 3. Speak response via TTS
      */
     private suspend fun processQueryInternal(query: String, imageBase64: String? = null) {
+        queryStartedAtMs = SystemClock.elapsedRealtime()
+        firstTokenAtMs = 0L
+        SessionRecorder.event(SessionRecorder.QUERY, query)
         try {
             val sanitizedQuery = sanitizeQuery(query)
             
+            if (imageBase64 == null && runLocalAction(sanitizedQuery)) return
+            
             var contextSources: List<String> = emptyList()
             var searchContext: String? = null
             
@@ -612,7 +893,7 @@ class AssistantService : Service() {
             if (_webSearchEnabled.value && imageBase64 == null) {
                 _assistantState.value = AssistantState.Searching
                 
-                val searchResults = braveSearchClient.search(sanitizedQuery)
+                val searchResults = Tracing.async("search.brave") { braveSearchClient.search(sanitizedQuery) }
                 
                 if (searchResults.isNotEmpty()) {
                     contextSources = searchResults.map { it.url }
@@ -624,51 +905,151 @@ class AssistantService : Service() {
             }
             
             val finalContext = searchContext
+            val screenContext = takeScreenContext()?.let { sanitizeQuery(it) }
             
             // Query LLM with context
-            streamLLMResponse(sanitizedQuery, finalContext, contextSources, imageBase64)
+            streamLLMResponse(sanitizedQuery, finalContext, contextSources, imageBase64, screenContext)
         } catch (e: Exception) {
             Log.e(TAG, "Query processing error", e)
             _assistantState.value = AssistantState.Error(e.message ?: "Processing failed")
         }
     }
     
+    /**
+     * Handle [query] on-device if it is a simple action ("open YouTube",
+     * "turn on the flashlight"). Returns false to fall through to the LLM.
+     */
+    private suspend fun runLocalAction(query: String): Boolean {
+        val resolved = intentRouter.route(query) ?: return false
+        val reply = withContext(Dispatchers.Main) { localActions.execute(resolved) } ?: return false
+        
+        val stats = intentRouter.stats()
+        Log.i(TAG, "Local action ${resolved.action} (${resolved.source}, ${resolved.confidence}); " +
+            "hit rate ${stats.hits}/${stats.queries}, mean ${stats.meanLatencyUs} µs, max ${stats.maxLatencyNs / 1000} µs")
+        replyLocally(reply)
+        return true
+    }
+    
+    /**
+     * A short wake word capture may be one of the [CommandGrammar.DEFAULT]
+     * commands ("turn off the torch", "louder"): recognize it against the
+     * closed grammar with Vosk, or with the on-device whisper model when
+     * Whisper is the input method, and carry it out with no transcript and
+     * no network. Returns false to transcribe as usual.
+     */
+    private suspend fun runVoiceCommand(audioFile: File, useWhisper: Boolean): Boolean {
+        if (EnergyMeter.wavSeconds(audioFile) > COMMAND_MAX_SECONDS) return false
+        val grammar = CommandGrammar.DEFAULT
+        val match = when {
+            !useWhisper && voskTranscriber.isReady() ->
+                Tracing.async("asr.voskCommand") { voskTranscriber.recognizeCommand(audioFile, grammar) }
+            useWhisper && LocalWhisper.ensureLoaded(this) ->
+                Tracing.async("asr.whisperCommand") {
+                    WhisperJNI.recognizeCommand(audioFile.absolutePath, grammar.nativeSpec())
+                }?.let { CommandGrammar.parseNativeResult(it) }
+            else -> null
+        }
+        if (match == null || match.score < CommandGrammar.MIN_SCORE) return false
+        
+        val session = if (settingsManager.apiProvider == SettingsManager.PROVIDER_COPILOT) {
+            copilotClient.chatSession
+        } else {
+            openRouterClient.chatSession
+        }
+        val reply = withContext(Dispatchers.Main) {
+            when (match.intent) {
+                "flashlight_on" -> localActions.execute(
+                    IntentRouter.Resolved(IntentRouter.Action.FLASHLIGHT_ON, null, IntentRouter.Source.RULE, match.score))
+                "flashlight_off" -> localActions.execute(
+                    IntentRouter.Resolved(IntentRouter.Action.FLASHLIGHT_OFF, null, IntentRouter.Source.RULE, match.score))
+                "open_camera", "take_photo" -> localActions.openCamera()
+                "volume_up" -> localActions.adjustVolume(true)
+                "volume_down" -> localActions.adjustVolume(false)
+                "repeat" -> session.getAllMessages().lastOrNull { it.role == "assistant" }?.content
+                "stop" -> ""
+                else -> null
+            }
+        } ?: return false
+        Log.i(TAG, "Voice command ${match.intent} (\"${match.phrase}\", ${match.score})")
+        reportEndpointLatency()
+        SessionRecorder.event(SessionRecorder.TRANSCRIPT, match.phrase)
+        
+        if (reply.isEmpty()) {
+            // "never mind": end the turn without an answer
+            _transcription.value = ""
+            _assistantState.value = AssistantState.Idle
+            return true
+        }
+        _transcription.value = match.phrase
+        withContext(Dispatchers.Main) { addUserMessageToChat(match.phrase, null) }
+        replyLocally(reply)
+        return true
+    }
+    
+    /** Show and speak an answer produced on-device, as the LLM's would be. */
+    private suspend fun replyLocally(reply: String) {
+        val useCopilot = settingsManager.apiProvider == SettingsManager.PROVIDER_COPILOT
+        val session = if (useCopilot) copilotClient.chatSession else openRouterClient.chatSession
+        withContext(Dispatchers.Main) {
+            session.addAssistantMessage(reply)
+            _chatMessages.value = session.getAllMessages()
+        }
+        _response.value = reply
+        if (settingsManager.ttsEnabled) {
+            _assistantState.value = AssistantState.Speaking
+            ttsManager.speak(reply)
+        }
+        _assistantState.value = AssistantState.Complete
+    }
+    
+    /** Prompt with web results and/or the on-screen text around the query; null if there is neither. */
+    private fun buildContextPrompt(query: String, searchContext: String?, screenContext: String?): String? {
+        val search = searchContext?.takeIf { it.isNotBlank() }
+        val screen = screenContext?.takeIf { it.isNotBlank() }
+        if (search == null && screen == null) return null
+        return buildString {
+            if (screen != null) {
+                append("The user is looking at this screen (text extracted from the app's views, in reading order):\n\n")
+                append("--- SCREEN CONTENT ---\n").append(screen).append("\n--- END SCREEN ---\n\n")
+            }
+            if (search != null) {
+                append("I found the following information from web search. Use this to answer the user's question comprehensively. Don't just list links - synthesize the information into a helpful answer.\n\n")
+                append("--- WEB SEARCH RESULTS ---\n").append(search).append("\n--- END RESULTS ---\n\n")
+            }
+            append("Now answer the user's question: ").append(query)
+        }
+    }
+    
     private suspend fun streamLLMResponse(
         query: String,
         context: String?,
         sources: List<String>,
-        imageBase64: String? = null
+        imageBase64: String? = null,
+        screenContext: String? = null
     ) {
-        _assistantState.value = AssistantState.Responding
         _response.value = ""
+        _streamingResponse.value = responseBuffer.clear()
+        _assistantState.value = AssistantState.Responding
         
-        val fullResponse = StringBuilder()
         val useCopilot = settingsManager.apiProvider == SettingsManager.PROVIDER_COPILOT
         
         Log.i(TAG, "Starting LLM request with ${if (useCopilot) "Copilot" else "OpenRouter"}, hasContext=${context != null}, contextLength=${context?.length ?: 0}")
         
         try {
-            // If we have search context, modify the last user message to include it
-            val responseFlow = if (context != null && context.isNotBlank()) {
-                // Build enhanced prompt with search results
-                val searchPrompt = """I found the following information from web search. Use this to answer the user's question comprehensively. Don't just list links - synthesize the information into a helpful answer.
-
---- WEB SEARCH RESULTS ---
-$context
---- END RESULTS ---
-
-Now answer the user's question: $query"""
-                
-                Log.i(TAG, "Using search context: ${context.take(200)}...")
+            // If we have search or screen context, modify the last user message to include it
+            val enhancedPrompt = buildContextPrompt(query, context, screenContext)
+            val responseFlow = if (enhancedPrompt != null) {
+                if (context != null) Log.i(TAG, "Using search context: ${context.take(200)}...")
+                if (screenContext != null) Log.i(TAG, "Using screen context: ${screenContext.length} chars")
                 
                 // Use streamCompletionDirect which sends the enhanced query without modifying chat history
                 if (useCopilot) {
-                    copilotClient.streamCompletionDirect(searchPrompt, imageBase64)
+                    copilotClient.streamCompletionDirect(enhancedPrompt, imageBase64)
                 } else {
-                    openRouterClient.streamCompletionDirect(searchPrompt, imageBase64)
+                    openRouterClient.streamCompletionDirect(enhancedPrompt, imageBase64)
                 }
             } else {
-                // No search context - use normal completion (message already in chat history)
+                // No extra context - use normal completion (message already in chat history)
                 if (useCopilot) {
                     copilotClient.streamCompletion(query, imageBase64)
                 } else {
@@ -676,20 +1057,42 @@ Now answer the user's question: $query"""
                 }
             }
             
-            responseFlow
-                .catch { e ->
-                    Log.e(TAG, "LLM streaming error", e)
-                    _response.value = "Error: ${e.message}"
-                    _assistantState.value = AssistantState.Error(e.message ?: "LLM error")
-                }
-                .collect { chunk ->
-                    fullResponse.append(chunk)
-                    _response.value = fullResponse.toString()
+            // Time to first visible text, then the whole stream
+            var firstChunkTrace = Tracing.beginAsync("llm.firstChunk")
+            var firstChunkAtMs = 0L
+            var lastChunkAtMs = 0L
+            EnergyMeter.measure("chat") {
+                Tracing.async("llm.response") {
+                    responseFlow
+                        .catch { e ->
+                            Log.e(TAG, "LLM streaming error", e)
+                            _response.value = "Error: ${e.message}"
+                            _assistantState.value = AssistantState.Error(e.message ?: "LLM error")
+                        }
+                        .collect { chunk ->
+                            lastChunkAtMs = SystemClock.elapsedRealtime()
+                            if (firstChunkTrace != 0) {
+                                Tracing.endAsync("llm.firstChunk", firstChunkTrace)
+                                firstChunkTrace = 0
+                                firstChunkAtMs = lastChunkAtMs
+                                firstTokenAtMs = lastChunkAtMs
+                                SessionRecorder.event(SessionRecorder.FIRST_TOKEN)
+                                LatencyMetrics.record(LatencyMetrics.Stage.TRANSCRIPT_TO_FIRST_TOKEN,
+                                    firstChunkAtMs - queryStartedAtMs)
+                            }
+                            _streamingResponse.value = responseBuffer.append(chunk)
+                        }
                 }
+            }
+            if (firstChunkTrace != 0) Tracing.endAsync("llm.firstChunk", firstChunkTrace)
+            if (firstChunkAtMs != 0L) {
+                LatencyMetrics.record(LatencyMetrics.Stage.FIRST_TO_LAST_TOKEN, lastChunkAtMs - firstChunkAtMs)
+                SessionRecorder.event(SessionRecorder.LAST_TOKEN, responseBuffer.size.toString())
+            }
             
-            Log.i(TAG, "LLM response complete: ${fullResponse.length} chars")
+            Log.i(TAG, "LLM response complete: ${responseBuffer.size} chars in ${responseBuffer.snapshot().chunkCount} chunks")
             
-            if (fullResponse.isEmpty()) {
+            if (responseBuffer.size == 0) {
                 _response.value = "No response. Check your API key."
                 _assistantState.value = AssistantState.Error("Empty response")
                 return
@@ -700,9 +1103,10 @@ Now answer the user's question: $query"""
                 val sourcesText = "\n\n📚 Sources:\n" + sources.take(3).mapIndexed { i, url -> 
                     "${i + 1}. $url" 
                 }.joinToString("\n")
-                fullResponse.append(sourcesText)
-                _response.value = fullResponse.toString()
+                _streamingResponse.value = responseBuffer.append(sourcesText)
             }
+            val responseText = responseBuffer.snapshot().text()
+            _response.value = responseText
             
             // Update chat messages for UI (get fresh state after assistant message was added)
             withContext(Dispatchers.Main) {
@@ -714,7 +1118,6 @@ Now answer the user's question: $query"""
             }
             
             // Check if AI wants to open URLs
-            val responseText = fullResponse.toString()
             val urlsToOpen = detectUrlsToOpen(responseText)
             
             // Always ask user before opening URLs (for safety and user control)
@@ -726,7 +1129,16 @@ Now answer the user's question: $query"""
             // Speak the response if enabled
             if (settingsManager.ttsEnabled) {
                 _assistantState.value = AssistantState.Speaking
-                ttsManager.speak(fullResponse.toString())
+                val interrupted = Tracing.async("tts.speak") {
+                    if (settingsManager.bargeInEnabled) {
+                        speakWithBargeIn(responseText)
+                    } else {
+                        ttsManager.speak(responseText)
+                        false
+                    }
+                }
+                // The user talked over the response; a new turn is already listening
+                if (interrupted) return
             }
             
             _assistantState.value = AssistantState.Complete
@@ -738,6 +1150,39 @@ Now answer the user's question: $query"""
         }
     }
     
+    /**
+     * Speak [text] while listening for the user to talk over it. Returns true
+     * if they did: playback is stopped and a new voice capture has started,
+     * seeded with the echo-cancelled audio from just before the detection.
+     */
+    private suspend fun speakWithBargeIn(text: String): Boolean {
+        // Set from the monitor's callback on serviceScope, read here after playback
+        val interrupted = AtomicBoolean(false)
+        WakeWordService.pause(this)
+        val monitoring = bargeInMonitor.start(serviceScope) { preroll ->
+            interrupted.set(true)
+            ttsManager.stop()
+            startVoiceCapture(prerollPcm = toPcmBytes(preroll))
+        }
+        try {
+            // Without a tap on the played audio there is no echo reference: speak normally
+            if (!monitoring || !ttsManager.speakDuplex(text)) {
+                bargeInMonitor.stop()
+                ttsManager.speak(text)
+            }
+        } finally {
+            bargeInMonitor.stop()
+            if (!interrupted.get()) WakeWordService.resume(this)
+        }
+        return interrupted.get()
+    }
+    
+    private fun toPcmBytes(pcm: ShortArray): ByteArray {
+        val bytes = ByteBuffer.allocate(pcm.size * 2).order(ByteOrder.LITTLE_ENDIAN)
+        bytes.asShortBuffer().put(pcm)
+        return bytes.array()
+    }
+    
     /**
      * Clear chat session and start fresh.
      * Saves current chat to history if it has messages.
@@ -764,6 +1209,7 @@ Now answer the user's question: $query"""
         copilotClient.clearSession()
         _chatMessages.value = emptyList()
         _response.value = ""
+        _streamingResponse.value = responseBuffer.clear()
         _transcription.value = ""
         _pendingUrls.value = emptyList()
         _assistantState.value = AssistantState.Idle
@@ -802,6 +1248,7 @@ Now answer the user's question: $query"""
      */
     fun reloadSettings() {
         Log.i(TAG, "Reloading settings...")
+        SessionRecorder.enabled = settingsManager.recordSessions
         
         // Reload model settings
         val effectiveModel = settingsManager.getEffectiveModel()
@@ -856,11 +1303,25 @@ Now answer the user's question: $query"""
         return sanitized.trim()
     }
 
+    private fun setScreenContext(text: String?) {
+        pendingScreenContext = text?.takeIf { it.isNotBlank() }
+        screenContextAtMs = SystemClock.elapsedRealtime()
+    }
+    
+    /** The pending screen context if it is still fresh; each capture is used for one query. */
+    private fun takeScreenContext(): String? {
+        val text = pendingScreenContext ?: return null
+        pendingScreenContext = null
+        return text.takeIf { SystemClock.elapsedRealtime() - screenContextAtMs < SCREEN_CONTEXT_TTL_MS }
+    }
+    
     fun cancelOperation() {
         serviceScope.coroutineContext.cancelChildren()
         speechRecognitionJob?.cancel()
         speechRecognizerManager.stopListening()
         audioCaptureManager.cancelCapture()
+        releaseEndpointing()
+        bargeInMonitor.stop()
         ttsManager.stop()
         _assistantState.value = AssistantState.Idle
     }
@@ -5,6 +5,11 @@ import android.service.voice.VoiceInteractionSession
 import android.service.voice.VoiceInteractionSessionService
 import android.content.Context
 import android.content.Intent
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import android.util.Log
+import com.satory.graphenosai.util.AssistStructureReader
 
 /**
  * Session service for voice interaction.
@@ -20,21 +25,31 @@ class AssistantVoiceInteractionSessionService : VoiceInteractionSessionService()
  * Voice interaction session handling.
  * This is invoked when the assistant is triggered via system mechanisms
  * (long-press home, assistant gesture, etc.)
+ *
+ * When the system offers assist data, the session waits for it and hands
+ * the service a compact text version of the current screen, which is
+ * attached to the next query.
  */
 class AssistantVoiceInteractionSession(context: Context) : VoiceInteractionSession(context) {
 
+    companion object {
+        private const val TAG = "AssistantSession"
+        // Assist data is normally delivered within a few hundred ms; don't hold the UI longer
+        private const val ASSIST_TIMEOUT_MS = 1500L
+    }
+
+    private val handler = Handler(Looper.getMainLooper())
+    private var activated = false
+    private val activateWithoutContext = Runnable { activate(null) }
+
     override fun onShow(args: Bundle?, showFlags: Int) {
         super.onShow(args, showFlags)
-        
-        // Start the assistant service and overlay
-        val intent = Intent(context, AssistantService::class.java).apply {
-            action = AssistantService.ACTION_ACTIVATE
-            putExtra(AssistantService.EXTRA_TRIGGER, "voice_interaction")
+        activated = false
+        if (showFlags and SHOW_WITH_ASSIST != 0) {
+            handler.postDelayed(activateWithoutContext, ASSIST_TIMEOUT_MS)
+        } else {
+            activate(null)
         }
-        context.startForegroundService(intent)
-        
-        // Close this session as we're using our own UI
-        hide()
     }
 
     @Suppress("DEPRECATION")
@@ -44,8 +59,39 @@ class AssistantVoiceInteractionSession(context: Context) : VoiceInteractionSessi
         structure: android.app.assist.AssistStructure?,
         content: android.app.assist.AssistContent?
     ) {
-        // Handle assist data if available
         @Suppress("DEPRECATION")
         super.onHandleAssist(data, structure, content)
+        if (activated) return
+
+        // Null when the user turned off "Use text from screen"
+        val screenContext = structure?.let {
+            val start = SystemClock.elapsedRealtime()
+            AssistStructureReader.read(it)?.also { text ->
+                Log.i(TAG, "Screen context: ${text.length} chars in ${SystemClock.elapsedRealtime() - start} ms")
+            }
+        }
+        activate(screenContext)
+    }
+
+    override fun onHide() {
+        handler.removeCallbacks(activateWithoutContext)
+        super.onHide()
+    }
+
+    private fun activate(screenContext: String?) {
+        if (activated) return
+        activated = true
+        handler.removeCallbacks(activateWithoutContext)
+
+        // Start the assistant service and overlay
+        val intent = Intent(context, AssistantService::class.java).apply {
+            action = AssistantService.ACTION_ACTIVATE
+            putExtra(AssistantService.EXTRA_TRIGGER, "voice_interaction")
+            screenContext?.let { putExtra(AssistantService.EXTRA_SCREEN_CONTEXT, it) }
+        }
+        context.startForegroundService(intent)
+        
+        // Close this session as we're using our own UI
+        hide()
     }
 }
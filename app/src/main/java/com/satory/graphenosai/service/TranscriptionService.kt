@@ -0,0 +1,241 @@
+package com.satory.graphenosai.service
+
+import android.app.Notification
+import android.app.NotificationManager
+import android.app.PendingIntent
+import android.app.Service
+import android.content.Context
+import android.content.Intent
+import android.content.pm.ServiceInfo
+import android.os.Build
+import android.os.IBinder
+import android.util.Log
+import androidx.core.app.NotificationCompat
+import androidx.core.app.ServiceCompat
+import com.satory.graphenosai.AssistantApplication
+import com.satory.graphenosai.MainActivity
+import com.satory.graphenosai.R
+import com.satory.graphenosai.audio.LocalWhisper
+import com.satory.graphenosai.audio.TranscriptJobStore
+import com.satory.graphenosai.audio.TranscriptSegment
+import com.vincent.ai_integrated_into_android.audio.WhisperJNI
+import kotlinx.coroutines.*
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import java.io.File
+
+/**
+ * Foreground service that owns long on-device transcriptions. It works
+ * through the [TranscriptJobStore] queue one recording at a time with
+ * checkpointed native jobs, so when Android kills the process the next
+ * start (the sticky restart, or [resumePending] from MainActivity)
+ * resubmits the job and it continues after its last saved window.
+ * Segments are published on [state] as each window finishes.
+ */
+class TranscriptionService : Service() {
+
+    /** What the UI shows of the job in progress. */
+    data class State(
+        val jobName: String? = null,
+        val progress: Float = 0f,
+        val segments: List<TranscriptSegment> = emptyList(),
+        val queued: Int = 0,
+        val done: Boolean = false,
+        val error: String? = null
+    )
+
+    private val serviceScope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private var worker: Job? = null
+    @Volatile private var activeJobId = 0L
+    @Volatile private var cancelRequested = false
+
+    companion object {
+        private const val TAG = "TranscriptionService"
+        private const val NOTIFICATION_ID = 1003
+        private const val POLL_MS = 500L
+
+        const val ACTION_START = "com.satory.graphenosai.TRANSCRIPTION_START"
+        const val ACTION_CANCEL = "com.satory.graphenosai.TRANSCRIPTION_CANCEL"
+
+        private val _state = MutableStateFlow(State())
+        val state: StateFlow<State> = _state.asStateFlow()
+
+        fun store(context: Context) = TranscriptJobStore(File(context.filesDir, TranscriptJobStore.DIR))
+
+        fun start(context: Context) {
+            val intent = Intent(context, TranscriptionService::class.java).apply { action = ACTION_START }
+            context.startForegroundService(intent)
+        }
+
+        /** Start the service if a job was left unfinished; returns whether one was. */
+        fun resumePending(context: Context): Boolean {
+            if (store(context).pending().isEmpty()) return false
+            start(context)
+            return true
+        }
+
+        /** Drop the job in progress (its files included) and go on with the next. */
+        fun cancel(context: Context) {
+            val intent = Intent(context, TranscriptionService::class.java).apply { action = ACTION_CANCEL }
+            context.startService(intent)
+        }
+    }
+
+    override fun onStartCommand(intent: Intent?, flags: Int, startId: Int): Int {
+        val type = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            ServiceInfo.FOREGROUND_SERVICE_TYPE_DATA_SYNC
+        } else {
+            0
+        }
+        if (intent?.action == ACTION_CANCEL && worker?.isActive != true) {
+            stopSelf()
+            return START_NOT_STICKY
+        }
+        try {
+            ServiceCompat.startForeground(this, NOTIFICATION_ID, createNotification(null, 0f), type)
+        } catch (e: IllegalStateException) {
+            // A restart while the app is in the background may not go foreground; MainActivity resumes the queue
+            Log.w(TAG, "Cannot start in the foreground now", e)
+            stopSelf()
+            return START_NOT_STICKY
+        }
+
+        if (intent?.action == ACTION_CANCEL) cancelRequested = true
+        // A null intent is the sticky restart after the process was killed: resume the queue
+        if (worker?.isActive != true) {
+            worker = serviceScope.launch { drain() }
+        }
+        return START_STICKY
+    }
+
+    override fun onBind(intent: Intent?): IBinder? = null
+
+    // Android 15 caps dataSync services at 6 h a day; the checkpoint keeps the work done so far
+    override fun onTimeout(startId: Int, fgsType: Int) {
+        Log.w(TAG, "Foreground time limit reached, stopping until the next start")
+        stopSelf()
+    }
+
+    override fun onDestroy() {
+        super.onDestroy()
+        worker?.cancel()
+        serviceScope.cancel()
+        // The engine would otherwise keep transcribing for nobody; the checkpoint stays
+        if (activeJobId != 0L) WhisperJNI.cancelJob(activeJobId)
+        activeJobId = 0L
+        Log.i(TAG, "TranscriptionService destroyed")
+    }
+
+    private suspend fun drain() {
+        do {
+            val blocked = !runQueue()
+            // Decided on the main thread, where onStartCommand runs, so a recording queued
+            // while the last job finished is not left behind
+            val stop = withContext(Dispatchers.Main) {
+                val idle = blocked || store(this@TranscriptionService).pending().isEmpty()
+                if (idle) {
+                    ServiceCompat.stopForeground(this@TranscriptionService, ServiceCompat.STOP_FOREGROUND_REMOVE)
+                    stopSelf()
+                }
+                idle
+            }
+        } while (!stop)
+    }
+
+    /** Transcribe pending jobs until none is left; false if there is no model to do it with. */
+    private suspend fun runQueue(): Boolean {
+        val store = store(this)
+        while (true) {
+            val pending = store.pending()
+            val job = pending.firstOrNull() ?: return true
+            if (!LocalWhisper.ensureLoaded(this)) {
+                // The jobs stay queued for when a model is installed
+                _state.value = State(
+                    jobName = job.name,
+                    queued = pending.size - 1,
+                    error = "No on-device Whisper model; import one in Settings"
+                )
+                return false
+            }
+            transcribe(store, job, pending.size - 1)
+        }
+    }
+
+    private suspend fun transcribe(store: TranscriptJobStore, job: TranscriptJobStore.Job, queued: Int) {
+        _state.value = State(jobName = job.name, queued = queued)
+        // A cancel that came in between jobs applies to this one, the job the UI now shows
+        if (cancelRequested) {
+            cancelRequested = false
+            store.remove(job.id)
+            _state.value = State(queued = queued)
+            return
+        }
+        val id = WhisperJNI.submitCheckpointedTranscription(job.audio.absolutePath, job.checkpoint.absolutePath)
+        if (id == 0L) {
+            Log.e(TAG, "Cannot transcribe ${job.name}")
+            store.fail(job, "Cannot read this recording")
+            _state.value = _state.value.copy(error = "Cannot read ${job.name}")
+            return
+        }
+        activeJobId = id
+
+        // The first poll returns what an earlier process already saved
+        val segments = ArrayList<TranscriptSegment>()
+        var failed = false
+        while (true) {
+            if (cancelRequested) {
+                cancelRequested = false
+                WhisperJNI.cancelJob(id)
+                activeJobId = 0L
+                store.remove(job.id)
+                _state.value = State(queued = queued)
+                return
+            }
+            val progress = WhisperJNI.getJobProgress(id)
+            val poll = TranscriptSegment.parsePoll(WhisperJNI.pollTranscriptSegments(id, segments.size))
+            segments.addAll(poll.segments)
+            if (poll.segments.isNotEmpty() || (progress >= 0f && progress != _state.value.progress)) {
+                _state.value = _state.value.copy(progress = maxOf(progress, 0f), segments = segments.toList())
+                updateNotification(job.name, progress)
+            }
+            failed = poll.failed
+            if (poll.done || poll.failed) break
+            delay(POLL_MS)
+        }
+        activeJobId = 0L
+
+        if (failed) {
+            Log.e(TAG, "Transcription of ${job.name} failed after ${segments.size} segments")
+            store.fail(job, "Transcription failed")
+            _state.value = _state.value.copy(error = "Transcription of ${job.name} failed")
+        } else {
+            store.complete(job, segments)
+            _state.value = _state.value.copy(progress = 1f, done = true)
+            Log.i(TAG, "Transcribed ${job.name}: ${segments.size} segments")
+        }
+    }
+
+    private fun updateNotification(name: String, progress: Float) {
+        val manager = getSystemService(Context.NOTIFICATION_SERVICE) as NotificationManager
+        manager.notify(NOTIFICATION_ID, createNotification(name, progress))
+    }
+
+    private fun createNotification(name: String?, progress: Float): Notification {
+        val pendingIntent = PendingIntent.getActivity(
+            this,
+            0,
+            Intent(this, MainActivity::class.java),
+            PendingIntent.FLAG_IMMUTABLE
+        )
+
+        return NotificationCompat.Builder(this, AssistantApplication.CHANNEL_SERVICE)
+            .setContentTitle(if (name != null) "Transcribing $name" else "Transcribing recordings")
+            .setProgress(100, (progress.coerceIn(0f, 1f) * 100).toInt(), name == null || progress <= 0f)
+            .setSmallIcon(R.drawable.ic_assistant)
+            .setContentIntent(pendingIntent)
+            .setOngoing(true)
+            .setOnlyAlertOnce(true)
+            .build()
+    }
+}
@@ -0,0 +1,237 @@
+package com.satory.graphenosai.service
+
+import android.Manifest
+import android.app.Notification
+import android.app.PendingIntent
+import android.app.Service
+import android.content.Context
+import android.content.Intent
+import android.content.pm.PackageManager
+import android.content.pm.ServiceInfo
+import android.media.AudioFormat
+import android.media.AudioRecord
+import android.media.MediaRecorder
+import android.os.Build
+import android.os.IBinder
+import android.util.Log
+import androidx.core.app.NotificationCompat
+import androidx.core.app.ServiceCompat
+import androidx.core.content.ContextCompat
+import com.satory.graphenosai.AssistantApplication
+import com.satory.graphenosai.MainActivity
+import com.satory.graphenosai.R
+import com.satory.graphenosai.audio.WakeWordEngine
+import com.satory.graphenosai.ui.SettingsManager
+import kotlinx.coroutines.*
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Foreground service that listens for the wake word with the native
+ * keyword spotter. On a trigger it releases the microphone, hands the
+ * pre-roll audio to AssistantService and waits for ACTION_RESUME.
+ */
+class WakeWordService : Service() {
+
+    private val serviceScope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private var listenJob: Job? = null
+    private var engine: WakeWordEngine? = null
+
+    companion object {
+        private const val TAG = "WakeWordService"
+        private const val NOTIFICATION_ID = 1002
+        private const val CHUNK_SAMPLES = WakeWordEngine.SAMPLE_RATE / 50 // 20 ms
+
+        const val ACTION_START = "com.satory.graphenosai.WAKE_WORD_START"
+        const val ACTION_RESUME = "com.satory.graphenosai.WAKE_WORD_RESUME"
+        const val ACTION_PAUSE = "com.satory.graphenosai.WAKE_WORD_PAUSE"
+        const val ACTION_STOP = "com.satory.graphenosai.WAKE_WORD_STOP"
+
+        /**
+         * A microphone foreground service may only start once RECORD_AUDIO is
+         * granted; on API 34+ startForeground() throws otherwise.
+         */
+        fun hasMicrophonePermission(context: Context): Boolean =
+            ContextCompat.checkSelfPermission(context, Manifest.permission.RECORD_AUDIO) ==
+                PackageManager.PERMISSION_GRANTED
+
+        /** Start listening; returns false (and starts nothing) without the microphone permission. */
+        fun start(context: Context): Boolean {
+            if (!hasMicrophonePermission(context)) {
+                Log.w(TAG, "RECORD_AUDIO not granted, wake word not started")
+                return false
+            }
+            val intent = Intent(context, WakeWordService::class.java).apply { action = ACTION_START }
+            context.startForegroundService(intent)
+            return true
+        }
+
+        /** Ask a running service to listen again; no-op if the wake word is disabled. */
+        fun resume(context: Context) {
+            if (!SettingsManager(context).wakeWordEnabled || !hasMicrophonePermission(context)) return
+            val intent = Intent(context, WakeWordService::class.java).apply { action = ACTION_RESUME }
+            context.startForegroundService(intent)
+        }
+
+        /** Release the microphone while the assistant records; no-op if disabled. */
+        fun pause(context: Context) {
+            if (!SettingsManager(context).wakeWordEnabled || !hasMicrophonePermission(context)) return
+            val intent = Intent(context, WakeWordService::class.java).apply { action = ACTION_PAUSE }
+            context.startForegroundService(intent)
+        }
+
+        fun stop(context: Context) {
+            context.stopService(Intent(context, WakeWordService::class.java))
+        }
+    }
+
+    override fun onCreate() {
+        super.onCreate()
+        val settings = SettingsManager(this)
+        engine = WakeWordEngine.create(this, settings.wakeWordThreshold)
+    }
+
+    override fun onStartCommand(intent: Intent?, flags: Int, startId: Int): Int {
+        if (intent?.action == ACTION_STOP) {
+            stopSelf()
+            return START_NOT_STICKY
+        }
+
+        // Checked again here: START_STICKY restarts and stale intents bypass start()
+        if (!hasMicrophonePermission(this)) {
+            Log.e(TAG, "RECORD_AUDIO permission not granted, stopping")
+            stopSelf()
+            return START_NOT_STICKY
+        }
+
+        val type = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) {
+            ServiceInfo.FOREGROUND_SERVICE_TYPE_MICROPHONE
+        } else {
+            0
+        }
+        ServiceCompat.startForeground(this, NOTIFICATION_ID, createNotification(), type)
+
+        if (engine == null) {
+            Log.w(TAG, "Wake word engine unavailable, stopping")
+            stopSelf()
+            return START_NOT_STICKY
+        }
+
+        when (intent?.action) {
+            ACTION_PAUSE -> listenJob?.cancel()
+            ACTION_START, ACTION_RESUME, null -> startListening()
+        }
+        return START_STICKY
+    }
+
+    override fun onBind(intent: Intent?): IBinder? = null
+
+    override fun onDestroy() {
+        super.onDestroy()
+        val last = listenJob
+        val detector = engine
+        listenJob = null
+        engine = null
+        serviceScope.cancel()
+        // A cancelled loop may still be inside process(); free the detector once it has left
+        if (last != null) last.invokeOnCompletion { detector?.close() } else detector?.close()
+        Log.i(TAG, "WakeWordService destroyed")
+    }
+
+    private fun startListening() {
+        if (listenJob?.isActive == true) return
+
+        // After a pause the cancelled loop may still be reading; it must be done with the
+        // detector before this one resets it. Each loop waits for the one before, so when
+        // the newest has completed every earlier one has too.
+        val previous = listenJob
+        listenJob = serviceScope.launch {
+            withContext(NonCancellable) { previous?.join() }
+            if (!isActive) return@launch
+            val detector = engine ?: return@launch
+            val minBuffer = AudioRecord.getMinBufferSize(
+                WakeWordEngine.SAMPLE_RATE, AudioFormat.CHANNEL_IN_MONO, AudioFormat.ENCODING_PCM_16BIT
+            )
+            val record = try {
+                AudioRecord(
+                    MediaRecorder.AudioSource.VOICE_RECOGNITION,
+                    WakeWordEngine.SAMPLE_RATE,
+                    AudioFormat.CHANNEL_IN_MONO,
+                    AudioFormat.ENCODING_PCM_16BIT,
+                    maxOf(minBuffer, CHUNK_SAMPLES * 2 * 4)
+                )
+            } catch (e: SecurityException) {
+                Log.e(TAG, "Microphone access denied", e)
+                return@launch
+            }
+            if (record.state != AudioRecord.STATE_INITIALIZED) {
+                Log.e(TAG, "AudioRecord failed to initialize")
+                record.release()
+                return@launch
+            }
+
+            val chunk = ShortArray(CHUNK_SAMPLES)
+            var triggered = false
+            detector.reset()
+            record.startRecording()
+            Log.i(TAG, "Listening for wake word")
+            try {
+                while (isActive) {
+                    val read = record.read(chunk, 0, chunk.size)
+                    if (read < 0) {
+                        Log.e(TAG, "AudioRecord read error $read")
+                        break
+                    }
+                    if (read > 0 && detector.process(chunk, read)) {
+                        Log.i(TAG, "Wake word detected (score ${detector.lastScore})")
+                        triggered = true
+                        break
+                    }
+                }
+            } finally {
+                record.stop()
+                record.release()
+            }
+
+            // The microphone is released before the assistant opens its own capture
+            if (triggered) activateAssistant(detector.getPreroll())
+        }
+    }
+
+    private fun activateAssistant(preroll: ShortArray) {
+        val prerollFile = File(cacheDir, "wakeword_preroll.pcm")
+        try {
+            val bytes = ByteBuffer.allocate(preroll.size * 2).order(ByteOrder.LITTLE_ENDIAN)
+            bytes.asShortBuffer().put(preroll)
+            prerollFile.writeBytes(bytes.array())
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to write pre-roll", e)
+            prerollFile.delete()
+        }
+
+        val intent = Intent(this, AssistantService::class.java).apply {
+            action = AssistantService.ACTION_ACTIVATE
+            putExtra(AssistantService.EXTRA_TRIGGER, "wake_word")
+            if (prerollFile.isFile) putExtra(AssistantService.EXTRA_PREROLL_PATH, prerollFile.absolutePath)
+        }
+        startForegroundService(intent)
+    }
+
+    private fun createNotification(): Notification {
+        val pendingIntent = PendingIntent.getActivity(
+            this,
+            0,
+            Intent(this, MainActivity::class.java),
+            PendingIntent.FLAG_IMMUTABLE
+        )
+
+        return NotificationCompat.Builder(this, AssistantApplication.CHANNEL_SERVICE)
+            .setContentTitle("AI Assistant")
+            .setContentText("Listening for wake word")
+            .setSmallIcon(R.drawable.ic_assistant)
+            .setContentIntent(pendingIntent)
+            .setOngoing(true)
+            .build()
+    }
+}
@@ -1,6 +1,5 @@
 package com.satory.graphenosai.storage
 
-import android.content.Context
 import android.util.Log
 import com.satory.graphenosai.llm.ChatSession
 import org.json.JSONArray
@@ -11,9 +10,9 @@ import java.util.*
 
 /**
  * Manages chat history persistence on device.
- * Each chat session is saved as a JSON file.
+ * Each chat session is saved as a JSON file under [filesDir].
  */
-class ChatHistoryManager(private val context: Context) {
+class ChatHistoryManager(private val filesDir: File) {
     
     companion object {
         private const val TAG = "ChatHistoryManager"
@@ -30,7 +29,7 @@ class ChatHistoryManager(private val context: Context) {
     )
     
     private val historyDir: File
-        get() = File(context.filesDir, HISTORY_DIR).also { 
+        get() = File(filesDir, HISTORY_DIR).also { 
             if (!it.exists()) it.mkdirs() 
         }
     
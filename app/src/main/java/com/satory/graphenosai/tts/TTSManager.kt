@@ -1,11 +1,23 @@
 package com.satory.graphenosai.tts
 
 import android.content.Context
+import android.media.AudioAttributes
+import android.media.AudioFormat
+import android.media.AudioTrack
+import android.os.Bundle
 import android.speech.tts.TextToSpeech
 import android.speech.tts.UtteranceProgressListener
 import android.util.Log
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.delay
 import kotlinx.coroutines.suspendCancellableCoroutine
+import kotlinx.coroutines.withContext
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import java.util.Locale
+import java.util.concurrent.ConcurrentHashMap
 import kotlin.coroutines.resume
 
 /**
@@ -18,6 +30,11 @@ class TTSManager(context: Context) {
         private const val TAG = "TTSManager"
         private const val UTTERANCE_ID_PREFIX = "assistant_tts_"
         
+        // Duplex playback: sentences are grouped up to this length per synthesis
+        private const val DUPLEX_GROUP_CHARS = 300
+        private const val DUPLEX_DIR = "tts_duplex"
+        private const val WRITE_CHUNK_MS = 20
+        
         /**
          * Check if TTS is available on this device without initializing it.
          */
@@ -35,6 +52,22 @@ class TTSManager(context: Context) {
     private var tts: TextToSpeech? = null
     private var isInitialized = false
     private var utteranceCounter = 0
+    
+    // Duplex playback state: the clip currently handed to our own AudioTrack
+    private val duplexDir = File(context.cacheDir, DUPLEX_DIR)
+    private val pendingSynthesis = ConcurrentHashMap<String, Pair<CompletableDeferred<File?>, File>>()
+    private val playbackLock = Any()
+    private var currentClip: Clip? = null
+    @Volatile private var duplexStopped = false
+    
+    /** Called when the first audio of a [speak] or [speakDuplex] call starts playing. */
+    @Volatile var onAudioStart: (() -> Unit)? = null
+    
+    private class Clip(val pcm: ShortArray, val sampleRate: Int, val track: AudioTrack) {
+        var reported = 0
+    }
+    
+    private class Wav(val pcm: ShortArray, val sampleRate: Int)
 
     init {
         tts = TextToSpeech(context) { status ->
@@ -75,6 +108,7 @@ class TTSManager(context: Context) {
         
         // Split long text into chunks to avoid TTS limits
         val chunks = splitIntoChunks(text, 4000)
+        tts?.setOnUtteranceProgressListener(playbackListener)
         
         chunks.forEachIndexed { index, chunk ->
             val mode = if (index == 0) queueMode else TextToSpeech.QUEUE_ADD
@@ -136,18 +170,80 @@ class TTSManager(context: Context) {
         }
     }
 
+    /**
+     * Speak text through an AudioTrack owned by this manager, so the PCM that
+     * reaches the speaker can be tapped with [drainPlayed] as the echo
+     * reference for barge-in. Sentences are synthesized to files a group at a
+     * time, the next group while the current one plays. Suspends until
+     * playback ends or [stop] is called; returns false if nothing could be
+     * played (e.g. the engine does not write 16-bit mono WAV).
+     */
+    suspend fun speakDuplex(text: String): Boolean = withContext(Dispatchers.IO) {
+        if (!isInitialized) return@withContext false
+        duplexStopped = false
+        duplexDir.mkdirs()
+        duplexDir.listFiles()?.forEach { it.delete() }
+        tts?.setOnUtteranceProgressListener(synthesisListener)
+
+        val utteranceId = "${UTTERANCE_ID_PREFIX}${utteranceCounter++}"
+        val groups = splitIntoSentenceGroups(text, DUPLEX_GROUP_CHARS)
+        var next = synthesize(groups[0], "$utteranceId-0")
+        var played = false
+        for (index in groups.indices) {
+            val file = next.await()
+            if (duplexStopped) break
+            if (index + 1 < groups.size) next = synthesize(groups[index + 1], "$utteranceId-${index + 1}")
+
+            val wav = file?.let { readWav(it) }
+            file?.delete()
+            if (wav == null) {
+                Log.w(TAG, "Duplex synthesis failed for chunk $index")
+                if (!played) return@withContext false
+                continue
+            }
+            if (play(wav, if (played) null else onAudioStart)) played = true
+        }
+        played
+    }
+
+    /**
+     * Hand the PCM that reached the speaker since the last call to [sink]
+     * as (samples, offset, length, sample rate). Returns false when no duplex
+     * clip is playing, so the caller can account for silence instead.
+     */
+    fun drainPlayed(sink: (ShortArray, Int, Int, Int) -> Unit): Boolean = synchronized(playbackLock) {
+        val clip = currentClip ?: return false
+        val head = clip.track.playbackHeadPosition.coerceIn(0, clip.pcm.size)
+        if (head > clip.reported) {
+            sink(clip.pcm, clip.reported, head - clip.reported, clip.sampleRate)
+            clip.reported = head
+        }
+        true
+    }
+
     /**
      * Stop ongoing speech.
      */
     fun stop() {
+        duplexStopped = true
         tts?.stop()
+        synchronized(playbackLock) {
+            currentClip?.track?.let {
+                try {
+                    it.pause()
+                    it.flush()
+                } catch (e: IllegalStateException) {
+                    Log.w(TAG, "Failed to stop duplex playback", e)
+                }
+            }
+        }
     }
 
     /**
      * Check if currently speaking.
      */
     fun isSpeaking(): Boolean {
-        return tts?.isSpeaking == true
+        return tts?.isSpeaking == true || synchronized(playbackLock) { currentClip != null }
     }
 
     /**
@@ -180,12 +276,169 @@ class TTSManager(context: Context) {
     }
 
     fun shutdown() {
-        tts?.stop()
+        stop()
         tts?.shutdown()
         tts = null
         isInitialized = false
     }
 
+    private val playbackListener = object : UtteranceProgressListener() {
+        override fun onStart(id: String?) {
+            if (id?.endsWith("-0") == true) onAudioStart?.invoke()
+        }
+
+        override fun onDone(id: String?) {}
+
+        @Deprecated("Deprecated in Java")
+        override fun onError(id: String?) {}
+    }
+
+    private val synthesisListener = object : UtteranceProgressListener() {
+        override fun onStart(id: String?) {}
+
+        override fun onDone(id: String?) {
+            pendingSynthesis.remove(id)?.let { (result, file) -> result.complete(file) }
+        }
+
+        @Deprecated("Deprecated in Java")
+        override fun onError(id: String?) {
+            pendingSynthesis.remove(id)?.let { (result, file) ->
+                file.delete()
+                result.complete(null)
+            }
+        }
+
+        override fun onStop(id: String?, interrupted: Boolean) {
+            pendingSynthesis.remove(id)?.let { (result, file) ->
+                file.delete()
+                result.complete(null)
+            }
+        }
+    }
+
+    private fun synthesize(text: String, id: String): CompletableDeferred<File?> {
+        val file = File(duplexDir, "$id.wav")
+        val result = CompletableDeferred<File?>()
+        pendingSynthesis[id] = result to file
+        if (tts?.synthesizeToFile(text, Bundle(), file, id) != TextToSpeech.SUCCESS) {
+            pendingSynthesis.remove(id)
+            result.complete(null)
+        }
+        return result
+    }
+
+    /** Play one clip to the end (or until [stop]); the head position drives [drainPlayed]. */
+    private suspend fun play(wav: Wav, onStarted: (() -> Unit)? = null): Boolean {
+        val track = try {
+            AudioTrack.Builder()
+                .setAudioAttributes(
+                    AudioAttributes.Builder()
+                        .setUsage(AudioAttributes.USAGE_ASSISTANT)
+                        .setContentType(AudioAttributes.CONTENT_TYPE_SPEECH)
+                        .build()
+                )
+                .setAudioFormat(
+                    AudioFormat.Builder()
+                        .setEncoding(AudioFormat.ENCODING_PCM_16BIT)
+                        .setSampleRate(wav.sampleRate)
+                        .setChannelMask(AudioFormat.CHANNEL_OUT_MONO)
+                        .build()
+                )
+                .setTransferMode(AudioTrack.MODE_STREAM)
+                .build()
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to create AudioTrack", e)
+            return false
+        }
+        if (track.state != AudioTrack.STATE_INITIALIZED) {
+            track.release()
+            return false
+        }
+
+        synchronized(playbackLock) { currentClip = Clip(wav.pcm, wav.sampleRate, track) }
+        try {
+            track.play()
+            onStarted?.invoke()
+            val chunk = wav.sampleRate * WRITE_CHUNK_MS / 1000
+            var written = 0
+            while (written < wav.pcm.size && !duplexStopped) {
+                val n = track.write(wav.pcm, written, minOf(chunk, wav.pcm.size - written))
+                if (n <= 0) break
+                written += n
+            }
+            while (!duplexStopped && track.playbackHeadPosition < written) delay(10)
+        } finally {
+            synchronized(playbackLock) { currentClip = null }
+            try {
+                track.stop()
+            } catch (e: IllegalStateException) {
+                Log.w(TAG, "AudioTrack stop failed", e)
+            }
+            track.release()
+        }
+        return true
+    }
+
+    /** 16-bit mono PCM WAV as written by synthesizeToFile; null for anything else. */
+    private fun readWav(file: File): Wav? {
+        val bytes = try {
+            file.readBytes()
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to read synthesized audio", e)
+            return null
+        }
+        if (bytes.size < 12 ||
+            String(bytes, 0, 4, Charsets.US_ASCII) != "RIFF" ||
+            String(bytes, 8, 4, Charsets.US_ASCII) != "WAVE") {
+            return null
+        }
+
+        val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+        var channels = 0
+        var bits = 0
+        var sampleRate = 0
+        var pos = 12
+        while (pos + 8 <= bytes.size) {
+            val id = String(bytes, pos, 4, Charsets.US_ASCII)
+            var size = buffer.getInt(pos + 4)
+            val body = pos + 8
+            if (id == "fmt " && size >= 16) {
+                channels = buffer.getShort(body + 2).toInt()
+                sampleRate = buffer.getInt(body + 4)
+                bits = buffer.getShort(body + 14).toInt()
+            } else if (id == "data") {
+                if (channels != 1 || bits != 16 || sampleRate <= 0) return null
+                // Engines that stream the file may leave the size unset
+                if (size < 0 || body + size > bytes.size) size = bytes.size - body
+                val pcm = ShortArray(size / 2)
+                buffer.position(body)
+                buffer.slice().order(ByteOrder.LITTLE_ENDIAN).asShortBuffer().get(pcm)
+                return Wav(pcm, sampleRate)
+            }
+            if (size < 0) return null
+            pos = body + size + (size and 1)
+        }
+        return null
+    }
+
+    /** Whole sentences, joined up to [maxLength] characters per group. */
+    private fun splitIntoSentenceGroups(text: String, maxLength: Int): List<String> {
+        val groups = mutableListOf<String>()
+        val current = StringBuilder()
+        for (sentence in text.split(Regex("(?<=[.!?])\\s+"))) {
+            if (sentence.isBlank()) continue
+            if (current.isNotEmpty() && current.length + sentence.length + 1 > maxLength) {
+                groups.add(current.toString())
+                current.clear()
+            }
+            if (current.isNotEmpty()) current.append(' ')
+            current.append(sentence)
+        }
+        if (current.isNotEmpty()) groups.add(current.toString())
+        // A single sentence can still exceed the engine's input limit
+        return groups.flatMap { splitIntoChunks(it, 4000) }.ifEmpty { listOf(text) }
+    }
+
     private fun splitIntoChunks(text: String, maxLength: Int): List<String> {
         if (text.length <= maxLength) {
             return listOf(text)
@@ -40,6 +40,7 @@ import androidx.compose.ui.platform.LocalContext
 import androidx.compose.ui.text.font.FontWeight
 import androidx.compose.ui.unit.dp
 import androidx.lifecycle.compose.collectAsStateWithLifecycle
+import com.satory.graphenosai.llm.ResponseBuffer
 import com.satory.graphenosai.service.AssistantService
 import com.satory.graphenosai.service.AssistantState
 import com.satory.graphenosai.ui.theme.AiintegratedintoandroidTheme
@@ -85,7 +86,13 @@ class CompactAssistantActivity : ComponentActivity() {
                 
                 if (service != null) {
                     val state by service!!.assistantState.collectAsStateWithLifecycle()
-                    val response by service!!.response.collectAsStateWithLifecycle()
+                    val finalResponse by service!!.response.collectAsStateWithLifecycle()
+                    val streaming by service!!.streamingResponse.collectAsStateWithLifecycle()
+                    // Each token copies only the unsettled tail; finished markdown blocks are kept as they are
+                    val streamReader = remember { ResponseBuffer.Reader() }
+                    val streamed = remember(streaming) { streamReader.read(streaming) }
+                    val finished = remember(finalResponse) { ResponseBuffer.Blocks.of(finalResponse) }
+                    val response = if (state is AssistantState.Responding && !streamed.isEmpty()) streamed else finished
                     val messages by service!!.chatMessages.collectAsStateWithLifecycle()
                     val transcription by service!!.transcription.collectAsStateWithLifecycle()
                     val pendingUrls by service!!.pendingUrls.collectAsStateWithLifecycle()
@@ -183,7 +190,7 @@ fun CompactAssistantView(
     service: AssistantService,
     state: AssistantState,
     transcription: String,
-    response: String,
+    response: ResponseBuffer.Blocks,
     onExpand: () -> Unit,
     onDismiss: () -> Unit
 ) {
@@ -303,12 +310,13 @@ fun CompactAssistantView(
         ""
     }
     
-    // Show response
-    val displayResponse = when {
-        response.isNotEmpty() -> response
-        state is AssistantState.Error -> state.message
-        else -> ""
+    // Show response; an error is plain text, so only it joins the blocks
+    val errorText = when {
+        state !is AssistantState.Error -> ""
+        !response.isEmpty() -> response.text()
+        else -> state.message
     }
+    val hasResponse = !response.isEmpty() || errorText.isNotEmpty()
     
     // Status text when idle or listening
     val statusText = when (state) {
@@ -385,7 +393,7 @@ fun CompactAssistantView(
                 }
                 
                 // Content area - shows transcription and response
-                if (displayTranscription.isNotEmpty() || displayResponse.isNotEmpty() || statusText.isNotEmpty()) {
+                if (displayTranscription.isNotEmpty() || hasResponse || statusText.isNotEmpty()) {
                     Spacer(modifier = Modifier.height(12.dp))
                     
                     Column(
@@ -405,7 +413,7 @@ fun CompactAssistantView(
                                 color = MaterialTheme.colorScheme.primary,
                                 fontWeight = FontWeight.Medium
                             )
-                            if (displayResponse.isNotEmpty()) {
+                            if (hasResponse) {
                                 Spacer(modifier = Modifier.height(8.dp))
                             }
                         }
@@ -420,16 +428,16 @@ fun CompactAssistantView(
                         }
                         
                         // AI Response with Markdown
-                        if (displayResponse.isNotEmpty()) {
-                            if (state is AssistantState.Error) {
+                        if (hasResponse) {
+                            if (errorText.isNotEmpty()) {
                                 Text(
-                                    displayResponse,
+                                    errorText,
                                     style = MaterialTheme.typography.bodyMedium,
                                     color = MaterialTheme.colorScheme.error
                                 )
                             } else {
-                                MarkdownText(
-                                    text = displayResponse,
+                                StreamedMarkdownText(
+                                    blocks = response,
                                     color = MaterialTheme.colorScheme.onSurface,
                                     linkColor = MaterialTheme.colorScheme.primary,
                                     onLinkClick = { url ->
@@ -444,7 +452,7 @@ fun CompactAssistantView(
                     }
                     
                     // Auto-scroll to bottom
-                    LaunchedEffect(displayResponse, displayTranscription) {
+                    LaunchedEffect(response, errorText, displayTranscription) {
                         scrollState.animateScrollTo(scrollState.maxValue)
                     }
                 }
@@ -692,7 +700,7 @@ fun CompactAssistantView(
 fun FullChatScreen(
     service: AssistantService,
     state: AssistantState,
-    response: String,
+    response: ResponseBuffer.Blocks,
     transcription: String,
     messages: List<com.satory.graphenosai.llm.ChatSession.Message>,
     webSearchEnabled: Boolean,
@@ -1195,10 +1203,11 @@ fun FullChatScreen(
             }
             
             // Current streaming response
-            if (response.isNotEmpty() && state is AssistantState.Responding) {
+            if (!response.isEmpty() && state is AssistantState.Responding) {
                 MessageBubble(
                     isUser = false,
-                    content = response,
+                    content = "",
+                    streamed = response,
                     isStreaming = true
                 )
             }
@@ -1261,7 +1270,8 @@ fun MessageBubble(
     isUser: Boolean,
     content: String,
     isStreaming: Boolean = false,
-    imageBase64: String? = null
+    imageBase64: String? = null,
+    streamed: ResponseBuffer.Blocks? = null
 ) {
     val context = LocalContext.current
     
@@ -1324,20 +1334,30 @@ fun MessageBubble(
                         )
                     } else {
                         // Markdown rendering for AI responses
-                        MarkdownText(
-                            text = content,
-                            color = MaterialTheme.colorScheme.onSurface,
-                            linkColor = MaterialTheme.colorScheme.primary,
-                            onLinkClick = { url ->
-                                // Check for "open" command patterns
-                                try {
-                                    val intent = Intent(Intent.ACTION_VIEW, Uri.parse(url))
-                                    context.startActivity(intent)
-                                } catch (e: Exception) {
-                                    // URL parsing failed
-                                }
+                        val openLink: (String) -> Unit = { url ->
+                            // Check for "open" command patterns
+                            try {
+                                val intent = Intent(Intent.ACTION_VIEW, Uri.parse(url))
+                                context.startActivity(intent)
+                            } catch (e: Exception) {
+                                // URL parsing failed
                             }
-                        )
+                        }
+                        if (streamed != null) {
+                            StreamedMarkdownText(
+                                blocks = streamed,
+                                color = MaterialTheme.colorScheme.onSurface,
+                                linkColor = MaterialTheme.colorScheme.primary,
+                                onLinkClick = openLink
+                            )
+                        } else {
+                            MarkdownText(
+                                text = content,
+                                color = MaterialTheme.colorScheme.onSurface,
+                                linkColor = MaterialTheme.colorScheme.primary,
+                                onLinkClick = openLink
+                            )
+                        }
                     }
                     if (isStreaming) {
                         Spacer(modifier = Modifier.width(4.dp))
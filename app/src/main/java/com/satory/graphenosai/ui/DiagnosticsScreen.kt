@@ -0,0 +1,203 @@
+package com.satory.graphenosai.ui
+
+import androidx.compose.foundation.layout.*
+import androidx.compose.foundation.lazy.LazyColumn
+import androidx.compose.foundation.lazy.items
+import androidx.compose.material.icons.Icons
+import androidx.compose.material.icons.automirrored.filled.ArrowBack
+import androidx.compose.material.icons.filled.Delete
+import androidx.compose.material3.*
+import androidx.compose.runtime.*
+import androidx.compose.ui.Alignment
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.text.font.FontFamily
+import androidx.compose.ui.text.font.FontWeight
+import androidx.compose.ui.unit.dp
+import com.satory.graphenosai.diagnostics.LatencyMetrics
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
+
+private enum class LatencyWindow(val label: String, val spanMs: Long) {
+    DAY("24 h", 24L * 60 * 60 * 1000),
+    WEEK("7 days", 7L * 24 * 60 * 60 * 1000),
+    ALL("All", 0L)
+}
+
+/**
+ * Voice-to-answer latency percentiles per stage, from the on-device
+ * history kept by [LatencyMetrics].
+ */
+@OptIn(ExperimentalMaterial3Api::class)
+@Composable
+fun DiagnosticsScreen(onNavigateBack: () -> Unit) {
+    val scope = rememberCoroutineScope()
+    var window by remember { mutableStateOf(LatencyWindow.DAY) }
+    var summaries by remember { mutableStateOf<List<LatencyMetrics.Summary>>(emptyList()) }
+    var storedSamples by remember { mutableStateOf(0) }
+    var refresh by remember { mutableStateOf(0) }
+    var showClearDialog by remember { mutableStateOf(false) }
+
+    // Windowed views re-read the ring file; keep that off the main thread
+    LaunchedEffect(window, refresh) {
+        withContext(Dispatchers.IO) {
+            val since = if (window.spanMs > 0) System.currentTimeMillis() - window.spanMs else 0L
+            summaries = LatencyMetrics.summaries(since)
+            storedSamples = LatencyMetrics.storedSamples()
+        }
+    }
+
+    Scaffold(
+        topBar = {
+            TopAppBar(
+                title = {
+                    Column {
+                        Text("Diagnostics")
+                        Text(
+                            "$storedSamples samples stored",
+                            style = MaterialTheme.typography.bodySmall,
+                            color = MaterialTheme.colorScheme.onSurfaceVariant
+                        )
+                    }
+                },
+                navigationIcon = {
+                    IconButton(onClick = onNavigateBack) {
+                        Icon(Icons.AutoMirrored.Filled.ArrowBack, contentDescription = "Back")
+                    }
+                },
+                actions = {
+                    IconButton(onClick = { showClearDialog = true }) {
+                        Icon(Icons.Default.Delete, contentDescription = "Clear history")
+                    }
+                }
+            )
+        }
+    ) { padding ->
+        LazyColumn(
+            modifier = Modifier
+                .fillMaxSize()
+                .padding(padding),
+            contentPadding = PaddingValues(16.dp),
+            verticalArrangement = Arrangement.spacedBy(12.dp)
+        ) {
+            item {
+                Text(
+                    "Voice-to-answer latency",
+                    style = MaterialTheme.typography.titleMedium,
+                    fontWeight = FontWeight.Bold,
+                    color = MaterialTheme.colorScheme.primary
+                )
+                Row(
+                    modifier = Modifier.padding(top = 8.dp),
+                    horizontalArrangement = Arrangement.spacedBy(8.dp)
+                ) {
+                    LatencyWindow.values().forEach { option ->
+                        FilterChip(
+                            selected = window == option,
+                            onClick = { window = option },
+                            label = { Text(option.label) }
+                        )
+                    }
+                }
+            }
+
+            items(summaries, key = { it.stage.id }) { summary ->
+                LatencyStageCard(summary)
+            }
+        }
+    }
+
+    if (showClearDialog) {
+        AlertDialog(
+            onDismissRequest = { showClearDialog = false },
+            title = { Text("Clear latency history?") },
+            text = { Text("All recorded samples are deleted from this device.") },
+            confirmButton = {
+                TextButton(
+                    onClick = {
+                        showClearDialog = false
+                        scope.launch {
+                            withContext(Dispatchers.IO) { LatencyMetrics.clear() }
+                            refresh++
+                        }
+                    },
+                    colors = ButtonDefaults.textButtonColors(
+                        contentColor = MaterialTheme.colorScheme.error
+                    )
+                ) {
+                    Text("Clear")
+                }
+            },
+            dismissButton = {
+                TextButton(onClick = { showClearDialog = false }) {
+                    Text("Cancel")
+                }
+            }
+        )
+    }
+}
+
+@Composable
+private fun LatencyStageCard(summary: LatencyMetrics.Summary) {
+    Card(modifier = Modifier.fillMaxWidth()) {
+        Column(modifier = Modifier.padding(16.dp)) {
+            Row(
+                modifier = Modifier.fillMaxWidth(),
+                verticalAlignment = Alignment.CenterVertically
+            ) {
+                Text(
+                    summary.stage.label,
+                    style = MaterialTheme.typography.titleSmall,
+                    modifier = Modifier.weight(1f)
+                )
+                Text(
+                    "${summary.count} turns",
+                    style = MaterialTheme.typography.bodySmall,
+                    color = MaterialTheme.colorScheme.onSurfaceVariant
+                )
+            }
+            if (summary.count == 0L) {
+                Text(
+                    "No samples yet",
+                    style = MaterialTheme.typography.bodySmall,
+                    color = MaterialTheme.colorScheme.onSurfaceVariant,
+                    modifier = Modifier.padding(top = 8.dp)
+                )
+                return@Column
+            }
+            Row(
+                modifier = Modifier
+                    .fillMaxWidth()
+                    .padding(top = 8.dp),
+                horizontalArrangement = Arrangement.SpaceBetween
+            ) {
+                LatencyValue("p50", summary.p50)
+                LatencyValue("p90", summary.p90)
+                LatencyValue("p99", summary.p99)
+                LatencyValue("max", summary.max)
+            }
+        }
+    }
+}
+
+@Composable
+private fun LatencyValue(label: String, valueMs: Long) {
+    Column(horizontalAlignment = Alignment.CenterHorizontally) {
+        Text(
+            formatLatency(valueMs),
+            style = MaterialTheme.typography.bodyLarge,
+            fontFamily = FontFamily.Monospace
+        )
+        Text(
+            label,
+            style = MaterialTheme.typography.labelSmall,
+            color = MaterialTheme.colorScheme.onSurfaceVariant
+        )
+    }
+}
+
+private fun formatLatency(ms: Long): String = when {
+    ms < 1000 -> "$ms ms"
+    ms < 60_000 -> "%.2f s".format(ms / 1000.0)
+    else -> "%.1f min".format(ms / 60_000.0)
+}
@@ -15,6 +15,8 @@ class SettingsManager(context: Context) {
         private const val KEY_SYSTEM_PROMPT = "system_prompt"
         private const val KEY_VOICE_INPUT_METHOD = "voice_input_method"
         private const val KEY_TTS_ENABLED = "tts_enabled"
+        private const val KEY_BARGE_IN_ENABLED = "barge_in_enabled"
+        private const val KEY_RECORD_SESSIONS = "record_sessions"
         private const val KEY_AUTO_SEND_VOICE = "auto_send_voice"
         private const val KEY_AUTO_START_VOICE = "auto_start_voice"
         private const val KEY_VOICE_LANGUAGE = "voice_language"
@@ -23,6 +25,18 @@ class SettingsManager(context: Context) {
         private const val KEY_API_PROVIDER = "api_provider"
         private const val KEY_WHISPER_PROVIDER = "whisper_provider"
         private const val KEY_SEARCH_ENGINE = "search_engine"
+        private const val KEY_WAKE_WORD_ENABLED = "wake_word_enabled"
+        private const val KEY_WAKE_WORD_THRESHOLD = "wake_word_threshold"
+        private const val KEY_ENDPOINT_VOSK = "endpoint_vosk_enabled"
+        private const val KEY_ENDPOINT_WHISPER = "endpoint_whisper_enabled"
+        private const val KEY_ENDPOINT_VOSK_HANGOVER = "endpoint_vosk_hangover_ms"
+        private const val KEY_ENDPOINT_WHISPER_HANGOVER = "endpoint_whisper_hangover_ms"
+        
+        const val DEFAULT_WAKE_WORD_THRESHOLD = 0.85f
+        
+        // Trailing silence before capture stops; Vosk also stops early on its own endpoint
+        const val DEFAULT_VOSK_HANGOVER_MS = 700
+        const val DEFAULT_WHISPER_HANGOVER_MS = 900
         
         const val VOICE_INPUT_SYSTEM = "system"
         const val VOICE_INPUT_VOSK = "vosk"
@@ -145,6 +159,11 @@ class SettingsManager(context: Context) {
         get() = prefs.getBoolean(KEY_TTS_ENABLED, true)
         set(value) = prefs.edit().putBoolean(KEY_TTS_ENABLED, value).apply()
     
+    /** Keep the microphone open while speaking so the user can interrupt the response. */
+    var bargeInEnabled: Boolean
+        get() = prefs.getBoolean(KEY_BARGE_IN_ENABLED, false)
+        set(value) = prefs.edit().putBoolean(KEY_BARGE_IN_ENABLED, value).apply()
+    
     var autoSendVoice: Boolean
         get() = prefs.getBoolean(KEY_AUTO_SEND_VOICE, true)
         set(value) = prefs.edit().putBoolean(KEY_AUTO_SEND_VOICE, value).apply()
@@ -153,6 +172,46 @@ class SettingsManager(context: Context) {
         get() = prefs.getBoolean(KEY_AUTO_START_VOICE, false)
         set(value) = prefs.edit().putBoolean(KEY_AUTO_START_VOICE, value).apply()
     
+    var wakeWordEnabled: Boolean
+        get() = prefs.getBoolean(KEY_WAKE_WORD_ENABLED, false)
+        set(value) = prefs.edit().putBoolean(KEY_WAKE_WORD_ENABLED, value).apply()
+    
+    /** Smoothed keyword posterior needed to trigger; lower is more sensitive. */
+    var wakeWordThreshold: Float
+        get() = prefs.getFloat(KEY_WAKE_WORD_THRESHOLD, DEFAULT_WAKE_WORD_THRESHOLD)
+        set(value) = prefs.edit().putFloat(KEY_WAKE_WORD_THRESHOLD, value.coerceIn(0.5f, 0.99f)).apply()
+    
+    /** Automatic end-of-speech detection, per recognition engine. */
+    fun isEndpointingEnabled(voiceMethod: String): Boolean = when (voiceMethod) {
+        VOICE_INPUT_VOSK -> prefs.getBoolean(KEY_ENDPOINT_VOSK, true)
+        VOICE_INPUT_WHISPER -> prefs.getBoolean(KEY_ENDPOINT_WHISPER, true)
+        else -> false // the system recognizer endpoints by itself
+    }
+    
+    fun setEndpointingEnabled(voiceMethod: String, enabled: Boolean) {
+        val key = when (voiceMethod) {
+            VOICE_INPUT_VOSK -> KEY_ENDPOINT_VOSK
+            VOICE_INPUT_WHISPER -> KEY_ENDPOINT_WHISPER
+            else -> return
+        }
+        prefs.edit().putBoolean(key, enabled).apply()
+    }
+    
+    fun getEndpointHangoverMs(voiceMethod: String): Int = when (voiceMethod) {
+        VOICE_INPUT_WHISPER -> prefs.getInt(KEY_ENDPOINT_WHISPER_HANGOVER, DEFAULT_WHISPER_HANGOVER_MS)
+        else -> prefs.getInt(KEY_ENDPOINT_VOSK_HANGOVER, DEFAULT_VOSK_HANGOVER_MS)
+    }
+    
+    fun setEndpointHangoverMs(voiceMethod: String, hangoverMs: Int) {
+        val key = if (voiceMethod == VOICE_INPUT_WHISPER) KEY_ENDPOINT_WHISPER_HANGOVER else KEY_ENDPOINT_VOSK_HANGOVER
+        prefs.edit().putInt(key, hangoverMs.coerceIn(300, 3000)).apply()
+    }
+    
+    /** Save each turn's audio, transcript and API stream for offline replay (diagnostics). */
+    var recordSessions: Boolean
+        get() = prefs.getBoolean(KEY_RECORD_SESSIONS, false)
+        set(value) = prefs.edit().putBoolean(KEY_RECORD_SESSIONS, value).apply()
+    
     var apiProvider: String
         get() = prefs.getString(KEY_API_PROVIDER, PROVIDER_OPENROUTER) ?: PROVIDER_OPENROUTER
         set(value) = prefs.edit().putString(KEY_API_PROVIDER, value).apply()
@@ -4,6 +4,9 @@ import android.content.ClipData
 import android.content.ClipboardManager
 import android.content.Intent
 import android.net.Uri
+import android.widget.Toast
+import androidx.activity.compose.rememberLauncherForActivityResult
+import androidx.activity.result.contract.ActivityResultContracts
 import androidx.compose.foundation.clickable
 import androidx.compose.foundation.layout.*
 import androidx.compose.foundation.lazy.LazyColumn
@@ -31,16 +34,22 @@ import androidx.compose.ui.window.Dialog
 import androidx.compose.ui.window.DialogProperties
 import com.satory.graphenosai.AssistantApplication
 import com.satory.graphenosai.audio.VoskTranscriber
+import com.satory.graphenosai.audio.WakeWordEngine
 import com.satory.graphenosai.llm.GitHubCopilotAuth
 import com.satory.graphenosai.service.AssistantService
+import com.satory.graphenosai.service.WakeWordService
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 
 @OptIn(ExperimentalMaterial3Api::class)
 @Composable
 fun SettingsScreen(
     onNavigateBack: () -> Unit,
     assistantService: AssistantService? = null,
-    onNavigateToLanguages: (() -> Unit)? = null
+    onNavigateToLanguages: (() -> Unit)? = null,
+    onNavigateToDiagnostics: (() -> Unit)? = null,
+    onNavigateToTranscription: (() -> Unit)? = null
 ) {
     val context = LocalContext.current
     val app = context.applicationContext as AssistantApplication
@@ -53,8 +62,11 @@ fun SettingsScreen(
     var systemPrompt by remember { mutableStateOf(settingsManager.systemPrompt) }
     var voiceInputMethod by remember { mutableStateOf(settingsManager.voiceInputMethod) }
     var ttsEnabled by remember { mutableStateOf(settingsManager.ttsEnabled) }
+    var bargeInEnabled by remember { mutableStateOf(settingsManager.bargeInEnabled) }
+    var recordSessions by remember { mutableStateOf(settingsManager.recordSessions) }
     var autoSendVoice by remember { mutableStateOf(settingsManager.autoSendVoice) }
     var autoStartVoice by remember { mutableStateOf(settingsManager.autoStartVoice) }
+    var wakeWordEnabled by remember { mutableStateOf(settingsManager.wakeWordEnabled) }
     var apiProvider by remember { mutableStateOf(settingsManager.apiProvider) }
     var multilingualEnabled by remember { mutableStateOf(settingsManager.multilingualEnabled) }
     var secondaryLanguage by remember { mutableStateOf(settingsManager.secondaryVoiceLanguage) }
@@ -587,6 +599,80 @@ fun SettingsScreen(
                         settingsManager.autoStartVoice = it
                     }
                 )
+                
+                if (voiceInputMethod != SettingsManager.VOICE_INPUT_SYSTEM) {
+                    var endpointingEnabled by remember(voiceInputMethod) {
+                        mutableStateOf(settingsManager.isEndpointingEnabled(voiceInputMethod))
+                    }
+                    SettingsItemWithSwitch(
+                        icon = Icons.Default.MicOff,
+                        title = "Stop listening automatically",
+                        subtitle = "End recording ${settingsManager.getEndpointHangoverMs(voiceInputMethod)} ms after you stop speaking",
+                        checked = endpointingEnabled,
+                        onCheckedChange = {
+                            endpointingEnabled = it
+                            settingsManager.setEndpointingEnabled(voiceInputMethod, it)
+                        }
+                    )
+                }
+                
+                var wakeWordModelInstalled by remember { mutableStateOf(WakeWordEngine.isModelInstalled(context)) }
+                val wakeWordModelPicker = rememberLauncherForActivityResult(
+                    contract = ActivityResultContracts.OpenDocument()
+                ) { uri ->
+                    if (uri == null) return@rememberLauncherForActivityResult
+                    scope.launch {
+                        val installed = withContext(Dispatchers.IO) { WakeWordEngine.installModel(context, uri) }
+                        if (installed) {
+                            wakeWordModelInstalled = true
+                            // A running listener still holds the previous model
+                            if (wakeWordEnabled) {
+                                WakeWordService.stop(context)
+                                WakeWordService.start(context)
+                            }
+                        }
+                        Toast.makeText(
+                            context,
+                            if (installed) "Wake word model installed" else "Not a valid keyword model",
+                            Toast.LENGTH_SHORT
+                        ).show()
+                    }
+                }
+                if (onNavigateToTranscription != null) {
+                    SettingsItem(
+                        icon = Icons.Default.AudioFile,
+                        title = "Transcribe recordings",
+                        subtitle = "Long recordings, on-device with Whisper, resumed if the app is stopped",
+                        onClick = onNavigateToTranscription
+                    )
+                }
+                SettingsItemWithSwitch(
+                    icon = Icons.Default.RecordVoiceOver,
+                    title = "Wake word",
+                    subtitle = when {
+                        !wakeWordModelInstalled -> "Import a keyword model below to enable"
+                        !WakeWordService.hasMicrophonePermission(context) -> "Needs the microphone permission"
+                        else -> "Listen on-device for the wake word and open the assistant"
+                    },
+                    checked = wakeWordEnabled,
+                    onCheckedChange = {
+                        wakeWordEnabled = it
+                        settingsManager.wakeWordEnabled = it
+                        // Without the permission the listener starts from MainActivity once it is granted
+                        if (it) WakeWordService.start(context) else WakeWordService.stop(context)
+                    },
+                    enabled = wakeWordModelInstalled || wakeWordEnabled
+                )
+                SettingsItem(
+                    icon = Icons.Default.FileOpen,
+                    title = "Import wake word model",
+                    subtitle = if (wakeWordModelInstalled) {
+                        "Replace the installed ${WakeWordEngine.MODEL_FILE}"
+                    } else {
+                        "Pick a ${WakeWordEngine.MODEL_FILE} keyword model file"
+                    },
+                    onClick = { wakeWordModelPicker.launch(arrayOf("*/*")) }
+                )
             }
             
             // Output Section
@@ -609,6 +695,18 @@ fun SettingsScreen(
                     enabled = ttsAvailable
                 )
                 
+                SettingsItemWithSwitch(
+                    icon = Icons.Default.RecordVoiceOver,
+                    title = "Interrupt by speaking",
+                    subtitle = "Stop reading and listen when you start talking",
+                    checked = bargeInEnabled && ttsEnabled && ttsAvailable,
+                    onCheckedChange = {
+                        bargeInEnabled = it
+                        settingsManager.bargeInEnabled = it
+                    },
+                    enabled = ttsEnabled && ttsAvailable
+                )
+                
                 if (!ttsAvailable) {
                     Text(
                         text = "Text-to-speech is not available on this device. Install a TTS engine from the Play Store to enable this feature.",
@@ -621,6 +719,25 @@ fun SettingsScreen(
             
             // Reset Section
             SettingsSection(title = "Advanced") {
+                if (onNavigateToDiagnostics != null) {
+                    SettingsItem(
+                        icon = Icons.Default.Speed,
+                        title = "Diagnostics",
+                        subtitle = "Voice-to-answer latency percentiles",
+                        onClick = onNavigateToDiagnostics
+                    )
+                }
+                SettingsItemWithSwitch(
+                    icon = Icons.Default.FiberManualRecord,
+                    title = "Record sessions",
+                    subtitle = "Save audio, transcripts and API streams of each turn for offline replay",
+                    checked = recordSessions,
+                    onCheckedChange = {
+                        recordSessions = it
+                        settingsManager.recordSessions = it
+                        assistantService?.reloadSettings()
+                    }
+                )
                 SettingsItem(
                     icon = Icons.Default.Refresh,
                     title = "Reset to Defaults",
@@ -631,8 +748,13 @@ fun SettingsScreen(
                         systemPrompt = SettingsManager.DEFAULT_SYSTEM_PROMPT
                         voiceInputMethod = SettingsManager.VOICE_INPUT_SYSTEM
                         ttsEnabled = true
+                        bargeInEnabled = false
+                        recordSessions = false
                         autoSendVoice = true
                         autoStartVoice = false
+                        if (wakeWordEnabled) WakeWordService.stop(context)
+                        wakeWordEnabled = false
+                        assistantService?.reloadSettings()
                     }
                 )
             }
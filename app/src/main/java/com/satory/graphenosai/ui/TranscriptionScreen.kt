@@ -0,0 +1,225 @@
+package com.satory.graphenosai.ui
+
+import android.content.Context
+import android.net.Uri
+import android.provider.OpenableColumns
+import android.widget.Toast
+import androidx.activity.compose.rememberLauncherForActivityResult
+import androidx.activity.result.contract.ActivityResultContracts
+import androidx.compose.foundation.layout.*
+import androidx.compose.foundation.lazy.LazyColumn
+import androidx.compose.foundation.lazy.items
+import androidx.compose.material.icons.Icons
+import androidx.compose.material.icons.automirrored.filled.ArrowBack
+import androidx.compose.material.icons.filled.AudioFile
+import androidx.compose.material.icons.filled.Delete
+import androidx.compose.material3.*
+import androidx.compose.runtime.*
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.platform.LocalContext
+import androidx.compose.ui.text.font.FontFamily
+import androidx.compose.ui.text.font.FontWeight
+import androidx.compose.ui.unit.dp
+import androidx.lifecycle.compose.collectAsStateWithLifecycle
+import com.satory.graphenosai.audio.LocalWhisper
+import com.satory.graphenosai.audio.TranscriptJobStore
+import com.satory.graphenosai.audio.TranscriptSegment
+import com.satory.graphenosai.service.TranscriptionService
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
+
+/**
+ * Long recordings transcribed on-device by [TranscriptionService]: pick a
+ * recording, follow its segments as each window finishes, read and delete
+ * finished transcripts.
+ */
+@OptIn(ExperimentalMaterial3Api::class)
+@Composable
+fun TranscriptionScreen(onNavigateBack: () -> Unit) {
+    val context = LocalContext.current
+    val scope = rememberCoroutineScope()
+    val store = remember { TranscriptionService.store(context) }
+    val state by TranscriptionService.state.collectAsStateWithLifecycle()
+    var modelInstalled by remember { mutableStateOf(LocalWhisper.isModelInstalled(context)) }
+    var finished by remember { mutableStateOf<List<TranscriptJobStore.Finished>>(emptyList()) }
+    var refresh by remember { mutableStateOf(0) }
+
+    // Re-read the store whenever a job ends
+    LaunchedEffect(state.done, state.error, refresh) {
+        finished = withContext(Dispatchers.IO) { store.finished() }
+    }
+
+    val recordingPicker = rememberLauncherForActivityResult(
+        contract = ActivityResultContracts.OpenDocument()
+    ) { uri ->
+        if (uri == null) return@rememberLauncherForActivityResult
+        scope.launch {
+            val job = withContext(Dispatchers.IO) {
+                store.add(displayName(context, uri)) { out ->
+                    context.contentResolver.openInputStream(uri)?.use { it.copyTo(out) }
+                        ?: throw IllegalStateException("cannot open $uri")
+                }
+            }
+            if (job != null) {
+                TranscriptionService.start(context)
+            } else {
+                Toast.makeText(context, "Could not copy the recording", Toast.LENGTH_SHORT).show()
+            }
+        }
+    }
+    val modelPicker = rememberLauncherForActivityResult(
+        contract = ActivityResultContracts.OpenDocument()
+    ) { uri ->
+        if (uri == null) return@rememberLauncherForActivityResult
+        scope.launch {
+            modelInstalled = withContext(Dispatchers.IO) { LocalWhisper.installModel(context, uri) }
+            if (modelInstalled) {
+                TranscriptionService.resumePending(context)
+            } else {
+                Toast.makeText(context, "Could not install the model", Toast.LENGTH_SHORT).show()
+            }
+        }
+    }
+
+    Scaffold(
+        topBar = {
+            TopAppBar(
+                title = { Text("Transcribe recordings") },
+                navigationIcon = {
+                    IconButton(onClick = onNavigateBack) {
+                        Icon(Icons.AutoMirrored.Filled.ArrowBack, contentDescription = "Back")
+                    }
+                },
+                actions = {
+                    IconButton(onClick = { recordingPicker.launch(arrayOf("audio/*")) }) {
+                        Icon(Icons.Default.AudioFile, contentDescription = "Transcribe a recording")
+                    }
+                }
+            )
+        }
+    ) { padding ->
+        LazyColumn(
+            modifier = Modifier
+                .fillMaxSize()
+                .padding(padding),
+            contentPadding = PaddingValues(16.dp),
+            verticalArrangement = Arrangement.spacedBy(12.dp)
+        ) {
+            item {
+                Card(modifier = Modifier.fillMaxWidth()) {
+                    Column(modifier = Modifier.padding(16.dp)) {
+                        Text(
+                            if (modelInstalled) "On-device Whisper model installed" else "No on-device Whisper model",
+                            style = MaterialTheme.typography.titleSmall
+                        )
+                        Text(
+                            "Recordings are transcribed on this device, window by window; " +
+                                "a transcription the system stops continues where it was",
+                            style = MaterialTheme.typography.bodySmall,
+                            color = MaterialTheme.colorScheme.onSurfaceVariant
+                        )
+                        TextButton(onClick = { modelPicker.launch(arrayOf("*/*")) }) {
+                            Text(if (modelInstalled) "Replace model" else "Import GGML model")
+                        }
+                    }
+                }
+            }
+
+            if (state.jobName != null) {
+                item {
+                    CurrentTranscriptionCard(state, onCancel = { TranscriptionService.cancel(context) })
+                }
+                items(state.segments) { segment -> SegmentRow(segment) }
+            }
+
+            if (finished.isNotEmpty()) {
+                item {
+                    Text(
+                        "Finished",
+                        style = MaterialTheme.typography.titleMedium,
+                        fontWeight = FontWeight.Bold,
+                        color = MaterialTheme.colorScheme.primary
+                    )
+                }
+                items(finished, key = { it.id }) { transcript ->
+                    FinishedTranscriptCard(transcript, onDelete = {
+                        scope.launch {
+                            withContext(Dispatchers.IO) { store.remove(transcript.id) }
+                            refresh++
+                        }
+                    })
+                }
+            }
+        }
+    }
+}
+
+@Composable
+private fun CurrentTranscriptionCard(state: TranscriptionService.State, onCancel: () -> Unit) {
+    Card(modifier = Modifier.fillMaxWidth()) {
+        Column(modifier = Modifier.padding(16.dp), verticalArrangement = Arrangement.spacedBy(8.dp)) {
+            Text(state.jobName ?: "", style = MaterialTheme.typography.titleSmall)
+            LinearProgressIndicator(progress = { state.progress }, modifier = Modifier.fillMaxWidth())
+            val status = when {
+                state.error != null -> state.error
+                state.done -> "Done, ${state.segments.size} segments"
+                else -> "${(state.progress * 100).toInt()}%, ${state.segments.size} segments" +
+                    if (state.queued > 0) ", ${state.queued} more queued" else ""
+            }
+            Text(status, style = MaterialTheme.typography.bodySmall)
+            if (!state.done && state.error == null) {
+                TextButton(onClick = onCancel) { Text("Cancel") }
+            }
+        }
+    }
+}
+
+@Composable
+private fun SegmentRow(segment: TranscriptSegment) {
+    Row(horizontalArrangement = Arrangement.spacedBy(12.dp)) {
+        Text(
+            formatTime(segment.startMs),
+            style = MaterialTheme.typography.bodySmall,
+            fontFamily = FontFamily.Monospace,
+            color = MaterialTheme.colorScheme.onSurfaceVariant
+        )
+        Text(segment.text.trim(), style = MaterialTheme.typography.bodyMedium)
+    }
+}
+
+@Composable
+private fun FinishedTranscriptCard(transcript: TranscriptJobStore.Finished, onDelete: () -> Unit) {
+    Card(modifier = Modifier.fillMaxWidth()) {
+        Column(modifier = Modifier.padding(16.dp)) {
+            Row {
+                Text(transcript.name, style = MaterialTheme.typography.titleSmall, modifier = Modifier.weight(1f))
+                IconButton(onClick = onDelete) {
+                    Icon(Icons.Default.Delete, contentDescription = "Delete transcript")
+                }
+            }
+            Text(
+                transcript.error ?: transcript.segments.joinToString("") { it.text }.trim(),
+                style = MaterialTheme.typography.bodyMedium,
+                color = if (transcript.error != null) MaterialTheme.colorScheme.error
+                        else MaterialTheme.colorScheme.onSurface
+            )
+        }
+    }
+}
+
+private fun formatTime(ms: Long): String {
+    val seconds = ms / 1000
+    return if (seconds >= 3600) {
+        "%d:%02d:%02d".format(seconds / 3600, seconds / 60 % 60, seconds % 60)
+    } else {
+        "%02d:%02d".format(seconds / 60, seconds % 60)
+    }
+}
+
+private fun displayName(context: Context, uri: Uri): String {
+    context.contentResolver.query(uri, arrayOf(OpenableColumns.DISPLAY_NAME), null, null, null)?.use { cursor ->
+        if (cursor.moveToFirst()) cursor.getString(0)?.let { return it }
+    }
+    return uri.lastPathSegment ?: "Recording"
+}
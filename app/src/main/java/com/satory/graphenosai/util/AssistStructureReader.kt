@@ -0,0 +1,81 @@
+package com.satory.graphenosai.util
+
+import android.app.assist.AssistStructure
+import android.text.InputType
+import android.view.View
+
+/**
+ * Flattens an [AssistStructure] into [ScreenContext.Item]s in screen
+ * coordinates. The walk is iterative and keeps no per-node objects beyond
+ * the labelled items: pending nodes and their parents' offsets sit on
+ * parallel stacks, so it stays fast on deep hierarchies.
+ */
+object AssistStructureReader {
+
+    /** Compact screen text for [structure], or null if it has nothing readable. */
+    fun read(structure: AssistStructure, maxChars: Int = ScreenContext.DEFAULT_MAX_CHARS): String? {
+        val items = mutableListOf<ScreenContext.Item>()
+        var screenWidth = 0
+        var screenHeight = 0
+        val nodes = ArrayList<AssistStructure.ViewNode>()
+        var offsets = IntArray(64)     // x, y of each pending node's parent content
+
+        fun push(node: AssistStructure.ViewNode, x: Int, y: Int) {
+            val at = nodes.size * 2
+            if (at + 2 > offsets.size) offsets = offsets.copyOf(offsets.size * 2)
+            offsets[at] = x
+            offsets[at + 1] = y
+            nodes.add(node)
+        }
+
+        for (w in 0 until structure.windowNodeCount) {
+            val window = structure.getWindowNodeAt(w)
+            screenWidth = maxOf(screenWidth, window.left + window.width)
+            screenHeight = maxOf(screenHeight, window.top + window.height)
+            push(window.rootViewNode, window.left, window.top)
+
+            while (nodes.isNotEmpty()) {
+                val node = nodes.removeAt(nodes.size - 1)
+                if (node.visibility != View.VISIBLE) continue
+                val left = offsets[nodes.size * 2] + node.left
+                val top = offsets[nodes.size * 2 + 1] + node.top
+
+                label(node)?.let { (text, role) ->
+                    items.add(ScreenContext.Item(text, role, left, top, node.width, node.height, node.isFocused))
+                }
+                // Children are positioned relative to this node's scrolled content
+                for (c in node.childCount - 1 downTo 0) {
+                    push(node.getChildAt(c), left - node.scrollX, top - node.scrollY)
+                }
+            }
+        }
+
+        val title = structure.activityComponent?.flattenToShortString()
+        return ScreenContext.build(title, items, screenWidth, screenHeight, maxChars)
+    }
+
+    private fun label(node: AssistStructure.ViewNode): Pair<String, ScreenContext.Role>? {
+        val className = node.className ?: ""
+        val role = when {
+            className.endsWith("EditText") -> ScreenContext.Role.INPUT
+            className.endsWith("Button") && !className.endsWith("ImageButton") -> ScreenContext.Role.BUTTON
+            className.endsWith("ImageView") || className.endsWith("ImageButton") -> ScreenContext.Role.IMAGE
+            else -> ScreenContext.Role.TEXT
+        }
+        if (role == ScreenContext.Role.INPUT && isPassword(node.inputType)) return null
+
+        val text = node.text?.toString()?.takeIf { it.isNotBlank() }
+            ?: node.contentDescription?.toString()?.takeIf { it.isNotBlank() }
+            ?: node.hint?.takeIf { it.isNotBlank() && role == ScreenContext.Role.INPUT }
+            ?: return null
+        return text to role
+    }
+
+    private fun isPassword(inputType: Int): Boolean {
+        val variation = inputType and (InputType.TYPE_MASK_CLASS or InputType.TYPE_MASK_VARIATION)
+        return variation == (InputType.TYPE_CLASS_TEXT or InputType.TYPE_TEXT_VARIATION_PASSWORD) ||
+            variation == (InputType.TYPE_CLASS_TEXT or InputType.TYPE_TEXT_VARIATION_WEB_PASSWORD) ||
+            variation == (InputType.TYPE_CLASS_TEXT or InputType.TYPE_TEXT_VARIATION_VISIBLE_PASSWORD) ||
+            variation == (InputType.TYPE_CLASS_NUMBER or InputType.TYPE_NUMBER_VARIATION_PASSWORD)
+    }
+}
@@ -0,0 +1,39 @@
+package com.satory.graphenosai.util
+
+import com.satory.graphenosai.BuildConfig
+
+/**
+ * Where the network clients send their requests. Each client keeps its
+ * production URL and asks [resolve] for the one to use; with a base
+ * override set, the scheme, host and port are replaced and the path kept,
+ * so one stand-in server (app/src/test/cpp/standin_server) can answer for
+ * every API by path.
+ *
+ * Debug builds take the override from the `apiBaseOverride` Gradle
+ * property, e.g. `-PapiBaseOverride=http://127.0.0.1:8080` together with
+ * `adb reverse tcp:8080 tcp:8080`. Release builds always use production.
+ */
+object Endpoints {
+
+    @Volatile
+    private var override: String? = BuildConfig.API_BASE_OVERRIDE.ifBlank { null }
+
+    /** Base URL replacing production hosts, or null; always null in release builds. */
+    val baseOverride: String? get() = if (BuildConfig.DEBUG) override else null
+
+    /** Point the clients at [base] instead of production (null restores it). Debug builds only. */
+    fun overrideBase(base: String?) {
+        check(BuildConfig.DEBUG) { "Endpoints cannot be redirected in a release build" }
+        override = base
+    }
+
+    fun resolve(url: String): String = resolve(url, baseOverride)
+
+    /** [url] with its scheme, host and port replaced by [base] (unchanged when [base] is blank). */
+    fun resolve(url: String, base: String?): String {
+        if (base.isNullOrBlank()) return url
+        val hostStart = url.indexOf("://").let { if (it < 0) 0 else it + 3 }
+        val pathStart = url.indexOf('/', hostStart).let { if (it < 0) url.length else it }
+        return base.trimEnd('/') + url.substring(pathStart)
+    }
+}
@@ -0,0 +1,105 @@
+package com.satory.graphenosai.util
+
+import kotlin.math.max
+import kotlin.math.min
+
+/**
+ * Compact text description of what is on screen, built from the view
+ * hierarchy (see AssistStructureReader) so questions about the current
+ * screen can go to any text model instead of sending a screenshot.
+ *
+ * Items are flattened, clipped to the screen, deduplicated and ranked by
+ * how visible they are; the best ones that fit the character budget are
+ * emitted in reading order. A typical screen comes out at 1-3 KB, against
+ * a few hundred KB for a base64 JPEG.
+ */
+object ScreenContext {
+
+    const val DEFAULT_MAX_CHARS = 3000
+    private const val MAX_ITEM_CHARS = 400
+
+    enum class Role { TEXT, BUTTON, INPUT, IMAGE }
+
+    /** One labelled view in screen coordinates. */
+    data class Item(
+        val text: String,
+        val role: Role,
+        val left: Int,
+        val top: Int,
+        val width: Int,
+        val height: Int,
+        val focused: Boolean = false
+    )
+
+    private class Ranked(val item: Item, val text: String, val score: Double)
+
+    /**
+     * Returns the context block, or null if nothing readable is visible.
+     * [title] is the app/activity name shown on the first line.
+     */
+    fun build(
+        title: String?,
+        items: List<Item>,
+        screenWidth: Int,
+        screenHeight: Int,
+        maxChars: Int = DEFAULT_MAX_CHARS
+    ): String? {
+        val screenArea = screenWidth.toDouble() * screenHeight
+        if (screenArea <= 0) return null
+
+        val best = LinkedHashMap<String, Ranked>()
+        for (item in items) {
+            val text = normalize(item.text)
+            if (text.isEmpty()) continue
+            val visibleWidth = min(item.left + item.width, screenWidth) - max(item.left, 0)
+            val visibleHeight = min(item.top + item.height, screenHeight) - max(item.top, 0)
+            if (visibleWidth <= 0 || visibleHeight <= 0) continue // scrolled away or off-screen
+
+            val visible = visibleWidth.toDouble() * visibleHeight
+            val fraction = visible / max(1.0, item.width.toDouble() * item.height)
+            val roleWeight = when (item.role) {
+                Role.INPUT -> 0.5
+                Role.BUTTON -> 0.2
+                else -> 0.0
+            }
+            val score = fraction + min(1.0, 20.0 * visible / screenArea) + roleWeight +
+                if (item.focused) 1.0 else 0.0
+
+            // Same label twice (text + content description, list echoes): keep the most visible
+            val key = text.lowercase()
+            val existing = best[key]
+            if (existing == null || existing.score < score) best[key] = Ranked(item, text, score)
+        }
+        if (best.isEmpty()) return null
+
+        val header = title?.takeIf { it.isNotBlank() }?.let { "Screen: ${normalize(it)}" }
+        var budget = maxChars - (header?.length?.plus(1) ?: 0)
+        val chosen = mutableListOf<Ranked>()
+        for (ranked in best.values.sortedByDescending { it.score }) {
+            val cost = line(ranked).length + 1
+            if (cost > budget) continue
+            chosen.add(ranked)
+            budget -= cost
+        }
+
+        // Reading order: rows top to bottom (items within half a line share a row), then left to right
+        val rowHeight = max(1, screenHeight / 80)
+        chosen.sortWith(compareBy({ it.item.top / rowHeight }, { it.item.left }))
+        return buildString {
+            header?.let { appendLine(it) }
+            chosen.forEach { appendLine(line(it)) }
+        }.trimEnd()
+    }
+
+    private fun line(ranked: Ranked): String = when (ranked.item.role) {
+        Role.BUTTON -> "[button] ${ranked.text}"
+        Role.INPUT -> "[field] ${ranked.text}"
+        Role.IMAGE -> "[image] ${ranked.text}"
+        Role.TEXT -> ranked.text
+    }
+
+    private fun normalize(text: String): String {
+        val collapsed = text.replace(Regex("\\s+"), " ").trim()
+        return if (collapsed.length > MAX_ITEM_CHARS) collapsed.take(MAX_ITEM_CHARS - 1) + "…" else collapsed
+    }
+}
@@ -0,0 +1,58 @@
+package com.vincent.ai_integrated_into_android.audio
+
+/**
+ * Kotlin side of the native whisper bridge (cpp/whisper_jni.cpp). The
+ * symbols keep the package the bridge was written under, so this binding
+ * lives there too; the library itself is loaded by AssistantApplication
+ * (check `nativeLibsLoaded` before calling). Built without whisper.cpp,
+ * every call reports failure (cpp/whisper_jni_stub.cpp).
+ *
+ * All calls block; keep them off the main thread.
+ */
+object WhisperJNI {
+
+    /** Load a GGML model; 0 on success, negative on failure. */
+    external fun initModel(modelPath: String): Int
+
+    external fun transcribe(audioPath: String): String?
+
+    external fun transcribeWithParams(audioPath: String, language: String, translate: Boolean, threads: Int): String?
+
+    /** Re-run only the decoder on the last clip. */
+    external fun redecode(language: String, translate: Boolean, temperature: Float): String?
+
+    /** `intent\tphrase\tscore`, constrained to the phrases of [grammar]. */
+    external fun recognizeCommand(audioPath: String, grammar: String): String?
+
+    /** Queue a background file job; 0 if the file cannot be transcribed. */
+    external fun submitFileTranscription(audioPath: String): Long
+
+    /**
+     * Queue a file job that saves every finished window to [checkpointPath]
+     * and, submitted again after a restart, resumes after the last saved one.
+     */
+    external fun submitCheckpointedTranscription(audioPath: String, checkpointPath: String): Long
+
+    /** 0..1, or -1 if the job is unknown, failed or was cancelled. */
+    external fun getJobProgress(jobId: Long): Float
+
+    external fun pollFileTranscription(jobId: Long): String
+
+    /**
+     * Segments from index [first] on as `t0_ms\tt1_ms\ttext` lines; a last
+     * line `done` or `failed` means the job is over and forgotten.
+     */
+    external fun pollTranscriptSegments(jobId: Long, first: Int): String
+
+    external fun cancelJob(jobId: Long): Boolean
+
+    external fun getSchedulerStats(): String
+
+    external fun setFallbackModel(modelPath: String)
+
+    external fun getGovernorStats(): String
+
+    external fun releaseModel()
+
+    external fun getVersion(): String
+}
@@ -0,0 +1,153 @@
+/**
+ * arena_test.cpp - Arena behaviour and the zero-allocation transcription request
+ *
+ * Replaces the global operator new/delete with counting versions (they
+ * forward to malloc/free, so other tests in the binary are unaffected)
+ * and runs whisper_jni.cpp's transcribe() against the fake engine. What
+ * is counted is the bridge on the calling thread: the fake engine's own
+ * allocations stand in for whisper.cpp's and are left out, as is the
+ * result string, which the VM would allocate in the Java heap. Threads
+ * the request only wakes (the energy sampler, the governor's sensor
+ * refresh) are off the request path and not counted either.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "fake_whisper.h"
+#include "lru_cache.h"
+#include "test_audio.h"
+#include "wav_io.h"
+#include "whisper_bridge.h"
+
+using namespace assistant;
+
+namespace {
+    thread_local bool t_counting = false;
+    thread_local size_t t_allocations = 0;
+
+    void* counted_alloc(size_t size) {
+        if (t_counting && !fake_whisper_in_engine()) ++t_allocations;
+        if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+        throw std::bad_alloc();
+    }
+
+    /** Heap allocations made by `fn` on the calling thread, outside the fake engine. */
+    template <typename Fn>
+    size_t count_allocations(Fn&& fn) {
+        t_allocations = 0;
+        t_counting = true;
+        fn();
+        t_counting = false;
+        return t_allocations;
+    }
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+TEST(Arena, AlignsAndGrows) {
+    Arena arena(64);
+    char* a = arena.alloc<char>(3);
+    double* b = arena.alloc<double>(4);
+    EXPECT_NE(a, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(double), 0u);
+
+    float* big = arena.alloc<float>(1000);      // spills into a new block
+    big[999] = 1.0f;
+    EXPECT_EQ(arena.blocks(), 2u);
+
+    arena.reset();                              // consolidates to the high-water mark
+    EXPECT_EQ(arena.blocks(), 1u);
+    EXPECT_GE(arena.capacity(), 1000 * sizeof(float));
+    EXPECT_EQ(arena.in_use(), 0u);
+}
+
+TEST(Arena, TextAppendsAcrossGrowth) {
+    Arena arena(128);
+    ArenaText text(arena);
+    EXPECT_STREQ(text.c_str(), "");
+    std::string expected;
+    for (int i = 0; i < 200; ++i) {
+        text.append(" word");
+        expected += " word";
+    }
+    EXPECT_EQ(text.size(), expected.size());
+    EXPECT_EQ(expected, text.c_str());
+    text.clear();
+    EXPECT_TRUE(text.empty());
+}
+
+TEST(Arena, RecycledCacheEntryKeepsKeyOrder) {
+    LruCache<int, int> cache(2);
+    EXPECT_EQ(cache.recycle_oldest(1), nullptr);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    int* reused = cache.recycle_oldest(3);      // takes over key 1's entry
+    ASSERT_NE(reused, nullptr);
+    EXPECT_EQ(*reused, 10);
+    *reused = 30;
+    EXPECT_EQ(cache.find(1), nullptr);
+    EXPECT_EQ(*cache.find(3), 30);
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(Arena, SteadyStateRequestDoesNotAllocate) {
+    const std::string dir = ::testing::TempDir();
+    const std::string model = dir + "arena_fake_model.bin";
+    FILE* file = fopen(model.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    fprintf(file, "encode_ms=0\ndecode_ms_per_token=0\n");
+    fclose(file);
+
+    // Distinct clips, so the later ones recycle cache entries instead of hitting them
+    std::mt19937 rng(5);
+    std::vector<std::string> clips;
+    for (int i = 0; i < 6; ++i) {
+        std::vector<int16_t> pcm;
+        assistant::testing::append_speech(pcm, 16000, 0.3f, 3000, rng);
+        clips.push_back(dir + "arena_request_" + std::to_string(i) + ".wav");
+        ASSERT_TRUE(write_wav_mono16(clips.back(), pcm.data(), pcm.size(), 16000));
+    }
+
+    JNIEnv env;
+    env.locals.reserve(64);         // the VM's local reference table does not grow per call
+    ASSERT_EQ(WHISPER_JNI(initModel)(&env, nullptr, env.NewStringUTF(model.c_str())), 0);
+    std::vector<jstring> paths;
+    for (const std::string& clip : clips) paths.push_back(env.NewStringUTF(clip.c_str()));
+
+    // Bridge allocations of one request, less what the host JNI spends building the result
+    auto bridge_allocations = [&env](jstring path) {
+        jstring result = nullptr;
+        const size_t total = count_allocations([&] { result = WHISPER_JNI(transcribe)(&env, nullptr, path); });
+        EXPECT_NE(result, nullptr);
+        if (result == nullptr) return total;
+        EXPECT_FALSE(result->utf.empty());
+        const std::string text = result->utf;
+        return total - count_allocations([&] { env.NewStringUTF(text.c_str()); });
+    };
+
+    // Warm-up: the arenas grow to the request size, the cache fills and the governor reads the sensors
+    for (size_t i = 0; i < 4; ++i) bridge_allocations(paths[i]);
+
+    EXPECT_EQ(bridge_allocations(paths[4]), 0u);    // cold: encodes into a recycled cache entry
+    EXPECT_EQ(bridge_allocations(paths[5]), 0u);
+    EXPECT_EQ(bridge_allocations(paths[5]), 0u);    // warm: answered from the encoder cache
+    EXPECT_EQ(fake_whisper_violations(), 0u);
+
+    WHISPER_JNI(releaseModel)(&env, nullptr);
+    env.clear_local_refs();
+
+    // The counter itself works
+    EXPECT_GT(count_allocations([] { std::vector<int> v(100); (void)v; }), 0u);
+}
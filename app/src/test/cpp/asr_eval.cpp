@@ -0,0 +1,403 @@
+/**
+ * asr_eval.cpp - Accuracy and latency regression gate for ASR engines
+ *
+ * Runs every clip in a manifest through the voice pipeline (resampled to
+ * 16 kHz, then the given preprocessing spec) into an engine, and reports
+ * WER, CER and real-time factor per language. Exits non-zero when a
+ * language exceeds an absolute limit or regresses past a stored baseline.
+ *
+ * Manifest: one "path<TAB>language<TAB>reference" per line, paths relative
+ * to the manifest; lines starting with '#' are ignored.
+ * Baseline: one "language<TAB>wer<TAB>cer" per line (see --write-baseline).
+ *
+ * Engines: "tone" (tone_speech.h), and "whisper": the real JNI bridge
+ * (whisper_bridge.h) with the model given by --model, called with
+ * transcribeWithParams in each clip's language the way the app calls it.
+ * asr_eval runs the bridge on the fake engine (fake_whisper.h);
+ * asr_eval_whispercpp, built when whisper.cpp is checked out, runs it on
+ * whisper.cpp. Other engines plug in by implementing AsrEngine and adding
+ * a case to make_engine().
+ *
+ * The fake engine's words do not follow the manifest, so with it
+ * --reference engine scores each clip against the fake's transcript of the
+ * whole clip instead: what the bridge loses on the way (samples, windows)
+ * then shows up as WER, and the fake's simulated latency as RTF.
+ *
+ * --audio-ctx auto|N limits what the engine sees to the whisper encoder
+ * window of that many frames ("auto": compute_audio_ctx per clip), so the
+ * short-utterance sizing rule is gated on the same corpus.
+ *
+ * Usage: asr_eval <manifest.tsv> [--engine NAME] [--model PATH] [--reference manifest|engine]
+ *                 [--spec SPEC] [--audio-ctx auto|N] [--max-wer W] [--max-cer C] [--max-rtf R]
+ *                 [--baseline FILE] [--tolerance T] [--write-baseline FILE] [--verbose]
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "arena.h"
+#include "asr_metrics.h"
+#include "audio_context.h"
+#include "tone_speech.h"
+#include "voice_pipeline.h"
+#include "wav_io.h"
+#include "whisper_bridge.h"
+#ifdef ASSISTANT_FAKE_WHISPER
+#include "fake_whisper.h"
+#endif
+
+using namespace assistant;
+
+namespace {
+    constexpr int32_t kEngineRate = 16000;
+
+    /** What make_engine needs beyond the name; the whisper engine writes each clip to `clip_path`. */
+    struct EngineSetup {
+        std::string language;
+        std::string clip_path;
+        std::string* engine_reference = nullptr;    // set to the fake's whole-clip transcript, if wanted
+#ifdef ASSISTANT_FAKE_WHISPER
+        FakeWhisperConfig fake;
+#endif
+    };
+
+    /**
+     * Hands the clip to the whisper bridge as the app does: a 16 kHz WAV
+     * file, transcribed with transcribeWithParams in the clip's language.
+     * The model is loaded once, by main().
+     */
+    class WhisperBridgeEngine : public AsrEngine {
+    public:
+        explicit WhisperBridgeEngine(const EngineSetup& setup) : setup_(setup) {}
+
+        void accept(const int16_t* pcm, size_t n) override { pcm_.insert(pcm_.end(), pcm, pcm + n); }
+
+        std::string finish() override {
+            if (!write_wav_mono16(setup_.clip_path, pcm_.data(), pcm_.size(), kEngineRate)) {
+                fprintf(stderr, "cannot write %s\n", setup_.clip_path.c_str());
+                return std::string();
+            }
+            pcm_.clear();
+            JNIEnv env;
+            jstring result = WHISPER_JNI(transcribeWithParams)(&env, nullptr, env.NewStringUTF(setup_.clip_path.c_str()),
+                                                               env.NewStringUTF(setup_.language.c_str()), JNI_FALSE, 0);
+            std::string text = result != nullptr ? result->utf : std::string();
+#ifdef ASSISTANT_FAKE_WHISPER
+            if (setup_.engine_reference != nullptr) {
+                // The samples exactly as the bridge read them
+                Arena arena(1 << 16);
+                float* samples = nullptr;
+                size_t n = 0;
+                read_wav_mono_float(setup_.clip_path.c_str(), arena, &samples, &n);
+                *setup_.engine_reference = fake_whisper_transcript(setup_.fake, samples, n,
+                                                                   setup_.language.c_str(), false);
+            }
+#endif
+            return text;
+        }
+
+        void reset() override { pcm_.clear(); }
+
+    private:
+        const EngineSetup& setup_;
+        std::vector<int16_t> pcm_;
+    };
+
+    std::unique_ptr<AsrEngine> make_engine(const std::string& name, const EngineSetup& setup) {
+        if (name == "tone") return std::unique_ptr<AsrEngine>(new testing::ToneRecognizer());
+        if (name == "whisper") return std::unique_ptr<AsrEngine>(new WhisperBridgeEngine(setup));
+        return nullptr;
+    }
+
+    bool read_text(const std::string& path, std::string& out) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) out.append(buffer, n);
+        fclose(file);
+        return true;
+    }
+
+    /**
+     * Buffers the clip, then passes the inner engine only the part a whisper
+     * encoder context of `audio_ctx` frames would cover (-1: size per clip).
+     */
+    class ContextWindowEngine : public AsrEngine {
+    public:
+        ContextWindowEngine(std::unique_ptr<AsrEngine> inner, int32_t audio_ctx, int64_t* frames, int64_t* full_frames)
+            : inner_(std::move(inner)), audio_ctx_(audio_ctx), frames_(frames), full_frames_(full_frames) {}
+
+        void accept(const int16_t* pcm, size_t n) override { pcm_.insert(pcm_.end(), pcm, pcm + n); }
+
+        std::string finish() override {
+            const AudioContextPolicy policy;
+            const int32_t ctx = audio_ctx_ < 0 ? compute_audio_ctx(pcm_.size(), kEngineRate, policy) : audio_ctx_;
+            const auto window = static_cast<size_t>(audio_ctx_seconds(ctx, policy) * kEngineRate);
+            *frames_ += ctx > 0 ? ctx : policy.full_ctx;
+            *full_frames_ += policy.full_ctx;
+            inner_->accept(pcm_.data(), std::min(window, pcm_.size()));
+            pcm_.clear();
+            return inner_->finish();
+        }
+
+        void reset() override {
+            pcm_.clear();
+            inner_->reset();
+        }
+
+    private:
+        std::unique_ptr<AsrEngine> inner_;
+        int32_t audio_ctx_;
+        int64_t* frames_;
+        int64_t* full_frames_;
+        std::vector<int16_t> pcm_;
+    };
+
+    struct Baseline {
+        double wer = 0.0;
+        double cer = 0.0;
+    };
+
+    bool read_baseline(const std::string& path, std::map<std::string, Baseline>& out) {
+        FILE* file = fopen(path.c_str(), "r");
+        if (file == nullptr) return false;
+        char line[256];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (line[0] == '#' || line[0] == '\n') continue;
+            char lang[64];
+            Baseline baseline;
+            if (sscanf(line, "%63s %lf %lf", lang, &baseline.wer, &baseline.cer) == 3) out[lang] = baseline;
+        }
+        fclose(file);
+        return true;
+    }
+
+    /** Split "a<TAB>b<TAB>rest"; false if there are fewer than three fields. */
+    bool split_manifest_line(const std::string& line, std::string& path, std::string& lang, std::string& text) {
+        const size_t a = line.find('\t');
+        const size_t b = a == std::string::npos ? a : line.find('\t', a + 1);
+        if (b == std::string::npos) return false;
+        path = line.substr(0, a);
+        lang = line.substr(a + 1, b - a - 1);
+        text = line.substr(b + 1);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <manifest.tsv> [--engine NAME] [--model PATH] [--reference manifest|engine] [--spec SPEC] "
+                        "[--audio-ctx auto|N] [--max-wer W] [--max-cer C] [--max-rtf R] [--baseline FILE] [--tolerance T] "
+                        "[--write-baseline FILE] [--verbose]\n",
+                argv[0]);
+        return 2;
+    }
+    const std::string manifest_path = argv[1];
+    std::string engine_name = "tone";
+    std::string model_path;
+    bool engine_reference = false;
+    std::string spec = "highpass cutoff_hz=80";
+    double max_wer = 1.0;
+    double max_cer = 1.0;
+    double max_rtf = 1.0;
+    std::string baseline_path;
+    std::string write_baseline_path;
+    double tolerance = 0.01;
+    bool verbose = false;
+    int32_t audio_ctx = 0;      // 0: engine sees the whole clip; -1: compute_audio_ctx
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) engine_name = argv[++i];
+        else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) model_path = argv[++i];
+        else if (strcmp(argv[i], "--reference") == 0 && i + 1 < argc) engine_reference = strcmp(argv[++i], "engine") == 0;
+        else if (strcmp(argv[i], "--spec") == 0 && i + 1 < argc) spec = argv[++i];
+        else if (strcmp(argv[i], "--audio-ctx") == 0 && i + 1 < argc) {
+            ++i;
+            audio_ctx = strcmp(argv[i], "auto") == 0 ? -1 : atoi(argv[i]);
+        }
+        else if (strcmp(argv[i], "--max-wer") == 0 && i + 1 < argc) max_wer = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-cer") == 0 && i + 1 < argc) max_cer = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-rtf") == 0 && i + 1 < argc) max_rtf = atof(argv[++i]);
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) write_baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+    }
+    EngineSetup setup;
+    if (!make_engine(engine_name, setup)) {
+        fprintf(stderr, "unknown engine %s\n", engine_name.c_str());
+        return 2;
+    }
+    const bool whisper = engine_name == "whisper";
+    if (whisper && audio_ctx != 0) {
+        fprintf(stderr, "the whisper bridge sizes the encoder context itself; --audio-ctx is for other engines\n");
+        return 2;
+    }
+#ifdef ASSISTANT_FAKE_WHISPER
+    const bool fake_engine = whisper;
+#else
+    const bool fake_engine = false;
+#endif
+    if (engine_reference && !fake_engine) {
+        fprintf(stderr, "--reference engine needs the whisper engine on the fake backend\n");
+        return 2;
+    }
+    std::string engine_reference_text;
+    if (engine_reference) setup.engine_reference = &engine_reference_text;
+
+    char work_dir[] = "/tmp/asr_eval.XXXXXX";
+    if (whisper) {
+        std::string model_text;
+        if (model_path.empty() || !read_text(model_path, model_text)) {
+            fprintf(stderr, "the whisper engine needs a readable --model\n");
+            return 2;
+        }
+#ifdef ASSISTANT_FAKE_WHISPER
+        parse_fake_whisper_config(model_text, setup.fake);
+#endif
+        if (mkdtemp(work_dir) == nullptr) {
+            perror("mkdtemp");
+            return 1;
+        }
+        setup.clip_path = std::string(work_dir) + "/clip.wav";
+        JNIEnv env;
+        if (WHISPER_JNI(initModel)(&env, nullptr, env.NewStringUTF(model_path.c_str())) != 0) {
+            fprintf(stderr, "cannot load model %s\n", model_path.c_str());
+            rmdir(work_dir);
+            return 1;
+        }
+    }
+
+    std::map<std::string, Baseline> baseline;
+    if (!baseline_path.empty() && !read_baseline(baseline_path, baseline)) {
+        fprintf(stderr, "cannot read baseline %s\n", baseline_path.c_str());
+        return 1;
+    }
+
+    FILE* manifest = fopen(manifest_path.c_str(), "r");
+    if (manifest == nullptr) {
+        fprintf(stderr, "cannot open manifest %s\n", manifest_path.c_str());
+        return 1;
+    }
+    const size_t slash = manifest_path.find_last_of('/');
+    const std::string base = slash == std::string::npos ? "" : manifest_path.substr(0, slash + 1);
+
+    const StageRegistry registry = StageRegistry::with_builtins();
+    std::map<std::string, AsrScore> by_language;
+    int64_t encoder_frames = 0;
+    int64_t full_encoder_frames = 0;
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), manifest) != nullptr) {
+        std::string line(buffer);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        std::string path, lang, reference;
+        if (line.empty() || line[0] == '#' || !split_manifest_line(line, path, lang, reference)) continue;
+
+        WavFileSource source;
+        if (!source.open(base + path)) {
+            fprintf(stderr, "cannot read %s\n", path.c_str());
+            fclose(manifest);
+            return 1;
+        }
+        PipelineOptions options;
+        options.sample_rate = source.sample_rate();
+        const std::string clip_spec = (options.sample_rate != kEngineRate
+            ? "resample rate=" + std::to_string(kEngineRate) + " | " : std::string()) + spec;
+
+        const auto start = std::chrono::steady_clock::now();
+        setup.language = lang;
+        std::unique_ptr<AsrEngine> engine = make_engine(engine_name, setup);
+        if (audio_ctx != 0) {
+            engine.reset(new ContextWindowEngine(std::move(engine), audio_ctx, &encoder_frames, &full_encoder_frames));
+        }
+        VoicePipeline pipeline;
+        std::string error;
+        if (!pipeline.build(clip_spec, registry, options, &error) ||
+            !pipeline.append(engine_name, make_engine_stage(std::move(engine)), &error)) {
+            fprintf(stderr, "bad pipeline \"%s\": %s\n", clip_spec.c_str(), error.c_str());
+            fclose(manifest);
+            return 1;
+        }
+        pipeline.run(source);
+        std::vector<PipelineEvent> events;
+        pipeline.poll_events(events);
+        std::string hypothesis;
+        for (const PipelineEvent& event : events) {
+            if (event.type == PIPELINE_RESULT) hypothesis = event.text;
+        }
+        const double compute = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double audio = static_cast<double>(pipeline.stats().empty() ? 0 : pipeline.stats()[0].samples) /
+                             options.sample_rate;
+
+        if (engine_reference) reference = engine_reference_text;
+        const AsrScore score = score_clip(reference, hypothesis, audio, compute);
+        by_language[lang].add(score);
+        if (verbose || score.words.errors() > 0) {
+            printf("%-12s %-3s wer %.2f  ref \"%s\"  hyp \"%s\"\n", path.c_str(), lang.c_str(),
+                   score.words.rate(), reference.c_str(), hypothesis.c_str());
+        }
+    }
+    fclose(manifest);
+    if (whisper) {
+        JNIEnv env;
+        WHISPER_JNI(releaseModel)(&env, nullptr);
+        unlink(setup.clip_path.c_str());
+        rmdir(work_dir);
+    }
+    if (by_language.empty()) {
+        fprintf(stderr, "no clips in %s\n", manifest_path.c_str());
+        return 1;
+    }
+
+    bool pass = true;
+    AsrScore total;
+    printf("%-6s %6s %8s %8s %8s\n", "lang", "clips", "WER", "CER", "RTF");
+    for (const auto& entry : by_language) {
+        const AsrScore& score = entry.second;
+        total.add(score);
+        std::string verdict;
+        if (score.words.rate() > max_wer) verdict += " WER>max";
+        if (score.chars.rate() > max_cer) verdict += " CER>max";
+        if (score.rtf() > max_rtf) verdict += " RTF>max";
+        const auto it = baseline.find(entry.first);
+        if (it != baseline.end()) {
+            if (score.words.rate() > it->second.wer + tolerance) verdict += " WER regressed";
+            if (score.chars.rate() > it->second.cer + tolerance) verdict += " CER regressed";
+        }
+        if (!verdict.empty()) pass = false;
+        printf("%-6s %6zu %7.2f%% %7.2f%% %8.4f%s\n", entry.first.c_str(), score.clips,
+               100.0 * score.words.rate(), 100.0 * score.chars.rate(), score.rtf(), verdict.c_str());
+    }
+    printf("%-6s %6zu %7.2f%% %7.2f%% %8.4f\n", "all", total.clips,
+           100.0 * total.words.rate(), 100.0 * total.chars.rate(), total.rtf());
+    if (full_encoder_frames > 0) {
+        printf("encoder frames: %.1f%% of full context\n", 100.0 * encoder_frames / full_encoder_frames);
+    }
+
+    if (!write_baseline_path.empty()) {
+        FILE* out = fopen(write_baseline_path.c_str(), "w");
+        if (out == nullptr) {
+            fprintf(stderr, "cannot write %s\n", write_baseline_path.c_str());
+            return 1;
+        }
+        fprintf(out, "# language\twer\tcer (engine %s, spec \"%s\")\n", engine_name.c_str(), spec.c_str());
+        for (const auto& entry : by_language) {
+            fprintf(out, "%s\t%.4f\t%.4f\n", entry.first.c_str(), entry.second.words.rate(), entry.second.chars.rate());
+        }
+        fclose(out);
+    }
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
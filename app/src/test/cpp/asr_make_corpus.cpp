@@ -0,0 +1,100 @@
+/**
+ * asr_make_corpus.cpp - Generate the golden ASR regression corpus
+ *
+ * Renders a fixed set of English, German, Spanish and Russian sentences as
+ * tone-coded speech (tone_speech.h) at the capture rates seen on devices,
+ * with background noise and level changes, and writes a manifest.tsv in
+ * the format read by asr_eval. Output is deterministic.
+ *
+ * Usage: asr_make_corpus <output_dir>
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_audio.h"
+#include "tone_speech.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    struct Sentence {
+        const char* lang;
+        const char* text;
+    };
+
+    const Sentence kSentences[] = {
+        {"en", "What's the weather like tomorrow?"},
+        {"en", "Set a timer for 15 minutes."},
+        {"en", "Read my last three messages."},
+        {"en", "Turn on the flashlight, please."},
+        {"de", "Wie spät ist es in Berlin?"},
+        {"de", "Stell einen Wecker für sieben Uhr."},
+        {"de", "Schließ die Tür und mach das Licht aus."},
+        {"de", "Öffne die Einstellungen für Bluetooth."},
+        {"es", "¿Qué tiempo hará mañana en Madrid?"},
+        {"es", "Envía un mensaje a mi hermano."},
+        {"es", "Pon música tranquila, por favor."},
+        {"es", "¿Cuántos kilómetros hay hasta Sevilla?"},
+        {"ru", "Какая завтра погода?"},
+        {"ru", "Поставь будильник на семь утра."},
+        {"ru", "Прочитай последнее сообщение."},
+        {"ru", "Включи фонарик, пожалуйста."},
+    };
+
+    struct Condition {
+        int32_t sample_rate;
+        float amplitude;
+        float noise;
+    };
+
+    // Device capture rates, quiet and loud speakers, and a noisy room (~4 dB SNR)
+    const Condition kConditions[] = {
+        {16000, 0.3f, 0.002f},
+        {48000, 0.1f, 0.01f},
+        {44100, 0.5f, 0.02f},
+        {16000, 0.1f, 0.06f},
+    };
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output_dir>\n", argv[0]);
+        return 2;
+    }
+    const std::string dir = argv[1];
+    FILE* manifest = fopen((dir + "/manifest.tsv").c_str(), "w");
+    if (manifest == nullptr) {
+        fprintf(stderr, "cannot write %s/manifest.tsv\n", dir.c_str());
+        return 1;
+    }
+    fprintf(manifest, "# path\tlanguage\treference\n");
+
+    std::mt19937 rng(42);
+    int clip = 0;
+    for (const Sentence& sentence : kSentences) {
+        for (const Condition& condition : kConditions) {
+            std::vector<int16_t> pcm = render_tone_speech(sentence.text, condition.sample_rate, condition.amplitude);
+            std::vector<int16_t> noise;
+            append_noise(noise, condition.sample_rate, condition.noise,
+                         static_cast<int32_t>(pcm.size() * 1000 / condition.sample_rate), rng);
+            mix_into(pcm, noise, 0);
+
+            char name[64];
+            snprintf(name, sizeof(name), "%s_%03d.wav", sentence.lang, clip++);
+            if (!write_wav_mono16(dir + "/" + name, pcm.data(), pcm.size(), condition.sample_rate)) {
+                fprintf(stderr, "cannot write %s/%s\n", dir.c_str(), name);
+                fclose(manifest);
+                return 1;
+            }
+            fprintf(manifest, "%s\t%s\t%s\n", name, sentence.lang, sentence.text);
+        }
+    }
+    fclose(manifest);
+    printf("wrote %d clips to %s\n", clip, dir.c_str());
+    return 0;
+}
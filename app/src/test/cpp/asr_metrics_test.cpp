@@ -0,0 +1,78 @@
+/**
+ * asr_metrics_test.cpp - WER/CER alignment and the tone-coded speech round trip
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asr_metrics.h"
+#include "test_audio.h"
+#include "tone_speech.h"
+#include "voice_pipeline.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+TEST(AsrMetrics, NormalizesCasePunctuationAndScripts) {
+    const std::vector<std::string> words = normalize_transcript("  What's the WEATHER, Über-Stadt?  ¿Qué?  ПРИВЕТ!");
+    const std::vector<std::string> expected = {"what's", "the", "weather", "über", "stadt", "qué", "привет"};
+    EXPECT_EQ(words, expected);
+    EXPECT_EQ(encode_utf8(decode_utf8("ß ё 日本")), "ß ё 日本");
+}
+
+TEST(AsrMetrics, CountsWordEdits) {
+    const ErrorCounts same = word_errors("set a timer", "Set a timer.");
+    EXPECT_EQ(same.errors(), 0u);
+    EXPECT_EQ(same.reference, 3u);
+
+    const ErrorCounts counts = word_errors("set a timer for ten minutes", "set the timer ten minutes please");
+    EXPECT_EQ(counts.substitutions, 1u);   // a -> the
+    EXPECT_EQ(counts.deletions, 1u);       // for
+    EXPECT_EQ(counts.insertions, 1u);      // please
+    EXPECT_DOUBLE_EQ(counts.rate(), 3.0 / 6.0);
+
+    EXPECT_DOUBLE_EQ(word_errors("", "").rate(), 0.0);
+    EXPECT_DOUBLE_EQ(word_errors("", "noise").rate(), 1.0);
+}
+
+TEST(AsrMetrics, CountsCharactersAsCodePoints) {
+    const ErrorCounts counts = char_errors("привет мир", "привед мир");
+    EXPECT_EQ(counts.reference, 9u);
+    EXPECT_EQ(counts.substitutions, 1u);
+    EXPECT_EQ(counts.errors(), 1u);
+}
+
+TEST(AsrMetrics, AccumulatesScores) {
+    AsrScore total;
+    total.add(score_clip("a b c d", "a b c d", 2.0, 0.1));
+    total.add(score_clip("a b c d", "a x c", 2.0, 0.3));
+    EXPECT_EQ(total.clips, 2u);
+    EXPECT_DOUBLE_EQ(total.words.rate(), 2.0 / 8.0);
+    EXPECT_DOUBLE_EQ(total.rtf(), 0.1);
+}
+
+TEST(ToneSpeech, RoundTripsThroughResamplingPipeline) {
+    const std::string text = "Schließ die Tür, включи свет и 15 минут";
+    std::vector<int16_t> pcm = render_tone_speech(text, 48000, 0.2f);
+    std::mt19937 rng(5);
+    std::vector<int16_t> noise;
+    append_noise(noise, 48000, 0.01f, static_cast<int32_t>(pcm.size() / 48), rng);
+    mix_into(pcm, noise, 0);
+
+    PipelineOptions options;
+    options.sample_rate = 48000;
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("resample rate=16000 | highpass", StageRegistry::with_builtins(), options, &error));
+    ASSERT_TRUE(pipeline.append("tone", make_engine_stage(std::unique_ptr<AsrEngine>(new ToneRecognizer())), &error));
+    BufferSource source(pcm, 48000);
+    pipeline.run(source);
+
+    std::vector<PipelineEvent> events;
+    pipeline.poll_events(events);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(word_errors(text, events[0].text).errors(), 0u) << events[0].text;
+}
@@ -0,0 +1,65 @@
+/**
+ * audio_context_test.cpp - Whisper encoder context sizing and its guardrails
+ */
+
+#include <gtest/gtest.h>
+
+#include "audio_context.h"
+
+using namespace assistant;
+
+TEST(AudioContext, ShortClipsGetTheMinimumContext) {
+    // 2 s command: 100 frames of audio, padded up to the 256-frame floor
+    EXPECT_EQ(compute_audio_ctx(2 * 16000, 16000), 256);
+    EXPECT_EQ(compute_audio_ctx(1, 16000), 256);
+}
+
+TEST(AudioContext, CoversClipWithMargin) {
+    const AudioContextPolicy policy;
+    for (int ms = 100; ms <= 20000; ms += 100) {
+        const size_t samples = static_cast<size_t>(ms) * 16;
+        const int32_t ctx = compute_audio_ctx(samples, 16000, policy);
+        const float covered = audio_ctx_seconds(ctx, policy);
+        const float seconds = ms / 1000.0f;
+        EXPECT_GE(covered, seconds * (1.0f + policy.margin_fraction) + policy.margin_seconds - 1e-3f) << ms << " ms";
+        if (ctx > 0) {
+            EXPECT_EQ(ctx % policy.granularity, 0) << ms << " ms";
+            EXPECT_LT(ctx, policy.full_ctx);
+        }
+    }
+}
+
+TEST(AudioContext, TypicalQueriesEncodeSeveralTimesFewerFrames) {
+    // Most voice queries are under 5 s; encoder cost grows at least linearly with frames
+    const int32_t ctx = compute_audio_ctx(5 * 16000, 16000);
+    ASSERT_GT(ctx, 0);
+    EXPECT_GE(1500.0 / ctx, 3.5);
+    EXPECT_GE(1500.0 / compute_audio_ctx(3 * 16000, 16000), 5.0);
+}
+
+TEST(AudioContext, LongClipsUseFullContext) {
+    EXPECT_EQ(compute_audio_ctx(21 * 16000, 16000), 0);
+    EXPECT_EQ(compute_audio_ctx(60 * 16000, 16000), 0);
+    EXPECT_EQ(compute_audio_ctx(0, 16000), 0);
+    EXPECT_FLOAT_EQ(audio_ctx_seconds(0), 30.0f);
+
+    AudioContextPolicy wide;
+    wide.max_seconds = 30.0f;
+    EXPECT_EQ(compute_audio_ctx(27 * 16000, 16000, wide), 0);    // rounds past 1500
+}
+
+TEST(AudioContext, HonoursSampleRate) {
+    EXPECT_EQ(compute_audio_ctx(8 * 48000, 48000), compute_audio_ctx(8 * 16000, 16000));
+    EXPECT_EQ(compute_audio_ctx(16000, 0), 0);
+}
+
+TEST(AudioContext, FlagsDegenerateTranscripts) {
+    EXPECT_FALSE(transcript_looks_degenerate("", 2.0));
+    EXPECT_FALSE(transcript_looks_degenerate(" Set a timer for fifteen minutes.", 2.0));
+    EXPECT_FALSE(transcript_looks_degenerate(" one two three four five six seven eight nine ten", 4.0));
+
+    // Decoder stuck in a loop
+    EXPECT_TRUE(transcript_looks_degenerate(" thank you thank you thank you thank you thank you", 4.0));
+    // Far more text than 2 s of speech can hold
+    EXPECT_TRUE(transcript_looks_degenerate(std::string(200, 'a'), 2.0));
+}
@@ -0,0 +1,234 @@
+/**
+ * audio_decode_bench.cpp - Throughput and memory of the imported-audio decoders
+ *
+ * Writes the same speech-like recording in the layouts voice notes come in
+ * (16 kHz mono as the app records, 44.1/48 kHz stereo from other apps,
+ * 24-bit from recorders) as WAV and FLAC, then decodes each two ways:
+ *
+ *   decode     the decoder alone, mono at the file's rate
+ *   16k        the file job's path: decoder + resampler, in 30 s windows
+ *
+ * Speeds are audio seconds per wall second (x realtime) and compressed MB
+ * per second. "peak" is how far the process high-water mark rose during
+ * the 16k pass (Linux: reset through /proc/self/clear_refs), which should
+ * stay near the size of one window whatever the file length.
+ *
+ * Lossy formats (AAC, Opus, MP3) go through MediaCodec on the device and
+ * are not measured here.
+ *
+ * Usage: audio_decode_bench [--minutes M] [--repeat N] [work_dir]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "audio_decoder.h"
+#include "flac_encode.h"
+#include "test_audio.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kOutputRate = 16000;
+    constexpr size_t kWindow = 30 * kOutputRate;
+
+    struct Layout {
+        const char* name;
+        int32_t rate;
+        int32_t channels;
+        int32_t bps;
+    };
+
+    std::vector<std::vector<int32_t>> make_audio(const Layout& layout, double minutes, std::mt19937& rng) {
+        const auto ms = static_cast<int32_t>(minutes * 60000.0);
+        std::uniform_int_distribution<int32_t> low(0, (1 << std::max(0, layout.bps - 16)) - 1);
+        std::vector<std::vector<int32_t>> planar;
+        for (int32_t c = 0; c < layout.channels; ++c) {
+            std::vector<int16_t> pcm;
+            append_speech(pcm, layout.rate, 0.3f, ms, rng);
+            std::vector<int32_t> wide(pcm.size());
+            for (size_t i = 0; i < pcm.size(); ++i) {
+                wide[i] = static_cast<int32_t>(static_cast<uint32_t>(pcm[i]) << (layout.bps - 16)) | (pcm[i] != 0 ? low(rng) : 0);
+            }
+            planar.push_back(std::move(wide));
+        }
+        return planar;
+    }
+
+    bool write_wav(const std::string& path, const std::vector<std::vector<int32_t>>& planar, int32_t rate, int32_t bps) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr) return false;
+        const auto channels = static_cast<uint32_t>(planar.size());
+        const auto bytes = static_cast<uint32_t>(bps / 8);
+        const auto data = static_cast<uint32_t>(planar[0].size() * channels * bytes);
+        std::vector<uint8_t> out;
+        const auto u32 = [&out](uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i))); };
+        const auto u16 = [&out](uint32_t v) { out.push_back(static_cast<uint8_t>(v)); out.push_back(static_cast<uint8_t>(v >> 8)); };
+        out.insert(out.end(), {'R', 'I', 'F', 'F'});
+        u32(36 + data);
+        out.insert(out.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        u32(16);
+        u16(1);
+        u16(channels);
+        u32(static_cast<uint32_t>(rate));
+        u32(static_cast<uint32_t>(rate) * channels * bytes);
+        u16(channels * bytes);
+        u16(static_cast<uint32_t>(bps));
+        out.insert(out.end(), {'d', 'a', 't', 'a'});
+        u32(data);
+        bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+        std::vector<uint8_t> frame(channels * bytes);
+        for (size_t i = 0; i < planar[0].size() && ok; ++i) {
+            for (uint32_t c = 0; c < channels; ++c) {
+                const auto v = static_cast<uint32_t>(planar[c][i]);
+                for (uint32_t b = 0; b < bytes; ++b) frame[c * bytes + b] = static_cast<uint8_t>(v >> (8 * b));
+            }
+            ok = fwrite(frame.data(), 1, frame.size(), file) == frame.size();
+        }
+        return fclose(file) == 0 && ok;
+    }
+
+    double file_mb(const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 ? static_cast<double>(st.st_size) / (1024.0 * 1024.0) : 0.0;
+    }
+
+    /** VmHWM in KiB, after optionally resetting it; -1 where /proc does not say. */
+    long peak_rss_kb(bool reset) {
+        if (reset) {
+            FILE* clear = fopen("/proc/self/clear_refs", "w");
+            if (clear == nullptr) return -1;
+            fputs("5", clear);
+            fclose(clear);
+        }
+        FILE* status = fopen("/proc/self/status", "r");
+        if (status == nullptr) return -1;
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), status) != nullptr) {
+            if (strncmp(line, "VmHWM:", 6) == 0) kb = atol(line + 6);
+        }
+        fclose(status);
+        return kb;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct Result {
+        double decode_s = 1e9;
+        double stream_s = 1e9;
+        long peak_kb = -1;
+        size_t output = 0;
+        bool ok = true;
+    };
+
+    Result measure(const std::string& path, int repeat, std::vector<float>& window) {
+        Result result;
+        std::vector<float> chunk(4096);
+        for (int r = 0; r < repeat; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            auto decoder = open_audio_decoder(path.c_str());
+            if (!decoder) return Result{0, 0, -1, 0, false};
+            while (decoder->read(chunk.data(), chunk.size()) > 0) {}
+            result.decode_s = std::min(result.decode_s, seconds_since(start));
+            result.ok &= !decoder->failed();
+            decoder.reset();
+
+            const long before = peak_rss_kb(true);
+            start = std::chrono::steady_clock::now();
+            auto stream = AudioFileStream::open(path.c_str(), kOutputRate);
+            if (!stream) return Result{0, 0, -1, 0, false};
+            size_t total = 0;
+            size_t got;
+            while ((got = stream->read(window.data(), window.size())) > 0) total += got;
+            result.stream_s = std::min(result.stream_s, seconds_since(start));
+            const long after = peak_rss_kb(false);
+            if (before >= 0 && after >= 0) result.peak_kb = std::max(result.peak_kb, after - before);
+            result.output = total;
+            result.ok &= !stream->failed();
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    double minutes = 5.0;
+    int repeat = 3;
+    std::string dir;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) minutes = atof(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && dir.empty()) dir = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--minutes M] [--repeat N] [work_dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    minutes = std::max(0.05, minutes);
+    repeat = std::max(1, repeat);
+    if (dir.empty()) {
+        char pattern[] = "/tmp/audio_decode_bench.XXXXXX";
+        if (mkdtemp(pattern) == nullptr) {
+            perror("mkdtemp");
+            return 2;
+        }
+        dir = pattern;
+    }
+
+    const Layout layouts[] = {
+        {"16k mono 16-bit", 16000, 1, 16},
+        {"44.1k stereo 16-bit", 44100, 2, 16},
+        {"48k stereo 24-bit", 48000, 2, 24},
+    };
+    struct File {
+        std::string path;
+        std::string label;
+        double audio_s;
+    };
+    std::vector<File> files;
+    std::mt19937 rng(3);
+    for (const Layout& layout : layouts) {
+        const auto planar = make_audio(layout, minutes, rng);
+        const double audio_s = static_cast<double>(planar[0].size()) / layout.rate;
+        const std::string base = dir + "/" + std::to_string(layout.rate) + "_" + std::to_string(layout.channels) + "_" +
+                                 std::to_string(layout.bps);
+        if (!write_wav(base + ".wav", planar, layout.rate, layout.bps) ||
+            !write_flac(base + ".flac", planar, layout.rate, layout.bps)) {
+            fprintf(stderr, "cannot write %s\n", base.c_str());
+            return 2;
+        }
+        files.push_back({base + ".wav", std::string("wav  ") + layout.name, audio_s});
+        files.push_back({base + ".flac", std::string("flac ") + layout.name, audio_s});
+    }
+
+    printf("%.1f min of audio per file, best of %d\n\n", minutes, repeat);
+    printf("%-26s %8s %12s %12s %10s %10s\n", "file", "MB", "decode xRT", "16k xRT", "16k MB/s", "peak KiB");
+    std::vector<float> window(kWindow);
+    bool ok = true;
+    for (const File& file : files) {
+        const Result r = measure(file.path, repeat, window);
+        const double mb = file_mb(file.path);
+        const auto expected = static_cast<size_t>(file.audio_s * kOutputRate + 0.999);
+        if (!r.ok || r.output + 1 < expected || r.output > expected + 1) {
+            fprintf(stderr, "%s: decoded %zu frames at 16 kHz, expected %zu\n", file.path.c_str(), r.output, expected);
+            ok = false;
+        }
+        const std::string peak = r.peak_kb >= 0 ? std::to_string(r.peak_kb) : "n/a";
+        printf("%-26s %8.1f %12.0f %12.0f %10.1f %10s\n", file.label.c_str(), mb, file.audio_s / r.decode_s,
+               file.audio_s / r.stream_s, mb / r.stream_s, peak.c_str());
+    }
+    printf("\n16k: %zu-frame windows, as the background file job reads them\n", kWindow);
+    return ok ? 0 : 1;
+}
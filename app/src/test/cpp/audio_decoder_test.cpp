@@ -0,0 +1,422 @@
+/**
+ * audio_decoder_test.cpp - FLAC and WAV decoding, resampling stream, damaged and foreign files
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "audio_decoder.h"
+#include "flac_encode.h"
+#include "test_audio.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    std::string temp_path(const std::string& name) {
+        return ::testing::TempDir() + "audio_decoder_" + name;
+    }
+
+    /**
+     * `channels` of speech-like signal with a silent stretch, as `bps`-bit
+     * planar samples. Above 16 bits the low bits are random unless
+     * `padded`, which leaves them zero (16-bit audio in a 24-bit file).
+     */
+    std::vector<std::vector<int32_t>> make_planar(int32_t rate, int32_t channels, int32_t bps, int32_t ms, uint32_t seed,
+                                                  bool padded = false) {
+        std::mt19937 rng(seed);
+        std::vector<std::vector<int32_t>> planar;
+        for (int32_t c = 0; c < channels; ++c) {
+            std::vector<int16_t> pcm;
+            append_speech(pcm, rate, 0.4f, ms / 2, rng);
+            append_silence(pcm, rate, ms / 4);
+            append_noise(pcm, rate, 0.05f, ms - ms / 2 - ms / 4, rng);
+            std::vector<int32_t> wide(pcm.size());
+            std::uniform_int_distribution<int32_t> low(0, (1 << std::max(0, bps - 16)) - 1);
+            for (size_t i = 0; i < pcm.size(); ++i) {
+                const int32_t fill = !padded && pcm[i] != 0 ? low(rng) : 0;
+                wide[i] = bps >= 16 ? static_cast<int32_t>(static_cast<uint32_t>(pcm[i]) << (bps - 16)) | fill
+                                    : pcm[i] >> (16 - bps);
+            }
+            planar.push_back(std::move(wide));
+        }
+        return planar;
+    }
+
+    /** The mono floats a decoder must produce for `planar`. */
+    std::vector<float> expected_mono(const std::vector<std::vector<int32_t>>& planar, int32_t bps) {
+        const float divisor = std::ldexp(1.0f, bps - 1) * static_cast<float>(planar.size());
+        std::vector<float> mono(planar[0].size());
+        for (size_t i = 0; i < mono.size(); ++i) {
+            int64_t sum = 0;
+            for (const auto& channel : planar) sum += channel[i];
+            mono[i] = static_cast<float>(sum) / divisor;
+        }
+        return mono;
+    }
+
+    std::vector<float> decode_all(AudioDecoder& decoder, size_t chunk = 1000) {
+        std::vector<float> out;
+        std::vector<float> buffer(chunk);
+        size_t got;
+        while ((got = decoder.read(buffer.data(), buffer.size())) > 0) out.insert(out.end(), buffer.begin(), buffer.begin() + got);
+        return out;
+    }
+
+    std::vector<float> stream_all(AudioFileStream& stream, size_t chunk) {
+        std::vector<float> out;
+        std::vector<float> buffer(chunk);
+        size_t got;
+        while ((got = stream.read(buffer.data(), buffer.size())) > 0) out.insert(out.end(), buffer.begin(), buffer.begin() + got);
+        return out;
+    }
+
+    /** Interleaved WAV with an arbitrary sample encoding; samples are given as floats in [-1, 1). */
+    void write_wav(const std::string& path, const std::vector<std::vector<float>>& planar, int32_t rate,
+                   int32_t format, int32_t bits) {
+        const auto channels = static_cast<uint32_t>(planar.size());
+        const uint32_t bytes = static_cast<uint32_t>(bits / 8);
+        const uint32_t data = static_cast<uint32_t>(planar[0].size()) * channels * bytes;
+        std::vector<uint8_t> out;
+        const auto u32 = [&out](uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i))); };
+        const auto u16 = [&out](uint32_t v) { out.push_back(static_cast<uint8_t>(v)); out.push_back(static_cast<uint8_t>(v >> 8)); };
+        out.insert(out.end(), {'R', 'I', 'F', 'F'});
+        u32(36 + 12 + data);
+        out.insert(out.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        u32(16);
+        u16(static_cast<uint32_t>(format));
+        u16(channels);
+        u32(static_cast<uint32_t>(rate));
+        u32(static_cast<uint32_t>(rate) * channels * bytes);
+        u16(channels * bytes);
+        u16(static_cast<uint32_t>(bits));
+        // A LIST chunk before the data, as phone recorders write
+        out.insert(out.end(), {'L', 'I', 'S', 'T'});
+        u32(4);
+        out.insert(out.end(), {'I', 'N', 'F', 'O'});
+        out.insert(out.end(), {'d', 'a', 't', 'a'});
+        u32(data);
+        for (size_t i = 0; i < planar[0].size(); ++i) {
+            for (const auto& channel : planar) {
+                const float s = channel[i];
+                if (format == 3) {
+                    uint32_t v;
+                    memcpy(&v, &s, sizeof(v));
+                    u32(v);
+                } else if (bits == 8) {
+                    out.push_back(static_cast<uint8_t>(std::lround(s * 127.0f) + 128));
+                } else {
+                    const auto v = static_cast<uint32_t>(static_cast<int32_t>(std::lround(s * std::ldexp(1.0, bits - 1))));
+                    for (int32_t b = 0; b < bits / 8; ++b) out.push_back(static_cast<uint8_t>(v >> (8 * b)));
+                }
+            }
+        }
+        FILE* file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(out.data(), 1, out.size(), file);
+        fclose(file);
+    }
+
+    std::vector<uint8_t> read_bytes(const std::string& path) {
+        std::vector<uint8_t> bytes;
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return bytes;
+        uint8_t buffer[4096];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + got);
+        fclose(file);
+        return bytes;
+    }
+
+    void write_bytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+        FILE* file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        fclose(file);
+    }
+}
+
+TEST(AudioDecoder, FlacRoundTripIsBitExact) {
+    struct Case {
+        int32_t channels;
+        int32_t bps;
+        FlacEncodeOptions options;
+        bool padded;
+    };
+    std::vector<Case> cases;
+    for (FlacStereo stereo : {FLAC_INDEPENDENT, FLAC_LEFT_SIDE, FLAC_SIDE_RIGHT, FLAC_MID_SIDE, FLAC_STEREO_AUTO}) {
+        FlacEncodeOptions options;
+        options.stereo = stereo;
+        cases.push_back({2, 16, options, false});
+    }
+    FlacEncodeOptions fixed_only;
+    fixed_only.lpc_order = 0;
+    cases.push_back({1, 16, fixed_only, false});
+    FlacEncodeOptions verbatim;
+    verbatim.verbatim = true;
+    cases.push_back({2, 16, verbatim, false});
+    FlacEncodeOptions odd_blocks;
+    odd_blocks.block_size = 1152;
+    odd_blocks.lpc_order = 32;
+    odd_blocks.lpc_precision = 15;
+    cases.push_back({1, 24, odd_blocks, false});
+    cases.push_back({2, 24, FlacEncodeOptions{}, false});
+    cases.push_back({2, 24, FlacEncodeOptions{}, true});     // wasted bits
+    cases.push_back({2, 8, FlacEncodeOptions{}, false});
+    cases.push_back({6, 20, FlacEncodeOptions{}, false});
+
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const Case& c = cases[i];
+        SCOPED_TRACE("case " + std::to_string(i));
+        const auto planar = make_planar(44100, c.channels, c.bps, 1500, static_cast<uint32_t>(i), c.padded);
+        const std::string path = temp_path("roundtrip_" + std::to_string(i) + ".flac");
+        ASSERT_TRUE(write_flac(path, planar, 44100, c.bps, c.options));
+
+        std::string error;
+        auto decoder = open_audio_decoder(path.c_str(), &error);
+        ASSERT_NE(decoder, nullptr) << error;
+        EXPECT_EQ(decoder->info().format, AUDIO_FLAC);
+        EXPECT_EQ(decoder->info().sample_rate, 44100);
+        EXPECT_EQ(decoder->info().channels, c.channels);
+        EXPECT_EQ(decoder->info().bits_per_sample, c.bps);
+        EXPECT_EQ(decoder->info().frames, static_cast<int64_t>(planar[0].size()));
+
+        const std::vector<float> decoded = decode_all(*decoder);
+        EXPECT_FALSE(decoder->failed());
+        const std::vector<float> expected = expected_mono(planar, c.bps);
+        ASSERT_EQ(decoded.size(), expected.size());
+        size_t mismatches = 0;
+        for (size_t s = 0; s < expected.size(); ++s) mismatches += decoded[s] != expected[s];
+        EXPECT_EQ(mismatches, 0u);
+    }
+}
+
+TEST(AudioDecoder, FlacCompresses) {
+    const auto planar = make_planar(44100, 2, 16, 3000, 1);
+    const std::string path = temp_path("ratio.flac");
+    ASSERT_TRUE(write_flac(path, planar, 44100, 16));
+    const double pcm_bytes = static_cast<double>(planar[0].size()) * 2 * 2;
+    EXPECT_LT(static_cast<double>(read_bytes(path).size()), 0.7 * pcm_bytes);
+}
+
+TEST(AudioDecoder, FlacWithId3TagAndUnknownLength) {
+    const auto planar = make_planar(16000, 1, 16, 2000, 2);
+    FlacEncodeOptions options;
+    options.total_frames = false;
+    options.id3_bytes = 300;
+    const std::string path = temp_path("tagged.flac");
+    ASSERT_TRUE(write_flac(path, planar, 16000, 16, options));
+
+    auto stream = AudioFileStream::open(path.c_str(), 16000);
+    ASSERT_NE(stream, nullptr);
+    EXPECT_EQ(stream->frames(), -1);
+    const std::vector<float> decoded = stream_all(*stream, 777);
+    EXPECT_FALSE(stream->failed());
+    EXPECT_EQ(decoded, expected_mono(planar, 16));
+    EXPECT_EQ(stream->frames(), static_cast<int64_t>(decoded.size()));
+}
+
+TEST(AudioDecoder, DamagedFlacFrameBecomesSilence) {
+    const auto planar = make_planar(16000, 1, 16, 3000, 3);
+    FlacEncodeOptions options;
+    options.block_size = 1024;
+    const std::string path = temp_path("damaged.flac");
+    ASSERT_TRUE(write_flac(path, planar, 16000, 16, options));
+    std::vector<uint8_t> bytes = read_bytes(path);
+    bytes[bytes.size() / 2] ^= 0x5a;
+    write_bytes(path, bytes);
+
+    auto decoder = open_audio_decoder(path.c_str());
+    ASSERT_NE(decoder, nullptr);
+    const std::vector<float> decoded = decode_all(*decoder);
+    const std::vector<float> expected = expected_mono(planar, 16);
+    EXPECT_FALSE(decoder->failed());
+    ASSERT_EQ(decoded.size(), expected.size());
+
+    // Exactly one block differs, and it is silent
+    size_t mismatched_blocks = 0;
+    for (size_t block = 0; block * 1024 < expected.size(); ++block) {
+        bool differs = false;
+        bool silent = true;
+        for (size_t i = block * 1024; i < std::min(expected.size(), (block + 1) * 1024); ++i) {
+            differs |= decoded[i] != expected[i];
+            silent &= decoded[i] == 0.0f;
+        }
+        if (differs) {
+            ++mismatched_blocks;
+            EXPECT_TRUE(silent);
+        }
+    }
+    EXPECT_EQ(mismatched_blocks, 1u);
+}
+
+TEST(AudioDecoder, TruncatedFlacReportsFailure) {
+    const auto planar = make_planar(16000, 1, 16, 2000, 4);
+    const std::string path = temp_path("truncated.flac");
+    ASSERT_TRUE(write_flac(path, planar, 16000, 16));
+    std::vector<uint8_t> bytes = read_bytes(path);
+    bytes.resize(bytes.size() * 2 / 3);
+    write_bytes(path, bytes);
+
+    auto decoder = open_audio_decoder(path.c_str());
+    ASSERT_NE(decoder, nullptr);
+    const std::vector<float> decoded = decode_all(*decoder);
+    EXPECT_TRUE(decoder->failed());
+    EXPECT_GT(decoded.size(), 0u);
+    EXPECT_LT(decoded.size(), planar[0].size());
+}
+
+TEST(AudioDecoder, Wav16kMatchesTheRecordingPath) {
+    std::mt19937 rng(5);
+    std::vector<int16_t> pcm;
+    append_speech(pcm, 16000, 0.3f, 2000, rng);
+    const std::string path = temp_path("clip.wav");
+    ASSERT_TRUE(write_wav_mono16(path, pcm.data(), pcm.size(), 16000));
+
+    Arena arena(1024);
+    float* direct = nullptr;
+    size_t n_direct = 0;
+    ASSERT_TRUE(read_wav_mono_float(path.c_str(), arena, &direct, &n_direct));
+    float* decoded = nullptr;
+    size_t n_decoded = 0;
+    ASSERT_TRUE(read_audio_mono_float(path.c_str(), 16000, arena, &decoded, &n_decoded));
+    ASSERT_EQ(n_decoded, n_direct);
+    EXPECT_EQ(memcmp(direct, decoded, n_direct * sizeof(float)), 0);
+}
+
+TEST(AudioDecoder, WavEncodingsAgree) {
+    std::mt19937 rng(6);
+    std::vector<int16_t> left, right;
+    append_speech(left, 22050, 0.4f, 1000, rng);
+    append_speech(right, 22050, 0.4f, 1000, rng);
+    std::vector<std::vector<float>> planar(2);
+    for (size_t i = 0; i < left.size(); ++i) {
+        planar[0].push_back(left[i] / 32768.0f);
+        planar[1].push_back(right[i] / 32768.0f);
+    }
+    const std::vector<float> reference = [&] {
+        std::vector<float> mono(left.size());
+        for (size_t i = 0; i < mono.size(); ++i) mono[i] = (planar[0][i] + planar[1][i]) / 2.0f;
+        return mono;
+    }();
+
+    const struct { int32_t format, bits; float tolerance; } encodings[] = {
+        {1, 8, 1.0f / 128}, {1, 16, 1e-6f}, {1, 24, 1e-6f}, {1, 32, 1e-6f}, {3, 32, 1e-7f},
+    };
+    for (const auto& e : encodings) {
+        SCOPED_TRACE("format " + std::to_string(e.format) + ", " + std::to_string(e.bits) + " bits");
+        const std::string path = temp_path("enc_" + std::to_string(e.format) + "_" + std::to_string(e.bits) + ".wav");
+        write_wav(path, planar, 22050, e.format, e.bits);
+        auto decoder = open_audio_decoder(path.c_str());
+        ASSERT_NE(decoder, nullptr);
+        EXPECT_EQ(decoder->info().frames, static_cast<int64_t>(reference.size()));
+        const std::vector<float> decoded = decode_all(*decoder, 333);
+        ASSERT_EQ(decoded.size(), reference.size());
+        float worst = 0.0f;
+        for (size_t i = 0; i < decoded.size(); ++i) worst = std::max(worst, std::fabs(decoded[i] - reference[i]));
+        EXPECT_LE(worst, e.tolerance);
+    }
+}
+
+TEST(AudioDecoder, StreamResamplesToExactLength) {
+    // 48 kHz stereo tone: 16 kHz output keeps the tone and ends exactly where the input does
+    const int32_t rate = 48000;
+    const size_t n = 48000 * 3 + 17;
+    std::vector<std::vector<int32_t>> planar(2, std::vector<int32_t>(n));
+    for (size_t i = 0; i < n; ++i) {
+        const double s = 0.5 * std::sin(2.0 * M_PI * 440.0 * static_cast<double>(i) / rate);
+        planar[0][i] = planar[1][i] = static_cast<int32_t>(std::lround(s * 32767.0));
+    }
+    const std::string path = temp_path("tone48k.flac");
+    ASSERT_TRUE(write_flac(path, planar, rate, 16));
+
+    auto whole = AudioFileStream::open(path.c_str(), 16000);
+    ASSERT_NE(whole, nullptr);
+    const int64_t expected_frames = (static_cast<int64_t>(n) * 16000 + rate - 1) / rate;
+    EXPECT_EQ(whole->frames(), expected_frames);
+    std::vector<float> all(static_cast<size_t>(expected_frames) + 100);
+    EXPECT_EQ(whole->read(all.data(), all.size()), static_cast<size_t>(expected_frames));
+    all.resize(static_cast<size_t>(expected_frames));
+
+    // Same samples whatever the chunk size
+    auto chunked = AudioFileStream::open(path.c_str(), 16000);
+    EXPECT_EQ(stream_all(*chunked, 1237), all);
+    EXPECT_EQ(chunked->position(), expected_frames);
+
+    double energy = 0.0;
+    for (size_t i = 1000; i < all.size() - 1000; ++i) energy += static_cast<double>(all[i]) * all[i];
+    const double rms = std::sqrt(energy / static_cast<double>(all.size() - 2000));
+    EXPECT_NEAR(rms, 0.5 / std::sqrt(2.0), 0.01);
+}
+
+TEST(AudioDecoder, SkipResumesWhereReadWould) {
+    // Resuming a file job steps over the saved windows; what follows must match an uninterrupted read
+    const auto planar = make_planar(44100, 2, 16, 3000, 21);
+    const std::string path = temp_path("skip.flac");
+    ASSERT_TRUE(write_flac(path, planar, 44100, 16));
+    auto whole = AudioFileStream::open(path.c_str(), 16000);
+    ASSERT_NE(whole, nullptr);
+    const std::vector<float> all = stream_all(*whole, 4096);
+
+    for (size_t at : {size_t{0}, size_t{1}, size_t{16000}, size_t{20011}, all.size() - 5}) {
+        auto resumed = AudioFileStream::open(path.c_str(), 16000);
+        EXPECT_EQ(resumed->skip(at), at);
+        EXPECT_EQ(resumed->position(), static_cast<int64_t>(at));
+        EXPECT_EQ(stream_all(*resumed, 3000), std::vector<float>(all.begin() + static_cast<std::ptrdiff_t>(at), all.end()))
+            << "resumed at " << at;
+    }
+    auto past_end = AudioFileStream::open(path.c_str(), 16000);
+    EXPECT_EQ(past_end->skip(all.size() + 100), all.size());
+    EXPECT_FALSE(past_end->failed());
+}
+
+TEST(AudioDecoder, ReadsWholeFileIntoArena) {
+    const auto planar = make_planar(44100, 2, 16, 1000, 7);
+    const std::string path = temp_path("arena.flac");
+    ASSERT_TRUE(write_flac(path, planar, 44100, 16));
+    Arena arena(1024);
+    float* pcm = nullptr;
+    size_t n = 0;
+    ASSERT_TRUE(read_audio_mono_float(path.c_str(), 16000, arena, &pcm, &n));
+    EXPECT_EQ(n, (planar[0].size() * 16000 + 44099) / 44100);
+}
+
+TEST(AudioDecoder, SniffsContainers) {
+    const auto sniff = [](const char* bytes, size_t n) { return sniff_audio_format(reinterpret_cast<const uint8_t*>(bytes), n); };
+    EXPECT_EQ(sniff("RIFF\x24\0\0\0WAVEfmt ", 16), AUDIO_WAV);
+    EXPECT_EQ(sniff("fLaC\0\0\0\x22", 8), AUDIO_FLAC);
+    EXPECT_EQ(sniff("OggS\0\x02\0\0", 8), AUDIO_OGG);
+    EXPECT_EQ(sniff("\0\0\0\x20" "ftypM4A ", 12), AUDIO_MP4);
+    EXPECT_EQ(sniff("\xff\xfb\x90\x64", 4), AUDIO_MP3);
+    EXPECT_EQ(sniff("\xff\xf1\x50\x80", 4), AUDIO_ADTS);
+    EXPECT_EQ(sniff("#!AMR\n", 6), AUDIO_AMR);
+    EXPECT_EQ(sniff("hello world", 11), AUDIO_UNKNOWN);
+}
+
+TEST(AudioDecoder, RejectsWhatItCannotDecode) {
+    std::string error;
+    EXPECT_EQ(open_audio_decoder(temp_path("missing.wav").c_str(), &error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+    const std::string text = temp_path("notes.txt");
+    write_bytes(text, {'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd'});
+    error.clear();
+    EXPECT_EQ(AudioFileStream::open(text.c_str(), 16000, &error), nullptr);
+    EXPECT_NE(error.find("unrecognized"), std::string::npos);
+
+#ifndef __ANDROID__
+    // Lossy formats need the platform codecs
+    const std::string ogg = temp_path("note.ogg");
+    write_bytes(ogg, {'O', 'g', 'g', 'S', 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    error.clear();
+    EXPECT_EQ(open_audio_decoder(ogg.c_str(), &error), nullptr);
+    EXPECT_NE(error.find("Android"), std::string::npos);
+#endif
+}
@@ -0,0 +1,210 @@
+/**
+ * barge_in_test.cpp - Echo cancellation and barge-in detection on a simulated room
+ *
+ * The "room" delays the playback reference, smears it with a decaying
+ * impulse response and adds it to the microphone together with noise and,
+ * optionally, the user's speech.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "barge_in.h"
+#include "echo_canceller.h"
+#include "test_audio.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+
+    int64_t ms_to_samples(int32_t ms) { return static_cast<int64_t>(kRate) * ms / 1000; }
+
+    /** Speaker-to-mic path: 40 ms delay, then 60 ms of decaying reflections. */
+    std::vector<float> room_response(uint32_t seed, float gain = 0.6f) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+        std::vector<float> h(static_cast<size_t>(ms_to_samples(100)), 0.0f);
+        const size_t delay = static_cast<size_t>(ms_to_samples(40));
+        h[delay] = gain;
+        for (size_t i = delay + 1; i < h.size(); ++i) {
+            h[i] = gain * 0.3f * dist(rng) * std::exp(-static_cast<float>(i - delay) / 200.0f);
+        }
+        return h;
+    }
+
+    /** y = h * x, skipping the zero taps of the delay. */
+    std::vector<int16_t> convolve(const std::vector<int16_t>& x, const std::vector<float>& h) {
+        size_t first = 0;
+        while (first < h.size() && h[first] == 0.0f) ++first;
+        std::vector<float> acc(x.size(), 0.0f);
+        // Tap-major: one pass over the signal per tap, which the compiler vectorizes
+        for (size_t k = first; k < h.size(); ++k) {
+            const float tap = h[k];
+            for (size_t i = k; i < x.size(); ++i) acc[i] += tap * x[i - k];
+        }
+        std::vector<int16_t> y(x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            y[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, acc[i])));
+        }
+        return y;
+    }
+
+    struct Scene {
+        std::vector<int16_t> reference;
+        std::vector<int16_t> mic;
+    };
+
+    /** Assistant speech for `ms`; user speech (at about the echo level) from `user_at_ms` if >= 0. */
+    Scene make_scene(int32_t ms, int32_t user_at_ms, uint32_t seed = 1, float user_amplitude = 0.3f) {
+        std::mt19937 rng(seed);
+        Scene scene;
+        append_speech(scene.reference, kRate, 0.5f, ms, rng);
+        // Synthesized voices are not purely harmonic; a breath component keeps the reference broadband
+        std::vector<int16_t> breath;
+        append_noise(breath, kRate, 0.1f, ms, rng);
+        mix_into(scene.reference, breath, 0);
+        scene.mic = convolve(scene.reference, room_response(seed));
+        std::vector<int16_t> noise;
+        append_noise(noise, kRate, 0.002f, ms, rng);
+        mix_into(scene.mic, noise, 0);
+        if (user_at_ms >= 0) {
+            std::vector<int16_t> user;
+            append_speech(user, kRate, user_amplitude, 1500, rng);
+            mix_into(scene.mic, user, static_cast<size_t>(ms_to_samples(user_at_ms)));
+        }
+        return scene;
+    }
+
+    /** Feed reference and capture in lockstep 20 ms chunks; returns the trigger time or -1. */
+    int64_t run(BargeInDetector& detector, const Scene& scene) {
+        const size_t chunk = 320;
+        for (size_t i = 0; i + chunk <= scene.mic.size(); i += chunk) {
+            detector.push_reference(scene.reference.data() + i, chunk);
+            if (detector.process_capture(scene.mic.data() + i, chunk)) {
+                return detector.trigger_sample() * 1000 / kRate;
+            }
+        }
+        return -1;
+    }
+}
+
+TEST(EchoCanceller, ConvergesOnSpeechReference) {
+    const Scene scene = make_scene(4000, -1);
+    EchoCanceller aec;
+    const size_t block = static_cast<size_t>(aec.block_size());
+    std::vector<float> mic(block), ref(block), out(block);
+    double mic_energy = 0.0, out_energy = 0.0;
+    for (size_t i = 0; i + block <= scene.mic.size(); i += block) {
+        for (size_t j = 0; j < block; ++j) {
+            mic[j] = scene.mic[i + j] / 32768.0f;
+            ref[j] = scene.reference[i + j] / 32768.0f;
+        }
+        aec.process(mic.data(), ref.data(), out.data());
+        if (static_cast<int64_t>(i) >= ms_to_samples(2000)) {
+            for (size_t j = 0; j < block; ++j) {
+                mic_energy += mic[j] * mic[j];
+                out_energy += out[j] * out[j];
+            }
+        }
+    }
+    const double erle = 10.0 * std::log10(mic_energy / out_energy);
+    EXPECT_GT(erle, 12.0);
+    EXPECT_GT(aec.erle_db(), 8.0f);
+}
+
+TEST(EchoCanceller, FrozenFilterKeepsNearEndSpeech) {
+    EchoCanceller aec;
+    aec.set_adaptation(false);
+    const size_t block = static_cast<size_t>(aec.block_size());
+    std::vector<float> mic(block, 0.1f), ref(block, 0.0f), out(block);
+    aec.process(mic.data(), ref.data(), out.data());
+    EXPECT_FLOAT_EQ(out[block - 1], 0.1f);
+}
+
+TEST(BargeIn, NoTriggerOnEchoAlone) {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        BargeInDetector detector;
+        EXPECT_EQ(run(detector, make_scene(10000, -1, seed)), -1) << "seed " << seed;
+    }
+}
+
+TEST(BargeIn, TriggersOnUserSpeechOverPlayback) {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        BargeInDetector detector;
+        const int64_t at = run(detector, make_scene(8000, 4000, seed));
+        ASSERT_GE(at, 4000) << "seed " << seed;
+        EXPECT_LE(at, 4500) << "seed " << seed;
+    }
+}
+
+TEST(BargeIn, TriggersWhenPlaybackIsSilent) {
+    std::mt19937 rng(9);
+    Scene scene;
+    append_silence(scene.reference, kRate, 3000);
+    append_noise(scene.mic, kRate, 0.002f, 3000, rng);
+    std::vector<int16_t> user;
+    append_speech(user, kRate, 0.1f, 1000, rng);
+    mix_into(scene.mic, user, static_cast<size_t>(ms_to_samples(1000)));
+
+    BargeInDetector detector;
+    const int64_t at = run(detector, scene);
+    EXPECT_GE(at, 1000);
+    EXPECT_LE(at, 1300);
+}
+
+TEST(BargeIn, ResampledReference) {
+    // TTS at 24 kHz: the reference goes through the resampler before the canceller
+    const Scene scene = make_scene(8000, 4500, 3);
+    std::vector<int16_t> reference24;
+    for (size_t i = 0; i < scene.reference.size(); ++i) {
+        // Linear upsample 2:3 is good enough to produce a 24 kHz version of the same audio
+        reference24.push_back(scene.reference[i]);
+        if (i % 2 == 1) {
+            const int16_t next = i + 1 < scene.reference.size() ? scene.reference[i + 1] : 0;
+            reference24.push_back(static_cast<int16_t>((scene.reference[i] + next) / 2));
+        }
+    }
+
+    BargeInConfig config;
+    config.reference_rate = 24000;
+    BargeInDetector detector(config);
+    int64_t at = -1;
+    for (size_t i = 0; i + 320 <= scene.mic.size() && at < 0; i += 320) {
+        detector.push_reference(reference24.data() + i * 3 / 2, 480);
+        if (detector.process_capture(scene.mic.data() + i, 320)) at = detector.trigger_sample() * 1000 / kRate;
+    }
+    EXPECT_GE(at, 4500);
+    EXPECT_LE(at, 4900);
+}
+
+TEST(BargeIn, PrerollHoldsSpeechStart) {
+    BargeInConfig config;
+    config.preroll_ms = 1000;
+    BargeInDetector detector(config);
+    const Scene scene = make_scene(8000, 4000, 2);
+    ASSERT_GE(run(detector, scene), 4000);
+
+    std::vector<int16_t> preroll(detector.preroll_capacity());
+    const size_t n = detector.copy_preroll(preroll.data(), preroll.size());
+    ASSERT_EQ(n, static_cast<size_t>(ms_to_samples(1000)));
+    // The preroll window reaches back before the user started talking
+    const int64_t start = detector.samples() - static_cast<int64_t>(n);
+    EXPECT_LT(start, ms_to_samples(4000));
+}
+
+TEST(BargeIn, PushSilenceKeepsAlignment) {
+    BargeInDetector detector;
+    std::vector<int16_t> mic;
+    std::mt19937 rng(4);
+    append_noise(mic, kRate, 0.002f, 2000, rng);
+    for (size_t i = 0; i + 320 <= mic.size(); i += 320) {
+        detector.push_silence(320);
+        EXPECT_FALSE(detector.process_capture(mic.data() + i, 320));
+    }
+    EXPECT_EQ(detector.samples(), ms_to_samples(2000));
+}
@@ -0,0 +1,149 @@
+/**
+ * command_grammar_test.cpp - Phrase trie, constrained decoding and early exit
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "command_grammar.h"
+
+using namespace assistant;
+
+namespace {
+    constexpr int32_t kEot = 0;
+    constexpr size_t kVocab = 64;
+
+    /** Word-level stand-in for the recognizer's tokenizer. */
+    class WordTokenizer {
+    public:
+        std::vector<int32_t> tokenize(const std::string& text) {
+            std::vector<int32_t> out;
+            std::istringstream in(text);
+            for (std::string word; in >> word;) {
+                auto it = ids_.find(word);
+                if (it == ids_.end()) it = ids_.emplace(word, static_cast<int32_t>(ids_.size()) + 1).first;
+                out.push_back(it->second);
+            }
+            return out;
+        }
+
+    private:
+        std::map<std::string, int32_t> ids_;
+    };
+
+    /**
+     * Greedy decode where the "acoustics" strongly prefer the words of
+     * `spoken`: the next spoken word gets a high logit, everything else 0.
+     */
+    CommandMatch decode(const PhraseTrie& trie, const std::vector<int32_t>& spoken, size_t* steps_run = nullptr) {
+        CommandDecoder decoder(trie, kEot);
+        std::vector<int32_t> history;
+        for (size_t step = 0; step < 16; ++step) {
+            std::vector<float> logits(kVocab, 0.0f);
+            if (history.size() < spoken.size()) logits[spoken[history.size()]] = 8.0f;
+            else logits[kEot] = 8.0f;
+            decoder.constrain(history.data(), history.size(), logits.data(), logits.size());
+            const int32_t next = static_cast<int32_t>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+            if (steps_run != nullptr) *steps_run = step + 1;
+            if (next == kEot) break;
+            history.push_back(next);
+        }
+        return decoder.result();
+    }
+
+    struct Fixture {
+        WordTokenizer tokenizer;
+        PhraseTrie trie;
+        std::vector<CommandPhrase> phrases;
+
+        Fixture() {
+            const std::string spec =
+                "# intent\tphrase\n"
+                "open_app\topen camera\n"
+                "open_app\topen calendar\n"
+                "open_app\topen the camera\n"
+                "timer\tset timer for five minutes\n"
+                "flashlight\tturn on flashlight\n"
+                "flashlight\tturn on the flashlight\n";
+            std::string error;
+            EXPECT_TRUE(parse_command_spec(spec, phrases, &error)) << error;
+            for (size_t i = 0; i < phrases.size(); ++i) {
+                const auto tokens = tokenizer.tokenize(phrases[i].text);
+                trie.add(tokens.data(), tokens.size(), static_cast<int32_t>(i));
+            }
+        }
+    };
+}
+
+TEST(CommandGrammar, ParsesSpec) {
+    std::vector<CommandPhrase> phrases;
+    std::string error;
+    ASSERT_TRUE(parse_command_spec("a\tone\r\n\n# note\nb\ttwo words", phrases, &error));
+    ASSERT_EQ(phrases.size(), 2u);
+    EXPECT_EQ(phrases[1].intent, "b");
+    EXPECT_EQ(phrases[1].text, "two words");
+
+    EXPECT_FALSE(parse_command_spec("no tab here", phrases, &error));
+    EXPECT_NE(error.find("line 1"), std::string::npos);
+    EXPECT_FALSE(parse_command_spec("# only comments\n", phrases, &error));
+}
+
+TEST(CommandGrammar, TrieTracksUniqueSubtrees) {
+    Fixture f;
+    const auto open = f.tokenizer.tokenize("open");
+    const auto set = f.tokenizer.tokenize("set");
+    const auto open_camera = f.tokenizer.tokenize("open camera");
+
+    EXPECT_EQ(f.trie.only_phrase(PhraseTrie::kRoot), -1);
+    EXPECT_EQ(f.trie.only_phrase(f.trie.walk(open.data(), 1)), -1);
+    EXPECT_EQ(f.trie.only_phrase(f.trie.walk(set.data(), 1)), 3);
+    EXPECT_EQ(f.trie.terminal(f.trie.walk(open_camera.data(), 2)), 0);
+    EXPECT_EQ(f.trie.walk(f.tokenizer.tokenize("open sesame").data(), 2), -1);
+    EXPECT_EQ(f.trie.max_depth(), 5u);
+}
+
+TEST(CommandGrammar, MatchesSpokenPhrase) {
+    Fixture f;
+    const CommandMatch match = decode(f.trie, f.tokenizer.tokenize("open calendar"));
+    ASSERT_EQ(match.phrase, 1);
+    EXPECT_EQ(f.phrases[match.phrase].intent, "open_app");
+    EXPECT_FALSE(match.early);
+    EXPECT_GT(match.score, 0.9f);
+}
+
+TEST(CommandGrammar, DecidesAfterAHandfulOfTokens) {
+    Fixture f;
+    size_t steps = 0;
+    // "set" already singles out the timer phrase; four more words are never decoded
+    const CommandMatch match = decode(f.trie, f.tokenizer.tokenize("set timer for five minutes"), &steps);
+    ASSERT_EQ(match.phrase, 3);
+    EXPECT_TRUE(match.early);
+    EXPECT_EQ(match.steps, 1);
+    EXPECT_EQ(steps, 2u);
+    EXPECT_GT(match.score, 0.9f);
+}
+
+TEST(CommandGrammar, OutOfGrammarSpeechScoresLow) {
+    Fixture f;
+    // The acoustics want words the grammar does not have
+    const CommandMatch match = decode(f.trie, f.tokenizer.tokenize("what is the weather"));
+    EXPECT_LT(match.score, 0.1f);
+}
+
+TEST(CommandGrammar, MasksEverythingOutsideTheTrie) {
+    Fixture f;
+    CommandDecoder decoder(f.trie, kEot);
+    std::vector<float> logits(kVocab, 1.0f);
+    decoder.constrain(nullptr, 0, logits.data(), logits.size());
+
+    size_t open = 0;
+    for (float l : logits) open += std::isfinite(l) ? 1 : 0;
+    EXPECT_EQ(open, 3u);    // open, set, turn; no eot before a phrase is complete
+    EXPECT_FALSE(std::isfinite(logits[kEot]));
+}
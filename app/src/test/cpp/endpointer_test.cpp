@@ -0,0 +1,152 @@
+/**
+ * endpointer_test.cpp - End-of-utterance detection on synthetic captures
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "endpointer.h"
+#include "test_audio.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+
+    /** Noise bed of `total_ms` with speech from `speech_at_ms` lasting `speech_ms`. */
+    std::vector<int16_t> capture(int32_t total_ms, int32_t speech_at_ms, int32_t speech_ms,
+                                 float noise = 0.003f, uint32_t seed = 1) {
+        std::mt19937 rng(seed);
+        std::vector<int16_t> pcm;
+        append_noise(pcm, kRate, noise, total_ms, rng);
+        std::vector<int16_t> speech;
+        append_speech(speech, kRate, 0.3f, speech_ms, rng);
+        mix_into(pcm, speech, static_cast<size_t>(kRate) * speech_at_ms / 1000);
+        return pcm;
+    }
+
+    /** Feed in 20 ms chunks until the endpoint fires; returns the sample count consumed. */
+    size_t run(Endpointer& endpointer, const std::vector<int16_t>& pcm) {
+        size_t i = 0;
+        while (i < pcm.size() && endpointer.state() != ENDPOINT_ENDED) {
+            const size_t n = std::min<size_t>(320, pcm.size() - i);
+            endpointer.process(pcm.data() + i, n);
+            i += n;
+        }
+        return i;
+    }
+
+    int64_t ms_to_samples(int32_t ms) { return static_cast<int64_t>(kRate) * ms / 1000; }
+}
+
+TEST(Endpointer, EndsAfterHangoverFollowingSpeech) {
+    Endpointer endpointer;
+    const auto pcm = capture(6000, 500, 2000);
+    run(endpointer, pcm);
+
+    ASSERT_EQ(endpointer.state(), ENDPOINT_ENDED);
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_SILENCE);
+    EXPECT_NEAR(endpointer.speech_start_sample(), ms_to_samples(500), ms_to_samples(150));
+    EXPECT_NEAR(endpointer.speech_end_sample(), ms_to_samples(2500), ms_to_samples(150));
+    EXPECT_GE(endpointer.detection_delay_ms(), 800);
+    EXPECT_LE(endpointer.detection_delay_ms(), 820);
+}
+
+TEST(Endpointer, ShortPausesDoNotEndUtterance) {
+    std::mt19937 rng(3);
+    std::vector<int16_t> pcm;
+    append_noise(pcm, kRate, 0.003f, 5000, rng);
+    std::vector<int16_t> phrase;
+    append_speech(phrase, kRate, 0.3f, 900, rng);
+    // Two phrases with a 500 ms pause between them
+    mix_into(pcm, phrase, ms_to_samples(300));
+    mix_into(pcm, phrase, ms_to_samples(1700));
+
+    Endpointer endpointer;
+    run(endpointer, pcm);
+    ASSERT_EQ(endpointer.reason(), ENDPOINT_REASON_SILENCE);
+    EXPECT_GT(endpointer.speech_end_sample(), ms_to_samples(2400));
+}
+
+TEST(Endpointer, DecoderEndpointShortensHangover) {
+    const auto pcm = capture(6000, 500, 2000);
+    Endpointer endpointer;
+    size_t i = 0;
+    bool notified = false;
+    while (i < pcm.size() && endpointer.state() != ENDPOINT_ENDED) {
+        endpointer.process(pcm.data() + i, 320);
+        i += 320;
+        // Pretend the recognizer finalized 100 ms after the speech stopped
+        if (!notified && static_cast<int64_t>(i) >= ms_to_samples(2600)) {
+            endpointer.notify_decoder_endpoint();
+            notified = true;
+        }
+    }
+    ASSERT_EQ(endpointer.reason(), ENDPOINT_REASON_DECODER);
+    EXPECT_LT(endpointer.detection_delay_ms(), 400);
+}
+
+TEST(Endpointer, DecoderEndpointClearedByMoreSpeech) {
+    Endpointer endpointer;
+    const auto pcm = capture(8000, 300, 3000);
+    size_t i = 0;
+    while (i < pcm.size() && endpointer.state() != ENDPOINT_ENDED) {
+        endpointer.process(pcm.data() + i, 320);
+        i += 320;
+        if (static_cast<int64_t>(i) == ms_to_samples(1000)) endpointer.notify_decoder_endpoint();
+    }
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_SILENCE);
+    EXPECT_GT(endpointer.speech_end_sample(), ms_to_samples(3000));
+}
+
+TEST(Endpointer, TimesOutWithoutSpeech) {
+    EndpointerConfig config;
+    config.leading_timeout_ms = 2000;
+    Endpointer endpointer(config);
+    const auto pcm = capture(5000, 0, 0, 0.02f);
+    const size_t consumed = run(endpointer, pcm);
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_NO_SPEECH);
+    EXPECT_LE(consumed, static_cast<size_t>(ms_to_samples(2020)));
+    EXPECT_EQ(endpointer.speech_start_sample(), -1);
+}
+
+TEST(Endpointer, LoudStationaryNoiseIsNotSpeech) {
+    EndpointerConfig config;
+    config.leading_timeout_ms = 3000;
+    Endpointer endpointer(config);
+    const auto pcm = capture(4000, 0, 0, 0.1f);
+    run(endpointer, pcm);
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_NO_SPEECH);
+}
+
+TEST(Endpointer, SpeechOverNoiseIsDetected) {
+    Endpointer endpointer;
+    const auto pcm = capture(6000, 1000, 1500, 0.03f, 7);
+    run(endpointer, pcm);
+    ASSERT_EQ(endpointer.reason(), ENDPOINT_REASON_SILENCE);
+    EXPECT_NEAR(endpointer.speech_end_sample(), ms_to_samples(2500), ms_to_samples(200));
+}
+
+TEST(Endpointer, MaxUtteranceLength) {
+    EndpointerConfig config;
+    config.max_utterance_ms = 1500;
+    Endpointer endpointer(config);
+    const auto pcm = capture(6000, 200, 5000);
+    run(endpointer, pcm);
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_MAX_LENGTH);
+}
+
+TEST(Endpointer, ResetStartsOver) {
+    Endpointer endpointer;
+    const auto pcm = capture(5000, 500, 1000);
+    run(endpointer, pcm);
+    ASSERT_EQ(endpointer.state(), ENDPOINT_ENDED);
+    endpointer.reset();
+    EXPECT_EQ(endpointer.state(), ENDPOINT_WAITING);
+    EXPECT_EQ(endpointer.end_sample(), -1);
+    run(endpointer, pcm);
+    EXPECT_EQ(endpointer.reason(), ENDPOINT_REASON_SILENCE);
+}
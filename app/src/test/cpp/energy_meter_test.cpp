@@ -0,0 +1,152 @@
+/**
+ * energy_meter_test.cpp - Power integration on stand-in files, per-thread CPU time, per-engine totals
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "energy_meter.h"
+
+using namespace assistant;
+
+namespace {
+    void write_file(const std::string& path, const std::string& value) {
+        FILE* file = fopen(path.c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        fprintf(file, "%s\n", value.c_str());
+        fclose(file);
+    }
+
+    /** power_supply/battery stand-in drawing `amps` at `volts`. */
+    std::string battery_root(const std::string& name, double amps, double volts, const char* status) {
+        const std::string root = ::testing::TempDir() + name;
+        mkdir(root.c_str(), 0755);
+        mkdir((root + "/power_supply").c_str(), 0755);
+        mkdir((root + "/power_supply/battery").c_str(), 0755);
+        write_file(root + "/power_supply/battery/status", status);
+        write_file(root + "/power_supply/battery/current_now", std::to_string(static_cast<long long>(amps * 1e6)));
+        write_file(root + "/power_supply/battery/voltage_now", std::to_string(static_cast<long long>(volts * 1e6)));
+        return root;
+    }
+
+    /** Spin until this thread has used `seconds` of CPU, however busy the machine is. */
+    void burn_cpu(double seconds) {
+        const double until = thread_cpu_seconds() + seconds;
+        volatile uint64_t x = 1;
+        while (thread_cpu_seconds() < until) x = x * 6364136223846793005ull + 1;
+    }
+}
+
+TEST(EnergyMeter, IntegratesBatteryPowerAndCpuTime) {
+    // 0.5 A at 4 V: 2 W for the whole request
+    EnergyMeter meter(DeviceSensors(battery_root("energy_discharging", 0.5, 4.0, "Discharging")), 5);
+    const uint64_t token = meter.begin("whisper");
+    std::thread worker([] { burn_cpu(0.1); });
+    burn_cpu(0.1);
+    worker.join();
+
+    EnergySample sample;
+    ASSERT_TRUE(meter.end(token, 3.0, &sample));
+    EXPECT_TRUE(sample.power_known);
+    EXPECT_NEAR(sample.joules, 2.0 * sample.wall_seconds, 1e-6);
+    // The calling thread's 100 ms only; the worker's is not this thread's
+    EXPECT_TRUE(sample.cpu_known);
+    EXPECT_GE(sample.cpu_seconds, 0.1);
+    EXPECT_LT(sample.cpu_seconds, 0.15);
+    EXPECT_DOUBLE_EQ(sample.audio_seconds, 3.0);
+    EXPECT_FALSE(meter.end(token, 3.0));
+
+    const std::vector<EngineEnergy> engines = meter.engines();
+    ASSERT_EQ(engines.size(), 1u);
+    EXPECT_EQ(engines[0].engine, "whisper");
+    EXPECT_EQ(engines[0].measured, 1u);
+    EXPECT_NEAR(engines[0].joules_per_audio_second(), sample.joules / 3.0, 1e-9);
+    EXPECT_NEAR(engines[0].cpu_per_audio_second(), sample.cpu_seconds / 3.0, 1e-9);
+}
+
+TEST(EnergyMeter, ChargingOrMissingPowerIsUnknown) {
+    EnergyMeter charging(DeviceSensors(battery_root("energy_charging", 1.0, 4.2, "Charging")), 5);
+    EnergySample sample;
+    uint64_t token = charging.begin("chat");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(charging.end(token, 0.0, &sample));
+    EXPECT_FALSE(sample.power_known);
+    EXPECT_EQ(sample.joules, 0.0);
+    EXPECT_GT(sample.wall_seconds, 0.0);
+
+    EnergyMeter none(DeviceSensors(::testing::TempDir() + "energy_no_sysfs"), 5);
+    token = none.begin("vosk");
+    ASSERT_TRUE(none.end(token, 2.0, &sample));
+    EXPECT_FALSE(sample.power_known);
+    const std::vector<EngineEnergy> engines = none.engines();
+    ASSERT_EQ(engines.size(), 1u);
+    EXPECT_EQ(engines[0].requests, 1u);
+    EXPECT_EQ(engines[0].measured, 0u);
+    EXPECT_EQ(engines[0].joules_per_audio_second(), 0.0);
+}
+
+TEST(EnergyMeter, ReportsEachEngine) {
+    EnergyMeter meter(DeviceSensors(battery_root("energy_report", 0.25, 4.0, "Discharging")), 5);
+    for (const char* engine : { "whisper", "vosk", "whisper" }) {
+        const uint64_t token = meter.begin(engine);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        meter.end(token, 1.0);
+    }
+    // Overlapping measurements split the 1 W draw instead of each being charged all of it
+    const uint64_t a = meter.begin("chat");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const uint64_t b = meter.begin("whisper");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EnergySample first;
+    EnergySample second;
+    meter.end(b, 1.0, &second);
+    meter.end(a, 0.0, &first);
+    ASSERT_TRUE(first.power_known);
+    ASSERT_TRUE(second.power_known);
+    EXPECT_NEAR(second.joules, 0.5 * second.wall_seconds, 1e-6);
+    EXPECT_NEAR(first.joules + second.joules, 1.0 * first.wall_seconds, 1e-6);
+
+    const std::vector<EngineEnergy> engines = meter.engines();
+    ASSERT_EQ(engines.size(), 3u);
+    EXPECT_EQ(engines[0].engine, "chat");
+    EXPECT_EQ(engines[2].engine, "whisper");
+    EXPECT_EQ(engines[2].requests, 3u);
+    const std::string report = meter.format_report();
+    EXPECT_NE(report.find("vosk"), std::string::npos);
+    EXPECT_NE(report.find("J/audio s"), std::string::npos);
+}
+
+TEST(EnergyMeter, CpuTimeNeedsTheSameThread) {
+    EnergyMeter meter(DeviceSensors(battery_root("energy_threads", 0.5, 4.0, "Discharging")), 5);
+    const uint64_t token = meter.begin("chat");
+    EnergySample sample;
+    // A suspended coroutine can resume elsewhere; that thread's clock says nothing about this request
+    std::thread other([&] { ASSERT_TRUE(meter.end(token, 0.0, &sample)); });
+    other.join();
+    EXPECT_FALSE(sample.cpu_known);
+    EXPECT_EQ(sample.cpu_seconds, 0.0);
+    EXPECT_TRUE(sample.power_known);
+
+    const std::vector<EngineEnergy> engines = meter.engines();
+    ASSERT_EQ(engines.size(), 1u);
+    EXPECT_EQ(engines[0].requests, 1u);
+    EXPECT_EQ(engines[0].cpu_seconds, 0.0);
+}
+
+TEST(EnergyMeter, RefusesPastMaxOpen) {
+    EnergyMeter meter(DeviceSensors(::testing::TempDir() + "energy_no_sysfs"), 5);
+    std::vector<uint64_t> tokens;
+    for (size_t i = 0; i < EnergyMeter::kMaxOpen; ++i) tokens.push_back(meter.begin("whisper-file"));
+    for (uint64_t token : tokens) EXPECT_NE(token, 0u);
+    EXPECT_EQ(meter.begin("whisper"), 0u);
+    EXPECT_FALSE(meter.end(0, 1.0));
+    for (uint64_t token : tokens) EXPECT_TRUE(meter.end(token, 1.0));
+    EXPECT_NE(meter.begin("whisper"), 0u);
+}
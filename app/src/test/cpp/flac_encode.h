@@ -0,0 +1,461 @@
+/**
+ * flac_encode.h - Small FLAC encoder for decoder tests and benchmarks
+ *
+ * No FLAC tooling is assumed on the build host, so tests make their own
+ * streams. The encoder covers what real encoders emit: constant, verbatim,
+ * fixed and LPC subframes, wasted bits, the three stereo decorrelation
+ * modes and partitioned Rice residuals, with frame CRCs and an optional
+ * ID3v2 tag in front. It picks the cheapest subframe by estimated size,
+ * which is good enough to give realistic compression ratios.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace assistant {
+namespace testing {
+
+enum FlacStereo : int32_t {
+    FLAC_INDEPENDENT = 0,
+    FLAC_LEFT_SIDE,
+    FLAC_SIDE_RIGHT,
+    FLAC_MID_SIDE,
+    FLAC_STEREO_AUTO,       // smallest of the four, per frame
+};
+
+struct FlacEncodeOptions {
+    uint32_t block_size = 4096;
+    int32_t lpc_order = 8;          // 0: fixed predictors only
+    int32_t lpc_precision = 12;
+    uint32_t max_partition_order = 6;
+    FlacStereo stereo = FLAC_STEREO_AUTO;
+    bool verbatim = false;          // every subframe verbatim
+    bool total_frames = true;       // false: STREAMINFO says "unknown length"
+    size_t id3_bytes = 0;           // ID3v2 tag of this size before the stream
+};
+
+class FlacBitWriter {
+public:
+    void put(uint32_t value, int n) {
+        if (n == 0) return;
+        const uint64_t mask = n == 32 ? 0xffffffffull : (1ull << n) - 1;
+        acc_ = (acc_ << n) | (value & mask);
+        bits_ += n;
+        while (bits_ >= 8) {
+            bits_ -= 8;
+            bytes.push_back(static_cast<uint8_t>(acc_ >> bits_));
+        }
+    }
+
+    void put_signed(int32_t value, int n) { put(static_cast<uint32_t>(value), n); }
+
+    void put_unary(uint32_t zeros) {
+        while (zeros >= 32) {
+            put(0, 32);
+            zeros -= 32;
+        }
+        put(1, static_cast<int>(zeros) + 1);
+    }
+
+    void align() {
+        if (bits_ > 0) put(0, 8 - bits_);
+    }
+
+    std::vector<uint8_t> bytes;
+
+private:
+    uint64_t acc_ = 0;
+    int bits_ = 0;
+};
+
+namespace flac_detail {
+
+inline uint8_t crc8(const uint8_t* p, size_t n) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x80) != 0 ? ((crc << 1) ^ 0x07) & 0xff : (crc << 1) & 0xff;
+    }
+    return static_cast<uint8_t>(crc);
+}
+
+inline uint16_t crc16(const uint8_t* p, size_t n) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        crc ^= static_cast<uint32_t>(p[i]) << 8;
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x8000) != 0 ? ((crc << 1) ^ 0x8005) & 0xffff : (crc << 1) & 0xffff;
+    }
+    return static_cast<uint16_t>(crc);
+}
+
+inline uint32_t zigzag(int32_t r) {
+    return (static_cast<uint32_t>(r) << 1) ^ static_cast<uint32_t>(r >> 31);
+}
+
+/** Partition order and per-partition Rice parameters for residual r[order, n). */
+struct RicePlan {
+    uint32_t method = 0;
+    uint32_t partition_order = 0;
+    std::vector<uint32_t> k;
+    uint64_t bits = ~0ull;
+};
+
+inline RicePlan plan_rice(const std::vector<int32_t>& r, uint32_t n, uint32_t order, uint32_t max_order) {
+    RicePlan best;
+    for (uint32_t p = 0; p <= max_order; ++p) {
+        const uint32_t partition = n >> p;
+        if ((partition << p) != n || partition < order || partition == 0) break;
+        RicePlan plan;
+        plan.partition_order = p;
+        plan.bits = 6;
+        for (uint32_t part = 0; part < (1u << p); ++part) {
+            const uint32_t begin = part == 0 ? order : part * partition;
+            const uint32_t end = (part + 1) * partition;
+            uint64_t sum = 0;
+            for (uint32_t i = begin; i < end; ++i) sum += zigzag(r[i]);
+            const uint64_t count = end - begin;
+            uint32_t k = 0;
+            while (k < 30 && (count << (k + 1)) <= sum) ++k;
+            plan.k.push_back(k);
+            if (k > 14) plan.method = 1;
+            plan.bits += count * (k + 1) + (sum >> k);
+        }
+        plan.bits += static_cast<uint64_t>(plan.k.size()) * (plan.method == 0 ? 4 : 5);
+        if (plan.bits < best.bits) best = plan;
+    }
+    return best;
+}
+
+inline void write_rice(FlacBitWriter& w, const std::vector<int32_t>& r, uint32_t n, uint32_t order, const RicePlan& plan) {
+    w.put(plan.method, 2);
+    w.put(plan.partition_order, 4);
+    const uint32_t partition = n >> plan.partition_order;
+    for (uint32_t part = 0; part < plan.k.size(); ++part) {
+        const uint32_t k = plan.k[part];
+        w.put(k, plan.method == 0 ? 4 : 5);
+        const uint32_t begin = part == 0 ? order : part * partition;
+        for (uint32_t i = begin; i < (part + 1) * partition; ++i) {
+            const uint32_t u = zigzag(r[i]);
+            w.put_unary(u >> k);
+            w.put(u, static_cast<int>(k));
+        }
+    }
+}
+
+inline void fixed_residual(const int32_t* s, uint32_t n, uint32_t order, std::vector<int32_t>& r) {
+    r.assign(n, 0);
+    for (uint32_t i = order; i < n; ++i) {
+        int64_t pred = 0;
+        switch (order) {
+            case 1: pred = s[i - 1]; break;
+            case 2: pred = 2ll * s[i - 1] - s[i - 2]; break;
+            case 3: pred = 3ll * (s[i - 1] - static_cast<int64_t>(s[i - 2])) + s[i - 3]; break;
+            case 4: pred = 4ll * (s[i - 1] + static_cast<int64_t>(s[i - 3])) - 6ll * s[i - 2] - s[i - 4]; break;
+            default: break;
+        }
+        r[i] = static_cast<int32_t>(s[i] - pred);
+    }
+}
+
+/** Quantized LPC coefficients from a Welch-windowed autocorrelation; false if the block has no signal. */
+inline bool lpc_coefs(const int32_t* s, uint32_t n, int32_t order, int32_t precision,
+                      std::vector<int32_t>& q, int32_t* shift) {
+    std::vector<double> x(n);
+    const double half = (static_cast<double>(n) + 1.0) / 2.0;
+    for (uint32_t i = 0; i < n; ++i) {
+        const double t = (static_cast<double>(i) - (static_cast<double>(n) - 1.0) / 2.0) / half;
+        x[i] = s[i] * (1.0 - t * t);
+    }
+    std::vector<double> autoc(static_cast<size_t>(order) + 1, 0.0);
+    for (int32_t lag = 0; lag <= order; ++lag) {
+        for (uint32_t i = static_cast<uint32_t>(lag); i < n; ++i) autoc[lag] += x[i] * x[i - lag];
+    }
+    if (autoc[0] <= 0.0) return false;
+
+    std::vector<double> a(static_cast<size_t>(order) + 1, 0.0);
+    a[0] = 1.0;
+    double err = autoc[0];
+    for (int32_t i = 1; i <= order && err > 0.0; ++i) {
+        double acc = autoc[i];
+        for (int32_t j = 1; j < i; ++j) acc += a[j] * autoc[i - j];
+        const double k = -acc / err;
+        const std::vector<double> prev = a;
+        for (int32_t j = 1; j < i; ++j) a[j] = prev[j] + k * prev[i - j];
+        a[i] = k;
+        err *= 1.0 - k * k;
+    }
+
+    double cmax = 0.0;
+    for (int32_t j = 1; j <= order; ++j) cmax = std::max(cmax, std::fabs(a[j]));
+    if (cmax <= 0.0) return false;
+    const double limit = static_cast<double>((1 << (precision - 1)) - 1);
+    *shift = std::max(0, std::min(15, static_cast<int32_t>(std::floor(std::log2(limit / cmax)))));
+    q.resize(static_cast<size_t>(order));
+    for (int32_t j = 0; j < order; ++j) {
+        const double c = std::round(-a[j + 1] * std::ldexp(1.0, *shift));
+        q[j] = static_cast<int32_t>(std::max(-limit, std::min(limit, c)));
+    }
+    return true;
+}
+
+inline bool lpc_residual(const int32_t* s, uint32_t n, const std::vector<int32_t>& q, int32_t shift,
+                         std::vector<int32_t>& r) {
+    const auto order = static_cast<uint32_t>(q.size());
+    r.assign(n, 0);
+    for (uint32_t i = order; i < n; ++i) {
+        int64_t sum = 0;
+        for (uint32_t j = 0; j < order; ++j) sum += static_cast<int64_t>(q[j]) * s[i - 1 - j];
+        const int64_t residual = s[i] - (sum >> shift);
+        if (residual > (1 << 29) || residual < -(1 << 29)) return false;
+        r[i] = static_cast<int32_t>(residual);
+    }
+    return true;
+}
+
+/** One subframe, written as the cheapest of constant, verbatim, fixed and LPC. */
+inline void write_subframe(FlacBitWriter& w, const int32_t* samples, uint32_t n, int32_t bps,
+                           const FlacEncodeOptions& options) {
+    if (std::all_of(samples, samples + n, [&](int32_t v) { return v == samples[0]; }) && !options.verbatim) {
+        w.put(0, 8);
+        w.put_signed(samples[0], bps);
+        return;
+    }
+
+    uint32_t bits_or = 0;
+    for (uint32_t i = 0; i < n; ++i) bits_or |= static_cast<uint32_t>(samples[i]);
+    const int32_t wasted = options.verbatim || bits_or == 0 ? 0 : std::min(__builtin_ctz(bits_or), bps - 1);
+    std::vector<int32_t> s(samples, samples + n);
+    for (int32_t& v : s) v >>= wasted;
+    const int32_t width = bps - wasted;
+
+    // type: 1 verbatim, 8 + order fixed, 31 + order LPC
+    uint32_t best_type = 1;
+    uint64_t best_bits = static_cast<uint64_t>(n) * static_cast<uint64_t>(width);
+    RicePlan best_plan;
+    std::vector<int32_t> best_residual;
+    std::vector<int32_t> best_q;
+    int32_t best_shift = 0;
+
+    std::vector<int32_t> r;
+    if (!options.verbatim) {
+        for (uint32_t order = 0; order <= 4 && order < n; ++order) {
+            fixed_residual(s.data(), n, order, r);
+            const RicePlan plan = plan_rice(r, n, order, options.max_partition_order);
+            const uint64_t bits = order * static_cast<uint64_t>(width) + plan.bits;
+            if (bits < best_bits) {
+                best_bits = bits;
+                best_type = 8 + order;
+                best_plan = plan;
+                best_residual = r;
+            }
+        }
+        std::vector<int32_t> q;
+        int32_t shift = 0;
+        const auto order = static_cast<uint32_t>(options.lpc_order);
+        if (order > 0 && order < n && lpc_coefs(s.data(), n, options.lpc_order, options.lpc_precision, q, &shift) &&
+            lpc_residual(s.data(), n, q, shift, r)) {
+            const RicePlan plan = plan_rice(r, n, order, options.max_partition_order);
+            const uint64_t bits = order * static_cast<uint64_t>(width + options.lpc_precision) + 9 + plan.bits;
+            if (bits < best_bits) {
+                best_bits = bits;
+                best_type = 31 + order;
+                best_plan = plan;
+                best_residual = r;
+                best_q = q;
+                best_shift = shift;
+            }
+        }
+    }
+
+    w.put(0, 1);
+    w.put(best_type, 6);
+    if (wasted > 0) {
+        w.put(1, 1);
+        w.put_unary(static_cast<uint32_t>(wasted - 1));
+    } else {
+        w.put(0, 1);
+    }
+    if (best_type == 1) {
+        for (int32_t v : s) w.put_signed(v, width);
+        return;
+    }
+    const uint32_t order = best_type >= 32 ? best_type - 31 : best_type - 8;
+    for (uint32_t i = 0; i < order; ++i) w.put_signed(s[i], width);
+    if (best_type >= 32) {
+        w.put(static_cast<uint32_t>(options.lpc_precision - 1), 4);
+        w.put_signed(best_shift, 5);
+        for (int32_t c : best_q) w.put_signed(c, options.lpc_precision);
+    }
+    write_rice(w, best_residual, n, order, best_plan);
+}
+
+inline void write_utf8(FlacBitWriter& w, uint64_t v) {
+    if (v < 0x80) {
+        w.put(static_cast<uint32_t>(v), 8);
+        return;
+    }
+    int extra = 1;
+    while (extra < 6 && v >= (1ull << (6 + 5 * extra))) ++extra;
+    const uint32_t lead_mask = (0xff00u >> (extra + 1)) & 0xff;
+    w.put(lead_mask | static_cast<uint32_t>(v >> (6 * extra)), 8);
+    for (int i = extra - 1; i >= 0; --i) w.put(0x80 | static_cast<uint32_t>((v >> (6 * i)) & 0x3f), 8);
+}
+
+inline uint32_t block_code(uint32_t n) {
+    if (n == 192) return 1;
+    for (uint32_t c = 2; c <= 5; ++c) if (n == (576u << (c - 2))) return c;
+    for (uint32_t c = 8; c <= 15; ++c) if (n == (256u << (c - 8))) return c;
+    return n <= 256 ? 6 : 7;
+}
+
+inline uint32_t rate_code(int32_t rate) {
+    switch (rate) {
+        case 8000: return 4;
+        case 16000: return 5;
+        case 22050: return 6;
+        case 24000: return 7;
+        case 32000: return 8;
+        case 44100: return 9;
+        case 48000: return 10;
+        case 96000: return 11;
+        default: return rate % 1000 == 0 && rate / 1000 < 256 ? 12 : 0;
+    }
+}
+
+inline uint32_t size_code(int32_t bps) {
+    switch (bps) {
+        case 8: return 1;
+        case 12: return 2;
+        case 16: return 4;
+        case 20: return 5;
+        case 24: return 6;
+        default: return 0;
+    }
+}
+
+} // namespace flac_detail
+
+/** One frame of `n` samples per channel from planar `channels`. */
+inline std::vector<uint8_t> encode_flac_frame(const std::vector<std::vector<int32_t>>& planar, size_t first, uint32_t n,
+                                              uint64_t frame_number, int32_t rate, int32_t bps,
+                                              const FlacEncodeOptions& options) {
+    using namespace flac_detail;
+    const auto channels = static_cast<int32_t>(planar.size());
+
+    // Candidate channel layouts; stereo modes carry a side channel one bit wider
+    struct Layout {
+        uint32_t assignment;
+        std::vector<std::vector<int32_t>> data;
+        std::vector<int32_t> bps;
+    };
+    std::vector<Layout> layouts;
+    Layout independent{static_cast<uint32_t>(channels - 1), {}, {}};
+    for (int32_t c = 0; c < channels; ++c) {
+        independent.data.emplace_back(planar[c].begin() + static_cast<std::ptrdiff_t>(first),
+                                      planar[c].begin() + static_cast<std::ptrdiff_t>(first + n));
+        independent.bps.push_back(bps);
+    }
+    if (channels == 2 && options.stereo != FLAC_INDEPENDENT) {
+        const std::vector<int32_t>& l = independent.data[0];
+        const std::vector<int32_t>& r = independent.data[1];
+        std::vector<int32_t> side(n), mid(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            side[i] = l[i] - r[i];
+            mid[i] = (l[i] + r[i]) >> 1;
+        }
+        if (options.stereo == FLAC_LEFT_SIDE || options.stereo == FLAC_STEREO_AUTO) layouts.push_back({8, {l, side}, {bps, bps + 1}});
+        if (options.stereo == FLAC_SIDE_RIGHT || options.stereo == FLAC_STEREO_AUTO) layouts.push_back({9, {side, r}, {bps + 1, bps}});
+        if (options.stereo == FLAC_MID_SIDE || options.stereo == FLAC_STEREO_AUTO) layouts.push_back({10, {mid, side}, {bps, bps + 1}});
+    }
+    if (layouts.empty() || options.stereo == FLAC_STEREO_AUTO) layouts.push_back(std::move(independent));
+
+    std::vector<uint8_t> best;
+    for (const Layout& layout : layouts) {
+        FlacBitWriter w;
+        w.put(0xfff8, 16);
+        const uint32_t bcode = block_code(n);
+        const uint32_t rcode = rate_code(rate);
+        w.put(bcode, 4);
+        w.put(rcode, 4);
+        w.put(layout.assignment, 4);
+        w.put(size_code(bps), 3);
+        w.put(0, 1);
+        write_utf8(w, frame_number);
+        if (bcode == 6) w.put(n - 1, 8);
+        else if (bcode == 7) w.put(n - 1, 16);
+        if (rcode == 12) w.put(static_cast<uint32_t>(rate / 1000), 8);
+        w.put(crc8(w.bytes.data(), w.bytes.size()), 8);
+        for (size_t c = 0; c < layout.data.size(); ++c) write_subframe(w, layout.data[c].data(), n, layout.bps[c], options);
+        w.align();
+        const uint16_t crc = crc16(w.bytes.data(), w.bytes.size());
+        w.put(crc, 16);
+        if (best.empty() || w.bytes.size() < best.size()) best = std::move(w.bytes);
+    }
+    return best;
+}
+
+/** Write planar samples (one vector per channel, `bps` significant bits) as a FLAC file. */
+inline bool write_flac(const std::string& path, const std::vector<std::vector<int32_t>>& planar, int32_t rate,
+                       int32_t bps, const FlacEncodeOptions& options = {}) {
+    using namespace flac_detail;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr || planar.empty()) {
+        if (file != nullptr) fclose(file);
+        return false;
+    }
+    const size_t total = planar[0].size();
+    const auto channels = static_cast<int32_t>(planar.size());
+
+    if (options.id3_bytes >= 10) {
+        std::vector<uint8_t> tag(options.id3_bytes, 0);
+        const size_t body = options.id3_bytes - 10;
+        tag[0] = 'I'; tag[1] = 'D'; tag[2] = '3'; tag[3] = 4;
+        tag[6] = static_cast<uint8_t>((body >> 21) & 0x7f);
+        tag[7] = static_cast<uint8_t>((body >> 14) & 0x7f);
+        tag[8] = static_cast<uint8_t>((body >> 7) & 0x7f);
+        tag[9] = static_cast<uint8_t>(body & 0x7f);
+        fwrite(tag.data(), 1, tag.size(), file);
+    }
+    const long streaminfo_at = ftell(file) + 8;
+    uint8_t head[4 + 4 + 34 + 4 + 16] = {'f', 'L', 'a', 'C', 0x00, 0, 0, 34};
+    // A PADDING block after STREAMINFO, as most encoders leave one
+    head[42] = 0x81;
+    head[45] = 16;
+    fwrite(head, 1, sizeof(head), file);
+
+    uint32_t min_frame = ~0u;
+    uint32_t max_frame = 0;
+    uint64_t frame_number = 0;
+    for (size_t first = 0; first < total; first += options.block_size, ++frame_number) {
+        const auto n = static_cast<uint32_t>(std::min<size_t>(options.block_size, total - first));
+        const std::vector<uint8_t> frame = encode_flac_frame(planar, first, n, frame_number, rate, bps, options);
+        fwrite(frame.data(), 1, frame.size(), file);
+        min_frame = std::min(min_frame, static_cast<uint32_t>(frame.size()));
+        max_frame = std::max(max_frame, static_cast<uint32_t>(frame.size()));
+    }
+
+    FlacBitWriter si;
+    si.put(options.block_size, 16);
+    si.put(options.block_size, 16);
+    si.put(total > 0 ? min_frame : 0, 24);
+    si.put(max_frame, 24);
+    si.put(static_cast<uint32_t>(rate), 20);
+    si.put(static_cast<uint32_t>(channels - 1), 3);
+    si.put(static_cast<uint32_t>(bps - 1), 5);
+    const uint64_t frames = options.total_frames ? total : 0;
+    si.put(static_cast<uint32_t>(frames >> 32), 4);
+    si.put(static_cast<uint32_t>(frames), 32);
+    for (int i = 0; i < 4; ++i) si.put(0, 32);     // MD5 unknown
+    const bool ok = fseek(file, streaminfo_at, SEEK_SET) == 0 &&
+                    fwrite(si.bytes.data(), 1, si.bytes.size(), file) == si.bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,97 @@
+/**
+ * jni.h - Minimal host JNI for running the bridges on Linux
+ *
+ * Just enough of the JNI types and JNIEnv string calls for whisper_jni.cpp
+ * to compile and run in host tools. Strings hold modified UTF-8; local
+ * references stay alive until the tool calls clear_local_refs(), as they
+ * would until a native method returns to the VM. GetStringUTFChars hands
+ * out a heap copy, so a missing ReleaseStringUTFChars shows up as a leak
+ * under AddressSanitizer.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+typedef uint8_t jboolean;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef jint jsize;
+
+class _jobject {};
+
+class _jstring : public _jobject {
+public:
+    explicit _jstring(std::string text) : utf(std::move(text)) {}
+    std::string utf;
+};
+
+typedef _jobject* jobject;
+typedef _jstring* jstring;
+
+struct _JNIEnv {
+    jstring NewStringUTF(const char* utf) {
+        if (utf == nullptr) return nullptr;
+        locals.push_back(std::make_unique<_jstring>(utf));
+        return locals.back().get();
+    }
+
+    const char* GetStringUTFChars(jstring str, jboolean* is_copy) {
+        if (is_copy != nullptr) *is_copy = JNI_TRUE;
+        char* copy = static_cast<char*>(std::malloc(str->utf.size() + 1));
+        std::memcpy(copy, str->utf.c_str(), str->utf.size() + 1);
+        return copy;
+    }
+
+    void ReleaseStringUTFChars(jstring /* str */, const char* chars) {
+        std::free(const_cast<char*>(chars));
+    }
+
+    jsize GetStringUTFLength(jstring str) { return static_cast<jsize>(str->utf.size()); }
+
+    /** UTF-16 units: one per sequence, and modified UTF-8 spells supplementary characters as two. */
+    jsize GetStringLength(jstring str) {
+        jsize units = 0;
+        for (unsigned char c : str->utf) {
+            if ((c & 0xc0) != 0x80) ++units;
+        }
+        return units;
+    }
+
+    void GetStringUTFRegion(jstring str, jsize start, jsize len, char* buf) {
+        const std::string& utf = str->utf;
+        size_t begin = 0;
+        size_t end = 0;
+        jsize unit = 0;
+        for (size_t i = 0; i <= utf.size(); ++i) {
+            const bool boundary = i == utf.size() || (static_cast<unsigned char>(utf[i]) & 0xc0) != 0x80;
+            if (!boundary) continue;
+            if (unit == start) begin = i;
+            if (unit == start + len) {
+                end = i;
+                break;
+            }
+            ++unit;
+        }
+        std::memcpy(buf, utf.data() + begin, end - begin);
+    }
+
+    /** Drop the local references made since the last call, like a return to the VM. */
+    void clear_local_refs() { locals.clear(); }
+
+    std::vector<std::unique_ptr<_jstring>> locals;
+};
+
+typedef _JNIEnv JNIEnv;
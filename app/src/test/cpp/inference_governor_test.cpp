@@ -0,0 +1,200 @@
+/**
+ * inference_governor_test.cpp - sysfs parsing from stand-in files, levels, hysteresis, RTF stats
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "device_state.h"
+#include "inference_governor.h"
+
+using namespace assistant;
+
+namespace {
+    /** A fake /sys/class tree under the test temp dir. */
+    class SysfsTree {
+    public:
+        explicit SysfsTree(const std::string& name) : root_(::testing::TempDir() + name) {
+            mkdir(root_.c_str(), 0755);
+            mkdir((root_ + "/thermal").c_str(), 0755);
+            mkdir((root_ + "/power_supply").c_str(), 0755);
+        }
+
+        void zone(int index, const std::string& type, long long millicelsius) {
+            const std::string dir = root_ + "/thermal/thermal_zone" + std::to_string(index);
+            mkdir(dir.c_str(), 0755);
+            write(dir + "/type", type);
+            write(dir + "/temp", std::to_string(millicelsius));
+        }
+
+        void supply(const std::string& name, const std::string& file, const std::string& value) {
+            const std::string dir = root_ + "/power_supply/" + name;
+            mkdir(dir.c_str(), 0755);
+            write(dir + "/" + file, value);
+        }
+
+        const std::string& root() const { return root_; }
+
+    private:
+        static void write(const std::string& path, const std::string& value) {
+            FILE* file = fopen(path.c_str(), "w");
+            ASSERT_NE(file, nullptr);
+            fprintf(file, "%s\n", value.c_str());
+            fclose(file);
+        }
+
+        std::string root_;
+    };
+
+    DeviceState at(float celsius, int32_t battery_pct = 80, bool charging = false) {
+        DeviceState state;
+        state.max_celsius = celsius;
+        state.battery.present = true;
+        state.battery.capacity_pct = battery_pct;
+        state.battery.charging = charging;
+        return state;
+    }
+}
+
+TEST(DeviceSensors, ReadsStandInThermalAndBatteryFiles) {
+    SysfsTree tree("governor_sysfs");
+    tree.zone(0, "cpu-1-0-usr", 47500);
+    tree.zone(1, "skin-therm", 39000);
+    tree.zone(2, "pm8150b-ibat-lvl0", 4200);     // a current limit, not a temperature
+    tree.zone(3, "unused", -273000);
+    tree.supply("usb", "type", "USB");
+    tree.supply("battery", "type", "Battery");
+    tree.supply("battery", "capacity", "64");
+    tree.supply("battery", "status", "Discharging");
+    tree.supply("battery", "current_now", "-350000");
+    tree.supply("battery", "voltage_now", "3900000");
+    tree.supply("battery", "temp", "312");
+
+    const DeviceState state = DeviceSensors(tree.root()).read();
+    ASSERT_EQ(state.zones.size(), 2u);
+    EXPECT_EQ(state.zones[0].type, "cpu-1-0-usr");
+    EXPECT_FLOAT_EQ(state.max_celsius, 47.5f);
+    EXPECT_TRUE(state.battery.present);
+    EXPECT_EQ(state.battery.capacity_pct, 64);
+    EXPECT_FALSE(state.battery.charging);
+    ASSERT_TRUE(state.battery.has_power);
+    EXPECT_NEAR(state.battery.current_a, 0.35f, 1e-6f);
+    EXPECT_NEAR(state.battery.voltage_v, 3.9f, 1e-6f);
+    EXPECT_NEAR(state.battery.power_w(), 1.365f, 1e-4f);
+    EXPECT_NEAR(state.battery.celsius, 31.2f, 1e-4f);
+}
+
+TEST(DeviceSensors, MissingFilesStayUnknown) {
+    const DeviceState state = DeviceSensors(::testing::TempDir() + "no_such_sysfs").read();
+    EXPECT_TRUE(state.zones.empty());
+    EXPECT_EQ(state.max_celsius, 0.0f);
+    EXPECT_FALSE(state.battery.present);
+    EXPECT_EQ(state.battery.capacity_pct, -1);
+
+    // Unknown temperature keeps full settings
+    InferenceGovernor governor(DeviceSensors(::testing::TempDir() + "no_such_sysfs"));
+    const GovernorDecision decision = governor.decide();
+    EXPECT_EQ(decision.level, THERMAL_NOMINAL);
+    EXPECT_EQ(decision.n_threads, 4);
+}
+
+TEST(InferenceGovernor, RefreshesStaleReadingsOffTheRequestPath) {
+    SysfsTree tree("governor_refresh");
+    tree.zone(0, "cpu-1-0-usr", 35000);
+    GovernorPolicy policy;
+    policy.sample_interval_ms = 0;
+    InferenceGovernor governor(DeviceSensors(tree.root()), policy);
+    EXPECT_EQ(governor.decide().level, THERMAL_NOMINAL);
+
+    // The stale decision is returned at once; the governor's thread picks up the new reading
+    tree.zone(0, "cpu-1-0-usr", 52000);
+    GovernorDecision decision = governor.decide();
+    for (int i = 0; i < 200 && decision.level != THERMAL_HOT; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        decision = governor.decide();
+    }
+    EXPECT_EQ(decision.level, THERMAL_HOT);
+}
+
+TEST(InferenceGovernor, StepsDownAsTheDeviceHeatsUp) {
+    InferenceGovernor governor;
+    GovernorDecision decision = governor.update(at(35.0f));
+    EXPECT_EQ(decision.level, THERMAL_NOMINAL);
+    EXPECT_EQ(decision.n_threads, 4);
+    EXPECT_EQ(decision.model_tier, 0);
+
+    decision = governor.update(at(45.0f));
+    EXPECT_EQ(decision.level, THERMAL_WARM);
+    EXPECT_EQ(decision.n_threads, 3);
+
+    decision = governor.update(at(52.0f));
+    EXPECT_EQ(decision.level, THERMAL_HOT);
+    EXPECT_EQ(decision.n_threads, 2);
+    EXPECT_TRUE(decision.short_utterance);
+    EXPECT_LT(decision.audio_ctx.margin_seconds, AudioContextPolicy().margin_seconds);
+    EXPECT_EQ(decision.model_tier, 0);
+
+    // A jump straight past several thresholds lands on the right level
+    InferenceGovernor jumped;
+    decision = jumped.update(at(70.0f));
+    EXPECT_EQ(decision.level, THERMAL_CRITICAL);
+    EXPECT_EQ(decision.n_threads, 1);
+    EXPECT_EQ(decision.model_tier, 1);
+}
+
+TEST(InferenceGovernor, HysteresisKeepsTheLevelNearAThreshold) {
+    InferenceGovernor governor;
+    EXPECT_EQ(governor.update(at(51.0f)).level, THERMAL_HOT);
+    // Just under the hot threshold: stays hot until it is 3 C clear
+    EXPECT_EQ(governor.update(at(49.0f)).level, THERMAL_HOT);
+    EXPECT_EQ(governor.update(at(47.5f)).level, THERMAL_HOT);
+    EXPECT_EQ(governor.update(at(46.9f)).level, THERMAL_WARM);
+    EXPECT_EQ(governor.update(at(30.0f)).level, THERMAL_NOMINAL);
+}
+
+TEST(InferenceGovernor, LowBatteryWhileDischargingSavesPower) {
+    InferenceGovernor governor;
+    GovernorDecision decision = governor.update(at(35.0f, 15));
+    EXPECT_TRUE(decision.battery_saver);
+    EXPECT_EQ(decision.n_threads, 2);
+    EXPECT_TRUE(decision.short_utterance);
+    EXPECT_EQ(decision.model_tier, 0);
+
+    // Hot on a low battery: the smaller model too
+    EXPECT_EQ(governor.update(at(52.0f, 15)).model_tier, 1);
+
+    // Charging: no saver
+    decision = governor.update(at(35.0f, 15, true));
+    EXPECT_FALSE(decision.battery_saver);
+    EXPECT_EQ(decision.n_threads, 4);
+}
+
+TEST(InferenceGovernor, RecordsRealTimeFactorPerLevel) {
+    InferenceGovernor governor;
+    governor.set_max_threads(8);
+    const GovernorDecision cool = governor.update(at(30.0f));
+    EXPECT_EQ(cool.n_threads, 8);
+    const GovernorDecision hot = governor.update(at(55.0f));
+    governor.record(cool, 10.0, 2.0);
+    governor.record(cool, 10.0, 4.0);
+    governor.record(hot, 5.0, 4.0);
+    governor.record(hot, 0.0, 1.0);     // no audio: ignored
+
+    const LevelStats nominal = governor.level_stats(THERMAL_NOMINAL);
+    EXPECT_EQ(nominal.requests, 2u);
+    EXPECT_DOUBLE_EQ(nominal.mean_rtf(), 0.3);
+    EXPECT_DOUBLE_EQ(nominal.max_rtf, 0.4);
+    const LevelStats hot_stats = governor.level_stats(THERMAL_HOT);
+    EXPECT_EQ(hot_stats.requests, 1u);
+    EXPECT_DOUBLE_EQ(hot_stats.mean_rtf(), 0.8);
+
+    const std::string text = governor.format_stats();
+    EXPECT_NE(text.find("nominal"), std::string::npos);
+    EXPECT_NE(text.find("hot"), std::string::npos);
+}
@@ -0,0 +1,129 @@
+/**
+ * int8_kernels_test.cpp - SIMD kernels agree with the scalar reference
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "int8_kernels.h"
+
+using namespace assistant;
+
+namespace {
+    std::vector<int8_t> random_int8(size_t n, std::mt19937& rng) {
+        std::uniform_int_distribution<int> dist(-127, 127);
+        std::vector<int8_t> v(n);
+        for (int8_t& x : v) x = static_cast<int8_t>(dist(rng));
+        return v;
+    }
+}
+
+TEST(Int8Kernels, DotMatchesReferenceForAllLengths) {
+    std::mt19937 rng(7);
+    for (size_t n = 0; n <= 300; ++n) {
+        const auto a = random_int8(n, rng);
+        const auto b = random_int8(n, rng);
+        ASSERT_EQ(int8::dot(a.data(), b.data(), n), int8::dot_ref(a.data(), b.data(), n))
+            << "n=" << n << " kernels=" << int8::kernel_name();
+    }
+}
+
+TEST(Int8Kernels, DotHandlesExtremes) {
+    std::vector<int8_t> a(1024, -127), b(1024, -127);
+    EXPECT_EQ(int8::dot(a.data(), b.data(), a.size()), 1024 * 127 * 127);
+    std::fill(b.begin(), b.end(), 127);
+    EXPECT_EQ(int8::dot(a.data(), b.data(), a.size()), -1024 * 127 * 127);
+}
+
+TEST(Int8Kernels, RequantizeRoundsClampsAndRelu) {
+    const int32_t acc[] = {100, -100, 10000, -10000, 5};
+    const int32_t bias[] = {0, 0, 0, 0, 1};
+    int8_t out[5];
+    int8::requantize(acc, bias, 5, 0.5f, false, out);
+    EXPECT_EQ(out[0], 50);
+    EXPECT_EQ(out[1], -50);
+    EXPECT_EQ(out[2], 127);
+    EXPECT_EQ(out[3], -127);
+    EXPECT_EQ(out[4], 3);
+    int8::requantize(acc, nullptr, 5, 0.5f, true, out);
+    EXPECT_EQ(out[1], 0);
+    EXPECT_EQ(out[3], 0);
+}
+
+TEST(Int8Kernels, Conv2dMatchesNaive) {
+    std::mt19937 rng(11);
+    int8::ConvShape s{9, 7, 3, 0, 0, 5, 3, 2, 2, 1, 1, 0};
+    s.out_h = (s.in_h + 2 * s.pad_h - s.kernel_h) / s.stride_h + 1;
+    s.out_w = (s.in_w + 2 * s.pad_w - s.kernel_w) / s.stride_w + 1;
+
+    const auto in = random_int8(static_cast<size_t>(s.in_h) * s.in_w * s.in_c, rng);
+    const auto w = random_int8(static_cast<size_t>(s.out_c) * s.kernel_h * s.kernel_w * s.in_c, rng);
+    std::vector<int32_t> bias(s.out_c, 17);
+    std::vector<int8_t> out(static_cast<size_t>(s.out_h) * s.out_w * s.out_c);
+    std::vector<int8_t> patch(static_cast<size_t>(s.kernel_h) * s.kernel_w * s.in_c);
+    const float scale = 1.0f / 512.0f;
+    int8::conv2d(in.data(), s, w.data(), bias.data(), scale, false, out.data(), patch.data());
+
+    for (int32_t oy = 0; oy < s.out_h; ++oy) {
+        for (int32_t ox = 0; ox < s.out_w; ++ox) {
+            for (int32_t oc = 0; oc < s.out_c; ++oc) {
+                int32_t acc = 0;
+                for (int32_t ky = 0; ky < s.kernel_h; ++ky) {
+                    for (int32_t kx = 0; kx < s.kernel_w; ++kx) {
+                        const int32_t iy = oy * s.stride_h + ky - s.pad_h;
+                        const int32_t ix = ox * s.stride_w + kx - s.pad_w;
+                        if (iy < 0 || iy >= s.in_h || ix < 0 || ix >= s.in_w) continue;
+                        for (int32_t ic = 0; ic < s.in_c; ++ic) {
+                            acc += in[(iy * s.in_w + ix) * s.in_c + ic] *
+                                   w[((oc * s.kernel_h + ky) * s.kernel_w + kx) * s.in_c + ic];
+                        }
+                    }
+                }
+                int8_t expected;
+                int8::requantize(&acc, &bias[oc], 1, scale, false, &expected);
+                ASSERT_EQ(out[(oy * s.out_w + ox) * s.out_c + oc], expected)
+                    << oy << "," << ox << "," << oc;
+            }
+        }
+    }
+}
+
+TEST(Int8Kernels, DepthwiseMatchesNaive) {
+    std::mt19937 rng(13);
+    int8::ConvShape s{6, 5, 4, 6, 5, 4, 3, 3, 1, 1, 1, 1};
+    const auto in = random_int8(static_cast<size_t>(s.in_h) * s.in_w * s.in_c, rng);
+    const auto w = random_int8(static_cast<size_t>(s.kernel_h) * s.kernel_w * s.in_c, rng);
+    std::vector<int8_t> out(in.size());
+    std::vector<int32_t> acc(s.in_c);
+    const float scale = 1.0f / 256.0f;
+    int8::depthwise_conv2d(in.data(), s, w.data(), nullptr, scale, true, out.data(), acc.data());
+
+    for (int32_t oy = 0; oy < s.out_h; ++oy) {
+        for (int32_t ox = 0; ox < s.out_w; ++ox) {
+            for (int32_t c = 0; c < s.in_c; ++c) {
+                int32_t sum = 0;
+                for (int32_t ky = 0; ky < 3; ++ky) {
+                    for (int32_t kx = 0; kx < 3; ++kx) {
+                        const int32_t iy = oy + ky - 1, ix = ox + kx - 1;
+                        if (iy < 0 || iy >= s.in_h || ix < 0 || ix >= s.in_w) continue;
+                        sum += in[(iy * s.in_w + ix) * s.in_c + c] * w[(ky * 3 + kx) * s.in_c + c];
+                    }
+                }
+                int8_t expected;
+                int8::requantize(&sum, nullptr, 1, scale, true, &expected);
+                ASSERT_EQ(out[(oy * s.out_w + ox) * s.out_c + c], expected);
+            }
+        }
+    }
+}
+
+TEST(Int8Kernels, GlobalAveragePoolRounds) {
+    const int8_t in[] = {1, -4, 2, -4, 2, 5};   // 3 pixels x 2 channels
+    int8_t out[2];
+    int32_t acc[2];
+    int8::global_average_pool(in, 1, 3, 2, out, acc);
+    EXPECT_EQ(out[0], 2);     // 5 / 3
+    EXPECT_EQ(out[1], -1);    // -3 / 3
+}
@@ -0,0 +1,97 @@
+/**
+ * intent_classifier_test.cpp - Intent classification on short transcripts
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "intent_classifier.h"
+
+using namespace assistant;
+
+namespace {
+    const char* kExamples =
+        "open_app\topen the camera\n"
+        "open_app\tlaunch settings\n"
+        "open_app\tstart the calculator app\n"
+        "open_app\topen my gallery app\n"
+        "flashlight_on\tturn on the flashlight\n"
+        "flashlight_on\tflashlight on\n"
+        "flashlight_on\tturn the torch on\n"
+        "flashlight_on\tвключи фонарик\n"
+        "flashlight_off\tturn off the flashlight\n"
+        "flashlight_off\tflashlight off\n"
+        "flashlight_off\tturn the torch off\n"
+        "flashlight_off\tвыключи фонарик\n"
+        "none\twhat is the capital of france\n"
+        "none\thow do i cook rice\n"
+        "none\twhy is the sky blue\n"
+        "none\texplain how a flashlight works\n"
+        "none\twrite a poem about the sea\n"
+        "none\twhat is the weather tomorrow\n";
+
+    IntentClassifier trained() {
+        std::vector<CommandPhrase> examples;
+        EXPECT_TRUE(parse_command_spec(kExamples, examples));
+        IntentClassifier classifier;
+        EXPECT_TRUE(classifier.train(examples));
+        return classifier;
+    }
+
+    std::string top(const IntentClassifier& classifier, const char* text) {
+        const IntentScore score = classifier.classify(text);
+        return score.intent >= 0 ? classifier.intent_name(score.intent) : "";
+    }
+}
+
+TEST(IntentClassifier, IdsFollowSpecOrder) {
+    const IntentClassifier classifier = trained();
+    ASSERT_EQ(classifier.intents(), 4u);
+    EXPECT_EQ(classifier.intent_id("open_app"), 0);
+    EXPECT_EQ(classifier.intent_id("none"), 3);
+    EXPECT_EQ(classifier.intent_id("missing"), -1);
+}
+
+TEST(IntentClassifier, ClassifiesParaphrases) {
+    const IntentClassifier classifier = trained();
+    EXPECT_EQ(top(classifier, "Could you turn on the torch?"), "flashlight_on");
+    EXPECT_EQ(top(classifier, "please switch the flashlight off"), "flashlight_off");
+    EXPECT_EQ(top(classifier, "Включи, пожалуйста, фонарик"), "flashlight_on");
+    EXPECT_EQ(top(classifier, "open the calculator"), "open_app");
+    EXPECT_EQ(top(classifier, "what is the tallest mountain"), "none");
+    // Shares "flashlight" with the actions, but the question words win
+    EXPECT_EQ(top(classifier, "how does a flashlight work"), "none");
+}
+
+TEST(IntentClassifier, ConfidenceSeparatesClearAndVagueText) {
+    const IntentClassifier classifier = trained();
+    const IntentScore clear = classifier.classify("turn on the flashlight");
+    EXPECT_GT(clear.probability, 0.9f);
+    EXPECT_GT(clear.margin, 2.0f);
+
+    const IntentScore vague = classifier.classify("the");
+    EXPECT_LT(vague.probability, clear.probability);
+
+    // No word was seen in training: no decision at all
+    const IntentScore unknown = classifier.classify("zebra quantum");
+    EXPECT_EQ(unknown.intent, -1);
+    EXPECT_EQ(unknown.features, 0);
+}
+
+TEST(IntentClassifier, FeaturesAreCaseInsensitiveAndOrderSensitive) {
+    uint32_t a[16], b[16], c[16];
+    ASSERT_EQ(intent_features("Turn ON", a, 16), 3u);     // two words and one bigram
+    ASSERT_EQ(intent_features("turn on!", b, 16), 3u);
+    ASSERT_EQ(intent_features("on turn", c, 16), 3u);
+    EXPECT_EQ(std::vector<uint32_t>(a, a + 3), std::vector<uint32_t>(b, b + 3));
+    EXPECT_NE(a[2], c[2]);
+    EXPECT_EQ(intent_features("one two three", a, 2), 2u);
+}
+
+TEST(IntentClassifier, NeedsTwoIntents) {
+    IntentClassifier classifier;
+    EXPECT_FALSE(classifier.train({{"only", "one intent"}}));
+    EXPECT_EQ(classifier.classify("one intent").intent, -1);
+}
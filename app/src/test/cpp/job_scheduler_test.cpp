@@ -0,0 +1,296 @@
+/**
+ * job_scheduler_test.cpp - Priorities, preemption at step boundaries, metrics
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "job_scheduler.h"
+#include "wav_io.h"
+
+using namespace assistant;
+
+namespace {
+    /** Appends "<name><step>" to a shared log for each step; optionally sleeps per step. */
+    class LoggingJob : public StepJob {
+    public:
+        LoggingJob(std::string name, int steps, std::vector<std::string>& log, std::mutex& mutex,
+                   std::chrono::milliseconds step_time = std::chrono::milliseconds(0))
+            : name_(std::move(name)), steps_(steps), log_(log), mutex_(mutex), step_time_(step_time) {}
+
+        bool step() override {
+            if (step_time_.count() > 0) std::this_thread::sleep_for(step_time_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            log_.push_back(name_ + std::to_string(done_));
+            return ++done_ >= steps_;
+        }
+
+        void cancelled() override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            log_.push_back(name_ + "x");
+        }
+
+    private:
+        std::string name_;
+        int steps_;
+        int done_ = 0;
+        std::vector<std::string>& log_;
+        std::mutex& mutex_;
+        std::chrono::milliseconds step_time_;
+    };
+
+    /** Blocks its first step until released, to pin the engine thread. */
+    class GateJob : public StepJob {
+    public:
+        bool step() override {
+            entered = true;
+            while (!release) std::this_thread::yield();
+            return true;
+        }
+        std::atomic<bool> entered{false};
+        std::atomic<bool> release{false};
+    };
+
+    /** Reads a WAV one window per step, like the whisper file job. */
+    class WindowedWavJob : public StepJob {
+    public:
+        WindowedWavJob(std::string path, size_t window, std::vector<float>& out)
+            : path_(std::move(path)), window_(window), out_(out) {
+            read_wav_info(path_.c_str(), info_);
+        }
+
+        bool step() override {
+            std::vector<float> buffer(window_);
+            const size_t n = read_wav_frames_float(path_.c_str(), info_, next_, window_, buffer.data());
+            out_.insert(out_.end(), buffer.begin(), buffer.begin() + static_cast<long>(n));
+            next_ += n;
+            return n < window_;
+        }
+
+    private:
+        std::string path_;
+        WavInfo info_;
+        size_t window_;
+        size_t next_ = 0;
+        std::vector<float>& out_;
+    };
+
+    void wait_for(const std::atomic<bool>& flag) {
+        while (!flag) std::this_thread::yield();
+    }
+}
+
+TEST(JobScheduler, RunsBackgroundJobsInOrder) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("a", 2, log, mutex));
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("b", 2, log, mutex));
+    scheduler.wait_idle();
+    EXPECT_EQ(log, (std::vector<std::string>{"a0", "a1", "b0", "b1"}));
+
+    const SchedulerStats stats = scheduler.stats();
+    EXPECT_EQ(stats.background.completed, 2u);
+    EXPECT_EQ(stats.background.steps, 4u);
+    EXPECT_EQ(stats.background.queue_depth, 0u);
+    EXPECT_EQ(stats.preemptions, 0u);
+}
+
+TEST(JobScheduler, InteractiveJobPreemptsAtStepBoundary) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    auto* gate = new GateJob();
+    scheduler.submit(JOB_BACKGROUND, std::unique_ptr<StepJob>(gate));
+    wait_for(gate->entered);
+
+    // Background job queued behind the gate, then a voice query arrives
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("bg", 3, log, mutex));
+    scheduler.submit(JOB_INTERACTIVE, std::make_unique<LoggingJob>("fg", 2, log, mutex));
+    EXPECT_TRUE(scheduler.preempt_requested());
+    EXPECT_EQ(scheduler.stats().background.queue_depth, 2u);
+    gate->release = true;
+    scheduler.wait_idle();
+
+    EXPECT_EQ(log, (std::vector<std::string>{"fg0", "fg1", "bg0", "bg1", "bg2"}));
+    EXPECT_FALSE(scheduler.preempt_requested());
+}
+
+TEST(JobScheduler, PausedBackgroundJobResumesWhereItStopped) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("bg", 6, log, mutex, std::chrono::milliseconds(10)));
+    while (scheduler.stats().background.steps < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    scheduler.submit(JOB_INTERACTIVE, std::make_unique<LoggingJob>("fg", 1, log, mutex));
+    scheduler.wait_idle();
+
+    // The interactive job ran between two background steps, and no step was lost or repeated
+    ASSERT_EQ(log.size(), 7u);
+    const auto fg = std::find(log.begin(), log.end(), "fg0");
+    ASSERT_NE(fg, log.end());
+    EXPECT_GT(fg - log.begin(), 1);
+    EXPECT_LT(fg - log.begin(), 6);
+    log.erase(fg);
+    EXPECT_EQ(log, (std::vector<std::string>{"bg0", "bg1", "bg2", "bg3", "bg4", "bg5"}));
+
+    const SchedulerStats stats = scheduler.stats();
+    EXPECT_EQ(stats.preemptions, 1u);
+    EXPECT_GT(stats.paused_us_total, 0u);
+    EXPECT_EQ(stats.interactive.completed, 1u);
+}
+
+TEST(JobScheduler, InteractiveTurnHoldsTheEngine) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    auto* gate = new GateJob();
+    scheduler.submit(JOB_BACKGROUND, std::unique_ptr<StepJob>(gate));
+    wait_for(gate->entered);
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("bg", 2, log, mutex));
+
+    std::atomic<bool> got_turn{false};
+    std::thread caller([&] {
+        JobScheduler::InteractiveTurn turn(scheduler);
+        got_turn = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::lock_guard<std::mutex> lock(mutex);
+        log.push_back("turn");
+    });
+
+    // The turn waits for the step in flight, and asks it to wrap up
+    while (!scheduler.preempt_requested()) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_FALSE(got_turn);
+    EXPECT_EQ(scheduler.stats().interactive.queue_depth, 1u);
+    gate->release = true;
+    caller.join();
+    scheduler.wait_idle();
+
+    // No background step ran while the turn was held
+    EXPECT_EQ(log, (std::vector<std::string>{"turn", "bg0", "bg1"}));
+    const SchedulerStats stats = scheduler.stats();
+    EXPECT_EQ(stats.interactive.started, 1u);
+    EXPECT_GE(stats.interactive.wait_us_max, 5000u);
+}
+
+TEST(JobScheduler, CancelsQueuedAndRunningJobs) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    auto* gate = new GateJob();
+    const uint64_t gate_id = scheduler.submit(JOB_BACKGROUND, std::unique_ptr<StepJob>(gate));
+    wait_for(gate->entered);
+    const uint64_t queued = scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("q", 2, log, mutex));
+    const uint64_t running = scheduler.submit(JOB_BACKGROUND,
+        std::make_unique<LoggingJob>("r", 100, log, mutex, std::chrono::milliseconds(2)));
+
+    EXPECT_TRUE(scheduler.cancel(queued));
+    EXPECT_FALSE(scheduler.cancel(queued));
+    gate->release = true;
+    while (scheduler.stats().background.steps < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_TRUE(scheduler.cancel(running));
+    scheduler.wait_idle();
+    EXPECT_FALSE(scheduler.cancel(gate_id));
+
+    ASSERT_GE(log.size(), 3u);
+    EXPECT_EQ(log.front(), "qx");
+    EXPECT_EQ(log.back(), "rx");
+    EXPECT_LT(log.size(), 50u);
+
+    const SchedulerStats stats = scheduler.stats();
+    EXPECT_EQ(stats.background.cancelled, 2u);
+    EXPECT_EQ(stats.background.completed, 1u);
+}
+
+TEST(JobScheduler, CancelAllWaitsForCallbacksRunningElsewhere) {
+    // A paused job whose cancellation takes a while to release what it holds
+    class SlowCancelJob : public StepJob {
+    public:
+        SlowCancelJob(std::atomic<bool>& entered, std::atomic<bool>& release, std::atomic<bool>& released)
+            : entered_(entered), release_(release), released_(released) {}
+        bool step() override { return false; }
+        void cancelled() override {
+            entered_ = true;
+            while (!release_) std::this_thread::yield();
+            released_ = true;
+        }
+
+    private:
+        std::atomic<bool>& entered_;
+        std::atomic<bool>& release_;
+        std::atomic<bool>& released_;
+    };
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> released{false};
+    std::atomic<bool> returned{false};
+    JobScheduler scheduler;
+    JobScheduler::InteractiveTurn turn(scheduler);
+    const uint64_t id = scheduler.submit(JOB_BACKGROUND, std::make_unique<SlowCancelJob>(entered, release, released));
+    std::thread canceller([&] { scheduler.cancel(id); });
+    wait_for(entered);
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_FALSE(returned.load());
+        release = true;
+    });
+    scheduler.cancel_all();
+    returned = true;
+    EXPECT_TRUE(released.load());
+    canceller.join();
+    releaser.join();
+}
+
+TEST(JobScheduler, TracksQueueDepthAndWaitTime) {
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    for (int i = 0; i < 4; ++i) {
+        scheduler.submit(JOB_BACKGROUND, std::make_unique<LoggingJob>("j", 1, log, mutex, std::chrono::milliseconds(5)));
+    }
+    scheduler.wait_idle();
+    const SchedulerStats stats = scheduler.stats();
+    EXPECT_GE(stats.background.max_queue_depth, 3u);
+    EXPECT_EQ(stats.background.started, 4u);
+    // The last job waited for the three before it
+    EXPECT_GE(stats.background.wait_us_max, 10000u);
+    EXPECT_LE(stats.background.mean_wait_us(), stats.background.wait_us_max);
+}
+
+TEST(JobScheduler, WindowedFileJobMatchesWholeFileRead) {
+    const std::string path = ::testing::TempDir() + "job_scheduler_windows.wav";
+    std::vector<int16_t> pcm(16000 * 2 + 123);
+    for (size_t i = 0; i < pcm.size(); ++i) pcm[i] = static_cast<int16_t>((i * 53) % 4000 - 2000);
+    ASSERT_TRUE(write_wav_mono16(path, pcm.data(), pcm.size(), 16000));
+
+    WavInfo info;
+    ASSERT_TRUE(read_wav_info(path.c_str(), info));
+    EXPECT_EQ(info.sample_rate, 16000);
+
+    JobScheduler scheduler;
+    std::vector<std::string> log;
+    std::mutex mutex;
+    std::vector<float> windows;
+    scheduler.submit(JOB_BACKGROUND, std::make_unique<WindowedWavJob>(path, 4000, windows));
+    scheduler.submit(JOB_INTERACTIVE, std::make_unique<LoggingJob>("fg", 1, log, mutex));
+    scheduler.wait_idle();
+
+    Arena arena(1024);
+    float* whole = nullptr;
+    size_t n = 0;
+    ASSERT_TRUE(read_wav_mono_float(path.c_str(), arena, &whole, &n));
+    ASSERT_EQ(windows.size(), n);
+    EXPECT_TRUE(std::equal(windows.begin(), windows.end(), whole));
+    EXPECT_EQ(read_wav_frames_float(path.c_str(), info, n, 100, whole), 0u);
+}
@@ -0,0 +1,133 @@
+/**
+ * kws_eval.cpp - False accept / false reject harness for wake word models
+ *
+ * Streams every clip in a manifest through a fresh WakeWordDetector and
+ * reports the false reject rate over positive clips and false accepts per
+ * hour over negative audio. Exits non-zero when either exceeds its limit,
+ * so it can gate a model change in CI.
+ *
+ * Manifest: one "path<TAB>label" per line, paths relative to the manifest,
+ * label 1 for clips containing the keyword once and 0 for clips that must
+ * not trigger. Lines starting with '#' are ignored.
+ *
+ * Usage: kws_eval <model.kws> <manifest.tsv> [--threshold T]
+ *                 [--max-fa-per-hour N] [--max-frr R] [--verbose]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "wake_word.h"
+#include "wav_io.h"
+
+using namespace assistant;
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <model.kws> <manifest.tsv> [--threshold T] "
+                        "[--max-fa-per-hour N] [--max-frr R] [--verbose]\n", argv[0]);
+        return 2;
+    }
+    const std::string model_path = argv[1];
+    const std::string manifest_path = argv[2];
+    WakeWordConfig config;
+    double max_fa_per_hour = 1.0;
+    double max_frr = 0.05;
+    bool verbose = false;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) config.threshold = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--max-fa-per-hour") == 0 && i + 1 < argc) max_fa_per_hour = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-frr") == 0 && i + 1 < argc) max_frr = atof(argv[++i]);
+        else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+    }
+
+    KwsModel model;
+    if (!model.load(model_path)) {
+        fprintf(stderr, "cannot load model %s\n", model_path.c_str());
+        return 1;
+    }
+
+    FILE* manifest = fopen(manifest_path.c_str(), "r");
+    if (manifest == nullptr) {
+        fprintf(stderr, "cannot open manifest %s\n", manifest_path.c_str());
+        return 1;
+    }
+    const size_t slash = manifest_path.find_last_of('/');
+    const std::string base = slash == std::string::npos ? "" : manifest_path.substr(0, slash + 1);
+
+    int positives = 0, misses = 0, negatives = 0, false_accepts = 0;
+    double negative_seconds = 0.0, total_seconds = 0.0;
+    uint64_t inferences = 0, gated = 0, inference_ns = 0;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), manifest) != nullptr) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char* tab = strchr(line, '\t');
+        if (tab == nullptr) continue;
+        *tab = '\0';
+        const int label = atoi(tab + 1);
+        const std::string path = line[0] == '/' ? std::string(line) : base + line;
+
+        std::vector<int16_t> pcm;
+        int32_t sample_rate = 0;
+        if (!read_wav_mono16(path, pcm, &sample_rate) || sample_rate != model.features.sample_rate) {
+            fprintf(stderr, "skipping %s: need 16-bit PCM at %d Hz\n", path.c_str(),
+                    model.features.sample_rate);
+            continue;
+        }
+
+        WakeWordDetector detector;
+        if (!detector.init(model, config)) return 1;
+        int32_t detections = 0;
+        for (size_t i = 0; i < pcm.size(); i += 320) {
+            detections += detector.process(pcm.data() + i, std::min<size_t>(320, pcm.size() - i));
+        }
+
+        const double seconds = static_cast<double>(pcm.size()) / sample_rate;
+        total_seconds += seconds;
+        inferences += detector.stats().inferences;
+        gated += detector.stats().gated;
+        inference_ns += detector.stats().inference_ns;
+
+        if (label != 0) {
+            positives++;
+            // Extra triggers on a positive clip count as false accepts
+            if (detections == 0) misses++;
+            else false_accepts += detections - 1;
+        } else {
+            negatives++;
+            negative_seconds += seconds;
+            false_accepts += detections;
+        }
+        if (verbose || (label != 0 && detections != 1) || (label == 0 && detections > 0)) {
+            printf("%-40s label=%d detections=%d\n", line, label, detections);
+        }
+    }
+    fclose(manifest);
+
+    const double frr = positives > 0 ? static_cast<double>(misses) / positives : 0.0;
+    const double fa_per_hour = negative_seconds > 0.0 ? false_accepts * 3600.0 / negative_seconds : 0.0;
+    const double us_per_inference = inferences > 0 ? inference_ns / 1000.0 / inferences : 0.0;
+    const double cpu_percent = total_seconds > 0.0 ? inference_ns / 1e9 / total_seconds * 100.0 : 0.0;
+
+    printf("positives: %d, missed: %d, FRR: %.2f%%\n", positives, misses, frr * 100.0);
+    printf("negatives: %d (%.1f min), false accepts: %d, FA/hour: %.2f\n",
+           negatives, negative_seconds / 60.0, false_accepts, fa_per_hour);
+    printf("inference: %.1f us avg, %llu run, %llu gated, network CPU %.3f%% of real time\n",
+           us_per_inference, static_cast<unsigned long long>(inferences),
+           static_cast<unsigned long long>(gated), cpu_percent);
+
+    if (positives == 0 && negatives == 0) {
+        fprintf(stderr, "no usable clips in manifest\n");
+        return 1;
+    }
+    if (frr > max_frr || fa_per_hour > max_fa_per_hour) {
+        fprintf(stderr, "FAIL: FRR limit %.2f%%, FA/hour limit %.2f\n", max_frr * 100.0, max_fa_per_hour);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * kws_make_fixtures.cpp - Generate a synthetic wake word evaluation set
+ *
+ * Writes the tone model (tone.kws), positive clips (tone bursts in noise at
+ * several levels), negative clips (noise, silence, other tones, chirps) and
+ * a manifest.tsv in the format read by kws_eval.
+ *
+ * Usage: kws_make_fixtures <output_dir>
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kws_test_models.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+
+    void append_chirp(std::vector<int16_t>& pcm, float f0, float f1, float amplitude, int32_t ms) {
+        const size_t n = static_cast<size_t>(kRate) * ms / 1000;
+        float phase = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            const float hz = f0 + (f1 - f0) * static_cast<float>(i) / static_cast<float>(n);
+            phase += 2.0f * static_cast<float>(M_PI) * hz / kRate;
+            pcm.push_back(static_cast<int16_t>(amplitude * std::sin(phase) * 32767.0f));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output_dir>\n", argv[0]);
+        return 2;
+    }
+    const std::string dir = argv[1];
+
+    const std::vector<uint8_t> model = make_tone_model().serialize();
+    FILE* file = fopen((dir + "/tone.kws").c_str(), "wb");
+    if (file == nullptr || fwrite(model.data(), 1, model.size(), file) != model.size()) {
+        fprintf(stderr, "cannot write %s/tone.kws\n", dir.c_str());
+        return 1;
+    }
+    fclose(file);
+
+    FILE* manifest = fopen((dir + "/manifest.tsv").c_str(), "w");
+    if (manifest == nullptr) return 1;
+    fprintf(manifest, "# path\tlabel (1 = contains the keyword once, 0 = must not trigger)\n");
+
+    std::mt19937 rng(1234);
+    int clip = 0;
+    auto emit = [&](const std::vector<int16_t>& pcm, int label) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s_%03d.wav", label ? "pos" : "neg", clip++);
+        if (!write_wav_mono16(dir + "/" + name, pcm.data(), pcm.size(), kRate)) return false;
+        fprintf(manifest, "%s\t%d\n", name, label);
+        return true;
+    };
+
+    const float noise_levels[] = {0.003f, 0.01f, 0.02f};
+    const float tone_levels[] = {0.1f, 0.3f};
+    for (float noise : noise_levels) {
+        for (float tone : tone_levels) {
+            for (int rep = 0; rep < 3; ++rep) {
+                std::vector<int16_t> pcm;
+                append_noise(pcm, kRate, noise, 700 + 300 * rep, rng);
+                std::vector<int16_t> burst;
+                append_tone(burst, kRate, kToneHz, tone, 800 + 100 * rep);
+                const size_t at = pcm.size();
+                append_noise(pcm, kRate, noise, static_cast<int32_t>(burst.size() * 1000 / kRate) + 1500, rng);
+                mix_into(pcm, burst, at);
+                if (!emit(pcm, 1)) return 1;
+            }
+        }
+    }
+
+    for (int rep = 0; rep < 4; ++rep) {
+        std::vector<int16_t> pcm;
+        append_noise(pcm, kRate, 0.02f + 0.03f * rep, 30000, rng);
+        if (!emit(pcm, 0)) return 1;
+    }
+    {
+        std::vector<int16_t> pcm;
+        append_silence(pcm, kRate, 30000);
+        if (!emit(pcm, 0)) return 1;
+    }
+    const float distractors[] = {250.0f, 600.0f, 2000.0f, 3000.0f};
+    for (float hz : distractors) {
+        std::vector<int16_t> pcm;
+        append_noise(pcm, kRate, 0.01f, 10000, rng);
+        std::vector<int16_t> burst;
+        for (int i = 0; i < 5; ++i) {
+            append_tone(burst, kRate, hz, 0.3f, 800);
+            append_silence(burst, kRate, 1000);
+        }
+        mix_into(pcm, burst, kRate);
+        if (!emit(pcm, 0)) return 1;
+    }
+    for (int rep = 0; rep < 3; ++rep) {
+        std::vector<int16_t> pcm;
+        append_noise(pcm, kRate, 0.01f, 500, rng);
+        for (int i = 0; i < 10; ++i) append_chirp(pcm, 200.0f, 3800.0f, 0.2f, 400 + 200 * rep);
+        if (!emit(pcm, 0)) return 1;
+    }
+
+    fclose(manifest);
+    printf("wrote %d clips to %s\n", clip, dir.c_str());
+    return 0;
+}
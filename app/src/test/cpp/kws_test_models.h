@@ -0,0 +1,164 @@
+/**
+ * kws_test_models.h - Synthetic keyword spotting models and audio for host tests
+ *
+ * The "tone" model is a hand-built network that fires on a sustained
+ * 1 kHz tone, which gives the detector, the FA/FR harness and the JNI-free
+ * tests a keyword with a known answer. The DS-CNN model has random weights
+ * and the shape of the small DS-CNN from the keyword spotting literature;
+ * it is only used to measure inference cost.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "audio_features.h"
+#include "test_audio.h"
+#include "wake_word.h"
+
+namespace assistant {
+namespace testing {
+
+constexpr float kToneHz = 1000.0f;
+
+/** Mel bin that responds most strongly to a pure tone at `hz`. */
+inline int32_t tone_mel_bin(const FeatureConfig& config, float hz) {
+    FeatureFrontend frontend(config);
+    std::vector<int16_t> pcm;
+    append_tone(pcm, config.sample_rate, hz, 0.3f, 100);
+    std::vector<float> last(frontend.feature_dim());
+    frontend.push(pcm.data(), pcm.size(), [&](const float* features, float) {
+        std::copy(features, features + last.size(), last.begin());
+    });
+    return static_cast<int32_t>(std::max_element(last.begin(), last.end()) - last.begin());
+}
+
+/**
+ * 1 s of log-mel frames -> per-frame conv contrasting the tone bin against
+ * the rest -> ReLU -> average pool -> FC(2). Class 1 is the keyword.
+ */
+inline KwsModel make_tone_model() {
+    KwsModel model;
+    model.features.n_mfcc = 0;
+    model.features.n_mels = 40;
+    model.input_frames = 50;
+    model.input_dim = 40;
+    model.n_classes = 2;
+    model.keyword_class = 1;
+    model.input_scale = 0.125f;
+
+    const int32_t bin = tone_mel_bin(model.features, kToneHz);
+    const float conv_w_scale = 1.0f / 39.0f;
+    const float conv_acc_scale = model.input_scale * conv_w_scale;
+
+    // Channel 0: tone bin minus the mean of the others, offset so ordinary
+    // spectra stay below zero. Channel 1: constant filler evidence.
+    KwsLayer conv;
+    conv.type = KWS_LAYER_CONV;
+    conv.out_c = 2;
+    conv.kernel_h = 1;
+    conv.kernel_w = model.input_dim;
+    conv.relu = true;
+    conv.weight_scale = conv_w_scale;
+    conv.out_scale = 0.25f;
+    conv.weights.assign(2 * model.input_dim, 0);
+    for (int32_t i = 0; i < model.input_dim; ++i) conv.weights[i] = i == bin ? 39 : -1;
+    conv.bias = {static_cast<int32_t>(std::lround(-3.0f / conv_acc_scale)),
+                 static_cast<int32_t>(std::lround(2.0f / conv_acc_scale))};
+    model.layers.push_back(conv);
+
+    KwsLayer pool;
+    pool.type = KWS_LAYER_AVGPOOL;
+    pool.out_c = 2;
+    model.layers.push_back(pool);
+
+    // logit_filler = 2 * ch1 = 4, logit_keyword = 2 * ch0
+    KwsLayer fc;
+    fc.type = KWS_LAYER_FC;
+    fc.out_c = 2;
+    fc.relu = false;
+    fc.weight_scale = 1.0f / 16.0f;
+    fc.weights = {0, 32,
+                  32, 0};
+    model.layers.push_back(fc);
+    return model;
+}
+
+/** DS-CNN (small) topology on 49 x 10 MFCCs with random weights. */
+inline KwsModel make_ds_cnn_model(uint32_t seed = 1, int32_t channels = 64, int32_t blocks = 4) {
+    KwsModel model;
+    model.features.frame_ms = 40;
+    model.features.hop_ms = 20;
+    model.features.n_mels = 40;
+    model.features.n_mfcc = 10;
+    model.input_frames = 49;
+    model.input_dim = 10;
+    model.n_classes = 12;
+    model.keyword_class = 2;
+    model.input_scale = 0.25f;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> weight(-127, 127);
+    std::uniform_int_distribution<int> bias(-1000, 1000);
+
+    float in_scale = model.input_scale;
+    int32_t in_c = 1;
+    auto add = [&](KwsLayer layer, int32_t fan_in, size_t n_weights) {
+        layer.weight_scale = 1.0f / 127.0f;
+        // Keep roughly unit-variance activations so the benchmark exercises real values
+        layer.out_scale = in_scale * layer.weight_scale * std::sqrt(static_cast<float>(fan_in)) * 73.0f / 40.0f;
+        layer.weights.resize(n_weights);
+        for (int8_t& w : layer.weights) w = static_cast<int8_t>(weight(rng));
+        layer.bias.resize(layer.out_c);
+        for (int32_t& b : layer.bias) b = bias(rng);
+        in_scale = layer.out_scale;
+        model.layers.push_back(std::move(layer));
+    };
+
+    KwsLayer conv;
+    conv.type = KWS_LAYER_CONV;
+    conv.out_c = channels;
+    conv.kernel_h = 10;
+    conv.kernel_w = 4;
+    conv.stride_h = 2;
+    conv.stride_w = 2;
+    conv.pad_h = 5;
+    conv.pad_w = 1;
+    add(conv, 10 * 4 * in_c, static_cast<size_t>(channels) * 10 * 4 * in_c);
+    in_c = channels;
+
+    for (int32_t b = 0; b < blocks; ++b) {
+        KwsLayer dw;
+        dw.type = KWS_LAYER_DEPTHWISE;
+        dw.out_c = channels;
+        dw.kernel_h = 3;
+        dw.kernel_w = 3;
+        dw.pad_h = 1;
+        dw.pad_w = 1;
+        add(dw, 9, static_cast<size_t>(9) * channels);
+
+        KwsLayer pw;
+        pw.type = KWS_LAYER_POINTWISE;
+        pw.out_c = channels;
+        add(pw, channels, static_cast<size_t>(channels) * channels);
+    }
+
+    KwsLayer pool;
+    pool.type = KWS_LAYER_AVGPOOL;
+    pool.out_c = channels;
+    model.layers.push_back(pool);
+
+    KwsLayer fc;
+    fc.type = KWS_LAYER_FC;
+    fc.out_c = model.n_classes;
+    fc.relu = false;
+    add(fc, channels, static_cast<size_t>(model.n_classes) * channels);
+    return model;
+}
+
+} // namespace testing
+} // namespace assistant
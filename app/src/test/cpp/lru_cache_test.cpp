@@ -0,0 +1,70 @@
+/**
+ * lru_cache_test.cpp - Eviction order and ownership of the LRU cache
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "lru_cache.h"
+
+using namespace assistant;
+
+namespace {
+    /** Counts live instances so the test can see when entries are destroyed. */
+    struct Tracked {
+        explicit Tracked(int* live) : live_(live) { ++*live_; }
+        ~Tracked() { --*live_; }
+        int* live_;
+    };
+}
+
+TEST(LruCache, EvictsLeastRecentlyUsed) {
+    LruCache<int, int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    ASSERT_NE(cache.find(1), nullptr);      // 1 becomes most recent
+    cache.insert(3, 30);                    // evicts 2
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(2), nullptr);
+    ASSERT_NE(cache.find(1), nullptr);
+    EXPECT_EQ(*cache.find(1), 10);
+    EXPECT_EQ(*cache.find(3), 30);
+    EXPECT_EQ(*cache.front_key(), 3);
+}
+
+TEST(LruCache, ReplacesExistingKey) {
+    LruCache<int, int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(1, 11);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(*cache.front(), 11);
+    EXPECT_TRUE(cache.erase(2));
+    EXPECT_FALSE(cache.erase(2));
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(LruCache, DestroysEvictedValues) {
+    int live = 0;
+    {
+        LruCache<uint64_t, std::unique_ptr<Tracked>> cache(3);
+        for (uint64_t key = 0; key < 5; ++key) cache.insert(key, std::unique_ptr<Tracked>(new Tracked(&live)));
+        EXPECT_EQ(live, 3);
+        cache.set_capacity(1);
+        EXPECT_EQ(live, 1);
+        EXPECT_NE(cache.find(4), nullptr);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST(LruCache, HashDistinguishesClips) {
+    std::vector<float> a(16000, 0.1f);
+    std::vector<float> b = a;
+    b[8000] = 0.2f;
+    EXPECT_EQ(fnv1a64(a.data(), a.size() * sizeof(float)), fnv1a64(a.data(), a.size() * sizeof(float)));
+    EXPECT_NE(fnv1a64(a.data(), a.size() * sizeof(float)), fnv1a64(b.data(), b.size() * sizeof(float)));
+}
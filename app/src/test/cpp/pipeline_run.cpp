@@ -0,0 +1,83 @@
+/**
+ * pipeline_run.cpp - Run a WAV file through a voice pipeline spec
+ *
+ * Prints the events the stages emit and the per-stage timing table, so a
+ * spec can be tried on recorded captures on the host before it ships.
+ *
+ * Usage: pipeline_run <input.wav> "<spec>" [--frame-ms N] [--trace out.json]
+ *   e.g. pipeline_run clip.wav "highpass | vad hangover_ms=700 | wav path=out.wav"
+ *
+ * --trace (or ASSISTANT_TRACE=out.json) records a section per stage and
+ * frame as Chrome trace JSON for Perfetto UI.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+#include "voice_pipeline.h"
+
+using namespace assistant;
+
+namespace {
+    const char* event_name(PipelineEventType type) {
+        switch (type) {
+            case PIPELINE_SPEECH_START: return "speech_start";
+            case PIPELINE_SPEECH_END: return "speech_end";
+            case PIPELINE_NO_SPEECH: return "no_speech";
+            case PIPELINE_RESULT: return "result";
+        }
+        return "?";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <input.wav> \"<spec>\" [--frame-ms N] [--trace out.json]\n", argv[0]);
+        return 2;
+    }
+    PipelineOptions options;
+    const char* trace_path = nullptr;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--frame-ms") == 0 && i + 1 < argc) options.frame_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) trace_path = argv[++i];
+    }
+    if (trace_path != nullptr) {
+        trace_start(trace_path);
+    } else {
+        trace_start_from_env();
+    }
+
+    WavFileSource source;
+    if (!source.open(argv[1])) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    options.sample_rate = source.sample_rate();
+
+    VoicePipeline pipeline;
+    std::string error;
+    if (!pipeline.build(argv[2], StageRegistry::with_builtins(), options, &error)) {
+        fprintf(stderr, "bad spec: %s\n", error.c_str());
+        return 1;
+    }
+    {
+        TRACE_SCOPE("pipeline.run");
+        pipeline.run(source);
+    }
+    trace_stop();
+
+    std::vector<PipelineEvent> events;
+    pipeline.poll_events(events);
+    for (const PipelineEvent& event : events) {
+        printf("%8.3f s  %-12s", static_cast<double>(event.position) / options.sample_rate, event_name(event.type));
+        if (event.type == PIPELINE_SPEECH_END) printf("  reason=%d delay=%d ms", event.reason, event.delay_ms);
+        if (event.type == PIPELINE_RESULT) printf("  \"%s\"", event.text.c_str());
+        printf("\n");
+    }
+    printf("%s%s", pipeline.stopped() ? "stopped early\n" : "", pipeline.format_stats().c_str());
+    return 0;
+}
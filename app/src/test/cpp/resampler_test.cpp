@@ -0,0 +1,78 @@
+/**
+ * resampler_test.cpp - Sample rate conversion for the echo reference
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "resampler.h"
+
+using namespace assistant;
+
+namespace {
+    std::vector<float> sine(int32_t rate, float hz, size_t n) {
+        std::vector<float> x(n);
+        for (size_t i = 0; i < n; ++i) x[i] = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * hz * i / rate);
+        return x;
+    }
+
+    /** Resample in uneven chunks, like capture-loop pushes. */
+    std::vector<float> run(Resampler& resampler, const std::vector<float>& in) {
+        std::vector<float> out;
+        size_t i = 0;
+        size_t chunk = 137;
+        while (i < in.size()) {
+            const size_t n = std::min(chunk, in.size() - i);
+            std::vector<float> buf(resampler.max_output(n));
+            const size_t produced = resampler.process(in.data() + i, n, buf.data(), buf.size());
+            out.insert(out.end(), buf.begin(), buf.begin() + produced);
+            i += n;
+            chunk = chunk == 137 ? 441 : 137;
+        }
+        return out;
+    }
+
+    /** Amplitude of `hz` in `x` (single-bin DFT over the whole signal). */
+    float amplitude_at(const std::vector<float>& x, int32_t rate, float hz) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            const double w = 2.0 * M_PI * hz * i / rate;
+            re += x[i] * std::cos(w);
+            im += x[i] * std::sin(w);
+        }
+        return static_cast<float>(2.0 * std::sqrt(re * re + im * im) / x.size());
+    }
+}
+
+TEST(Resampler, OutputLengthTracksRateRatio) {
+    Resampler resampler(22050, 16000);
+    const auto out = run(resampler, sine(22050, 440.0f, 22050));
+    EXPECT_NEAR(static_cast<double>(out.size()), 16000.0, 20.0);
+}
+
+TEST(Resampler, PreservesInBandTone) {
+    for (const int32_t in_rate : {22050, 24000, 48000}) {
+        Resampler resampler(in_rate, 16000);
+        auto out = run(resampler, sine(in_rate, 1000.0f, static_cast<size_t>(in_rate)));
+        out.erase(out.begin(), out.begin() + 100);  // skip the filter's start-up
+        EXPECT_NEAR(amplitude_at(out, 16000, 1000.0f), 0.5f, 0.02f) << in_rate;
+    }
+}
+
+TEST(Resampler, RejectsAboveOutputNyquist) {
+    // 10 kHz at 24 kHz would alias to 6 kHz at 16 kHz without the low-pass
+    Resampler resampler(24000, 16000);
+    auto out = run(resampler, sine(24000, 10000.0f, 24000));
+    out.erase(out.begin(), out.begin() + 100);
+    EXPECT_LT(amplitude_at(out, 16000, 6000.0f), 0.01f);
+}
+
+TEST(Resampler, EqualRatesPassThrough) {
+    Resampler resampler(16000, 16000);
+    const auto in = sine(16000, 300.0f, 1000);
+    const auto out = run(resampler, in);
+    ASSERT_EQ(out.size(), in.size());
+    EXPECT_EQ(out, in);
+}
@@ -0,0 +1,178 @@
+/**
+ * session_io.h - Read and write recorded assistant sessions
+ *
+ * The on-disk format written by SessionRecorder on the device, one
+ * directory per voice turn:
+ *
+ *   session.tsv        t_ms <TAB> event <TAB> detail, t_ms since the trigger
+ *   audio.wav          the capture as handed to the recognizer
+ *   llm_request.json   the chat request body
+ *   llm_response.sse   the response body, one SSE line per "\n"
+ *   llm_response.tsv   t_ms <TAB> end offset in llm_response.sse, per line,
+ *                      t_ms since the request was sent
+ *
+ * Details escape tab, newline and backslash as \t, \n and \\.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace assistant {
+namespace testing {
+
+struct SessionEvent {
+    int64_t t_ms = 0;
+    std::string name;
+    std::string detail;
+};
+
+/** One response line and when it arrived after the request was sent. */
+struct SessionLine {
+    int64_t t_ms = 0;
+    std::string text;
+};
+
+struct Session {
+    std::string dir;
+    std::vector<SessionEvent> events;
+    std::string request;
+    std::vector<SessionLine> response;
+
+    /** First event called `name`, or nullptr. */
+    const SessionEvent* find(const char* name) const {
+        for (const SessionEvent& event : events) {
+            if (event.name == name) return &event;
+        }
+        return nullptr;
+    }
+
+    std::string audio_path() const { return dir + "/audio.wav"; }
+};
+
+inline std::string session_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+inline std::string session_unescape(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            out += text[i];
+            continue;
+        }
+        const char c = text[++i];
+        out += c == 't' ? '\t' : c == 'n' ? '\n' : c;
+    }
+    return out;
+}
+
+inline bool read_text_file(const std::string& path, std::string& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    out.clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) out.append(buffer, n);
+    fclose(file);
+    return true;
+}
+
+inline bool write_text_file(const std::string& path, const std::string& text) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    const bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    return fclose(file) == 0 && ok;
+}
+
+inline std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+/**
+ * Load the session in `dir`. The events are required; the request and
+ * response are empty for turns that never reached the chat API.
+ */
+inline bool load_session(const std::string& dir, Session& session, std::string* error) {
+    session = Session();
+    session.dir = dir;
+    std::string text;
+    if (!read_text_file(dir + "/session.tsv", text)) {
+        *error = "cannot read " + dir + "/session.tsv";
+        return false;
+    }
+    for (const std::string& line : split_lines(text)) {
+        if (line.empty() || line[0] == '#') continue;
+        const size_t tab1 = line.find('\t');
+        const size_t tab2 = tab1 == std::string::npos ? tab1 : line.find('\t', tab1 + 1);
+        if (tab1 == std::string::npos) {
+            *error = "bad event line: " + line;
+            return false;
+        }
+        SessionEvent event;
+        event.t_ms = strtoll(line.c_str(), nullptr, 10);
+        event.name = line.substr(tab1 + 1, tab2 == std::string::npos ? std::string::npos : tab2 - tab1 - 1);
+        if (tab2 != std::string::npos) event.detail = session_unescape(line.substr(tab2 + 1));
+        session.events.push_back(event);
+    }
+
+    read_text_file(dir + "/llm_request.json", session.request);
+    std::string body, timing;
+    if (read_text_file(dir + "/llm_response.sse", body) && read_text_file(dir + "/llm_response.tsv", timing)) {
+        size_t start = 0;
+        for (const std::string& line : split_lines(timing)) {
+            const size_t tab = line.find('\t');
+            if (tab == std::string::npos) continue;
+            const size_t end = static_cast<size_t>(strtoull(line.c_str() + tab + 1, nullptr, 10));
+            if (end <= start || end > body.size()) {
+                *error = "response timing does not match " + dir + "/llm_response.sse";
+                return false;
+            }
+            // Offsets include the line's "\n"
+            session.response.push_back({strtoll(line.c_str(), nullptr, 10), body.substr(start, end - start - 1)});
+            start = end;
+        }
+    }
+    return true;
+}
+
+/** Write `session` to `session.dir` (which must exist); audio is written separately. */
+inline bool save_session(const Session& session) {
+    std::string events = "# assistant session v1\n";
+    for (const SessionEvent& event : session.events) {
+        events += std::to_string(event.t_ms) + "\t" + event.name + "\t" + session_escape(event.detail) + "\n";
+    }
+    if (!write_text_file(session.dir + "/session.tsv", events)) return false;
+    if (session.response.empty()) return true;
+
+    std::string body, timing;
+    for (const SessionLine& line : session.response) {
+        body += line.text + "\n";
+        timing += std::to_string(line.t_ms) + "\t" + std::to_string(body.size()) + "\n";
+    }
+    return write_text_file(session.dir + "/llm_request.json", session.request) &&
+           write_text_file(session.dir + "/llm_response.sse", body) &&
+           write_text_file(session.dir + "/llm_response.tsv", timing);
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,132 @@
+/**
+ * session_make_fixture.cpp - Generate a recorded session for session_replay
+ *
+ * Writes a session directory in the format SessionRecorder produces on the
+ * device: a short utterance in a quiet room, the capture pipeline's own
+ * endpoint on it, a typical cloud transcription delay, and a streamed chat
+ * answer of 40 tokens at 20 ms each after a 420 ms first-token wait. Output
+ * is deterministic.
+ *
+ * Usage: session_make_fixture <output_dir>
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "session_io.h"
+#include "test_audio.h"
+#include "voice_pipeline.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+    constexpr int32_t kFrameMs = 20;
+    constexpr int64_t kListeningMs = 150;
+    constexpr int64_t kAsrMs = 350;
+    constexpr int64_t kFirstTokenMs = 420;
+    constexpr int64_t kTokenMs = 20;
+    constexpr int kTokens = 40;
+    const char* kSpec = "highpass cutoff_hz=80 | vad hangover_ms=700 | tap seconds=5";
+    const char* kQuery = "What's the weather like tomorrow?";
+    const char* kWords[] = {"Tomorrow ", "will ", "be ", "mostly ", "sunny ", "with ", "a ", "light ", "breeze, "};
+
+    std::string sse_event(const std::string& token) {
+        return "data: {\"id\":\"gen-1\",\"object\":\"chat.completion.chunk\",\"model\":\"test/model\","
+               "\"choices\":[{\"index\":0,\"delta\":{\"content\":\"" + token + "\"},\"finish_reason\":null}]}";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output_dir>\n", argv[0]);
+        return 2;
+    }
+    const std::string dir = argv[1];
+
+    std::mt19937 rng(7);
+    std::vector<int16_t> pcm;
+    append_silence(pcm, kRate, 400);
+    append_speech(pcm, kRate, 0.3f, 1600, rng);
+    append_silence(pcm, kRate, 1500);
+    std::vector<int16_t> noise;
+    append_noise(noise, kRate, 0.003f, static_cast<int32_t>(pcm.size() * 1000 / kRate), rng);
+    mix_into(pcm, noise, 0);
+
+    // Endpoint the clip the way the capture pipeline would, and keep what it heard
+    PipelineOptions options;
+    options.sample_rate = kRate;
+    options.frame_ms = kFrameMs;
+    VoicePipeline pipeline;
+    std::string error;
+    if (!pipeline.build(kSpec, StageRegistry::with_builtins(), options, &error)) {
+        fprintf(stderr, "bad spec: %s\n", error.c_str());
+        return 1;
+    }
+    PipelineEvent end;
+    std::vector<PipelineEvent> events;
+    const size_t frame = static_cast<size_t>(kRate * kFrameMs / 1000);
+    size_t fed = 0;
+    while (fed < pcm.size() && end.type != PIPELINE_SPEECH_END) {
+        const size_t n = std::min(frame, pcm.size() - fed);
+        pipeline.push(pcm.data() + fed, n);
+        fed += n;
+        events.clear();
+        pipeline.poll_events(events);
+        for (const PipelineEvent& event : events) {
+            if (event.type == PIPELINE_SPEECH_END) end = event;
+        }
+    }
+    if (end.type != PIPELINE_SPEECH_END) {
+        fprintf(stderr, "pipeline found no end of speech in the fixture clip\n");
+        return 1;
+    }
+    pcm.resize(fed);
+    if (!write_wav_mono16(dir + "/audio.wav", pcm.data(), pcm.size(), kRate)) {
+        fprintf(stderr, "cannot write %s/audio.wav\n", dir.c_str());
+        return 1;
+    }
+
+    Session session;
+    session.dir = dir;
+    const int64_t speech_end = kListeningMs + static_cast<int64_t>(fed) * 1000 / kRate;
+    const int64_t capture_stop = speech_end + 15;
+    const int64_t transcript = capture_stop + kAsrMs;
+    const int64_t request = transcript + 40;
+    const int64_t first_token = request + kFirstTokenMs;
+    const int64_t last_token = first_token + (kTokens - 1) * kTokenMs;
+    session.events = {
+        {0, "trigger", ""},
+        {3, "pipeline", kSpec},
+        {kListeningMs, "listening", ""},
+        {speech_end, "speech_end", std::to_string(end.delay_ms) + " SILENCE"},
+        {capture_stop, "capture_stop", ""},
+        {transcript, "transcript", kQuery},
+        {transcript + 1, "query", kQuery},
+        {request, "request", ""},
+        {first_token + 2, "first_token", ""},
+        {first_token + 180, "first_audio", ""},
+        {last_token + 3, "last_token", std::to_string(kTokens * 5)},
+        {last_token + 6, "complete", ""},
+    };
+    session.request = std::string("{\"model\":\"test/model\",\"stream\":true,\"messages\":[{\"role\":\"user\","
+                                  "\"content\":\"") + kQuery + "\"}]}";
+    for (int i = 0; i < kTokens; ++i) {
+        const int64_t at = kFirstTokenMs + i * kTokenMs;
+        session.response.push_back({at, sse_event(kWords[i % (sizeof(kWords) / sizeof(kWords[0]))])});
+        session.response.push_back({at, ""});
+    }
+    session.response.push_back({kFirstTokenMs + kTokens * kTokenMs, "data: [DONE]"});
+    if (!save_session(session)) {
+        fprintf(stderr, "cannot write session to %s\n", dir.c_str());
+        return 1;
+    }
+    printf("wrote session to %s: %zu ms of audio, endpoint %d ms after speech\n",
+           dir.c_str(), fed * 1000 / kRate, end.delay_ms);
+    return 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * session_replay.cpp - Replay a recorded session against a local stand-in
+ *
+ * Drives a session recorded on the device (SessionRecorder, or
+ * session_make_fixture) through the host pieces of the voice turn:
+ *  - the capture audio through the recorded voice pipeline spec (or
+ *    --spec), paced like a microphone, until the pipeline ends the utterance;
+ *  - the recognizer and query preparation as the recorded delays;
+ *  - the chat request against a loopback StandinServer that sends the
+ *    recorded SSE lines at their recorded times, read and parsed the way
+ *    the app's clients do.
+ * Then prints each stage as recorded and as replayed (in recorded time,
+ * i.e. multiplied back by --speed), so a change to the pipeline, the
+ * endpoint settings or the stream parsing shows up as a latency delta.
+ *
+ * Usage: session_replay <session_dir> [--speed X] [--spec "<spec>"]
+ *                       [--tsv out.tsv] [--max-drift-ms N]
+ *   --speed         replay X times faster than recorded (default 1; 0 = no
+ *                   waiting at all: prints only the pipeline and parse cost)
+ *   --max-drift-ms  fail if a stage replayed from the recording (not one
+ *                   the pipeline decides) is off by more than N ms
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "session_io.h"
+#include "sse_parse.h"
+#include "standin_http.h"
+#include "voice_pipeline.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // VoicePipeline.captureSpec() without endpointing settings
+    const char* kDefaultSpec = "highpass cutoff_hz=80 | vad | tap seconds=5";
+    constexpr int32_t kFrameMs = 20;
+
+    struct StageTiming {
+        const char* name;
+        double recorded_ms;     // NAN when the session lacks the events
+        double replayed_ms;
+        bool from_recording;    // replayed from recorded delays, so drift is a harness error
+    };
+
+    /** Replay clock: wall time since the replayed trigger, in recorded milliseconds. */
+    class ReplayClock {
+    public:
+        explicit ReplayClock(double speed) : speed_(speed), start_(Clock::now()) {}
+
+        double now_ms() const {
+            const double wall = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+            return speed_ > 0.0 ? wall * speed_ : wall;
+        }
+
+        /** Wait until recorded time `t_ms`; no waiting when unpaced. */
+        void wait_until(double t_ms) const {
+            if (speed_ <= 0.0) return;
+            std::this_thread::sleep_until(start_ + wall_duration(t_ms));
+        }
+
+        /** Recorded milliseconds as wall microseconds (0 when unpaced). */
+        int64_t wall_us(double t_ms) const {
+            return speed_ > 0.0 ? static_cast<int64_t>(t_ms * 1000.0 / speed_) : 0;
+        }
+
+    private:
+        std::chrono::microseconds wall_duration(double t_ms) const {
+            return std::chrono::microseconds(wall_us(t_ms));
+        }
+
+        double speed_;
+        Clock::time_point start_;
+    };
+
+    double event_ms(const Session& session, const char* name) {
+        const SessionEvent* event = session.find(name);
+        return event != nullptr ? static_cast<double>(event->t_ms) : NAN;
+    }
+
+    double speech_end_delay_ms(const Session& session) {
+        const SessionEvent* event = session.find("speech_end");
+        return event != nullptr ? atof(event->detail.c_str()) : NAN;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <session_dir> [--speed X] [--spec \"<spec>\"] [--tsv out.tsv] "
+                        "[--max-drift-ms N]\n", argv[0]);
+        return 2;
+    }
+    double speed = 1.0;
+    double max_drift_ms = -1.0;
+    const char* spec_override = nullptr;
+    const char* tsv_path = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) speed = atof(argv[++i]);
+        else if (strcmp(argv[i], "--spec") == 0 && i + 1 < argc) spec_override = argv[++i];
+        else if (strcmp(argv[i], "--tsv") == 0 && i + 1 < argc) tsv_path = argv[++i];
+        else if (strcmp(argv[i], "--max-drift-ms") == 0 && i + 1 < argc) max_drift_ms = atof(argv[++i]);
+    }
+
+    Session session;
+    std::string error;
+    if (!load_session(argv[1], session, &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Recorded timeline (ms since trigger); a typed query has no capture events
+    const double rec_listening = event_ms(session, "listening");
+    const double rec_speech_end = event_ms(session, "speech_end") - speech_end_delay_ms(session);
+    const double rec_capture_stop = event_ms(session, "capture_stop");
+    double rec_transcript = event_ms(session, "transcript");
+    const double rec_query = event_ms(session, "query");
+    const double rec_request = event_ms(session, "request");
+    const double rec_first_token = event_ms(session, "first_token");
+    const double rec_last_token = event_ms(session, "last_token");
+    if (std::isnan(rec_transcript)) rec_transcript = rec_query;
+    // Without an endpoint, speech ended when the user stopped the capture
+    const double rec_heard = std::isnan(rec_speech_end) ? rec_capture_stop : rec_speech_end;
+
+    ReplayClock clock(speed);
+    double listening = NAN, speech_end = NAN, endpoint_delay = NAN;
+    double capture_stop = 0.0;
+
+    std::vector<int16_t> pcm;
+    int32_t rate = 0;
+    if (!std::isnan(rec_listening) && read_wav_mono16(session.audio_path(), pcm, &rate)) {
+        const SessionEvent* recorded_spec = session.find("pipeline");
+        const std::string spec = spec_override != nullptr ? spec_override
+                               : recorded_spec != nullptr ? recorded_spec->detail : kDefaultSpec;
+        PipelineOptions options;
+        options.sample_rate = rate;
+        options.frame_ms = kFrameMs;
+        VoicePipeline pipeline;
+        if (!pipeline.build(spec, StageRegistry::with_builtins(), options, &error)) {
+            fprintf(stderr, "bad spec: %s\n", error.c_str());
+            return 1;
+        }
+
+        // The microphone opens when it did on the device, then delivers a frame per frame time
+        clock.wait_until(rec_listening);
+        listening = clock.now_ms();
+        const size_t frame = static_cast<size_t>(rate) * kFrameMs / 1000;
+        std::vector<PipelineEvent> events;
+        size_t fed = 0;
+        while (fed < pcm.size() && std::isnan(speech_end)) {
+            const size_t n = std::min(frame, pcm.size() - fed);
+            fed += n;
+            clock.wait_until(listening + static_cast<double>(fed) * 1000.0 / rate);
+            pipeline.push(pcm.data() + fed - n, n);
+            events.clear();
+            pipeline.poll_events(events);
+            for (const PipelineEvent& event : events) {
+                if (event.type != PIPELINE_SPEECH_END) continue;
+                endpoint_delay = event.delay_ms;
+                speech_end = clock.now_ms() - event.delay_ms;
+            }
+        }
+        capture_stop = clock.now_ms();
+        printf("pipeline: %s\n%s", spec.c_str(), pipeline.format_stats().c_str());
+    } else if (!std::isnan(rec_capture_stop)) {
+        clock.wait_until(rec_capture_stop);
+        capture_stop = clock.now_ms();
+    }
+
+    // Recognition and query preparation (search, local actions) take what they took
+    const double asr_ms = std::isnan(rec_capture_stop) ? 0.0 : rec_transcript - rec_capture_stop;
+    clock.wait_until(capture_stop + asr_ms);
+    const double transcript = clock.now_ms();
+    const double prep_ms = std::isnan(rec_request) ? 0.0 : rec_request - rec_transcript;
+    clock.wait_until(transcript + prep_ms);
+
+    // Chat stream through the stand-in, timed and parsed as it arrives
+    double first_token = NAN, last_token = NAN;
+    size_t lines = 0, tokens = 0;
+    double parse_us = 0.0;
+    if (!session.response.empty()) {
+        StandinServer server;
+        const std::vector<SessionLine>& recorded = session.response;
+        bool started = server.start([&](const HttpRequest&) {
+            HttpResponse response;
+            response.content_type = "text/event-stream";
+            for (const SessionLine& line : recorded) {
+                response.chunks.push_back({clock.wall_us(static_cast<double>(line.t_ms)), line.text + "\n"});
+            }
+            return response;
+        }, &error);
+        if (!started) {
+            fprintf(stderr, "stand-in server: %s\n", error.c_str());
+            return 1;
+        }
+        std::string text;
+        HttpResult result;
+        const bool ok = http_request_lines(server.port(), "POST", "/api/v1/chat/completions", session.request,
+            "application/json", [&](const std::string& line, int64_t) {
+                const Clock::time_point begin = Clock::now();
+                const bool token = sse_delta_content(line, text);
+                parse_us += std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+                ++lines;
+                if (!token) return;
+                ++tokens;
+                last_token = clock.now_ms();
+                if (std::isnan(first_token)) first_token = last_token;
+            }, result, &error);
+        server.stop();
+        if (!ok || result.status != 200) {
+            fprintf(stderr, "replayed request failed: %s (status %d)\n", error.c_str(), result.status);
+            return 1;
+        }
+        printf("stream: %zu lines, %zu tokens, %zu chars, %llu bytes; parse %.2f us/line\n",
+               lines, tokens, text.size(), static_cast<unsigned long long>(result.body_bytes),
+               lines > 0 ? parse_us / lines : 0.0);
+    }
+    if (speed <= 0.0) {
+        // Nothing waited, so only the pipeline and parse costs above mean anything
+        if (!std::isnan(rec_first_token) && tokens == 0) {
+            fprintf(stderr, "recorded stream had tokens but the replay parsed none\n");
+            return 1;
+        }
+        return 0;
+    }
+    const double heard = std::isnan(speech_end) ? capture_stop : speech_end;
+
+    const StageTiming stages[] = {
+        {"trigger_to_listening", rec_listening, listening, true},
+        {"endpoint_delay", speech_end_delay_ms(session), endpoint_delay, false},
+        {"trigger_to_speech_end", rec_speech_end, speech_end, false},
+        {"speech_end_to_transcript", rec_transcript - rec_heard, transcript - heard, false},
+        {"transcript_to_first_token", rec_first_token - rec_transcript, first_token - transcript, true},
+        {"first_to_last_token", rec_last_token - rec_first_token, last_token - first_token, true},
+        {"trigger_to_last_token", rec_last_token, last_token, false},
+    };
+
+    FILE* tsv = tsv_path != nullptr ? fopen(tsv_path, "w") : nullptr;
+    if (tsv != nullptr) fprintf(tsv, "# stage\trecorded_ms\treplayed_ms\n");
+    printf("\n%-28s %10s %10s %10s\n", "stage (ms)", "recorded", "replayed", "delta");
+    bool drift_ok = true;
+    for (const StageTiming& stage : stages) {
+        if (std::isnan(stage.recorded_ms) && std::isnan(stage.replayed_ms)) continue;
+        const double delta = stage.replayed_ms - stage.recorded_ms;
+        printf("%-28s %10.1f %10.1f %+10.1f\n", stage.name, stage.recorded_ms, stage.replayed_ms, delta);
+        if (tsv != nullptr) fprintf(tsv, "%s\t%.1f\t%.1f\n", stage.name, stage.recorded_ms, stage.replayed_ms);
+        if (max_drift_ms >= 0.0 && stage.from_recording && !std::isnan(stage.recorded_ms) &&
+            !(std::fabs(delta) <= max_drift_ms)) {
+            fprintf(stderr, "%s drifted %.1f ms from the recording (limit %.1f)\n",
+                    stage.name, delta, max_drift_ms);
+            drift_ok = false;
+        }
+    }
+    if (tsv != nullptr) fclose(tsv);
+    if (!std::isnan(rec_first_token) && tokens == 0) {
+        fprintf(stderr, "recorded stream had tokens but the replay parsed none\n");
+        return 1;
+    }
+    return drift_ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/**
+ * sse_parse.h - Pull the text delta out of OpenAI-style chat SSE lines
+ *
+ * The same work the app's clients do per line (find "data: ", skip
+ * "[DONE]", read choices[0].delta.content) without a JSON library, so
+ * host tools can time a stream the way the app would consume it.
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace assistant {
+namespace testing {
+
+/** Append the UTF-8 encoding of `code` to `out`. */
+inline void append_utf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+/** Decode the JSON string starting at the opening quote `p`; returns the char after it or nullptr. */
+inline const char* read_json_string(const char* p, std::string& out) {
+    if (*p != '"') return nullptr;
+    for (++p; *p != '\0'; ++p) {
+        if (*p == '"') return p + 1;
+        if (*p != '\\') {
+            out += *p;
+            continue;
+        }
+        switch (*++p) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                char hex[5] = {0};
+                for (int i = 0; i < 4; ++i) {
+                    if (p[1 + i] == '\0') return nullptr;
+                    hex[i] = p[1 + i];
+                }
+                unsigned code = static_cast<unsigned>(strtoul(hex, nullptr, 16));
+                p += 4;
+                // Surrogate pair
+                if (code >= 0xD800 && code < 0xDC00 && p[1] == '\\' && p[2] == 'u') {
+                    char low_hex[5] = {0};
+                    for (int i = 0; i < 4 && p[3 + i] != '\0'; ++i) low_hex[i] = p[3 + i];
+                    const unsigned low = static_cast<unsigned>(strtoul(low_hex, nullptr, 16));
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                append_utf8(out, code);
+                break;
+            }
+            case '\0': return nullptr;
+            default: out += *p; break;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Text delta carried by one SSE line, appended to `out`. False for
+ * comments, blank lines, "[DONE]" and events without content.
+ */
+inline bool sse_delta_content(const std::string& line, std::string& out) {
+    if (line.compare(0, 5, "data:") != 0) return false;
+    const char* p = line.c_str() + 5;
+    while (*p == ' ') ++p;
+    if (strncmp(p, "[DONE]", 6) == 0) return false;
+    const char* delta = strstr(p, "\"delta\"");
+    if (delta == nullptr) return false;
+    const char* key = strstr(delta, "\"content\"");
+    if (key == nullptr) return false;
+    p = key + 9;
+    while (*p == ' ' || *p == ':') ++p;
+    const size_t before = out.size();
+    return read_json_string(p, out) != nullptr && out.size() > before;
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,171 @@
+/**
+ * standin_api.cpp - Stand-in for the chat, transcription and search APIs
+ */
+
+#include "standin_api.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace assistant {
+namespace testing {
+
+namespace {
+    const char* kWords[] = {
+        "The ", "forecast ", "for ", "tomorrow ", "is ", "mostly ", "sunny, ", "with ",
+        "a ", "light ", "breeze ", "and ", "highs ", "around ", "twenty ", "degrees. ",
+    };
+    constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+    bool is_chat_path(const std::string& path) {
+        return path == "/api/v1/chat/completions" || path == "/chat/completions" ||
+               path == "/v1/chat/completions";
+    }
+
+    bool is_transcription_path(const std::string& path) {
+        return path == "/v1/audio/transcriptions" || path == "/openai/v1/audio/transcriptions";
+    }
+
+    /** Value of query parameter `name` in `path`, or "". */
+    std::string query_param(const std::string& path, const std::string& name) {
+        size_t start = path.find('?');
+        while (start != std::string::npos) {
+            ++start;
+            const size_t end = path.find('&', start);
+            const std::string pair = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (pair.compare(0, name.size() + 1, name + "=") == 0) return pair.substr(name.size() + 1);
+            start = end;
+        }
+        return std::string();
+    }
+
+    HttpResponse json_response(int64_t delay_us, const std::string& body) {
+        HttpResponse response;
+        response.chunks.push_back({delay_us, body});
+        return response;
+    }
+
+    bool requests_stream(const std::string& body) {
+        const size_t key = body.find("\"stream\"");
+        if (key == std::string::npos) return false;
+        size_t value = body.find(':', key);
+        if (value == std::string::npos) return false;
+        ++value;
+        while (value < body.size() && body[value] == ' ') ++value;
+        return body.compare(value, 4, "true") == 0;
+    }
+}
+
+HttpResponse StandinApi::handle(const HttpRequest& request) {
+    const std::string path = request.path.substr(0, request.path.find('?'));
+    int64_t delay_us = 0;
+    bool fail = false, cut = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        if (config_.jitter_ms > 0) {
+            delay_us = std::uniform_int_distribution<int64_t>(0, config_.jitter_ms * 1000)(rng_);
+        }
+        fail = chance(rng_) < config_.fail_rate;
+        cut = chance(rng_) < config_.cut_rate;
+        if (is_chat_path(path)) counters_.chat++;
+        else if (is_transcription_path(path)) counters_.transcriptions++;
+        else if (path == "/res/v1/web/search") counters_.searches++;
+        else counters_.not_found++;
+        if (fail) counters_.failures++;
+    }
+
+    HttpResponse response;
+    if (fail) {
+        response = json_response(delay_us, "{\"error\":{\"message\":\"injected failure\",\"code\":" +
+                                           std::to_string(config_.fail_status) + "}}");
+        response.status = config_.fail_status;
+        return response;
+    }
+    if (is_chat_path(path) && request.method == "POST") {
+        if (cut && requests_stream(request.body)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            counters_.cuts++;
+        }
+        return chat(request, delay_us, cut);
+    }
+    if (is_transcription_path(path) && request.method == "POST") {
+        return json_response(delay_us + config_.transcribe_ms * 1000,
+                             "{\"text\":\"What's the weather like tomorrow?\"}");
+    }
+    if (path == "/res/v1/web/search" && request.method == "GET") {
+        const int count = std::max(1, std::min(20, atoi(query_param(request.path, "count").c_str())));
+        std::string body = "{\"type\":\"search\",\"web\":{\"results\":[";
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) body += ",";
+            body += "{\"title\":\"Result " + std::to_string(i + 1) + "\",\"url\":\"https://example.com/" +
+                    std::to_string(i + 1) + "\",\"description\":\"Stand-in search result " +
+                    std::to_string(i + 1) + " with a snippet of typical length for ranking.\"}";
+        }
+        body += "]}}";
+        return json_response(delay_us + config_.search_ms * 1000, body);
+    }
+    response.status = 404;
+    response.chunks.push_back({0, "{\"error\":{\"message\":\"no stand-in for " + request.method + " " + path + "\"}}"});
+    return response;
+}
+
+HttpResponse StandinApi::chat(const HttpRequest& request, int64_t delay_us, bool cut) {
+    HttpResponse response;
+    const int64_t first_us = delay_us + config_.first_token_ms * 1000;
+    if (!requests_stream(request.body)) {
+        response.chunks.push_back({first_us, "{\"id\":\"standin\",\"object\":\"chat.completion\",\"choices\":"
+                                             "[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"" +
+                                             answer_text() + "\"},\"finish_reason\":\"stop\"}]}"});
+        return response;
+    }
+
+    response.content_type = "text/event-stream";
+    const double step_us = config_.tokens_per_s > 0.0 ? 1e6 / config_.tokens_per_s : 0.0;
+    const int32_t sent = cut ? config_.tokens / 2 : config_.tokens;
+    for (int32_t i = 0; i < sent; ++i) {
+        response.chunks.push_back({first_us + static_cast<int64_t>(i * step_us),
+                                   std::string("data: {\"id\":\"standin\",\"object\":\"chat.completion.chunk\","
+                                               "\"choices\":[{\"index\":0,\"delta\":{\"content\":\"") +
+                                   kWords[i % kWordCount] + "\"},\"finish_reason\":null}]}\n\n"});
+    }
+    if (!cut) {
+        response.chunks.push_back({first_us + static_cast<int64_t>(sent * step_us), "data: [DONE]\n\n"});
+    }
+    return response;
+}
+
+StandinCounters StandinApi::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+}
+
+bool parse_standin_option(int argc, char** argv, int& i, StandinConfig& config) {
+    if (i + 1 >= argc) return false;
+    const char* name = argv[i];
+    const char* value = argv[i + 1];
+    if (strcmp(name, "--first-token-ms") == 0) config.first_token_ms = atoll(value);
+    else if (strcmp(name, "--tokens-per-s") == 0) config.tokens_per_s = atof(value);
+    else if (strcmp(name, "--tokens") == 0) config.tokens = atoi(value);
+    else if (strcmp(name, "--transcribe-ms") == 0) config.transcribe_ms = atoll(value);
+    else if (strcmp(name, "--search-ms") == 0) config.search_ms = atoll(value);
+    else if (strcmp(name, "--jitter-ms") == 0) config.jitter_ms = atoll(value);
+    else if (strcmp(name, "--fail-rate") == 0) config.fail_rate = atof(value);
+    else if (strcmp(name, "--fail-status") == 0) config.fail_status = atoi(value);
+    else if (strcmp(name, "--cut-rate") == 0) config.cut_rate = atof(value);
+    else if (strcmp(name, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+    else return false;
+    ++i;
+    return true;
+}
+
+std::string StandinApi::answer_text() const {
+    std::string text;
+    for (int32_t i = 0; i < config_.tokens; ++i) text += kWords[i % kWordCount];
+    return text;
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,81 @@
+/**
+ * standin_api.h - Stand-in for the chat, transcription and search APIs
+ *
+ * Answers the requests our clients make, by path, so the app (pointed at
+ * it with Endpoints.baseOverride) and host tools can be measured without
+ * the real services:
+ *   POST /api/v1/chat/completions, /chat/completions, /v1/chat/completions
+ *        OpenAI-style chat; SSE when the body asks for "stream": true
+ *   POST /v1/audio/transcriptions, /openai/v1/audio/transcriptions
+ *        Whisper-style {"text": ...}
+ *   GET  /res/v1/web/search?q=...&count=N
+ *        Brave-style {"web": {"results": [...]}}
+ * Latency, token rate and failures are set by StandinConfig; random
+ * choices come from a seeded generator, so a run is repeatable.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "standin_http.h"
+
+namespace assistant {
+namespace testing {
+
+struct StandinConfig {
+    int64_t first_token_ms = 300;   // request to first chat token
+    double tokens_per_s = 50.0;     // chat token rate; 0 sends them all at once
+    int32_t tokens = 100;           // tokens per chat answer
+    int64_t transcribe_ms = 400;
+    int64_t search_ms = 250;
+    int64_t jitter_ms = 0;          // uniform 0..jitter_ms added before the first byte
+    double fail_rate = 0.0;         // share of requests answered with fail_status
+    int32_t fail_status = 503;
+    double cut_rate = 0.0;          // share of chat streams ended halfway without [DONE]
+    uint32_t seed = 1;
+};
+
+struct StandinCounters {
+    uint64_t chat = 0;
+    uint64_t transcriptions = 0;
+    uint64_t searches = 0;
+    uint64_t failures = 0;          // injected error statuses
+    uint64_t cuts = 0;              // injected truncated streams
+    uint64_t not_found = 0;
+};
+
+/** Usage text for the options parse_standin_option() understands. */
+constexpr const char* kStandinOptions =
+    "[--first-token-ms N] [--tokens-per-s X] [--tokens N] [--transcribe-ms N] [--search-ms N]\n"
+    "    [--jitter-ms N] [--fail-rate P] [--fail-status S] [--cut-rate P] [--seed N]";
+
+/** Consume the stand-in option at argv[i] (and its value); false if it is not one. */
+bool parse_standin_option(int argc, char** argv, int& i, StandinConfig& config);
+
+class StandinApi {
+public:
+    explicit StandinApi(const StandinConfig& config) : config_(config), rng_(config.seed) {}
+
+    /** Thread-safe; suitable as a StandinServer handler. */
+    HttpResponse handle(const HttpRequest& request);
+
+    StandinCounters counters() const;
+
+    /** The chat answer's tokens joined, as a client should reassemble it. */
+    std::string answer_text() const;
+
+private:
+    HttpResponse chat(const HttpRequest& request, int64_t delay_us, bool cut);
+
+    StandinConfig config_;
+    mutable std::mutex mutex_;
+    std::mt19937 rng_;
+    StandinCounters counters_;
+};
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,207 @@
+/**
+ * standin_bench.cpp - Load and latency benchmark against the API stand-in
+ *
+ * Starts StandinApi in-process and sends requests from several threads with
+ * the streaming client and SSE parser the host tools share. Everything the
+ * stand-in is told to wait (first token, token rate, transcription and
+ * search delay) is subtracted, so what is left is client and loopback
+ * overhead, per request and per token. With --first-token-ms 0
+ * --tokens-per-s 0 that is the floor any client can reach on this machine;
+ * the app's own clients are measured against the same server on a device
+ * (see docs/ARCHITECTURE.md, Native Tests).
+ *
+ * --check verifies the injected failures and cut streams are the ones the
+ * clients saw, and that every complete stream reassembles the answer.
+ *
+ * Usage: standin_bench [--requests N] [--concurrency N] [--api chat|transcribe|search]
+ *                      [--check] <stand-in options>
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sse_parse.h"
+#include "standin_api.h"
+#include "standin_http.h"
+
+using namespace assistant::testing;
+
+namespace {
+    struct Sample {
+        double latency_ms = 0.0;
+        double overhead_ms = 0.0;
+        int32_t tokens = 0;
+        bool failed = false;
+        bool cut = false;
+        bool wrong_text = false;
+    };
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+}
+
+int main(int argc, char** argv) {
+    StandinConfig config;
+    config.first_token_ms = 0;
+    config.tokens_per_s = 0.0;
+    config.transcribe_ms = 0;
+    config.search_ms = 0;
+    int requests = 200;
+    int concurrency = 4;
+    std::string api_name = "chat";
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) requests = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) concurrency = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--api") == 0 && i + 1 < argc) api_name = argv[++i];
+        else if (strcmp(argv[i], "--check") == 0) check = true;
+        else if (!parse_standin_option(argc, argv, i, config)) {
+            fprintf(stderr, "usage: %s [--requests N] [--concurrency N] [--api chat|transcribe|search] [--check]\n"
+                            "    %s\n", argv[0], kStandinOptions);
+            return 2;
+        }
+    }
+    if (api_name != "chat" && api_name != "transcribe" && api_name != "search") {
+        fprintf(stderr, "unknown --api %s\n", api_name.c_str());
+        return 2;
+    }
+    concurrency = std::max(1, concurrency);
+
+    StandinApi api(config);
+    StandinServer server;
+    std::string error;
+    if (!server.start([&api](const HttpRequest& request) { return api.handle(request); }, &error)) {
+        fprintf(stderr, "stand-in server: %s\n", error.c_str());
+        return 1;
+    }
+
+    // What the stand-in waits on purpose, per successful request
+    double scheduled_ms = 0.0;
+    if (api_name == "chat") {
+        scheduled_ms = static_cast<double>(config.first_token_ms) +
+                       (config.tokens_per_s > 0.0 ? config.tokens * 1000.0 / config.tokens_per_s : 0.0);
+    } else {
+        scheduled_ms = static_cast<double>(api_name == "search" ? config.search_ms : config.transcribe_ms);
+    }
+    const std::string answer = api.answer_text();
+    // A short WAV-sized upload, like a few seconds of 16 kHz speech
+    const std::string upload(api_name == "transcribe" ? 96 * 1024 : 0, 'a');
+    const std::string chat_body = "{\"model\":\"test/model\",\"stream\":true,\"max_tokens\":4096,"
+                                  "\"messages\":[{\"role\":\"user\",\"content\":\"What's the weather like?\"}]}";
+
+    std::vector<Sample> samples(static_cast<size_t>(requests));
+    std::atomic<int> next{0};
+    std::atomic<int> errors{0};
+    std::mutex error_mutex;
+    std::string first_error;
+    auto worker = [&]() {
+        int index;
+        while ((index = next++) < requests) {
+            Sample& sample = samples[static_cast<size_t>(index)];
+            std::string text;
+            bool done = false;
+            HttpResult result;
+            std::string request_error;
+            const auto start = std::chrono::steady_clock::now();
+            bool ok;
+            if (api_name == "chat") {
+                ok = http_request_lines(server.port(), "POST", "/api/v1/chat/completions", chat_body,
+                    "application/json", [&](const std::string& line, int64_t) {
+                        if (sse_delta_content(line, text)) sample.tokens++;
+                        else if (line.compare(0, 12, "data: [DONE]") == 0) done = true;
+                    }, result, &request_error);
+            } else if (api_name == "transcribe") {
+                ok = http_request_lines(server.port(), "POST", "/openai/v1/audio/transcriptions", upload,
+                    "multipart/form-data; boundary=x", [&](const std::string& line, int64_t) { text += line; },
+                    result, &request_error);
+            } else {
+                ok = http_request_lines(server.port(), "GET", "/res/v1/web/search?q=weather&count=5", "", "",
+                    [&](const std::string& line, int64_t) { text += line; }, result, &request_error);
+            }
+            sample.latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!ok) {
+                if (errors++ == 0) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    first_error = request_error;
+                }
+                continue;
+            }
+            sample.failed = result.status != 200;
+            sample.overhead_ms = sample.latency_ms - (sample.failed ? 0.0 : scheduled_ms);
+            if (api_name == "chat" && !sample.failed) {
+                sample.cut = !done;
+                sample.wrong_text = done && text != answer;
+            } else if (!sample.failed) {
+                sample.wrong_text = text.find(api_name == "search" ? "\"results\"" : "\"text\"") == std::string::npos;
+            }
+        }
+    };
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < concurrency; ++i) threads.emplace_back(worker);
+    for (std::thread& thread : threads) thread.join();
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.stop();
+
+    std::vector<double> latency, overhead;
+    int64_t tokens = 0;
+    int failed = 0, cut = 0, wrong = 0;
+    double overhead_sum = 0.0;
+    for (const Sample& sample : samples) {
+        failed += sample.failed;
+        cut += sample.cut;
+        wrong += sample.wrong_text;
+        if (sample.failed || sample.cut) continue;
+        latency.push_back(sample.latency_ms);
+        overhead.push_back(sample.overhead_ms);
+        overhead_sum += sample.overhead_ms;
+        tokens += sample.tokens;
+    }
+    printf("%s: %d requests, %d threads, %.1f req/s; %d failed, %d cut, %d connection errors\n",
+           api_name.c_str(), requests, concurrency, requests / wall_s, failed, cut, errors.load());
+    printf("latency ms    p50 %8.2f  p90 %8.2f  p99 %8.2f\n",
+           percentile(latency, 50), percentile(latency, 90), percentile(latency, 99));
+    printf("overhead ms   p50 %8.3f  p90 %8.3f  p99 %8.3f  (scheduled %.1f ms per request)\n",
+           percentile(overhead, 50), percentile(overhead, 90), percentile(overhead, 99), scheduled_ms);
+    if (tokens > 0) {
+        printf("overhead per token %.2f us (%lld tokens)\n", overhead_sum * 1000.0 / tokens,
+               static_cast<long long>(tokens));
+    }
+
+    if (errors > 0) {
+        fprintf(stderr, "%d requests failed to connect or read: %s\n", errors.load(), first_error.c_str());
+        return 1;
+    }
+    if (check) {
+        const StandinCounters counters = api.counters();
+        bool ok = true;
+        if (static_cast<uint64_t>(failed) != counters.failures) {
+            fprintf(stderr, "clients saw %d failures, stand-in injected %llu\n", failed,
+                    static_cast<unsigned long long>(counters.failures));
+            ok = false;
+        }
+        if (static_cast<uint64_t>(cut) != counters.cuts) {
+            fprintf(stderr, "clients saw %d cut streams, stand-in cut %llu\n", cut,
+                    static_cast<unsigned long long>(counters.cuts));
+            ok = false;
+        }
+        if (wrong > 0) {
+            fprintf(stderr, "%d complete responses did not match the stand-in's answer\n", wrong);
+            ok = false;
+        }
+        if (!ok) return 1;
+    }
+    return 0;
+}
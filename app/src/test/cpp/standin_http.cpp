@@ -0,0 +1,266 @@
+/**
+ * standin_http.cpp - Loopback HTTP server and streaming client for host tools
+ */
+
+#include "standin_http.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+namespace assistant {
+namespace testing {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    int64_t micros_since(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+
+    bool send_all(int fd, const char* data, size_t n) {
+        while (n > 0) {
+            const ssize_t sent = send(fd, data, n, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            data += sent;
+            n -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    const char* reason_phrase(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 404: return "Not Found";
+            case 429: return "Too Many Requests";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+        }
+        return "Status";
+    }
+
+    /** Read until the blank line ending the headers; leftover body bytes stay in `buffer`. */
+    bool read_head(int fd, std::string& buffer, size_t& head_end) {
+        char chunk[4096];
+        while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer.size() > 64 * 1024) return false;
+            const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    void parse_headers(const std::string& head, size_t first_line_end,
+                       std::vector<std::pair<std::string, std::string>>& headers) {
+        size_t start = first_line_end + 2;
+        while (start < head.size()) {
+            size_t end = head.find("\r\n", start);
+            if (end == std::string::npos) end = head.size();
+            const size_t colon = head.find(':', start);
+            if (colon != std::string::npos && colon < end) {
+                size_t value = colon + 1;
+                while (value < end && head[value] == ' ') ++value;
+                headers.emplace_back(head.substr(start, colon - start), head.substr(value, end - value));
+            }
+            start = end + 2;
+        }
+    }
+}
+
+std::string HttpRequest::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (strcasecmp(entry.first.c_str(), name.c_str()) == 0) return entry.second;
+    }
+    return std::string();
+}
+
+bool StandinServer::start(HttpHandler handler, std::string* error, int port) {
+    stop();
+    handler_ = std::move(handler);
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        *error = std::string("socket: ") + strerror(errno);
+        return false;
+    }
+    const int on = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 64) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        *error = std::string("listen: ") + strerror(errno);
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    running_ = true;
+    acceptor_ = std::thread(&StandinServer::accept_loop, this);
+    return true;
+}
+
+void StandinServer::stop() {
+    if (!running_.exchange(false)) return;
+    // Wakes the acceptor blocked in poll()
+    shutdown(listen_fd_, SHUT_RDWR);
+    acceptor_.join();
+    close(listen_fd_);
+    listen_fd_ = -1;
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        workers.swap(workers_);
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+void StandinServer::accept_loop() {
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        const int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        workers_.emplace_back(&StandinServer::serve, this, fd);
+    }
+}
+
+void StandinServer::serve(int fd) {
+    const int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    std::string buffer;
+    size_t head_end = 0;
+    HttpRequest request;
+    if (!read_head(fd, buffer, head_end)) {
+        close(fd);
+        return;
+    }
+    const std::string head = buffer.substr(0, head_end);
+    const size_t line_end = std::min(head.find("\r\n"), head.size());
+    const size_t sp1 = head.find(' ');
+    const size_t sp2 = sp1 == std::string::npos ? sp1 : head.find(' ', sp1 + 1);
+    if (sp2 == std::string::npos || sp2 > line_end) {
+        close(fd);
+        return;
+    }
+    request.method = head.substr(0, sp1);
+    request.path = head.substr(sp1 + 1, sp2 - sp1 - 1);
+    parse_headers(head, line_end, request.headers);
+
+    request.body = buffer.substr(head_end + 4);
+    if (strcasecmp(request.header("Expect").c_str(), "100-continue") == 0) {
+        static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        send_all(fd, kContinue, sizeof(kContinue) - 1);
+    }
+    const size_t length = static_cast<size_t>(strtoull(request.header("Content-Length").c_str(), nullptr, 10));
+    char chunk[4096];
+    while (request.body.size() < length) {
+        const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        request.body.append(chunk, static_cast<size_t>(n));
+    }
+    const Clock::time_point received = Clock::now();
+    requests_++;
+
+    const HttpResponse response = handler_(request);
+    std::string out = "HTTP/1.1 " + std::to_string(response.status) + " " + reason_phrase(response.status) +
+                      "\r\nContent-Type: " + response.content_type +
+                      "\r\nConnection: close\r\n\r\n";
+    bool ok = send_all(fd, out.data(), out.size());
+    for (const HttpChunk& part : response.chunks) {
+        if (!ok || !running_) break;
+        const Clock::time_point due = received + std::chrono::microseconds(part.at_us);
+        if (due > Clock::now()) std::this_thread::sleep_until(due);
+        ok = send_all(fd, part.bytes.data(), part.bytes.size());
+    }
+    shutdown(fd, SHUT_WR);
+    close(fd);
+}
+
+bool http_request_lines(int port, const std::string& method, const std::string& path,
+                        const std::string& body, const std::string& content_type,
+                        const std::function<void(const std::string& line, int64_t at_us)>& on_line,
+                        HttpResult& result, std::string* error) {
+    result = HttpResult();
+    const Clock::time_point start = Clock::now();
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        *error = std::string("socket: ") + strerror(errno);
+        return false;
+    }
+    const int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        *error = std::string("connect: ") + strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    std::string request = method + " " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    if (!body.empty()) {
+        request += "Content-Type: " + content_type + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    request += "Connection: close\r\n\r\n" + body;
+    std::string buffer;
+    size_t head_end = 0;
+    if (!send_all(fd, request.data(), request.size()) || !read_head(fd, buffer, head_end)) {
+        *error = "no response";
+        close(fd);
+        return false;
+    }
+    result.headers_us = micros_since(start);
+    const size_t sp = buffer.find(' ');
+    result.status = sp == std::string::npos ? 0 : atoi(buffer.c_str() + sp + 1);
+
+    // Lines are handed over as they complete; a final unterminated line at EOF too
+    std::string pending = buffer.substr(head_end + 4);
+    result.body_bytes = pending.size();
+    size_t start_line = 0;
+    char chunk[4096];
+    for (;;) {
+        size_t newline;
+        while ((newline = pending.find('\n', start_line)) != std::string::npos) {
+            on_line(pending.substr(start_line, newline - start_line), micros_since(start));
+            start_line = newline + 1;
+        }
+        pending.erase(0, start_line);
+        start_line = 0;
+        const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        pending.append(chunk, static_cast<size_t>(n));
+        result.body_bytes += static_cast<uint64_t>(n);
+    }
+    if (!pending.empty()) on_line(pending, micros_since(start));
+    close(fd);
+    result.total_us = micros_since(start);
+    return true;
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,99 @@
+/**
+ * standin_http.h - Loopback HTTP server and streaming client for host tools
+ *
+ * Stands in for the chat and transcription APIs so client timing can be
+ * measured on Linux without a network: the server answers each request
+ * from a handler that says what to send and when, and the client hands
+ * each response line to a callback as it arrives. HTTP/1.1 with
+ * "Connection: close" bodies only; enough for our own tools, not a
+ * general server.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace assistant {
+namespace testing {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    /** Value of header `name` (case-insensitive), or "". */
+    std::string header(const std::string& name) const;
+};
+
+/** Bytes the server writes once `at_us` has passed since the request was read. */
+struct HttpChunk {
+    int64_t at_us = 0;
+    std::string bytes;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::vector<HttpChunk> chunks;
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+class StandinServer {
+public:
+    StandinServer() = default;
+    ~StandinServer() { stop(); }
+
+    StandinServer(const StandinServer&) = delete;
+    StandinServer& operator=(const StandinServer&) = delete;
+
+    /** Listen on 127.0.0.1 at `port` (0 = any free port); false with a message on error. */
+    bool start(HttpHandler handler, std::string* error, int port = 0);
+
+    /** Stop accepting and wait for responses in flight. */
+    void stop();
+
+    int port() const { return port_; }
+    uint64_t requests() const { return requests_.load(); }
+
+private:
+    void accept_loop();
+    void serve(int fd);
+
+    HttpHandler handler_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> requests_{0};
+    std::thread acceptor_;
+    std::mutex workers_mutex_;
+    std::vector<std::thread> workers_;
+};
+
+struct HttpResult {
+    int status = 0;
+    int64_t headers_us = 0;     // request start to response headers
+    int64_t total_us = 0;       // request start to end of body
+    uint64_t body_bytes = 0;
+};
+
+/**
+ * Send one request to 127.0.0.1:`port` and call `on_line` for each body line
+ * (without its "\n") as soon as it has arrived, with the microseconds since
+ * the request started. False with a message on connection or protocol errors.
+ */
+bool http_request_lines(int port, const std::string& method, const std::string& path,
+                        const std::string& body, const std::string& content_type,
+                        const std::function<void(const std::string& line, int64_t at_us)>& on_line,
+                        HttpResult& result, std::string* error);
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,75 @@
+/**
+ * standin_server.cpp - Run the API stand-in for the app or other clients
+ *
+ * Serves StandinApi on 127.0.0.1 until interrupted (or for --duration-s),
+ * then prints what it answered. To point a debug build at it:
+ *
+ *   standin_server --port 8080 --first-token-ms 600 --tokens-per-s 40
+ *   adb reverse tcp:8080 tcp:8080
+ *   ./gradlew installDebug -PapiBaseOverride=http://127.0.0.1:8080
+ *
+ * Usage: standin_server [--port N] [--duration-s N] <stand-in options>
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "standin_api.h"
+#include "standin_http.h"
+
+using namespace assistant::testing;
+
+namespace {
+    std::atomic<bool> g_stop{false};
+
+    void on_signal(int) { g_stop = true; }
+}
+
+int main(int argc, char** argv) {
+    StandinConfig config;
+    int port = 8080;
+    double duration_s = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) duration_s = atof(argv[++i]);
+        else if (!parse_standin_option(argc, argv, i, config)) {
+            fprintf(stderr, "usage: %s [--port N] [--duration-s N]\n    %s\n", argv[0], kStandinOptions);
+            return 2;
+        }
+    }
+
+    StandinApi api(config);
+    StandinServer server;
+    std::string error;
+    if (!server.start([&api](const HttpRequest& request) { return api.handle(request); }, &error, port)) {
+        fprintf(stderr, "cannot serve on port %d: %s\n", port, error.c_str());
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("stand-in listening on http://127.0.0.1:%d\n", server.port());
+    fflush(stdout);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (duration_s > 0.0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= duration_s) break;
+    }
+    server.stop();
+
+    const StandinCounters counters = api.counters();
+    printf("served %llu requests: %llu chat, %llu transcriptions, %llu searches, %llu not found; "
+           "injected %llu failures, %llu cut streams\n",
+           static_cast<unsigned long long>(server.requests()), static_cast<unsigned long long>(counters.chat),
+           static_cast<unsigned long long>(counters.transcriptions),
+           static_cast<unsigned long long>(counters.searches), static_cast<unsigned long long>(counters.not_found),
+           static_cast<unsigned long long>(counters.failures), static_cast<unsigned long long>(counters.cuts));
+    return 0;
+}
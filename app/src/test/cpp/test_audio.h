@@ -0,0 +1,86 @@
+/**
+ * test_audio.h - Synthetic audio for native host tests
+ *
+ * Deterministic tones, noise and a crude voiced "speech" signal (harmonic
+ * source with a syllable envelope) so tests do not need recorded clips.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace assistant {
+namespace testing {
+
+inline void append_tone(std::vector<int16_t>& pcm, int32_t sample_rate, float hz,
+                        float amplitude, int32_t ms) {
+    const size_t n = static_cast<size_t>(sample_rate) * ms / 1000;
+    const size_t offset = pcm.size();
+    for (size_t i = 0; i < n; ++i) {
+        const float s = amplitude * std::sin(2.0f * static_cast<float>(M_PI) * hz * (offset + i) / sample_rate);
+        pcm.push_back(static_cast<int16_t>(s * 32767.0f));
+    }
+}
+
+inline void append_noise(std::vector<int16_t>& pcm, int32_t sample_rate, float amplitude,
+                         int32_t ms, std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, amplitude);
+    const size_t n = static_cast<size_t>(sample_rate) * ms / 1000;
+    for (size_t i = 0; i < n; ++i) {
+        const float s = std::max(-1.0f, std::min(1.0f, dist(rng)));
+        pcm.push_back(static_cast<int16_t>(s * 32767.0f));
+    }
+}
+
+inline void append_silence(std::vector<int16_t>& pcm, int32_t sample_rate, int32_t ms) {
+    pcm.insert(pcm.end(), static_cast<size_t>(sample_rate) * ms / 1000, 0);
+}
+
+/** Mix `other` into `pcm` starting at `offset` samples, with saturation. */
+inline void mix_into(std::vector<int16_t>& pcm, const std::vector<int16_t>& other, size_t offset) {
+    for (size_t i = 0; i < other.size() && offset + i < pcm.size(); ++i) {
+        const int32_t s = pcm[offset + i] + other[i];
+        pcm[offset + i] = static_cast<int16_t>(std::max(-32768, std::min(32767, s)));
+    }
+}
+
+/**
+ * Voiced speech stand-in: 120-180 Hz harmonic series with formant-like
+ * emphasis, chopped into ~220 ms syllables separated by short gaps.
+ */
+inline void append_speech(std::vector<int16_t>& pcm, int32_t sample_rate, float amplitude,
+                          int32_t ms, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pitch(120.0f, 180.0f);
+    std::uniform_int_distribution<int> syllable_ms(160, 280);
+    std::uniform_int_distribution<int> gap_ms(30, 90);
+    const size_t total = static_cast<size_t>(sample_rate) * ms / 1000;
+    const size_t start = pcm.size();
+    float phase = 0.0f;
+    while (pcm.size() - start < total) {
+        const float f0 = pitch(rng);
+        const size_t n = std::min(total - (pcm.size() - start),
+                                  static_cast<size_t>(sample_rate) * syllable_ms(rng) / 1000);
+        for (size_t i = 0; i < n; ++i) {
+            const float env = std::sin(static_cast<float>(M_PI) * i / n);
+            phase += 2.0f * static_cast<float>(M_PI) * f0 / sample_rate;
+            float s = 0.0f;
+            for (int h = 1; h * f0 < 3500.0f; ++h) {
+                const float hz = h * f0;
+                const float formant = 1.0f / (1.0f + std::fabs(hz - 700.0f) / 300.0f) +
+                                      0.5f / (1.0f + std::fabs(hz - 1800.0f) / 400.0f);
+                s += formant * std::sin(h * phase) / h;
+            }
+            pcm.push_back(static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, amplitude * env * s)) * 32767.0f));
+        }
+        const size_t gap = std::min(total - (pcm.size() - start),
+                                    static_cast<size_t>(sample_rate) * gap_ms(rng) / 1000);
+        pcm.insert(pcm.end(), gap, 0);
+    }
+}
+
+} // namespace testing
+} // namespace assistant
@@ -0,0 +1,51 @@
+/**
+ * thread_priority_test.cpp - CPU selection and the interactive priority scope
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/resource.h>
+
+#include <thread>
+#include <vector>
+
+#include "thread_priority.h"
+
+using namespace assistant;
+
+TEST(ThreadPriority, SelectsFastClusters) {
+    // 4 little @ 1.8 GHz, 3 mid @ 2.4 GHz, 1 prime @ 3.0 GHz
+    const std::vector<int64_t> freqs = {1800000, 1800000, 1800000, 1800000, 2400000, 2400000, 2400000, 3000000};
+    EXPECT_EQ(select_fast_cpus(freqs), (std::vector<int32_t>{4, 5, 6, 7}));
+
+    EXPECT_EQ(select_fast_cpus({0, 0, 0}), (std::vector<int32_t>{0, 1, 2}));
+    EXPECT_EQ(select_fast_cpus({2000000, 2000000}), (std::vector<int32_t>{0, 1}));
+    EXPECT_FALSE(fast_cpus().empty());
+}
+
+TEST(ThreadPriority, InteractiveScopeIsInheritedAndRestored) {
+    // On a thread of its own, so the test runner's priority is never touched
+    std::thread([] {
+        const int before = getpriority(PRIO_PROCESS, 0);
+        cpu_set_t cpus_before;
+        ASSERT_EQ(sched_getaffinity(0, sizeof(cpus_before), &cpus_before), 0);
+        {
+            InteractiveScope scope;
+            const int inside = getpriority(PRIO_PROCESS, 0);
+            if (scope.raised()) {
+                EXPECT_EQ(inside, kInteractiveNice);
+            } else {
+                EXPECT_EQ(inside, before);    // not permitted here, or already as high
+            }
+
+            // A thread started inside the scope, like a whisper graph worker, runs at its priority
+            int worker = 0;
+            std::thread([&worker] { worker = getpriority(PRIO_PROCESS, 0); }).join();
+            EXPECT_EQ(worker, inside);
+        }
+        EXPECT_EQ(getpriority(PRIO_PROCESS, 0), before);
+        cpu_set_t cpus_after;
+        ASSERT_EQ(sched_getaffinity(0, sizeof(cpus_after), &cpus_after), 0);
+        EXPECT_TRUE(CPU_EQUAL(&cpus_before, &cpus_after));
+    }).join();
+}
@@ -0,0 +1,142 @@
+/**
+ * tone_speech.h - Tone-coded "speech" and its recognizer for ASR regression runs
+ *
+ * Neither whisper.cpp nor Vosk is available to the host build, so the
+ * golden-corpus suite uses a stand-in with a known answer: every letter is
+ * a short tone burst at its own frequency, words are separated by longer
+ * gaps, and ToneRecognizer decodes the bursts back with a Goertzel bank.
+ * The alphabet covers English, German, Spanish and Russian, so capture,
+ * resampling and preprocessing changes show up in per-language WER/CER and
+ * RTF exactly as they would for a real engine behind the same AsrEngine
+ * interface.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "asr_metrics.h"
+#include "voice_pipeline.h"
+
+namespace assistant {
+namespace testing {
+
+constexpr int32_t kToneSymbolMs = 40;
+constexpr int32_t kToneGapMs = 15;
+constexpr int32_t kToneWordGapMs = 90;
+constexpr float kToneBaseHz = 300.0f;
+constexpr float kToneStepHz = 40.0f;
+
+inline const std::vector<uint32_t>& tone_alphabet() {
+    static const std::vector<uint32_t> alphabet =
+        decode_utf8("abcdefghijklmnopqrstuvwxyz0123456789'äöüßñáéíóú"
+                    "абвгдеёжзийклмнопрстуфхцчшщъыьэюя");
+    return alphabet;
+}
+
+inline float tone_hz(size_t symbol) { return kToneBaseHz + kToneStepHz * static_cast<float>(symbol); }
+
+/** Render the normalized words of `text`; characters outside the alphabet are skipped. */
+inline std::vector<int16_t> render_tone_speech(const std::string& text, int32_t sample_rate, float amplitude) {
+    const auto& alphabet = tone_alphabet();
+    const size_t symbol = static_cast<size_t>(sample_rate) * kToneSymbolMs / 1000;
+    const size_t ramp = static_cast<size_t>(sample_rate) * 5 / 1000;
+    std::vector<int16_t> pcm;
+    pcm.insert(pcm.end(), static_cast<size_t>(sample_rate) * kToneWordGapMs / 1000, 0);
+    for (const std::string& word : normalize_transcript(text)) {
+        for (uint32_t cp : decode_utf8(word)) {
+            const auto it = std::find(alphabet.begin(), alphabet.end(), cp);
+            if (it == alphabet.end()) continue;
+            const float hz = tone_hz(static_cast<size_t>(it - alphabet.begin()));
+            for (size_t i = 0; i < symbol; ++i) {
+                const size_t edge = std::min(i, symbol - 1 - i);
+                const float env = edge < ramp ? 0.5f - 0.5f * std::cos(static_cast<float>(M_PI) * edge / ramp) : 1.0f;
+                const float s = amplitude * env * std::sin(2.0f * static_cast<float>(M_PI) * hz * i / sample_rate);
+                pcm.push_back(static_cast<int16_t>(s * 32767.0f));
+            }
+            pcm.insert(pcm.end(), static_cast<size_t>(sample_rate) * kToneGapMs / 1000, 0);
+        }
+        pcm.insert(pcm.end(), static_cast<size_t>(sample_rate) * kToneWordGapMs / 1000, 0);
+    }
+    return pcm;
+}
+
+/** Decodes render_tone_speech output: energy segmentation, then a windowed Goertzel per burst. */
+class ToneRecognizer : public AsrEngine {
+public:
+    void accept(const int16_t* pcm, size_t n) override { pcm_.insert(pcm_.end(), pcm, pcm + n); }
+
+    std::string finish() override {
+        constexpr int32_t kRate = 16000;
+        constexpr size_t kBlock = kRate * 5 / 1000;
+        const size_t blocks = pcm_.size() / kBlock;
+        std::vector<float> rms(blocks);
+        for (size_t b = 0; b < blocks; ++b) {
+            double sum = 0.0;
+            for (size_t i = 0; i < kBlock; ++i) sum += static_cast<double>(pcm_[b * kBlock + i]) * pcm_[b * kBlock + i];
+            rms[b] = static_cast<float>(std::sqrt(sum / kBlock));
+        }
+        if (blocks == 0) return "";
+        std::vector<float> sorted = rms;
+        std::sort(sorted.begin(), sorted.end());
+        const float floor = sorted[blocks / 5];
+        const float peak = sorted[blocks - 1 - blocks / 50];
+        const float threshold = std::max(floor * 1.4f, std::sqrt(std::max(floor, 1.0f) * peak));
+
+        std::vector<uint32_t> text;
+        size_t b = 0;
+        size_t last_end = 0;
+        while (b < blocks) {
+            if (rms[b] < threshold) {
+                ++b;
+                continue;
+            }
+            const size_t start = b;
+            while (b < blocks && rms[b] >= threshold) ++b;
+            if ((b - start) * 5 < kToneSymbolMs / 2) continue;     // clicks and noise bursts
+            if (!text.empty() && (start - last_end) * 5 >= (kToneGapMs + kToneWordGapMs) / 2) text.push_back(' ');
+            text.push_back(classify(start * kBlock, b * kBlock));
+            last_end = b;
+        }
+        pcm_.clear();
+        return encode_utf8(text);
+    }
+
+    void reset() override { pcm_.clear(); }
+
+private:
+    uint32_t classify(size_t begin, size_t end) const {
+        constexpr float kRate = 16000.0f;
+        const auto& alphabet = tone_alphabet();
+        const size_t n = end - begin;
+        size_t best = 0;
+        double best_power = -1.0;
+        for (size_t s = 0; s < alphabet.size(); ++s) {
+            const double w = 2.0 * M_PI * tone_hz(s) / kRate;
+            const double coeff = 2.0 * std::cos(w);
+            double s1 = 0.0;
+            double s2 = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                const double hann = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / (n - 1));
+                const double s0 = hann * pcm_[begin + i] + coeff * s1 - s2;
+                s2 = s1;
+                s1 = s0;
+            }
+            const double power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+            if (power > best_power) {
+                best_power = power;
+                best = s;
+            }
+        }
+        return alphabet[best];
+    }
+
+    std::vector<int16_t> pcm_;
+};
+
+} // namespace testing
+} // namespace assistant
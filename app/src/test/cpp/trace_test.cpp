@@ -0,0 +1,82 @@
+/**
+ * trace_test.cpp - Host Chrome trace recording: nesting, threads, counters, escaping
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "trace.h"
+
+using namespace assistant;
+
+namespace {
+    std::string read_file(const std::string& path) {
+        std::string text;
+        FILE* file = fopen(path.c_str(), "r");
+        if (file == nullptr) return text;
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, n);
+        fclose(file);
+        return text;
+    }
+
+    size_t count(const std::string& text, const std::string& needle) {
+        size_t n = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) ++n;
+        return n;
+    }
+}
+
+TEST(Trace, IdleSectionsRecordNothing) {
+    EXPECT_FALSE(trace_enabled());
+    {
+        TRACE_SCOPE("idle");
+    }
+    EXPECT_EQ(trace_stop(), 0u);
+}
+
+TEST(Trace, WritesNestedSectionsAsChromeJson) {
+    const std::string path = ::testing::TempDir() + "trace_nested.json";
+    ASSERT_TRUE(trace_start(path.c_str()));
+    EXPECT_TRUE(trace_enabled());
+    {
+        TRACE_SCOPE("whisper.full");
+        {
+            TRACE_SCOPE("whisper.encode");
+        }
+        TRACE_SCOPE("whisper.decode");
+        trace_counter("queue", 3);
+    }
+    std::thread([] { TRACE_SCOPE("worker"); }).join();
+    EXPECT_EQ(trace_stop(), 9u);
+    EXPECT_FALSE(trace_enabled());
+
+    const std::string json = read_file(path);
+    ASSERT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"displayTimeUnit\":\"ms\""), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), 4u);
+    EXPECT_EQ(count(json, "\"ph\":\"E\""), 4u);
+    EXPECT_NE(json.find("\"name\":\"queue\",\"args\":{\"queue\":3}"), std::string::npos);
+    // Begins come in program order, the encode section inside the full one
+    const size_t full = json.find("whisper.full");
+    const size_t encode = json.find("whisper.encode");
+    const size_t decode = json.find("whisper.decode");
+    ASSERT_NE(full, std::string::npos);
+    EXPECT_LT(full, encode);
+    EXPECT_LT(encode, decode);
+    EXPECT_NE(json.find("\"worker\""), std::string::npos);
+}
+
+TEST(Trace, EscapesNames) {
+    const std::string path = ::testing::TempDir() + "trace_escape.json";
+    ASSERT_TRUE(trace_start(path.c_str()));
+    {
+        TRACE_SCOPE("say \"hi\"\\\n");
+    }
+    EXPECT_EQ(trace_stop(), 2u);
+    EXPECT_NE(read_file(path).find("\"say \\\"hi\\\"\\\\\\u000a\""), std::string::npos);
+}
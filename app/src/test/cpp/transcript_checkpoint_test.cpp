@@ -0,0 +1,197 @@
+/**
+ * transcript_checkpoint_test.cpp - Journal round trip, torn writes, damage and foreign keys
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "transcript_checkpoint.h"
+
+using namespace assistant;
+
+namespace {
+    std::string temp_path(const std::string& name) {
+        const std::string path = ::testing::TempDir() + "transcript_checkpoint_" + name;
+        unlink(path.c_str());
+        return path;
+    }
+
+    std::vector<uint8_t> read_bytes(const std::string& path) {
+        std::vector<uint8_t> bytes;
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return bytes;
+        uint8_t buffer[4096];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + got);
+        fclose(file);
+        return bytes;
+    }
+
+    void write_bytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+        FILE* file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        fclose(file);
+    }
+
+    std::vector<TranscriptSegment> window_segments(int window) {
+        const int64_t start = window * 30000;
+        return {
+            {start, start + 12000, " the weather tomorrow " + std::to_string(window)},
+            {start + 12000, start + 30000, " will be sunny\tand warm"},
+        };
+    }
+
+    std::vector<int32_t> window_prompt(int window) {
+        std::vector<int32_t> prompt;
+        for (int i = 0; i <= window; ++i) prompt.push_back(100 * window + i);
+        return prompt;
+    }
+
+    /** A journal at `path` with `windows` windows of 30 s, optionally marked complete. */
+    void write_journal(const std::string& path, const std::string& key, int windows, bool complete) {
+        auto checkpoint = TranscriptCheckpoint::open(path.c_str(), key, nullptr);
+        ASSERT_NE(checkpoint, nullptr);
+        for (int w = 0; w < windows; ++w) {
+            const auto segments = window_segments(w);
+            ASSERT_TRUE(checkpoint->append((w + 1) * 480000LL, window_prompt(w), segments.data(), segments.size()));
+        }
+        if (complete) {
+            ASSERT_TRUE(checkpoint->finish());
+        }
+    }
+}
+
+TEST(TranscriptCheckpoint, NewJournalStartsEmpty) {
+    const std::string path = temp_path("new");
+    TranscriptProgress progress;
+    progress.position = 7;
+    auto checkpoint = TranscriptCheckpoint::open(path.c_str(), "job", &progress);
+    ASSERT_NE(checkpoint, nullptr);
+    EXPECT_EQ(progress.position, 0);
+    EXPECT_EQ(progress.windows, 0u);
+    EXPECT_TRUE(progress.segments.empty());
+    EXPECT_TRUE(progress.prompt.empty());
+    EXPECT_FALSE(progress.complete);
+}
+
+TEST(TranscriptCheckpoint, RestoresEveryWindow) {
+    const std::string path = temp_path("restore");
+    write_journal(path, "job", 3, false);
+
+    TranscriptProgress progress;
+    auto checkpoint = TranscriptCheckpoint::open(path.c_str(), "job", &progress);
+    ASSERT_NE(checkpoint, nullptr);
+    EXPECT_EQ(progress.windows, 3u);
+    EXPECT_EQ(progress.position, 3 * 480000LL);
+    EXPECT_EQ(progress.prompt, window_prompt(2));
+    EXPECT_FALSE(progress.complete);
+    ASSERT_EQ(progress.segments.size(), 6u);
+    for (int w = 0; w < 3; ++w) {
+        const auto expected = window_segments(w);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const TranscriptSegment& got = progress.segments[static_cast<size_t>(w) * 2 + i];
+            EXPECT_EQ(got.t0_ms, expected[i].t0_ms);
+            EXPECT_EQ(got.t1_ms, expected[i].t1_ms);
+            EXPECT_EQ(got.text, expected[i].text);
+        }
+    }
+
+    // Appending after a restore continues the same journal
+    const auto segments = window_segments(3);
+    ASSERT_TRUE(checkpoint->append(4 * 480000LL, window_prompt(3), segments.data(), segments.size()));
+    ASSERT_TRUE(checkpoint->finish());
+    checkpoint.reset();
+    ASSERT_NE(TranscriptCheckpoint::open(path.c_str(), "job", &progress), nullptr);
+    EXPECT_EQ(progress.windows, 4u);
+    EXPECT_EQ(progress.segments.size(), 8u);
+    EXPECT_TRUE(progress.complete);
+}
+
+TEST(TranscriptCheckpoint, TornTailIsDroppedAndOverwritten) {
+    const std::string path = temp_path("torn");
+    write_journal(path, "job", 2, false);
+    const std::vector<uint8_t> two = read_bytes(path);
+    write_journal(path, "job", 0, false);   // reopen only
+    {
+        auto checkpoint = TranscriptCheckpoint::open(path.c_str(), "job", nullptr);
+        const auto segments = window_segments(2);
+        ASSERT_TRUE(checkpoint->append(3 * 480000LL, window_prompt(2), segments.data(), segments.size()));
+    }
+    const std::vector<uint8_t> three = read_bytes(path);
+    ASSERT_GT(three.size(), two.size());
+
+    // Every cut inside the third record loses that window and nothing else
+    for (size_t cut = two.size() + 1; cut < three.size(); cut += 7) {
+        write_bytes(path, std::vector<uint8_t>(three.begin(), three.begin() + static_cast<std::ptrdiff_t>(cut)));
+        TranscriptProgress progress;
+        auto checkpoint = TranscriptCheckpoint::open(path.c_str(), "job", &progress);
+        ASSERT_NE(checkpoint, nullptr);
+        EXPECT_EQ(progress.windows, 2u) << "cut at " << cut;
+        EXPECT_EQ(progress.position, 2 * 480000LL);
+        EXPECT_EQ(progress.prompt, window_prompt(1));
+        EXPECT_EQ(read_bytes(path), two) << "torn record not cut off at " << cut;
+
+        const auto segments = window_segments(2);
+        ASSERT_TRUE(checkpoint->append(3 * 480000LL, window_prompt(2), segments.data(), segments.size()));
+        EXPECT_EQ(read_bytes(path), three);
+    }
+}
+
+TEST(TranscriptCheckpoint, DamagedRecordEndsTheJournal) {
+    const std::string path = temp_path("damaged");
+    write_journal(path, "job", 3, true);
+    std::vector<uint8_t> bytes = read_bytes(path);
+
+    // Flip a byte inside the second window's text: its CRC fails, so the journal ends after the first
+    const std::string marker = " the weather tomorrow 1";
+    const auto at = std::search(bytes.begin(), bytes.end(), marker.begin(), marker.end());
+    ASSERT_NE(at, bytes.end());
+    *(at + 5) ^= 0x20;
+    write_bytes(path, bytes);
+
+    TranscriptProgress progress;
+    ASSERT_NE(TranscriptCheckpoint::open(path.c_str(), "job", &progress), nullptr);
+    EXPECT_EQ(progress.windows, 1u);
+    EXPECT_EQ(progress.position, 480000LL);
+    EXPECT_FALSE(progress.complete);
+}
+
+TEST(TranscriptCheckpoint, AnotherKeyStartsOver) {
+    const std::string path = temp_path("key");
+    write_journal(path, "audio=a.flac\nsize=100", 2, true);
+
+    TranscriptProgress progress;
+    ASSERT_NE(TranscriptCheckpoint::open(path.c_str(), "audio=a.flac\nsize=101", &progress), nullptr);
+    EXPECT_EQ(progress.windows, 0u);
+    EXPECT_FALSE(progress.complete);
+    // The old journal is gone for good, not just hidden
+    ASSERT_NE(TranscriptCheckpoint::open(path.c_str(), "audio=a.flac\nsize=100", &progress), nullptr);
+    EXPECT_EQ(progress.windows, 0u);
+}
+
+TEST(TranscriptCheckpoint, GarbageFileStartsOver) {
+    const std::string path = temp_path("garbage");
+    write_bytes(path, std::vector<uint8_t>(1000, 0xA5));
+    TranscriptProgress progress;
+    auto checkpoint = TranscriptCheckpoint::open(path.c_str(), "job", &progress);
+    ASSERT_NE(checkpoint, nullptr);
+    EXPECT_EQ(progress.windows, 0u);
+    const auto segments = window_segments(0);
+    ASSERT_TRUE(checkpoint->append(480000LL, window_prompt(0), segments.data(), segments.size()));
+    checkpoint.reset();
+    ASSERT_NE(TranscriptCheckpoint::open(path.c_str(), "job", &progress), nullptr);
+    EXPECT_EQ(progress.windows, 1u);
+}
+
+TEST(TranscriptCheckpoint, UnwritablePathIsAnError) {
+    std::string error;
+    EXPECT_EQ(TranscriptCheckpoint::open("/nonexistent-dir/checkpoint", "job", nullptr, &error), nullptr);
+    EXPECT_FALSE(error.empty());
+}
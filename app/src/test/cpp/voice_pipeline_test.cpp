@@ -0,0 +1,258 @@
+/**
+ * voice_pipeline_test.cpp - Spec parsing, stage chaining and file-driven runs
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_audio.h"
+#include "voice_pipeline.h"
+#include "wav_io.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+
+    std::vector<int16_t> capture(int32_t total_ms, int32_t speech_at_ms, int32_t speech_ms, uint32_t seed = 1) {
+        std::mt19937 rng(seed);
+        std::vector<int16_t> pcm;
+        append_noise(pcm, kRate, 0.003f, total_ms, rng);
+        std::vector<int16_t> speech;
+        append_speech(speech, kRate, 0.3f, speech_ms, rng);
+        mix_into(pcm, speech, static_cast<size_t>(kRate) * speech_at_ms / 1000);
+        return pcm;
+    }
+
+    /** Records everything it is fed; stands in for a recognizer. */
+    class RecordingEngine : public AsrEngine {
+    public:
+        explicit RecordingEngine(std::vector<int16_t>* sink) : sink_(sink) {}
+        void accept(const int16_t* pcm, size_t n) override { sink_->insert(sink_->end(), pcm, pcm + n); }
+        std::string finish() override { return "heard " + std::to_string(sink_->size()); }
+
+    private:
+        std::vector<int16_t>* sink_;
+    };
+
+    /** Remembers the address of every frame buffer it is handed. */
+    class AddressStage : public Stage {
+    public:
+        explicit AddressStage(std::vector<const int16_t*>* seen) : seen_(seen) {}
+        bool process(AudioFrame& frame, PipelineContext&) override {
+            seen_->push_back(frame.pcm);
+            return true;
+        }
+
+    private:
+        std::vector<const int16_t*>* seen_;
+    };
+
+    std::vector<PipelineEvent> events(VoicePipeline& pipeline) {
+        std::vector<PipelineEvent> out;
+        pipeline.poll_events(out);
+        return out;
+    }
+}
+
+TEST(VoicePipeline, ParsesSpec) {
+    std::vector<StageSpec> specs;
+    std::string error;
+    ASSERT_TRUE(parse_pipeline_spec("highpass cutoff_hz=100 |gain db=-3|  vad hangover_ms=700 stop=0 | tap",
+                                    specs, &error)) << error;
+    ASSERT_EQ(specs.size(), 4u);
+    EXPECT_EQ(specs[0].name, "highpass");
+    EXPECT_FLOAT_EQ(specs[0].params.get_float("cutoff_hz", 0.0f), 100.0f);
+    EXPECT_FLOAT_EQ(specs[1].params.get_float("db", 0.0f), -3.0f);
+    EXPECT_EQ(specs[2].params.get_int("hangover_ms", 0), 700);
+    EXPECT_EQ(specs[2].params.get_int("stop", 1), 0);
+    EXPECT_EQ(specs[3].name, "tap");
+    EXPECT_TRUE(specs[3].params.values().empty());
+}
+
+TEST(VoicePipeline, RejectsMalformedSpec) {
+    std::vector<StageSpec> specs;
+    std::string error;
+    EXPECT_FALSE(parse_pipeline_spec("highpass | | tap", specs, &error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(parse_pipeline_spec("gain 6", specs, &error));
+    EXPECT_FALSE(parse_pipeline_spec("", specs, &error));
+
+    VoicePipeline pipeline;
+    error.clear();
+    EXPECT_FALSE(pipeline.build("highpass | reverb", StageRegistry::with_builtins(), PipelineOptions(), &error));
+    EXPECT_NE(error.find("reverb"), std::string::npos);
+    error.clear();
+    EXPECT_FALSE(pipeline.build("wav", StageRegistry::with_builtins(), PipelineOptions(), &error));
+    EXPECT_NE(error.find("path"), std::string::npos);
+}
+
+TEST(VoicePipeline, FramesPassInPlaceWithoutPoolMisses) {
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("highpass | gain db=0", StageRegistry::with_builtins(), PipelineOptions(), &error));
+    std::vector<const int16_t*> first, last;
+    pipeline.append("first", std::unique_ptr<Stage>(new AddressStage(&first)), &error);
+    ASSERT_TRUE(pipeline.append("last", std::unique_ptr<Stage>(new AddressStage(&last)), &error)) << error;
+
+    const auto pcm = capture(1000, 100, 500);
+    // Odd chunk sizes: input framing must not depend on the caller's reads
+    for (size_t i = 0; i < pcm.size(); i += 137) {
+        pipeline.push(pcm.data() + i, std::min<size_t>(137, pcm.size() - i));
+    }
+    pipeline.finish();
+
+    ASSERT_EQ(first.size(), 50u);
+    EXPECT_EQ(first, last);
+    EXPECT_EQ(pipeline.pool_misses(), 0u);
+    for (const StageStats& stats : pipeline.stats()) {
+        EXPECT_EQ(stats.frames, 50u) << stats.name;
+        EXPECT_EQ(stats.samples, pcm.size()) << stats.name;
+        EXPECT_EQ(stats.dropped, 0u) << stats.name;
+    }
+    EXPECT_NE(pipeline.format_stats().find("highpass"), std::string::npos);
+}
+
+TEST(VoicePipeline, VadEmitsEventsAndStops) {
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("highpass | vad hangover_ms=600 | tap", StageRegistry::with_builtins(),
+                               PipelineOptions(), &error)) << error;
+    BufferSource source(capture(6000, 500, 2000), kRate);
+    pipeline.run(source);
+
+    EXPECT_TRUE(pipeline.stopped());
+    const auto got = events(pipeline);
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(got[0].type, PIPELINE_SPEECH_START);
+    EXPECT_NEAR(static_cast<double>(got[0].position), 500.0 * kRate / 1000, 0.15 * kRate);
+    EXPECT_EQ(got[1].type, PIPELINE_SPEECH_END);
+    EXPECT_GE(got[1].delay_ms, 600);
+    // Stopped roughly one hangover after speech, well before the end of the clip
+    EXPECT_LT(got[1].position, static_cast<int64_t>(kRate) * 3300 / 1000);
+
+    std::vector<int16_t> out(static_cast<size_t>(kRate) * 6);
+    const size_t n = pipeline.read_output(out.data(), out.size());
+    EXPECT_EQ(static_cast<int64_t>(n), got[1].position + static_cast<int64_t>(pipeline.frame_samples()));
+    EXPECT_FALSE(pipeline.push(out.data(), 320));
+}
+
+TEST(VoicePipeline, VadReportsNoSpeech) {
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("vad leading_timeout_ms=1000", StageRegistry::with_builtins(),
+                               PipelineOptions(), &error)) << error;
+    BufferSource source(capture(3000, 0, 0), kRate);
+    pipeline.run(source);
+
+    const auto got = events(pipeline);
+    ASSERT_EQ(got.size(), 1u);
+    EXPECT_EQ(got[0].type, PIPELINE_NO_SPEECH);
+}
+
+TEST(VoicePipeline, EngineSeesEveryResampledSample) {
+    std::vector<int16_t> heard;
+    VoicePipeline pipeline;
+    PipelineOptions options;
+    options.sample_rate = 48000;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("highpass | resample rate=16000", StageRegistry::with_builtins(), options, &error));
+    ASSERT_EQ(pipeline.output_rate(), 16000);
+    ASSERT_TRUE(pipeline.append("engine", make_engine_stage(std::unique_ptr<AsrEngine>(new RecordingEngine(&heard))),
+                                &error)) << error;
+
+    std::vector<int16_t> pcm;
+    append_tone(pcm, 48000, 440.0f, 0.3f, 1000);
+    BufferSource source(pcm, 48000);
+    pipeline.run(source);
+
+    EXPECT_NEAR(static_cast<double>(heard.size()), 16000.0, 64.0);
+    const auto got = events(pipeline);
+    ASSERT_EQ(got.size(), 1u);
+    EXPECT_EQ(got[0].type, PIPELINE_RESULT);
+    EXPECT_EQ(got[0].text, "heard " + std::to_string(heard.size()));
+}
+
+TEST(VoicePipeline, EngineRateMismatchFailsToBuild) {
+    VoicePipeline pipeline;
+    PipelineOptions options;
+    options.sample_rate = 8000;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("highpass", StageRegistry::with_builtins(), options, &error));
+    std::vector<int16_t> heard;
+    EXPECT_FALSE(pipeline.append("engine", make_engine_stage(std::unique_ptr<AsrEngine>(new RecordingEngine(&heard))),
+                                 &error));
+    EXPECT_NE(error.find("8000"), std::string::npos);
+}
+
+TEST(VoicePipeline, RunsFromWavFileAndWritesWav) {
+    const std::string in_path = ::testing::TempDir() + "pipeline_in.wav";
+    const std::string out_path = ::testing::TempDir() + "pipeline_out.wav";
+    const auto pcm = capture(2000, 300, 1000);
+    ASSERT_TRUE(write_wav_mono16(in_path, pcm.data(), pcm.size(), kRate));
+
+    WavFileSource source;
+    ASSERT_TRUE(source.open(in_path));
+    VoicePipeline pipeline;
+    PipelineOptions options;
+    options.sample_rate = source.sample_rate();
+    std::string error;
+    ASSERT_TRUE(pipeline.build("gain db=-6 | wav path=" + out_path, StageRegistry::with_builtins(), options, &error))
+        << error;
+    pipeline.run(source);
+
+    std::vector<int16_t> out;
+    int32_t rate = 0;
+    ASSERT_TRUE(read_wav_mono16(out_path, out, &rate));
+    EXPECT_EQ(rate, kRate);
+    ASSERT_EQ(out.size(), pcm.size());
+    for (size_t i = 0; i < pcm.size(); i += 997) {
+        EXPECT_NEAR(out[i], pcm[i] * 0.50119f, 1.0f);
+    }
+    std::remove(in_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+TEST(VoicePipeline, CustomStagesRegisterByName) {
+    std::vector<int16_t> heard;
+    StageRegistry registry = StageRegistry::with_builtins();
+    registry.add("recorder", [&heard](const StageParams&, std::string*) {
+        return make_engine_stage(std::unique_ptr<AsrEngine>(new RecordingEngine(&heard)));
+    });
+    EXPECT_TRUE(registry.contains("recorder"));
+
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("highpass | recorder", registry, PipelineOptions(), &error)) << error;
+    const auto pcm = capture(1000, 100, 500);
+    pipeline.push(pcm.data(), pcm.size());
+    pipeline.finish();
+    EXPECT_EQ(heard.size(), pcm.size());
+
+    pipeline.reset();
+    heard.clear();
+    pipeline.push(pcm.data(), 500);
+    pipeline.finish();
+    EXPECT_EQ(heard.size(), 500u);
+    EXPECT_EQ(pipeline.stats()[0].samples, 500u);
+}
+
+TEST(VoicePipeline, TapKeepsNewestAudioWhenFull) {
+    VoicePipeline pipeline;
+    std::string error;
+    ASSERT_TRUE(pipeline.build("tap seconds=0.1", StageRegistry::with_builtins(), PipelineOptions(), &error));
+    std::vector<int16_t> pcm(kRate / 2);
+    for (size_t i = 0; i < pcm.size(); ++i) pcm[i] = static_cast<int16_t>(i);
+    pipeline.push(pcm.data(), pcm.size());
+
+    std::vector<int16_t> out(kRate);
+    const size_t n = pipeline.read_output(out.data(), out.size());
+    ASSERT_EQ(n, static_cast<size_t>(kRate / 10));
+    EXPECT_EQ(out[n - 1], pcm.back());
+    EXPECT_EQ(pipeline.read_output(out.data(), out.size()), 0u);
+}
@@ -0,0 +1,102 @@
+/**
+ * wake_word_bench.cpp - Wake word CPU cost on the build machine
+ *
+ * Times the int8 DS-CNN inference and the feature front-end separately,
+ * then runs the full detector over noise (every window inferred) and
+ * silence (energy gate engaged) and reports the cost as a percentage of
+ * one core in real time.
+ *
+ * Usage: wake_word_bench [--iterations N] [--seconds S]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "int8_kernels.h"
+#include "kws_test_models.h"
+#include "wake_word.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    double run_detector(const KwsModel& model, const std::vector<int16_t>& pcm, WakeWordStats& stats) {
+        WakeWordDetector detector;
+        if (!detector.init(model, WakeWordConfig{})) exit(1);
+        const auto start = Clock::now();
+        for (size_t i = 0; i < pcm.size(); i += 320) {
+            detector.process(pcm.data() + i, std::min<size_t>(320, pcm.size() - i));
+        }
+        const double elapsed = seconds_since(start);
+        stats = detector.stats();
+        return elapsed;
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = 2000;
+    int seconds = 60;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atoi(argv[++i]);
+    }
+
+    const KwsModel model = make_ds_cnn_model();
+    KwsNetwork network;
+    if (!network.init(model)) return 1;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-127, 127);
+    std::vector<int8_t> input(static_cast<size_t>(model.input_frames) * model.input_dim);
+    for (int8_t& x : input) x = static_cast<int8_t>(dist(rng));
+
+    float sink = 0.0f;
+    for (int i = 0; i < 10; ++i) sink += network.infer(input.data())[0];
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) sink += network.infer(input.data())[0];
+    const double infer_us = seconds_since(start) * 1e6 / iterations;
+
+    std::vector<int16_t> noise;
+    append_noise(noise, model.features.sample_rate, 0.05f, seconds * 1000, rng);
+    std::vector<int16_t> silence;
+    append_silence(silence, model.features.sample_rate, seconds * 1000);
+
+    FeatureFrontend frontend(model.features);
+    int64_t hops = 0;
+    start = Clock::now();
+    frontend.push(noise.data(), noise.size(), [&](const float* f, float) { sink += f[0]; hops++; });
+    const double feature_us = seconds_since(start) * 1e6 / std::max<int64_t>(1, hops);
+
+    WakeWordStats noise_stats, silence_stats;
+    const double noise_elapsed = run_detector(model, noise, noise_stats);
+    const double silence_elapsed = run_detector(model, silence, silence_stats);
+
+    const double hop_us = model.features.hop_ms * 1000.0;
+    const double stride = WakeWordConfig{}.inference_stride;
+    printf("kernels: %s, model: DS-CNN %d x %d, %.2f M MACs\n", int8::kernel_name(),
+           model.input_frames, model.input_dim, network.macs_per_inference() / 1e6);
+    printf("inference: %.1f us (%.2f GMAC/s)\n", infer_us,
+           network.macs_per_inference() / infer_us / 1e3);
+    printf("features:  %.2f us per %d ms hop\n", feature_us, model.features.hop_ms);
+    printf("estimate:  %.3f%% of one core (inference every %.0f hops)\n",
+           (feature_us / hop_us + infer_us / (stride * hop_us)) * 100.0, stride);
+    printf("detector, noise:   %.3f%% of one core (%llu inferences, %llu gated)\n",
+           noise_elapsed / seconds * 100.0,
+           static_cast<unsigned long long>(noise_stats.inferences),
+           static_cast<unsigned long long>(noise_stats.gated));
+    printf("detector, silence: %.3f%% of one core (%llu inferences, %llu gated)\n",
+           silence_elapsed / seconds * 100.0,
+           static_cast<unsigned long long>(silence_stats.inferences),
+           static_cast<unsigned long long>(silence_stats.gated));
+    return sink == 12345.0f ? 1 : 0;
+}
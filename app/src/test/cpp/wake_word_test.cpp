@@ -0,0 +1,187 @@
+/**
+ * wake_word_test.cpp - Model format, network execution and detector behaviour
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "kws_test_models.h"
+#include "wake_word.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kRate = 16000;
+
+    int32_t feed(WakeWordDetector& detector, const std::vector<int16_t>& pcm, size_t chunk = 320) {
+        int32_t detections = 0;
+        for (size_t i = 0; i < pcm.size(); i += chunk) {
+            detections += detector.process(pcm.data() + i, std::min(chunk, pcm.size() - i));
+        }
+        return detections;
+    }
+}
+
+TEST(KwsModel, SerializeRoundTrip) {
+    const KwsModel model = make_ds_cnn_model();
+    const std::vector<uint8_t> bytes = model.serialize();
+
+    KwsModel parsed;
+    ASSERT_TRUE(parsed.parse(bytes.data(), bytes.size()));
+    EXPECT_EQ(parsed.input_frames, model.input_frames);
+    EXPECT_EQ(parsed.features.n_mfcc, model.features.n_mfcc);
+    ASSERT_EQ(parsed.layers.size(), model.layers.size());
+    for (size_t i = 0; i < model.layers.size(); ++i) {
+        EXPECT_EQ(parsed.layers[i].type, model.layers[i].type);
+        EXPECT_EQ(parsed.layers[i].weights, model.layers[i].weights);
+        EXPECT_EQ(parsed.layers[i].bias, model.layers[i].bias);
+        EXPECT_FLOAT_EQ(parsed.layers[i].out_scale, model.layers[i].out_scale);
+    }
+    EXPECT_EQ(parsed.serialize(), bytes);
+}
+
+TEST(KwsModel, RejectsTruncatedAndForeignData) {
+    const std::vector<uint8_t> bytes = make_tone_model().serialize();
+    KwsModel parsed;
+    EXPECT_FALSE(parsed.parse(bytes.data(), bytes.size() - 3));
+    EXPECT_FALSE(parsed.parse(bytes.data(), 10));
+    const uint8_t junk[] = "RIFF....WAVE";
+    EXPECT_FALSE(parsed.parse(junk, sizeof(junk)));
+}
+
+TEST(KwsModel, RejectsInvalidScales) {
+    const float bad[] = {0.0f, -0.5f, std::nanf(""), INFINITY};
+    for (const float scale : bad) {
+        for (int field = 0; field < 3; ++field) {
+            KwsModel model = make_tone_model();
+            if (field == 0) model.input_scale = scale;
+            if (field == 1) model.layers[0].weight_scale = scale;
+            if (field == 2) model.layers[0].out_scale = scale;
+            const std::vector<uint8_t> bytes = model.serialize();
+            KwsModel parsed;
+            EXPECT_FALSE(parsed.parse(bytes.data(), bytes.size())) << "field " << field << " scale " << scale;
+        }
+    }
+}
+
+TEST(KwsNetwork, RejectsInconsistentWeights) {
+    KwsModel model = make_ds_cnn_model();
+    model.layers[1].weights.pop_back();
+    KwsNetwork network;
+    EXPECT_FALSE(network.init(model));
+}
+
+TEST(KwsNetwork, DsCnnProducesDistribution) {
+    const KwsModel model = make_ds_cnn_model();
+    KwsNetwork network;
+    ASSERT_TRUE(network.init(model));
+    EXPECT_GT(network.macs_per_inference(), 2000000u);
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(-100, 100);
+    std::vector<int8_t> input(static_cast<size_t>(model.input_frames) * model.input_dim);
+    for (int8_t& x : input) x = static_cast<int8_t>(dist(rng));
+
+    const float* probs = network.infer(input.data());
+    float sum = 0.0f;
+    for (int32_t i = 0; i < network.n_classes(); ++i) {
+        EXPECT_GE(probs[i], 0.0f);
+        sum += probs[i];
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-4f);
+}
+
+TEST(WakeWordDetector, DetectsToneKeywordOnce) {
+    WakeWordDetector detector;
+    ASSERT_TRUE(detector.init(make_tone_model(), WakeWordConfig{}));
+
+    std::mt19937 rng(5);
+    std::vector<int16_t> pcm;
+    append_noise(pcm, kRate, 0.01f, 1500, rng);
+    const size_t onset = pcm.size();
+    append_tone(pcm, kRate, kToneHz, 0.3f, 900);
+    append_noise(pcm, kRate, 0.01f, 1500, rng);
+
+    EXPECT_EQ(feed(detector, pcm), 1);
+    const int64_t at = detector.last_detection().sample_index;
+    EXPECT_GT(at, static_cast<int64_t>(onset));
+    EXPECT_LT(at, static_cast<int64_t>(onset) + kRate);
+    EXPECT_GE(detector.last_detection().score, 0.85f);
+}
+
+TEST(WakeWordDetector, IgnoresNoiseSilenceAndOtherTones) {
+    WakeWordDetector detector;
+    ASSERT_TRUE(detector.init(make_tone_model(), WakeWordConfig{}));
+
+    std::mt19937 rng(9);
+    std::vector<int16_t> pcm;
+    append_silence(pcm, kRate, 2000);
+    append_noise(pcm, kRate, 0.1f, 3000, rng);
+    append_tone(pcm, kRate, 2500.0f, 0.3f, 1000);
+    append_tone(pcm, kRate, 300.0f, 0.3f, 1000);
+    EXPECT_EQ(feed(detector, pcm), 0);
+    EXPECT_GT(detector.stats().inferences, 0u);
+}
+
+TEST(WakeWordDetector, GatesSilence) {
+    WakeWordDetector detector;
+    ASSERT_TRUE(detector.init(make_tone_model(), WakeWordConfig{}));
+    std::vector<int16_t> pcm;
+    append_silence(pcm, kRate, 3000);
+    feed(detector, pcm);
+    EXPECT_EQ(detector.stats().inferences, 0u);
+    EXPECT_GT(detector.stats().gated, 0u);
+}
+
+TEST(WakeWordDetector, RefractoryPeriodSuppressesRepeats) {
+    WakeWordConfig config;
+    config.refractory_ms = 5000;
+    WakeWordDetector detector;
+    ASSERT_TRUE(detector.init(make_tone_model(), config));
+
+    std::vector<int16_t> pcm;
+    append_tone(pcm, kRate, kToneHz, 0.3f, 1000);
+    append_silence(pcm, kRate, 3000);
+    append_tone(pcm, kRate, kToneHz, 0.3f, 1000);
+    EXPECT_EQ(feed(detector, pcm), 1);
+
+    config.refractory_ms = 1500;
+    ASSERT_TRUE(detector.init(make_tone_model(), config));
+    EXPECT_EQ(feed(detector, pcm), 2);
+}
+
+TEST(WakeWordDetector, PrerollHoldsMostRecentAudio) {
+    WakeWordConfig config;
+    config.preroll_ms = 100;
+    WakeWordDetector detector;
+    ASSERT_TRUE(detector.init(make_tone_model(), config));
+    ASSERT_EQ(detector.preroll_capacity(), 1600u);
+
+    std::vector<int16_t> pcm(5000);
+    for (size_t i = 0; i < pcm.size(); ++i) pcm[i] = static_cast<int16_t>(i);
+    feed(detector, pcm, 333);
+
+    std::vector<int16_t> preroll(4000);
+    ASSERT_EQ(detector.copy_preroll(preroll.data(), preroll.size()), 1600u);
+    EXPECT_EQ(preroll.front(), 5000 - 1600);
+    EXPECT_EQ(preroll[1599], 4999);
+}
+
+TEST(WakeWordDetector, ChunkSizeDoesNotChangeResult) {
+    std::mt19937 rng(21);
+    std::vector<int16_t> pcm;
+    append_noise(pcm, kRate, 0.02f, 800, rng);
+    append_tone(pcm, kRate, kToneHz, 0.2f, 900);
+    append_noise(pcm, kRate, 0.02f, 800, rng);
+
+    WakeWordDetector a, b;
+    ASSERT_TRUE(a.init(make_tone_model(), WakeWordConfig{}));
+    ASSERT_TRUE(b.init(make_tone_model(), WakeWordConfig{}));
+    EXPECT_EQ(feed(a, pcm, 160), 1);
+    EXPECT_EQ(feed(b, pcm, 1777), 1);
+    EXPECT_EQ(a.last_detection().sample_index, b.last_detection().sample_index);
+}
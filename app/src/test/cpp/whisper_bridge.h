@@ -0,0 +1,36 @@
+/**
+ * whisper_bridge.h - Entry points of whisper_jni.cpp for host tools
+ *
+ * The bridge only exports JNI functions; these are their declarations, so
+ * host tools can call them the way the VM does, with a host JNIEnv from
+ * host_jni/jni.h. The `this` argument is unused by every entry point.
+ */
+
+#pragma once
+
+#include <jni.h>
+
+#define WHISPER_JNI(name) Java_com_vincent_ai_1integrated_1into_1android_audio_WhisperJNI_##name
+
+extern "C" {
+
+jint WHISPER_JNI(initModel)(JNIEnv* env, jobject self, jstring modelPath);
+jstring WHISPER_JNI(transcribe)(JNIEnv* env, jobject self, jstring audioPath);
+jstring WHISPER_JNI(transcribeWithParams)(JNIEnv* env, jobject self, jstring audioPath, jstring language,
+                                          jboolean translate, jint threads);
+jstring WHISPER_JNI(redecode)(JNIEnv* env, jobject self, jstring language, jboolean translate, jfloat temperature);
+jstring WHISPER_JNI(recognizeCommand)(JNIEnv* env, jobject self, jstring audioPath, jstring grammar);
+jlong WHISPER_JNI(submitFileTranscription)(JNIEnv* env, jobject self, jstring audioPath);
+jlong WHISPER_JNI(submitCheckpointedTranscription)(JNIEnv* env, jobject self, jstring audioPath,
+                                                   jstring checkpointPath);
+jfloat WHISPER_JNI(getJobProgress)(JNIEnv* env, jobject self, jlong jobId);
+jstring WHISPER_JNI(pollFileTranscription)(JNIEnv* env, jobject self, jlong jobId);
+jstring WHISPER_JNI(pollTranscriptSegments)(JNIEnv* env, jobject self, jlong jobId, jint first);
+jboolean WHISPER_JNI(cancelJob)(JNIEnv* env, jobject self, jlong jobId);
+jstring WHISPER_JNI(getSchedulerStats)(JNIEnv* env, jobject self);
+void WHISPER_JNI(setFallbackModel)(JNIEnv* env, jobject self, jstring modelPath);
+jstring WHISPER_JNI(getGovernorStats)(JNIEnv* env, jobject self);
+void WHISPER_JNI(releaseModel)(JNIEnv* env, jobject self);
+jstring WHISPER_JNI(getVersion)(JNIEnv* env, jobject self);
+
+} // extern "C"
@@ -0,0 +1,201 @@
+/**
+ * whisper_bridge_bench.cpp - Overhead of the whisper bridge around the engine
+ *
+ * Runs whisper_jni.cpp against the fake engine with the engine's own cost
+ * set to zero, so everything measured is the bridge: JNI strings, the
+ * scheduler turn, WAV reading, the encoder cache, the decoder loop and
+ * the logits filter. Each row is one kind of call:
+ *
+ *   transcribe (cold)   a clip not seen before: read, hash, encode, collect text
+ *   transcribe (warm)   the same clip again: answered from the encoder cache
+ *   redecode            the cached clip in another language, token by token
+ *   redecode (T=0.5)    the same with temperature sampling
+ *   recognizeCommand    constrained decode through the phrase trie
+ *   poll                getJobProgress + pollFileTranscription on a running job
+ *   preempted (warm)    a warm transcribe while a file job holds the engine,
+ *                       with --file-encode-ms per window: the wait for it to yield
+ *
+ * The last row is the only one that includes engine time; compare it with
+ * the warm row to see what preempting a background job costs a voice query.
+ *
+ * Usage: whisper_bridge_bench [--iterations N] [--seconds S] [--file-encode-ms N] [work_dir]
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "test_audio.h"
+#include "wav_io.h"
+#include "whisper_bridge.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kSampleRate = 16000;
+
+    const char* kGrammar =
+        "camera\topen camera\n"
+        "lights_on\tturn on lights\n"
+        "music\tplay music\n"
+        "timer\tset a timer for ten minutes\n";
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    void report(const char* name, const std::vector<double>& us) {
+        printf("%-20s %7zu %10.1f %10.1f %10.1f\n", name, us.size(), percentile(us, 50.0), percentile(us, 99.0),
+               us.empty() ? 0.0 : *std::max_element(us.begin(), us.end()));
+    }
+
+    template <typename F>
+    double time_us(F&& call) {
+        const auto start = std::chrono::steady_clock::now();
+        call();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string write_model(const std::string& path, int32_t encode_ms) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            exit(2);
+        }
+        fprintf(file, "encode_ms=%d\ndecode_ms_per_token=0\n", encode_ms);
+        fclose(file);
+        return path;
+    }
+
+    std::string write_clip(const std::string& path, int32_t ms, std::mt19937& rng) {
+        std::vector<int16_t> pcm;
+        append_speech(pcm, kSampleRate, 0.3f, ms, rng);
+        if (!write_wav_mono16(path, pcm.data(), pcm.size(), kSampleRate)) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            exit(2);
+        }
+        return path;
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = 200;
+    double seconds = 3.0;
+    int32_t file_encode_ms = 50;
+    std::string dir;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--file-encode-ms") == 0 && i + 1 < argc) file_encode_ms = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && dir.empty()) dir = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--iterations N] [--seconds S] [--file-encode-ms N] [work_dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    iterations = std::max(1, iterations);
+    if (dir.empty()) {
+        char pattern[] = "/tmp/whisper_bridge_bench.XXXXXX";
+        if (mkdtemp(pattern) == nullptr) {
+            perror("mkdtemp");
+            return 2;
+        }
+        dir = pattern;
+    }
+
+    // Distinct clips for the cold path, so every call misses the encoder cache
+    std::mt19937 rng(11);
+    const int32_t clip_ms = static_cast<int32_t>(seconds * 1000.0);
+    std::vector<std::string> clips;
+    for (int i = 0; i < std::min(iterations, 64); ++i) {
+        clips.push_back(write_clip(dir + "/clip_" + std::to_string(i) + ".wav", clip_ms, rng));
+    }
+    const std::string recording = write_clip(dir + "/recording.wav", 5 * 60 * 1000, rng);
+    const std::string model = write_model(dir + "/ggml-fake.bin", 0);
+    const std::string slow_model = write_model(dir + "/ggml-fake-slow.bin", file_encode_ms);
+
+    JNIEnv env;
+    const auto str = [&env](const std::string& text) { return env.NewStringUTF(text.c_str()); };
+    if (WHISPER_JNI(initModel)(&env, nullptr, str(model)) != 0) {
+        fprintf(stderr, "initModel failed\n");
+        return 1;
+    }
+    env.clear_local_refs();
+    // Warm the arenas and the cache slots
+    for (int i = 0; i < 4; ++i) WHISPER_JNI(transcribe)(&env, nullptr, str(clips[static_cast<size_t>(i) % clips.size()]));
+    env.clear_local_refs();
+
+    printf("engine cost zero; %.1f s clips, %d iterations\n\n", seconds, iterations);
+    printf("%-20s %7s %10s %10s %10s\n", "call", "count", "p50 us", "p99 us", "max us");
+
+    std::vector<double> cold, warm, redecode, sampled, command;
+    for (int i = 0; i < iterations; ++i) {
+        // The cache holds two clips; cycling through more than two always misses
+        const std::string& clip = clips[static_cast<size_t>(i) % clips.size()];
+        jstring path = str(clip);
+        cold.push_back(time_us([&] { WHISPER_JNI(transcribe)(&env, nullptr, path); }));
+        warm.push_back(time_us([&] { WHISPER_JNI(transcribe)(&env, nullptr, path); }));
+        jstring language = str(i % 2 == 0 ? "de" : "en");
+        redecode.push_back(time_us([&] { WHISPER_JNI(redecode)(&env, nullptr, language, JNI_FALSE, 0.0f); }));
+        sampled.push_back(time_us([&] { WHISPER_JNI(redecode)(&env, nullptr, language, JNI_FALSE, 0.5f); }));
+        jstring grammar = str(kGrammar);
+        command.push_back(time_us([&] { WHISPER_JNI(recognizeCommand)(&env, nullptr, path, grammar); }));
+        env.clear_local_refs();
+    }
+    if (clips.size() < 3) printf("(fewer than three clips: cold calls hit the cache)\n");
+    report("transcribe (cold)", cold);
+    report("transcribe (warm)", warm);
+    report("redecode", redecode);
+    report("redecode (T=0.5)", sampled);
+    report("recognizeCommand", command);
+
+    // A long file job on an engine with real encoder time, interrupted by voice queries
+    if (WHISPER_JNI(initModel)(&env, nullptr, str(slow_model)) != 0) {
+        fprintf(stderr, "initModel failed\n");
+        return 1;
+    }
+    const std::string& query = clips.front();
+    WHISPER_JNI(transcribe)(&env, nullptr, str(query));
+    const jlong job = WHISPER_JNI(submitFileTranscription)(&env, nullptr, str(recording));
+    env.clear_local_refs();
+    if (job == 0) {
+        fprintf(stderr, "submitFileTranscription failed\n");
+        return 1;
+    }
+
+    std::vector<double> poll, preempted;
+    std::uniform_int_distribution<int> pause_ms(1, std::max(1, file_encode_ms));
+    const int preemptions = std::max(1, std::min(iterations, 50));
+    for (int i = 0; i < preemptions && WHISPER_JNI(getJobProgress)(&env, nullptr, job) < 1.0f; ++i) {
+        // Land at a random point of the window in flight
+        std::this_thread::sleep_for(std::chrono::milliseconds(pause_ms(rng)));
+        poll.push_back(time_us([&] {
+            WHISPER_JNI(getJobProgress)(&env, nullptr, job);
+            WHISPER_JNI(pollFileTranscription)(&env, nullptr, job);
+        }));
+        jstring path = str(query);
+        preempted.push_back(time_us([&] { WHISPER_JNI(transcribe)(&env, nullptr, path); }));
+        env.clear_local_refs();
+    }
+    WHISPER_JNI(cancelJob)(&env, nullptr, job);
+    report("poll", poll);
+    report("preempted (warm)", preempted);
+    printf("\nfile job windows: %d ms of encoder time each\n", file_encode_ms);
+
+    WHISPER_JNI(releaseModel)(&env, nullptr);
+    return 0;
+}
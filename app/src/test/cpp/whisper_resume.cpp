@@ -0,0 +1,357 @@
+/**
+ * whisper_resume.cpp - Kills checkpointed file jobs and checks what they resume to
+ *
+ * Runs whisper_jni.cpp against the fake engine in child processes, the
+ * way Android ends an app: a child submits a long recording with a
+ * checkpoint, follows it with pollTranscriptSegments and is SIGKILLed at
+ * a random moment; the next child submits the same recording and
+ * checkpoint and carries on. Checks that
+ *
+ *   - every restart resumes with at least the segments the killed process
+ *     had already shown (they are saved before they are shown),
+ *   - the final segments, timestamps included, equal those of a run that
+ *     was never interrupted, and their text equals the fake engine's
+ *     transcript of the whole recording (so the decoder context crossed
+ *     every restart),
+ *   - submitting a finished checkpoint again returns it without
+ *     transcribing anything.
+ *
+ * The recording is 44.1 kHz stereo FLAC, so resuming also steps the
+ * decoder and resampler to the saved position.
+ *
+ * Usage: whisper_resume [--minutes M] [--kills N] [--encode-ms N] [--seed S] [work_dir]
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "audio_decoder.h"
+#include "fake_whisper.h"
+#include "flac_encode.h"
+#include "test_audio.h"
+#include "whisper_bridge.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kSourceRate = 44100;
+
+    struct Paths {
+        std::string model;
+        std::string recording;
+    };
+
+    struct Segment {
+        std::string line;       // "t0\tt1\ttext" as the bridge returns it
+        long long t0 = 0;
+        long long t1 = 0;
+        std::string text;
+    };
+
+    /** What a child reports on its pipe: the segments it was given back on submit and every one it saw. */
+    struct RunReport {
+        bool finished = false;  // got "done" and exited cleanly
+        size_t restored = 0;
+        std::vector<std::string> lines;
+    };
+
+    bool write_text(const std::string& path, const std::string& text) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr) return false;
+        const bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+        return fclose(file) == 0 && ok;
+    }
+
+    void write_line(int fd, const std::string& line) {
+        const std::string out = line + "\n";
+        size_t done = 0;
+        while (done < out.size()) {
+            const ssize_t wrote = write(fd, out.data() + done, out.size() - done);
+            if (wrote <= 0) return;
+            done += static_cast<size_t>(wrote);
+        }
+    }
+
+    /**
+     * The child: load the model, submit the recording with `checkpoint`
+     * and follow it to the end. Reports "restored N", then "seg <line>"
+     * per segment and "done" on `fd`.
+     */
+    int run_job(const Paths& paths, const std::string& checkpoint, int fd) {
+        JNIEnv env;
+        if (WHISPER_JNI(initModel)(&env, nullptr, env.NewStringUTF(paths.model.c_str())) != 0) return 3;
+        const jlong id = WHISPER_JNI(submitCheckpointedTranscription)(
+            &env, nullptr, env.NewStringUTF(paths.recording.c_str()), env.NewStringUTF(checkpoint.c_str()));
+        if (id == 0) return 4;
+        size_t seen = 0;
+        bool first = true;
+        while (true) {
+            const std::string chunk = WHISPER_JNI(pollTranscriptSegments)(&env, nullptr, id, static_cast<jint>(seen))->utf;
+            env.clear_local_refs();
+            size_t start = 0;
+            bool done = false;
+            std::vector<std::string> lines;
+            while (start < chunk.size()) {
+                const size_t end = chunk.find('\n', start);
+                const std::string line = chunk.substr(start, end - start);
+                start = end + 1;
+                if (line == "done") done = true;
+                else if (line == "failed") return 5;
+                else lines.push_back(line);
+            }
+            if (first) {
+                write_line(fd, "restored " + std::to_string(lines.size()));
+                first = false;
+            }
+            for (const std::string& line : lines) write_line(fd, "seg " + line);
+            seen += lines.size();
+            if (done) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        write_line(fd, "done");
+        WHISPER_JNI(releaseModel)(&env, nullptr);
+        return 0;
+    }
+
+    /** Fork a child running run_job; kill it after `kill_ms` (negative: let it finish). */
+    RunReport run_child(const Paths& paths, const std::string& checkpoint, int kill_ms) {
+        RunReport report;
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) {
+            perror("pipe");
+            exit(2);
+        }
+        fflush(stdout);
+        const pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            exit(2);
+        }
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            _exit(run_job(paths, checkpoint, pipe_fds[1]));
+        }
+        close(pipe_fds[1]);
+        if (kill_ms >= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kill_ms));
+            kill(pid, SIGKILL);
+        }
+
+        std::string output;
+        char buffer[4096];
+        ssize_t got;
+        while ((got = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) output.append(buffer, static_cast<size_t>(got));
+        close(pipe_fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+
+        size_t start = 0;
+        bool saw_done = false;
+        while (start < output.size()) {
+            const size_t end = output.find('\n', start);
+            if (end == std::string::npos) break;        // cut off by the kill
+            const std::string line = output.substr(start, end - start);
+            start = end + 1;
+            if (line.compare(0, 9, "restored ") == 0) report.restored = strtoul(line.c_str() + 9, nullptr, 10);
+            else if (line.compare(0, 4, "seg ") == 0) report.lines.push_back(line.substr(4));
+            else if (line == "done") saw_done = true;
+        }
+        report.finished = saw_done && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (kill_ms < 0 && !report.finished) {
+            fprintf(stderr, "job process failed (status %d)\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+        return report;
+    }
+
+    bool parse_segment(const std::string& line, Segment& segment) {
+        const size_t a = line.find('\t');
+        const size_t b = a == std::string::npos ? a : line.find('\t', a + 1);
+        if (b == std::string::npos) return false;
+        segment.line = line;
+        segment.t0 = atoll(line.c_str());
+        segment.t1 = atoll(line.c_str() + a + 1);
+        segment.text = line.substr(b + 1);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    double minutes = 4.0;
+    int kills = 6;
+    int32_t encode_ms = 40;
+    uint32_t seed = 5;
+    std::string dir;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) minutes = atof(argv[++i]);
+        else if (strcmp(argv[i], "--kills") == 0 && i + 1 < argc) kills = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--encode-ms") == 0 && i + 1 < argc) encode_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (argv[i][0] != '-' && dir.empty()) dir = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--minutes M] [--kills N] [--encode-ms N] [--seed S] [work_dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    minutes = std::max(0.5, minutes);
+    kills = std::max(0, kills);
+    encode_ms = std::max(1, encode_ms);
+    if (dir.empty()) {
+        char pattern[] = "/tmp/whisper_resume.XXXXXX";
+        if (mkdtemp(pattern) == nullptr) {
+            perror("mkdtemp");
+            return 2;
+        }
+        dir = pattern;
+    }
+
+    // Speech with pauses of random length (so no two windows are alike) and a silent stretch in the middle,
+    // in the layout of a shared voice note. Snippets are synthesized once; synthesis dominates otherwise
+    std::mt19937 rng(seed);
+    std::vector<std::vector<int16_t>> snippets(6);
+    for (auto& snippet : snippets) append_speech(snippet, kSourceRate, 0.3f, 3000, rng);
+    const auto total_ms = static_cast<int32_t>(minutes * 60000.0);
+    const size_t total = static_cast<size_t>(kSourceRate) * static_cast<size_t>(total_ms) / 1000;
+    const size_t quiet_from = total / 2;
+    const size_t quiet_to = quiet_from + static_cast<size_t>(kSourceRate) * 40;
+    std::vector<int16_t> pcm;
+    std::uniform_int_distribution<size_t> pick(0, snippets.size() - 1);
+    std::uniform_int_distribution<int32_t> pause_ms(20, 900);
+    while (pcm.size() < total) {
+        if (pcm.size() >= quiet_from && pcm.size() < quiet_to) append_silence(pcm, kSourceRate, 1000);
+        const std::vector<int16_t>& snippet = snippets[pick(rng)];
+        pcm.insert(pcm.end(), snippet.begin(), snippet.end());
+        append_silence(pcm, kSourceRate, pause_ms(rng));
+    }
+    pcm.resize(total);
+    // Stereo with a quieter second channel, as from a phone held off-center
+    std::vector<std::vector<int32_t>> planar(2, std::vector<int32_t>(pcm.begin(), pcm.end()));
+    for (int32_t& v : planar[1]) v /= 2;
+
+    Paths paths;
+    paths.recording = dir + "/recording.flac";
+    paths.model = dir + "/ggml-fake.bin";
+    const std::string model_text = "encode_ms=" + std::to_string(encode_ms) + "\ndecode_ms_per_token=0\n";
+    if (!write_flac(paths.recording, planar, kSourceRate, 16) || !write_text(paths.model, model_text)) {
+        fprintf(stderr, "cannot write to %s\n", dir.c_str());
+        return 2;
+    }
+
+    // The fake's transcript of the whole recording, read the way the job reads it
+    FakeWhisperConfig config;
+    parse_fake_whisper_config(model_text, config);
+    Arena arena(1 << 20);
+    float* samples = nullptr;
+    size_t n_samples = 0;
+    if (!read_audio_mono_float(paths.recording.c_str(), 16000, arena, &samples, &n_samples)) {
+        fprintf(stderr, "cannot decode %s\n", paths.recording.c_str());
+        return 2;
+    }
+    const std::string expected_text = fake_whisper_transcript(config, samples, n_samples, "en", false);
+    const size_t windows = (n_samples + 16000 * 30 - 1) / (16000 * 30);
+
+    bool ok = true;
+    const std::string reference_checkpoint = dir + "/reference.ckpt";
+    const std::string checkpoint = dir + "/job.ckpt";
+    unlink(reference_checkpoint.c_str());
+    unlink(checkpoint.c_str());
+
+    const auto started = std::chrono::steady_clock::now();
+    const RunReport reference = run_child(paths, reference_checkpoint, -1);
+    const double reference_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::string reference_text;
+    for (const std::string& line : reference.lines) {
+        Segment segment;
+        if (!parse_segment(line, segment)) {
+            fprintf(stderr, "malformed segment line: %s\n", line.c_str());
+            ok = false;
+        }
+        reference_text += segment.text;
+    }
+    if (!reference.finished || reference_text != expected_text) {
+        fprintf(stderr, "uninterrupted job does not match the engine's transcript (%zu vs %zu chars)\n",
+                reference_text.size(), expected_text.size());
+        ok = false;
+    }
+    printf("%.1f min recording, %zu windows, %zu segments; uninterrupted job %.0f ms\n\n", minutes, windows,
+           reference.lines.size(), reference_ms);
+    printf("%-6s %10s %10s %10s\n", "run", "killed at", "restored", "shown");
+
+    // Kill at random points of the remaining work, then let the last run finish
+    std::uniform_int_distribution<int> kill_at(0, std::max(1, static_cast<int>(reference_ms * 0.8)));
+    size_t shown_before = 0;
+    RunReport last;
+    for (int run = 0; run <= kills && ok; ++run) {
+        const int kill_ms = run < kills ? kill_at(rng) : -1;
+        last = run_child(paths, checkpoint, kill_ms);
+        if (last.lines.empty() && !last.finished && kill_ms >= 0) {
+            printf("%-6d %8d ms %10s %10s\n", run, kill_ms, "-", "-");
+            continue;       // killed before it reported anything
+        }
+        printf("%-6d %10s %10zu %10zu\n", run, kill_ms >= 0 ? (std::to_string(kill_ms) + " ms").c_str() : "-",
+               last.restored, last.lines.size());
+        if (last.restored < shown_before) {
+            fprintf(stderr, "run %d restored %zu segments, but %zu were shown before the kill\n", run, last.restored,
+                    shown_before);
+            ok = false;
+        }
+        // Whatever was shown, restored or not, must agree with the uninterrupted run
+        for (size_t i = 0; i < last.lines.size() && ok; ++i) {
+            if (i >= reference.lines.size() || last.lines[i] != reference.lines[i]) {
+                fprintf(stderr, "run %d segment %zu: '%s', uninterrupted: '%s'\n", run, i, last.lines[i].c_str(),
+                        i < reference.lines.size() ? reference.lines[i].c_str() : "(none)");
+                ok = false;
+            }
+        }
+        shown_before = std::max(shown_before, last.lines.size());
+        if (last.finished) break;
+    }
+    if (ok && (!last.finished || last.lines != reference.lines)) {
+        fprintf(stderr, "resumed job ended with %zu segments, uninterrupted %zu\n", last.lines.size(),
+                reference.lines.size());
+        ok = false;
+    }
+
+    // Finished checkpoint: everything comes back at once, and quickly
+    if (ok) {
+        const auto again = std::chrono::steady_clock::now();
+        const RunReport replay = run_child(paths, checkpoint, -1);
+        const double replay_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - again).count();
+        printf("\nfinished checkpoint: %zu segments restored in %.0f ms\n", replay.restored, replay_ms);
+        if (!replay.finished || replay.lines != reference.lines || replay.restored != reference.lines.size()) {
+            fprintf(stderr, "finished checkpoint did not restore the whole transcript\n");
+            ok = false;
+        }
+    }
+
+    // Segments run forward on the recording's clock
+    long long previous = 0;
+    for (const std::string& line : reference.lines) {
+        Segment segment;
+        parse_segment(line, segment);
+        if (segment.t0 < previous || segment.t1 < segment.t0 || segment.t1 > total_ms + 10) {
+            fprintf(stderr, "segment out of order or range: %s\n", line.c_str());
+            ok = false;
+            break;
+        }
+        previous = segment.t1;
+    }
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,504 @@
+/**
+ * whisper_stress.cpp - Concurrency stress test and throughput bench for the whisper bridge
+ *
+ * Runs the real whisper_jni.cpp against the fake engine (fake_whisper.h)
+ * and calls its JNI entry points from many threads at once, the way the
+ * app's services, UI and file picker can: transcriptions with and without
+ * parameters, re-decodes, command recognition, background file jobs that
+ * are polled, cancelled or abandoned, stats queries, and model churn
+ * (initModel, releaseModel, setFallbackModel) in between. Every thread
+ * draws its calls from its own seeded generator, so a failing mix can be
+ * re-run with the same --seed.
+ *
+ * Each answer is checked against the transcript the fake engine produces
+ * for that clip, language and task: transcribeWithParams must match its
+ * own parameters, file jobs must return a prefix of the file's transcript
+ * (all of it when they complete), and an empty answer is only accepted
+ * where the model may have been released. The fake engine counts misuse
+ * the bridge would get away with on a host but not with the real engine
+ * (a state used by two calls, freed after its context, ...) and the most
+ * states a context had alive at once: interactive requests share one and
+ * a file job has its own, so more than kMaxLiveStates is a leak of
+ * hundreds of MB on a phone. Build with
+ * -DASSISTANT_SANITIZE=thread or =address to have TSan or ASan check the
+ * bridge as well.
+ *
+ * One round runs per --threads value; the report shows throughput, its
+ * scaling against the first round, and call latency. The bridge serializes
+ * inference on one engine, so throughput is not expected to scale with
+ * threads: the table shows what contention costs.
+ *
+ * Usage: whisper_stress [--threads 1,2,4,8] [--ops N] [--seed N] [--encode-ms N]
+ *                       [--decode-ms-per-token X] [--churn PERCENT] [--check] [work_dir]
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "arena.h"
+#include "fake_whisper.h"
+#include "test_audio.h"
+#include "wav_io.h"
+#include "whisper_bridge.h"
+
+using namespace assistant;
+using namespace assistant::testing;
+
+namespace {
+    constexpr int32_t kSampleRate = 16000;
+    constexpr int32_t kMaxLiveStates = 2;
+    const char* kLanguages[] = { "en", "de", "es" };
+    constexpr size_t kLanguageCount = sizeof(kLanguages) / sizeof(kLanguages[0]);
+
+    const char* kGrammar =
+        "camera\topen camera\n"
+        "lights_on\tturn on lights\n"
+        "lights_off\tturn off lights\n"
+        "music\tplay music\n"
+        "call\tcall my mother\n"
+        "timer\tset a timer for ten minutes\n";
+
+    struct Clip {
+        std::string path;
+        // Transcript per model (primary, fallback), language and task
+        std::string expected[2][kLanguageCount][2];
+
+        bool matches_any(const std::string& text) const {
+            for (const auto& model : expected) {
+                for (const auto& language : model) {
+                    if (text == language[0] || text == language[1]) return true;
+                }
+            }
+            return false;
+        }
+
+        bool matches(const std::string& text, size_t language, bool translate) const {
+            return text == expected[0][language][translate] || text == expected[1][language][translate];
+        }
+
+        bool prefix_of_any(const std::string& text) const {
+            for (const auto& model : expected) {
+                for (const auto& language : model) {
+                    for (const std::string& full : language) {
+                        if (full.compare(0, text.size(), text) == 0) return true;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+
+    struct Workload {
+        std::string model;
+        std::string fallback;
+        std::vector<Clip> clips;        // short clips, then the long one last
+        int32_t churn = 3;              // percent of calls that init/release/swap the model
+    };
+
+    enum Op {
+        OP_TRANSCRIBE,
+        OP_TRANSCRIBE_PARAMS,
+        OP_REDECODE,
+        OP_COMMAND,
+        OP_FILE_JOB,
+        OP_STATS,
+        OP_CHURN,
+        OP_COUNT,
+    };
+
+    const char* kOpNames[OP_COUNT] = {
+        "transcribe", "transcribeWithParams", "redecode", "recognizeCommand", "file job", "stats", "model churn",
+    };
+
+    struct ThreadResult {
+        std::vector<double> latency_ms[OP_COUNT];
+        uint64_t wrong = 0;
+        uint64_t empty = 0;
+        uint64_t jobs_completed = 0;
+        uint64_t jobs_cancelled = 0;
+        std::string first_wrong;
+    };
+
+    /** Local references live until the next call, as they would until a JNI method returns. */
+    class Caller {
+    public:
+        jstring str(const std::string& text) { return env_.NewStringUTF(text.c_str()); }
+
+        std::string take(jstring result) {
+            std::string text = result != nullptr ? result->utf : std::string();
+            env_.clear_local_refs();
+            return text;
+        }
+
+        JNIEnv* env() { return &env_; }
+
+    private:
+        JNIEnv env_;
+    };
+
+    void record_wrong(ThreadResult& result, const char* op, const std::string& got) {
+        if (result.wrong++ == 0) result.first_wrong = std::string(op) + " returned \"" + got + "\"";
+    }
+
+    void write_clip(const std::string& path, const std::vector<int16_t>& pcm) {
+        if (!write_wav_mono16(path, pcm.data(), pcm.size(), kSampleRate)) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            exit(2);
+        }
+    }
+
+    bool write_text(const std::string& path, const std::string& text) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr) return false;
+        fputs(text.c_str(), file);
+        fclose(file);
+        return true;
+    }
+
+    Workload make_workload(const std::string& dir, const FakeWhisperConfig& primary, int32_t churn) {
+        Workload work;
+        work.churn = churn;
+        FakeWhisperConfig fallback = primary;
+        fallback.seed = primary.seed + 1;
+        fallback.encode_ms = primary.encode_ms / 2;
+        work.model = dir + "/ggml-fake.bin";
+        work.fallback = dir + "/ggml-fake-small.bin";
+        char text[256];
+        for (const auto& model : { std::make_pair(work.model, primary), std::make_pair(work.fallback, fallback) }) {
+            snprintf(text, sizeof(text), "encode_ms=%d\ndecode_ms_per_token=%g\nwords_per_second=%g\nseed=%u\n",
+                     model.second.encode_ms, model.second.decode_ms_per_token, model.second.words_per_second,
+                     model.second.seed);
+            if (!write_text(model.first, text)) {
+                fprintf(stderr, "cannot write %s\n", model.first.c_str());
+                exit(2);
+            }
+        }
+
+        // Utterances of 1-4 s, one of silence, and a 65 s recording that spans three windows
+        std::mt19937 rng(7);
+        const int32_t lengths_ms[] = { 1000, 1600, 2300, 3100, 4000, 1000, 65000 };
+        for (size_t i = 0; i < sizeof(lengths_ms) / sizeof(lengths_ms[0]); ++i) {
+            std::vector<int16_t> pcm;
+            if (i == 5) append_silence(pcm, kSampleRate, lengths_ms[i]);
+            else append_speech(pcm, kSampleRate, 0.3f, lengths_ms[i], rng);
+            Clip clip;
+            clip.path = dir + "/clip_" + std::to_string(i) + ".wav";
+            write_clip(clip.path, pcm);
+
+            // Expected text from the samples exactly as the bridge reads them
+            Arena arena(1 << 16);
+            float* samples = nullptr;
+            size_t n = 0;
+            read_wav_mono_float(clip.path.c_str(), arena, &samples, &n);
+            for (size_t m = 0; m < 2; ++m) {
+                for (size_t l = 0; l < kLanguageCount; ++l) {
+                    for (int t = 0; t < 2; ++t) {
+                        clip.expected[m][l][t] = fake_whisper_transcript(m == 0 ? primary : fallback, samples, n,
+                                                                         kLanguages[l], t != 0);
+                    }
+                }
+            }
+            work.clips.push_back(std::move(clip));
+        }
+        return work;
+    }
+
+    Op pick_op(std::mt19937& rng, int32_t churn) {
+        static const int weights[OP_COUNT - 1] = { 30, 20, 10, 8, 6, 10 };
+        std::uniform_int_distribution<int> percent(0, 99);
+        if (percent(rng) < churn) return OP_CHURN;
+        std::discrete_distribution<int> dist(std::begin(weights), std::end(weights));
+        return static_cast<Op>(dist(rng));
+    }
+
+    void run_file_job(Caller& call, const Workload& work, std::mt19937& rng, ThreadResult& result) {
+        const bool long_file = std::uniform_int_distribution<int>(0, 2)(rng) == 0;
+        const Clip& clip = long_file ? work.clips.back() : work.clips[std::uniform_int_distribution<size_t>(0, 4)(rng)];
+        const jlong id = WHISPER_JNI(submitFileTranscription)(call.env(), nullptr, call.str(clip.path));
+        call.take(nullptr);
+        if (id == 0) return;    // no model loaded
+
+        // Some jobs are given up on right away, some abandoned to the next releaseModel
+        const int fate = std::uniform_int_distribution<int>(0, 9)(rng);
+        if (fate == 0) {
+            WHISPER_JNI(cancelJob)(call.env(), nullptr, id);
+            ++result.jobs_cancelled;
+            return;
+        }
+        if (fate == 1) return;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (true) {
+            const float progress = WHISPER_JNI(getJobProgress)(call.env(), nullptr, id);
+            if (progress >= 1.0f || progress < 0.0f) {
+                const std::string text = call.take(WHISPER_JNI(pollFileTranscription)(call.env(), nullptr, id));
+                if (progress >= 1.0f ? !clip.matches_any(text) : !clip.prefix_of_any(text)) {
+                    record_wrong(result, "file job", text);
+                }
+                ++(progress >= 1.0f ? result.jobs_completed : result.jobs_cancelled);
+                return;
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                // Starved by interactive calls; the bridge must still cancel it cleanly
+                WHISPER_JNI(cancelJob)(call.env(), nullptr, id);
+                ++result.jobs_cancelled;
+                return;
+            }
+            const std::string partial = call.take(WHISPER_JNI(pollFileTranscription)(call.env(), nullptr, id));
+            if (!clip.prefix_of_any(partial)) record_wrong(result, "file job (partial)", partial);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    void run_op(Op op, Caller& call, const Workload& work, std::mt19937& rng, ThreadResult& result) {
+        // The long clip is rare in interactive calls, as it is in the app
+        const size_t n_clips = work.clips.size();
+        const size_t clip_index = std::uniform_int_distribution<int>(0, 19)(rng) == 0
+            ? n_clips - 1 : std::uniform_int_distribution<size_t>(0, n_clips - 2)(rng);
+        const Clip& clip = work.clips[clip_index];
+        const size_t language = std::uniform_int_distribution<size_t>(0, kLanguageCount - 1)(rng);
+        const bool translate = std::uniform_int_distribution<int>(0, 3)(rng) == 0;
+
+        switch (op) {
+            case OP_TRANSCRIBE: {
+                // Uses whatever language the last transcribeWithParams left behind
+                const std::string text = call.take(WHISPER_JNI(transcribe)(call.env(), nullptr, call.str(clip.path)));
+                if (clip.matches_any(text)) break;
+                if (text.empty()) ++result.empty;
+                else record_wrong(result, "transcribe", text);
+                break;
+            }
+            case OP_TRANSCRIBE_PARAMS: {
+                const jint threads = std::uniform_int_distribution<int>(0, 4)(rng);
+                const std::string text = call.take(WHISPER_JNI(transcribeWithParams)(
+                    call.env(), nullptr, call.str(clip.path), call.str(kLanguages[language]),
+                    translate ? JNI_TRUE : JNI_FALSE, threads));
+                if (clip.matches(text, language, translate)) break;
+                if (text.empty()) ++result.empty;
+                else record_wrong(result, "transcribeWithParams", text);
+                break;
+            }
+            case OP_REDECODE: {
+                // Re-decodes whichever clip was transcribed last, by any thread
+                const bool sample = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
+                const std::string text = call.take(WHISPER_JNI(redecode)(
+                    call.env(), nullptr, call.str(kLanguages[language]), translate ? JNI_TRUE : JNI_FALSE,
+                    sample ? 0.7f : 0.0f));
+                if (text.empty() || sample) break;
+                const bool known = std::any_of(work.clips.begin(), work.clips.end(), [&](const Clip& c) {
+                    return c.matches(text, language, translate);
+                });
+                if (!known) record_wrong(result, "redecode", text);
+                break;
+            }
+            case OP_COMMAND: {
+                const std::string text = call.take(WHISPER_JNI(recognizeCommand)(
+                    call.env(), nullptr, call.str(clip.path), call.str(kGrammar)));
+                const size_t tab = text.find('\t');
+                if (!text.empty() && (tab == std::string::npos ||
+                                      strstr(kGrammar, text.substr(0, tab + 1).c_str()) == nullptr)) {
+                    record_wrong(result, "recognizeCommand", text);
+                }
+                break;
+            }
+            case OP_FILE_JOB:
+                run_file_job(call, work, rng, result);
+                break;
+            case OP_STATS:
+                call.take(WHISPER_JNI(getSchedulerStats)(call.env(), nullptr));
+                call.take(WHISPER_JNI(getGovernorStats)(call.env(), nullptr));
+                call.take(WHISPER_JNI(getVersion)(call.env(), nullptr));
+                break;
+            case OP_CHURN:
+                switch (std::uniform_int_distribution<int>(0, 3)(rng)) {
+                    case 0:
+                        WHISPER_JNI(releaseModel)(call.env(), nullptr);
+                        break;
+                    case 1:
+                        WHISPER_JNI(setFallbackModel)(call.env(), nullptr, call.str(work.fallback));
+                        break;
+                    case 2:
+                        WHISPER_JNI(setFallbackModel)(call.env(), nullptr, nullptr);
+                        break;
+                    default:
+                        WHISPER_JNI(initModel)(call.env(), nullptr, call.str(work.model));
+                        break;
+                }
+                call.take(nullptr);
+                break;
+            default:
+                break;
+        }
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    std::vector<int> parse_list(const char* text) {
+        std::vector<int> out;
+        for (const char* p = text; *p != '\0';) {
+            char* end = nullptr;
+            const long value = strtol(p, &end, 10);
+            if (end == p) break;
+            if (value > 0) out.push_back(static_cast<int>(value));
+            p = *end == ',' ? end + 1 : end;
+        }
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> thread_counts = { 1, 2, 4, 8 };
+    int ops = 400;
+    uint32_t seed = 1;
+    int32_t churn = 3;
+    bool check = false;
+    std::string dir;
+    FakeWhisperConfig config;
+    config.encode_ms = 20;
+    config.decode_ms_per_token = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) thread_counts = parse_list(argv[++i]);
+        else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc) ops = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--encode-ms") == 0 && i + 1 < argc) config.encode_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--decode-ms-per-token") == 0 && i + 1 < argc) config.decode_ms_per_token = atof(argv[++i]);
+        else if (strcmp(argv[i], "--churn") == 0 && i + 1 < argc) churn = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--check") == 0) check = true;
+        else if (argv[i][0] != '-' && dir.empty()) dir = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--threads 1,2,4,8] [--ops N] [--seed N] [--encode-ms N] "
+                            "[--decode-ms-per-token X] [--churn PERCENT] [--check] [work_dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (thread_counts.empty() || ops <= 0) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+    if (dir.empty()) {
+        char pattern[] = "/tmp/whisper_stress.XXXXXX";
+        if (mkdtemp(pattern) == nullptr) {
+            perror("mkdtemp");
+            return 2;
+        }
+        dir = pattern;
+    }
+
+    const Workload work = make_workload(dir, config, std::max(0, std::min(100, churn)));
+    {
+        Caller call;
+        printf("engine: %s\n", call.take(WHISPER_JNI(getVersion)(call.env(), nullptr)).c_str());
+    }
+    printf("%d calls per round, encode %d ms, decode %.2f ms/token, churn %d%%, seed %u\n\n",
+           ops, config.encode_ms, config.decode_ms_per_token, work.churn, seed);
+    printf("%-8s %10s %8s %9s %9s %9s %7s %7s %6s %10s\n",
+           "threads", "calls/s", "speedup", "p50 ms", "p99 ms", "max ms", "empty", "jobs", "wrong", "violations");
+
+    bool failed = false;
+    double baseline = 0.0;
+    ThreadResult last;
+    for (const int n_threads : thread_counts) {
+        {
+            Caller call;
+            if (WHISPER_JNI(initModel)(call.env(), nullptr, call.str(work.model)) != 0) {
+                fprintf(stderr, "initModel failed for %s\n", work.model.c_str());
+                return 1;
+            }
+            call.take(nullptr);
+        }
+        const uint64_t violations_before = fake_whisper_violations();
+
+        std::vector<ThreadResult> results(static_cast<size_t>(n_threads));
+        std::vector<std::thread> threads;
+        const auto started = std::chrono::steady_clock::now();
+        for (int t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&, t] {
+                Caller call;
+                std::mt19937 rng(seed * 7919u + static_cast<uint32_t>(n_threads * 131 + t));
+                ThreadResult& result = results[static_cast<size_t>(t)];
+                const int my_ops = ops / n_threads + (t < ops % n_threads ? 1 : 0);
+                for (int i = 0; i < my_ops; ++i) {
+                    const Op op = pick_op(rng, work.churn);
+                    const auto begin = std::chrono::steady_clock::now();
+                    run_op(op, call, work, rng, result);
+                    result.latency_ms[op].push_back(
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        {
+            // Abandoned jobs are cancelled here, with the context they belong to
+            Caller call;
+            WHISPER_JNI(releaseModel)(call.env(), nullptr);
+        }
+        const uint64_t violations = fake_whisper_violations() - violations_before;
+
+        ThreadResult total;
+        std::vector<double> all;
+        for (const ThreadResult& result : results) {
+            for (int op = 0; op < OP_COUNT; ++op) {
+                total.latency_ms[op].insert(total.latency_ms[op].end(), result.latency_ms[op].begin(),
+                                            result.latency_ms[op].end());
+                all.insert(all.end(), result.latency_ms[op].begin(), result.latency_ms[op].end());
+            }
+            if (total.first_wrong.empty()) total.first_wrong = result.first_wrong;
+            total.wrong += result.wrong;
+            total.empty += result.empty;
+            total.jobs_completed += result.jobs_completed;
+            total.jobs_cancelled += result.jobs_cancelled;
+        }
+        const double rate = static_cast<double>(all.size()) / seconds;
+        if (baseline == 0.0) baseline = rate;
+        char jobs[32];
+        snprintf(jobs, sizeof(jobs), "%llu/%llu", static_cast<unsigned long long>(total.jobs_completed),
+                 static_cast<unsigned long long>(total.jobs_completed + total.jobs_cancelled));
+        printf("%-8d %10.1f %7.2fx %9.2f %9.2f %9.2f %7llu %7s %6llu %10llu\n",
+               n_threads, rate, rate / baseline, percentile(all, 50.0), percentile(all, 99.0),
+               all.empty() ? 0.0 : *std::max_element(all.begin(), all.end()),
+               static_cast<unsigned long long>(total.empty), jobs, static_cast<unsigned long long>(total.wrong),
+               static_cast<unsigned long long>(violations));
+        if (!total.first_wrong.empty()) printf("    first wrong answer: %s\n", total.first_wrong.c_str());
+        if (violations > 0) printf("    first violation: %s\n", fake_whisper_first_violation().c_str());
+        failed = failed || total.wrong > 0 || violations > 0;
+        last = std::move(total);
+    }
+
+    printf("\nlatency by call at %d threads:\n", thread_counts.back());
+    printf("%-22s %7s %9s %9s\n", "call", "count", "p50 ms", "p99 ms");
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (last.latency_ms[op].empty()) continue;
+        printf("%-22s %7zu %9.2f %9.2f\n", kOpNames[op], last.latency_ms[op].size(),
+               percentile(last.latency_ms[op], 50.0), percentile(last.latency_ms[op], 99.0));
+    }
+
+    const int32_t peak_states = fake_whisper_peak_states();
+    printf("\npeak whisper states alive: %d (limit %d)\n", peak_states, kMaxLiveStates);
+    failed = failed || peak_states > kMaxLiveStates;
+
+    if (check && failed) {
+        fprintf(stderr, "FAIL: wrong answers, engine misuse or too many states, see above\n");
+        return 1;
+    }
+    return 0;
+}
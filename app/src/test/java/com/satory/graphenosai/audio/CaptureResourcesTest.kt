@@ -0,0 +1,52 @@
+package com.satory.graphenosai.audio
+
+import org.junit.Assert.*
+import org.junit.Test
+
+class CaptureResourcesTest {
+
+    private class Resource(val name: String) : AutoCloseable {
+        var closed = false
+        override fun close() {
+            closed = true
+        }
+    }
+
+    @Test
+    fun `the stream is still open once capture starts`() {
+        val resources = CaptureResources<Resource, Resource>()
+        val (firstPipeline, firstStream) = resources.open({ Resource("pipeline 1") }, { Resource("stream 1") })
+        assertFalse(firstPipeline!!.closed)
+        assertFalse(firstStream!!.closed)
+
+        // The next capture releases the previous pair before opening its own
+        val (secondPipeline, secondStream) = resources.open({
+            assertTrue(firstPipeline.closed)
+            assertTrue(firstStream.closed)
+            Resource("pipeline 2")
+        }, { Resource("stream 2") })
+        assertFalse(secondPipeline!!.closed)
+        assertFalse(secondStream!!.closed)
+    }
+
+    @Test
+    fun `a taken stream outlives the release`() {
+        val resources = CaptureResources<Resource, Resource>()
+        val (pipeline, stream) = resources.open({ Resource("pipeline") }, { Resource("stream") })
+        assertSame(stream, resources.takeStream())
+        assertNull(resources.takeStream())
+
+        resources.release()
+        assertTrue(pipeline!!.closed)
+        assertFalse(stream!!.closed)
+    }
+
+    @Test
+    fun `capture without endpointing has no stream`() {
+        val resources = CaptureResources<Resource, Resource>()
+        val (pipeline, stream) = resources.open({ Resource("pipeline") }, { null })
+        assertNull(stream)
+        assertSame(pipeline, resources.takePipeline())
+        assertNull(resources.takePipeline())
+    }
+}
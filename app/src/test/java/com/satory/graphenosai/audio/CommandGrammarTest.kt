@@ -0,0 +1,65 @@
+package com.satory.graphenosai.audio
+
+import com.satory.graphenosai.audio.CommandGrammar.Rule
+import org.junit.Assert.*
+import org.junit.Test
+
+class CommandGrammarTest {
+
+    @Test
+    fun `expands alternatives and optional parts`() {
+        assertEquals(
+            listOf("open the camera", "open camera", "launch the camera", "launch camera"),
+            CommandGrammar.expand("(open|launch) [the] camera")
+        )
+        assertEquals(
+            listOf("set a timer", "set timer", "start a timer", "start timer"),
+            CommandGrammar.expand("(set|start) [a] timer")
+        )
+        assertEquals(listOf("turn on the light", "turn on light", "lights on"),
+            CommandGrammar.expand("(turn on [the] light|lights on)"))
+    }
+
+    @Test
+    fun `raw expansion keeps markup`() {
+        assertEquals(listOf("Open {app} now", "Open {app}"), CommandGrammar.expandRaw("Open {app} [now]"))
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun `rejects unclosed groups`() {
+        CommandGrammar.expand("(open camera")
+    }
+
+    @Test
+    fun `matches recognizer text regardless of case and punctuation`() {
+        val grammar = CommandGrammar.DEFAULT
+        assertEquals("open_camera", grammar.match(" Open the camera.")?.intent)
+        assertEquals("stop", grammar.match("Never mind!")?.intent)
+        assertNull(grammar.match("open the fridge"))
+    }
+
+    @Test
+    fun `resolves a prefix once a single intent is left`() {
+        val grammar = CommandGrammar.DEFAULT
+        assertNull(grammar.resolvePrefix("turn"))
+        assertEquals("flashlight_off", grammar.resolvePrefix("turn off")?.intent)
+        assertEquals("take_photo", grammar.resolvePrefix("take")?.intent)
+        assertNull(grammar.resolvePrefix(""))
+    }
+
+    @Test
+    fun `serializes for vosk and the native decoder`() {
+        val grammar = CommandGrammar(listOf(Rule("stop", "(Stop!|halt)"), Rule("repeat", "again")))
+        assertEquals("""["stop","halt","again","[unk]"]""", grammar.voskGrammarJson())
+        assertEquals("stop\tstop\nstop\thalt\nrepeat\tagain", grammar.nativeSpec())
+    }
+
+    @Test
+    fun `parses native results`() {
+        val match = CommandGrammar.parseNativeResult("volume_up\tvolume up\t0.912")
+        assertEquals("volume_up", match?.intent)
+        assertEquals(0.912f, match!!.score, 1e-6f)
+        assertNull(CommandGrammar.parseNativeResult(""))
+        assertNull(CommandGrammar.parseNativeResult("a\tb"))
+    }
+}
@@ -0,0 +1,74 @@
+package com.satory.graphenosai.audio
+
+import org.junit.Assert.*
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+
+class TranscriptJobStoreTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    @Test
+    fun `poll lines parse into segments and the end marker`() {
+        val poll = TranscriptSegment.parsePoll("0\t2400\t the weather\n2400\t5000\t is\tsunny\ndone\n")
+        assertEquals(
+            listOf(TranscriptSegment(0, 2400, " the weather"), TranscriptSegment(2400, 5000, " is\tsunny")),
+            poll.segments
+        )
+        assertTrue(poll.done)
+        assertFalse(poll.failed)
+
+        val running = TranscriptSegment.parsePoll("")
+        assertTrue(running.segments.isEmpty())
+        assertFalse(running.done || running.failed)
+        assertTrue(TranscriptSegment.parsePoll("failed\n").failed)
+        assertNull(TranscriptSegment.parseLine("garbage"))
+    }
+
+    @Test
+    fun `segment lines round trip`() {
+        val segment = TranscriptSegment(1200, 3400, " a\ttab and a\nbreak")
+        assertEquals(TranscriptSegment(1200, 3400, " a tab and a break"), TranscriptSegment.parseLine(segment.toLine()))
+    }
+
+    @Test
+    fun `a job is pending until its transcript is stored`() {
+        val store = TranscriptJobStore(folder.root)
+        val first = store.add("meeting.m4a") { it.write(ByteArray(16)) }!!
+        val second = store.add("lecture.flac") { it.write(ByteArray(16)) }!!
+        assertEquals(listOf("meeting.m4a", "lecture.flac"), store.pending().map { it.name })
+        assertTrue(first.audio.isFile)
+
+        // What a restarted process sees is the same queue
+        first.checkpoint.writeText("journal")
+        assertEquals(listOf(first, second), TranscriptJobStore(folder.root).pending())
+
+        val segments = listOf(TranscriptSegment(0, 1000, " hello"), TranscriptSegment(1000, 2000, " world"))
+        store.complete(first, segments)
+        assertFalse(first.audio.exists())
+        assertFalse(first.checkpoint.exists())
+        assertEquals(listOf(second), store.pending())
+
+        store.fail(second, "Cannot read this recording")
+        assertTrue(store.pending().isEmpty())
+        val finished = store.finished()
+        assertEquals(listOf("lecture.flac", "meeting.m4a"), finished.map { it.name })
+        assertEquals("Cannot read this recording", finished[0].error)
+        assertEquals(segments, finished[1].segments)
+
+        store.remove(first.id)
+        store.remove(second.id)
+        assertTrue(store.finished().isEmpty())
+        assertTrue(folder.root.list()!!.isEmpty())
+    }
+
+    @Test
+    fun `a copy that fails leaves nothing queued`() {
+        val store = TranscriptJobStore(folder.root)
+        assertNull(store.add("broken.wav") { throw java.io.IOException("read failed") })
+        assertTrue(store.pending().isEmpty())
+        assertTrue(folder.root.list()!!.isEmpty())
+    }
+}
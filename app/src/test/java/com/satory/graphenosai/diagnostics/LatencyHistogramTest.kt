@@ -0,0 +1,66 @@
+package com.satory.graphenosai.diagnostics
+
+import org.junit.Assert.*
+import org.junit.Test
+
+class LatencyHistogramTest {
+
+    @Test
+    fun `small values are exact`() {
+        val histogram = LatencyHistogram()
+        (1L..100L).forEach { histogram.record(it) }
+
+        assertEquals(100L, histogram.count)
+        assertEquals(50L, histogram.percentile(50.0))
+        assertEquals(90L, histogram.percentile(90.0))
+        assertEquals(99L, histogram.percentile(99.0))
+        assertEquals(1L, histogram.min)
+        assertEquals(100L, histogram.max)
+        assertEquals(50.5, histogram.mean, 1e-9)
+    }
+
+    @Test
+    fun `large values stay within bucket precision`() {
+        val histogram = LatencyHistogram()
+        // A long tail: 1 ms to 100 s
+        var value = 1L
+        val values = mutableListOf<Long>()
+        while (value <= 100_000L) {
+            values.add(value)
+            histogram.record(value)
+            value = value * 11 / 10 + 1
+        }
+        values.sort()
+        for (p in listOf(10.0, 50.0, 75.0, 90.0, 99.0)) {
+            val exact = values[Math.ceil(p / 100.0 * values.size).toInt() - 1]
+            val reported = histogram.percentile(p)
+            assertTrue("p$p: $reported vs $exact", Math.abs(reported - exact) <= exact / 60 + 1)
+        }
+        assertEquals(values.last(), histogram.percentile(100.0))
+    }
+
+    @Test
+    fun `out of range values are clamped`() {
+        val histogram = LatencyHistogram()
+        histogram.record(-5L)
+        histogram.record(10 * LatencyHistogram.MAX_VALUE_MS)
+
+        assertEquals(0L, histogram.min)
+        assertEquals(LatencyHistogram.MAX_VALUE_MS, histogram.max)
+        assertEquals(LatencyHistogram.MAX_VALUE_MS, histogram.percentile(99.0))
+    }
+
+    @Test
+    fun `add merges counts and extremes`() {
+        val fast = LatencyHistogram().apply { repeat(90) { record(200L) } }
+        val slow = LatencyHistogram().apply { repeat(10) { record(5_000L) } }
+        val all = LatencyHistogram().apply { add(fast); add(slow) }
+
+        assertEquals(100L, all.count)
+        assertEquals(200L, all.min)
+        assertEquals(5_000L, all.max)
+        assertEquals(200L, all.percentile(90.0))
+        assertEquals(5_000L, all.percentile(91.0))
+        assertEquals(0L, LatencyHistogram().percentile(50.0))
+    }
+}
@@ -0,0 +1,80 @@
+package com.satory.graphenosai.diagnostics
+
+import org.junit.Assert.*
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+
+class LatencyLogTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    @Test
+    fun `records survive reopening`() {
+        val file = File(folder.root, "latency.ring")
+        LatencyLog(file, capacity = 8).apply {
+            append(1_000L, 120, 0)
+            append(2_000L, 450, 2)
+            close()
+        }
+        val log = LatencyLog(file, capacity = 8)
+
+        assertEquals(
+            listOf(LatencyLog.Record(1_000L, 120, 0), LatencyLog.Record(2_000L, 450, 2)),
+            log.read()
+        )
+        assertEquals(24L + 2 * 16, file.length())
+    }
+
+    @Test
+    fun `ring overwrites the oldest records`() {
+        val file = File(folder.root, "latency.ring")
+        val log = LatencyLog(file, capacity = 4)
+        (1..10).forEach { log.append(it * 1_000L, it, 1) }
+
+        assertEquals(10L, log.totalWritten)
+        assertEquals(listOf(7, 8, 9, 10), log.read().map { it.latencyMs })
+        assertEquals(24L + 4 * 16, file.length())
+
+        log.close()
+        assertEquals(listOf(7, 8, 9, 10), LatencyLog(file, capacity = 4).read().map { it.latencyMs })
+    }
+
+    @Test
+    fun `foreign or resized files start afresh`() {
+        val file = File(folder.root, "latency.ring")
+        file.writeText("not a latency log at all")
+        val log = LatencyLog(file, capacity = 4)
+        assertTrue(log.read().isEmpty())
+        log.append(1L, 1, 0)
+        log.close()
+
+        assertTrue(LatencyLog(file, capacity = 8).read().isEmpty())
+    }
+
+    @Test
+    fun `metrics summarize per stage and window`() {
+        LatencyMetrics.open(folder.root, capacity = 64)
+        LatencyMetrics.clear()
+        repeat(10) { LatencyMetrics.record(LatencyMetrics.Stage.TRIGGER_TO_LISTENING, 100L, nowMs = 1_000L) }
+        repeat(10) { LatencyMetrics.record(LatencyMetrics.Stage.TRIGGER_TO_LISTENING, 300L, nowMs = 5_000L) }
+        LatencyMetrics.record(LatencyMetrics.Stage.FIRST_TO_LAST_TOKEN, 2_000L, nowMs = 5_000L)
+
+        val all = LatencyMetrics.summaries().associateBy { it.stage }
+        assertEquals(20L, all.getValue(LatencyMetrics.Stage.TRIGGER_TO_LISTENING).count)
+        assertEquals(100L, all.getValue(LatencyMetrics.Stage.TRIGGER_TO_LISTENING).p50)
+        assertEquals(300L, all.getValue(LatencyMetrics.Stage.TRIGGER_TO_LISTENING).p90)
+        assertEquals(0L, all.getValue(LatencyMetrics.Stage.SPEECH_END_TO_TRANSCRIPT).count)
+
+        val recent = LatencyMetrics.summaries(sinceMs = 2_000L).associateBy { it.stage }
+        assertEquals(10L, recent.getValue(LatencyMetrics.Stage.TRIGGER_TO_LISTENING).count)
+        assertEquals(300L, recent.getValue(LatencyMetrics.Stage.TRIGGER_TO_LISTENING).p50)
+
+        // Reopening rebuilds the histograms from the ring
+        LatencyMetrics.open(folder.root, capacity = 64)
+        assertEquals(21, LatencyMetrics.storedSamples())
+        assertEquals(2_000L, LatencyMetrics.summaries().first { it.stage == LatencyMetrics.Stage.FIRST_TO_LAST_TOKEN }.max)
+    }
+}
@@ -0,0 +1,107 @@
+package com.satory.graphenosai.intent
+
+import com.satory.graphenosai.intent.IntentRouter.Action
+import com.satory.graphenosai.intent.IntentRouter.Source
+import org.junit.Assert.*
+import org.junit.Test
+
+class IntentRouterTest {
+
+    private val apps = mapOf("camera" to "app.grapheneos.camera", "settings" to "com.android.settings")
+
+    private fun router(classifier: IntentRouter.Classifier? = null) =
+        IntentRouter(classifier = classifier, apps = { apps[it] })
+
+    @Test
+    fun `rules resolve sites and installed apps`() {
+        val router = router()
+        val site = router.route("Open YouTube, please.")
+        assertEquals(Action.OPEN_SITE, site?.action)
+        assertEquals("https://www.youtube.com", site?.argument)
+        assertEquals(Source.RULE, site?.source)
+
+        assertEquals("https://www.google.com/maps", router.route("go to google maps")?.argument)
+        assertEquals("app.grapheneos.camera", router.route("launch the camera app")?.argument)
+        assertEquals("com.android.settings", router.route("open settings")?.argument)
+        assertEquals(Action.FLASHLIGHT_OFF, router.route("Turn the torch off")?.action)
+        assertEquals(Action.FLASHLIGHT_ON, router.route("включи фонарик")?.action)
+        assertEquals("https://www.youtube.com", router.route("Открой ютуб")?.argument)
+    }
+
+    @Test
+    fun `questions and unknown apps fall through`() {
+        val router = router()
+        assertNull(router.route("open the pod bay doors"))
+        assertNull(router.route("what is on youtube today"))
+        assertNull(router.route("how do I open a jar"))
+        assertNull(router.route(""))
+    }
+
+    @Test
+    fun `classifier handles confident argument-free paraphrases only`() {
+        val results = mapOf(
+            "could you switch the torch on" to IntentClassifier.Result("FLASHLIGHT_ON", 0.97f, 4f),
+            "is the torch any good" to IntentClassifier.Result("FLASHLIGHT_ON", 0.7f, 0.8f),
+            "why is it dark" to IntentClassifier.Result(IntentRouter.NO_INTENT, 0.99f, 5f),
+            "bring up the camera" to IntentClassifier.Result("OPEN_APP", 0.99f, 5f)
+        )
+        val router = router { results[it] }
+
+        val paraphrase = router.route("could you switch the torch on")
+        assertEquals(Action.FLASHLIGHT_ON, paraphrase?.action)
+        assertEquals(Source.CLASSIFIER, paraphrase?.source)
+        assertEquals(0.97f, paraphrase!!.confidence, 0f)
+
+        assertNull(router.route("is the torch any good"))
+        assertNull(router.route("why is it dark"))
+        assertNull(router.route("bring up the camera"))
+    }
+
+    @Test
+    fun `classifier hits need the flashlight and no question`() {
+        // Unseen words do not count against an intent, so the classifier may be sure of all of these
+        val router = router { text ->
+            val off = " off" in text || text.startsWith("off")
+            IntentClassifier.Result(if (off) "FLASHLIGHT_OFF" else "FLASHLIGHT_ON", 0.99f, 5f)
+        }
+        for (text in listOf(
+            "turn on the lights in the living room",
+            "turn on wifi",
+            "can you turn on dark mode",
+            "can you turn on subtitles",
+            "i need some light reading suggestions",
+            "how do i turn on my flashlight",
+            "please turn off the alarm",
+            "turn off do not disturb",
+            "что делать если фонарик не включается"
+        )) {
+            assertNull(text, router.route(text))
+        }
+        assertEquals(Action.FLASHLIGHT_ON, router.route("could you get the flashlight going")?.action)
+        assertEquals(Action.FLASHLIGHT_OFF, router.route("kill the torch off now")?.action)
+    }
+
+    @Test
+    fun `counts hits and latency`() {
+        val router = router { if (it == "torch please") IntentClassifier.Result("FLASHLIGHT_ON", 0.95f, 3f) else null }
+        router.route("open github")
+        router.route("torch please")
+        router.route("tell me a joke")
+        router.route("open reddit")
+
+        val stats = router.stats()
+        assertEquals(4, stats.queries)
+        assertEquals(2, stats.ruleHits)
+        assertEquals(1, stats.classifierHits)
+        assertEquals(0.75f, stats.hitRate, 1e-6f)
+        assertTrue(stats.maxLatencyNs > 0)
+        assertTrue(stats.totalLatencyNs >= stats.maxLatencyNs)
+    }
+
+    @Test
+    fun `classifier spec lists intents in first-appearance order`() {
+        val names = IntentClassifier.intentNames(IntentRouter.classifierSpec())
+        assertEquals(listOf("FLASHLIGHT_ON", "FLASHLIGHT_OFF", IntentRouter.NO_INTENT), names)
+        assertTrue(names.all { it == IntentRouter.NO_INTENT || Action.valueOf(it).needsArgument.not() })
+    }
+}
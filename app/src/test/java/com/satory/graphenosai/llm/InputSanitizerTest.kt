@@ -0,0 +1,28 @@
+package com.satory.graphenosai.llm
+
+import org.junit.Assert.*
+import org.junit.Test
+
+class InputSanitizerTest {
+
+    @Test
+    fun `masks contact details and identifiers`() {
+        val sanitized = InputSanitizer.sanitize(
+            "Call +491701234567 or mail anna@example.de about 3f9a1c2b7d4e8f60, card 4111 1111 1111 1111"
+        )
+        assertEquals("Call [PHONE] or mail [EMAIL] about [ID], card [CARD]", sanitized)
+    }
+
+    @Test
+    fun `leaves ordinary questions alone`() {
+        val question = "Wie spät ist es gerade in Tokio?"
+        assertEquals(question, InputSanitizer.sanitize("  $question\n"))
+    }
+
+    @Test
+    fun `caps long input`() {
+        val sanitized = InputSanitizer.sanitize("x".repeat(10_000))
+        assertEquals(4003, sanitized.length)
+        assertTrue(sanitized.endsWith("..."))
+    }
+}
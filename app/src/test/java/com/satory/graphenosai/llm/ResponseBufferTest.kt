@@ -0,0 +1,142 @@
+package com.satory.graphenosai.llm
+
+import org.junit.Assert.*
+import org.junit.Assume.assumeTrue
+import org.junit.Test
+import java.lang.management.ManagementFactory
+
+class ResponseBufferTest {
+
+    /** A 20 KB answer streamed the way OpenRouter/Copilot deliver it: a few characters per token. */
+    private fun streamedAnswer(): List<String> {
+        val words = listOf("The ", "quick ", "brown ", "fox ", "jumps ", "over ", "the ", "lazy ", "dog. ", "\n\n")
+        val tokens = mutableListOf<String>()
+        var size = 0
+        var i = 0
+        while (size < 20_000) {
+            val token = words[i++ % words.size]
+            tokens.add(token)
+            size += token.length
+        }
+        return tokens
+    }
+
+    @Test
+    fun `snapshots are stable while the buffer grows`() {
+        val buffer = ResponseBuffer()
+        val first = buffer.append("Hello")
+        val second = buffer.append(", world")
+        repeat(200) { buffer.append("!") }
+
+        assertEquals("Hello", first.text())
+        assertEquals(1, first.version)
+        assertEquals("Hello, world", second.text())
+        assertEquals(12, second.length)
+        assertEquals(202, buffer.snapshot().chunkCount)
+        assertEquals(212, buffer.size)
+    }
+
+    @Test
+    fun `chunksSince returns only new chunks`() {
+        val buffer = ResponseBuffer()
+        val a = buffer.append("a")
+        buffer.append("b")
+        val c = buffer.append("c")
+
+        assertEquals(listOf("b", "c"), c.chunksSince(a))
+        assertEquals(listOf("a", "b", "c"), c.chunksSince(null))
+        assertTrue(c.chunksSince(c).isEmpty())
+    }
+
+    @Test
+    fun `clear starts a new generation without touching old snapshots`() {
+        val buffer = ResponseBuffer()
+        val old = buffer.append("old answer")
+        val empty = buffer.clear()
+        val fresh = buffer.append("new")
+
+        assertTrue(empty.isEmpty())
+        assertEquals("old answer", old.text())
+        assertEquals("new", fresh.text())
+        assertEquals(listOf("new"), fresh.chunksSince(old))
+    }
+
+    @Test
+    fun `reader appends only new chunks and restarts on a new answer`() {
+        val buffer = ResponseBuffer()
+        val reader = ResponseBuffer.Reader()
+        val hello = buffer.append("Hello")
+        assertEquals("Hello", reader.read(hello).tail)
+        buffer.append(", ")
+        val world = buffer.append("world")
+        assertEquals("Hello, world", reader.read(world).tail)
+        assertEquals("Hello, world", reader.read(world).tail)
+        // An older snapshot of the same answer is read from scratch
+        assertEquals("Hello", reader.read(hello).tail)
+
+        buffer.clear()
+        assertEquals("next", reader.read(buffer.append("next")).tail)
+        assertTrue(reader.read(buffer.clear()).isEmpty())
+    }
+
+    @Test
+    fun `reader settles blocks at blank lines outside code fences`() {
+        val buffer = ResponseBuffer()
+        val reader = ResponseBuffer.Reader()
+        buffer.append("# Title\nfirst ")
+        val first = reader.read(buffer.append("para\n\nsecond"))
+        assertEquals(listOf("# Title\nfirst para"), first.settled)
+        assertEquals("second", first.tail)
+
+        buffer.append("\n\n\n```kotlin\nval a = 1\n\nval b = 2\n")
+        val fenced = reader.read(buffer.append("```\n\nend"))
+        assertEquals(listOf("# Title\nfirst para", "second", "```kotlin\nval a = 1\n\nval b = 2\n```"), fenced.settled)
+        assertEquals("end", fenced.tail)
+        // A settled block is copied out once and shared by later reads
+        assertSame(first.settled[0], fenced.settled[0])
+        assertEquals(buffer.snapshot().text().replace("\n\n\n", "\n\n"), fenced.text())
+    }
+
+    @Test
+    fun `empty chunks do not create versions`() {
+        val buffer = ResponseBuffer()
+        val a = buffer.append("a")
+        assertSame(a, buffer.append(""))
+    }
+
+    @Test
+    fun `streaming 20 KB allocates far less than re-materializing per token`() {
+        val threads = ManagementFactory.getThreadMXBean() as? com.sun.management.ThreadMXBean
+        assumeTrue(threads != null && threads.isThreadAllocatedMemorySupported)
+        val mx = threads!!
+        mx.isThreadAllocatedMemoryEnabled = true
+        val tokens = streamedAnswer()
+        val threadId = Thread.currentThread().id
+
+        fun allocated(block: () -> Unit): Long {
+            block() // warm up
+            val before = mx.getThreadAllocatedBytes(threadId)
+            block()
+            return mx.getThreadAllocatedBytes(threadId) - before
+        }
+
+        var published: Any? = null
+        val perToken = allocated {
+            val full = StringBuilder()
+            for (token in tokens) {
+                full.append(token)
+                published = full.toString()
+            }
+        }
+        val buffered = allocated {
+            val buffer = ResponseBuffer()
+            for (token in tokens) published = buffer.append(token)
+            published = buffer.snapshot().text()
+        }
+        assertNotNull(published)
+
+        // O(n^2) copying is ~ tokens * 20 KB / 2 (at least one byte per char); the buffer is linear
+        assertTrue("per-token toString allocated only $perToken bytes", perToken > tokens.size * 10_000L)
+        assertTrue("ResponseBuffer allocated $buffered bytes vs $perToken", buffered * 20 < perToken)
+    }
+}
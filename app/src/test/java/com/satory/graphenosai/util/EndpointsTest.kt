@@ -0,0 +1,30 @@
+package com.satory.graphenosai.util
+
+import org.junit.Assert.*
+import org.junit.Test
+
+class EndpointsTest {
+
+    @Test
+    fun `production URLs are unchanged without an override`() {
+        val url = "https://openrouter.ai/api/v1/chat/completions"
+        assertEquals(url, Endpoints.resolve(url, null))
+        assertEquals(url, Endpoints.resolve(url, " "))
+    }
+
+    @Test
+    fun `override replaces scheme host and port and keeps the path`() {
+        val base = "http://127.0.0.1:8080/"
+        assertEquals("http://127.0.0.1:8080/api/v1/chat/completions",
+            Endpoints.resolve("https://openrouter.ai/api/v1/chat/completions", base))
+        assertEquals("http://127.0.0.1:8080/openai/v1/audio/transcriptions",
+            Endpoints.resolve("https://api.groq.com/openai/v1/audio/transcriptions", base))
+        assertEquals("http://127.0.0.1:8080/res/v1/web/search",
+            Endpoints.resolve("https://api.search.brave.com/res/v1/web/search", base))
+    }
+
+    @Test
+    fun `host without a path maps to the base`() {
+        assertEquals("http://10.0.2.2:9000", Endpoints.resolve("https://example.com", "http://10.0.2.2:9000"))
+    }
+}
@@ -0,0 +1,75 @@
+package com.satory.graphenosai.util
+
+import com.satory.graphenosai.util.ScreenContext.Item
+import com.satory.graphenosai.util.ScreenContext.Role
+import org.junit.Assert.*
+import org.junit.Test
+
+class ScreenContextTest {
+
+    private val width = 1080
+    private val height = 2400
+
+    @Test
+    fun `emits visible items in reading order with roles`() {
+        val items = listOf(
+            Item("Send", Role.BUTTON, 900, 2200, 150, 120),
+            Item("Hello there", Role.TEXT, 40, 400, 600, 80),
+            Item("Messages", Role.TEXT, 40, 100, 400, 100),
+            Item("Type a message", Role.INPUT, 40, 2200, 800, 120, focused = true)
+        )
+        val text = ScreenContext.build("com.example.chat/.Main", items, width, height)
+
+        assertEquals(
+            """
+            Screen: com.example.chat/.Main
+            Messages
+            Hello there
+            [field] Type a message
+            [button] Send
+            """.trimIndent(),
+            text
+        )
+    }
+
+    @Test
+    fun `drops off-screen and empty items and dedupes labels`() {
+        val items = listOf(
+            Item("Scrolled away", Role.TEXT, 0, -500, 1080, 200),
+            Item("Below the fold", Role.TEXT, 0, 2600, 1080, 200),
+            Item("   ", Role.TEXT, 0, 0, 100, 100),
+            Item("Settings", Role.IMAGE, 0, 0, 10, 10),
+            Item("settings", Role.BUTTON, 0, 200, 500, 150)
+        )
+        val text = ScreenContext.build(null, items, width, height)
+
+        assertEquals("[button] settings", text)
+    }
+
+    @Test
+    fun `returns null when nothing is readable`() {
+        assertNull(ScreenContext.build("app", emptyList(), width, height))
+        assertNull(ScreenContext.build("app", listOf(Item("x", Role.TEXT, 0, 0, 10, 10)), 0, 0))
+    }
+
+    @Test
+    fun `keeps the most visible items within the budget`() {
+        val items = (0 until 200).map { i ->
+            // Small list rows plus one large, clearly visible headline
+            Item("Row number $i with some filler text", Role.TEXT, 0, 300 + i * 10, 200, 10)
+        } + Item("Breaking headline", Role.TEXT, 0, 100, 1080, 180)
+        val text = ScreenContext.build("news", items, width, height, maxChars = 300)!!
+
+        assertTrue(text.length <= 300)
+        assertTrue(text.contains("Breaking headline"))
+        assertTrue(text.lines().first() == "Screen: news")
+    }
+
+    @Test
+    fun `is far smaller than a screenshot`() {
+        val items = (0 until 60).map { i -> Item("List entry $i: a typical line of UI text", Role.TEXT, 0, i * 40, 1080, 40) }
+        val text = ScreenContext.build("app", items, width, height)!!
+        // A 1080x2400 JPEG at quality 80 is ~200-400 KB, ~1.33x that in base64
+        assertTrue("context is ${text.length} chars", text.length <= ScreenContext.DEFAULT_MAX_CHARS)
+    }
+}
@@ -0,0 +1,64 @@
+import org.jetbrains.kotlin.gradle.dsl.JvmTarget
+
+/*
+ * JMH microbenchmarks for the app's per-token and per-conversation Kotlin
+ * paths, on a plain JVM. The app module is Android-only, so the sources
+ * under test are compiled in here directly; they must not use Android APIs
+ * beyond android.util.Log (stubbed in src/jmh/java) and org.json.
+ *
+ *   ./gradlew :benchmark:jmh
+ *   ./gradlew :benchmark:jmh -PjmhIncludes=ChatSession
+ *
+ * Results (ns/op, and B/op from the gc profiler as gc.alloc.rate.norm) are
+ * printed and written to build/results/jmh/results.json.
+ */
+plugins {
+    alias(libs.plugins.kotlin.jvm)
+    alias(libs.plugins.jmh)
+}
+
+java {
+    sourceCompatibility = JavaVersion.VERSION_17
+    targetCompatibility = JavaVersion.VERSION_17
+}
+
+kotlin {
+    compilerOptions {
+        jvmTarget.set(JvmTarget.JVM_17)
+    }
+}
+
+// App sources under test, copied so that only these files are compiled here
+val appSources = tasks.register<Sync>("appSources") {
+    from("../app/src/main/java") {
+        include(
+            "com/satory/graphenosai/llm/ChatSession.kt",
+            "com/satory/graphenosai/llm/InputSanitizer.kt",
+            "com/satory/graphenosai/llm/SseParser.kt",
+            "com/satory/graphenosai/storage/ChatHistoryManager.kt",
+            "com/satory/graphenosai/ui/MarkdownParser.kt"
+        )
+    }
+    into(layout.buildDirectory.dir("appSources"))
+}
+
+kotlin.sourceSets.named("jmh") {
+    kotlin.srcDir(appSources)
+}
+
+dependencies {
+    // Reference org.json; Android ships its own fork with the same API
+    jmh(libs.org.json)
+    // AnnotatedString and friends for the markdown parser
+    jmh(libs.compose.ui.text.desktop)
+}
+
+jmh {
+    jmhVersion.set(libs.versions.jmh)
+    warmupIterations.set(3)
+    iterations.set(5)
+    fork.set(1)
+    profilers.add("gc")
+    resultFormat.set("JSON")
+    (project.findProperty("jmhIncludes") as String?)?.let { includes.add(it) }
+}
@@ -0,0 +1,44 @@
+package com.satory.graphenosai.benchmark
+
+import com.satory.graphenosai.storage.ChatHistoryManager
+import org.openjdk.jmh.annotations.*
+import java.io.File
+import java.nio.file.Files
+import java.util.concurrent.TimeUnit
+
+/**
+ * [ChatHistoryManager.getSavedChats] with a full history (50 saved chats),
+ * which the history screen and every save (through cleanupOldChats) pay.
+ * Every chat file is read and parsed in full, photos included, to build
+ * the summaries.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+open class ChatHistoryBenchmark {
+
+    /** Ask for a photo with every Nth question; 0 for text only. */
+    @Param("0", "5")
+    @JvmField
+    var imageEvery: Int = 0
+
+    private lateinit var dir: File
+    private lateinit var manager: ChatHistoryManager
+
+    @Setup(Level.Trial)
+    fun setUp() {
+        dir = Files.createTempDirectory("chat-history-bench").toFile()
+        manager = ChatHistoryManager(dir)
+        for (chat in 0 until 50) {
+            manager.saveChat(Fixtures.conversation(turns = 10 + chat % 10, imageEvery = imageEvery))
+        }
+    }
+
+    @TearDown(Level.Trial)
+    fun tearDown() {
+        dir.deleteRecursively()
+    }
+
+    @Benchmark
+    fun savedChats(): List<ChatHistoryManager.ChatSummary> = manager.getSavedChats()
+}
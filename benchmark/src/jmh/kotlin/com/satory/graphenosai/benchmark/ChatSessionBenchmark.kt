@@ -0,0 +1,59 @@
+package com.satory.graphenosai.benchmark
+
+import com.satory.graphenosai.llm.ChatSession
+import org.json.JSONArray
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * [ChatSession.getMessagesForApi] runs once per request over the whole
+ * history; trimHistory runs on every added message. Both are measured on a
+ * session at its 20-message cap, text-only or with a photo every third
+ * question.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+open class ChatSessionBenchmark {
+
+    /** Ask for a photo with every Nth question; 0 for text only. */
+    @Param("0", "3")
+    @JvmField
+    var imageEvery: Int = 0
+
+    @Param("false", "true")
+    @JvmField
+    var includeVision: Boolean = false
+
+    private lateinit var conversation: List<ChatSession.Message>
+    private lateinit var session: ChatSession
+    private var next = 0
+    private val systemPrompt = "You are a helpful voice assistant on a GrapheneOS phone. Answer briefly."
+
+    @Setup
+    fun setUp() {
+        conversation = Fixtures.conversation(turns = 10, imageEvery = imageEvery)
+        session = Fixtures.session(conversation)
+    }
+
+    @Benchmark
+    fun messagesForApi(): JSONArray = session.getMessagesForApi(systemPrompt, includeVision)
+
+    /** Serialized request body, as the clients send it. */
+    @Benchmark
+    fun messagesForApiToString(): String = session.getMessagesForApi(systemPrompt, includeVision).toString()
+
+    /**
+     * One message added at the cap: trimHistory drops the oldest and
+     * re-estimates tokens. The conversation is replayed in a loop so the
+     * session keeps its mix of languages and photos.
+     */
+    @Benchmark
+    fun addMessageAtCapacity(): Int {
+        val message = conversation[next]
+        next = (next + 1) % conversation.size
+        if (message.role == "user") session.addUserMessage(message.content, message.imageBase64)
+        else session.addAssistantMessage(message.content)
+        return session.messageCount()
+    }
+}
@@ -0,0 +1,156 @@
+package com.satory.graphenosai.benchmark
+
+import com.satory.graphenosai.llm.ChatSession
+import java.util.Base64
+import kotlin.random.Random
+
+/**
+ * Deterministic inputs shaped like real use: conversations that switch
+ * between scripts, photo attachments as the app sends them (base64 JPEG),
+ * answers with the markdown models actually produce, and the SSE lines of
+ * a streamed answer.
+ */
+object Fixtures {
+
+    val questions = listOf(
+        "What's the weather like in Berlin tomorrow, and should I take an umbrella?",
+        "Wie spät ist es gerade in Tokio, und wann öffnen dort die Geschäfte?",
+        "Переведи, пожалуйста: «Встреча перенесена на четверг, 15:30».",
+        "東京から京都まで新幹線で何分かかりますか？",
+        "ما هي أفضل طريقة لتعلم البرمجة للمبتدئين؟",
+        "Can you summarize this article in three bullet points? 📄✨",
+        "¿Cuál es la diferencia entre «ser» y «estar»? Dame ejemplos.",
+        "Explain the difference between a mutex and a semaphore with a code example."
+    )
+
+    /** About 1.5 KB of the markdown the models answer with, in several scripts. */
+    private val answerSections = listOf(
+        """
+        ## Forecast for tomorrow
+
+        Tomorrow in **Berlin** will be *mostly cloudy* with a high of 14 °C.
+        - Morning: light rain, 9 °C
+        - Afternoon: dry, 14 °C
+        - Evening: clear, 11 °C
+
+        Take an umbrella until noon. Details at https://example.com/weather/berlin?day=1
+        """.trimIndent(),
+        """
+        ### Zeitzonen
+
+        In **Tokio** ist es jetzt 22:15 Uhr (JST, UTC+9). Die meisten Geschäfte öffnen um `10:00`
+        und schließen gegen 20:00. Mehr unter [Japan Guide](https://example.com/japan/hours).
+        1. Kaufhäuser: 10:00–20:00
+        2. Konbini: rund um die Uhr
+        """.trimIndent(),
+        """
+        Перевод: *"The meeting has been moved to Thursday, 3:30 pm."*
+
+        - «перенесена» — ~~cancelled~~ **moved**
+        - «четверг» — Thursday
+        """.trimIndent(),
+        """
+        東京から京都までは**のぞみ**で約 *2時間15分* です。
+        - 始発: 6:00
+        - 料金: 約14,000円
+        """.trimIndent(),
+        """
+        A mutex admits one owner; a semaphore admits up to N:
+
+        ```kotlin
+        val lock = Mutex()
+        val slots = Semaphore(permits = 4)
+        suspend fun fetch(url: String) = slots.withPermit { client.get(url) }
+        ```
+
+        Use `Mutex` to guard state and `Semaphore` to bound concurrency.
+        """.trimIndent()
+    )
+
+    /** Markdown of at least [chars] characters built from the answer sections. */
+    fun markdown(chars: Int): String {
+        val builder = StringBuilder()
+        var i = 0
+        while (builder.length < chars) {
+            if (builder.isNotEmpty()) builder.append("\n\n")
+            builder.append(answerSections[i++ % answerSections.size])
+        }
+        return builder.toString()
+    }
+
+    /**
+     * A photo as the app attaches it: a ~1024 px JPEG of roughly [kb] KB,
+     * base64-encoded. Content is random so it does not compress.
+     */
+    fun imageBase64(kb: Int, seed: Int): String =
+        Base64.getEncoder().encodeToString(Random(seed).nextBytes(kb * 1024))
+
+    /**
+     * [turns] question/answer pairs cycling through the languages above;
+     * with [imageEvery] > 0, every that many questions carries a photo.
+     */
+    fun conversation(turns: Int, imageEvery: Int = 0, imageKb: Int = 150): List<ChatSession.Message> {
+        val messages = ArrayList<ChatSession.Message>(turns * 2)
+        for (turn in 0 until turns) {
+            val image = if (imageEvery > 0 && turn % imageEvery == 0) imageBase64(imageKb, turn) else null
+            messages.add(ChatSession.Message("user", questions[turn % questions.size], turn * 60_000L, image))
+            messages.add(ChatSession.Message("assistant", answerSections[turn % answerSections.size], turn * 60_000L + 5_000L))
+        }
+        return messages
+    }
+
+    fun session(messages: List<ChatSession.Message>): ChatSession = ChatSession().apply {
+        for (message in messages) {
+            if (message.role == "user") addUserMessage(message.content, message.imageBase64)
+            else addAssistantMessage(message.content)
+        }
+    }
+
+    /**
+     * The lines of a streamed answer of [tokens] tokens, as OpenRouter sends
+     * them: a role chunk, one chunk per token with blank separators, a
+     * keep-alive comment now and then, a finish chunk and [DONE].
+     */
+    fun sseLines(tokens: Int): List<String> {
+        val words = markdown(tokens * 8).split(' ')
+        val lines = ArrayList<String>(tokens * 2 + 8)
+        val head = "{\"id\":\"gen-1729000000-AbCdEfGhIjKlMnOp\",\"provider\":\"OpenAI\",\"model\":\"openai/gpt-4o-mini\"," +
+            "\"object\":\"chat.completion.chunk\",\"created\":1729000000,\"choices\":[{\"index\":0,"
+        lines.add("data: $head\"delta\":{\"role\":\"assistant\",\"content\":\"\"},\"finish_reason\":null}]}")
+        lines.add("")
+        for (i in 0 until tokens) {
+            if (i % 50 == 25) {
+                lines.add(": OPENROUTER PROCESSING")
+                lines.add("")
+            }
+            val token = jsonEscape(words[i % words.size] + " ")
+            lines.add("data: $head\"delta\":{\"role\":\"assistant\",\"content\":\"$token\"},\"finish_reason\":null}]}")
+            lines.add("")
+        }
+        lines.add("data: $head\"delta\":{\"role\":\"assistant\",\"content\":null},\"finish_reason\":\"stop\"}]}")
+        lines.add("")
+        lines.add("data: [DONE]")
+        return lines
+    }
+
+    /** A pasted e-mail thread with addresses, phone numbers and ids, about [chars] long. */
+    fun pastedText(chars: Int): String {
+        val paragraph = "Hi team, please call Anna at +491701234567 or write to anna.mueller@example.de " +
+            "about ticket 3f9a1c2b7d4e8f60. Привет! Card on file ends 4111 1111 1111 1111, " +
+            "so do not forward this. 会議は木曜日です。\n"
+        val builder = StringBuilder()
+        while (builder.length < chars) builder.append(paragraph)
+        return builder.toString()
+    }
+
+    private fun jsonEscape(text: String): String = buildString {
+        for (c in text) {
+            when (c) {
+                '"' -> append("\\\"")
+                '\\' -> append("\\\\")
+                '\n' -> append("\\n")
+                else -> append(c)
+            }
+        }
+    }
+}
@@ -0,0 +1,30 @@
+package com.satory.graphenosai.benchmark
+
+import com.satory.graphenosai.llm.InputSanitizer
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * [InputSanitizer.sanitize] on every query: a spoken question, and a pasted
+ * text at and well over the 4000-character cap.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+open class InputSanitizerBenchmark {
+
+    /** Query length in characters; 0 for a short spoken question. */
+    @Param("0", "4000", "16000")
+    @JvmField
+    var chars: Int = 0
+
+    private lateinit var query: String
+
+    @Setup
+    fun setUp() {
+        query = if (chars == 0) Fixtures.questions[0] else Fixtures.pastedText(chars)
+    }
+
+    @Benchmark
+    fun sanitize(): String = InputSanitizer.sanitize(query)
+}
@@ -0,0 +1,36 @@
+package com.satory.graphenosai.benchmark
+
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.text.AnnotatedString
+import androidx.compose.ui.text.TextStyle
+import androidx.compose.ui.unit.sp
+import com.satory.graphenosai.ui.parseMarkdown
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * [parseMarkdown] over a whole answer. MarkdownText parses again whenever
+ * the text changes, so while an answer streams this cost is paid per token
+ * at the answer's current length.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+open class MarkdownBenchmark {
+
+    /** Answer length in KB. */
+    @Param("1", "4", "16")
+    @JvmField
+    var kb: Int = 0
+
+    private lateinit var markdown: String
+    private val baseStyle = TextStyle(fontSize = 16.sp)
+
+    @Setup
+    fun setUp() {
+        markdown = Fixtures.markdown(kb * 1024)
+    }
+
+    @Benchmark
+    fun parse(): AnnotatedString = parseMarkdown(markdown, baseStyle, Color.Blue, Color.LightGray)
+}
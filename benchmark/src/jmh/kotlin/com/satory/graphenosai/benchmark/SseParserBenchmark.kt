@@ -0,0 +1,38 @@
+package com.satory.graphenosai.benchmark
+
+import com.satory.graphenosai.llm.SseParser
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * The client read loop over one streamed answer: every line goes through
+ * [SseParser] and the deltas are appended, as OpenRouterClient does.
+ * Divide by the token count for the per-token cost.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+open class SseParserBenchmark {
+
+    @Param("200", "1000")
+    @JvmField
+    var tokens: Int = 0
+
+    private lateinit var lines: List<String>
+
+    @Setup
+    fun setUp() {
+        lines = Fixtures.sseLines(tokens)
+    }
+
+    @Benchmark
+    fun stream(): Int {
+        val response = StringBuilder()
+        for (line in lines) {
+            if (SseParser.isDone(line)) break
+            val content = SseParser.deltaContent(line) ?: continue
+            response.append(content)
+        }
+        return response.length
+    }
+}
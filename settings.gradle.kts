@@ -21,4 +21,5 @@ dependencyResolutionManagement {
 
 rootProject.name = "ai-integrated-into-android"
 include(":app")
+include(":benchmark")
  
\ No newline at end of file